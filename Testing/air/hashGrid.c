@@ -0,0 +1,140 @@
+/*
+  Teem: Tools to process and visualize scientific data and images
+  Copyright (C) 2009--2019  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/air.h"
+
+/*
+** Tests:
+** airHashGridNew
+** airHashGridNix
+** airHashGridBuild
+** airHashGridCell
+** airHashGridNeighborBuckets
+**
+** Also uses:
+** airMopNew, airMopAdd, airMopError, airMopDone
+** airRandMTStateNew, airRandMTStateNix, airDrandMT_r
+*/
+
+#define NUM 3000
+int
+main(int argc, const char *argv[]) {
+  airArray *mop;
+  airRandMTState *rng;
+  airHashGrid *hgA, *hgB;
+  const char *me;
+  double *pos, dd[3];
+  unsigned int ii, jj, bi, ni, found, nei[27], neiNum, *seen;
+  int cell[3];
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+
+  mop = airMopNew();
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  pos = AIR_CALLOC(3 * NUM, double);
+  airMopAdd(mop, pos, airFree, airMopAlways);
+  seen = AIR_CALLOC(NUM, unsigned int);
+  airMopAdd(mop, seen, airFree, airMopAlways);
+  hgA = airHashGridNew(0.1);
+  airMopAdd(mop, hgA, (airMopper)airHashGridNix, airMopAlways);
+  hgB = airHashGridNew(0.1);
+  airMopAdd(mop, hgB, (airMopper)airHashGridNix, airMopAlways);
+  if (!(hgA && hgB) || airHashGridNew(0)) {
+    fprintf(stderr, "%s: airHashGridNew failed\n", me);
+    airMopError(mop);
+    exit(1);
+  }
+  /* points straddling the origin, so that cells have negative coordinates */
+  for (ii = 0; ii < 3 * NUM; ii++) {
+    pos[ii] = AIR_AFFINE(0, airDrandMT_r(rng), 1, -0.7, 0.8);
+  }
+  if (airHashGridBuild(hgA, pos, 3, NUM, 1) || airHashGridBuild(hgB, pos, 3, NUM, 4)) {
+    fprintf(stderr, "%s: airHashGridBuild failed\n", me);
+    airMopError(mop);
+    exit(1);
+  }
+
+  /* building with more threads gives the same result */
+  if (hgA->bucketNum != hgB->bucketNum) {
+    fprintf(stderr, "%s: bucketNum %u != %u\n", me, hgA->bucketNum, hgB->bucketNum);
+    airMopError(mop);
+    exit(1);
+  }
+  for (bi = 0; bi < hgA->bucketNum; bi++) {
+    if (hgA->bucketStart[bi] != hgB->bucketStart[bi]
+        || hgA->bucketCount[bi] != hgB->bucketCount[bi]) {
+      fprintf(stderr, "%s: bucket %u differs with threads\n", me, bi);
+      airMopError(mop);
+      exit(1);
+    }
+  }
+  for (ii = 0; ii < NUM; ii++) {
+    if (hgA->pointIdx[ii] != hgB->pointIdx[ii]) {
+      fprintf(stderr, "%s: pointIdx[%u] %u != %u\n", me, ii, hgA->pointIdx[ii],
+              hgB->pointIdx[ii]);
+      airMopError(mop);
+      exit(1);
+    }
+    seen[hgA->pointIdx[ii]] += 1;
+  }
+  for (ii = 0; ii < NUM; ii++) {
+    if (1 != seen[ii]) {
+      fprintf(stderr, "%s: point %u in grid %u times\n", me, ii, seen[ii]);
+      airMopError(mop);
+      exit(1);
+    }
+  }
+
+  /* every pair of points no further apart than cellSize is found */
+  for (ii = 0; ii < NUM; ii++) {
+    airHashGridCell(hgA, cell, pos + 3 * ii);
+    neiNum = airHashGridNeighborBuckets(hgA, nei, cell);
+    for (jj = 0; jj < NUM; jj++) {
+      dd[0] = pos[0 + 3 * ii] - pos[0 + 3 * jj];
+      dd[1] = pos[1 + 3 * ii] - pos[1 + 3 * jj];
+      dd[2] = pos[2 + 3 * ii] - pos[2 + 3 * jj];
+      if (sqrt(dd[0] * dd[0] + dd[1] * dd[1] + dd[2] * dd[2]) > hgA->cellSize) {
+        continue;
+      }
+      found = AIR_FALSE;
+      for (ni = 0; !found && ni < neiNum; ni++) {
+        for (bi = 0; bi < hgA->bucketCount[nei[ni]]; bi++) {
+          if (jj == hgA->pointIdx[hgA->bucketStart[nei[ni]] + bi]) {
+            found = AIR_TRUE;
+            break;
+          }
+        }
+      }
+      if (!found) {
+        fprintf(stderr, "%s: point %u not a neighbor of %u\n", me, jj, ii);
+        airMopError(mop);
+        exit(1);
+      }
+    }
+  }
+
+  airMopOkay(mop);
+  exit(0);
+}
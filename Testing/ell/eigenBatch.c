@@ -0,0 +1,202 @@
+/*
+  Teem: Tools to process and visualize scientific data and images
+  Copyright (C) 2009--2019  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/ell.h"
+
+/*
+** Tests:
+** ell_3ms_eigensolve_batch_d
+**
+** by comparing, for symmetric matrices made from known eigensystems
+** (including ones with double and triple eigenvalues, and nearly so, and
+** with tiny and huge entries), its eigenvalues with the true ones and
+** with those from ell_3m_eigensolve_d, and checking that its
+** eigenvectors are eigenvectors, and form a rotation.  Also prints the
+** time taken by the two solvers.
+*/
+
+#define NUM 20000
+#define SPEC_NUM 8
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  airRandMTState *rng;
+  double *sym, *truEval, *eval, *evec, *evalOnly, mat[9], rot[9], rotT[9], diag[9],
+    tmp[9], qq[4], len, scl, ee[3], ev[9], av[3], err, errMax[3], time0, time1, time2;
+  unsigned int ii, jj, spec, jacobi;
+  int bad;
+
+  AIR_UNUSED(argc);
+  AIR_UNUSED(argv);
+  mop = airMopNew();
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  sym = AIR_CALLOC(6 * NUM, double);
+  airMopAdd(mop, sym, airFree, airMopAlways);
+  truEval = AIR_CALLOC(3 * NUM, double);
+  airMopAdd(mop, truEval, airFree, airMopAlways);
+  eval = AIR_CALLOC(3 * NUM, double);
+  airMopAdd(mop, eval, airFree, airMopAlways);
+  evalOnly = AIR_CALLOC(3 * NUM, double);
+  airMopAdd(mop, evalOnly, airFree, airMopAlways);
+  evec = AIR_CALLOC(9 * NUM, double);
+  airMopAdd(mop, evec, airFree, airMopAlways);
+  if (!(sym && truEval && eval && evalOnly && evec)) {
+    fprintf(stderr, "couldn't allocate buffers\n");
+    airMopError(mop);
+    return 1;
+  }
+
+  for (ii = 0; ii < NUM; ii++) {
+    double *tt = truEval + 3 * ii;
+    spec = ii % SPEC_NUM;
+    ELL_3V_SET(tt, airDrandMT_r(rng), airDrandMT_r(rng), airDrandMT_r(rng));
+    tt[0] = AIR_AFFINE(0, tt[0], 1, -1, 2);
+    tt[1] = AIR_AFFINE(0, tt[1], 1, -1, 2);
+    tt[2] = AIR_AFFINE(0, tt[2], 1, -1, 2);
+    switch (spec) {
+    case 0: /* three distinct (probably) */
+    case 1:
+      break;
+    case 2: /* double */
+      tt[1] = tt[0];
+      break;
+    case 3: /* nearly double */
+      tt[1] = tt[0] * (1 + 1e-9);
+      break;
+    case 4: /* triple */
+      tt[2] = tt[1] = tt[0];
+      break;
+    case 5: /* nearly triple, on top of a big isotropic part */
+      ELL_3V_SET(tt, 1 + 1e-8 * tt[0], 1 + 1e-8 * tt[1], 1 + 1e-8 * tt[2]);
+      break;
+    case 6: /* tiny */
+      ELL_3V_SCALE(tt, 1e-30, tt);
+      break;
+    case 7: /* huge */
+      ELL_3V_SCALE(tt, 1e30, tt);
+      break;
+    }
+    ELL_SORT3(tt[0], tt[1], tt[2], len);
+    ELL_4V_SET(qq, airDrandMT_r(rng) - 0.5, airDrandMT_r(rng) - 0.5,
+               airDrandMT_r(rng) - 0.5, airDrandMT_r(rng) - 0.5);
+    ELL_4V_NORM(qq, qq, len);
+    ell_q_to_3m_d(rot, qq);
+    if (!(ii % 3)) {
+      /* some diagonal matrices */
+      ELL_3M_IDENTITY_SET(rot);
+    }
+    ELL_3M_ZERO_SET(diag);
+    ELL_3M_DIAG_SET(diag, tt[0], tt[1], tt[2]);
+    ELL_3M_MUL(tmp, diag, rot);
+    ELL_3M_TRANSPOSE(rotT, rot);
+    ELL_3M_MUL(mat, rotT, tmp);
+    /* symmetric exactly */
+    ELL_6V_SET(sym + 6 * ii, mat[0], (mat[1] + mat[3]) / 2, (mat[2] + mat[6]) / 2,
+               mat[4], (mat[5] + mat[7]) / 2, mat[8]);
+  }
+
+  bad = AIR_FALSE;
+  for (jacobi = 0; jacobi <= 2; jacobi += 2) {
+    ELL_3V_SET(errMax, 0, 0, 0);
+    ell_3ms_eigensolve_batch_d(eval, evec, sym, 6, NUM, jacobi);
+    ell_3ms_eigensolve_batch_d(evalOnly, NULL, sym, 6, NUM, jacobi);
+    for (ii = 0; ii < NUM; ii++) {
+      double *ss = sym + 6 * ii, *tt = truEval + 3 * ii, *ei = eval + 3 * ii,
+             *vi = evec + 9 * ii;
+      ELL_3M_SET(mat, ss[0], ss[1], ss[2], ss[1], ss[3], ss[4], ss[2], ss[4], ss[5]);
+      scl = AIR_MAX(fabs(tt[0]), fabs(tt[2]));
+      scl = scl ? scl : 1;
+      ell_3m_eigensolve_d(ee, ev, mat, AIR_TRUE);
+      for (jj = 0; jj < 3; jj++) {
+        /* without eigenvectors, and with no jacobi, the eigenvalues are
+           from the closed-form solution alone, and are less accurate */
+        err = fabs(evalOnly[jj + 3 * ii] - tt[jj]) / scl;
+        if (jacobi ? ei[jj] != evalOnly[jj + 3 * ii] : err > 1e-7) {
+          fprintf(stderr, "matrix %u (jacobi %u): eval[%u] %.17g vs %.17g without "
+                  "evecs\n", ii, jacobi, jj, ei[jj], evalOnly[jj + 3 * ii]);
+          bad = AIR_TRUE;
+        }
+        /* error in eigenvalue, relative to the true eigenvalues */
+        err = fabs(ei[jj] - tt[jj]) / scl;
+        errMax[0] = AIR_MAX(errMax[0], err);
+        /* how far the existing solver is from the truth */
+        err = fabs(ee[jj] - tt[jj]) / scl;
+        errMax[1] = AIR_MAX(errMax[1], err);
+        /* residual of eigenvector */
+        ELL_3MV_MUL(av, mat, vi + 3 * jj);
+        ELL_3V_SCALE_INCR(av, -ei[jj], vi + 3 * jj);
+        err = ELL_3V_LEN(av) / scl;
+        errMax[2] = AIR_MAX(errMax[2], err);
+      }
+      ELL_3M_TRANSPOSE(rotT, vi);
+      ELL_3M_MUL(tmp, vi, rotT);
+      ELL_3M_IDENTITY_SET(rot);
+      ELL_3M_SUB(tmp, tmp, rot);
+      if (ELL_3M_FROB(tmp) > 1e-13 || fabs(ell_3m_det_d(vi) - 1) > 1e-13) {
+        fprintf(stderr, "matrix %u (jacobi %u): eigenvectors not a rotation\n", ii,
+                jacobi);
+        bad = AIR_TRUE;
+      }
+      if (bad) {
+        break;
+      }
+    }
+    printf("jacobi %u: max eval err %g (ell_3m_eigensolve_d: %g); max evec "
+           "residual %g\n",
+           jacobi, errMax[0], errMax[1], errMax[2]);
+    if (bad || !(errMax[0] < 1e-13 && errMax[2] < 1e-13)) {
+      fprintf(stderr, "jacobi %u: too much error\n", jacobi);
+      airMopError(mop);
+      return 1;
+    }
+  }
+
+  time0 = airTime();
+  for (ii = 0; ii < NUM; ii++) {
+    double *ss = sym + 6 * ii;
+    ELL_3M_SET(mat, ss[0], ss[1], ss[2], ss[1], ss[3], ss[4], ss[2], ss[4], ss[5]);
+    ell_3m_eigensolve_d(eval + 3 * ii, evec + 9 * ii, mat, AIR_TRUE);
+  }
+  time1 = airTime();
+  ell_3ms_eigensolve_batch_d(eval, evec, sym, 6, NUM, 0);
+  time2 = airTime();
+  printf("time for %u eigensystems: ell_3m_eigensolve_d %g, batch %g\n", NUM,
+         time1 - time0, time2 - time1);
+  time0 = airTime();
+  for (ii = 0; ii < NUM; ii++) {
+    double *ss = sym + 6 * ii;
+    ELL_3M_SET(mat, ss[0], ss[1], ss[2], ss[1], ss[3], ss[4], ss[2], ss[4], ss[5]);
+    ell_3m_eigenvalues_d(eval + 3 * ii, mat, AIR_TRUE);
+  }
+  time1 = airTime();
+  ell_3ms_eigensolve_batch_d(eval, NULL, sym, 6, NUM, 0);
+  time2 = airTime();
+  printf("time for %u eigenvalues: ell_3m_eigenvalues_d %g, batch %g\n", NUM,
+         time1 - time0, time2 - time1);
+
+  printf("All ok.\n");
+  airMopOkay(mop);
+  return 0;
+}
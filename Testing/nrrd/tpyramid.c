@@ -0,0 +1,164 @@
+/*
+  Teem: Tools to process and visualize scientific data and images
+  Copyright (C) 2009--2019  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/nrrd.h"
+
+/*
+** Tests:
+** nrrdPyramid
+** nrrdPyramidCheck
+** nrrdPyramidManage (saving and then re-loading levels)
+** nrrdPyramidLevelPick
+**
+** The pyramid levels are saved in the directory given as the one
+** (optional) argument, and removed again when done
+*/
+
+#define LEVELS 3
+
+static void *
+removeFile(void *fname) {
+  remove(AIR_CAST(char *, fname));
+  return NULL;
+}
+
+int
+main(int argc, const char *argv[]) {
+  const char *me, *tdir;
+  char format[AIR_STRLEN_HUGE + 1], fname[LEVELS][AIR_STRLEN_HUGE + 1];
+  Nrrd *nin, *nlev[LEVELS], **nman;
+  double *val, *lval;
+  size_t ii, nn;
+  unsigned int li;
+  int recomp;
+  airArray *mop;
+  char *err;
+
+  me = argv[0];
+  tdir = argc > 1 ? argv[1] : ".";
+  if (airStrlen(tdir) + airStrlen("/tpyr%02u.nrrd") > AIR_STRLEN_HUGE) {
+    fprintf(stderr, "%s: directory name \"%s\" too long\n", me, tdir);
+    return 1;
+  }
+  sprintf(format, "%s/tpyr%%02u.nrrd", tdir);
+  mop = airMopNew();
+  for (li = 0; li < LEVELS; li++) {
+    /* nrrdPyramidManage numbers the levels from 1 */
+    sprintf(fname[li], format, li + 1);
+    airMopAdd(mop, fname[li], removeFile, airMopAlways);
+  }
+
+  /* constant volume: every level of pyramid should also be constant */
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdAlloc_va(nin, nrrdTypeDouble, 3, AIR_SIZE_T(17), AIR_SIZE_T(12),
+                   AIR_SIZE_T(9))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    airMopError(mop);
+    return 1;
+  }
+  val = AIR_CAST(double *, nin->data);
+  nn = nrrdElementNumber(nin);
+  for (ii = 0; ii < nn; ii++) {
+    val[ii] = 42;
+  }
+  for (li = 0; li < LEVELS; li++) {
+    nlev[li] = nrrdNew();
+    airMopAdd(mop, nlev[li], (airMopper)nrrdNuke, airMopAlways);
+  }
+  if (nrrdPyramid(nlev, LEVELS, nin, 0, NULL)
+      || nrrdPyramidCheck(AIR_CAST(const Nrrd *const *, nlev), LEVELS, nin, 0, NULL)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble with pyramid:\n%s", me, err);
+    airMopError(mop);
+    return 1;
+  }
+  /* 17 -> 9 -> 5 -> 3 */
+  if (!(3 == nlev[2]->axis[0].size && 2 == nlev[2]->axis[1].size
+        && 2 == nlev[2]->axis[2].size)) {
+    fprintf(stderr, "%s: level %u has wrong sizes\n", me, LEVELS);
+    airMopError(mop);
+    return 1;
+  }
+  for (li = 0; li < LEVELS; li++) {
+    lval = AIR_CAST(double *, nlev[li]->data);
+    nn = nrrdElementNumber(nlev[li]);
+    for (ii = 0; ii < nn; ii++) {
+      if (!(fabs(lval[ii] - 42) < 1e-10)) {
+        fprintf(stderr, "%s: level %u value[%u] %g != 42\n", me, li + 1,
+                AIR_UINT(ii), lval[ii]);
+        airMopError(mop);
+        return 1;
+      }
+    }
+  }
+  /* a pyramid of one volume shouldn't pass as pyramid of another */
+  val[0] = 0;
+  nin->axis[2].size = 8;
+  if (!nrrdPyramidCheck(AIR_CAST(const Nrrd *const *, nlev), LEVELS, nin, 0, NULL)) {
+    fprintf(stderr, "%s: pyramid check didn't catch size mismatch\n", me);
+    airMopError(mop);
+    return 1;
+  }
+  airMopAdd(mop, biffGetDone(NRRD), airFree, airMopAlways);
+  nin->axis[2].size = 9;
+
+  /* first call computes and saves, second one should load */
+  if (nrrdPyramidManage(&nman, &recomp, LEVELS, format, AIR_TRUE, nin, 0, NULL)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble managing pyramid (1):\n%s", me, err);
+    airMopError(mop);
+    return 1;
+  }
+  for (li = 0; li < LEVELS; li++) {
+    nrrdNuke(nman[li]);
+  }
+  free(nman);
+  if (nrrdPyramidManage(&nman, &recomp, LEVELS, format, AIR_TRUE, nin, 0, NULL)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble managing pyramid (2):\n%s", me, err);
+    airMopError(mop);
+    return 1;
+  }
+  for (li = 0; li < LEVELS; li++) {
+    airMopAdd(mop, nman[li], (airMopper)nrrdNuke, airMopAlways);
+  }
+  airMopAdd(mop, nman, airFree, airMopAlways);
+  if (recomp) {
+    fprintf(stderr, "%s: saved pyramid wasn't re-used\n", me);
+    airMopError(mop);
+    return 1;
+  }
+
+  if (!(0 == nrrdPyramidLevelPick(0.7, LEVELS) && 1 == nrrdPyramidLevelPick(2.5, LEVELS)
+        && 2 == nrrdPyramidLevelPick(4.0, LEVELS)
+        && LEVELS == nrrdPyramidLevelPick(1000, LEVELS))) {
+    fprintf(stderr, "%s: nrrdPyramidLevelPick gave wrong level\n", me);
+    airMopError(mop);
+    return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,97 @@
+/*
+  Teem: Tools to process and visualize scientific data and images
+  Copyright (C) 2009--2019  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/pull.h"
+
+/*
+** Tests:
+** pullEnergySpecEvalBatch
+**
+** by checking that every pullEnergy (but unknown) has an evalBatch, and
+** that it gives exactly the same energies and derivatives as calling eval
+** one distance at a time, over distances that go a bit past the support
+*/
+
+#define DIST_NUM 1001
+#define DIST_MAX 1.2
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  pullEnergySpec *ensp;
+  double *dist, *enr, *denr, ee, de;
+  /* parms for each energy type: typical values, nothing special */
+  static const double parm[PULL_ENERGY_TYPE_MAX + 1][PULL_ENERGY_PARM_NUM]
+    = {{0, 0, 0},           /* unknown */
+       {0.2, 0, 0},         /* spring */
+       {0, 0, 0},           /* gauss */
+       {0, 0, 0},           /* bspln */
+       {16, 0.8, 0},        /* butter */
+       {0, 0, 0},           /* cotan */
+       {0, 0, 0},           /* cubic */
+       {0, 0, 0},           /* quartic */
+       {0.7, -0.001, 0},    /* cwell */
+       {0.7, -0.001, 0},    /* bwell */
+       {0.64, 0, 0},        /* qwell */
+       {0.64, 0, 0},        /* hwell */
+       {0, 0, 0},           /* zero */
+       {10, 0.7, -0.1}};    /* bparab */
+  unsigned int ti, ii;
+
+  AIR_UNUSED(argc);
+  AIR_UNUSED(argv);
+  mop = airMopNew();
+  ensp = pullEnergySpecNew();
+  airMopAdd(mop, ensp, (airMopper)pullEnergySpecNix, airMopAlways);
+  dist = AIR_CALLOC(3 * DIST_NUM, double);
+  airMopAdd(mop, dist, airFree, airMopAlways);
+  enr = dist + DIST_NUM;
+  denr = dist + 2 * DIST_NUM;
+  for (ii = 0; ii < DIST_NUM; ii++) {
+    dist[ii] = AIR_AFFINE(0, ii, DIST_NUM - 1, 0, DIST_MAX);
+  }
+  for (ti = 1; ti <= PULL_ENERGY_TYPE_MAX; ti++) {
+    pullEnergySpecSet(ensp, pullEnergyAll[ti], parm[ti]);
+    if (!ensp->energy->evalBatch) {
+      fprintf(stderr, "energy \"%s\" has no evalBatch\n", ensp->energy->name);
+      airMopError(mop);
+      return 1;
+    }
+    pullEnergySpecEvalBatch(enr, denr, dist, DIST_NUM, ensp);
+    for (ii = 0; ii < DIST_NUM; ii++) {
+      ee = ensp->energy->eval(&de, dist[ii], ensp->parm);
+      if (!(ee == enr[ii] && de == denr[ii])) {
+        fprintf(stderr,
+                "energy \"%s\" at dist %.17g: eval gives %.17g (deriv %.17g), "
+                "evalBatch gives %.17g (deriv %.17g)\n",
+                ensp->energy->name, dist[ii], ee, de, enr[ii], denr[ii]);
+        airMopError(mop);
+        return 1;
+      }
+    }
+  }
+
+  printf("All ok.\n");
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,181 @@
+/*
+  Teem: Tools to process and visualize scientific data and images
+  Copyright (C) 2009--2019  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/pull.h"
+#include <testDataPath.h>
+
+/*
+** Tests:
+** pullSysParmNeighborSkin
+**
+** by checking that the points end up in the same places with and without
+** Verlet lists, with a skin small enough that points often move more than
+** half of it in an iteration.  Without the lists, the bins are made as wide
+** as they are with the skin, so that the points are processed in the same
+** order.  With several threads and several bins, the result depends on
+** the timing of the threads (they read positions that other threads are
+** updating), so the multi-threaded comparison uses a single bin, which
+** fixes the order without turning off the threading
+*/
+
+#define POINT_NUM 300
+#define ITER_MAX 8
+#define THREAD_NUM 3
+#define SKIN 0.05
+#define BIN_WIDTH 1.001
+
+/*
+** runs pull on nin, and sets pos[4*I + 0..3] to the position of the point
+** with idtag I (or NaN if there's no such point)
+*/
+static int /* Biff: 1 */
+runPull(double *pos, const Nrrd *nin, unsigned int threadNum, int binSingle,
+        double skin, double binWidth) {
+  static const char me[] = "runPull";
+  airArray *mop;
+  pullContext *pctx;
+  pullInfoSpec *ispec;
+  pullEnergySpec *ensp;
+  NrrdKernelSpec *ksp[3];
+  Nrrd *npos, *nidt;
+  const double *pp;
+  const unsigned int *idt;
+  unsigned int ii, pi;
+  static const char *kstr[3] = {"cubic:1,0", "cubicd:1,0", "cubicdd:1,0"};
+
+  mop = airMopNew();
+  for (ii = 0; ii < 3; ii++) {
+    ksp[ii] = nrrdKernelSpecNew();
+    airMopAdd(mop, ksp[ii], (airMopper)nrrdKernelSpecNix, airMopAlways);
+    if (nrrdKernelSpecParse(ksp[ii], kstr[ii])) {
+      biffMovef(PULL, NRRD, "%s: trouble with kernel %u", me, ii);
+      airMopError(mop);
+      return 1;
+    }
+  }
+  ensp = pullEnergySpecNew();
+  airMopAdd(mop, ensp, (airMopper)pullEnergySpecNix, airMopAlways);
+  pctx = pullContextNew();
+  airMopAdd(mop, pctx, (airMopper)pullContextNix, airMopAlways);
+  ispec = pullInfoSpecNew();
+  ispec->info = pullInfoSeedThresh;
+  ispec->source = pullSourceGage;
+  ispec->volName = airStrdup("V");
+  ispec->item = gageSclValue;
+  ispec->zero = -0.5;
+  ispec->scale = 1;
+  if (pullEnergySpecParse(ensp, "cotan")
+      || pullVolumeSingleAdd(pctx, gageKindScl, AIR_CAST(char *, "V"), nin, ksp[0],
+                             ksp[1], ksp[2])
+      || pullInfoSpecAdd(pctx, ispec) || pullInitRandomSet(pctx, POINT_NUM)
+      || pullFlagSet(pctx, pullFlagBinSingle, binSingle)
+      || pullRngSeedSet(pctx, 42) || pullThreadNumSet(pctx, threadNum)
+      || pullIterParmSet(pctx, pullIterParmMax, ITER_MAX)
+      || pullIterParmSet(pctx, pullIterParmPopCntlPeriod, 0)
+      || pullSysParmSet(pctx, pullSysParmRadiusSpace, 0.1)
+      || pullSysParmSet(pctx, pullSysParmBinWidthSpace, binWidth)
+      || pullSysParmSet(pctx, pullSysParmNeighborSkin, skin)
+      || pullInterEnergySet(pctx, pullInterTypeJustR, ensp, NULL, NULL)
+      || pullStart(pctx) || pullRun(pctx)) {
+    biffAddf(PULL, "%s: trouble running with %u threads, skin %g", me, threadNum, skin);
+    airMopError(mop);
+    return 1;
+  }
+  npos = nrrdNew();
+  airMopAdd(mop, npos, (airMopper)nrrdNuke, airMopAlways);
+  nidt = nrrdNew();
+  airMopAdd(mop, nidt, (airMopper)nrrdNuke, airMopAlways);
+  if (pullPropGet(npos, pullPropPosition, pctx)
+      || pullPropGet(nidt, pullPropIdtag, pctx)) {
+    biffAddf(PULL, "%s: trouble getting output", me);
+    airMopError(mop);
+    return 1;
+  }
+  for (ii = 0; ii < 4 * POINT_NUM; ii++) {
+    pos[ii] = AIR_NAN;
+  }
+  pp = AIR_CAST(const double *, npos->data);
+  idt = AIR_CAST(const unsigned int *, nidt->data);
+  for (pi = 0; pi < nidt->axis[0].size; pi++) {
+    if (idt[pi] < POINT_NUM) {
+      ELL_4V_COPY(pos + 4 * idt[pi], pp + 4 * pi);
+    }
+  }
+  if (pullFinish(pctx)) {
+    biffAddf(PULL, "%s: trouble finishing", me);
+    airMopError(mop);
+    return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  char *fullname, *err;
+  Nrrd *nin;
+  double pos[2][4 * POINT_NUM], dd[4];
+  unsigned int ii, ci, threadNum;
+
+  AIR_UNUSED(argc);
+  AIR_UNUSED(argv);
+  mop = airMopNew();
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  fullname = testDataPathPrefix("fmob-c4h.nrrd");
+  airMopAdd(mop, fullname, airFree, airMopAlways);
+  if (nrrdLoad(nin, fullname, NULL)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "trouble reading data \"%s\":\n%s", fullname, err);
+    airMopError(mop);
+    return 1;
+  }
+  for (ci = 0; ci < 2; ci++) {
+    threadNum = ci ? THREAD_NUM : 1;
+    if (runPull(pos[0], nin, threadNum, ci, 0, BIN_WIDTH * (1 + SKIN))
+        || runPull(pos[1], nin, threadNum, ci, SKIN, BIN_WIDTH)) {
+      airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
+      fprintf(stderr, "trouble:\n%s", err);
+      airMopError(mop);
+      return 1;
+    }
+    for (ii = 0; ii < POINT_NUM; ii++) {
+      ELL_4V_SUB(dd, pos[0] + 4 * ii, pos[1] + 4 * ii);
+      if (!(ELL_4V_LEN(dd) < 1e-8)) {
+        fprintf(stderr,
+                "%u threads: point %u at (%g,%g,%g) with Verlet lists, "
+                "(%g,%g,%g) without\n",
+                threadNum, ii, pos[1][0 + 4 * ii], pos[1][1 + 4 * ii],
+                pos[1][2 + 4 * ii], pos[0][0 + 4 * ii], pos[0][1 + 4 * ii],
+                pos[0][2 + 4 * ii]);
+        airMopError(mop);
+        return 1;
+      }
+    }
+  }
+
+  printf("All ok.\n");
+  airMopOkay(mop);
+  return 0;
+}
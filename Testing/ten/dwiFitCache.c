@@ -0,0 +1,212 @@
+/*
+  Teem: Tools to process and visualize scientific data and images
+  Copyright (C) 2009--2019  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/ten.h"
+
+/*
+** Tests:
+** tenDwiGageKindFitCacheSet
+**
+** by checking that with the fit cache, the LLS tensor measured by the
+** DWI kind (in two gageContexts sharing the kind, and so its cache) is
+** the trilinear interpolation of the (noise-free) tensors from which the
+** DWIs were made
+*/
+
+#define SX 9
+#define SY 8
+#define SZ 6
+#define GRAD_NUM 16
+
+/*
+** one B0 and GRAD_NUM-1 gradients spiraling down the upper hemisphere
+*/
+static void
+makeGrads(double *grad) {
+  double zz, rr, phi;
+  unsigned int ii;
+
+  ELL_3V_SET(grad, 0, 0, 0);
+  for (ii = 1; ii < GRAD_NUM; ii++) {
+    zz = 1 - (ii - 0.5) / (GRAD_NUM - 1);
+    rr = sqrt(1 - zz * zz);
+    phi = 2.39996 * ii; /* golden angle */
+    ELL_3V_SET(grad + 3 * ii, rr * cos(phi), rr * sin(phi), zz);
+  }
+}
+
+/*
+** tensors whose principal eigenvector turns around the X axis with Y, and
+** whose eigenvalues vary with X and Z, with B0 varying with X
+*/
+static void
+makeTensors(double *tru, double *B0) {
+  double eval[3], evec[9], cc, ss;
+  unsigned int xi, yi, zi;
+
+  for (zi = 0; zi < SZ; zi++) {
+    for (yi = 0; yi < SY; yi++) {
+      for (xi = 0; xi < SX; xi++) {
+        ELL_3V_SET(eval, 0.0017 - 0.0001 * zi, 0.0005, 0.0003 + 0.00002 * xi);
+        cc = cos(AIR_PI * yi / SY);
+        ss = sin(AIR_PI * yi / SY);
+        ELL_3V_SET(evec + 0, 0, cc, ss);
+        ELL_3V_SET(evec + 3, 0, -ss, cc);
+        ELL_3V_SET(evec + 6, 1, 0, 0);
+        tenMakeSingle_d(tru, 1, eval, evec);
+        *B0 = 800 + 40 * xi;
+        tru += 7;
+        B0 += 1;
+      }
+    }
+  }
+}
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  airRandMTState *rng;
+  gageKind *kind;
+  gageContext *ctx[2];
+  gagePerVolume *pvl;
+  Nrrd *ngrad, *ndwi, *ntrue, *nB0;
+  const double *tenAns[2];
+  double *grad, *dwi, *tru, *B0, pos[3], want[7], ww[3], wght, diff, bval = 1000,
+                                                                     kparm[1] = {1.0};
+  unsigned int ii, jj, II, NN, pi, ci, lo[3], hi[3], vi;
+  char *err;
+  int E;
+
+  AIR_UNUSED(argc);
+  AIR_UNUSED(argv);
+  mop = airMopNew();
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  ngrad = nrrdNew();
+  airMopAdd(mop, ngrad, (airMopper)nrrdNuke, airMopAlways);
+  ndwi = nrrdNew();
+  airMopAdd(mop, ndwi, (airMopper)nrrdNuke, airMopAlways);
+  ntrue = nrrdNew();
+  airMopAdd(mop, ntrue, (airMopper)nrrdNuke, airMopAlways);
+  nB0 = nrrdNew();
+  airMopAdd(mop, nB0, (airMopper)nrrdNuke, airMopAlways);
+  NN = SX * SY * SZ;
+  if (nrrdMaybeAlloc_va(ngrad, nrrdTypeDouble, 2, AIR_SIZE_T(3),
+                        AIR_SIZE_T(GRAD_NUM))
+      || nrrdMaybeAlloc_va(ndwi, nrrdTypeDouble, 4, AIR_SIZE_T(GRAD_NUM),
+                           AIR_SIZE_T(SX), AIR_SIZE_T(SY), AIR_SIZE_T(SZ))
+      || nrrdMaybeAlloc_va(ntrue, nrrdTypeDouble, 2, AIR_SIZE_T(7), AIR_SIZE_T(NN))
+      || nrrdMaybeAlloc_va(nB0, nrrdTypeDouble, 1, AIR_SIZE_T(NN))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "trouble allocating:\n%s", err);
+    airMopError(mop);
+    return 1;
+  }
+  nrrdAxisInfoSet_va(ndwi, nrrdAxisInfoSpacing, AIR_NAN, 1.0, 1.0, 1.0);
+  grad = AIR_CAST(double *, ngrad->data);
+  makeGrads(grad);
+  tru = AIR_CAST(double *, ntrue->data);
+  B0 = AIR_CAST(double *, nB0->data);
+  makeTensors(tru, B0);
+  /* noise-free DWIs */
+  dwi = AIR_CAST(double *, ndwi->data);
+  for (II = 0; II < NN; II++) {
+    for (ii = 0; ii < GRAD_NUM; ii++) {
+      dwi[ii + GRAD_NUM * II]
+        = B0[II] * exp(-bval * TEN_T3V_CONTR(tru + 7 * II, grad + 3 * ii));
+    }
+  }
+
+  kind = tenDwiGageKindNew();
+  airMopAdd(mop, kind, (airMopper)tenDwiGageKindNix, airMopAlways);
+  if (tenDwiGageKindSet(kind, 100, 0, bval, 0.0001, ngrad, NULL,
+                        tenEstimate1MethodLLS, tenEstimate2MethodPeled, 42)
+      || tenDwiGageKindFitCacheSet(kind, AIR_TRUE)) {
+    airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+    fprintf(stderr, "trouble setting up DWI kind:\n%s", err);
+    airMopError(mop);
+    return 1;
+  }
+  ctx[0] = gageContextNew();
+  airMopAdd(mop, ctx[0], (airMopper)gageContextNix, airMopAlways);
+  E = 0;
+  if (!E) E |= !(pvl = gagePerVolumeNew(ctx[0], ndwi, kind));
+  if (!E) E |= gagePerVolumeAttach(ctx[0], pvl);
+  if (!E) E |= gageKernelSet(ctx[0], gageKernel00, nrrdKernelTent, kparm);
+  if (!E) E |= gageQueryItemOn(ctx[0], pvl, tenDwiGageTensorLLS);
+  if (!E) E |= gageUpdate(ctx[0]);
+  if (!E) E |= !(ctx[1] = gageContextCopy(ctx[0]));
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "trouble setting up gage:\n%s", err);
+    airMopError(mop);
+    return 1;
+  }
+  airMopAdd(mop, ctx[1], (airMopper)gageContextNix, airMopAlways);
+  for (ci = 0; ci < 2; ci++) {
+    tenAns[ci] = gageAnswerPointer(ctx[ci], ctx[ci]->pvl[0], tenDwiGageTensorLLS);
+  }
+  for (pi = 0; pi < 500; pi++) {
+    ELL_3V_SET(pos, AIR_AFFINE(0, airDrandMT_r(rng), 1, 0, SX - 1),
+               AIR_AFFINE(0, airDrandMT_r(rng), 1, 0, SY - 1),
+               AIR_AFFINE(0, airDrandMT_r(rng), 1, 0, SZ - 1));
+    /* alternate (irregularly) between the contexts */
+    ci = (pi / 3) % 2;
+    if (gageProbe(ctx[ci], pos[0], pos[1], pos[2])) {
+      fprintf(stderr, "trouble probing at (%g,%g,%g): %s\n", pos[0], pos[1], pos[2],
+              ctx[ci]->errStr);
+      airMopError(mop);
+      return 1;
+    }
+    for (ii = 0; ii < 3; ii++) {
+      lo[ii] = AIR_UINT(floor(pos[ii]));
+      ww[ii] = pos[ii] - lo[ii];
+    }
+    hi[0] = AIR_MIN(lo[0] + 1, SX - 1);
+    hi[1] = AIR_MIN(lo[1] + 1, SY - 1);
+    hi[2] = AIR_MIN(lo[2] + 1, SZ - 1);
+    TEN_T_SET(want, 0, 0, 0, 0, 0, 0, 0);
+    for (vi = 0; vi < 8; vi++) {
+      wght = ((vi & 1 ? ww[0] : 1 - ww[0]) * (vi & 2 ? ww[1] : 1 - ww[1])
+              * (vi & 4 ? ww[2] : 1 - ww[2]));
+      II = ((vi & 1 ? hi[0] : lo[0])
+            + SX * ((vi & 2 ? hi[1] : lo[1]) + SY * (vi & 4 ? hi[2] : lo[2])));
+      TEN_T_SCALE_INCR(want, wght, tru + 7 * II);
+    }
+    diff = 0;
+    for (jj = 0; jj < 7; jj++) {
+      diff = AIR_MAX(diff, fabs(want[jj] - tenAns[ci][jj]));
+    }
+    if (diff > 1e-12) {
+      fprintf(stderr,
+              "context %u: tensor at (%g,%g,%g) off from interpolated truth by %g\n",
+              ci, pos[0], pos[1], pos[2], diff);
+      airMopError(mop);
+      return 1;
+    }
+  }
+
+  printf("All ok.\n");
+  airMopOkay(mop);
+  return 0;
+}
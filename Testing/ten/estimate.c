@@ -0,0 +1,221 @@
+/*
+  Teem: Tools to process and visualize scientific data and images
+  Copyright (C) 2009--2019  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/ten.h"
+
+/*
+** Tests:
+** tenEstimateContextNew
+** tenEstimateContextNix
+** tenEstimateGradientsSet
+** tenEstimateThreadNumSet
+** tenEstimate1TensorSingle_d
+** tenEstimate1TensorVolume4D
+**
+** by checking that LLS and WLS estimation of a volume (which is done a
+** block of samples at a time, possibly with multiple threads) gives the same
+** results as estimating each sample on its own, and that these recover the
+** (noise-free) tensors from which the DWIs were made
+*/
+
+#define SX 20
+#define SY 16
+#define SZ 12
+#define GRAD_NUM 13
+
+static const double gradVec[GRAD_NUM][3]
+  = {{0, 0, 0},  {1, 0, 0},  {0, 1, 0},  {0, 0, 1},   {1, 1, 0},
+     {1, -1, 0}, {1, 0, 1},  {1, 0, -1}, {0, 1, 1},   {0, 1, -1},
+     {1, 1, 1},  {1, -1, 1}, {1, 1, -1}};
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  airRandMTState *rng;
+  tenEstimateContext *tec, *tec1;
+  Nrrd *ngrad, *ndwi, *nten, *ntrue, *nB0;
+  double *grad, *dwi, *ten, *tru, *B0, ttmp[7], val[GRAD_NUM], diff, bval = 1000;
+  unsigned int ii, jj, II, NN, method, threadNum, estB0;
+  char *err;
+  int E;
+
+  AIR_UNUSED(argc);
+  AIR_UNUSED(argv);
+  mop = airMopNew();
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  ngrad = nrrdNew();
+  airMopAdd(mop, ngrad, (airMopper)nrrdNuke, airMopAlways);
+  ndwi = nrrdNew();
+  airMopAdd(mop, ndwi, (airMopper)nrrdNuke, airMopAlways);
+  ntrue = nrrdNew();
+  airMopAdd(mop, ntrue, (airMopper)nrrdNuke, airMopAlways);
+  NN = SX * SY * SZ;
+  if (nrrdMaybeAlloc_va(ngrad, nrrdTypeDouble, 2, AIR_SIZE_T(3),
+                        AIR_SIZE_T(GRAD_NUM))
+      || nrrdMaybeAlloc_va(ndwi, nrrdTypeDouble, 4, AIR_SIZE_T(GRAD_NUM),
+                           AIR_SIZE_T(SX), AIR_SIZE_T(SY), AIR_SIZE_T(SZ))
+      || nrrdMaybeAlloc_va(ntrue, nrrdTypeDouble, 2, AIR_SIZE_T(7), AIR_SIZE_T(NN))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "trouble allocating:\n%s", err);
+    airMopError(mop);
+    return 1;
+  }
+  grad = AIR_CAST(double *, ngrad->data);
+  for (ii = 0; ii < GRAD_NUM; ii++) {
+    ELL_3V_COPY(grad + 3 * ii, gradVec[ii]);
+    if (ii) {
+      ELL_3V_NORM(grad + 3 * ii, grad + 3 * ii, diff);
+    }
+  }
+  /* diagonally dominant (so positive-definite) tensors, and noise-free DWIs */
+  dwi = AIR_CAST(double *, ndwi->data);
+  tru = AIR_CAST(double *, ntrue->data);
+  for (II = 0; II < NN; II++) {
+    double *tt = tru + 7 * II, *gg, bb;
+    TEN_T_SET(tt, 1, AIR_AFFINE(0, airDrandMT_r(rng), 1, 0.0005, 0.0015),
+              AIR_AFFINE(0, airDrandMT_r(rng), 1, -0.0002, 0.0002),
+              AIR_AFFINE(0, airDrandMT_r(rng), 1, -0.0002, 0.0002),
+              AIR_AFFINE(0, airDrandMT_r(rng), 1, 0.0005, 0.0015),
+              AIR_AFFINE(0, airDrandMT_r(rng), 1, -0.0002, 0.0002),
+              AIR_AFFINE(0, airDrandMT_r(rng), 1, 0.0005, 0.0015));
+    bb = AIR_AFFINE(0, airDrandMT_r(rng), 1, 500, 1500);
+    for (ii = 0; ii < GRAD_NUM; ii++) {
+      gg = grad + 3 * ii;
+      dwi[ii + GRAD_NUM * II] = bb * exp(-bval * TEN_T3V_CONTR(tt, gg));
+    }
+  }
+
+  for (estB0 = 0; estB0 <= 1; estB0++) {
+    for (method = tenEstimate1MethodLLS; method <= tenEstimate1MethodWLS; method++) {
+      tec1 = tenEstimateContextNew();
+      airMopAdd(mop, tec1, (airMopper)tenEstimateContextNix, airMopAlways);
+      E = 0;
+      if (!E) E |= tenEstimateMethodSet(tec1, method);
+      if (!E) E |= tenEstimateGradientsSet(tec1, ngrad, bval, estB0);
+      if (!E) E |= tenEstimateValueMinSet(tec1, 0.0001);
+      if (!E) E |= tenEstimateThresholdSet(tec1, 100, 0);
+      if (!E) E |= tenEstimateUpdate(tec1);
+      for (threadNum = 1; !E && threadNum <= 3; threadNum += 2) {
+        tec = tenEstimateContextNew();
+        airMopAdd(mop, tec, (airMopper)tenEstimateContextNix, airMopAlways);
+        nten = nrrdNew();
+        airMopAdd(mop, nten, (airMopper)nrrdNuke, airMopAlways);
+        nB0 = NULL;
+        tenEstimateThreadNumSet(tec, threadNum);
+        if (!E) E |= tenEstimateMethodSet(tec, method);
+        if (!E) E |= tenEstimateGradientsSet(tec, ngrad, bval, estB0);
+        if (!E) E |= tenEstimateValueMinSet(tec, 0.0001);
+        if (!E) E |= tenEstimateThresholdSet(tec, 100, 0);
+        if (!E) E |= tenEstimateUpdate(tec);
+        if (!E) E |= tenEstimate1TensorVolume4D(tec, nten, &nB0, NULL, ndwi,
+                                                nrrdTypeDouble);
+        if (E) {
+          break;
+        }
+        airMopAdd(mop, nB0, (airMopper)nrrdNuke, airMopAlways);
+        ten = AIR_CAST(double *, nten->data);
+        B0 = AIR_CAST(double *, nB0->data);
+        for (II = 0; II < NN; II++) {
+          for (ii = 0; ii < GRAD_NUM; ii++) {
+            val[ii] = dwi[ii + GRAD_NUM * II];
+          }
+          if ((E = tenEstimate1TensorSingle_d(tec1, ttmp, val))) {
+            break;
+          }
+          for (jj = 0; jj < 7; jj++) {
+            if (ttmp[jj] != ten[jj + 7 * II]) {
+              fprintf(stderr,
+                      "%s (estB0=%u, %u threads): sample %u ten[%u] %.17g from "
+                      "volume != %.17g from single\n",
+                      airEnumStr(tenEstimate1Method, method), estB0, threadNum, II,
+                      jj, ten[jj + 7 * II], ttmp[jj]);
+              airMopError(mop);
+              return 1;
+            }
+          }
+          if (B0[II] != (estB0 ? tec1->estimatedB0 : tec1->knownB0)) {
+            fprintf(stderr, "%s (estB0=%u, %u threads): sample %u B0 mismatch\n",
+                    airEnumStr(tenEstimate1Method, method), estB0, threadNum, II);
+            airMopError(mop);
+            return 1;
+          }
+          diff = 0;
+          for (jj = 1; jj < 7; jj++) {
+            diff = AIR_MAX(diff, fabs(ttmp[jj] - tru[jj + 7 * II]));
+          }
+          if (diff > 1e-12) {
+            fprintf(stderr,
+                    "%s (estB0=%u): sample %u tensor off from truth by %g\n",
+                    airEnumStr(tenEstimate1Method, method), estB0, II, diff);
+            airMopError(mop);
+            return 1;
+          }
+        }
+      }
+      if (E) {
+        airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+        fprintf(stderr, "trouble estimating:\n%s", err);
+        airMopError(mop);
+        return 1;
+      }
+    }
+  }
+
+  /* with bad values at two samples, estimation fails at the first of them,
+     no matter how many threads, and biff says why */
+  dwi[1 + GRAD_NUM * 1234] = AIR_POS_INF;
+  dwi[1 + GRAD_NUM * 2345] = AIR_POS_INF;
+  for (threadNum = 1; threadNum <= 3; threadNum += 2) {
+    tec = tenEstimateContextNew();
+    airMopAdd(mop, tec, (airMopper)tenEstimateContextNix, airMopAlways);
+    nten = nrrdNew();
+    airMopAdd(mop, nten, (airMopper)nrrdNuke, airMopAlways);
+    tenEstimateThreadNumSet(tec, threadNum);
+    E = 0;
+    if (!E) E |= tenEstimateMethodSet(tec, tenEstimate1MethodLLS);
+    if (!E) E |= tenEstimateGradientsSet(tec, ngrad, bval, AIR_TRUE);
+    if (!E) E |= tenEstimateValueMinSet(tec, 0.0001);
+    if (!E) E |= tenEstimateThresholdSet(tec, 100, 0);
+    if (!E) E |= tenEstimateUpdate(tec);
+    if (E) {
+      airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+      fprintf(stderr, "trouble setting up:\n%s", err);
+      airMopError(mop);
+      return 1;
+    }
+    E = tenEstimate1TensorVolume4D(tec, nten, NULL, NULL, ndwi, nrrdTypeDouble);
+    airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+    if (!(E && strstr(err, "failed at sample 1234")
+          && strstr(err, "non-existent tensor"))) {
+      fprintf(stderr, "%u threads: didn't fail as expected (%d):\n%s", threadNum, E,
+              err);
+      airMopError(mop);
+      return 1;
+    }
+  }
+
+  printf("All ok.\n");
+  airMopOkay(mop);
+  return 0;
+}
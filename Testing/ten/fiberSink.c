@@ -0,0 +1,257 @@
+/*
+  Teem: Tools to process and visualize scientific data and images
+  Copyright (C) 2009--2019  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/ten.h"
+
+/*
+** Tests:
+** tenFiberSinkNew
+** tenFiberSinkNix
+** tenFiberSinkAdd
+** tenFiberSinkFlush
+** tenFiberSinkRead
+** tenFiberMultiTraceSink
+**
+** by checking that fibers streamed out in small chunks (possibly traced
+** with multiple threads) and read back in are the same as the polydata
+** made from all of them at once by tenFiberMultiPolyData, and that the
+** sink's length and stop-reason filtering drops the right fibers
+*/
+
+#define SX 24
+#define SY 24
+#define SZ 6
+#define SEED_NUM 200
+#define CHUNK 7
+
+/* (float) tensors whose principal eigenvector circles around the Z axis */
+static void
+makeTensors(Nrrd *nten) {
+  float *ten, eval[3], evec[9], xx, yy, rr;
+  unsigned int xi, yi, zi;
+
+  ten = AIR_CAST(float *, nten->data);
+  ELL_3V_SET(eval, 0.0015f, 0.0004f, 0.0003f);
+  for (zi = 0; zi < SZ; zi++) {
+    for (yi = 0; yi < SY; yi++) {
+      for (xi = 0; xi < SX; xi++) {
+        xx = AIR_FLOAT(xi - (SX - 1) / 2.0);
+        yy = AIR_FLOAT(yi - (SY - 1) / 2.0);
+        rr = AIR_FLOAT(sqrt(xx * xx + yy * yy));
+        ELL_3V_SET(evec + 0, -yy / rr, xx / rr, 0);
+        ELL_3V_SET(evec + 3, xx / rr, yy / rr, 0);
+        ELL_3V_SET(evec + 6, 0, 0, 1);
+        tenMakeSingle_f(ten, 1, eval, evec);
+        ten += 7;
+      }
+    }
+  }
+}
+
+static int
+samePolyData(const limnPolyData *aa, const limnPolyData *bb, const char *what) {
+  unsigned int ii;
+
+  if (!(aa->xyzwNum == bb->xyzwNum && aa->indxNum == bb->indxNum
+        && aa->primNum == bb->primNum)) {
+    fprintf(stderr, "%s: sizes (%u,%u,%u) != (%u,%u,%u)\n", what, aa->xyzwNum,
+            aa->indxNum, aa->primNum, bb->xyzwNum, bb->indxNum, bb->primNum);
+    return 0;
+  }
+  for (ii = 0; ii < 4 * aa->xyzwNum; ii++) {
+    if (aa->xyzw[ii] != bb->xyzw[ii]) {
+      fprintf(stderr, "%s: xyzw[%u] %g != %g\n", what, ii, aa->xyzw[ii],
+              bb->xyzw[ii]);
+      return 0;
+    }
+  }
+  for (ii = 0; ii < aa->indxNum; ii++) {
+    if (aa->indx[ii] != bb->indx[ii]) {
+      fprintf(stderr, "%s: indx[%u] %u != %u\n", what, ii, aa->indx[ii],
+              bb->indx[ii]);
+      return 0;
+    }
+  }
+  for (ii = 0; ii < aa->primNum; ii++) {
+    if (!(aa->type[ii] == bb->type[ii] && aa->icnt[ii] == bb->icnt[ii])) {
+      fprintf(stderr, "%s: prim[%u] mismatch\n", what, ii);
+      return 0;
+    }
+  }
+  return 1;
+}
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  airRandMTState *rng;
+  Nrrd *nten, *nseed;
+  tenFiberContext *tfx;
+  tenFiberMulti *tfml;
+  tenFiberSingle *tfbs;
+  tenFiberSink *tfsk;
+  limnPolyData *lpldAll, *lpldStream;
+  double *seed, len, lenRange[2] = {0.7, 16};
+  unsigned int ii, threadNum, filter, keepNum[3];
+  FILE *file;
+  char *err;
+  int E;
+
+  AIR_UNUSED(argc);
+  AIR_UNUSED(argv);
+  mop = airMopNew();
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  nten = nrrdNew();
+  airMopAdd(mop, nten, (airMopper)nrrdNuke, airMopAlways);
+  nseed = nrrdNew();
+  airMopAdd(mop, nseed, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_va(nten, nrrdTypeFloat, 4, AIR_SIZE_T(7), AIR_SIZE_T(SX),
+                        AIR_SIZE_T(SY), AIR_SIZE_T(SZ))
+      || nrrdMaybeAlloc_va(nseed, nrrdTypeDouble, 2, AIR_SIZE_T(3),
+                           AIR_SIZE_T(SEED_NUM))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "trouble allocating:\n%s", err);
+    airMopError(mop);
+    return 1;
+  }
+  nrrdAxisInfoSet_va(nten, nrrdAxisInfoSpacing, AIR_NAN, 1.0, 1.0, 1.0);
+  makeTensors(nten);
+  seed = AIR_CAST(double *, nseed->data);
+  for (ii = 0; ii < SEED_NUM; ii++) {
+    ELL_3V_SET(seed + 3 * ii, AIR_AFFINE(0, airDrandMT_r(rng), 1, 1, SX - 2),
+               AIR_AFFINE(0, airDrandMT_r(rng), 1, 1, SY - 2),
+               AIR_AFFINE(0, airDrandMT_r(rng), 1, 1, SZ - 2));
+  }
+
+  tfx = tenFiberContextNew(nten);
+  if (!tfx) {
+    airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+    fprintf(stderr, "trouble making context:\n%s", err);
+    airMopError(mop);
+    return 1;
+  }
+  airMopAdd(mop, tfx, (airMopper)tenFiberContextNix, airMopAlways);
+  E = 0;
+  if (!E) E |= tenFiberTypeSet(tfx, tenFiberTypeEvec0);
+  if (!E) E |= tenFiberKernelSet(tfx, nrrdKernelTent, NULL);
+  if (!E) E |= tenFiberIntgSet(tfx, tenFiberIntgRK4);
+  if (!E) E |= tenFiberParmSet(tfx, tenFiberParmStepSize, 0.1);
+  if (!E) E |= tenFiberParmSet(tfx, tenFiberParmUseIndexSpace, AIR_TRUE);
+  if (!E) E |= tenFiberStopSet(tfx, tenFiberStopLength, 8.0);
+  if (!E) E |= tenFiberUpdate(tfx);
+  tfml = tenFiberMultiNew();
+  airMopAdd(mop, tfml, (airMopper)tenFiberMultiNix, airMopAlways);
+  lpldAll = limnPolyDataNew();
+  airMopAdd(mop, lpldAll, (airMopper)limnPolyDataNix, airMopAlways);
+  if (!E) E |= tenFiberMultiTrace(tfx, tfml, nseed);
+  if (!E) E |= tenFiberMultiPolyData(tfx, lpldAll, tfml);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+    fprintf(stderr, "trouble tracing:\n%s", err);
+    airMopError(mop);
+    return 1;
+  }
+  /* the # fibers that should be kept with no filtering (filter 0),
+     filtering by length (filter 1), and by stop reason (filter 2); the
+     fibers that don't leave the volume have length just over 16, and the
+     ones that do (near its corners) are much shorter */
+  keepNum[0] = lpldAll->primNum;
+  keepNum[1] = keepNum[2] = 0;
+  for (ii = 0; ii < tfml->fiberArr->len; ii++) {
+    tfbs = tfml->fiber + ii;
+    if (tenFiberStopUnknown != tfbs->whyNowhere) {
+      continue;
+    }
+    len = tfbs->halfLen[0] + tfbs->halfLen[1];
+    keepNum[1] += AIR_IN_CL(lenRange[0], len, lenRange[1]);
+    keepNum[2] += (tenFiberStopBounds != tfbs->whyStop[0]
+                   && tenFiberStopBounds != tfbs->whyStop[1]);
+  }
+  for (filter = 1; filter <= 2; filter++) {
+    if (!(keepNum[filter] && keepNum[filter] < keepNum[0])) {
+      fprintf(stderr, "filter %u test is moot: keeping %u of %u fibers\n", filter,
+              keepNum[filter], keepNum[0]);
+      airMopError(mop);
+      return 1;
+    }
+  }
+
+  for (threadNum = 1; threadNum <= 3; threadNum += 2) {
+    for (filter = 0; filter <= 2; filter++) {
+      if (!(file = tmpfile())) {
+        fprintf(stderr, "couldn't open temporary file\n");
+        airMopError(mop);
+        return 1;
+      }
+      airMopAdd(mop, file, (airMopper)airFclose, airMopAlways);
+      lpldStream = limnPolyDataNew();
+      airMopAdd(mop, lpldStream, (airMopper)limnPolyDataNix, airMopAlways);
+      E = 0;
+      if (!E) E |= tenFiberParmSet(tfx, tenFiberParmThreadNum, threadNum);
+      if (!E) E |= !(tfsk = tenFiberSinkNew(file, CHUNK));
+      if (E) {
+        break;
+      }
+      airMopAdd(mop, tfsk, (airMopper)tenFiberSinkNix, airMopAlways);
+      if (1 == filter) {
+        ELL_2V_COPY(tfsk->lenRange, lenRange);
+      } else if (2 == filter) {
+        tfsk->dropStop = (1 << tenFiberStopBounds);
+      }
+      if (!E) E |= tenFiberMultiTraceSink(tfx, tfsk, nseed);
+      if (!E) rewind(file);
+      if (!E) E |= tenFiberSinkRead(lpldStream, file);
+      if (E) {
+        break;
+      }
+      if (tfsk->fiberAdded != tfml->fiberArr->len
+          || tfsk->fiberWritten != lpldStream->primNum
+          || tfsk->fiberWritten != keepNum[filter]
+          || tfsk->chunkWritten != (tfsk->fiberWritten + CHUNK - 1) / CHUNK) {
+        fprintf(stderr,
+                "(%u threads, filter %u) added %u, wrote %u fibers in %u chunks, "
+                "read %u\n",
+                threadNum, filter, tfsk->fiberAdded, tfsk->fiberWritten,
+                tfsk->chunkWritten, lpldStream->primNum);
+        airMopError(mop);
+        return 1;
+      }
+      if (!filter && !samePolyData(lpldAll, lpldStream, "streamed")) {
+        fprintf(stderr, "(with %u threads)\n", threadNum);
+        airMopError(mop);
+        return 1;
+      }
+    }
+    if (E) {
+      airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+      fprintf(stderr, "trouble streaming (%u threads):\n%s", threadNum, err);
+      airMopError(mop);
+      return 1;
+    }
+  }
+
+  printf("All ok.\n");
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,172 @@
+/*
+  Teem: Tools to process and visualize scientific data and images
+  Copyright (C) 2009--2019  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/ten.h"
+
+/*
+** Tests:
+** tenGageEigenVolume
+** tenGageEigenVolumeSet
+**
+** by checking that tenGageKind's Eval and Evec answers, when interpolated
+** from the volume of per-voxel eigensystems, are exactly the solved ones
+** at voxel centers, and elsewhere are orthonormal and close to them
+*/
+
+#define SX 10
+#define SY 6
+#define SZ 8
+
+/*
+** (float) tensors with distinct eigenvalues (the largest varying with Y),
+** whose eigenvectors turn around the Y axis with X and Z
+*/
+static void
+makeTensors(Nrrd *nten) {
+  float *ten, eval[3], evec[9], cc, ss;
+  unsigned int xi, yi, zi;
+
+  ten = AIR_CAST(float *, nten->data);
+  for (zi = 0; zi < SZ; zi++) {
+    for (yi = 0; yi < SY; yi++) {
+      for (xi = 0; xi < SX; xi++) {
+        ELL_3V_SET(eval, 0.0012f + 0.00005f * yi, 0.0007f, 0.0003f);
+        cc = AIR_FLOAT(cos(0.12 * xi + 0.2 * zi));
+        ss = AIR_FLOAT(sin(0.12 * xi + 0.2 * zi));
+        ELL_3V_SET(evec + 0, cc, 0, ss);
+        ELL_3V_SET(evec + 3, 0, 1, 0);
+        ELL_3V_SET(evec + 6, -ss, 0, cc);
+        tenMakeSingle_f(ten, 1, eval, evec);
+        ten += 7;
+      }
+    }
+  }
+}
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  airRandMTState *rng;
+  Nrrd *nten, *neig, *nbad;
+  gageContext *ctx;
+  gagePerVolume *pvl;
+  const double *evalAns, *evecAns;
+  double pos[3], eval[2][3], evec[2][9], dot, kparm[1] = {1.0};
+  unsigned int ii, vi, pi, ui;
+  char *err;
+  int E;
+
+  AIR_UNUSED(argc);
+  AIR_UNUSED(argv);
+  mop = airMopNew();
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  nten = nrrdNew();
+  airMopAdd(mop, nten, (airMopper)nrrdNuke, airMopAlways);
+  neig = nrrdNew();
+  airMopAdd(mop, neig, (airMopper)nrrdNuke, airMopAlways);
+  nbad = nrrdNew();
+  airMopAdd(mop, nbad, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_va(nten, nrrdTypeFloat, 4, AIR_SIZE_T(7), AIR_SIZE_T(SX),
+                        AIR_SIZE_T(SY), AIR_SIZE_T(SZ))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "trouble allocating:\n%s", err);
+    airMopError(mop);
+    return 1;
+  }
+  nrrdAxisInfoSet_va(nten, nrrdAxisInfoSpacing, AIR_NAN, 1.0, 1.0, 1.0);
+  makeTensors(nten);
+  ctx = gageContextNew();
+  airMopAdd(mop, ctx, (airMopper)gageContextNix, airMopAlways);
+  E = 0;
+  if (!E) E |= !(pvl = gagePerVolumeNew(ctx, nten, tenGageKind));
+  if (!E) E |= gagePerVolumeAttach(ctx, pvl);
+  if (!E) E |= gageKernelSet(ctx, gageKernel00, nrrdKernelTent, kparm);
+  if (!E) E |= gageQueryItemOn(ctx, pvl, tenGageEvec);
+  if (!E) E |= gageUpdate(ctx);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "trouble setting up gage:\n%s", err);
+    airMopError(mop);
+    return 1;
+  }
+  if (tenGageEigenVolume(neig, nten)) {
+    airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+    fprintf(stderr, "trouble making eigensystem volume:\n%s", err);
+    airMopError(mop);
+    return 1;
+  }
+  if (nrrdSlice(nbad, neig, 3, 0) || !tenGageEigenVolumeSet(pvl, nbad)) {
+    fprintf(stderr, "wrongly accepted mis-sized eigensystem volume\n");
+    airMopError(mop);
+    return 1;
+  }
+  airFree(biffGetDone(TEN));
+  evalAns = gageAnswerPointer(ctx, pvl, tenGageEval);
+  evecAns = gageAnswerPointer(ctx, pvl, tenGageEvec);
+  /* the first 10 positions are voxel centers */
+  for (pi = 0; pi < 200; pi++) {
+    ELL_3V_SET(pos, AIR_AFFINE(0, airDrandMT_r(rng), 1, 1, SX - 2),
+               AIR_AFFINE(0, airDrandMT_r(rng), 1, 1, SY - 2),
+               AIR_AFFINE(0, airDrandMT_r(rng), 1, 0, SZ - 1));
+    if (pi < 10) {
+      ELL_3V_SET(pos, floor(pos[0]), floor(pos[1]), floor(pos[2]));
+    }
+    for (ui = 0; ui < 2; ui++) {
+      if (tenGageEigenVolumeSet(pvl, ui ? neig : NULL)
+          || gageProbe(ctx, pos[0], pos[1], pos[2])) {
+        airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+        fprintf(stderr, "trouble probing at (%g,%g,%g):\n%s%s\n", pos[0], pos[1],
+                pos[2], err, ctx->errStr);
+        airMopError(mop);
+        return 1;
+      }
+      ELL_3V_COPY(eval[ui], evalAns);
+      ELL_3M_COPY(evec[ui], evecAns);
+    }
+    for (vi = 0; vi < 3; vi++) {
+      for (ii = 0; ii < 3; ii++) {
+        dot = ELL_3V_DOT(evec[1] + 3 * vi, evec[1] + 3 * ii);
+        if (!(fabs(dot - (vi == ii)) < 1e-12)) {
+          fprintf(stderr, "interpolated evec%u . evec%u = %g at (%g,%g,%g)\n", vi, ii,
+                  dot, pos[0], pos[1], pos[2]);
+          airMopError(mop);
+          return 1;
+        }
+      }
+      dot = fabs(ELL_3V_DOT(evec[0] + 3 * vi, evec[1] + 3 * vi));
+      if (pi < 10 ? (eval[0][vi] != eval[1][vi] || 1 - dot > 1e-12)
+                  : (fabs(eval[0][vi] - eval[1][vi]) > 1e-4 || dot < 0.95)) {
+        fprintf(stderr,
+                "interpolated eval%u %g, |evec%u.solved| %g; solved eval %g "
+                "at (%g,%g,%g)\n",
+                vi, eval[1][vi], vi, dot, eval[0][vi], pos[0], pos[1], pos[2]);
+        airMopError(mop);
+        return 1;
+      }
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
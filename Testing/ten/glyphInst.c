@@ -0,0 +1,218 @@
+/*
+  Teem: Tools to process and visualize scientific data and images
+  Copyright (C) 2009--2019  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/ten.h"
+
+/*
+** Tests:
+** tenGlyphInstGen
+** tenGlyphInstPolyData
+**
+** by checking that the instanced glyphs don't depend on the number of
+** threads, and that each glyph has (nearly) the same shape, orientation,
+** and color as the corresponding glyph from tenGlyphGen
+*/
+
+#define SX 7
+#define SY 6
+#define SZ 5
+
+/*
+** signature of the shape of a glyph: with the verts mapped back to glyph
+** space by inverse transform ixf, sig[k] is the largest distance of a
+** vertex from axis k.  The verts are vidx[0..num-1] of lobj, or (if lobj
+** is NULL) num (homogeneous) xyzw verts
+*/
+static void
+shapeSig(double sig[3], const double ixf[16], const limnObject *lobj,
+         const unsigned int *vidx, const float *xyzw, unsigned int num) {
+  const float *vv;
+  double ww[4], gg[4], ll;
+  unsigned int ii, kk;
+
+  ELL_3V_SET(sig, 0, 0, 0);
+  for (ii = 0; ii < num; ii++) {
+    vv = lobj ? lobj->vert[vidx[ii]].world : xyzw + 4 * ii;
+    ELL_4V_COPY(ww, vv);
+    ELL_4MV_MUL(gg, ixf, ww);
+    ELL_3V_SCALE(gg, 1 / gg[3], gg);
+    ll = ELL_3V_DOT(gg, gg);
+    for (kk = 0; kk < 3; kk++) {
+      sig[kk] = AIR_MAX(sig[kk], sqrt(ll - gg[kk] * gg[kk]));
+    }
+  }
+}
+
+int
+main(int argc, const char **argv) {
+  static const int gtype[3]
+    = {tenGlyphTypeBox, tenGlyphTypeCylinder, tenGlyphTypeSuperquad};
+  static const double tol[3] = {1e-4, 1e-4, 0.05};
+  airArray *mop;
+  airRandMTState *rng;
+  Nrrd *nten;
+  tenGlyphParm *parm;
+  tenGlyphInst *gin[2];
+  limnPolyData *pld[2];
+  limnObject *lobj;
+  const limnPart *part;
+  float *tt;
+  double xf[16], ixf[16], asig[3], bsig[3], diff;
+  unsigned int ii, ti, gi, vo, NN;
+  char *err;
+
+  AIR_UNUSED(argc);
+  AIR_UNUSED(argv);
+  mop = airMopNew();
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  nten = nrrdNew();
+  airMopAdd(mop, nten, (airMopper)nrrdNuke, airMopAlways);
+  parm = tenGlyphParmNew();
+  airMopAdd(mop, parm, (airMopper)tenGlyphParmNix, airMopAlways);
+  for (ti = 0; ti < 2; ti++) {
+    gin[ti] = tenGlyphInstNew();
+    airMopAdd(mop, gin[ti], (airMopper)tenGlyphInstNix, airMopAlways);
+    pld[ti] = limnPolyDataNew();
+    airMopAdd(mop, pld[ti], (airMopper)limnPolyDataNix, airMopAlways);
+  }
+  NN = SX * SY * SZ;
+  if (nrrdMaybeAlloc_va(nten, nrrdTypeFloat, 4, AIR_SIZE_T(7), AIR_SIZE_T(SX),
+                        AIR_SIZE_T(SY), AIR_SIZE_T(SZ))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "trouble allocating:\n%s", err);
+    airMopError(mop);
+    return 1;
+  }
+  nrrdAxisInfoSet_va(nten, nrrdAxisInfoSpacing, AIR_NAN, 1.0, 1.0, 1.0);
+  tt = AIR_CAST(float *, nten->data);
+  for (ii = 0; ii < NN; ii++) {
+    /* some (low-confidence) samples get no glyph, and the tensors are
+       anisotropic enough for the glyph shapes to differ */
+    TEN_T_SET(tt + 7 * ii, airDrandMT_r(rng) < 0.8,
+              AIR_AFFINE(0, airDrandMT_r(rng), 1, 0.1, 1.5),
+              AIR_AFFINE(0, airDrandMT_r(rng), 1, -0.05, 0.05),
+              AIR_AFFINE(0, airDrandMT_r(rng), 1, -0.05, 0.05),
+              AIR_AFFINE(0, airDrandMT_r(rng), 1, 0.1, 1.5),
+              AIR_AFFINE(0, airDrandMT_r(rng), 1, -0.05, 0.05),
+              AIR_AFFINE(0, airDrandMT_r(rng), 1, 0.1, 1.5));
+  }
+  parm->anisoType = tenAniso_FA;
+  parm->colAnisoType = tenAniso_FA;
+  parm->confThresh = 0.5;
+  parm->anisoThresh = 0.0;
+  parm->glyphScale = 0.3f;
+  parm->facetRes = 16;
+  parm->shapeRes = 0;
+
+  for (gi = 0; gi < 3; gi++) {
+    parm->glyphType = gtype[gi];
+    lobj = limnObjectNew(100, AIR_TRUE);
+    airMopAdd(mop, lobj, (airMopper)limnObjectNix, airMopAlways);
+    if (tenGlyphGen(lobj, NULL, parm, nten, NULL, NULL)) {
+      airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+      fprintf(stderr, "trouble with tenGlyphGen:\n%s", err);
+      airMopError(mop);
+      return 1;
+    }
+    for (ti = 0; ti < 2; ti++) {
+      parm->threadNum = ti ? 3 : 1;
+      if (tenGlyphInstGen(gin[ti], parm, nten, NULL)
+          || tenGlyphInstPolyData(pld[ti], gin[ti], parm->threadNum)) {
+        airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+        fprintf(stderr, "trouble with %u threads:\n%s", parm->threadNum, err);
+        airMopError(mop);
+        return 1;
+      }
+    }
+    if (!(gin[0]->glyphNum == gin[1]->glyphNum && gin[0]->baseNum == gin[1]->baseNum
+          && pld[0]->xyzwNum == pld[1]->xyzwNum && pld[0]->indxNum == pld[1]->indxNum
+          && !memcmp(gin[0]->xform, gin[1]->xform,
+                     16 * gin[0]->glyphNum * sizeof(float))
+          && !memcmp(gin[0]->rgba, gin[1]->rgba, 4 * gin[0]->glyphNum)
+          && !memcmp(pld[0]->xyzw, pld[1]->xyzw, 4 * pld[0]->xyzwNum * sizeof(float))
+          && !memcmp(pld[0]->indx, pld[1]->indx,
+                     pld[0]->indxNum * sizeof(unsigned int)))) {
+      fprintf(stderr, "glyph type %d: results differ with 1 and 3 threads\n",
+              gtype[gi]);
+      airMopError(mop);
+      return 1;
+    }
+    if (!(gin[0]->glyphNum == lobj->partNum && gin[0]->glyphNum < NN
+          && gin[0]->baseNum
+               == (2 == gi ? gin[0]->glyphNum : AIR_MIN(gi + 1, 2)))) {
+      fprintf(stderr, "glyph type %d: %u glyphs (%u bases), but %u limnObject parts\n",
+              gtype[gi], gin[0]->glyphNum, gin[0]->baseNum, lobj->partNum);
+      airMopError(mop);
+      return 1;
+    }
+    vo = 0;
+    for (ii = 0; ii < gin[0]->glyphNum; ii++) {
+      part = lobj->part[ii];
+      ELL_4M_COPY(xf, gin[0]->xform + 16 * ii);
+      ell_4m_inv_d(ixf, xf);
+      shapeSig(asig, ixf, lobj, part->vertIdx, NULL, part->vertIdxNum);
+      ti = gin[0]->base[gin[0]->baseIdx[ii]]->xyzwNum;
+      shapeSig(bsig, ixf, NULL, NULL, pld[0]->xyzw + 4 * vo, ti);
+      vo += ti;
+      diff = ELL_3V_DIST(asig, bsig);
+      if (diff > tol[gi]) {
+        fprintf(stderr, "glyph type %d: glyph %u shape (%g,%g,%g) != (%g,%g,%g)\n",
+                gtype[gi], ii, bsig[0], bsig[1], bsig[2], asig[0], asig[1], asig[2]);
+        airMopError(mop);
+        return 1;
+      }
+      diff = 0;
+      for (ti = 0; ti < 3; ti++) {
+        diff = AIR_MAX(diff, fabs(lobj->vert[part->vertIdx[0]].rgba[ti]
+                                  - gin[0]->rgba[ti + 4 * ii] / 255.0));
+      }
+      if (diff > 1.0 / 255) {
+        fprintf(stderr, "glyph type %d: glyph %u color off by %g\n", gtype[gi], ii,
+                diff);
+        airMopError(mop);
+        return 1;
+      }
+    }
+  }
+
+  /* quantizing superquadric shape gives fewer base meshes */
+  parm->shapeRes = 10;
+  if (tenGlyphInstGen(gin[0], parm, nten, NULL)) {
+    airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+    fprintf(stderr, "trouble with shapeRes:\n%s", err);
+    airMopError(mop);
+    return 1;
+  }
+  if (!(gin[0]->glyphNum == gin[1]->glyphNum && gin[0]->baseNum < gin[1]->baseNum
+        && gin[0]->baseNum <= 11 * 11)) {
+    fprintf(stderr, "shapeRes 10: %u glyphs with %u bases (vs %u)\n", gin[0]->glyphNum,
+            gin[0]->baseNum, gin[1]->baseNum);
+    airMopError(mop);
+    return 1;
+  }
+
+  printf("All ok.\n");
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,155 @@
+/*
+  Teem: Tools to process and visualize scientific data and images
+  Copyright (C) 2009--2019  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/ten.h"
+
+/*
+** Tests:
+** tenModelSimulate
+** tenModelSqeFit
+**
+** by checking that fitting a (noisy) ball-and-stick volume from several
+** random starts, with and without warm starts, gives exactly the same
+** parameters and errors with one thread as with several
+*/
+
+#define SX 7
+#define SY 6
+#define GRAD_NUM 12
+#define THREAD_NUM 3
+
+static const double gradVec[GRAD_NUM][3]
+  = {{1, 0, 0},  {0, 1, 0},  {0, 0, 1},  {1, 1, 0}, {1, -1, 0}, {1, 0, 1},
+     {1, 0, -1}, {0, 1, 1},  {0, 1, -1}, {1, 1, 1}, {1, -1, 1}, {1, 1, -1}};
+
+/* fits ndwi with threadNum threads, and an rng seeded the same every time */
+static int /* Biff: 1 */
+fitVolume(Nrrd *nfit, Nrrd **nsqeP, const tenExperSpec *espec, const Nrrd *ndwi,
+          int warmStart, unsigned int threadNum) {
+  static const char me[] = "fitVolume";
+  airRandMTState *rng;
+  int ret;
+
+  rng = airRandMTStateNew(42);
+  ret = tenModelSqeFit(nfit, nsqeP, NULL, NULL, tenModelBall1Stick, espec, ndwi,
+                       AIR_FALSE /* knownB0 */, AIR_TRUE /* saveB0 */, nrrdTypeDouble,
+                       3, 100, 3 /* starts */, warmStart, 0.0001, rng, threadNum,
+                       AIR_FALSE);
+  airRandMTStateNix(rng);
+  if (ret) {
+    biffAddf(TEN, "%s: trouble with %u threads", me, threadNum);
+    return 1;
+  }
+  return 0;
+}
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  airRandMTState *rng;
+  tenExperSpec *espec;
+  Nrrd *nparm, *ndwi, *nfit[2], *nsqe[2];
+  double grad[3 * GRAD_NUM], *parm, *dwi, ang;
+  unsigned int ii, xi, yi, ws, NN;
+  char *err;
+
+  AIR_UNUSED(argc);
+  AIR_UNUSED(argv);
+  mop = airMopNew();
+  for (ii = 0; ii < GRAD_NUM; ii++) {
+    ELL_3V_NORM(grad + 3 * ii, gradVec[ii], ang);
+  }
+  espec = tenExperSpecNew();
+  airMopAdd(mop, espec, (airMopper)tenExperSpecNix, airMopAlways);
+  nparm = nrrdNew();
+  airMopAdd(mop, nparm, (airMopper)nrrdNuke, airMopAlways);
+  ndwi = nrrdNew();
+  airMopAdd(mop, ndwi, (airMopper)nrrdNuke, airMopAlways);
+  for (ii = 0; ii < 2; ii++) {
+    nfit[ii] = nrrdNew();
+    airMopAdd(mop, nfit[ii], (airMopper)nrrdNuke, airMopAlways);
+    nsqe[ii] = nrrdNew();
+    airMopAdd(mop, nsqe[ii], (airMopper)nrrdNuke, airMopAlways);
+  }
+  if (nrrdMaybeAlloc_va(nparm, nrrdTypeDouble, 3, AIR_SIZE_T(7), AIR_SIZE_T(SX),
+                        AIR_SIZE_T(SY))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "trouble allocating:\n%s", err);
+    airMopError(mop);
+    return 1;
+  }
+  /* a stick turning in the XY plane, in a ball of varying fraction */
+  parm = AIR_CAST(double *, nparm->data);
+  for (yi = 0; yi < SY; yi++) {
+    for (xi = 0; xi < SX; xi++) {
+      ang = AIR_AFFINE(0, xi, SX, 0, AIR_PI);
+      ELL_4V_SET(parm, 100, 0.001, AIR_AFFINE(0, yi, SY - 1, 0.3, 0.8), 0.002);
+      ELL_3V_SET(parm + 4, cos(ang), sin(ang), 0);
+      parm += 7;
+    }
+  }
+  if (tenExperSpecGradSingleBValSet(espec, AIR_TRUE, 1000, grad, GRAD_NUM)
+      || tenModelSimulate(ndwi, nrrdTypeDouble, espec, tenModelBall1Stick, NULL, nparm,
+                          AIR_FALSE)) {
+    airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+    fprintf(stderr, "trouble simulating:\n%s", err);
+    airMopError(mop);
+    return 1;
+  }
+  /* some noise, so that the random starts lead to different fits */
+  rng = airRandMTStateNew(7);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  dwi = AIR_CAST(double *, ndwi->data);
+  NN = AIR_UINT(nrrdElementNumber(ndwi));
+  for (ii = 0; ii < NN; ii++) {
+    dwi[ii] += 2 * airDrandMT_r(rng) - 1;
+  }
+
+  for (ws = 0; ws < 2; ws++) {
+    if (fitVolume(nfit[0], &nsqe[0], espec, ndwi, ws, 1)) {
+      airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+      fprintf(stderr, "trouble fitting:\n%s", err);
+      airMopError(mop);
+      return 1;
+    }
+    if (fitVolume(nfit[1], &nsqe[1], espec, ndwi, ws, THREAD_NUM)) {
+      airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+      fprintf(stderr, "trouble fitting:\n%s", err);
+      airMopError(mop);
+      return 1;
+    }
+    if (memcmp(nfit[0]->data, nfit[1]->data, nrrdElementNumber(nfit[0])
+                                                 * nrrdElementSize(nfit[0]))
+        || memcmp(nsqe[0]->data, nsqe[1]->data,
+                  nrrdElementNumber(nsqe[0]) * nrrdElementSize(nsqe[0]))) {
+      fprintf(stderr, "warmStart %u: fit with 1 thread differs from fit with %u\n",
+              ws, THREAD_NUM);
+      airMopError(mop);
+      return 1;
+    }
+  }
+
+  printf("All ok.\n");
+  airMopOkay(mop);
+  return 0;
+}
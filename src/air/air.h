@@ -293,6 +293,37 @@ AIR_EXPORT int airHeapRemove(airHeap *h, unsigned int ai);
 AIR_EXPORT int airHeapUpdate(airHeap *h, unsigned int ai, double newKey,
                              const void *newData);
 
+/* hashGrid.c: uniform grid of cubical cells covering all of 3-D space,
+ * hashed into buckets, for finding which points are near each other. The
+ * points in each bucket are listed contiguously in pointIdx */
+
+/* max # threads that airHashGridBuild will use */
+#define AIR_HASH_GRID_THREAD_MAXNUM 512
+
+typedef struct {
+  double cellSize;           /* edge length of cells */
+  unsigned int bucketNum,    /* # buckets (a power of 2) in last build */
+    pointNum,                /* # points in last build */
+    *bucketStart,            /* [bucketNum]: where bucket's points start in pointIdx */
+    *bucketCount,            /* [bucketNum]: # points in bucket */
+    *pointIdx,               /* [pointNum]: point indices, sorted by bucket */
+    *pointBucket,            /* [pointNum]: which bucket each point is in */
+    bucketAlloc, pointAlloc, /* allocated lengths of above arrays */
+    *threadCount,            /* per-thread counts, for building */
+    threadCountAlloc;        /* allocated length of threadCount */
+} airHashGrid;
+
+AIR_EXPORT airHashGrid *airHashGridNew(double cellSize);
+AIR_EXPORT airHashGrid *airHashGridNix(airHashGrid *hg);
+AIR_EXPORT void airHashGridCell(const airHashGrid *hg, int cell[3], const double pos[3]);
+AIR_EXPORT unsigned int airHashGridBucket(const airHashGrid *hg, const double pos[3]);
+AIR_EXPORT unsigned int airHashGridNeighborBuckets(const airHashGrid *hg,
+                                                   unsigned int bucket[27],
+                                                   const int cell[3]);
+AIR_EXPORT int airHashGridBuild(airHashGrid *hg, const double *pos,
+                                unsigned int posStride, unsigned int pointNum,
+                                unsigned int threadNum);
+
 /* threadAir.c: simplistic wrapper functions for multi-threading  */
 /*
 ********  airThreadCapable
@@ -325,6 +356,7 @@ typedef struct {
 
 AIR_EXPORT airThread *airThreadNew(void);
 AIR_EXPORT int airThreadStart(airThread *thread, void *(*threadBody)(void *), void *arg);
+/* retP can be NULL if the thread's return value isn't needed */
 AIR_EXPORT int airThreadJoin(airThread *thread, void **retP);
 AIR_EXPORT airThread *airThreadNix(airThread *thread);
 
@@ -333,6 +365,13 @@ AIR_EXPORT int airThreadMutexLock(airThreadMutex *mutex);
 AIR_EXPORT int airThreadMutexUnlock(airThreadMutex *mutex);
 AIR_EXPORT airThreadMutex *airThreadMutexNix(airThreadMutex *mutex);
 
+/* atomically: { ret = *val; *val += incr; return ret; } */
+AIR_EXPORT unsigned int airThreadAtomicUIntAdd(volatile unsigned int *val,
+                                               unsigned int incr);
+/* how many of jobNum jobs each of threadNum threads should claim at a time
+   (with airThreadAtomicUIntAdd) to balance the load with few fetches */
+AIR_EXPORT unsigned int airThreadFetchChunk(unsigned int jobNum, unsigned int threadNum);
+
 AIR_EXPORT airThreadCond *airThreadCondNew(void);
 AIR_EXPORT int airThreadCondWait(airThreadCond *cond, airThreadMutex *mutex);
 AIR_EXPORT int airThreadCondSignal(airThreadCond *cond);
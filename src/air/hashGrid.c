@@ -0,0 +1,324 @@
+/*
+  Teem: Tools to process and visualize scientific data and images
+  Copyright (C) 2009--2023  University of Chicago
+  Copyright (C) 2005--2008  Gordon Kindlmann
+  Copyright (C) 1998--2004  University of Utah
+
+  This library is free software; you can redistribute it and/or modify it under the terms
+  of the GNU Lesser General Public License (LGPL) as published by the Free Software
+  Foundation; either version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also include exceptions to
+  the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+  PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with
+  this library; if not, write to Free Software Foundation, Inc., 51 Franklin Street,
+  Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "air.h"
+
+/*
+** the cell coordinates are clamped to this, so that (int) casts are safe
+*/
+#define _AIR_HASH_GRID_COORD_MAX 1000000000.0
+
+/* spreads out the low 10 bits of vv so that there are two 0 bits
+   between each of them */
+static unsigned int
+_airHashGridSpread(unsigned int vv) {
+
+  vv &= 0x3ffu;
+  vv = (vv | (vv << 16)) & 0x030000ffu;
+  vv = (vv | (vv << 8)) & 0x0300f00fu;
+  vv = (vv | (vv << 4)) & 0x030c30c3u;
+  vv = (vv | (vv << 2)) & 0x09249249u;
+  return vv;
+}
+
+/*
+** the key of a cell is the Morton code (bit interleaving) of the low bits
+** of its coordinates, so the lowest bits of the key, which pick the bucket,
+** wrap around periodically in all three directions.  Nearby cells are thus
+** usually in nearby buckets, which keeps bucket order spatially coherent
+*/
+static unsigned int
+_airHashGridKey(int xi, int yi, int zi) {
+
+  return (_airHashGridSpread(AIR_UINT(xi)) | (_airHashGridSpread(AIR_UINT(yi)) << 1)
+          | (_airHashGridSpread(AIR_UINT(zi)) << 2));
+}
+
+/*
+******** airHashGridCell
+**
+** sets in cell[] the integer coordinates of the cell containing pos
+*/
+void
+airHashGridCell(const airHashGrid *hg, int cell[3], const double pos[3]) {
+  unsigned int ci;
+  double cc;
+
+  for (ci = 0; ci < 3; ci++) {
+    cc = floor(pos[ci] / hg->cellSize);
+    /* also makes NaN into something */
+    cc = AIR_CLAMP(-_AIR_HASH_GRID_COORD_MAX, cc, _AIR_HASH_GRID_COORD_MAX);
+    cell[ci] = AIR_EXISTS(cc) ? (int)cc : 0;
+  }
+}
+
+/*
+******** airHashGridNew
+**
+** creates an empty hash grid with cubical cells of the given edge length;
+** airHashGridBuild() must be called before the grid is useful.  A
+** cellSize of AIR_POS_INF puts all points in the same cell. Returns
+** NULL if cellSize isn't positive, or on allocation failure.
+*/
+airHashGrid *
+airHashGridNew(double cellSize) {
+  airHashGrid *hg;
+
+  if (!(cellSize > 0)) {
+    return NULL;
+  }
+  hg = AIR_CALLOC(1, airHashGrid);
+  if (hg) {
+    hg->cellSize = cellSize;
+    hg->bucketNum = 0;
+    hg->pointNum = 0;
+    hg->bucketStart = NULL;
+    hg->bucketCount = NULL;
+    hg->pointIdx = NULL;
+    hg->pointBucket = NULL;
+    hg->bucketAlloc = 0;
+    hg->pointAlloc = 0;
+    hg->threadCount = NULL;
+    hg->threadCountAlloc = 0;
+  }
+  return hg;
+}
+
+airHashGrid *
+airHashGridNix(airHashGrid *hg) {
+
+  if (hg) {
+    airFree(hg->bucketStart);
+    airFree(hg->bucketCount);
+    airFree(hg->pointIdx);
+    airFree(hg->pointBucket);
+    airFree(hg->threadCount);
+    airFree(hg);
+  }
+  return NULL;
+}
+
+/*
+******** airHashGridBucket
+**
+** returns the index of the bucket that holds the cell containing pos
+*/
+unsigned int
+airHashGridBucket(const airHashGrid *hg, const double pos[3]) {
+  int cell[3];
+
+  airHashGridCell(hg, cell, pos);
+  return _airHashGridKey(cell[0], cell[1], cell[2]) & (hg->bucketNum - 1);
+}
+
+/*
+******** airHashGridNeighborBuckets
+**
+** sets in bucket[] the indices of the buckets holding the 3x3x3 cells
+** around (and including) the given cell, with each bucket listed
+** once, even if more than one of these cells hash to it.  Returns how many
+** buckets were set.  As long as two points are no further apart than
+** cellSize, each is in one of the other's neighbor buckets.  Buckets can
+** also hold points from unrelated cells, so the caller still needs to
+** check the distance to the points in them.
+*/
+unsigned int
+airHashGridNeighborBuckets(const airHashGrid *hg, unsigned int bucket[27],
+                           const int cell[3]) {
+  int xi, yi, zi;
+  unsigned int num, bb, ii;
+
+  num = 0;
+  for (zi = -1; zi <= 1; zi++) {
+    for (yi = -1; yi <= 1; yi++) {
+      for (xi = -1; xi <= 1; xi++) {
+        bb = (_airHashGridKey(cell[0] + xi, cell[1] + yi, cell[2] + zi)
+              & (hg->bucketNum - 1));
+        for (ii = 0; ii < num; ii++) {
+          if (bb == bucket[ii]) {
+            break;
+          }
+        }
+        if (ii == num) {
+          bucket[num++] = bb;
+        }
+      }
+    }
+  }
+  return num;
+}
+
+/* what each thread of airHashGridBuild needs to know */
+typedef struct {
+  airHashGrid *hg;
+  const double *pos;
+  unsigned int posStride, lo, hi, /* this thread does points [lo,hi) */
+    *count;                       /* bucketNum counters for this thread */
+  int scatter;                    /* else counting */
+} _airHashGridPart;
+
+static void *
+_airHashGridPartDo(void *_part) {
+  _airHashGridPart *part;
+  airHashGrid *hg;
+  unsigned int pi, bb;
+
+  part = (_airHashGridPart *)_part;
+  hg = part->hg;
+  if (!part->scatter) {
+    memset(part->count, 0, hg->bucketNum * sizeof(unsigned int));
+    for (pi = part->lo; pi < part->hi; pi++) {
+      bb = airHashGridBucket(hg, part->pos + AIR_SIZE_T(pi) * part->posStride);
+      hg->pointBucket[pi] = bb;
+      part->count[bb] += 1;
+    }
+  } else {
+    /* count[] is now where this thread's next point in each bucket goes */
+    for (pi = part->lo; pi < part->hi; pi++) {
+      hg->pointIdx[part->count[hg->pointBucket[pi]]++] = pi;
+    }
+  }
+  return _part;
+}
+
+/*
+******** airHashGridBuild
+**
+** puts pointNum points into the grid, replacing whatever was there: point
+** pi is at pos + pi*posStride (pos[0,1,2] of each point are its x,y,z).
+** This is a counting sort of the points by bucket: with threadNum > 1
+** (and multi-threading available) each thread counts and then places a
+** contiguous range of points, and the result is the same as with one
+** thread: within a bucket, points are in increasing order of index.
+**
+** The number of buckets is the smallest power of two that is at least
+** pointNum, so memory use depends only on the number of points, not on
+** how far apart they are.
+**
+** Returns non-zero on allocation or threading error.
+*/
+int
+airHashGridBuild(airHashGrid *hg, const double *pos, unsigned int posStride,
+                 unsigned int pointNum, unsigned int threadNum) {
+  _airHashGridPart part[AIR_HASH_GRID_THREAD_MAXNUM];
+  airThread *thread[AIR_HASH_GRID_THREAD_MAXNUM];
+  unsigned int ti, bi, bucketNum, run, tmp, started;
+  int phase, E;
+
+  if (!(hg && (pos || !pointNum))) {
+    return 1;
+  }
+  threadNum = (airThreadCapable ? threadNum : 1);
+  threadNum = AIR_CLAMP(1, threadNum, AIR_HASH_GRID_THREAD_MAXNUM);
+  /* don't bother with threads for which there'd be very little to do */
+  threadNum = AIR_MIN(threadNum, 1 + pointNum / 1024);
+  for (bucketNum = 1; bucketNum < pointNum; bucketNum *= 2)
+    ;
+  if (bucketNum > hg->bucketAlloc) {
+    airFree(hg->bucketStart);
+    airFree(hg->bucketCount);
+    hg->bucketStart = AIR_CALLOC(bucketNum, unsigned int);
+    hg->bucketCount = AIR_CALLOC(bucketNum, unsigned int);
+    if (!(hg->bucketStart && hg->bucketCount)) {
+      hg->bucketAlloc = 0;
+      return 1;
+    }
+    hg->bucketAlloc = bucketNum;
+  }
+  if (pointNum > hg->pointAlloc) {
+    airFree(hg->pointIdx);
+    airFree(hg->pointBucket);
+    hg->pointIdx = AIR_CALLOC(pointNum, unsigned int);
+    hg->pointBucket = AIR_CALLOC(pointNum, unsigned int);
+    if (!(hg->pointIdx && hg->pointBucket)) {
+      hg->pointAlloc = 0;
+      return 1;
+    }
+    hg->pointAlloc = pointNum;
+  }
+  if (threadNum * bucketNum > hg->threadCountAlloc) {
+    airFree(hg->threadCount);
+    hg->threadCount = AIR_CALLOC(threadNum * bucketNum, unsigned int);
+    if (!hg->threadCount) {
+      hg->threadCountAlloc = 0;
+      return 1;
+    }
+    hg->threadCountAlloc = threadNum * bucketNum;
+  }
+  hg->bucketNum = bucketNum;
+  hg->pointNum = pointNum;
+
+  for (ti = 0; ti < threadNum; ti++) {
+    part[ti].hg = hg;
+    part[ti].pos = pos;
+    part[ti].posStride = posStride;
+    part[ti].lo = AIR_UINT(AIR_CAST(airULLong, pointNum) * ti / threadNum);
+    part[ti].hi = AIR_UINT(AIR_CAST(airULLong, pointNum) * (ti + 1) / threadNum);
+    part[ti].count = hg->threadCount + ti * bucketNum;
+    thread[ti] = NULL;
+  }
+  for (ti = 1; ti < threadNum; ti++) {
+    if (!(thread[ti] = airThreadNew())) {
+      for (; ti > 1; ti--) {
+        airThreadNix(thread[ti - 1]);
+      }
+      return 1;
+    }
+  }
+  E = 0;
+  for (phase = 0; phase < 2; phase++) {
+    for (ti = 0; ti < threadNum; ti++) {
+      part[ti].scatter = phase;
+    }
+    if (1 == phase) {
+      /* counts to offsets: all of bucket 0 (first thread 0's points,
+         then thread 1's ...), then all of bucket 1, etc. */
+      run = 0;
+      for (bi = 0; bi < bucketNum; bi++) {
+        hg->bucketStart[bi] = run;
+        for (ti = 0; ti < threadNum; ti++) {
+          tmp = part[ti].count[bi];
+          part[ti].count[bi] = run;
+          run += tmp;
+        }
+        hg->bucketCount[bi] = run - hg->bucketStart[bi];
+      }
+    }
+    for (started = 1; !E && started < threadNum; started++) {
+      E |= airThreadStart(thread[started], _airHashGridPartDo, part + started);
+    }
+    if (E) {
+      /* the thread that failed to start isn't joined below */
+      started--;
+    }
+    _airHashGridPartDo(part + 0);
+    for (ti = 1; ti < started; ti++) {
+      E |= airThreadJoin(thread[ti], NULL);
+    }
+    if (E) {
+      break;
+    }
+  }
+  for (ti = 1; ti < threadNum; ti++) {
+    airThreadNix(thread[ti]);
+  }
+  return E;
+}
@@ -115,6 +115,31 @@ airThreadMutexNix(airThreadMutex *mutex) {
   return mutex;
 }
 
+/*
+** with gcc and compatible compilers we use the builtin; otherwise the
+** fetch-and-add is done under a (single, static) mutex
+*/
+#  if defined(__GNUC__)
+unsigned int
+airThreadAtomicUIntAdd(volatile unsigned int *val, unsigned int incr) {
+
+  return __sync_fetch_and_add(val, incr);
+}
+#  else
+static pthread_mutex_t _airThreadAtomicMutex = PTHREAD_MUTEX_INITIALIZER;
+
+unsigned int
+airThreadAtomicUIntAdd(volatile unsigned int *val, unsigned int incr) {
+  unsigned int ret;
+
+  pthread_mutex_lock(&_airThreadAtomicMutex);
+  ret = *val;
+  *val = ret + incr;
+  pthread_mutex_unlock(&_airThreadAtomicMutex);
+  return ret;
+}
+#  endif
+
 airThreadCond *
 airThreadCondNew(void) {
   airThreadCond *cond;
@@ -230,7 +255,9 @@ airThreadJoin(airThread *thread, void **retP) {
   int err;
 
   err = (WAIT_FAILED == WaitForSingleObject(thread->handle, INFINITE));
-  *retP = thread->ret;
+  if (retP) {
+    *retP = thread->ret;
+  }
   return err;
 }
 
@@ -277,6 +304,12 @@ airThreadMutexNix(airThreadMutex *mutex) {
   return mutex;
 }
 
+unsigned int
+airThreadAtomicUIntAdd(volatile unsigned int *val, unsigned int incr) {
+
+  return (unsigned int)InterlockedExchangeAdd((LONG volatile *)val, (LONG)incr);
+}
+
 airThreadCond *
 airThreadCondNew(void) {
   airThreadCond *cond;
@@ -444,7 +477,9 @@ airThreadStart(airThread *thread, void *(*threadBody)(void *), void *arg) {
 int
 airThreadJoin(airThread *thread, void **retP) {
 
-  *retP = thread->ret;
+  if (retP) {
+    *retP = thread->ret;
+  }
   return 0;
 }
 
@@ -492,6 +527,16 @@ airThreadMutexNix(airThreadMutex *mutex) {
   return NULL;
 }
 
+unsigned int
+airThreadAtomicUIntAdd(volatile unsigned int *val, unsigned int incr) {
+  unsigned int ret;
+
+  /* no other threads to worry about */
+  ret = *val;
+  *val = ret + incr;
+  return ret;
+}
+
 airThreadCond *
 airThreadCondNew(void) {
   airThreadCond *cond;
@@ -589,3 +634,16 @@ airThreadBarrierNix(airThreadBarrier *barrier) {
   airFree(barrier);
   return NULL;
 }
+
+/* the chunk is such that there are about this many fetches per thread,
+   but no more than _AIR_THREAD_CHUNK_MAX jobs per fetch */
+#define _AIR_THREAD_FETCH_PER_THREAD 16
+#define _AIR_THREAD_CHUNK_MAX        64
+
+unsigned int
+airThreadFetchChunk(unsigned int jobNum, unsigned int threadNum) {
+  unsigned int chunk;
+
+  chunk = jobNum / (AIR_MAX(1, threadNum) * _AIR_THREAD_FETCH_PER_THREAD);
+  return AIR_CLAMP(1, chunk, _AIR_THREAD_CHUNK_MAX);
+}
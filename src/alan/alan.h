@@ -142,11 +142,22 @@ typedef struct alanContext_t {
     *nlev;                  /* pointer to last iterations output */
   Nrrd *nparm;              /* alpha, beta values for all texels */
   alan_t averageChange;     /* average amount of "change" in last iteration */
-  unsigned int changeCount; /* # of contributions to averageChange
-                               to control update of averageChange and changeCount */
-  airThreadMutex *changeMutex;
-  /* to synchronize separate iterations of simulation */
-  airThreadBarrier *iterBarrier;
+  /* the threads can be working on two successive iterations at once, so
+     the per-thread contributions to averageChange, and whether any thread
+     found a reason to stop, are collected separately for each (by iteration
+     parity) until all the threads have finished the iteration */
+  alan_t changeSum[2];
+  unsigned int changeCount[2]; /* # of contributions to changeSum */
+  int changeStop[2];
+  unsigned int iterDone[ALAN_THREAD_MAX], /* # iterations each thread has done */
+    iterDecided;                          /* # iterations all threads have done,
+                                             and that have been checked for
+                                             stopping (and saved, etc) */
+  int deciding;                /* some thread is deciding iteration iterDecided;
+                                  it calls perIteration without changeMutex */
+  airThreadMutex *changeMutex; /* around all of the above */
+  /* signaled when threads finish iterations */
+  airThreadCond *iterCond;
 
   /* OUTPUT ---------------------------- */
   int stop; /* why we stopped */
@@ -204,6 +204,9 @@ typedef struct {
   /* these two are genuine input to each worker thread */
   alanContext *actx;
   int idx;
+  /* number of threads actually working; may be less than actx->numThreads
+     so that every thread gets at least one row (2D) or slice (3D) */
+  unsigned int threadNum;
   /* this is just a convenient place to put airThread (so that alanRun()
      doesn't have to make multiple arrays of per-thread items) */
   airThread *thread;
@@ -211,32 +214,315 @@ typedef struct {
      return, and currently that will just end up pointing back to this
      struct */
   void *me;
+  /* things computed once by the worker, for the texel updates */
+  alan_t diffA, diffB;
+  int sx, sy, sz;
+  alan_t change; /* sum of change over this iteration */
+  int stop;      /* any reason to stop found this iteration */
 } alanTask;
 
+/*
+** the part of the texel update shared by all the kernels below: learns
+** from the laplacians (and corrections) of A and B where they go next
+*/
+static void
+_alanTexel(alanTask *task, alan_t *changeP, int *stopP, alan_t *lev1, const alan_t *parm,
+           size_t idx, alan_t A, alan_t B, alan_t conf, alan_t lapA, alan_t lapB,
+           alan_t corrA, alan_t corrB) {
+  alan_t deltaT, alpha, beta, deltaA, deltaB;
+
+  deltaT = parm[0 + 3 * idx];
+  alpha = parm[1 + 3 * idx];
+  beta = parm[2 + 3 * idx];
+  deltaA = deltaT
+           * (task->actx->react * conf * task->actx->K * (alpha - A * B)
+              + task->diffA * (lapA + corrA));
+  if (AIR_ABS(deltaA) > task->actx->maxPixelChange) {
+    *stopP = alanStopDiverged;
+  }
+  *changeP += AIR_ABS(deltaA);
+  deltaB = deltaT
+           * (task->actx->react * conf * task->actx->K * (A * B - B - beta)
+              + task->diffB * (lapB + corrB));
+  if (!(AIR_EXISTS(deltaA) && AIR_EXISTS(deltaB))) {
+    *stopP = alanStopNonExist;
+  }
+  A += deltaA;
+  B = AIR_MAX(0, B + deltaB);
+  lev1[0 + 2 * idx] = A;
+  lev1[1 + 2 * idx] = B;
+}
+
+/*
+** Each kernel does one row (along X) of the texture, given the indices of
+** the rows before and after it along Y and Z, which the caller has wrapped
+** or clamped.  Within the row, only the first and last texels need their
+** X neighbors wrapped or clamped; the x loop in between has no branches.
+*/
+
+/* clang-format off */
+/* 2D, isotropic */
+static void
+_alanRow2D(alanTask *task, const alan_t *lev0, alan_t *lev1, const alan_t *parm,
+           int y, int my, int py) {
+  const alan_t *r0, *rm, *rp;
+  alan_t A, B, lapA, lapB, change;
+  int x, mx, px, sx, stop;
+  size_t idx;
+
+  change = task->change;
+  stop = task->stop;
+  sx = task->sx;
+  r0 = lev0 + 2*sx*y;
+  rm = lev0 + 2*sx*my;
+  rp = lev0 + 2*sx*py;
+  for (x = 0; x < sx; x++) {
+    if (x && x < sx - 1) {
+      /* the interior of the row */
+      for (; x < sx - 1; x++) {
+        idx = x + AIR_SIZE_T(sx)*y;
+        A = r0[0 + 2*x];
+        B = r0[1 + 2*x];
+        lapA = rm[0 + 2*x] + r0[0 + 2*(x-1)] + r0[0 + 2*(x+1)] + rp[0 + 2*x] - 4*A;
+        lapB = rm[1 + 2*x] + r0[1 + 2*(x-1)] + r0[1 + 2*(x+1)] + rp[1 + 2*x] - 4*B;
+        _alanTexel(task, &change, &stop, lev1, parm, idx, A, B, 1, lapA, lapB, 0, 0);
+      }
+    }
+    mx = (x ? x - 1 : (task->actx->wrap ? sx - 1 : 0));
+    px = (x < sx - 1 ? x + 1 : (task->actx->wrap ? 0 : sx - 1));
+    idx = x + AIR_SIZE_T(sx)*y;
+    A = r0[0 + 2*x];
+    B = r0[1 + 2*x];
+    lapA = rm[0 + 2*x] + r0[0 + 2*mx] + r0[0 + 2*px] + rp[0 + 2*x] - 4*A;
+    lapB = rm[1 + 2*x] + r0[1 + 2*mx] + r0[1 + 2*px] + rp[1 + 2*x] - 4*B;
+    _alanTexel(task, &change, &stop, lev1, parm, idx, A, B, 1, lapA, lapB, 0, 0);
+  }
+  task->change = change;
+  task->stop = stop;
+}
+
+/* 2D, guided by tensors */
+static void
+_alanRow2DTensor(alanTask *task, const alan_t *lev0, alan_t *lev1, const alan_t *parm,
+                 int y, int my, int py) {
+  const alan_t *tendata, *ten, *tpx, *tmx, *tpy, *tmy, *v[9];
+  alan_t A, B, conf, Dxx, Dxy, Dyy, lapA, lapB, corrA, corrB, change;
+  int x, mx, px, sx, sy, z, stop;
+  size_t idx;
+
+  change = task->change;
+  stop = task->stop;
+  sx = task->sx;
+  sy = task->sy;
+  z = 0;
+  tendata = (const alan_t *)task->actx->nten->data;
+  for (x = 0; x < sx; x++) {
+    if (task->actx->wrap) {
+      px = AIR_MOD(x+1, sx);
+      mx = AIR_MOD(x-1, sx);
+    } else {
+      px = AIR_MIN(x+1, sx-1);
+      mx = AIR_MAX(x-1, 0);
+    }
+    idx = x + AIR_SIZE_T(sx)*y;
+    A = lev0[0 + 2*idx];
+    B = lev0[1 + 2*idx];
+    lapA = lapB = corrA = corrB = 0;
+    /*
+    **  0 1 2 ----> X
+    **  3 4 5
+    **  6 7 8
+    **  |
+    **  v Y
+    */
+    v[1] = lev0 + 2*( x + sx*(my));
+    v[3] = lev0 + 2*(mx + sx*( y));
+    v[5] = lev0 + 2*(px + sx*( y));
+    v[7] = lev0 + 2*( x + sx*(py));
+    /*
+    **  0 1 2    Dxy/2          Dyy        -Dxy/2
+    **  3 4 5     Dxx     -2*(Dxx + Dyy)     Dxx
+    **  6 7 8   -Dxy/2          Dyy         Dxy/2
+    */
+    v[0] = lev0 + 2*(mx + sx*(my));
+    v[2] = lev0 + 2*(px + sx*(my));
+    v[6] = lev0 + 2*(mx + sx*(py));
+    v[8] = lev0 + 2*(px + sx*(py));
+    ten = tendata + 4*idx;
+    conf = AIR_CAST(alan_t, (AIR_CLAMP(0.3, ten[0], 1) - 0.3)/0.7);
+    if (conf) {
+      Dxx = ten[1];
+      Dxy = ten[2];
+      Dyy = ten[3];
+      lapA = (Dxy*(v[0][0] + v[8][0] - v[2][0] - v[6][0])/2
+              + Dxx*(v[3][0] + v[5][0]) + Dyy*(v[1][0] + v[7][0])
+              - 2*(Dxx + Dyy)*A);
+      lapB = (Dxy*(v[0][1] + v[8][1] - v[2][1] - v[6][1])/2
+              + Dxx*(v[3][1] + v[5][1]) + Dyy*(v[1][1] + v[7][1])
+              - 2*(Dxx + Dyy)*B);
+      if (!(task->actx->homogAniso)) {
+        tpx = tendata + 4*(px + sx*( y + sy*( z)));
+        tmx = tendata + 4*(mx + sx*( y + sy*( z)));
+        tpy = tendata + 4*( x + sx*(py + sy*( z)));
+        tmy = tendata + 4*( x + sx*(my + sy*( z)));
+        corrA = ((tpx[1]-tmx[1])*(v[5][0]-v[3][0])/4+ /* Dxx,x*A,x */
+                 (tpx[2]-tmx[2])*(v[7][0]-v[1][0])/4+ /* Dxy,x*A,y */
+                 (tpy[2]-tmy[2])*(v[5][0]-v[3][0])/4+ /* Dxy,y*A,x */
+                 (tpy[3]-tmy[3])*(v[7][0]-v[1][0]));  /* Dyy,y*A,y */
+        corrB = ((tpx[1]-tmx[1])*(v[5][1]-v[3][1])/4+ /* Dxx,x*B,x */
+                 (tpx[2]-tmx[2])*(v[7][1]-v[1][1])/4+ /* Dxy,x*B,y */
+                 (tpy[2]-tmy[2])*(v[5][1]-v[3][1])/4+ /* Dxy,y*B,x */
+                 (tpy[3]-tmy[3])*(v[7][1]-v[1][1]));  /* Dyy,y*B,y */
+      }
+    } else {
+      /* no confidence; you diffuse */
+      lapA = v[1][0] + v[3][0] + v[5][0] + v[7][0] - 4*A;
+      lapB = v[1][1] + v[3][1] + v[5][1] + v[7][1] - 4*B;
+    }
+    _alanTexel(task, &change, &stop, lev1, parm, idx, A, B, conf, lapA, lapB, corrA, corrB);
+  }
+  task->change = change;
+  task->stop = stop;
+}
+
+/*
+** 3D.  With tensors, there is (still) no anisotropic diffusion in 3D, and
+** only reaction happens
+**
+**          0   1   2   ---- X
+**        3   4   5
+**      6   7   8
+**    /
+**  /       9  10  11
+** Y     12  13  14
+**     15  16  17
+**
+**         18  19  20
+**       21  22  23
+**     24  25  26
+**         |
+**         |
+**         Z
+*/
+static void
+_alanRow3D(alanTask *task, const alan_t *lev0, alan_t *lev1, const alan_t *parm,
+           int y, int my, int py, int z, int mz, int pz) {
+  const alan_t *r13, *r4, *r10, *r16, *r22;
+  alan_t A, B, lapA, lapB, change;
+  int x, mx, px, sx, sy, diffuse, stop;
+  size_t idx;
+
+  change = task->change;
+  stop = task->stop;
+  sx = task->sx;
+  sy = task->sy;
+  r4  = lev0 + 2*sx*( y + sy*(mz));
+  r10 = lev0 + 2*sx*(my + sy*( z));
+  r13 = lev0 + 2*sx*( y + sy*( z));
+  r16 = lev0 + 2*sx*(py + sy*( z));
+  r22 = lev0 + 2*sx*( y + sy*(pz));
+  diffuse = !task->actx->nten;
+  lapA = lapB = 0;
+  for (x = 0; x < sx; x++) {
+    if (diffuse && x && x < sx - 1) {
+      for (; x < sx - 1; x++) {
+        idx = x + AIR_SIZE_T(sx)*(y + AIR_SIZE_T(sy)*z);
+        A = r13[0 + 2*x];
+        B = r13[1 + 2*x];
+        lapA = (r4[0 + 2*x] + r10[0 + 2*x] + r13[0 + 2*(x-1)]
+                + r13[0 + 2*(x+1)] + r16[0 + 2*x] + r22[0 + 2*x] - 6*A);
+        lapB = (r4[1 + 2*x] + r10[1 + 2*x] + r13[1 + 2*(x-1)]
+                + r13[1 + 2*(x+1)] + r16[1 + 2*x] + r22[1 + 2*x] - 6*B);
+        _alanTexel(task, &change, &stop, lev1, parm, idx, A, B, 1, lapA, lapB, 0, 0);
+      }
+    }
+    idx = x + AIR_SIZE_T(sx)*(y + AIR_SIZE_T(sy)*z);
+    A = r13[0 + 2*x];
+    B = r13[1 + 2*x];
+    if (diffuse) {
+      mx = (x ? x - 1 : (task->actx->wrap ? sx - 1 : 0));
+      px = (x < sx - 1 ? x + 1 : (task->actx->wrap ? 0 : sx - 1));
+      lapA = (r4[0 + 2*x] + r10[0 + 2*x] + r13[0 + 2*mx]
+              + r13[0 + 2*px] + r16[0 + 2*x] + r22[0 + 2*x] - 6*A);
+      lapB = (r4[1 + 2*x] + r10[1 + 2*x] + r13[1 + 2*mx]
+              + r13[1 + 2*px] + r16[1 + 2*x] + r22[1 + 2*x] - 6*B);
+    }
+    _alanTexel(task, &change, &stop, lev1, parm, idx, A, B, 1, lapA, lapB, 0, 0);
+  }
+  task->change = change;
+  task->stop = stop;
+}
+/* clang-format on */
+
+/*
+** with the changeMutex locked: having all the threads' contributions to
+** iteration iter, see if we should stop.  Returns non-zero if we keep
+** going, in which case the per-iteration things (saving, and calling
+** actx->perIteration) are to be done, but with the changeMutex unlocked.
+*/
+static int
+_alanIterDecide(alanContext *actx, unsigned int iter) {
+  unsigned int slot;
+  int ret;
+
+  slot = iter % 2;
+  actx->iter = AIR_INT(iter);
+  actx->nlev = actx->_nlev[(iter + 1) % 2];
+  actx->averageChange = actx->changeSum[slot];
+  ret = AIR_FALSE;
+  if (alanStopNot != actx->changeStop[slot]) {
+    /* there was some problem in going from lev0 to lev1 */
+    actx->stop = actx->changeStop[slot];
+  } else if (actx->averageChange < actx->minAverageChange) {
+    /* we converged */
+    actx->stop = alanStopConverged;
+  } else {
+    /* we keep going */
+    ret = AIR_TRUE;
+  }
+  actx->changeSum[slot] = 0;
+  actx->changeCount[slot] = 0;
+  actx->changeStop[slot] = alanStopNot;
+  return ret;
+}
+
+/*
+** Each thread works on a band of rows (2D) or slices (3D), and there is no
+** barrier between iterations.  Iteration iter reads _nlev[iter % 2] and
+** writes _nlev[(iter + 1) % 2], so a thread can start iteration iter once
+** the threads with the bands on either side of it have finished iteration
+** iter-1: by then they have written the rows it will read, and they are
+** done reading the rows it will write.  So threads only wait on their
+** neighbors, and a slow thread holds up the others gradually.
+**
+** Whether to stop after iteration iter (and the per-iteration saving and
+** callbacks) is decided by the thread to finish iter last, while other
+** threads may already be working on iteration iter+1.  This does not
+** change the results: iteration iter+1 writes into the buffer that
+** iteration iter read, not the one it wrote.  No thread starts iteration
+** iter+2 until iter has been decided.
+*/
 static void *
 _alanTuringWorker(void *_task) {
-  alan_t *tendata, *ten, react, conf, Dxx, Dxy, Dyy, /* Dxz, Dyz, */
-    *tpx, *tmx, *tpy, *tmy,                          /* *tpz, *tmz, */
-    *lev0, *lev1, *parm, deltaT, alpha, beta, A, B, *v[27], lapA, lapB, corrA, corrB,
-    deltaA, deltaB, diffA, diffB, change;
-  int dim, stop, startW, endW, idx, px, mx, py, my, pz, mz, startY, endY, startZ, endZ,
-    sx, sy, sz, x, y, z;
-  unsigned int iter;
   alanTask *task;
+  alanContext *actx;
+  alan_t *lev0, *lev1, *parm;
+  int dim, bandNum, startW, endW, y, my, py, z, mz, pz, startY, endY, startZ, endZ,
+    lowNeed, highNeed, stop;
+  unsigned int iter, low, high, slot;
 
   task = (alanTask *)_task;
-  dim = task->actx->dim;
-  sx = task->actx->size[0];
-  sy = task->actx->size[1];
-  sz = (2 == dim ? 1 : task->actx->size[2]);
-  parm = (alan_t *)(task->actx->nparm->data);
-  diffA = AIR_CAST(alan_t, task->actx->diffA / pow(task->actx->deltaX, dim));
-  diffB = AIR_CAST(alan_t, task->actx->diffB / pow(task->actx->deltaX, dim));
-  startW = task->idx * sy / task->actx->numThreads;
-  endW = (task->idx + 1) * sy / task->actx->numThreads;
-  tendata = task->actx->nten ? (alan_t *)task->actx->nten->data : NULL;
-  react = task->actx->react;
-
+  actx = task->actx;
+  dim = actx->dim;
+  task->sx = actx->size[0];
+  task->sy = actx->size[1];
+  task->sz = (2 == dim ? 1 : actx->size[2]);
+  parm = (alan_t *)(actx->nparm->data);
+  task->diffA = AIR_CAST(alan_t, actx->diffA / pow(actx->deltaX, dim));
+  task->diffB = AIR_CAST(alan_t, actx->diffB / pow(actx->deltaX, dim));
+  bandNum = (2 == dim ? task->sy : task->sz);
+  startW = task->idx * bandNum / AIR_INT(task->threadNum);
+  endW = (task->idx + 1) * bandNum / AIR_INT(task->threadNum);
   if (2 == dim) {
     startZ = 0;
     endZ = 1;
@@ -246,206 +532,92 @@ _alanTuringWorker(void *_task) {
     startZ = startW;
     endZ = endW;
     startY = 0;
-    endY = sy;
+    endY = task->sy;
   }
-
-  for (iter = 0; (alanStopNot == task->actx->stop
-                  && (0 == task->actx->maxIteration || iter < task->actx->maxIteration));
-       iter++) {
-
-    if (0 == task->idx) {
-      task->actx->iter = iter;
-      task->actx->nlev = task->actx->_nlev[(iter + 1) % 2];
+  /* the threads working on the neighboring bands */
+  low = (AIR_UINT(task->idx) + task->threadNum - 1) % task->threadNum;
+  high = (AIR_UINT(task->idx) + 1) % task->threadNum;
+  lowNeed = (task->threadNum > 1 && (actx->wrap || task->idx > 0));
+  highNeed = (task->threadNum > 1
+              && (actx->wrap || AIR_UINT(task->idx) < task->threadNum - 1));
+
+  for (iter = 0; 0 == actx->maxIteration || iter < actx->maxIteration; iter++) {
+    airThreadMutexLock(actx->changeMutex);
+    while (alanStopNot == actx->stop
+           && !((!lowNeed || actx->iterDone[low] >= iter)
+                && (!highNeed || actx->iterDone[high] >= iter)
+                && actx->iterDecided + 1 >= iter)) {
+      airThreadCondWait(actx->iterCond, actx->changeMutex);
     }
-    lev0 = (alan_t *)(task->actx->_nlev[iter % 2]->data);
-    lev1 = (alan_t *)(task->actx->_nlev[(iter + 1) % 2]->data);
-    stop = alanStopNot;
-    change = 0;
-    conf = 1; /* if you have no data; this will stay 1 */
-    /* clang-format off */
+    stop = actx->stop;
+    airThreadMutexUnlock(actx->changeMutex);
+    if (alanStopNot != stop) {
+      break;
+    }
+
+    lev0 = (alan_t *)(actx->_nlev[iter % 2]->data);
+    lev1 = (alan_t *)(actx->_nlev[(iter + 1) % 2]->data);
+    task->stop = alanStopNot;
+    task->change = 0;
     for (z = startZ; z < endZ; z++) {
-      if (task->actx->wrap) {
-        pz = AIR_MOD(z+1, sz);
-        mz = AIR_MOD(z-1, sz);
+      if (actx->wrap) {
+        pz = AIR_MOD(z + 1, task->sz);
+        mz = AIR_MOD(z - 1, task->sz);
       } else {
-        pz = AIR_MIN(z+1, sz-1);
-        mz = AIR_MAX(z-1, 0);
+        pz = AIR_MIN(z + 1, task->sz - 1);
+        mz = AIR_MAX(z - 1, 0);
       }
       for (y = startY; y < endY; y++) {
-        if (task->actx->wrap) {
-          py = AIR_MOD(y+1, sy);
-          my = AIR_MOD(y-1, sy);
+        if (actx->wrap) {
+          py = AIR_MOD(y + 1, task->sy);
+          my = AIR_MOD(y - 1, task->sy);
         } else {
-          py = AIR_MIN(y+1, sy-1);
-          my = AIR_MAX(y-1, 0);
+          py = AIR_MIN(y + 1, task->sy - 1);
+          my = AIR_MAX(y - 1, 0);
         }
-        for (x = 0; x < sx; x++) {
-          if (task->actx->wrap) {
-            px = AIR_MOD(x+1, sx);
-            mx = AIR_MOD(x-1, sx);
-          } else {
-            px = AIR_MIN(x+1, sx-1);
-            mx = AIR_MAX(x-1, 0);
-          }
-          idx = x + sx*(y + sy*z);
-          A = lev0[0 + 2*idx];
-          B = lev0[1 + 2*idx];
-          deltaT = parm[0 + 3*idx];
-          alpha = parm[1 + 3*idx];
-          beta = parm[2 + 3*idx];
-          lapA = lapB = corrA = corrB = 0;
-          if (2 == dim) {
-            /*
-            **  0 1 2 ----> X
-            **  3 4 5
-            **  6 7 8
-            **  |
-            **  v Y
-            */
-            v[1] = lev0 + 2*( x + sx*(my));
-            v[3] = lev0 + 2*(mx + sx*( y));
-            v[5] = lev0 + 2*(px + sx*( y));
-            v[7] = lev0 + 2*( x + sx*(py));
-            if (tendata) {
-              /*
-              **  0 1 2    Dxy/2          Dyy        -Dxy/2
-              **  3 4 5     Dxx     -2*(Dxx + Dyy)     Dxx
-              **  6 7 8   -Dxy/2          Dyy         Dxy/2
-              */
-              v[0] = lev0 + 2*(mx + sx*(my));
-              v[2] = lev0 + 2*(px + sx*(my));
-              v[6] = lev0 + 2*(mx + sx*(py));
-              v[8] = lev0 + 2*(px + sx*(py));
-              ten = tendata + 4*idx;
-              conf = AIR_CAST(alan_t, (AIR_CLAMP(0.3, ten[0], 1) - 0.3)/0.7);
-              if (conf) {
-                Dxx = ten[1];
-                Dxy = ten[2];
-                Dyy = ten[3];
-                lapA = (Dxy*(v[0][0] + v[8][0] - v[2][0] - v[6][0])/2
-                        + Dxx*(v[3][0] + v[5][0]) + Dyy*(v[1][0] + v[7][0])
-                        - 2*(Dxx + Dyy)*A);
-                lapB = (Dxy*(v[0][1] + v[8][1] - v[2][1] - v[6][1])/2
-                        + Dxx*(v[3][1] + v[5][1]) + Dyy*(v[1][1] + v[7][1])
-                        - 2*(Dxx + Dyy)*B);
-                if (!(task->actx->homogAniso)) {
-                  tpx = tendata + 4*(px + sx*( y + sy*( z)));
-                  tmx = tendata + 4*(mx + sx*( y + sy*( z)));
-                  tpy = tendata + 4*( x + sx*(py + sy*( z)));
-                  tmy = tendata + 4*( x + sx*(my + sy*( z)));
-                  corrA = ((tpx[1]-tmx[1])*(v[5][0]-v[3][0])/4+ /* Dxx,x*A,x */
-                           (tpx[2]-tmx[2])*(v[7][0]-v[1][0])/4+ /* Dxy,x*A,y */
-                           (tpy[2]-tmy[2])*(v[5][0]-v[3][0])/4+ /* Dxy,y*A,x */
-                           (tpy[3]-tmy[3])*(v[7][0]-v[1][0]));  /* Dyy,y*A,y */
-                  corrB = ((tpx[1]-tmx[1])*(v[5][1]-v[3][1])/4+ /* Dxx,x*B,x */
-                           (tpx[2]-tmx[2])*(v[7][1]-v[1][1])/4+ /* Dxy,x*B,y */
-                           (tpy[2]-tmy[2])*(v[5][1]-v[3][1])/4+ /* Dxy,y*B,x */
-                           (tpy[3]-tmy[3])*(v[7][1]-v[1][1]));  /* Dyy,y*B,y */
-                }
-              } else {
-                /* no confidence; you diffuse */
-                lapA = v[1][0] + v[3][0] + v[5][0] + v[7][0] - 4*A;
-                lapB = v[1][1] + v[3][1] + v[5][1] + v[7][1] - 4*B;
-              }
-            } else {
-              /* no data; you diffuse */
-              lapA = v[1][0] + v[3][0] + v[5][0] + v[7][0] - 4*A;
-              lapB = v[1][1] + v[3][1] + v[5][1] + v[7][1] - 4*B;
-            }
-          } else {
-            /* 3 == dim */
-            /*
-            **          0   1   2   ---- X
-            **        3   4   5
-            **      6   7   8
-            **    /
-            **  /       9  10  11
-            ** Y     12  13  14
-            **     15  16  17
-            **
-            **         18  19  20
-            **       21  22  23
-            **     24  25  26
-            **         |
-            **         |
-            **         Z
-            */
-            v[ 4] = lev0 + 2*( x + sx*( y + sy*(mz)));
-            v[10] = lev0 + 2*( x + sx*(my + sy*( z)));
-            v[12] = lev0 + 2*(mx + sx*( y + sy*( z)));
-            v[14] = lev0 + 2*(px + sx*( y + sy*( z)));
-            v[16] = lev0 + 2*( x + sx*(py + sy*( z)));
-            v[22] = lev0 + 2*( x + sx*( y + sy*(pz)));
-            if (tendata) {
-
-              if (!(task->actx->homogAniso)) {
-
-              }
-            } else {
-              lapA = (v[ 4][0] + v[10][0] + v[12][0]
-                      + v[14][0] + v[16][0] + v[22][0] - 6*A);
-              lapB = (v[ 4][1] + v[10][1] + v[12][1]
-                      + v[14][1] + v[16][1] + v[22][1] - 6*B);
-            }
-          }
-
-          deltaA = deltaT*(react*conf*task->actx->K*(alpha - A*B)
-                           + diffA*(lapA + corrA));
-          if (AIR_ABS(deltaA) > task->actx->maxPixelChange) {
-            stop = alanStopDiverged;
-          }
-          change += AIR_ABS(deltaA);
-          deltaB = deltaT*(react*conf*task->actx->K*(A*B - B - beta)
-                           + diffB*(lapB + corrB));
-          if (!( AIR_EXISTS(deltaA) && AIR_EXISTS(deltaB) )) {
-            stop = alanStopNonExist;
-          }
-
-          A += deltaA;
-          B = AIR_MAX(0, B + deltaB);
-          lev1[0 + 2*idx] = A;
-          lev1[1 + 2*idx] = B;
+        if (3 == dim) {
+          _alanRow3D(task, lev0, lev1, parm, y, my, py, z, mz, pz);
+        } else if (actx->nten) {
+          _alanRow2DTensor(task, lev0, lev1, parm, y, my, py);
+        } else {
+          _alanRow2D(task, lev0, lev1, parm, y, my, py);
         }
       }
     }
-    /* clang-format on */
 
     /* add change to global sum in a threadsafe way */
-    airThreadMutexLock(task->actx->changeMutex);
-    task->actx->averageChange += change / (sx * sy * sz);
-    task->actx->changeCount += 1;
-    if (task->actx->changeCount == task->actx->numThreads) {
-      /* I must be the last thread to reach this point; all
-         others must have passed the mutex unlock, and are
-         sitting at the barrier */
-      if (alanStopNot != stop) {
-        /* there was some problem in going from lev0 to lev1, which
-           we deal with now by setting actx->stop */
-        task->actx->stop = stop;
-      } else if (task->actx->averageChange < task->actx->minAverageChange) {
-        /* we converged */
-        task->actx->stop = alanStopConverged;
-      } else {
-        /* we keep going */
-        _alanPerIteration(task->actx, iter);
-        if (task->actx->perIteration) {
-          task->actx->perIteration(task->actx, iter);
+    airThreadMutexLock(actx->changeMutex);
+    slot = iter % 2;
+    actx->changeSum[slot] += task->change / (task->sx * task->sy * task->sz);
+    actx->changeCount[slot] += 1;
+    if (alanStopNot != task->stop) {
+      actx->changeStop[slot] = task->stop;
+    }
+    actx->iterDone[task->idx] = iter + 1;
+    /* decide all the iterations that everyone has finished, in order.  The
+       per-iteration things are done with the changeMutex unlocked (and
+       actx->deciding set, so that no other thread decides anything), but
+       before iterDecided is incremented, so that no thread starts writing
+       into the buffer that they read */
+    while (alanStopNot == actx->stop && !actx->deciding
+           && actx->changeCount[actx->iterDecided % 2] == task->threadNum) {
+      actx->deciding = AIR_TRUE;
+      if (_alanIterDecide(actx, actx->iterDecided)) {
+        airThreadMutexUnlock(actx->changeMutex);
+        _alanPerIteration(actx, actx->iter);
+        if (actx->perIteration) {
+          actx->perIteration(actx, actx->iter);
         }
+        airThreadMutexLock(actx->changeMutex);
       }
-      task->actx->averageChange = 0;
-      task->actx->changeCount = 0;
+      actx->averageChange = 0;
+      actx->iterDecided += 1;
+      actx->deciding = AIR_FALSE;
     }
-    airThreadMutexUnlock(task->actx->changeMutex);
-
-    /* force all threads to line up here, once per iteration */
-    airThreadBarrierWait(task->actx->iterBarrier);
+    airThreadCondBroadcast(actx->iterCond);
+    airThreadMutexUnlock(actx->changeMutex);
   }
 
-  if (iter == task->actx->maxIteration) {
-    /* HEY: all threads will agree on this, right? */
-    task->actx->stop = alanStopMaxIteration;
-  }
-  /* else: the non-alanStopNot value of task->actx->stop made us stop */
   return _task;
 }
 
@@ -453,7 +625,7 @@ int /* Biff: 1 */
 alanRun(alanContext *actx) {
   static const char me[] = "alanRun";
   int hack = AIR_FALSE;
-  unsigned int tid;
+  unsigned int tid, tjd, threadNum;
   alanTask task[ALAN_THREAD_MAX];
 
   if (_alanCheck(actx)) {
@@ -472,23 +644,63 @@ alanRun(alanContext *actx) {
     hack = airThreadNoopWarning;
     airThreadNoopWarning = AIR_FALSE;
   }
+  /* without real threads, the "threads" run one after the other, and
+     would wait forever for each other; with real threads, every thread
+     gets at least one row (2D) or slice (3D) */
+  threadNum = airThreadCapable ? actx->numThreads : 1;
+  threadNum = AIR_MIN(threadNum, actx->size[2 == actx->dim ? 1 : 2]);
+  threadNum = AIR_CLAMP(1, threadNum, ALAN_THREAD_MAX);
   actx->changeMutex = airThreadMutexNew();
-  actx->iterBarrier = airThreadBarrierNew(actx->numThreads);
+  actx->iterCond = airThreadCondNew();
   actx->averageChange = 0;
-  actx->changeCount = 0;
+  actx->changeSum[0] = actx->changeSum[1] = 0;
+  actx->changeCount[0] = actx->changeCount[1] = 0;
+  actx->changeStop[0] = actx->changeStop[1] = alanStopNot;
+  actx->iterDecided = 0;
+  actx->deciding = AIR_FALSE;
   actx->stop = alanStopNot;
-  for (tid = 0; tid < actx->numThreads; tid++) {
+  for (tid = 0; tid < threadNum; tid++) {
+    actx->iterDone[tid] = 0;
     task[tid].actx = actx;
     task[tid].idx = tid;
+    task[tid].threadNum = threadNum;
     task[tid].thread = airThreadNew();
-    airThreadStart(task[tid].thread, _alanTuringWorker, (void *)&(task[tid]));
   }
-  for (tid = 0; tid < actx->numThreads; tid++) {
+  for (tid = 0; tid < threadNum; tid++) {
+    if (!task[tid].thread
+        || airThreadStart(task[tid].thread, _alanTuringWorker, (void *)&(task[tid]))) {
+      biffAddf(ALAN, "%s: couldn't start thread %u (of %u)", me, tid, threadNum);
+      /* stop the threads already started, then wait for them */
+      airThreadMutexLock(actx->changeMutex);
+      actx->stop = alanStopUnknown;
+      airThreadCondBroadcast(actx->iterCond);
+      airThreadMutexUnlock(actx->changeMutex);
+      for (tjd = 0; tjd < threadNum; tjd++) {
+        if (tjd < tid) {
+          airThreadJoin(task[tjd].thread, &(task[tjd].me));
+        }
+        if (task[tjd].thread) {
+          task[tjd].thread = airThreadNix(task[tjd].thread);
+        }
+      }
+      actx->iterCond = airThreadCondNix(actx->iterCond);
+      actx->changeMutex = airThreadMutexNix(actx->changeMutex);
+      if (!airThreadCapable && 1 == actx->numThreads) {
+        airThreadNoopWarning = hack;
+      }
+      return 1;
+    }
+  }
+  for (tid = 0; tid < threadNum; tid++) {
     airThreadJoin(task[tid].thread, &(task[tid].me));
     task[tid].thread = airThreadNix(task[tid].thread);
   }
-  actx->iterBarrier = airThreadBarrierNix(actx->iterBarrier);
+  actx->iterCond = airThreadCondNix(actx->iterCond);
   actx->changeMutex = airThreadMutexNix(actx->changeMutex);
+  if (alanStopNot == actx->stop) {
+    /* nothing else made us stop */
+    actx->stop = alanStopMaxIteration;
+  }
 
   if (!airThreadCapable && 1 == actx->numThreads) {
     airThreadNoopWarning = hack;
@@ -36,11 +36,12 @@ main(int argc, const char *argv[]) {
   hestParm *hparm = NULL;
   miteUser *muu;
   const char *me;
-  char *errS, *outS, *shadeStr, *normalStr, debugStr[AIR_STRLEN_MED];
+  char *errS, *outS, *shadeStr, *normalStr, *lodFormat, debugStr[AIR_STRLEN_MED];
   int renorm, baseDim, verbPix[2], offfr;
-  int E, Ecode, Ethread;
+  int E, Ecode, Ethread, lodRecomputed;
+  unsigned int li;
   float ads[3], isScale;
-  double turn, eye[3], eyedist, gmc;
+  double turn, eye[3], eyedist, gmc, adaptStepRange[2];
   double v[NRRD_SPACE_DIM_MAX];
   Nrrd *nin;
 
@@ -116,6 +117,42 @@ main(int argc, const char *argv[]) {
   hestOptAdd_1_Double(&hopt, "ref", "size", &(muu->refStep), "0.01",
                       "\"reference\" step size (world space) for doing "
                       "opacity correction in compositing");
+  hestOptAdd_Flag(&hopt, "preint", &(muu->preint),
+                  "use pre-integrated transfer functions (for txfs with only "
+                  "scalar domain variables), which account for the whole ray "
+                  "segment between samples, allowing larger \"-step\" sizes "
+                  "without missing thin features");
+  hestOptAdd_Flag(&hopt, "adapt", &(muu->adaptStep),
+                  "use adaptive ray stepping: take larger steps (up to \"-asr\" "
+                  "max times \"-step\") in nearly transparent regions with low "
+                  "gradient magnitude, and smaller ones (down to \"-asr\" min) "
+                  "near boundaries. Requires a scalar volume.");
+  hestOptAdd_2_Double(&hopt, "asr", "min max", adaptStepRange, "1 4",
+                      "range of step scalings (relative to \"-step\") allowed "
+                      "with \"-adapt\"");
+  hestOptAdd_1_Double(&hopt, "ave", "value err", &(muu->adaptValErr), "nan",
+                      "with \"-adapt\", the change in scalar value (as predicted "
+                      "by gradient magnitude) allowed over one step");
+  hestOptAdd_1_Double(&hopt, "aom", "opac", &(muu->adaptOpacMax), "0.02",
+                      "with \"-adapt\", steps only grow beyond \"-step\" where "
+                      "sample opacity is at or below this");
+  hestOptAdd_1_UInt(&hopt, "lod", "# levels", &(muu->nsinLevelNum), "0",
+                    "if non-zero, build (or load, see \"-lodf\") this many "
+                    "levels of a 2x-decimated pyramid of the scalar volume, and "
+                    "render the level best matched to the pixel size at the "
+                    "volume center");
+  hestOptAdd_1_String(&hopt, "lodf", "format", &lodFormat, "",
+                      "sprintf-style format (e.g. \"vol-L%02u.nrrd\") for the "
+                      "filenames of pyramid levels 1 through \"-lod\": these are "
+                      "re-used if they exist and match the input volume, or else "
+                      "they are computed and saved");
+  hestOptAdd_1_Double(&hopt, "lods", "scale", &(muu->lodScale), "1.0",
+                      "scaling of pixel size in picking the level of detail: "
+                      "smaller favors finer levels");
+  hestOptAdd_Flag(&hopt, "stats", &(muu->hctx->timing),
+                  "after rendering, print statistics on rays, samples, and "
+                  "probes, and time spent in the stages of rendering (measuring "
+                  "which slows rendering down somewhat)");
   hestOptAdd_2_Int(&hopt, "vp", "verbose pixel", verbPix, "-1 -1",
                    "pixel for which to turn on verbose messages");
   hestOptAdd_1_Double(&hopt, "n1", "near1", &(muu->opacNear1), "0.99",
@@ -147,12 +184,35 @@ main(int argc, const char *argv[]) {
     return 1;
   }
 
+  if (muu->nsinLevelNum) {
+    if (!muu->nsin) {
+      fprintf(stderr, "%s: \"-lod\" needs a scalar volume (\"-i\")\n", me);
+      airMopError(mop);
+      return 1;
+    }
+    if (nrrdPyramidManage(&(muu->nsinLevel), &lodRecomputed, muu->nsinLevelNum,
+                          lodFormat, AIR_TRUE, muu->nsin, 0, muu->ksp[gageKernel00])) {
+      airMopAdd(mop, errS = biffGetDone(NRRD), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble with volume pyramid:\n%s\n", me, errS);
+      airMopError(mop);
+      return 1;
+    }
+    airMopAdd(mop, muu->nsinLevel, airFree, airMopAlways);
+    for (li = 0; li < muu->nsinLevelNum; li++) {
+      airMopAdd(mop, muu->nsinLevel[li], (airMopper)nrrdNuke, airMopAlways);
+    }
+    fprintf(stderr, "%s: %s %u pyramid levels\n", me,
+            lodRecomputed ? "computed" : "loaded", muu->nsinLevelNum);
+  }
+
   /* finish processing command-line args */
   muu->rangeInit[miteRangeKa] = ads[0];
   muu->rangeInit[miteRangeKd] = ads[1];
   muu->rangeInit[miteRangeKs] = ads[2];
   gageParmSet(muu->gctx0, gageParmGradMagCurvMin, gmc);
   gageParmSet(muu->gctx0, gageParmRenormalize, renorm ? AIR_TRUE : AIR_FALSE);
+  muu->adaptStepMin = adaptStepRange[0];
+  muu->adaptStepMax = adaptStepRange[1];
   muu->verbUi = verbPix[0];
   muu->verbVi = verbPix[1];
   if (offfr) {
@@ -263,6 +323,16 @@ main(int argc, const char *argv[]) {
   fprintf(stderr, "\n");
   fprintf(stderr, "%s: rendering time = %g secs\n", me, muu->rendTime);
   fprintf(stderr, "%s: sampling rate = %g Khz\n", me, muu->sampRate);
+  if (muu->adaptStep) {
+    fprintf(stderr, "%s: mean step = %g * step\n", me, muu->stepMean);
+  }
+  if (muu->nsinLevelNum) {
+    fprintf(stderr, "%s: rendered level %u of detail\n", me, muu->levelUsed);
+  }
+  if (muu->hctx->timing) {
+    hooverStatsPrint(stderr, muu->hctx);
+    miteStatsPrint(stderr, muu);
+  }
   if (muu->ndebug) {
     /* if its been generated, we should save it */
     sprintf(debugStr, "%04d-%04d-debug.nrrd", verbPix[0], verbPix[1]);
@@ -504,6 +504,9 @@ main(int argc, const char *argv[]) {
                       "step size along ray in world space");
   hestOptAdd_1_UInt(&hopt, "nt", "# threads", &(uu->hctx->numThreads), "1",
                     "number of threads hoover should use");
+  hestOptAdd_Flag(&hopt, "stats", &(uu->hctx->timing),
+                  "after rendering, print statistics on rays and samples, and "
+                  "time spent in the hoover callbacks");
   hestOptAdd_2_Int(&hopt, "vp", "img coords", uu->verbPixel, "-1 -1",
                    "pixel coordinates for which to turn on all verbose "
                    "debugging messages, or \"-1 -1\" to disable this.");
@@ -640,6 +643,10 @@ main(int argc, const char *argv[]) {
     return 1;
   }
 
+  if (uu->hctx->timing) {
+    hooverStatsPrint(stderr, uu->hctx);
+  }
+
   if (1) {
     ELL_3V_SUB(uu->imgU, uu->imgU, uu->imgOrig);
     ELL_3V_SUB(uu->imgV, uu->imgV, uu->imgOrig);
@@ -42,7 +42,7 @@ main(int argc, const char **argv) {
   airArray *mop;
   const char *me;
 
-  char *err, *outS, *extraOutBaseS, *addLogS, *cachePathSS;
+  char *err, *outS, *extraOutBaseS, *addLogS, *cachePathSS, *chkpOutS, *chkpInS;
   FILE *addLog;
   meetPullVol **vspec;
   meetPullInfo **idef;
@@ -58,16 +58,17 @@ main(int argc, const char **argv) {
   int energyFromStrength, nixAtVolumeEdgeSpace, constraintBeforeSeedThresh, binSingle,
     liveThresholdOnInit, permuteOnRebin, noPopCntlWithZeroAlpha, useBetaForGammaLearn,
     restrictiveAddToBins, noAdd, unequalShapesAllow, popCntlEnoughTest,
-    convergenceIgnoresPopCntl, zeroZ;
+    convergenceIgnoresPopCntl, zeroZ, binPack, probeCache;
   int verbose;
   int interType, allowCodimension3Constraints, scaleIsTau, useHalton, pointPerVoxel;
-  unsigned int samplesAlongScaleNum, pointNumInitial, ppvZRange[2], snap, iterMax,
-    stuckIterMax, constraintIterMax, popCntlPeriod, addDescent, iterCallback, rngSeed,
-    progressBinMod, threadNum, eipHalfLife, kssOpi, kssFinished, bspOpi, bspFinished;
+  unsigned int samplesAlongScaleNum, pointNumInitial, ppvZRange[2], snap, chkp,
+    iterMax, stuckIterMax, constraintIterMax, popCntlPeriod, addDescent, iterCallback,
+    rngSeed, progressBinMod, threadNum, eipHalfLife, kssOpi, kssFinished, bspOpi,
+    bspFinished;
   double jitter, stepInitial, constraintStepMin, radiusSpace, binWidthSpace, radiusScale,
     alpha, beta, _gamma, wall, energyIncreasePermit, backStepScale, opporStepScale,
-    energyDecreaseMin, energyDecreasePopCntlMin, neighborTrueProb, probeProb,
-    fracNeighNixedMax;
+    energyDecreaseMin, energyDecreasePopCntlMin, neighborTrueProb, neighborSkin,
+    probeProb, probeCacheQuantum, fracNeighNixedMax;
 
   mop = airMopNew();
   hparm = hestParmNew();
@@ -113,6 +114,12 @@ main(int argc, const char **argv) {
   hestOptAdd_Flag(&hopt, "nobin", &binSingle,
                   "turn off spatial binning (which prevents multi-threading "
                   "from being useful), for debugging or speed-up measurement");
+  hestOptAdd_Flag(&hopt, "pack", &binPack,
+                  "pack particle positions contiguously and process bins in "
+                  "Morton order, for better memory locality with many particles");
+  hestOptAdd_Flag(&hopt, "pcache", &probeCache,
+                  "have each thread cache its recent probe results, to re-use "
+                  "them when probing at the same position again");
   hestOptAdd_1_Bool(&hopt, "lti", "bool", &liveThresholdOnInit, "true",
                     "impose liveThresh on initialization");
   hestOptAdd_1_Bool(&hopt, "por", "bool", &permuteOnRebin, "true",
@@ -183,6 +190,14 @@ main(int argc, const char **argv) {
                       "convergence criterion for constraint satisfaction");
   hestOptAdd_1_UInt(&hopt, "snap", "# iters", &snap, "0",
                     "if non-zero, # iters between saved snapshots");
+  hestOptAdd_1_UInt(&hopt, "chkp", "# iters", &chkp, "0",
+                    "if non-zero, # iters between checkpoints (saved to "
+                    "\"-chkpo\" in the background), from which run can resume");
+  hestOptAdd_1_String(&hopt, "chkpo", "fname", &chkpOutS, "pull-chkp.nrrd",
+                      "filename for checkpoints, with \"-chkp\"");
+  hestOptAdd_1_String(&hopt, "chkpi", "fname", &chkpInS, "",
+                      "if a filename is given here, resume from this checkpoint "
+                      "(instead of initializing points)");
   hestOptAdd_1_UInt(&hopt, "maxi", "# iters", &iterMax, "0",
                     "if non-zero, max # iterations to run whole system");
   hestOptAdd_1_UInt(&hopt, "stim", "# iters", &stuckIterMax, "5",
@@ -245,8 +260,16 @@ main(int argc, const char **argv) {
                          "you would control the number of threads to use"));
   hestOptAdd_1_Double(&hopt, "nprob", "prob", &neighborTrueProb, "1.0",
                       "do full neighbor discovery with this probability");
+  hestOptAdd_1_Double(&hopt, "nskin", "skin", &neighborSkin, "0.0",
+                      "if non-zero, re-use Verlet neighbor lists with this skin "
+                      "(as a fraction of the interaction radius), until some "
+                      "particle moves more than half of it");
   hestOptAdd_1_Double(&hopt, "pprob", "prob", &probeProb, "1.0",
                       "probe local image values with this probability");
+  hestOptAdd_1_Double(&hopt, "pcq", "quantum", &probeCacheQuantum, "0.0",
+                      "with \"-pcache\": if non-zero, positions within this "
+                      "fraction of a voxel share a cache entry (an approximation); "
+                      "with zero, only identical positions do");
 
   hestOptAdd_1_String(&hopt, "addlog", "fname", &addLogS, "",
                       "name of file in which to log all particle additions");
@@ -287,6 +310,8 @@ main(int argc, const char **argv) {
       || pullFlagSet(pctx, pullFlagPopCntlEnoughTest, popCntlEnoughTest)
       || pullFlagSet(pctx, pullFlagConvergenceIgnoresPopCntl, convergenceIgnoresPopCntl)
       || pullFlagSet(pctx, pullFlagBinSingle, binSingle)
+      || pullFlagSet(pctx, pullFlagBinPack, binPack)
+      || pullFlagSet(pctx, pullFlagProbeCache, probeCache)
       || pullFlagSet(pctx, pullFlagNoAdd, noAdd)
       || pullFlagSet(pctx, pullFlagPermuteOnRebin, permuteOnRebin)
       || pullFlagSet(pctx, pullFlagNoPopCntlWithZeroAlpha, noPopCntlWithZeroAlpha)
@@ -297,6 +322,8 @@ main(int argc, const char **argv) {
       || pullFlagSet(pctx, pullFlagScaleIsTau, scaleIsTau)
       || pullInitUnequalShapesAllowSet(pctx, unequalShapesAllow)
       || pullIterParmSet(pctx, pullIterParmSnap, snap)
+      || pullIterParmSet(pctx, pullIterParmCheckpoint, chkp)
+      || pullCheckpointNameSet(pctx, chkpOutS)
       || pullIterParmSet(pctx, pullIterParmMax, iterMax)
       || pullIterParmSet(pctx, pullIterParmStuckMax, stuckIterMax)
       || pullIterParmSet(pctx, pullIterParmConstraintMax, constraintIterMax)
@@ -321,6 +348,8 @@ main(int argc, const char **argv) {
       || pullSysParmSet(pctx, pullSysParmBackStepScale, backStepScale)
       || pullSysParmSet(pctx, pullSysParmOpporStepScale, opporStepScale)
       || pullSysParmSet(pctx, pullSysParmNeighborTrueProb, neighborTrueProb)
+      || pullSysParmSet(pctx, pullSysParmNeighborSkin, neighborSkin)
+      || pullSysParmSet(pctx, pullSysParmProbeCacheQuantum, probeCacheQuantum)
       || pullSysParmSet(pctx, pullSysParmProbeProb, probeProb)
       || pullRngSeedSet(pctx, rngSeed) || pullProgressBinModSet(pctx, progressBinMod)
       || pullThreadNumSet(pctx, threadNum)
@@ -371,7 +400,7 @@ main(int argc, const char **argv) {
             "meetPullVol specified boundary specs\n\n\n",
             me, hopt[bspOpi].flag);
   }
-  if (pullStart(pctx)) {
+  if (airStrlen(chkpInS) ? pullStartFromCheckpoint(pctx, chkpInS) : pullStart(pctx)) {
     airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
     fprintf(stderr, "%s: trouble starting system:\n%s", me, err);
     airMopError(mop);
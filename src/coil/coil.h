@@ -145,6 +145,18 @@ typedef struct {
                                            coil_t **iv3, double spacing[3],
                                            double parm[COIL_PARMS_NUM]);
   void (*update)(coil_t *val, coil_t *delta); /* how to apply update */
+  /* fused versions of (some of) the filter[] methods, used when radius is 1:
+     these compute the update values for rows [yLo,yHi) of slice zi by
+     reading the neighbors straight out of the interleaved value/update
+     volume vol (see coilContext->nvol) rather than through iv3, and are
+     free to share work (such as fluxes) between adjacent samples. scratch
+     has room for 5*(size[0]+1)*valLen values.  NULL where there isn't one,
+     in which case filter[] is used for each sample */
+  void (*filterBlock[COIL_METHOD_TYPE_MAX + 1])(coil_t *vol, const size_t size[3],
+                                                unsigned int zi, unsigned int yLo,
+                                                unsigned int yHi, coil_t *scratch,
+                                                double spacing[3],
+                                                double parm[COIL_PARMS_NUM]);
 } coilKind;
 
 struct coilContext_t;
@@ -166,6 +178,7 @@ typedef struct {
                               /* how to fill iv3 */
   void (*iv3Fill)(coil_t **iv3, coil_t *here, unsigned int radius, int valLen, int x0,
                   int y0, int z0, int sizeX, int sizeY, int sizeZ);
+  coil_t *scratch; /* working space for kind->filterBlock */
   void *returnPtr; /* for airThreadJoin */
 } coilTask;
 
@@ -190,10 +203,14 @@ typedef struct coilContext_t {
   /* ---------- internal */
   unsigned int iter;               /* what iteration we're on */
   size_t size[3],                  /* size of volume */
-    nextSlice;                     /* global indicator of next slice needing
+    blockNum,                      /* work is handed out to threads in
+                                      blocks of blockRows rows of a slice;
+                                      this is the total number of blocks */
+    nextBlock;                     /* global indicator of next block needing
                                       to be processed, either in filter or
                                       in update stage.  Stage is done when
-                                      nextSlice == size[2] */
+                                      nextBlock == blockNum */
+  unsigned int blockRows;          /* number of rows (along Y) per block */
   double spacing[3];               /* sample spacings we'll use- we perhaps
                                       should be using a gageShape, but this is
                                       actually all we really need . . . */
@@ -204,7 +221,7 @@ typedef struct coilContext_t {
     todoFilter, todoUpdate;        /* flags to signal which is scheduled to
                                       come next, used as part of doling out
                                       slices to workers */
-  airThreadMutex *nextSliceMutex;  /* mutex around nextSlice (and effectively,
+  airThreadMutex *nextBlockMutex;  /* mutex around nextBlock (and effectively,
                                       also the "todo" flags above) */
   coilTask **task;                 /* dynamically allocated array of tasks */
   airThreadBarrier *filterBarrier, /* so that thread 0 can see if filtering
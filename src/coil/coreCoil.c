@@ -108,10 +108,20 @@ _coilIv3Fill_1_7(coil_t **iv3, coil_t *here, unsigned int radius, int valLen, in
   return;
 }
 
-static unsigned int
-_coilThisZGet(coilTask *task, int doFilter) {
+/*
+** with more than one thread, slices are cut into blocks of rows so that
+** there are at least this many blocks per thread
+*/
+#define _COIL_BLOCK_PER_THREAD 8
+
+/*
+** gets the next block to work on in the filter (doFilter) or update stage,
+** or returns blockNum if the stage is done
+*/
+static size_t
+_coilThisBlockGet(coilTask *task, int doFilter) {
   int *thisFlag, *thatFlag;
-  unsigned int thisZ;
+  size_t thisBlock;
 
   if (doFilter) {
     thisFlag = &(task->cctx->todoFilter);
@@ -122,34 +132,39 @@ _coilThisZGet(coilTask *task, int doFilter) {
   }
 
   if (task->cctx->numThreads > 1) {
-    airThreadMutexLock(task->cctx->nextSliceMutex);
+    airThreadMutexLock(task->cctx->nextBlockMutex);
   }
-  if (task->cctx->nextSlice == task->cctx->size[2] && *thisFlag) {
+  if (task->cctx->nextBlock == task->cctx->blockNum && *thisFlag) {
     /* we're the first thread to start this phase */
-    task->cctx->nextSlice = 0;
+    task->cctx->nextBlock = 0;
     *thisFlag = AIR_FALSE;
   }
-  thisZ = AIR_UINT(task->cctx->nextSlice);
-  if (task->cctx->nextSlice < task->cctx->size[2]) {
-    task->cctx->nextSlice++;
-    if (task->cctx->nextSlice == task->cctx->size[2]) {
-      /* we just grabbed the last slice of this phase */
+  thisBlock = task->cctx->nextBlock;
+  if (task->cctx->nextBlock < task->cctx->blockNum) {
+    task->cctx->nextBlock++;
+    if (task->cctx->nextBlock == task->cctx->blockNum) {
+      /* we just grabbed the last block of this phase */
       *thatFlag = AIR_TRUE;
     }
   }
   if (task->cctx->numThreads > 1) {
-    airThreadMutexUnlock(task->cctx->nextSliceMutex);
+    airThreadMutexUnlock(task->cctx->nextBlockMutex);
   }
-  return thisZ;
+  return thisBlock;
 }
 
 static void
 _coilProcess(coilTask *task, int doFilter) {
   static const char me[] = "_coilProcess";
-  unsigned int xi, yi, sizeX, sizeY, thisZ, sizeZ, valLen, radius;
-  coil_t *here;
+  unsigned int xi, yi, sizeX, sizeY, sizeZ, valLen, radius, sliceBlockNum, thisZ, yLo,
+    yHi;
+  size_t thisBlock;
+  coil_t *here, *vol;
   void (*filter)(coil_t * delta, int xi, int yi, int zi, coil_t **iv3, double spacing[3],
                  double parm[COIL_PARMS_NUM]);
+  void (*filterBlock)(coil_t * vol, const size_t size[3], unsigned int zi,
+                      unsigned int yLo, unsigned int yHi, coil_t *scratch,
+                      double spacing[3], double parm[COIL_PARMS_NUM]);
 
   sizeX = AIR_UINT(task->cctx->size[0]);
   sizeY = AIR_UINT(task->cctx->size[1]);
@@ -157,43 +172,39 @@ _coilProcess(coilTask *task, int doFilter) {
   valLen = AIR_UINT(task->cctx->kind->valLen);
   radius = task->cctx->radius;
   filter = task->cctx->kind->filter[task->cctx->method->type];
-  if (doFilter) {
-    while (1) {
-      thisZ = _coilThisZGet(task, doFilter);
-      if (thisZ == sizeZ) {
-        break;
-      }
-      if (task->cctx->verbose > 2) {
-        fprintf(stderr, "%s(%u),f: iter=%u, z=%d\n", me, task->threadIdx,
-                task->cctx->iter, thisZ);
-      }
-      here = (coil_t *)(task->cctx->nvol->data) + 2 * valLen * sizeX * sizeY * thisZ;
-      for (yi = 0; yi < sizeY; yi++) {
-        for (xi = 0; xi < sizeX; xi++) {
+  filterBlock = (1 == radius ? task->cctx->kind->filterBlock[task->cctx->method->type]
+                             : NULL);
+  vol = (coil_t *)(task->cctx->nvol->data);
+  sliceBlockNum = (sizeY + task->cctx->blockRows - 1) / task->cctx->blockRows;
+  while (1) {
+    thisBlock = _coilThisBlockGet(task, doFilter);
+    if (thisBlock == task->cctx->blockNum) {
+      break;
+    }
+    thisZ = AIR_UINT(thisBlock / sliceBlockNum);
+    yLo = AIR_UINT(thisBlock % sliceBlockNum) * task->cctx->blockRows;
+    yHi = AIR_MIN(sizeY, yLo + task->cctx->blockRows);
+    if (task->cctx->verbose > (doFilter ? 2 : 3)) {
+      fprintf(stderr, "%s(%u),%c: iter=%u, z=%u, y=[%u,%u)\n", me, task->threadIdx,
+              doFilter ? 'f' : 'u', task->cctx->iter, thisZ, yLo, yHi);
+    }
+    if (doFilter && filterBlock) {
+      filterBlock(vol, task->cctx->size, thisZ, yLo, yHi, task->scratch,
+                  task->cctx->spacing, task->cctx->parm);
+      continue;
+    }
+    here = vol + 2 * valLen * sizeX * (yLo + sizeY * thisZ);
+    for (yi = yLo; yi < yHi; yi++) {
+      for (xi = 0; xi < sizeX; xi++) {
+        if (doFilter) {
           task->iv3Fill(task->iv3, here + 0 * valLen, radius, valLen, xi, yi, thisZ,
                         sizeX, sizeY, sizeZ);
           filter(here + 1 * valLen, xi, yi, thisZ, task->iv3, task->cctx->spacing,
                  task->cctx->parm);
-          here += 2 * valLen;
-        }
-      }
-    }
-  } else {
-    while (1) {
-      thisZ = _coilThisZGet(task, doFilter);
-      if (thisZ == sizeZ) {
-        break;
-      }
-      if (task->cctx->verbose > 3) {
-        fprintf(stderr, "%s(%u),u: iter=%u, z=%d\n", me, task->threadIdx,
-                task->cctx->iter, thisZ);
-      }
-      here = (coil_t *)(task->cctx->nvol->data) + 2 * valLen * sizeX * sizeY * thisZ;
-      for (yi = 0; yi < sizeY; yi++) {
-        for (xi = 0; xi < sizeX; xi++) {
+        } else {
           task->cctx->kind->update(here + 0 * valLen, here + 1 * valLen);
-          here += 2 * valLen;
         }
+        here += 2 * valLen;
       }
     }
   }
@@ -224,6 +235,7 @@ _coilTaskNew(coilContext *cctx, int threadIdx) {
     } else {
       task->iv3Fill = _coilIv3Fill_R_L;
     }
+    task->scratch = (coil_t *)calloc(5 * (cctx->size[0] + 1) * len, sizeof(coil_t));
     task->returnPtr = NULL;
   }
   return task;
@@ -236,6 +248,7 @@ _coilTaskNix(coilTask *task) {
     task->thread = airThreadNix(task->thread);
     task->_iv3 = (coil_t *)airFree(task->_iv3);
     task->iv3 = (coil_t **)airFree(task->iv3);
+    task->scratch = (coil_t *)airFree(task->scratch);
     free(task);
   }
   return NULL;
@@ -288,7 +301,7 @@ coilStart(coilContext *cctx) {
   static const char me[] = "coilStart";
   int valIdx, valLen;
   coil_t (*lup)(const void *, size_t), *val;
-  unsigned tidx, elIdx;
+  unsigned tidx, elIdx, sliceBlockNum;
 
   if (!cctx) {
     biffAddf(COIL, "%s: got NULL pointer", me);
@@ -300,6 +313,23 @@ coilStart(coilContext *cctx) {
     return 1;
   }
 
+  /* blocks are whole slices unless they need to be smaller for there to be
+     enough blocks for all the threads */
+  sliceBlockNum = 1;
+  if (cctx->numThreads > 1) {
+    sliceBlockNum = _COIL_BLOCK_PER_THREAD * cctx->numThreads;
+    sliceBlockNum = AIR_UINT((sliceBlockNum + cctx->size[2] - 1) / cctx->size[2]);
+    sliceBlockNum = AIR_MIN(sliceBlockNum, AIR_UINT(cctx->size[1]));
+  }
+  cctx->blockRows = AIR_UINT((cctx->size[1] + sliceBlockNum - 1) / sliceBlockNum);
+  /* with the rounding up of blockRows, there may be fewer blocks per slice */
+  sliceBlockNum = AIR_UINT((cctx->size[1] + cctx->blockRows - 1) / cctx->blockRows);
+  cctx->blockNum = sliceBlockNum * cctx->size[2];
+  if (cctx->verbose) {
+    fprintf(stderr, "%s: %u blocks of %u rows per slice\n", me, sliceBlockNum,
+            cctx->blockRows);
+  }
+
   /* we create tasks for ALL threads, including me, thread 0 */
   cctx->task[0] = NULL;
   for (tidx = 0; tidx < cctx->numThreads; tidx++) {
@@ -312,7 +342,7 @@ coilStart(coilContext *cctx) {
 
   cctx->finished = AIR_FALSE;
   if (cctx->numThreads > 1) {
-    cctx->nextSliceMutex = airThreadMutexNew();
+    cctx->nextBlockMutex = airThreadMutexNew();
     cctx->filterBarrier = airThreadBarrierNew(cctx->numThreads);
     cctx->updateBarrier = airThreadBarrierNew(cctx->numThreads);
   }
@@ -344,7 +374,7 @@ coilStart(coilContext *cctx) {
   }
 
   /* set things as though we've just finished an update phase */
-  cctx->nextSlice = cctx->size[2];
+  cctx->nextBlock = cctx->blockNum;
   cctx->todoFilter = AIR_TRUE;
   cctx->todoUpdate = AIR_FALSE;
 
@@ -430,7 +460,7 @@ coilFinish(coilContext *cctx) {
   cctx->task = (coilTask **)airFree(cctx->task);
 
   if (cctx->numThreads > 1) {
-    cctx->nextSliceMutex = airThreadMutexNix(cctx->nextSliceMutex);
+    cctx->nextBlockMutex = airThreadMutexNix(cctx->nextBlockMutex);
     cctx->filterBarrier = airThreadBarrierNix(cctx->filterBarrier);
     cctx->updateBarrier = airThreadBarrierNix(cctx->updateBarrier);
   }
@@ -58,7 +58,10 @@ coilContextNew() {
     cctx->nvol = NULL;
     cctx->finished = AIR_FALSE;
     cctx->task = NULL;
-    cctx->nextSliceMutex = NULL;
+    cctx->blockNum = 0;
+    cctx->nextBlock = 0;
+    cctx->blockRows = 0;
+    cctx->nextBlockMutex = NULL;
     cctx->filterBarrier = NULL;
     cctx->updateBarrier = NULL;
   }
@@ -126,14 +129,14 @@ coilContextAllSet(coilContext *cctx, const Nrrd *nin, const coilKind *kind,
   sx = nin->axis[0 + baseDim].size;
   sy = nin->axis[1 + baseDim].size;
   sz = nin->axis[2 + baseDim].size;
-  if (sz < numThreads) {
+  if (sy * sz < numThreads) {
     char stmp[AIR_STRLEN_SMALL + 1];
-    airSprintSize_t(stmp, sz);
+    airSprintSize_t(stmp, sy * sz);
     fprintf(stderr,
-            "%s: wanted %d threads but volume only has %s slices, "
+            "%s: wanted %d threads but volume only has %s rows, "
             "using %s threads instead\n",
             me, numThreads, stmp, stmp);
-    numThreads = AIR_UINT(sz);
+    numThreads = AIR_UINT(sy * sz);
   }
   ELL_3V_SET(cctx->size, sx, sy, sz);
   xsp = nin->axis[0 + baseDim].spacing;
@@ -314,6 +314,215 @@ _coilKindScalarFilterModifiedCurvatureRings(coil_t *delta,
   delta[0] *= AIR_CAST(coil_t, parm[0]);
 }
 
+/*
+** The fused (filterBlock) scalar kernels.  vol is the interleaved volume of
+** value and update, so the value of sample xi in a row starting at rr is
+** rr[2*xi], and its update goes in rr[2*xi + 1].  Boundaries are handled by
+** clamping (as in the iv3 filling), and the arithmetic is done the same
+** way as in the per-sample filters above, so the results are the same.
+**
+** rr[] are the rows around row yi of slice zi, indexed like the second
+** index of iv3: the yi-1, yi, yi+1 rows of slice zi-1, then of zi, then
+** of zi+1
+*/
+static void
+_coilKindScalarBlockRows(const coil_t *rr[9], coil_t *vol, const size_t size[3],
+                         unsigned int yi, unsigned int zi) {
+  unsigned int yn, zn, yv, zv;
+
+  for (zn = 0; zn < 3; zn++) {
+    zv = AIR_UINT(AIR_CLAMP(0, AIR_INT(zi + zn) - 1, AIR_INT(size[2]) - 1));
+    for (yn = 0; yn < 3; yn++) {
+      yv = AIR_UINT(AIR_CLAMP(0, AIR_INT(yi + yn) - 1, AIR_INT(size[1]) - 1));
+      rr[yn + 3*zn] = vol + 2*size[0]*(yv + size[1]*zv);
+    }
+  }
+}
+
+static coil_t
+_coilKindScalarBlockLaplacian(const coil_t *rr[9], int xm, int xi, int xp,
+                              double spacing[3]) {
+  double ret;
+
+  ret = (  (rr[4][2*xm] - 2*rr[4][2*xi] + rr[4][2*xp])/(spacing[0]*spacing[0])
+         + (rr[3][2*xi] - 2*rr[4][2*xi] + rr[5][2*xi])/(spacing[1]*spacing[1])
+         + (rr[1][2*xi] - 2*rr[4][2*xi] + rr[7][2*xi])/(spacing[2]*spacing[2]));
+  return AIR_CAST(coil_t, ret);
+}
+
+static void
+_coilKindScalarBlockHomogeneous(coil_t *vol, const size_t size[3],
+                                unsigned int zi, unsigned int yLo, unsigned int yHi,
+                                coil_t *scratch, double spacing[3],
+                                double parm[COIL_PARMS_NUM]) {
+  const coil_t *rr[9];
+  coil_t *delta, step;
+  unsigned int yi;
+  int xi, sizeX;
+
+  AIR_UNUSED(scratch);
+  sizeX = AIR_INT(size[0]);
+  step = AIR_CAST(coil_t, parm[0]);
+  for (yi = yLo; yi < yHi; yi++) {
+    _coilKindScalarBlockRows(rr, vol, size, yi, zi);
+    delta = vol + 2*size[0]*(yi + size[1]*zi) + 1;
+    for (xi = 0; xi < sizeX; xi++) {
+      delta[2*xi] = step*_coilKindScalarBlockLaplacian(rr, AIR_MAX(0, xi - 1), xi,
+                                                       AIR_MIN(sizeX - 1, xi + 1),
+                                                       spacing);
+    }
+  }
+}
+
+/*
+** flux through a face, from the gradient (g0,g1,g2) on it, of which gn
+** is the component normal to the face; the same as what the Perona-Malik
+** (!curv) and modified curvature (curv) filters do to forwX[0], etc.
+*/
+static coil_t
+_coilKindScalarFlux(coil_t gn, coil_t g0, coil_t g1, coil_t g2, coil_t KK, int curv) {
+  coil_t LL, eps, denom;
+
+  LL = g0*g0 + g1*g1 + g2*g2;
+  if (curv) {
+    eps = 0.0000000001f;
+    denom = AIR_CAST(coil_t, 1.0/(eps + sqrt(LL)));
+    return gn*(_COIL_CONDUCT(LL, KK)*denom);
+  }
+  return gn*_COIL_CONDUCT(LL, KK);
+}
+
+/*
+** sets flux[xi] to the flux through the faces between rows lo[1] and hi[1],
+** which are adjacent along Y (yAxis) or along Z (!yAxis).  lo[0],hi[0] and
+** lo[2],hi[2] are the rows before and after them along the other axis
+** (Z or Y, respectively)
+*/
+static void
+_coilKindScalarFaceFlux(coil_t *flux, const coil_t *lo[3], const coil_t *hi[3],
+                        int sizeX, coil_t rspX, coil_t rspN, coil_t rspT, coil_t KK,
+                        int yAxis, int curv) {
+  int xi, xm, xp;
+  coil_t gx, gn, gt;
+
+  for (xi = 0; xi < sizeX; xi++) {
+    xm = AIR_MAX(0, xi - 1);
+    xp = AIR_MIN(sizeX - 1, xi + 1);
+    gx = rspX*(lo[1][2*xp] + hi[1][2*xp] - lo[1][2*xm] - hi[1][2*xm])/2;
+    gn = rspN*(hi[1][2*xi] - lo[1][2*xi]);
+    gt = rspT*(lo[2][2*xi] + hi[2][2*xi] - lo[0][2*xi] - hi[0][2*xi])/2;
+    flux[xi] = (yAxis
+                ? _coilKindScalarFlux(gn, gx, gn, gt, KK, curv)
+                : _coilKindScalarFlux(gn, gx, gt, gn, KK, curv));
+  }
+}
+
+/*
+** Perona-Malik (!curv) and modified curvature (curv).  Each flux through
+** a face between two samples is computed once for both of them: along X
+** within a row, and along Y between consecutive rows of the block
+*/
+static void
+_coilKindScalarBlockFlow(coil_t *vol, const size_t size[3],
+                         unsigned int zi, unsigned int yLo, unsigned int yHi,
+                         coil_t *scratch, double spacing[3],
+                         double parm[COIL_PARMS_NUM], int curv) {
+  const coil_t *rr[9], *lo[3], *hi[3];
+  coil_t *fluxX, *fluxYB, *fluxYF, *fluxZB, *fluxZF, *ftmp, *delta,
+    rspX, rspY, rspZ, KK, lerp, step, gx, gy, gz, gm, div;
+  unsigned int yi;
+  int xi, xa, xb, sizeX;
+
+  sizeX = AIR_INT(size[0]);
+  fluxX = scratch;
+  fluxYB = fluxX + sizeX + 1;
+  fluxYF = fluxYB + sizeX + 1;
+  fluxZB = fluxYF + sizeX + 1;
+  fluxZF = fluxZB + sizeX + 1;
+  rspX = AIR_CAST(coil_t, 1.0/spacing[0]);
+  rspY = AIR_CAST(coil_t, 1.0/spacing[1]);
+  rspZ = AIR_CAST(coil_t, 1.0/spacing[2]);
+  KK = AIR_CAST(coil_t, parm[1]*parm[1]);
+  lerp = AIR_CAST(coil_t, parm[2]);
+  step = AIR_CAST(coil_t, parm[0]);
+  for (yi = yLo; yi < yHi; yi++) {
+    _coilKindScalarBlockRows(rr, vol, size, yi, zi);
+    /* fluxX[xi] is through the face between samples xi-1 and xi */
+    for (xi = 0; xi <= sizeX; xi++) {
+      xa = AIR_MAX(0, xi - 1);
+      xb = AIR_MIN(sizeX - 1, xi);
+      gx = rspX*(rr[4][2*xb] - rr[4][2*xa]);
+      gy = rspY*(rr[5][2*xa] + rr[5][2*xb] - rr[3][2*xa] - rr[3][2*xb])/2;
+      gz = rspZ*(rr[7][2*xa] + rr[7][2*xb] - rr[1][2*xa] - rr[1][2*xb])/2;
+      fluxX[xi] = _coilKindScalarFlux(gx, gx, gy, gz, KK, curv);
+    }
+    /* fluxYB, fluxYF: through the faces before and after row yi */
+    if (yi == yLo) {
+      ELL_3V_SET(lo, rr[0], rr[3], rr[6]);
+      ELL_3V_SET(hi, rr[1], rr[4], rr[7]);
+      _coilKindScalarFaceFlux(fluxYB, lo, hi, sizeX, rspX, rspY, rspZ, KK, AIR_TRUE,
+                              curv);
+    } else {
+      ftmp = fluxYB;
+      fluxYB = fluxYF;
+      fluxYF = ftmp;
+    }
+    ELL_3V_SET(lo, rr[1], rr[4], rr[7]);
+    ELL_3V_SET(hi, rr[2], rr[5], rr[8]);
+    _coilKindScalarFaceFlux(fluxYF, lo, hi, sizeX, rspX, rspY, rspZ, KK, AIR_TRUE,
+                            curv);
+    /* fluxZB, fluxZF: through the faces before and after slice zi */
+    ELL_3V_SET(lo, rr[0], rr[1], rr[2]);
+    ELL_3V_SET(hi, rr[3], rr[4], rr[5]);
+    _coilKindScalarFaceFlux(fluxZB, lo, hi, sizeX, rspX, rspZ, rspY, KK, AIR_FALSE,
+                            curv);
+    ELL_3V_SET(lo, rr[3], rr[4], rr[5]);
+    ELL_3V_SET(hi, rr[6], rr[7], rr[8]);
+    _coilKindScalarFaceFlux(fluxZF, lo, hi, sizeX, rspX, rspZ, rspY, KK, AIR_FALSE,
+                            curv);
+    delta = vol + 2*size[0]*(yi + size[1]*zi) + 1;
+    for (xi = 0; xi < sizeX; xi++) {
+      div = (rspX*(fluxX[xi + 1] - fluxX[xi])
+             + rspY*(fluxYF[xi] - fluxYB[xi])
+             + rspZ*(fluxZF[xi] - fluxZB[xi]));
+      if (curv) {
+        xa = AIR_MAX(0, xi - 1);
+        xb = AIR_MIN(sizeX - 1, xi + 1);
+        gx = rspX*(rr[4][2*xb] - rr[4][2*xa]);
+        gy = rspY*(rr[5][2*xi] - rr[3][2*xi]);
+        gz = rspZ*(rr[7][2*xi] - rr[1][2*xi]);
+        gm = AIR_CAST(coil_t, sqrt(gx*gx + gy*gy + gz*gz));
+        delta[2*xi] = (lerp*_coilKindScalarBlockLaplacian(rr, xa, xi, xb, spacing)
+                       + (1-lerp)*gm*div);
+        delta[2*xi] *= step;
+      } else {
+        delta[2*xi] = step*div;
+      }
+    }
+  }
+}
+
+static void
+_coilKindScalarBlockPeronaMalik(coil_t *vol, const size_t size[3],
+                                unsigned int zi, unsigned int yLo, unsigned int yHi,
+                                coil_t *scratch, double spacing[3],
+                                double parm[COIL_PARMS_NUM]) {
+
+  _coilKindScalarBlockFlow(vol, size, zi, yLo, yHi, scratch, spacing, parm,
+                           AIR_FALSE);
+}
+
+static void
+_coilKindScalarBlockModifiedCurvature(coil_t *vol, const size_t size[3],
+                                      unsigned int zi, unsigned int yLo,
+                                      unsigned int yHi, coil_t *scratch,
+                                      double spacing[3],
+                                      double parm[COIL_PARMS_NUM]) {
+
+  _coilKindScalarBlockFlow(vol, size, zi, yLo, yHi, scratch, spacing, parm,
+                           AIR_TRUE);
+}
+
 static void
 _coilKindScalarUpdate(coil_t *val, coil_t *delta) {
 
@@ -333,7 +542,16 @@ _coilKindScalar = {
    NULL,
    NULL,
    NULL},
-  _coilKindScalarUpdate
+  _coilKindScalarUpdate,
+  {NULL,
+   NULL,
+   _coilKindScalarBlockHomogeneous,
+   _coilKindScalarBlockPeronaMalik,
+   _coilKindScalarBlockModifiedCurvature,
+   NULL,
+   NULL,
+   NULL,
+   NULL}
 };
 
 const coilKind *const
@@ -282,7 +282,8 @@ _coilKind7Tensor = {
    NULL,
    _coilKind7TensorFilterSelf,
    _coilKind7TensorFilterFinish},
-  _coilKind7TensorUpdate
+  _coilKind7TensorUpdate,
+  {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL}
 };
 
 const coilKind *const
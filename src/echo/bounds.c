@@ -87,8 +87,8 @@ BNDS_TMPL(
     ELL_3V_MAX(hi, hi, h);
   })
 
-BNDS_TMPL(Split, AIR_UNUSED(obj);
-          fprintf(stderr, "_echoSplit_bounds: unimplemented!\n");)
+BNDS_TMPL(Split, ELL_3V_MIN(lo, obj->min0, obj->min1);
+          ELL_3V_MAX(hi, obj->max0, obj->max1);)
 
 BNDS_TMPL(Instance, echoPos_t a[8][4]; echoPos_t b[8][4]; echoPos_t l[3]; echoPos_t h[3];
 
@@ -124,3 +124,73 @@ void
 echoBoundsGet(echoPos_t *lo, echoPos_t *hi, echoObject *obj) {
   _echoBoundsGet[obj->type](lo, hi, obj);
 }
+
+/*
+** whether echoBoundsGet() can say something useful about obj; the only
+** thing it can't handle is the (unimplemented) isosurface
+*/
+static int
+_echoBoundable(echoObject *obj) {
+  unsigned int ii;
+  int ret;
+
+  switch (obj->type) {
+  case echoTypeIsosurface:
+    ret = AIR_FALSE;
+    break;
+  case echoTypeList:
+    ret = AIR_TRUE;
+    for (ii = 0; ret && ii < AIR_CAST(echoList *, obj)->objArr->len; ii++) {
+      ret = _echoBoundable(AIR_CAST(echoList *, obj)->obj[ii]);
+    }
+    break;
+  case echoTypeInstance:
+    ret = _echoBoundable(AIR_CAST(echoInstance *, obj)->obj);
+    break;
+  default:
+    /* AABBox and Split store their own bounds */
+    ret = AIR_TRUE;
+    break;
+  }
+  return ret;
+}
+
+/*
+******** echoSceneBoundsSet
+**
+** computes scene->rendBounds, the world-space bounding boxes of all the
+** top-level objects, so that echoRayIntx() can skip (without transforming
+** rays into instance space, or descending lists) those that a ray misses.
+** Has to be re-done whenever the scene changes; echoRTRender() calls this.
+*/
+int /* Biff: 1 */
+echoSceneBoundsSet(echoScene *scene) {
+  static const char me[] = "echoSceneBoundsSet";
+  unsigned int idx;
+  echoPos_t *bb;
+
+  if (!scene) {
+    biffAddf(ECHO, "%s: got NULL pointer", me);
+    return 1;
+  }
+  scene->rendBounds = AIR_CAST(echoPos_t *, airFree(scene->rendBounds));
+  scene->rendBoundsNum = 0;
+  if (!scene->rendArr->len) {
+    return 0;
+  }
+  if (!(scene->rendBounds = AIR_CALLOC(6 * scene->rendArr->len, echoPos_t))) {
+    biffAddf(ECHO, "%s: couldn't allocate %u bounding boxes", me, scene->rendArr->len);
+    return 1;
+  }
+  for (idx = 0; idx < scene->rendArr->len; idx++) {
+    bb = scene->rendBounds + 6 * idx;
+    if (_echoBoundable(scene->rend[idx])) {
+      echoBoundsGet(bb + 0, bb + 3, scene->rend[idx]);
+    } else {
+      ELL_3V_SET(bb + 0, AIR_NAN, AIR_NAN, AIR_NAN);
+      ELL_3V_SET(bb + 3, AIR_NAN, AIR_NAN, AIR_NAN);
+    }
+  }
+  scene->rendBoundsNum = scene->rendArr->len;
+  return 0;
+}
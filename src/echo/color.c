@@ -151,7 +151,7 @@ echoIntxLightColor(echoCol_t ambi[3], echoCol_t diff[3], echoCol_t spec[3], echo
     if (parm->shadow) {
       ELL_3V_COPY(shadRay.dir, Ldir);
       shadRay.faar = Ldist;
-      if (echoRayIntx(&shadIntx, &shadRay, scene, parm, tstate)) {
+      if (echoRayIntxShadow(&shadIntx, &shadRay, Lidx, scene, parm, tstate)) {
         if (1.0 == parm->shadow) {
           /* skip to next light, this one is obscured by something,
              and we don't do any partial shadowing */
@@ -112,6 +112,7 @@ typedef struct {
 } echoRTParm;
 
 struct echoScene_t;
+struct echoObject_t;
 
 typedef struct {
   int verbose;
@@ -144,6 +145,13 @@ typedef struct {
   echoCol_t *chanBuff;    /* for storing ray color and other parameters for each
                              of the parm->numSamples rays in current pixel */
   airRandMTState *rst;    /* random number state */
+  /* for shadow rays: occluder[i] is the world-space object (a primitive,
+     or the outermost instance around one) that most recently blocked a
+     shadow ray towards light scene->light[i], which is tested first the
+     next time; shadowInst is set during shadow ray intersection to the
+     outermost instance containing the hit */
+  struct echoObject_t **occluder, *shadowInst;
+  unsigned int occluderNum; /* allocated length of occluder[] */
   void *returnPtr;        /* for airThreadJoin */
 } echoThreadState;
 
@@ -267,7 +275,7 @@ enum {
   echoCol_t mat[ECHO_MATTER_PARM_NUM];                                                  \
   Nrrd *ntext
 
-typedef struct {
+typedef struct echoObject_t {
   signed char type;
   ECHO_OBJECT_MATTER; /* ha! its not actually in every object, but in
                          those cases were we want to access it without
@@ -374,6 +382,13 @@ typedef struct echoScene_t {
   airArray *nrrdArr;
   Nrrd *envmap;      /* 16checker-based diffuse environment map,
                         not touched by echoSceneNix() */
+  echoPos_t *rendBounds;    /* world-space bounding boxes (lo[3] then hi[3])
+                               of each of the rend[] objects, with instances
+                               transformed, as set by echoSceneBoundsSet()
+                               (called by echoRTRender); lo[0] is NaN for
+                               objects that can't be bounded */
+  unsigned int rendBoundsNum; /* number of boxes in rendBounds; only used
+                                 when equal to rendArr->len */
   echoCol_t ambi[3], /* color of ambient light */
     bkgr[3];         /* color of background */
 } echoScene;
@@ -444,6 +459,7 @@ ECHO_EXPORT echoObject *echoRoughSphereNew(echoScene *scene, int theRes, int phi
 
 /* bounds.c --------------------------------------- */
 ECHO_EXPORT void echoBoundsGet(echoPos_t *lo, echoPos_t *hi, echoObject *obj);
+ECHO_EXPORT int echoSceneBoundsSet(echoScene *scene);
 
 /* list.c --------------------------------------- */
 ECHO_EXPORT void echoListAdd(echoObject *parent, echoObject *child);
@@ -502,6 +518,9 @@ ECHO_EXPORT void echoIntxFuzzify(echoIntx *intx, echoCol_t fuzz,
 /* intx.c ------------------------------------------- */
 ECHO_EXPORT int echoRayIntx(echoIntx *intx, echoRay *ray, echoScene *scene,
                             echoRTParm *parm, echoThreadState *tstate);
+ECHO_EXPORT int echoRayIntxShadow(echoIntx *intx, echoRay *ray, unsigned int lightIdx,
+                                  echoScene *scene, echoRTParm *parm,
+                                  echoThreadState *tstate);
 ECHO_EXPORT void echoIntxColor(echoCol_t rgba[4], echoIntx *intx, echoScene *scene,
                                echoRTParm *parm, echoThreadState *tstate);
 
@@ -638,6 +638,12 @@ _echoRayIntx_Instance(RAYINTX_ARGS(Instance)) {
   iray.shadow = ray->shadow;
 
   if (_echoRayIntx[obj->obj->type](intx, &iray, obj->obj, parm, tstate)) {
+    if (ray->shadow) {
+      /* as the recursion unwinds, this ends up as the outermost instance;
+         and normals don't matter */
+      tstate->shadowInst = AIR_CAST(echoObject *, obj);
+      return AIR_TRUE;
+    }
     ELL_4V_SET(a, intx->norm[0], intx->norm[1], intx->norm[2], 0);
     ELL_4MV_TMUL(b, obj->Mi, a);
     ELL_3V_COPY(intx->norm, b);
@@ -695,13 +701,22 @@ int /* Biff: nope */
 echoRayIntx(echoIntx *intx, echoRay *ray, echoScene *scene, echoRTParm *parm,
             echoThreadState *tstate) {
   unsigned int idx;
-  int ret;
+  int ret, bounded;
   echoObject *kid;
-  echoPos_t tmp;
+  echoPos_t tmp, tmin, tmax, *bb;
 
   ret = AIR_FALSE;
+  bounded = (scene->rendBounds && scene->rendBoundsNum == scene->rendArr->len);
   for (idx = 0; idx < scene->rendArr->len; idx++) {
     kid = scene->rend[idx];
+    if (bounded) {
+      bb = scene->rendBounds + 6 * idx;
+      if (AIR_EXISTS(bb[0])
+          && !_echoRayIntx_CubeSolid(&tmin, &tmax, bb[0], bb[3], bb[1], bb[4], bb[2],
+                                     bb[5], ray)) {
+        continue;
+      }
+    }
     if (_echoRayIntx[kid->type](intx, ray, kid, parm, tstate)) {
       ray->faar = intx->t;
       ret = AIR_TRUE;
@@ -723,3 +738,37 @@ echoRayIntx(echoIntx *intx, echoRay *ray, echoScene *scene, echoRTParm *parm,
 
   return ret;
 }
+
+/*
+******** echoRayIntxShadow
+**
+** any-hit intersection of a shadow ray (ray->shadow must be set) towards
+** light scene->light[lightIdx].  Returns non-zero if anything blocks the
+** ray, but nothing about intx is useful afterwards.  The object which
+** blocked the previous shadow ray (from this thread) to the same light
+** is tried first, which, for spatially coherent rays, often obviates
+** the traversal of the whole scene.
+*/
+int /* Biff: nope */
+echoRayIntxShadow(echoIntx *intx, echoRay *ray, unsigned int lightIdx, echoScene *scene,
+                  echoRTParm *parm, echoThreadState *tstate) {
+  echoObject *hint;
+  int ret;
+
+  hint = (lightIdx < tstate->occluderNum ? tstate->occluder[lightIdx] : NULL);
+  if (hint) {
+    tstate->shadowInst = NULL;
+    if (_echoRayIntx[hint->type](intx, ray, hint, parm, tstate)) {
+      return AIR_TRUE;
+    }
+  }
+  tstate->shadowInst = NULL;
+  ret = echoRayIntx(intx, ray, scene, parm, tstate);
+  if (lightIdx < tstate->occluderNum) {
+    /* on a miss, the next ray is probably also unblocked, so forget hint */
+    tstate->occluder[lightIdx] = (ret ? (tstate->shadowInst ? tstate->shadowInst
+                                                            : intx->obj)
+                                      : NULL);
+  }
+  return ret;
+}
@@ -104,6 +104,9 @@ echoThreadStateNew(void) {
     state->jitt = NULL;
     state->chanBuff = NULL;
     state->rst = airRandMTStateNew(0);
+    state->occluder = NULL;
+    state->occluderNum = 0;
+    state->shadowInst = NULL;
     state->returnPtr = NULL;
   }
   return state;
@@ -118,6 +121,7 @@ echoThreadStateNix(echoThreadState *state) {
     nrrdNuke(state->nperm);
     state->permBuff = AIR_CAST(unsigned int *, airFree(state->permBuff));
     state->chanBuff = AIR_CAST(echoCol_t *, airFree(state->chanBuff));
+    state->occluder = AIR_CAST(echoObject **, airFree(state->occluder));
     airFree(state);
   }
   return NULL;
@@ -147,6 +151,8 @@ echoSceneNew(void) {
                                ECHO_LIST_OBJECT_INCR);
     airArrayPointerCB(ret->nrrdArr, airNull, (void *(*)(void *))nrrdNuke);
     ret->envmap = NULL;
+    ret->rendBounds = NULL;
+    ret->rendBoundsNum = 0;
     ELL_3V_SET(ret->ambi, 1.0, 1.0, 1.0);
     ELL_3V_SET(ret->bkgr, 0.0, 0.0, 0.0);
   }
@@ -192,6 +198,7 @@ echoSceneNix(echoScene *scene) {
     airArrayNuke(scene->lightArr);
     airArrayNuke(scene->nrrdArr);
     /* don't touch envmap nrrd */
+    airFree(scene->rendBounds);
     airFree(scene);
   }
   return NULL;
@@ -63,6 +63,17 @@ echoThreadStateInit(int threadIdx, echoThreadState *tstate, echoRTParm *parm,
     return 1;
   }
 
+  tstate->occluder = AIR_CAST(echoObject **, airFree(tstate->occluder));
+  tstate->occluderNum = 0;
+  if (gstate->scene && gstate->scene->lightArr->len) {
+    if (!(tstate->occluder = AIR_CALLOC(gstate->scene->lightArr->len, echoObject *))) {
+      biffAddf(ECHO, "%s: couldn't allocate shadow occluder hints", me);
+      return 1;
+    }
+    tstate->occluderNum = gstate->scene->lightArr->len;
+  }
+  tstate->shadowInst = NULL;
+
   airSrandMT_r(tstate->rst, AIR_UINT((parm->seedRand ? airTime() : threadIdx)));
   tstate->returnPtr = NULL;
 
@@ -417,6 +428,10 @@ echoRTRender(Nrrd *nraw, limnCamera *cam, echoScene *scene, echoRTParm *parm,
     biffAddf(ECHO, "%s: problem with input", me);
     return 1;
   }
+  if (echoSceneBoundsSet(scene)) {
+    biffAddf(ECHO, "%s: problem bounding scene", me);
+    return 1;
+  }
   gstate->nraw = nraw;
   gstate->cam = cam;
   gstate->scene = scene;
@@ -914,3 +914,275 @@ ell_6ms_eigensolve_d(double eval[6], double _evec[36], const double sym[21],
 
   return 0;
 }
+
+/* ____________________________ 3ms batch ____________________________ */
+
+/* # matrices ell_3ms_eigensolve_batch_d works on at a time */
+#define _ELL_3MS_BATCH 64
+
+/*
+** for the simple root lam of the (scaled) symmetric matrix with unique
+** entries a[] (xx, xy, xz, yy, yz, zz): the largest of the cross products
+** of the rows of a - lam*I is parallel to the eigenvector
+*/
+static void
+_ell_3ms_evec_simple_d(double ev[3], const double a[6], double lam) {
+  double r0[3], r1[3], r2[3], c0[3], c1[3], c2[3], d0, d1, d2, dm;
+
+  ELL_3V_SET(r0, a[0] - lam, a[1], a[2]);
+  ELL_3V_SET(r1, a[1], a[3] - lam, a[4]);
+  ELL_3V_SET(r2, a[2], a[4], a[5] - lam);
+  ELL_3V_CROSS(c0, r0, r1);
+  ELL_3V_CROSS(c1, r0, r2);
+  ELL_3V_CROSS(c2, r1, r2);
+  d0 = ELL_3V_DOT(c0, c0);
+  d1 = ELL_3V_DOT(c1, c1);
+  d2 = ELL_3V_DOT(c2, c2);
+  if (d0 >= d1 && d0 >= d2) {
+    dm = d0;
+    ELL_3V_COPY(ev, c0);
+  } else if (d1 >= d2) {
+    dm = d1;
+    ELL_3V_COPY(ev, c1);
+  } else {
+    dm = d2;
+    ELL_3V_COPY(ev, c2);
+  }
+  if (dm > 0) {
+    dm = 1.0 / sqrt(dm);
+    ELL_3V_SCALE(ev, dm, ev);
+  } else {
+    /* a - lam*I has rank < 2, which shouldn't happen for a simple root */
+    ELL_3V_SET(ev, 1, 0, 0);
+  }
+}
+
+/*
+** given unit-length eigenvector ev0 of a, sets w0 and w1 to its other two
+** eigenvectors, by diagonalizing (with one Jacobi rotation) the 2x2
+** restriction of a to the plane perpendicular to ev0.  This is accurate
+** even when the other two eigenvalues are nearly or exactly equal.
+*/
+static void
+_ell_3ms_evec_perp_d(double w0[3], double w1[3], const double a[6],
+                     const double ev0[3]) {
+  double uu[3], vv[3], au[3], av[3], len, m00, m01, m11, theta, tt, cc, ss;
+
+  /* uu and vv are an orthonormal basis for the plane perpendicular to ev0 */
+  if (fabs(ev0[0]) > fabs(ev0[1])) {
+    len = 1.0 / sqrt(ev0[0] * ev0[0] + ev0[2] * ev0[2]);
+    ELL_3V_SET(uu, -ev0[2] * len, 0, ev0[0] * len);
+  } else {
+    len = 1.0 / sqrt(ev0[1] * ev0[1] + ev0[2] * ev0[2]);
+    ELL_3V_SET(uu, 0, ev0[2] * len, -ev0[1] * len);
+  }
+  ELL_3V_CROSS(vv, ev0, uu);
+  ELL_3V_SET(au, a[0] * uu[0] + a[1] * uu[1] + a[2] * uu[2],
+             a[1] * uu[0] + a[3] * uu[1] + a[4] * uu[2],
+             a[2] * uu[0] + a[4] * uu[1] + a[5] * uu[2]);
+  ELL_3V_SET(av, a[0] * vv[0] + a[1] * vv[1] + a[2] * vv[2],
+             a[1] * vv[0] + a[3] * vv[1] + a[4] * vv[2],
+             a[2] * vv[0] + a[4] * vv[1] + a[5] * vv[2]);
+  m00 = ELL_3V_DOT(uu, au);
+  m01 = ELL_3V_DOT(uu, av);
+  m11 = ELL_3V_DOT(vv, av);
+  if (m01) {
+    theta = (m11 - m00) / (2 * m01);
+    tt = (theta >= 0 ? 1 : -1) / (fabs(theta) + sqrt(theta * theta + 1));
+    cc = 1.0 / sqrt(tt * tt + 1);
+    ss = tt * cc;
+  } else {
+    cc = 1;
+    ss = 0;
+  }
+  ELL_3V_SCALE_ADD2(w0, cc, uu, -ss, vv);
+  ELL_3V_SCALE_ADD2(w1, ss, uu, cc, vv);
+}
+
+/* sets dd = evec * a * evec' (the rows of evec are the eigenvectors) */
+static void
+_ell_3ms_rayleigh_d(double dd[9], const double a[6], const double evec[9]) {
+  double am[9], tmp[9], evecT[9];
+
+  ELL_3M_SET(am, a[0], a[1], a[2], a[1], a[3], a[4], a[2], a[4], a[5]);
+  ELL_3M_TRANSPOSE(evecT, evec);
+  ELL_3M_MUL(tmp, am, evecT);
+  ELL_3M_MUL(dd, evec, tmp);
+}
+
+/*
+** sets eval to the Rayleigh quotients of the rows of evec, sorts them
+** (and evec) in descending order, and makes evec right-handed
+*/
+static void
+_ell_3ms_finish_d(double eval[3], double evec[9], const double a[6]) {
+  static const unsigned int pair[3][2] = {{0, 1}, {0, 2}, {1, 2}};
+  double tmp, vp[3], cr[3], *vv;
+  unsigned int pi, pp, qq;
+
+  for (pi = 0; pi < 3; pi++) {
+    vv = evec + 3 * pi;
+    ELL_3V_SET(vp, a[0] * vv[0] + a[1] * vv[1] + a[2] * vv[2],
+               a[1] * vv[0] + a[3] * vv[1] + a[4] * vv[2],
+               a[2] * vv[0] + a[4] * vv[1] + a[5] * vv[2]);
+    eval[pi] = ELL_3V_DOT(vv, vp);
+  }
+  for (pi = 0; pi < 3; pi++) {
+    pp = pair[pi][0];
+    qq = pair[pi][1];
+    if (eval[pp] < eval[qq]) {
+      ELL_SWAP2(eval[pp], eval[qq], tmp);
+      ELL_3V_COPY(vp, evec + 3 * pp);
+      ELL_3V_COPY(evec + 3 * pp, evec + 3 * qq);
+      ELL_3V_COPY(evec + 3 * qq, vp);
+    }
+  }
+  ELL_3V_CROSS(cr, evec + 0, evec + 3);
+  if (ELL_3V_DOT(cr, evec + 6) < 0) {
+    ELL_3V_SCALE(evec + 6, -1, evec + 6);
+  }
+}
+
+/*
+** polishes the eigenvectors evec of a by iter sweeps of cyclic Jacobi
+** rotations of its rows, each of which zeros one off-diagonal entry of
+** evec * a * evec'
+*/
+static void
+_ell_3ms_jacobi_d(double evec[9], const double a[6], unsigned int iter) {
+  static const unsigned int pair[3][2] = {{0, 1}, {0, 2}, {1, 2}};
+  double dd[9], theta, tt, cc, ss, vp[3], vq[3];
+  unsigned int ii, pi, pp, qq;
+
+  for (ii = 0; ii < iter; ii++) {
+    for (pi = 0; pi < 3; pi++) {
+      pp = pair[pi][0];
+      qq = pair[pi][1];
+      _ell_3ms_rayleigh_d(dd, a, evec);
+      if (!dd[pp + 3 * qq]) {
+        continue;
+      }
+      theta = (dd[qq + 3 * qq] - dd[pp + 3 * pp]) / (2 * dd[pp + 3 * qq]);
+      tt = (theta >= 0 ? 1 : -1) / (fabs(theta) + sqrt(theta * theta + 1));
+      cc = 1.0 / sqrt(tt * tt + 1);
+      ss = tt * cc;
+      ELL_3V_COPY(vp, evec + 3 * pp);
+      ELL_3V_COPY(vq, evec + 3 * qq);
+      ELL_3V_SCALE_ADD2(evec + 3 * pp, cc, vp, -ss, vq);
+      ELL_3V_SCALE_ADD2(evec + 3 * qq, ss, vp, cc, vq);
+    }
+  }
+}
+
+/*
+******** ell_3ms_eigensolve_batch_d()
+**
+** finds the eigenvalues, and (if evec is non-NULL) eigenvectors, of num
+** symmetric 3x3 matrices.  The unique entries of matrix ii are given in
+** sym + ii*stride, ordered xx, xy, xz, yy, yz, zz (so the matrices
+** can be, for example, the tensors of a 7-by-N ten array, after the
+** confidence: sym = ten + 1 and stride = 7).  The eigenvalues of matrix
+** ii are put in eval + 3*ii, and its eigenvectors in evec + 9*ii, with
+** the same ordering and conventions as in ell_3m_eigensolve_d():
+** eigenvalues are sorted in descending order, and the eigenvectors are
+** the rows of a right-handed rotation matrix.
+**
+** Unlike ell_3m_eigensolve_d(), which solves the characteristic cubic
+** with Newton polishing and then finds nullspaces, this uses a closed-form
+** (trigonometric) solution of the cubic, with no iteration or special
+** cases for root multiplicities, so that the eigenvalues of a block of
+** matrices are found together in a straight-line loop that compilers
+** can vectorize.  For eigenvectors (after D. Eberly, "A Robust
+** Eigensolver for 3x3 Symmetric Matrices"), the one for the most separated
+** eigenvalue is a cross-product of rows of the shifted matrix, and the
+** other two diagonalize the 2x2 problem in the plane perpendicular to it;
+** with jacobiIter > 0 these are further polished by that many sweeps of
+** Jacobi rotations.  Whenever eigenvectors are computed (which is always
+** when jacobiIter > 0, even if evec is NULL), the eigenvalues are their
+** Rayleigh quotients, which are accurate to near machine precision.  The
+** closed-form eigenvalues alone (evec NULL and jacobiIter 0) are the
+** fastest, but two (nearly) equal eigenvalues may only be accurate to
+** about the square root of machine precision, relative to the largest.
+** A multiple of the identity gets the identity as its eigenvectors.
+**
+** This does NOT use biff
+*/
+void
+ell_3ms_eigensolve_batch_d(double *eval, double *evec, const double *sym,
+                           size_t stride, size_t num, unsigned int jacobiIter) {
+  double aa[6 * _ELL_3MS_BATCH], mx[_ELL_3MS_BATCH], hd[_ELL_3MS_BATCH],
+    ee[3 * _ELL_3MS_BATCH], vbuf[9];
+  const double *ss;
+  double *aI, *eI, *vI, scl, qq, b0, b3, b5, off, pp, det, ang, beta0, beta2;
+  size_t base, nn, ii;
+
+  if (!(eval && sym)) {
+    return;
+  }
+  for (base = 0; base < num; base += nn) {
+    nn = AIR_MIN(_ELL_3MS_BATCH, num - base);
+    /* eigenvalues, without branching (beyond that in min, max, clamp) */
+    for (ii = 0; ii < nn; ii++) {
+      ss = sym + stride * (base + ii);
+      aI = aa + 6 * ii;
+      mx[ii] = AIR_MAX(AIR_MAX(fabs(ss[0]), fabs(ss[1])),
+                       AIR_MAX(AIR_MAX(fabs(ss[2]), fabs(ss[3])),
+                               AIR_MAX(fabs(ss[4]), fabs(ss[5]))));
+      /* scaling by the largest entry avoids over- and under-flow */
+      scl = mx[ii] ? 1.0 / mx[ii] : 1.0;
+      aI[0] = scl * ss[0];
+      aI[1] = scl * ss[1];
+      aI[2] = scl * ss[2];
+      aI[3] = scl * ss[3];
+      aI[4] = scl * ss[4];
+      aI[5] = scl * ss[5];
+      /* with B = (A - qq*I)/pp, the eigenvalues of A are qq + pp*beta,
+         for the roots beta = 2*cos(ang + 2*k*pi/3) of det(beta*I - B),
+         where cos(3*ang) = det(B)/2 */
+      qq = (aI[0] + aI[3] + aI[5]) / 3;
+      b0 = aI[0] - qq;
+      b3 = aI[3] - qq;
+      b5 = aI[5] - qq;
+      off = aI[1] * aI[1] + aI[2] * aI[2] + aI[4] * aI[4];
+      pp = sqrt((b0 * b0 + b3 * b3 + b5 * b5 + 2 * off) / 6);
+      det = (b0 * (b3 * b5 - aI[4] * aI[4]) - aI[1] * (aI[1] * b5 - aI[4] * aI[2])
+             + aI[2] * (aI[1] * aI[4] - b3 * aI[2]));
+      hd[ii] = pp ? det / (2 * pp * pp * pp) : 0;
+      hd[ii] = AIR_CLAMP(-1.0, hd[ii], 1.0);
+      ang = acos(hd[ii]) / 3;
+      beta2 = 2 * cos(ang);
+      beta0 = 2 * cos(ang + 2 * AIR_PI / 3);
+      eI = ee + 3 * ii;
+      eI[0] = qq + pp * beta2;
+      eI[1] = qq - pp * (beta0 + beta2);
+      eI[2] = qq + pp * beta0;
+      /* exactly isotropic is flagged with hd > 1 */
+      hd[ii] = pp ? hd[ii] : 2;
+    }
+    for (ii = 0; ii < nn; ii++) {
+      aI = aa + 6 * ii;
+      eI = ee + 3 * ii;
+      if (evec || jacobiIter) {
+        vI = evec ? evec + 9 * (base + ii) : vbuf;
+        if (hd[ii] > 1) {
+          ELL_3M_IDENTITY_SET(vI);
+        } else {
+          /* the eigenvector of the most separated eigenvalue, and then
+             the other two in the plane perpendicular to it; these may be
+             out of order, but _ell_3ms_finish_d sorts them */
+          if (hd[ii] >= 0) {
+            _ell_3ms_evec_simple_d(vI + 0, aI, eI[0]);
+            _ell_3ms_evec_perp_d(vI + 3, vI + 6, aI, vI + 0);
+          } else {
+            _ell_3ms_evec_simple_d(vI + 6, aI, eI[2]);
+            _ell_3ms_evec_perp_d(vI + 0, vI + 3, aI, vI + 6);
+          }
+          _ell_3ms_jacobi_d(vI, aI, jacobiIter);
+          _ell_3ms_finish_d(eI, vI, aI);
+        }
+      }
+      ELL_3V_SCALE(eval + 3 * (base + ii), mx[ii], eI);
+    }
+  }
+  return;
+}
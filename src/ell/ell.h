@@ -254,6 +254,9 @@ ELL_EXPORT int ell_3m_svd_d(double uu[9], double sval[3], double vv[9],
                             const double mat[9], const int newton);
 ELL_EXPORT int ell_6ms_eigensolve_d(double eval[6], double evec[36],
                                     const double mat[21], const double eps);
+ELL_EXPORT void ell_3ms_eigensolve_batch_d(double *eval, double *evec,
+                                           const double *sym, size_t stride,
+                                           size_t num, unsigned int jacobiIter);
 
 #ifdef __cplusplus
 }
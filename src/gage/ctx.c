@@ -918,3 +918,28 @@ gageProbeSpace(gageContext *ctx, double xx, double yy, double zz, int indexSpace
 
   return _gageProbeSpace(ctx, xx, yy, zz, AIR_NAN, indexSpace, clamp);
 }
+
+/*
+******** gageProbeLevel
+**
+** for probing a coarser level of a multi-resolution pyramid (as from
+** nrrdPyramid) with positions given in the index space of the finest
+** level, whose shape is shapeFine: the position is mapped to world space
+** with shapeFine, and then probed (with clamping) in ctxLevel, which has
+** been set up on the coarser level.  Because nrrdPyramid preserves the
+** world-space extent of the volume, the answers from different levels
+** are comparable.
+*/
+int /* Biff: nope */
+gageProbeLevel(gageContext *ctxLevel, const gageShape *shapeFine, double xi, double yi,
+               double zi) {
+  double posI[3], posW[3];
+
+  if (!(ctxLevel && shapeFine)) {
+    return 1;
+  }
+  ELL_3V_SET(posI, xi, yi, zi);
+  gageShapeItoW(shapeFine, posW, posI);
+  return _gageProbeSpace(ctxLevel, posW[0], posW[1], posW[2], AIR_NAN, AIR_FALSE,
+                         AIR_TRUE);
+}
@@ -1266,6 +1266,8 @@ GAGE_EXPORT void gageKernelReset(gageContext *ctx);
 GAGE_EXPORT int gageProbe(gageContext *ctx, double xi, double yi, double zi);
 GAGE_EXPORT int gageProbeSpace(gageContext *ctx, double x, double y, double z,
                                int indexSpace, int clamp);
+GAGE_EXPORT int gageProbeLevel(gageContext *ctxLevel, const gageShape *shapeFine,
+                               double xi, double yi, double zi);
 
 /* update.c */
 GAGE_EXPORT int gageUpdate(gageContext *ctx);
@@ -82,6 +82,29 @@ typedef int(hooverRayEnd_t)(void *thread, void *render, void *user);
 typedef int(hooverThreadEnd_t)(void *thread, void *render, void *user);
 typedef int(hooverRenderEnd_t)(void *rend, void *user);
 
+/*
+******** hooverStats struct
+**
+** counters accumulated by hoover during one hooverRender(), either for
+** one thread or summed over all threads.  The callback times are only
+** measured when hooverContext->timing is non-zero, because calling
+** airTime() around every sample isn't free.
+*/
+typedef struct {
+  size_t rays,           /* number of rays cast */
+    samples,             /* number of calls to sample() */
+    insideSamples,       /* number of those samples inside the volume */
+    earlyRays;           /* number of rays ended by sample() returning 0.0
+                            (e.g. early ray termination), rather than by
+                            leaving the near-far clipping region */
+  double timeRayBegin,   /* seconds spent in rayBegin() */
+    timeSample,          /* seconds spent in sample() */
+    timeRayEnd,          /* seconds spent in rayEnd() */
+    timeRender;          /* (for sum over threads) wall-clock seconds for the
+                            whole hooverRender(), from renderBegin() through
+                            renderEnd(), whether or not timing is set */
+} hooverStats;
+
 /*
 ******** hooverContext struct
 **
@@ -93,6 +116,7 @@ typedef int(hooverRenderEnd_t)(void *rend, void *user);
 ** 5) opaque "user information" pointer
 ** 6) stuff about multi-threading
 ** 7) the callbacks
+** 8) statistics (output) from the last rendering
 */
 typedef struct {
 
@@ -233,6 +257,13 @@ typedef struct {
   */
   hooverRenderEnd_t *renderEnd;
 
+  /******** 8) statistics (output) from the last rendering */
+  int timing;                                 /* (input) if non-zero, measure
+                                                 time spent in callbacks */
+  hooverStats stats,                          /* summed over all threads */
+    threadStats[HOOVER_THREAD_MAX];           /* per-thread (only first
+                                                 numThreads are meaningful) */
+
 } hooverContext;
 
 /*
@@ -270,6 +301,8 @@ HOOVER_EXPORT const airEnum *const hooverErr;
 HOOVER_EXPORT hooverContext *hooverContextNew(void);
 HOOVER_EXPORT int hooverContextCheck(hooverContext *ctx);
 HOOVER_EXPORT void *hooverContextNix(hooverContext *ctx);
+HOOVER_EXPORT void hooverStatsPrint(FILE *file, const hooverContext *ctx);
+HOOVER_EXPORT double hooverPixelSize(const hooverContext *ctx, const double posW[3]);
 
 /* rays.c */
 HOOVER_EXPORT int hooverRender(hooverContext *ctx, int *errCodeP, int *errThreadP);
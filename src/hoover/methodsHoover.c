@@ -45,6 +45,8 @@ hooverContextNew() {
     ctx->rayEnd = hooverStubRayEnd;
     ctx->threadEnd = hooverStubThreadEnd;
     ctx->renderEnd = hooverStubRenderEnd;
+    ctx->timing = AIR_FALSE;
+    /* stats and threadStats are zeroed by calloc, and reset by hooverRender */
   }
   return (ctx);
 }
@@ -170,3 +172,77 @@ hooverContextNix(hooverContext *ctx) {
   }
   return NULL;
 }
+
+/*
+******** hooverStatsPrint
+**
+** prints a summary of the statistics from the last hooverRender, with
+** per-thread sample counts (to show load balance) if there was more than
+** one thread
+*/
+void
+hooverStatsPrint(FILE *file, const hooverContext *ctx) {
+  char stmp[4][AIR_STRLEN_SMALL + 1];
+  const hooverStats *st;
+  unsigned int thr;
+
+  if (!(file && ctx)) {
+    return;
+  }
+  st = &(ctx->stats);
+  fprintf(file, "hoover: %s rays (%s ended early), %s samples (%s inside)\n",
+          airSprintSize_t(stmp[0], st->rays), airSprintSize_t(stmp[1], st->earlyRays),
+          airSprintSize_t(stmp[2], st->samples),
+          airSprintSize_t(stmp[3], st->insideSamples));
+  fprintf(file, "hoover: render time = %g secs", st->timeRender);
+  if (st->rays) {
+    fprintf(file, "; %g samples/ray", (double)st->samples / st->rays);
+  }
+  fprintf(file, "\n");
+  if (ctx->timing) {
+    fprintf(file,
+            "hoover: thread-secs in rayBegin = %g, sample = %g, rayEnd = %g\n",
+            st->timeRayBegin, st->timeSample, st->timeRayEnd);
+  }
+  if (ctx->numThreads > 1) {
+    for (thr = 0; thr < ctx->numThreads; thr++) {
+      fprintf(file, "hoover: thread %u: %s rays, %s samples\n", thr,
+              airSprintSize_t(stmp[0], ctx->threadStats[thr].rays),
+              airSprintSize_t(stmp[1], ctx->threadStats[thr].samples));
+    }
+  }
+  return;
+}
+
+/*
+******** hooverPixelSize
+**
+** world-space distance, at world-space position posW, between the rays of
+** adjacent pixels: the projected footprint of one pixel.  This is useful
+** for picking a level of detail (e.g. from a nrrdPyramid) for rendering.
+** Camera must have been set by limnCameraUpdate() (which hooverRender()
+** does before calling renderBegin).  Returns NaN on bad input.
+*/
+double
+hooverPixelSize(const hooverContext *ctx, const double posW[3]) {
+  double du, dv, pitch, diff[3], depth;
+
+  if (!(ctx && ctx->cam && posW && ctx->imgSize[0] > 1 && ctx->imgSize[1] > 1)) {
+    return AIR_NAN;
+  }
+  if (nrrdCenterCell == ctx->imgCentering) {
+    du = (ctx->cam->uRange[1] - ctx->cam->uRange[0]) / ctx->imgSize[0];
+    dv = (ctx->cam->vRange[1] - ctx->cam->vRange[0]) / ctx->imgSize[1];
+  } else {
+    du = (ctx->cam->uRange[1] - ctx->cam->uRange[0]) / (ctx->imgSize[0] - 1);
+    dv = (ctx->cam->vRange[1] - ctx->cam->vRange[0]) / (ctx->imgSize[1] - 1);
+  }
+  /* pitch on the image plane (at distance vspDist from eye) */
+  pitch = AIR_MAX(AIR_ABS(du), AIR_ABS(dv));
+  if (!ctx->cam->orthographic) {
+    ELL_3V_SUB(diff, posW, ctx->cam->from);
+    depth = ELL_3V_DOT(diff, ctx->cam->N);
+    pitch *= AIR_MAX(depth, ctx->cam->vspNeer) / ctx->cam->vspDist;
+  }
+  return pitch;
+}
@@ -112,6 +112,14 @@ _hooverExtraContextNix(_hooverExtraContext *ec) {
   return NULL;
 }
 
+static void
+_hooverStatsReset(hooverStats *st) {
+
+  st->rays = st->samples = st->insideSamples = st->earlyRays = 0;
+  st->timeRayBegin = st->timeSample = st->timeRayEnd = st->timeRender = 0;
+  return;
+}
+
 /*
 ** _hooverThreadArg struct
 **
@@ -162,10 +170,16 @@ _hooverThreadBody(void *_arg) {
     rayStartW[3],       /* ray start on near plane (world-space) */
     rayStartI[3],       /* ray start on near plane (index-space) */
     rayStep,            /* distance between samples (world-space) */
-    vOff[3], uOff[3];   /* offsets in arg->ec->wU and arg->ec->wV
+    vOff[3], uOff[3],   /* offsets in arg->ec->wU and arg->ec->wV
                            directions towards start of ray */
+    time0 = 0;          /* start time of current callback, if timing */
+  hooverStats stats;    /* local copy (to avoid false sharing) of this
+                           thread's statistics */
+  int timing;
 
   arg = (_hooverThreadArg *)_arg;
+  _hooverStatsReset(&stats);
+  timing = arg->ctx->timing;
   if ((ret = (arg->ctx->threadBegin)(&thread,
                                      arg->render,
                                      arg->ctx->user,
@@ -287,12 +301,15 @@ _hooverThreadBody(void *_arg) {
         rayLen = ((arg->ctx->cam->vspFaar - arg->ctx->cam->vspNeer)
                   / ELL_3V_DOT(rayDirW, arg->ctx->cam->N));
       }
+      if (timing) time0 = airTime();
       if ((ret = (arg->ctx->rayBegin)(thread, arg->render, arg->ctx->user, uI, vI,
                                       rayLen, rayStartW, rayStartI, rayDirW, rayDirI))) {
         arg->errCode = ret;
         arg->whichErr = hooverErrRayBegin;
         return arg;
       }
+      if (timing) stats.timeRayBegin += airTime() - time0;
+      stats.rays++;
 
       sampleI = 0;
       rayT = 0;
@@ -305,8 +322,12 @@ _hooverThreadBody(void *_arg) {
         }
         inside = (AIR_IN_CL(mm, rayPosI[0], Mx) && AIR_IN_CL(mm, rayPosI[1], My)
                   && AIR_IN_CL(mm, rayPosI[2], Mz));
+        if (timing) time0 = airTime();
         rayStep = (arg->ctx->sample)(thread, arg->render, arg->ctx->user, sampleI, rayT,
                                      inside, rayPosW, rayPosI);
+        if (timing) stats.timeSample += airTime() - time0;
+        stats.samples++;
+        stats.insideSamples += !!inside;
         if (!AIR_EXISTS(rayStep)) {
           /* sampling failed */
           arg->errCode = 0;
@@ -315,6 +336,7 @@ _hooverThreadBody(void *_arg) {
         }
         if (!rayStep) {
           /* ray decided to finish itself */
+          stats.earlyRays++;
           break;
         }
         /* else we moved to a new location along the ray */
@@ -326,14 +348,17 @@ _hooverThreadBody(void *_arg) {
         sampleI++;
       }
 
+      if (timing) time0 = airTime();
       if ((ret = (arg->ctx->rayEnd)(thread, arg->render, arg->ctx->user))) {
         arg->errCode = ret;
         arg->whichErr = hooverErrRayEnd;
         return arg;
       }
+      if (timing) stats.timeRayEnd += airTime() - time0;
     } /* end this scanline */
   }   /* end while(1) assignment of scanlines */
 
+  arg->ctx->threadStats[arg->whichThread] = stats;
   if ((ret = (arg->ctx->threadEnd)(thread, arg->render, arg->ctx->user))) {
     arg->errCode = ret;
     arg->whichErr = hooverErrThreadEnd;
@@ -368,6 +393,7 @@ hooverRender(hooverContext *ctx, int *errCodeP, int *errThreadP) {
   int ret;
   airArray *mop;
   unsigned int threadIdx;
+  double time0;
 
   if (!(errCodeP && errThreadP)) {
     biffAddf(HOOVER, "%s: got NULL int return pointer", me);
@@ -390,6 +416,11 @@ hooverRender(hooverContext *ctx, int *errCodeP, int *errThreadP) {
   }
   mop = airMopNew();
   airMopAdd(mop, ec, (airMopper)_hooverExtraContextNix, airMopAlways);
+  _hooverStatsReset(&(ctx->stats));
+  for (threadIdx = 0; threadIdx < ctx->numThreads; threadIdx++) {
+    _hooverStatsReset(ctx->threadStats + threadIdx);
+  }
+  time0 = airTime();
   if ((ret = (ctx->renderBegin)(&render, ctx->user))) {
     *errCodeP = ret;
     *errCodeP = 0;
@@ -458,6 +489,13 @@ hooverRender(hooverContext *ctx, int *errCodeP, int *errThreadP) {
       return errArg->whichErr;
     }
     thread[threadIdx] = airThreadNix(thread[threadIdx]);
+    ctx->stats.rays += ctx->threadStats[threadIdx].rays;
+    ctx->stats.samples += ctx->threadStats[threadIdx].samples;
+    ctx->stats.insideSamples += ctx->threadStats[threadIdx].insideSamples;
+    ctx->stats.earlyRays += ctx->threadStats[threadIdx].earlyRays;
+    ctx->stats.timeRayBegin += ctx->threadStats[threadIdx].timeRayBegin;
+    ctx->stats.timeSample += ctx->threadStats[threadIdx].timeSample;
+    ctx->stats.timeRayEnd += ctx->threadStats[threadIdx].timeRayEnd;
   }
 
   if (1 < ctx->numThreads) {
@@ -469,6 +507,7 @@ hooverRender(hooverContext *ctx, int *errCodeP, int *errThreadP) {
     *errThreadP = -1;
     return hooverErrRenderEnd;
   }
+  ctx->stats.timeRender = airTime() - time0;
   render = NULL;
   airMopOkay(mop);
 
@@ -35,3 +35,15 @@ int miteDefNormalSide = 1;
 double miteDefOpacNear1 = 0.98;
 
 double miteDefOpacMatters = 0.05;
+
+int miteDefPreint = AIR_FALSE;
+
+int miteDefAdaptStep = AIR_FALSE;
+
+double miteDefAdaptStepMin = 1.0;
+
+double miteDefAdaptStepMax = 4.0;
+
+double miteDefAdaptOpacMax = 0.02;
+
+double miteDefLodScale = 1.0;
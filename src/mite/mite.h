@@ -100,6 +100,27 @@ enum {
 ** function, and ntxf->axis[0].size is the number of variables in the range.
 */
 
+/*
+******** miteStats struct
+**
+** counters from mite's per-sample work, accumulated per-thread and then
+** summed into the miteUser at the end of rendering.  The times (in
+** seconds, summed over threads) are only measured when the
+** hooverContext's timing is set; hoover itself times ray setup and
+** the sample callback as a whole (see hooverStats)
+*/
+typedef struct {
+  size_t probes,     /* number of gageProbe calls */
+    shades,          /* number of samples with non-zero opacity, which were
+                        shaded and composited */
+    opaqueRays;      /* number of rays terminated because their opacity
+                        reached opacNear1 */
+  double timeProbe,  /* time in gageProbe */
+    timeTxf,         /* time computing miteVals and running txf stages */
+    timeShade,       /* time in shading (_miteRGBACalc) */
+    timeComposite;   /* time in compositing */
+} miteStats;
+
 /*
 ******** miteUser struct
 **
@@ -160,6 +181,33 @@ typedef struct {
                           ray */
     opacNear1;         /* opacity close enough to unity for the sake of
                           doing early ray termination */
+  int preint;          /* if non-zero, use pre-integrated transfer function
+                          tables (built in miteRenderBegin) for those txfs
+                          with only scalar domain variables, so that each
+                          sample accounts for the whole segment between it
+                          and the previous sample, rather than just the
+                          value at the sample point */
+  /* adaptive ray stepping: with adaptStep non-zero, the step to the next
+     sample is scaled (relative to rayStep) so that, by a linear prediction
+     from the scalar volume gradient magnitude, the scalar value changes by
+     about adaptValErr, with the scaling clamped to [adaptStepMin,
+     adaptStepMax].  Steps larger than rayStep are only taken where the
+     sample opacity (corrected for rayStep) is at or below adaptOpacMax.
+     Opacity correction is adjusted for the step actually taken. */
+  int adaptStep;       /* non-zero to enable adaptive ray stepping */
+  double adaptStepMin, /* smallest step scaling (<= 1) for near boundaries */
+    adaptStepMax,      /* largest step scaling (>= 1) in homogeneous regions */
+    adaptValErr,       /* allowed (predicted) change in scalar value per step */
+    adaptOpacMax;      /* largest sample opacity at which steps can grow */
+  /* level of detail: if nsinLevelNum is non-zero, nsinLevel[i] is nsin
+     decimated by 2^(i+1) (as by nrrdPyramid with baseDim 0), and the level
+     actually rendered (0 being nsin itself) is picked in miteRenderBegin:
+     the coarsest level with voxels no bigger than lodScale times the pixel
+     footprint (hooverPixelSize) at the volume center.  Only possible when
+     rendering just a scalar volume. */
+  Nrrd **nsinLevel;          /* array of coarser levels, managed by user */
+  unsigned int nsinLevelNum; /* length of nsinLevel[] */
+  double lodScale;           /* < 1 favors finer levels, > 1 coarser */
   hooverContext *hctx; /* context and input for all hoover-related things,
                           including camera and image parameters */
   double fakeFrom[3],  /* if non-NaN, then the "V"-dependent miteVal's will
@@ -190,7 +238,11 @@ typedef struct {
                          multiple renderings */
   /* output information from last rendering */
   double rendTime, /* rendering time, in seconds */
-    sampRate;      /* rate (KHz) at which samples were rendered */
+    sampRate,      /* rate (KHz) at which samples were rendered */
+    stepMean;      /* mean step size taken inside the volume, as a multiple of
+                      rayStep (always 1.0 unless adaptStep) */
+  unsigned int levelUsed; /* level of detail rendered (0 unless nsinLevelNum) */
+  miteStats stats; /* summed over all threads */
 } miteUser;
 
 struct miteThread_t;
@@ -246,6 +298,13 @@ typedef struct {
                                           these have been converted/unquantized to
                                           type mite_t */
   unsigned int ntxfNum;                /* allocated and valid length of ntxf[] */
+  Nrrd **npreint;                      /* if muu->preint, array (length ntxfNum)
+                                          of pre-integrated versions of ntxf[]; with
+                                          NULL for txfs that can't be pre-integrated.
+                                          Axis 0 is the txf range, axes 1 and 2 are
+                                          the front and back samples of the txf's
+                                          axis 1 domain variable, and then come the
+                                          remaining txf domain axes */
   int sclPvlIdx, vecPvlIdx, tenPvlIdx; /* indices of the different gageKinds of
                                           volumes in the gageContext's array of
                                           gagePerVolumes.  Probably a hack */
@@ -316,6 +375,11 @@ typedef struct {
                                          == number of pointers in range[] to use */
   char *label;                        /* pointer into axis label identifying txf
                                          domain variable, NOT COPIED */
+  int preint,                         /* data points into a pre-integrated table,
+                                         indexed by previous and current sample */
+    prevIdx;                          /* if preint: txf index of the previous
+                                         sample along this ray, or -1 at the
+                                         start of the ray */
 } miteStage;
 
 /*
@@ -374,6 +438,7 @@ typedef struct miteThread_t {
   gageContext *gctx;    /* per-thread context */
   double *ansScl,       /* pointer to gageKindScl answer vector */
     *nPerp, *geomTens,  /* convenience pointers into ansScl */
+    *gradMag,           /* pointer into ansScl, for adaptive stepping */
     *ansVec,            /* pointer to gageKindVec answer vector */
     *ansTen,            /* pointer to tenGageKind answer vector */
     *ansMiteVal,        /* room for all the miteVal answers, which
@@ -409,10 +474,15 @@ typedef struct miteThread_t {
                                    over-written by txf evaluation */
     rayStep,                    /* per-ray step (may need to be different for
                                    each ray to enable sampling on planes) */
+    stepFactor,                 /* (adaptStep) length of step taken to reach
+                                   the current sample, relative to rayStep */
     V[3],                       /* per-ray view direction */
     RR, GG, BB, TT,             /* per-ray composited values */
     ZZ;                         /* for storing ray-depth when opacity passed
                                    muu->opacMatters */
+  double stepSum;               /* sum of stepFactor over all samples handled
+                                   so far by this thread */
+  miteStats stats;              /* this thread's statistics */
   airArray *rmop;               /* for things allocated which are rendering
                                    (or rendering parameter) specific and which
                                    are thread-specific */
@@ -426,6 +496,12 @@ MITE_EXPORT int miteDefRenorm;
 MITE_EXPORT int miteDefNormalSide;
 MITE_EXPORT double miteDefOpacNear1;
 MITE_EXPORT double miteDefOpacMatters;
+MITE_EXPORT int miteDefPreint;
+MITE_EXPORT int miteDefAdaptStep;
+MITE_EXPORT double miteDefAdaptStepMin;
+MITE_EXPORT double miteDefAdaptStepMax;
+MITE_EXPORT double miteDefAdaptOpacMax;
+MITE_EXPORT double miteDefLodScale;
 
 /* kindnot.c */
 MITE_EXPORT const airEnum *const miteVal;
@@ -437,6 +513,7 @@ MITE_EXPORT const char *const miteRangeChar;
 MITE_EXPORT int miteVariableParse(gageItemSpec *isp, const char *label);
 MITE_EXPORT void miteVariablePrint(char *buff, const gageItemSpec *isp);
 MITE_EXPORT int miteNtxfCheck(const Nrrd *ntxf);
+MITE_EXPORT int miteNtxfPreint(Nrrd *nout, const Nrrd *ntxf, double frac);
 MITE_EXPORT void miteQueryAdd(gageQuery queryScl, gageQuery queryVec, gageQuery queryTen,
                               gageQuery queryMite, gageItemSpec *isp);
 
@@ -456,6 +533,7 @@ MITE_EXPORT void miteShadeSpecQueryAdd(gageQuery queryScl, gageQuery queryVec,
 /* renderMite.c */
 MITE_EXPORT int miteRenderBegin(miteRender **mrrP, miteUser *muu);
 MITE_EXPORT int miteRenderEnd(miteRender *mrr, miteUser *muu);
+MITE_EXPORT void miteStatsPrint(FILE *file, const miteUser *muu);
 
 /* thread.c */
 MITE_EXPORT miteThread *miteThreadNew(void);
@@ -31,6 +31,9 @@ extern "C" {
 #  define limnVTOQN limnVtoQN_f
 #endif
 
+/* renderMite.c */
+extern void _miteStatsReset(miteStats *stats);
+
 /* txf.c */
 extern double *_miteAnswerPointer(miteThread *mtt, gageItemSpec *isp);
 extern int _miteNtxfAlphaAdjust(miteRender *mrr, miteUser *muu);
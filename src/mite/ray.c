@@ -27,6 +27,7 @@ miteRayBegin(miteThread *mtt, miteRender *mrr, miteUser *muu, int uIndex, int vI
              double rayLen, double rayStartWorld[3], double rayStartIndex[3],
              double rayDirWorld[3], double rayDirIndex[3]) {
   airPtrPtrUnion appu;
+  unsigned int stageIdx;
   AIR_UNUSED(mrr);
   AIR_UNUSED(rayStartWorld);
   AIR_UNUSED(rayStartIndex);
@@ -57,6 +58,10 @@ miteRayBegin(miteThread *mtt, miteRender *mrr, miteUser *muu, int uIndex, int vI
                                 128);
   }
   mtt->raySample = 0;
+  mtt->stepFactor = 1.0;
+  for (stageIdx = 0; stageIdx < mtt->stageNum; stageIdx++) {
+    mtt->stage[stageIdx].prevIdx = -1;
+  }
   mtt->RR = mtt->GG = mtt->BB = 0.0;
   mtt->TT = 1.0;
   mtt->ZZ = AIR_NAN;
@@ -146,6 +151,29 @@ _miteRGBACalc(mite_t *R, mite_t *G, mite_t *B, mite_t *A, miteThread *mtt,
   return;
 }
 
+/*
+** _miteStepFactorNext
+**
+** for adaptive stepping: determines the length (relative to rayStep) of
+** the step from the current sample to the next one, based on how far we
+** can go before the scalar value is predicted (from the gradient magnitude)
+** to change by muu->adaptValErr.  Steps only grow past rayStep in regions
+** that are nearly transparent, given the (rayStep-corrected) opacity
+** alpha of the current sample.
+*/
+static mite_t
+_miteStepFactorNext(miteThread *mtt, miteUser *muu, mite_t alpha) {
+  double gm, fac;
+
+  gm = mtt->gradMag[0] * mtt->rayStep;
+  fac = (gm > 0 ? muu->adaptValErr / gm : muu->adaptStepMax);
+  if (alpha > muu->adaptOpacMax) {
+    fac = AIR_MIN(fac, 1.0);
+  }
+  fac = AIR_CLAMP(muu->adaptStepMin, fac, muu->adaptStepMax);
+  return AIR_CAST(mite_t, fac);
+}
+
 /* interesting test of whether the python wrapper can catch this :) */
 double /* Biff: AIR_NAN */
 miteSample(miteThread *mtt, miteRender *mrr, miteUser *muu, int num, double rayT,
@@ -153,9 +181,18 @@ miteSample(miteThread *mtt, miteRender *mrr, miteUser *muu, int num, double rayT
   static const char me[] = "miteSample";
   mite_t R, G, B, A;
   double *NN;
-  double NdotV, kn[3], knd[3], ref[3], len, *dbg = NULL;
+  double NdotV, kn[3], knd[3], ref[3], len, *dbg = NULL, time0 = 0;
+  int timing;
+  unsigned int stageIdx;
 
   if (!inside) {
+    /* a pre-integrated segment shouldn't span the gap outside the volume,
+       so pre-integration starts over if the ray comes back in, as does
+       the adaptive step size */
+    mtt->stepFactor = 1.0;
+    for (stageIdx = 0; stageIdx < mtt->stageNum; stageIdx++) {
+      mtt->stage[stageIdx].prevIdx = -1;
+    }
     return mtt->rayStep;
   }
 
@@ -167,8 +204,10 @@ miteSample(miteThread *mtt, miteRender *mrr, miteUser *muu, int num, double rayT
   /* early ray termination */
   if (1 - mtt->TT >= muu->opacNear1) {
     mtt->TT = 0.0;
+    mtt->stats.opaqueRays++;
     return 0.0;
   }
+  timing = muu->hctx->timing;
 
   /* set (fake) view based on fake from */
   if (AIR_EXISTS(muu->fakeFrom[0])) {
@@ -178,11 +217,18 @@ miteSample(miteThread *mtt, miteRender *mrr, miteUser *muu, int num, double rayT
 
   /* do probing at this location to determine values of everything
      that might appear in the txf domain */
+  if (timing) time0 = airTime();
   if (gageProbe(mtt->gctx, samplePosIndex[0], samplePosIndex[1], samplePosIndex[2])) {
     biffAddf(MITE, "%s: gage trouble: %s (%d)", me, mtt->gctx->errStr,
              mtt->gctx->errNum);
     return AIR_NAN;
   }
+  mtt->stats.probes++;
+  if (timing) {
+    double time1 = airTime();
+    mtt->stats.timeProbe += time1 - time0;
+    time0 = time1;
+  }
 
   if (mrr->queryMiteNonzero) {
     /* There is some optimal trade-off between slowing things down
@@ -240,6 +286,7 @@ miteSample(miteThread *mtt, miteRender *mrr, miteUser *muu, int num, double rayT
 
   memcpy(mtt->range, muu->rangeInit, MITE_RANGE_NUM * sizeof(mite_t));
   _miteStageRun(mtt, muu);
+  if (timing) mtt->stats.timeTxf += airTime() - time0;
 
   /* if there's opacity, do shading and compositing */
   if (mtt->range[miteRangeAlpha]) {
@@ -250,11 +297,24 @@ miteSample(miteThread *mtt, miteRender *mrr, miteUser *muu, int num, double rayT
               me, mtt->RR, mtt->GG, mtt->BB, mtt->TT);
     }
     */
+    if (timing) time0 = airTime();
     _miteRGBACalc(&R, &G, &B, &A, mtt, mrr, muu);
+    if (timing) {
+      double time1 = airTime();
+      mtt->stats.timeShade += time1 - time0;
+      time0 = time1;
+    }
+    if (1.0 != mtt->stepFactor) {
+      /* the txf opacities were corrected for rayStep, but this sample
+         accounts for a different length along the ray */
+      A = 1 - pow(1 - A, mtt->stepFactor);
+    }
     mtt->RR += mtt->TT * A * R;
     mtt->GG += mtt->TT * A * G;
     mtt->BB += mtt->TT * A * B;
     mtt->TT *= 1 - A;
+    mtt->stats.shades++;
+    if (timing) mtt->stats.timeComposite += airTime() - time0;
     /*
     if (mtt->verbose) {
       fprintf(stderr, "%s: after compositing: RGBT = %g,%g,%g,%g\n",
@@ -281,8 +341,12 @@ miteSample(miteThread *mtt, miteRender *mrr, miteUser *muu, int num, double rayT
 
   /* this is used to index mtt->debug */
   mtt->raySample += 1;
+  mtt->stepSum += mtt->stepFactor;
 
-  return mtt->rayStep;
+  if (muu->adaptStep) {
+    mtt->stepFactor = _miteStepFactorNext(mtt, muu, mtt->range[miteRangeAlpha]);
+  }
+  return mtt->rayStep * mtt->stepFactor;
 }
 
 int /* Biff: nope */
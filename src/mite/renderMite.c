@@ -22,6 +22,14 @@
 #include "mite.h"
 #include "privateMite.h"
 
+void
+_miteStatsReset(miteStats *stats) {
+
+  stats->probes = stats->shades = stats->opaqueRays = 0;
+  stats->timeProbe = stats->timeTxf = stats->timeShade = stats->timeComposite = 0;
+  return;
+}
+
 static miteRender *
 _miteRenderNew(void) {
   miteRender *mrr;
@@ -35,6 +43,7 @@ _miteRenderNew(void) {
     }
     mrr->ntxf = NULL;
     mrr->ntxfNum = 0;
+    mrr->npreint = NULL;
     mrr->sclPvlIdx = -1;
     mrr->vecPvlIdx = -1;
     mrr->tenPvlIdx = -1;
@@ -59,10 +68,51 @@ _miteRenderNix(miteRender *mrr) {
   return NULL;
 }
 
+/*
+** picks which level of detail of the scalar volume to render (see
+** muu->nsinLevelNum), and sets muu->shape (and hence the index space of
+** the hoover rays) to match it
+*/
+static int
+_miteLevelPick(const Nrrd **nsinP, miteUser *muu) {
+  static const char me[] = "_miteLevelPick";
+  gageShape *shape;
+  double posI[3], posW[3], vox, foot;
+  unsigned int level;
+
+  if (!muu->nsinLevelNum) {
+    *nsinP = muu->nsin;
+    muu->levelUsed = 0;
+    return 0;
+  }
+  shape = gageShapeNew();
+  if (gageShapeSet(shape, muu->nsin, 0)) {
+    biffMovef(MITE, GAGE, "%s: trouble with %s volume shape", me, gageKindScl->name);
+    gageShapeNix(shape);
+    return 1;
+  }
+  ELL_3V_SET(posI, (shape->size[0] - 1) / 2.0, (shape->size[1] - 1) / 2.0,
+             (shape->size[2] - 1) / 2.0);
+  gageShapeItoW(shape, posW, posI);
+  vox = AIR_MIN(shape->spacing[0], AIR_MIN(shape->spacing[1], shape->spacing[2]));
+  gageShapeNix(shape);
+  foot = hooverPixelSize(muu->hctx, posW);
+  level = nrrdPyramidLevelPick(muu->lodScale * foot / vox, muu->nsinLevelNum);
+  *nsinP = level ? muu->nsinLevel[level - 1] : muu->nsin;
+  if (gageShapeSet(muu->shape, *nsinP, 0)) {
+    biffMovef(MITE, GAGE, "%s: trouble with level %u shape", me, level);
+    return 1;
+  }
+  muu->hctx->shape = muu->shape;
+  muu->levelUsed = level;
+  return 0;
+}
+
 int /* Biff: 1 */
 miteRenderBegin(miteRender **mrrP, miteUser *muu) {
   static const char me[] = "miteRenderBegin";
   gagePerVolume *pvl;
+  const Nrrd *nsin;
   int E, pvlIdx;
   gageQuery queryScl, queryVec, queryTen;
   gageItemSpec isp;
@@ -76,6 +126,10 @@ miteRenderBegin(miteRender **mrrP, miteUser *muu) {
     biffAddf(MITE, "%s: problem with user-set parameters", me);
     return 1;
   }
+  if (_miteLevelPick(&nsin, muu)) {
+    biffAddf(MITE, "%s: trouble picking level of detail", me);
+    return 1;
+  }
   if (!(*mrrP = _miteRenderNew())) {
     biffAddf(MITE, "%s: couldn't alloc miteRender", me);
     return 1;
@@ -101,11 +155,14 @@ miteRenderBegin(miteRender **mrrP, miteUser *muu) {
   miteShadeSpecQueryAdd(queryScl, queryVec, queryTen, (*mrrP)->queryMite,
                         (*mrrP)->shadeSpec);
   (*mrrP)->queryMiteNonzero = GAGE_QUERY_NONZERO((*mrrP)->queryMite);
+  if (muu->adaptStep) {
+    GAGE_QUERY_ITEM_ON(queryScl, gageSclGradMag);
+  }
 
   E = 0;
   pvlIdx = 0;
-  if (muu->nsin) {
-    if (!E) E |= !(pvl = gagePerVolumeNew(muu->gctx0, muu->nsin, gageKindScl));
+  if (nsin) {
+    if (!E) E |= !(pvl = gagePerVolumeNew(muu->gctx0, nsin, gageKindScl));
     if (!E) E |= gageQuerySet(muu->gctx0, pvl, queryScl);
     if (!E) E |= gagePerVolumeAttach(muu->gctx0, pvl);
     if (!E) (*mrrP)->sclPvlIdx = pvlIdx++;
@@ -167,14 +224,53 @@ miteRenderBegin(miteRender **mrrP, miteUser *muu) {
 int /* Biff: nope */
 miteRenderEnd(miteRender *mrr, miteUser *muu) {
   unsigned int thr;
-  double samples;
+  double samples, stepSum;
 
   muu->rendTime = airTime() - mrr->time0;
-  samples = 0;
+  samples = stepSum = 0;
+  _miteStatsReset(&(muu->stats));
   for (thr = 0; thr < muu->hctx->numThreads; thr++) {
+    const miteStats *tst = &(mrr->tt[thr]->stats);
     samples += mrr->tt[thr]->samples;
+    stepSum += mrr->tt[thr]->stepSum;
+    muu->stats.probes += tst->probes;
+    muu->stats.shades += tst->shades;
+    muu->stats.opaqueRays += tst->opaqueRays;
+    muu->stats.timeProbe += tst->timeProbe;
+    muu->stats.timeTxf += tst->timeTxf;
+    muu->stats.timeShade += tst->timeShade;
+    muu->stats.timeComposite += tst->timeComposite;
   }
   muu->sampRate = samples / (1000.0 * muu->rendTime);
+  muu->stepMean = samples ? stepSum / samples : 0;
   _miteRenderNix(mrr);
   return 0;
 }
+
+/*
+******** miteStatsPrint
+**
+** prints the statistics from the last rendering; call hooverStatsPrint
+** on muu->hctx for hoover's side of things
+*/
+void
+miteStatsPrint(FILE *file, const miteUser *muu) {
+  char stmp[3][AIR_STRLEN_SMALL + 1];
+  const miteStats *st;
+
+  if (!(file && muu)) {
+    return;
+  }
+  st = &(muu->stats);
+  fprintf(file, "mite: %s probes, %s shaded samples, %s opaque rays\n",
+          airSprintSize_t(stmp[0], st->probes), airSprintSize_t(stmp[1], st->shades),
+          airSprintSize_t(stmp[2], st->opaqueRays));
+  fprintf(file, "mite: render time = %g secs, sampling rate = %g KHz, mean step = %g\n",
+          muu->rendTime, muu->sampRate, muu->stepMean);
+  if (muu->hctx->timing) {
+    fprintf(file,
+            "mite: thread-secs in probe = %g, txf = %g, shade = %g, composite = %g\n",
+            st->timeProbe, st->timeTxf, st->timeShade, st->timeComposite);
+  }
+  return;
+}
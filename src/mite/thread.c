@@ -65,6 +65,9 @@ miteThreadNew() {
   mtt->ui = mtt->vi = -1;
   mtt->raySample = 0;
   mtt->samples = 0;
+  mtt->stepSum = 0;
+  _miteStatsReset(&(mtt->stats));
+  mtt->gradMag = NULL;
   mtt->stage = NULL;
   /* mtt->range[], rayStep, V, RR, GG, BB, TT  initialized in
      miteRayBegin or in miteSample */
@@ -112,10 +115,13 @@ miteThreadBegin(miteThread **mttP, miteRender *mrr, miteUser *muu, int whichThre
     (*mttP)->nPerp = ((*mttP)->ansScl + gageKindAnswerOffset(gageKindScl, gageSclNPerp));
     (*mttP)->geomTens = ((*mttP)->ansScl
                          + gageKindAnswerOffset(gageKindScl, gageSclGeomTens));
+    (*mttP)->gradMag = ((*mttP)->ansScl
+                        + gageKindAnswerOffset(gageKindScl, gageSclGradMag));
   } else {
     (*mttP)->ansScl = NULL;
     (*mttP)->nPerp = NULL;
     (*mttP)->geomTens = NULL;
+    (*mttP)->gradMag = NULL;
   }
   (*mttP)->ansVec = (-1 != mrr->vecPvlIdx ? (*mttP)->gctx->pvl[mrr->vecPvlIdx]->answer
                                           : NULL);
@@ -124,6 +130,8 @@ miteThreadBegin(miteThread **mttP, miteRender *mrr, miteUser *muu, int whichThre
   (*mttP)->thrid = whichThread;
   (*mttP)->raySample = 0;
   (*mttP)->samples = 0;
+  (*mttP)->stepSum = 0;
+  _miteStatsReset(&((*mttP)->stats));
   (*mttP)->verbose = 0;
   (*mttP)->skip = 0;
   (*mttP)->_normal = _miteAnswerPointer(*mttP, mrr->normalSpec);
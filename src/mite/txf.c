@@ -446,6 +446,182 @@ _miteNtxfCopy(miteRender *mrr, miteUser *muu) {
   return 0;
 }
 
+/*
+******** miteNtxfPreint()
+**
+** builds a pre-integrated version of the given transfer function, for
+** the domain variable on axis 1.  Entry [r][f][b][...] of nout is the
+** result of treating the axis 1 variable as going linearly from txf
+** index f (the front sample) to index b (the back sample), over a ray
+** segment of length frac (relative to the "reference" step), with the
+** other domain indices [...] held fixed.  The opacity ("A", if present)
+** is opacity-corrected by frac (so that f == b gives the same as the
+** regular opacity correction), and the other range variables are
+** averaged over the segment, weighted by the opacity's extinction
+** coefficient (or straight averages, with no opacity).  Self-attenuation
+** within the segment is ignored, which lets this be computed from prefix
+** sums in time proportional to the size of the output.
+**
+** ntxf has to be of type mite_t, and should NOT already be opacity
+** corrected.  The output will be one dimension higher than ntxf, with
+** axis info copied from the corresponding axes of ntxf
+*/
+int /* Biff: 1 */
+miteNtxfPreint(Nrrd *nout, const Nrrd *ntxf, double frac) {
+  static const char me[] = "miteNtxfPreint";
+  size_t size[NRRD_DIM_MAX];
+  int axmap[NRRD_DIM_MAX], alphaIdx;
+  unsigned int axi, rnum, snum, onum, oi, fi, bi, ii, lo, hi, len, ri;
+  const mite_t *idata;
+  mite_t *odata, *optr, trans;
+  double *tsum, *wsum, *usum, tau, ttot;
+  const char *rangeStr, *aptr;
+  airArray *mop;
+
+  if (!(nout && ntxf)) {
+    biffAddf(MITE, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (mite_nt != ntxf->type) {
+    biffAddf(MITE, "%s: need txf type %s (not %s)", me, airEnumStr(nrrdType, mite_nt),
+             airEnumStr(nrrdType, ntxf->type));
+    return 1;
+  }
+  if (!(2 <= ntxf->dim && ntxf->dim < NRRD_DIM_MAX)) {
+    biffAddf(MITE, "%s: txf dim %u not in [2,%u]", me, ntxf->dim, NRRD_DIM_MAX - 1);
+    return 1;
+  }
+  if (!(AIR_EXISTS(frac) && frac > 0)) {
+    biffAddf(MITE, "%s: need positive step fraction (not %g)", me, frac);
+    return 1;
+  }
+  rangeStr = ntxf->axis[0].label;
+  if (airStrlen(rangeStr) != ntxf->axis[0].size) {
+    biffAddf(MITE, "%s: axis[0] label \"%s\" doesn't identify txf range", me,
+             rangeStr ? rangeStr : "(null)");
+    return 1;
+  }
+  rnum = AIR_UINT(ntxf->axis[0].size);
+  snum = AIR_UINT(ntxf->axis[1].size);
+  onum = AIR_UINT(nrrdElementNumber(ntxf) / (rnum * snum));
+  aptr = strchr(rangeStr, miteRangeChar[miteRangeAlpha]);
+  alphaIdx = aptr ? AIR_INT(aptr - rangeStr) : -1;
+
+  size[0] = rnum;
+  axmap[0] = 0;
+  size[1] = size[2] = snum;
+  axmap[1] = axmap[2] = 1;
+  for (axi = 2; axi < ntxf->dim; axi++) {
+    size[axi + 1] = ntxf->axis[axi].size;
+    axmap[axi + 1] = AIR_INT(axi);
+  }
+  if (nrrdMaybeAlloc_nva(nout, mite_nt, ntxf->dim + 1, size)
+      || nrrdAxisInfoCopy(nout, ntxf, axmap, NRRD_AXIS_INFO_NONE)
+      || nrrdKeyValueCopy(nout, ntxf)) {
+    biffMovef(MITE, NRRD, "%s: trouble allocating pre-integrated txf", me);
+    return 1;
+  }
+
+  mop = airMopNew();
+  /* prefix sums (with snum+1 entries per range variable) of extinction
+     (tsum), extinction-weighted range values (wsum), and range values (usum) */
+  tsum = AIR_CALLOC(snum + 1, double);
+  airMopAdd(mop, tsum, airFree, airMopAlways);
+  wsum = AIR_CALLOC(rnum * (snum + 1), double);
+  airMopAdd(mop, wsum, airFree, airMopAlways);
+  usum = AIR_CALLOC(rnum * (snum + 1), double);
+  airMopAdd(mop, usum, airFree, airMopAlways);
+  if (!(tsum && wsum && usum)) {
+    biffAddf(MITE, "%s: couldn't allocate prefix sum buffers", me);
+    airMopError(mop);
+    return 1;
+  }
+  idata = (const mite_t *)ntxf->data;
+  odata = (mite_t *)nout->data;
+  for (oi = 0; oi < onum; oi++) {
+    for (ii = 0; ii < snum; ii++) {
+      const mite_t *ivec = idata + rnum * (ii + snum * oi);
+      if (-1 != alphaIdx) {
+        /* a tiny bit of transparency keeps the log finite */
+        trans = AIR_MAX(1 - ivec[alphaIdx], 1e-12);
+        tau = -log(trans);
+      } else {
+        tau = 0;
+      }
+      tsum[ii + 1] = tsum[ii] + tau;
+      for (ri = 0; ri < rnum; ri++) {
+        wsum[ri + rnum * (ii + 1)] = wsum[ri + rnum * ii] + tau * ivec[ri];
+        usum[ri + rnum * (ii + 1)] = usum[ri + rnum * ii] + ivec[ri];
+      }
+    }
+    for (bi = 0; bi < snum; bi++) {
+      for (fi = 0; fi < snum; fi++) {
+        lo = AIR_MIN(fi, bi);
+        hi = AIR_MAX(fi, bi);
+        len = hi - lo + 1;
+        ttot = tsum[hi + 1] - tsum[lo];
+        optr = odata + rnum * (fi + snum * (bi + snum * oi));
+        for (ri = 0; ri < rnum; ri++) {
+          if (AIR_INT(ri) == alphaIdx) {
+            optr[ri] = AIR_CAST(mite_t, 1 - exp(-frac * ttot / len));
+          } else if (ttot > 0) {
+            optr[ri] = AIR_CAST(mite_t, (wsum[ri + rnum * (hi + 1)] - wsum[ri + rnum * lo])
+                                          / ttot);
+          } else {
+            optr[ri] = AIR_CAST(mite_t,
+                                (usum[ri + rnum * (hi + 1)] - usum[ri + rnum * lo]) / len);
+          }
+        }
+      }
+    }
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+** _miteNtxfPreintSet
+**
+** builds mrr->npreint[] from the (not yet opacity corrected) mrr->ntxf[],
+** for those txfs that have only scalar domain variables.  The vector
+** quantization of vector domain variables doesn't have a meaningful
+** ordering along which to integrate, so those txfs are left alone, with
+** a NULL mrr->npreint[] entry (which is how _miteStageSet knows to use
+** the plain txf for them).
+*/
+static int /* Biff: 1 */
+_miteNtxfPreintSet(miteRender *mrr, miteUser *muu, double frac) {
+  static const char me[] = "_miteNtxfPreintSet";
+  unsigned int ni, axi;
+  gageItemSpec isp;
+  int scalarOnly;
+
+  mrr->npreint = AIR_CALLOC(mrr->ntxfNum, Nrrd *);
+  if (!mrr->npreint) {
+    biffAddf(MITE, "%s: couldn't calloc %u npreint pointers", me, mrr->ntxfNum);
+    return 1;
+  }
+  airMopAdd(mrr->rmop, mrr->npreint, airFree, airMopAlways);
+  for (ni = 0; ni < mrr->ntxfNum; ni++) {
+    scalarOnly = AIR_TRUE;
+    for (axi = 1; axi < muu->ntxf[ni]->dim; axi++) {
+      /* no error checking because miteNtxfCheck succeeded */
+      miteVariableParse(&isp, muu->ntxf[ni]->axis[axi].label);
+      scalarOnly &= (1 == isp.kind->table[isp.item].answerLength);
+    }
+    if (!scalarOnly) {
+      continue;
+    }
+    mrr->npreint[ni] = nrrdNew();
+    airMopAdd(mrr->rmop, mrr->npreint[ni], (airMopper)nrrdNuke, airMopAlways);
+    if (miteNtxfPreint(mrr->npreint[ni], mrr->ntxf[ni], frac)) {
+      biffAddf(MITE, "%s: trouble pre-integrating txf %u", me, ni);
+      return 1;
+    }
+  }
+  return 0;
+}
+
 int /* Biff: (private) 1 */
 _miteNtxfAlphaAdjust(miteRender *mrr, miteUser *muu) {
   static const char me[] = "_miteNtxfAlphaAdjust";
@@ -458,6 +634,10 @@ _miteNtxfAlphaAdjust(miteRender *mrr, miteUser *muu) {
     return 1;
   }
   frac = muu->rayStep / muu->refStep;
+  if (muu->preint && _miteNtxfPreintSet(mrr, muu, frac)) {
+    biffAddf(MITE, "%s: trouble pre-integrating transfer functions", me);
+    return 1;
+  }
   for (ni = 0; ni < mrr->ntxfNum; ni++) {
     ntxf = mrr->ntxf[ni];
     if (!strchr(ntxf->axis[0].label, miteRangeChar[miteRangeAlpha])) {
@@ -505,6 +685,8 @@ _miteStageInit(miteStage *stage) {
   }
   stage->rangeNum = -1;
   stage->label = NULL;
+  stage->preint = AIR_FALSE;
+  stage->prevIdx = -1;
   return;
 }
 
@@ -578,8 +760,13 @@ _miteStageSet(miteThread *mtt, miteRender *mrr) {
       stage->max = ntxf->axis[di].max;
       if (di > 1) {
         stage->data = NULL;
+      } else if (mrr->npreint && mrr->npreint[ni]) {
+        stage->data = (mite_t *)mrr->npreint[ni]->data;
+        stage->preint = AIR_TRUE;
       } else {
         stage->data = (mite_t *)ntxf->data;
+      }
+      if (1 == di) {
         value = nrrdKeyValueGet(ntxf, "miteStageOp");
         if (value) {
           stage->op = airEnumVal(miteStageOp, value);
@@ -657,7 +844,7 @@ _miteStageSet(miteThread *mtt, miteRender *mrr) {
 void
 _miteStageRun(miteThread *mtt, miteUser *muu) {
   static const char me[] = "_miteStageRun";
-  unsigned int stageIdx, ri, rii, txfIdx, finalIdx;
+  unsigned int stageIdx, ri, rii, txfIdx, prevIdx, finalIdx;
   miteStage *stage;
   mite_t *rangeData;
   double *dbg = NULL;
@@ -681,7 +868,15 @@ _miteStageRun(miteThread *mtt, miteUser *muu) {
         dbg[0 + 2 * stageIdx] = *(stage->val);
       }
     }
-    finalIdx = stage->size * finalIdx + txfIdx;
+    if (stage->preint) {
+      /* front sample is the previous one along the ray (or this one, at the
+         start of the ray), back sample is this one */
+      prevIdx = (-1 != stage->prevIdx ? AIR_UINT(stage->prevIdx) : txfIdx);
+      stage->prevIdx = AIR_INT(txfIdx);
+      finalIdx = prevIdx + stage->size * (txfIdx + stage->size * finalIdx);
+    } else {
+      finalIdx = stage->size * finalIdx + txfIdx;
+    }
     if (mtt->verbose) {
       dbg[1 + 2 * stageIdx] = txfIdx;
     }
@@ -51,6 +51,15 @@ miteUserNew() {
   muu->rayStep = AIR_NAN;
   muu->opacMatters = miteDefOpacMatters;
   muu->opacNear1 = miteDefOpacNear1;
+  muu->preint = miteDefPreint;
+  muu->adaptStep = miteDefAdaptStep;
+  muu->adaptStepMin = miteDefAdaptStepMin;
+  muu->adaptStepMax = miteDefAdaptStepMax;
+  muu->adaptValErr = AIR_NAN;
+  muu->adaptOpacMax = miteDefAdaptOpacMax;
+  muu->nsinLevel = NULL; /* managed by user */
+  muu->nsinLevelNum = 0;
+  muu->lodScale = miteDefLodScale;
   muu->hctx = hooverContextNew();
   ELL_3V_SET(muu->fakeFrom, AIR_NAN, AIR_NAN, AIR_NAN);
   ELL_3V_SET(muu->vectorD, 0, 0, 0);
@@ -69,6 +78,8 @@ miteUserNew() {
   muu->verbUi = muu->verbVi = -1;
   muu->rendTime = 0;
   muu->sampRate = 0;
+  muu->stepMean = 0;
+  muu->levelUsed = 0;
   return muu;
 }
 
@@ -179,6 +190,58 @@ _miteUserCheck(miteUser *muu) {
     return 1;
   }
 
+  /* check adaptive stepping parameters */
+  if (muu->adaptStep) {
+    if (!muu->nsin) {
+      biffAddf(MITE, "%s: adaptive stepping needs a %s volume", me, gageKindScl->name);
+      airMopError(mop);
+      return 1;
+    }
+    if (!(AIR_EXISTS(muu->adaptValErr) && muu->adaptValErr > 0)) {
+      biffAddf(MITE, "%s: adaptive stepping value error (%g) not set or not positive",
+               me, muu->adaptValErr);
+      airMopError(mop);
+      return 1;
+    }
+    if (!(0 < muu->adaptStepMin && muu->adaptStepMin <= 1
+          && 1 <= muu->adaptStepMax)) {
+      biffAddf(MITE, "%s: need adaptive step range (%g,%g) with 0 < min <= 1 <= max",
+               me, muu->adaptStepMin, muu->adaptStepMax);
+      airMopError(mop);
+      return 1;
+    }
+  }
+
+  /* check level of detail parameters */
+  if (muu->nsinLevelNum) {
+    unsigned int li;
+    if (!(muu->nsin && muu->nsinLevel)) {
+      biffAddf(MITE, "%s: level of detail needs %s volume and its levels", me,
+               gageKindScl->name);
+      airMopError(mop);
+      return 1;
+    }
+    if (muu->nvin || muu->ntin) {
+      biffAddf(MITE, "%s: level of detail only possible with just a %s volume", me,
+               gageKindScl->name);
+      airMopError(mop);
+      return 1;
+    }
+    if (!(AIR_EXISTS(muu->lodScale) && muu->lodScale > 0)) {
+      biffAddf(MITE, "%s: level of detail scale (%g) not positive", me, muu->lodScale);
+      airMopError(mop);
+      return 1;
+    }
+    for (li = 0; li < muu->nsinLevelNum; li++) {
+      if (gageVolumeCheck(muu->gctx0, muu->nsinLevel[li], gageKindScl)) {
+        biffMovef(MITE, GAGE, "%s: trouble with level %u %s volume", me, li + 1,
+                  gageKindScl->name);
+        airMopError(mop);
+        return 1;
+      }
+    }
+  }
+
   /* see if we have volumes for requested queries */
   if (GAGE_QUERY_NONZERO(queryScl) && !(muu->nsin)) {
     biffAddf(MITE, "%s: txf or shading require %s volume, but don't have one", me,
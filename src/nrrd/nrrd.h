@@ -1389,6 +1389,19 @@ NRRD_EXPORT int nrrdSimpleResample(Nrrd *nout, const Nrrd *nin, const NrrdKernel
                                    const double *parm, const size_t *samples,
                                    const double *scalings);
 
+/* pyramid.c */
+NRRD_EXPORT int nrrdPyramid(Nrrd *const nlevel[], unsigned int levelNum, const Nrrd *nin,
+                            unsigned int baseDim, const NrrdKernelSpec *kspec);
+NRRD_EXPORT int nrrdPyramidCheck(const Nrrd *const nlevel[], unsigned int levelNum,
+                                 const Nrrd *nin, unsigned int baseDim,
+                                 const NrrdKernelSpec *kspec);
+NRRD_EXPORT int nrrdPyramidManage(Nrrd ***nlevelP, int *recomputedP,
+                                  unsigned int levelNum, const char *format,
+                                  int saveIfComputed, const Nrrd *nin,
+                                  unsigned int baseDim, const NrrdKernelSpec *kspec);
+NRRD_EXPORT unsigned int nrrdPyramidLevelPick(double footprintRatio,
+                                              unsigned int levelNum);
+
 /******** connected component extraction and manipulation */
 /* ccmethods.c */
 NRRD_EXPORT int nrrdCCValid(const Nrrd *nin);
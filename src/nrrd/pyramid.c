@@ -0,0 +1,397 @@
+/*
+  Teem: Tools to process and visualize scientific data and images
+  Copyright (C) 2009--2023  University of Chicago
+  Copyright (C) 2005--2008  Gordon Kindlmann
+  Copyright (C) 1998--2004  University of Utah
+
+  This library is free software; you can redistribute it and/or modify it under the terms
+  of the GNU Lesser General Public License (LGPL) as published by the Free Software
+  Foundation; either version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also include exceptions to
+  the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+  PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with
+  this library; if not, write to Free Software Foundation, Inc., 51 Franklin Street,
+  Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "nrrd.h"
+#include "privateNrrd.h"
+
+/*
+** Multi-resolution pyramids: a series of levels, each one made by
+** 2x decimation (with nrrdResampleExecute) of the level before it, along
+** all axes from baseDim onward.  Level 0 is the given volume itself, and
+** is not stored; nlevel[i] is level i+1.  Each level records in its
+** key/value pairs how it was made, so that a pyramid saved to disk (as
+** "sidecar" files named by a sprintf-style format, as with
+** gageStackBlurManage) can be re-used only if it matches.
+*/
+
+#define PYRAMID_KEY_LEVEL  "pyramid level"
+#define PYRAMID_KEY_KERNEL "pyramid kernel"
+#define PYRAMID_KEY_SIZE   "pyramid base size"
+
+/* size of given axis at given level (level 0 is original) */
+static size_t
+_pyramidSize(size_t size0, unsigned int level) {
+  size_t ret;
+  unsigned int li;
+
+  ret = size0;
+  for (li = 0; li < level; li++) {
+    ret = (ret + 1) / 2;
+  }
+  return ret;
+}
+
+static void
+_pyramidBaseSizeSprint(char *str, const Nrrd *nin) {
+  char stmp[AIR_STRLEN_SMALL + 1];
+  unsigned int ai;
+
+  str[0] = '\0';
+  for (ai = 0; ai < nin->dim; ai++) {
+    strcat(str, ai ? " " : "");
+    strcat(str, airSprintSize_t(stmp, nin->axis[ai].size));
+  }
+}
+
+/* copies kspec into ksp, or sets ksp to the default tent if kspec is NULL */
+static void
+_pyramidKernelSet(NrrdKernelSpec *ksp, const NrrdKernelSpec *kspec) {
+  double kparm[NRRD_KERNEL_PARMS_NUM];
+
+  if (kspec) {
+    nrrdKernelSpecSet(ksp, kspec->kernel, kspec->parm);
+  } else {
+    kparm[0] = 1.0; /* scale */
+    nrrdKernelSpecSet(ksp, nrrdKernelTent, kparm);
+  }
+}
+
+static int
+_pyramidArgCheck(unsigned int levelNum, const Nrrd *nin, unsigned int baseDim) {
+  static const char me[] = "_pyramidArgCheck";
+
+  if (!levelNum) {
+    biffAddf(NRRD, "%s: need levelNum > 0", me);
+    return 1;
+  }
+  if (!(baseDim < nin->dim)) {
+    biffAddf(NRRD, "%s: baseDim %u not < nin->dim %u", me, baseDim, nin->dim);
+    return 1;
+  }
+  if (nrrdTypeBlock == nin->type) {
+    biffAddf(NRRD, "%s: can't resample %s type", me,
+             airEnumStr(nrrdType, nrrdTypeBlock));
+    return 1;
+  }
+  if (nin->dim * AIR_STRLEN_SMALL > AIR_STRLEN_HUGE) {
+    biffAddf(NRRD, "%s: dimension %u too high", me, nin->dim);
+    return 1;
+  }
+  return 0;
+}
+
+/*
+******** nrrdPyramid
+**
+** computes levelNum levels of pyramid from nin into the already allocated
+** nlevel[0] through nlevel[levelNum-1].  The first baseDim axes (e.g. 1 for
+** vector or tensor volumes) are not resampled.  The kernel in kspec is
+** used for the decimation, after the resampler stretches it to filter out
+** what can't be represented at the lower rate.  If kspec is NULL, a tent
+** (linear interpolation) is used.  Output type is the same as input.
+*/
+int /* Biff: 1 */
+nrrdPyramid(Nrrd *const nlevel[], unsigned int levelNum, const Nrrd *nin,
+            unsigned int baseDim, const NrrdKernelSpec *kspec) {
+  static const char me[] = "nrrdPyramid";
+  char kstr[AIR_STRLEN_LARGE + 1], sstr[AIR_STRLEN_HUGE + 1], lstr[AIR_STRLEN_SMALL + 1];
+  NrrdResampleContext *rsmc;
+  NrrdKernelSpec *ksp;
+  const Nrrd *nprev;
+  airArray *mop;
+  unsigned int li, ai;
+  int E;
+
+  if (!(nlevel && nin)) {
+    biffAddf(NRRD, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (_pyramidArgCheck(levelNum, nin, baseDim)) {
+    biffAddf(NRRD, "%s: problem with args", me);
+    return 1;
+  }
+  for (li = 0; li < levelNum; li++) {
+    if (!nlevel[li]) {
+      biffAddf(NRRD, "%s: got NULL nlevel[%u]", me, li);
+      return 1;
+    }
+    if (nin == nlevel[li]) {
+      biffAddf(NRRD, "%s: nlevel[%u] == nin; can't work in place", me, li);
+      return 1;
+    }
+  }
+  mop = airMopNew();
+  ksp = nrrdKernelSpecNew();
+  airMopAdd(mop, ksp, (airMopper)nrrdKernelSpecNix, airMopAlways);
+  _pyramidKernelSet(ksp, kspec);
+  if (nrrdKernelSpecSprint(kstr, ksp)) {
+    biffAddf(NRRD, "%s: trouble describing kernel", me);
+    airMopError(mop);
+    return 1;
+  }
+  _pyramidBaseSizeSprint(sstr, nin);
+  rsmc = nrrdResampleContextNew();
+  airMopAdd(mop, rsmc, (airMopper)nrrdResampleContextNix, airMopAlways);
+
+  nprev = nin;
+  for (li = 0; li < levelNum; li++) {
+    E = 0;
+    if (!E) E |= nrrdResampleDefaultCenterSet(rsmc, nrrdDefaultCenter);
+    if (!E) E |= nrrdResampleInputSet(rsmc, nprev);
+    for (ai = 0; ai < nin->dim; ai++) {
+      if (ai < baseDim) {
+        if (!E) E |= nrrdResampleKernelSet(rsmc, ai, NULL, NULL);
+      } else {
+        if (!E) E |= nrrdResampleKernelSet(rsmc, ai, ksp->kernel, ksp->parm);
+        if (!E)
+          E |= nrrdResampleSamplesSet(rsmc, ai,
+                                      _pyramidSize(nin->axis[ai].size, li + 1));
+        if (!E) E |= nrrdResampleRangeFullSet(rsmc, ai);
+      }
+    }
+    if (!E) E |= nrrdResampleBoundarySet(rsmc, nrrdBoundaryBleed);
+    if (!E) E |= nrrdResampleTypeOutSet(rsmc, nrrdTypeDefault);
+    if (!E) E |= nrrdResampleClampSet(rsmc, AIR_TRUE);
+    if (!E) E |= nrrdResampleRenormalizeSet(rsmc, AIR_TRUE);
+    if (!E) E |= nrrdResampleExecute(rsmc, nlevel[li]);
+    if (E) {
+      biffAddf(NRRD, "%s: trouble computing level %u", me, li + 1);
+      airMopError(mop);
+      return 1;
+    }
+    sprintf(lstr, "%u", li + 1);
+    E = 0;
+    if (!E) E |= nrrdKeyValueAdd(nlevel[li], PYRAMID_KEY_LEVEL, lstr);
+    if (!E) E |= nrrdKeyValueAdd(nlevel[li], PYRAMID_KEY_KERNEL, kstr);
+    if (!E) E |= nrrdKeyValueAdd(nlevel[li], PYRAMID_KEY_SIZE, sstr);
+    if (E) {
+      biffAddf(NRRD, "%s: trouble recording level %u info", me, li + 1);
+      airMopError(mop);
+      return 1;
+    }
+    nprev = nlevel[li];
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+******** nrrdPyramidCheck
+**
+** checks that the given levels are what nrrdPyramid would have computed
+** from nin with the same baseDim and kspec: same type, the expected sizes,
+** and matching level, kernel, and base size key/value pairs.
+*/
+int /* Biff: 1 */
+nrrdPyramidCheck(const Nrrd *const nlevel[], unsigned int levelNum, const Nrrd *nin,
+                 unsigned int baseDim, const NrrdKernelSpec *kspec) {
+  static const char me[] = "nrrdPyramidCheck";
+  char kstr[AIR_STRLEN_LARGE + 1], sstr[AIR_STRLEN_HUGE + 1], lstr[AIR_STRLEN_SMALL + 1],
+    stmp[2][AIR_STRLEN_SMALL + 1], *val;
+  NrrdKernelSpec *ksp;
+  airArray *mop;
+  unsigned int li, ai;
+  size_t want;
+
+  if (!(nlevel && nin)) {
+    biffAddf(NRRD, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (_pyramidArgCheck(levelNum, nin, baseDim)) {
+    biffAddf(NRRD, "%s: problem with args", me);
+    return 1;
+  }
+  mop = airMopNew();
+  ksp = nrrdKernelSpecNew();
+  airMopAdd(mop, ksp, (airMopper)nrrdKernelSpecNix, airMopAlways);
+  _pyramidKernelSet(ksp, kspec);
+  if (nrrdKernelSpecSprint(kstr, ksp)) {
+    biffAddf(NRRD, "%s: trouble describing kernel", me);
+    airMopError(mop);
+    return 1;
+  }
+  _pyramidBaseSizeSprint(sstr, nin);
+  for (li = 0; li < levelNum; li++) {
+    const Nrrd *nlev = nlevel[li];
+    if (!nlev) {
+      biffAddf(NRRD, "%s: got NULL nlevel[%u]", me, li);
+      airMopError(mop);
+      return 1;
+    }
+    if (!(nin->dim == nlev->dim && nin->type == nlev->type)) {
+      biffAddf(NRRD, "%s: level %u dim,type (%u,%s) != input (%u,%s)", me, li + 1,
+               nlev->dim, airEnumStr(nrrdType, nlev->type), nin->dim,
+               airEnumStr(nrrdType, nin->type));
+      airMopError(mop);
+      return 1;
+    }
+    for (ai = 0; ai < nin->dim; ai++) {
+      want = (ai < baseDim ? nin->axis[ai].size
+                           : _pyramidSize(nin->axis[ai].size, li + 1));
+      if (want != nlev->axis[ai].size) {
+        biffAddf(NRRD, "%s: level %u axis[%u].size %s != expected %s", me, li + 1, ai,
+                 airSprintSize_t(stmp[0], nlev->axis[ai].size),
+                 airSprintSize_t(stmp[1], want));
+        airMopError(mop);
+        return 1;
+      }
+    }
+    sprintf(lstr, "%u", li + 1);
+#define CHECK(KEY, STR)                                                                 \
+  val = nrrdKeyValueGet(nlev, KEY);                                                    \
+  if (val && !nrrdStateKeyValueReturnInternalPointers) {                               \
+    airMopAdd(mop, val, airFree, airMopAlways);                                        \
+  }                                                                                    \
+  if (!val) {                                                                          \
+    biffAddf(NRRD, "%s: level %u didn't have \"%s\" key", me, li + 1, KEY);            \
+    airMopError(mop);                                                                  \
+    return 1;                                                                          \
+  }                                                                                    \
+  if (strcmp(val, STR)) {                                                              \
+    biffAddf(NRRD, "%s: level %u \"%s\" value \"%s\" != expected \"%s\"", me, li + 1, \
+             KEY, val, STR);                                                           \
+    airMopError(mop);                                                                  \
+    return 1;                                                                          \
+  }
+    CHECK(PYRAMID_KEY_LEVEL, lstr);
+    CHECK(PYRAMID_KEY_KERNEL, kstr);
+    CHECK(PYRAMID_KEY_SIZE, sstr);
+#undef CHECK
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+******** nrrdPyramidManage
+**
+** allocates (in *nlevelP) an array of levelNum Nrrds, and either loads
+** them from files named by sprintf-style format (with level numbers 1
+** through levelNum), if those exist and pass nrrdPyramidCheck, or else
+** computes them with nrrdPyramid, and then saves them if saveIfComputed
+** (and format is given).  Whether or not they were recomputed is saved in
+** *recomputedP if non-NULL.  Caller is responsible for nrrdNuke()ing the
+** levels and free()ing the array.
+*/
+int /* Biff: 1 */
+nrrdPyramidManage(Nrrd ***nlevelP, int *recomputedP, unsigned int levelNum,
+                  const char *format, int saveIfComputed, const Nrrd *nin,
+                  unsigned int baseDim, const NrrdKernelSpec *kspec) {
+  static const char me[] = "nrrdPyramidManage";
+  Nrrd **nlevel;
+  airArray *mop;
+  unsigned int li;
+  int recompute;
+
+  if (!(nlevelP && nin)) {
+    biffAddf(NRRD, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (_pyramidArgCheck(levelNum, nin, baseDim)) {
+    biffAddf(NRRD, "%s: problem with args", me);
+    return 1;
+  }
+  nlevel = *nlevelP = AIR_CALLOC(levelNum, Nrrd *);
+  if (!nlevel) {
+    biffAddf(NRRD, "%s: couldn't alloc %u Nrrd*s", me, levelNum);
+    return 1;
+  }
+  mop = airMopNew();
+  airMopAdd(mop, nlevelP, (airMopper)airSetNull, airMopOnError);
+  airMopAdd(mop, *nlevelP, airFree, airMopOnError);
+  for (li = 0; li < levelNum; li++) {
+    nlevel[li] = nrrdNew();
+    airMopAdd(mop, nlevel[li], (airMopper)nrrdNuke, airMopOnError);
+  }
+
+  if (!airStrlen(format)) {
+    recompute = AIR_TRUE;
+  } else {
+    char *fname, *suberr;
+    int firstExists;
+    FILE *file;
+    fname = AIR_CALLOC(strlen(format) + AIR_STRLEN_SMALL + 1, char);
+    if (!fname) {
+      biffAddf(NRRD, "%s: couldn't allocate fname", me);
+      airMopError(mop);
+      return 1;
+    }
+    airMopAdd(mop, fname, airFree, airMopAlways);
+    sprintf(fname, format, 1);
+    firstExists = !!(file = fopen(fname, "r"));
+    airFclose(file);
+    if (!firstExists) {
+      recompute = AIR_TRUE;
+    } else if (nrrdLoadMulti(nlevel, levelNum, format, 1, NULL)
+               || nrrdPyramidCheck(AIR_CAST(const Nrrd *const *, nlevel), levelNum, nin,
+                                   baseDim, kspec)) {
+      /* either couldn't read or didn't match; either way, recompute */
+      airMopAdd(mop, suberr = biffGetDone(NRRD), airFree, airMopAlways);
+      recompute = AIR_TRUE;
+    } else {
+      recompute = AIR_FALSE;
+    }
+  }
+  if (recompute) {
+    if (nrrdPyramid(nlevel, levelNum, nin, baseDim, kspec)) {
+      biffAddf(NRRD, "%s: trouble computing pyramid", me);
+      airMopError(mop);
+      return 1;
+    }
+    if (airStrlen(format) && saveIfComputed
+        && nrrdSaveMulti(format, AIR_CAST(const Nrrd *const *, nlevel), levelNum, 1,
+                         NULL)) {
+      biffAddf(NRRD, "%s: trouble saving pyramid", me);
+      airMopError(mop);
+      return 1;
+    }
+  }
+  if (recomputedP) {
+    *recomputedP = recompute;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+******** nrrdPyramidLevelPick
+**
+** given the ratio of (world-space) sampling footprint to the finest
+** (world-space) sample spacing, returns which level (0 for the original,
+** up to levelNum) has sample spacing closest to, but not exceeding, the
+** footprint.  Scaling the ratio down (e.g. by 0.5) favors finer levels.
+*/
+unsigned int /* Biff: nope */
+nrrdPyramidLevelPick(double footprintRatio, unsigned int levelNum) {
+  double ll;
+  unsigned int ret;
+
+  if (!(footprintRatio > 1)) {
+    /* includes NaN */
+    return 0;
+  }
+  ll = floor(log(footprintRatio) / log(2.0));
+  ret = AIR_UINT(AIR_MIN(ll, (double)levelNum));
+  return ret;
+}
@@ -31,15 +31,23 @@
 
 #define __IF_DEBUG if (0)
 
-static double
-_pointDistSqrd(pullContext *pctx, pullPoint *AA, pullPoint *BB) {
+/*
+** squared distance between positions, in rs-normalized space
+*/
+double
+_pullPosDistSqrd(pullContext *pctx, const double AA[4], const double BB[4]) {
   double diff[4];
-  ELL_4V_SUB(diff, AA->pos, BB->pos);
+  ELL_4V_SUB(diff, AA, BB);
   ELL_3V_SCALE(diff, 1 / pctx->sysParm.radiusSpace, diff);
   diff[3] /= pctx->sysParm.radiusScale;
   return ELL_4V_DOT(diff, diff);
 }
 
+static double
+_pointDistSqrd(pullContext *pctx, pullPoint *AA, pullPoint *BB) {
+  return _pullPosDistSqrd(pctx, AA->pos, BB->pos);
+}
+
 /*
 ** this sets, in task->neighPoint (*NOT* point->neighPoint), all the
 ** points in neighboring bins with which we might possibly interact,
@@ -55,6 +63,31 @@ _neighBinPoints(pullTask *task, pullBin *bin, pullPoint *point, double distTest)
   nn = 0;
   herBinIdx = 0;
   while ((herBin = bin->neighBin[herBinIdx])) {
+    if (herBin->packPos) {
+      /* same as below, but the distance test (which rejects most
+         candidates) streams through the packed positions, and only
+         the survivors are dereferenced */
+      const double *herPos;
+      herPos = herBin->packPos;
+      for (herPointIdx = 0; herPointIdx < herBin->pointNum;
+           herPointIdx++, herPos += 4) {
+        if (distTest && _pullPosDistSqrd(task->pctx, point->pos, herPos) > distTest) {
+          continue;
+        }
+        herPoint = herBin->point[herPointIdx];
+        if (point == herPoint || (herPoint->status & PULL_STATUS_NIXME_BIT)) {
+          continue;
+        }
+        if (nn + 1 < _PULL_NEIGH_MAXNUM) {
+          task->neighPoint[nn++] = herPoint;
+        } else {
+          fprintf(stderr, "%s: hit max# (%u) poss. neighbors (from bins)\n", me,
+                  _PULL_NEIGH_MAXNUM);
+        }
+      }
+      herBinIdx++;
+      continue;
+    }
     for (herPointIdx = 0; herPointIdx < herBin->pointNum; herPointIdx++) {
       herPoint = herBin->point[herPointIdx];
       /*
@@ -98,6 +131,87 @@ _neighBinPoints(pullTask *task, pullBin *bin, pullPoint *point, double distTest)
   return nn;
 }
 
+/*
+** same as _neighBinPoints(task, bin, point, 1.0), but (when it is safe
+** to do so) using the Verlet list point->verletPoint instead of looking
+** through all the points in the neighboring bins. The list is (re)built
+** here if _pullVerletCheck() has decided it is out of date. The list can
+** be used if neither this point, nor any other point, has moved more than
+** half the skin since the lists were built: then every point that could
+** now be within the interaction radius is on the list.
+*/
+static unsigned int
+_neighVerletPoints(pullTask *task, pullBin *bin, pullPoint *point) {
+  static const char me[] = "_neighVerletPoints";
+  pullContext *pctx;
+  unsigned int nn, herPointIdx, herBinIdx, ii;
+  double halfSkin, verletDistSq;
+  pullBin *herBin;
+  pullPoint *herPoint;
+
+  pctx = task->pctx;
+  halfSkin = pctx->sysParm.neighborSkin / 2;
+  if (!pctx->sysParm.neighborSkin || pullProcessModeDescent != task->processMode
+      || (point->status & PULL_STATUS_NEWBIE_BIT)
+      || airThreadAtomicUIntAdd(&(pctx->verletBroken), 0)
+      || !(_pullPosDistSqrd(pctx, point->pos, point->verletPos)
+           <= halfSkin * halfSkin)) {
+    return _neighBinPoints(task, bin, point, 1.0);
+  }
+  if (point->verletStamp != pctx->verletStamp) {
+    if (!pctx->verletRebuilt) {
+      /* bins are only known to match verletPos on the iteration of the
+         rebuild; later this point will have to wait for the next one */
+      return _neighBinPoints(task, bin, point, 1.0);
+    }
+    /* bins were set from the current verletPos, and they're wide enough
+       to include everything within the skin */
+    verletDistSq = (1 + pctx->sysParm.neighborSkin) * (1 + pctx->sysParm.neighborSkin);
+    airArrayLenSet(point->verletPointArr, 0);
+    herBinIdx = 0;
+    while ((herBin = bin->neighBin[herBinIdx])) {
+      for (herPointIdx = 0; herPointIdx < herBin->pointNum; herPointIdx++) {
+        herPoint = herBin->point[herPointIdx];
+        if (point != herPoint
+            && _pullPosDistSqrd(pctx, point->verletPos, herPoint->verletPos)
+                 <= verletDistSq) {
+          ii = airArrayLenIncr(point->verletPointArr, 1);
+          point->verletPoint[ii] = herPoint;
+        }
+      }
+      herBinIdx++;
+    }
+    point->verletStamp = pctx->verletStamp;
+  }
+  nn = 0;
+  for (ii = 0; ii < point->verletPointNum; ii++) {
+    herPoint = point->verletPoint[ii];
+    if ((herPoint->status & PULL_STATUS_NIXME_BIT)
+        || _pointDistSqrd(pctx, point, herPoint) > 1.0) {
+      continue;
+    }
+    if (nn + 1 < _PULL_NEIGH_MAXNUM) {
+      task->neighPoint[nn++] = herPoint;
+    } else {
+      fprintf(stderr, "%s: hit max# (%u) poss. neighbors (from list)\n", me,
+              _PULL_NEIGH_MAXNUM);
+    }
+  }
+  /* the add queue is not in the lists */
+  for (herPointIdx = 0; herPointIdx < task->addPointNum; herPointIdx++) {
+    herPoint = task->addPoint[herPointIdx];
+    if (point != herPoint && !(_pointDistSqrd(pctx, point, herPoint) > 1.0)) {
+      if (nn + 1 < _PULL_NEIGH_MAXNUM) {
+        task->neighPoint[nn++] = herPoint;
+      } else {
+        fprintf(stderr, "%s: hit max# (%u) poss neighs (add queue len %u)\n", me,
+                _PULL_NEIGH_MAXNUM, task->addPointNum);
+      }
+    }
+  }
+  return nn;
+}
+
 /*
 ** compute the energy at "me" due to "she", and
 ** the gradient vector of her energy (probably pointing towards her)
@@ -228,6 +342,112 @@ _pullEnergyInterParticle(pullContext *pctx, pullPoint *me, const pullPoint *she,
   return en;
 }
 
+/*
+** batch version of _pullEnergyInterParticle(), for num (at most
+** _PULL_ENERGY_BATCH) of "her" points already known to be within range:
+** diff[4*ii] is me - her, spaDist[ii] = |diff[0,1,2]|, and rr[ii], ss[ii]
+** are the spatial and scale distances normalized by the radii, with
+** 0 < rr[ii]^2 + ss[ii]^2 and rr[ii], ss[ii] <= 1 (caller checks). Sets
+** enr[ii], and if egrad is non-NULL, egrad[4*ii]. The results are the
+** same as from num calls to _pullEnergyInterParticle(), but the energy
+** functions are evaluated a whole batch at a time
+*/
+static void
+_pullEnergyInterParticleBatch(pullContext *pctx, unsigned int num, const double *diff,
+                              const double *spaDist, const double *rr,
+                              const double *ss,
+                              /* output */
+                              double *enr, double *egrad) {
+  static const char me[] = "_pullEnergyInterParticleBatch";
+  double spaceRad, scaleRad, beta, scaleSgn, den[_PULL_ENERGY_BATCH],
+    enS[_PULL_ENERGY_BATCH], denS[_PULL_ENERGY_BATCH], enW[2][_PULL_ENERGY_BATCH],
+    denW[2][_PULL_ENERGY_BATCH], uu[_PULL_ENERGY_BATCH];
+  const double *dd;
+  double *eg;
+  unsigned int ii;
+
+  spaceRad = pctx->sysParm.radiusSpace;
+  scaleRad = pctx->sysParm.radiusScale;
+  switch (pctx->interType) {
+  case pullInterTypeJustR:
+    pullEnergySpecEvalBatch(enr, den, rr, num, pctx->energySpecR);
+    if (egrad) {
+      for (ii = 0; ii < num; ii++) {
+        dd = diff + 4 * ii;
+        eg = egrad + 4 * ii;
+        den[ii] *= 1.0 / (spaceRad * spaDist[ii]);
+        ELL_3V_SCALE(eg, den[ii], dd);
+        eg[3] = 0;
+      }
+    }
+    break;
+  case pullInterTypeUnivariate:
+    for (ii = 0; ii < num; ii++) {
+      uu[ii] = sqrt(rr[ii] * rr[ii] + ss[ii] * ss[ii]);
+    }
+    pullEnergySpecEvalBatch(enr, den, uu, num, pctx->energySpecR);
+    if (egrad) {
+      for (ii = 0; ii < num; ii++) {
+        dd = diff + 4 * ii;
+        eg = egrad + 4 * ii;
+        ELL_3V_SCALE(eg, den[ii] / (uu[ii] * spaceRad * spaceRad), dd);
+        eg[3] = den[ii] * dd[3] / (uu[ii] * scaleRad * scaleRad);
+      }
+    }
+    break;
+  case pullInterTypeSeparable:
+    /* enW[0] is used for the spatial energy */
+    pullEnergySpecEvalBatch(enW[0], den, rr, num, pctx->energySpecR);
+    pullEnergySpecEvalBatch(enS, denS, ss, num, pctx->energySpecS);
+    for (ii = 0; ii < num; ii++) {
+      enr[ii] = enW[0][ii] * enS[ii];
+    }
+    if (egrad) {
+      for (ii = 0; ii < num; ii++) {
+        dd = diff + 4 * ii;
+        eg = egrad + 4 * ii;
+        ELL_3V_SCALE(eg, den[ii] * enS[ii] / (spaceRad * spaDist[ii]), dd);
+        eg[3] = enW[0][ii] * airSgn(dd[3]) * denS[ii] / scaleRad;
+      }
+    }
+    break;
+  case pullInterTypeAdditive:
+    /* enr and den are used for the spatial energy, until the end */
+    pullEnergySpecEvalBatch(enr, den, rr, num, pctx->energySpecR);
+    pullEnergySpecEvalBatch(enS, denS, ss, num, pctx->energySpecS);
+    pullEnergySpecEvalBatch(enW[0], denW[0], rr, num, pctx->energySpecWin);
+    pullEnergySpecEvalBatch(enW[1], denW[1], ss, num, pctx->energySpecWin);
+    beta = pctx->sysParm.beta;
+    if (egrad) {
+      double egradR[4], egradS[4];
+      for (ii = 0; ii < num; ii++) {
+        dd = diff + 4 * ii;
+        eg = egrad + 4 * ii;
+        scaleSgn = pctx->haveScale ? airSgn(dd[3]) : 1;
+        ELL_3V_SCALE(egradR, den[ii] * enW[1][ii] / (spaceRad * spaDist[ii]), dd);
+        ELL_3V_SCALE(egradS, denW[0][ii] * enS[ii] / (spaceRad * spaDist[ii]), dd);
+        egradR[3] = enr[ii] * scaleSgn * denW[1][ii] / scaleRad;
+        egradS[3] = enW[0][ii] * scaleSgn * denS[ii] / scaleRad;
+        ELL_4V_LERP(eg, beta, egradR, egradS);
+      }
+    }
+    for (ii = 0; ii < num; ii++) {
+      enr[ii] = AIR_LERP(beta, enr[ii] * enW[1][ii], enS[ii] * enW[0][ii]);
+    }
+    break;
+  default:
+    fprintf(stderr, "!%s: sorry, intertype %d unimplemented", me, pctx->interType);
+    for (ii = 0; ii < num; ii++) {
+      enr[ii] = AIR_NAN;
+      if (egrad) {
+        ELL_4V_SET(egrad + 4 * ii, AIR_NAN, AIR_NAN, AIR_NAN, AIR_NAN);
+      }
+    }
+    break;
+  }
+  return;
+}
+
 int /* Biff: 1 */
 pullEnergyPlot(pullContext *pctx, Nrrd *nplot, double xx, double yy, double zz,
                unsigned int res) {
@@ -366,7 +586,7 @@ _pullEnergyFromPoints(pullTask *task, pullBin *bin, pullPoint *point,
   if (ntrue) {
     /* this finds the over-inclusive set of all possible interacting
        points, based on bin membership as well the task's add queue */
-    nnum = _neighBinPoints(task, bin, point, 1.0);
+    nnum = _neighVerletPoints(task, bin, point);
     if (nlist) {
       airArrayLenSet(point->neighPointArr, 0);
     }
@@ -411,118 +631,170 @@ _pullEnergyFromPoints(pullTask *task, pullBin *bin, pullPoint *point,
   if (egradSum) {
     ELL_4V_SET(egradSum, 0, 0, 0, 0);
   }
-  for (nidx = 0; nidx < nnum; nidx++) {
-    double diff[4], spaDistSq, spaDist, sclDist, enr, egrad[4];
-    pullPoint *herPoint;
+  nidx = 0;
+  while (nidx < nnum) {
+    double bdiff[4 * _PULL_ENERGY_BATCH], bspaDist[_PULL_ENERGY_BATCH],
+      brr[_PULL_ENERGY_BATCH], bss[_PULL_ENERGY_BATCH], benr[_PULL_ENERGY_BATCH],
+      begrad[4 * _PULL_ENERGY_BATCH];
+    pullPoint *bpoint[_PULL_ENERGY_BATCH];
+    unsigned int bnum, bidx;
 
-    herPoint = task->neighPoint[nidx];
-    if (herPoint->status & PULL_STATUS_NIXME_BIT) {
-      /* this point is not long for this world, pass over it */
-      continue;
-    }
-    ELL_4V_SUB(diff, point->pos, herPoint->pos); /* me - her */
-    spaDistSq = ELL_3V_DOT(diff, diff);
-    /*
-    printf("!%s: %u:%g,%g,%g <-- %u:%g,%g,%g = sqd %g %s %g\n", me,
-           point->idtag, point->pos[0], point->pos[1], point->pos[2],
-           herPoint->idtag,
-           herPoint->pos[0], herPoint->pos[1], herPoint->pos[2],
-           spaDistSq, spaDistSq > spaDistSqMax ? ">" : "<=", spaDistSqMax);
-    */
-    if (spaDistSq > spaDistSqMax) {
-      continue;
+    /* gather a batch of neighbors that are actually in range */
+    bnum = 0;
+    for (; nidx < nnum && bnum < _PULL_ENERGY_BATCH; nidx++) {
+      double *diff, spaDistSq, spaDist, sclDist, rr, ss;
+      pullPoint *herPoint;
+
+      herPoint = task->neighPoint[nidx];
+      if (herPoint->status & PULL_STATUS_NIXME_BIT) {
+        /* this point is not long for this world, pass over it */
+        continue;
+      }
+      diff = bdiff + 4 * bnum;
+      ELL_4V_SUB(diff, point->pos, herPoint->pos); /* me - her */
+      spaDistSq = ELL_3V_DOT(diff, diff);
+      /*
+      printf("!%s: %u:%g,%g,%g <-- %u:%g,%g,%g = sqd %g %s %g\n", me,
+             point->idtag, point->pos[0], point->pos[1], point->pos[2],
+             herPoint->idtag,
+             herPoint->pos[0], herPoint->pos[1], herPoint->pos[2],
+             spaDistSq, spaDistSq > spaDistSqMax ? ">" : "<=", spaDistSqMax);
+      */
+      if (spaDistSq > spaDistSqMax) {
+        continue;
+      }
+      sclDist = AIR_ABS(diff[3]);
+      if (sclDist > task->pctx->sysParm.radiusScale) {
+        continue;
+      }
+      spaDist = sqrt(spaDistSq);
+      /* the same tests that _pullEnergyInterParticle() does */
+      rr = spaDist / task->pctx->sysParm.radiusSpace;
+      ss = task->pctx->haveScale ? sclDist / task->pctx->sysParm.radiusScale : 0;
+      if (rr > 1 || ss > 1) {
+        continue;
+      }
+      if (rr == 0 && ss == 0) {
+        fprintf(stderr, "%s: pos(%u) == pos(%u) !! (%g,%g,%g,%g)\n", me, point->idtag,
+                herPoint->idtag, point->pos[0], point->pos[1], point->pos[2],
+                point->pos[3]);
+        continue;
+      }
+#if PULL_HINTER
+      if (pullProcessModeDescent == task->pctx->task[0]->processMode
+          && task->pctx->nhinter && task->pctx->nhinter->data) {
+        unsigned int ri, si, sz;
+        float *hint;
+        hint = AIR_CAST(float *, task->pctx->nhinter->data);
+        sz = task->pctx->nhinter->axis[0].size;
+        ri = airIndex(-1.0, rr, 1.0, sz);
+        si = airIndex(-1.0, ss * (task->pctx->haveScale ? airSgn(diff[3]) : 1), 1.0, sz);
+        hint[ri + sz * si] += 1;
+      }
+#endif
+      bspaDist[bnum] = spaDist;
+      brr[bnum] = rr;
+      bss[bnum] = ss;
+      bpoint[bnum] = herPoint;
+      bnum++;
     }
-    sclDist = AIR_ABS(diff[3]);
-    if (sclDist > task->pctx->sysParm.radiusScale) {
+    if (!bnum) {
       continue;
     }
-    spaDist = sqrt(spaDistSq);
-    /* we pass spaDist to avoid recomputing sqrt(), and sclDist for
-       stupid consistency  */
-    enr = _pullEnergyInterParticle(task->pctx, point, herPoint, spaDist, sclDist,
-                                   egradSum ? egrad : NULL);
+    _pullEnergyInterParticleBatch(task->pctx, bnum, bdiff, bspaDist, brr, bss, benr,
+                                  egradSum ? begrad : NULL);
+
+    /* accumulate, in the same order as the neighbors were listed */
+    for (bidx = 0; bidx < bnum; bidx++) {
+      double diff[4], enr, *egrad;
+      pullPoint *herPoint;
+
+      herPoint = bpoint[bidx];
+      enr = benr[bidx];
+      egrad = begrad + 4 * bidx;
+      ELL_4V_COPY(diff, bdiff + 4 * bidx);
 #if 0
-    /* sanity checking on energy derivatives */
-    if (enr && egradSum) {
-      double _pos[4], tdf[4], ee[2], eps=0.000001, apegrad[4], quot[4];
-      unsigned int cord, pan;
-      ELL_4V_COPY(_pos, point->pos);
+      /* sanity checking on energy derivatives */
+      if (enr && egradSum) {
+        double _pos[4], tdf[4], ee[2], eps=0.000001, apegrad[4], quot[4];
+        unsigned int cord, pan;
+        ELL_4V_COPY(_pos, point->pos);
 
-      for (cord=0; cord<=3; cord++) {
-        for (pan=0; pan<=1; pan++) {
-          point->pos[cord] = _pos[cord] + (!pan ? -1 : +1)*eps;
-          ELL_4V_SUB(tdf, point->pos, herPoint->pos);
-          ee[pan] = _pullEnergyInterParticle(task->pctx, point, herPoint,
-                                             ELL_3V_LEN(tdf), AIR_ABS(tdf[3]), NULL);
+        for (cord=0; cord<=3; cord++) {
+          for (pan=0; pan<=1; pan++) {
+            point->pos[cord] = _pos[cord] + (!pan ? -1 : +1)*eps;
+            ELL_4V_SUB(tdf, point->pos, herPoint->pos);
+            ee[pan] = _pullEnergyInterParticle(task->pctx, point, herPoint,
+                                               ELL_3V_LEN(tdf), AIR_ABS(tdf[3]), NULL);
+          }
+          point->pos[cord] = _pos[cord];
+          apegrad[cord] = (ee[1] - ee[0])/(2*eps);
+          quot[cord] = apegrad[cord]/egrad[cord];
+        }
+        if ( AIR_ABS(1.0 - quot[0]) > 0.01 ||
+             AIR_ABS(1.0 - quot[1]) > 0.01 ||
+             AIR_ABS(1.0 - quot[2]) > 0.01 ||
+             (task->pctx->haveScale && AIR_ABS(1.0 - quot[3]) > 0.01) ) {
+          printf("!%s(%u<-%u): ---------- claim egrad (%g,%g,%g,%g)\n", me,
+                 point->idtag, herPoint->idtag, egrad[0], egrad[1], egrad[2], egrad[3]);
+          printf("!%s(%u<-%u):            measr egrad (%g,%g,%g,%g)\n", me,
+                 point->idtag, herPoint->idtag, apegrad[0], apegrad[1], apegrad[2], apegrad[3]);
+          printf("!%s(%u<-%u):            quot (%g,%g,%g,%g)\n", me,
+                 point->idtag, herPoint->idtag, quot[0], quot[1], quot[2], quot[3]);
         }
-        point->pos[cord] = _pos[cord];
-        apegrad[cord] = (ee[1] - ee[0])/(2*eps);
-        quot[cord] = apegrad[cord]/egrad[cord];
-      }
-      if ( AIR_ABS(1.0 - quot[0]) > 0.01 ||
-           AIR_ABS(1.0 - quot[1]) > 0.01 ||
-           AIR_ABS(1.0 - quot[2]) > 0.01 ||
-           (task->pctx->haveScale && AIR_ABS(1.0 - quot[3]) > 0.01) ) {
-        printf("!%s(%u<-%u): ---------- claim egrad (%g,%g,%g,%g)\n", me,
-               point->idtag, herPoint->idtag, egrad[0], egrad[1], egrad[2], egrad[3]);
-        printf("!%s(%u<-%u):            measr egrad (%g,%g,%g,%g)\n", me,
-               point->idtag, herPoint->idtag, apegrad[0], apegrad[1], apegrad[2], apegrad[3]);
-        printf("!%s(%u<-%u):            quot (%g,%g,%g,%g)\n", me,
-               point->idtag, herPoint->idtag, quot[0], quot[1], quot[2], quot[3]);
-      }
 
-      ELL_4V_COPY(point->pos, _pos);
-    }
+        ELL_4V_COPY(point->pos, _pos);
+      }
 #endif
+      if (enr) {
+        /* there is some non-zero energy due to her; and we assume that
+           its not just a fluke zero-crossing of the potential profile */
+        double ndist;
 
-    if (enr) {
-      /* there is some non-zero energy due to her; and we assume that
-         its not just a fluke zero-crossing of the potential profile */
-      double ndist;
-
-      point->neighInterNum++;
-      if (nlist && ntrue) {
-        unsigned int ii;
-        /* we have to record that we had an interaction with this point */
-        ii = airArrayLenIncr(point->neighPointArr, 1);
-        point->neighPoint[ii] = herPoint;
-      }
-      energySum += enr;
-      ELL_3V_SCALE(diff, 1.0 / task->pctx->sysParm.radiusSpace, diff);
-      if (task->pctx->haveScale) {
-        diff[3] /= task->pctx->sysParm.radiusScale;
-      }
-      ndist = ELL_4V_LEN(diff);
-      point->neighDistMean += ndist;
-      if (pullProcessModeNeighLearn == task->processMode) {
-        float outer[16];
-        ELL_4MV_OUTER_TT(outer, float, diff, diff);
-        point->neighCovar[0] += outer[0];
-        point->neighCovar[1] += outer[1];
-        point->neighCovar[2] += outer[2];
-        point->neighCovar[3] += outer[3];
-        point->neighCovar[4] += outer[5];
-        point->neighCovar[5] += outer[6];
-        point->neighCovar[6] += outer[7];
-        point->neighCovar[7] += outer[10];
-        point->neighCovar[8] += outer[11];
-        point->neighCovar[9] += outer[15];
-#if PULL_TANCOVAR
-        if (task->pctx->ispec[pullInfoTangent1]) {
-          double *tng;
-          tng = herPoint->info + task->pctx->infoIdx[pullInfoTangent1];
-          ELL_3MV_OUTER_TT(outer, float, tng, tng);
-          point->neighTanCovar[0] += outer[0];
-          point->neighTanCovar[1] += outer[1];
-          point->neighTanCovar[2] += outer[2];
-          point->neighTanCovar[3] += outer[4];
-          point->neighTanCovar[4] += outer[5];
-          point->neighTanCovar[5] += outer[8];
+        point->neighInterNum++;
+        if (nlist && ntrue) {
+          unsigned int ii;
+          /* we have to record that we had an interaction with this point */
+          ii = airArrayLenIncr(point->neighPointArr, 1);
+          point->neighPoint[ii] = herPoint;
         }
+        energySum += enr;
+        ELL_3V_SCALE(diff, 1.0 / task->pctx->sysParm.radiusSpace, diff);
+        if (task->pctx->haveScale) {
+          diff[3] /= task->pctx->sysParm.radiusScale;
+        }
+        ndist = ELL_4V_LEN(diff);
+        point->neighDistMean += ndist;
+        if (pullProcessModeNeighLearn == task->processMode) {
+          float outer[16];
+          ELL_4MV_OUTER_TT(outer, float, diff, diff);
+          point->neighCovar[0] += outer[0];
+          point->neighCovar[1] += outer[1];
+          point->neighCovar[2] += outer[2];
+          point->neighCovar[3] += outer[3];
+          point->neighCovar[4] += outer[5];
+          point->neighCovar[5] += outer[6];
+          point->neighCovar[6] += outer[7];
+          point->neighCovar[7] += outer[10];
+          point->neighCovar[8] += outer[11];
+          point->neighCovar[9] += outer[15];
+#if PULL_TANCOVAR
+          if (task->pctx->ispec[pullInfoTangent1]) {
+            double *tng;
+            tng = herPoint->info + task->pctx->infoIdx[pullInfoTangent1];
+            ELL_3MV_OUTER_TT(outer, float, tng, tng);
+            point->neighTanCovar[0] += outer[0];
+            point->neighTanCovar[1] += outer[1];
+            point->neighTanCovar[2] += outer[2];
+            point->neighTanCovar[3] += outer[4];
+            point->neighTanCovar[4] += outer[5];
+            point->neighTanCovar[5] += outer[8];
+          }
 #endif
-      }
-      if (egradSum) {
-        ELL_4V_INCR(egradSum, egrad);
+        }
+        if (egradSum) {
+          ELL_4V_INCR(egradSum, egrad);
+        }
       }
     }
   }
@@ -1131,6 +1403,20 @@ pullBinProcess(pullTask *task, unsigned int myBinIdx) {
       biffAddf(PULL, "%s: on point %u of bin %u\n", me, myPointIdx, myBinIdx);
       return 1;
     }
+    if (myBin->packPos) {
+      /* so that neighbor searches see where the point is now */
+      ELL_4V_COPY(myBin->packPos + 4 * myPointIdx, point->pos);
+    }
+    if (task->pctx->sysParm.neighborSkin
+        && pullProcessModeDescent == task->processMode) {
+      double halfSkin = task->pctx->sysParm.neighborSkin / 2;
+      if (_pullPosDistSqrd(task->pctx, point->pos, point->verletPos)
+          > halfSkin * halfSkin) {
+        /* other points' lists may now be missing this point; so until the
+           lists are rebuilt, all the tasks go back to the bins */
+        airThreadAtomicUIntAdd(&(task->pctx->verletBroken), 1);
+      }
+    }
     task->stuckNum += (point->status & PULL_STATUS_STUCK_BIT);
   } /* for myPointIdx */
 
@@ -33,6 +33,7 @@ _pullBinInit(pullBin *bin) {
   bin->pointNum = 0;
   bin->pointArr = NULL;
   bin->neighBin = NULL;
+  bin->packPos = NULL;
   return;
 }
 
@@ -51,8 +52,8 @@ _pullBinDone(pullBin *bin) {
   return;
 }
 
-static int /* Biff: 1 */
-_pullBinNeighborSet(pullContext *pctx, pullBin *bin) {
+static int /* Biff: maybe:3:1 */
+_pullBinNeighborSet(pullContext *pctx, pullBin *bin, int useBiff) {
   static const char me[] = "_pullBinNeighborSet";
   unsigned int neiIdx, neiNum, be[4], binIdx;
   unsigned int xi, yi, zi, si, xx, yy, zz, ss, xmax, ymax, zmax, smax;
@@ -88,7 +89,8 @@ _pullBinNeighborSet(pullContext *pctx, pullBin *bin) {
     }
   }
   if (!(bin->neighBin = AIR_CALLOC(1 + neiNum, pullBin *))) {
-    biffAddf(PULL, "%s: couldn't calloc array of %u neighbor pointers", me, 1 + neiNum);
+    biffMaybeAddf(useBiff, PULL, "%s: couldn't calloc array of %u neighbor pointers",
+                  me, 1 + neiNum);
     return 1;
   }
   for (neiIdx = 0; neiIdx < neiNum; neiIdx++) {
@@ -133,31 +135,46 @@ _pullBinLocate(pullContext *pctx, double *posWorld) {
 }
 
 /*
-** this makes the bin the owner of the point
+** sets up the bin's point array and neighbor bin vector, if not done so
+** already, so that points can be added to it.  The tasks call this (with
+** useBiff false) while re-binning
 */
-static int /* Biff: 1 */
-_pullBinPointAdd(pullContext *pctx, pullBin *bin, pullPoint *point) {
-  static const char me[] = "_pullBinPointAdd";
-  int pntI;
+static int /* Biff: maybe:3:1 */
+_pullBinArraySet(pullContext *pctx, pullBin *bin, int useBiff) {
+  static const char me[] = "_pullBinArraySet";
   pullPtrPtrUnion pppu;
 
-  AIR_UNUSED(pctx);
   if (!(bin->pointArr)) {
     pppu.points = &(bin->point);
     bin->pointArr = airArrayNew(pppu.v, &(bin->pointNum), sizeof(pullPoint *),
                                 _PULL_BIN_INCR);
     if (!(bin->pointArr)) {
-      biffAddf(PULL, "%s: couldn't create point array", me);
+      biffMaybeAddf(useBiff, PULL, "%s: couldn't create point array", me);
       return 1;
     }
   }
   if (!(bin->neighBin)) {
     /* set up neighbor bin vector if not done so already */
-    if (_pullBinNeighborSet(pctx, bin)) {
-      biffAddf(PULL, "%s: couldn't initialize neighbor bins", me);
+    if (_pullBinNeighborSet(pctx, bin, useBiff)) {
+      biffMaybeAddf(useBiff, PULL, "%s: couldn't initialize neighbor bins", me);
       return 1;
     }
   }
+  return 0;
+}
+
+/*
+** this makes the bin the owner of the point
+*/
+static int /* Biff: 1 */
+_pullBinPointAdd(pullContext *pctx, pullBin *bin, pullPoint *point) {
+  static const char me[] = "_pullBinPointAdd";
+  int pntI;
+
+  if (_pullBinArraySet(pctx, bin, AIR_TRUE)) {
+    biffAddf(PULL, "%s: couldn't set up bin", me);
+    return 1;
+  }
   pntI = airArrayLenIncr(bin->pointArr, 1);
   bin->point[pntI] = point;
   return 0;
@@ -201,14 +218,34 @@ pullBinsPointAdd(pullContext *pctx, pullPoint *point, pullBin **binP) {
   return 0;
 }
 
+/*
+** whether point is too close to any of the num points in list[] to be
+** added alongside them, with flag.restrictiveAddToBins
+*/
+static int
+_pullBinPointTooClose(const pullContext *pctx, pullPoint *const *list, unsigned int num,
+                      const pullPoint *point) {
+  unsigned int idx;
+
+  for (idx = 0; idx < num; idx++) {
+    double diff[4], len;
+    ELL_4V_SUB(diff, point->pos, list[idx]->pos);
+    ELL_3V_SCALE(diff, 1 / pctx->sysParm.radiusSpace, diff);
+    diff[3] /= pctx->sysParm.radiusScale;
+    len = ELL_4V_LEN(diff);
+    if (len < _PULL_BINNING_MAYBE_ADD_THRESH) {
+      return AIR_TRUE;
+    }
+  }
+  return AIR_FALSE;
+}
+
 int /* Biff: 1 */
 pullBinsPointMaybeAdd(pullContext *pctx, pullPoint *point,
                       /* output */
                       pullBin **binP, int *added) {
   static const char me[] = "pullBinsPointMaybeAdd";
   pullBin *bin;
-  unsigned int idx;
-  int okay;
 
   if (binP) {
     *binP = NULL;
@@ -225,19 +262,7 @@ pullBinsPointMaybeAdd(pullContext *pctx, pullPoint *point,
     *binP = bin;
   }
   if (pctx->flag.restrictiveAddToBins) {
-    okay = AIR_TRUE;
-    for (idx = 0; idx < bin->pointNum; idx++) {
-      double diff[4], len;
-      ELL_4V_SUB(diff, point->pos, bin->point[idx]->pos);
-      ELL_3V_SCALE(diff, 1 / pctx->sysParm.radiusSpace, diff);
-      diff[3] /= pctx->sysParm.radiusScale;
-      len = ELL_4V_LEN(diff);
-      if (len < _PULL_BINNING_MAYBE_ADD_THRESH) {
-        okay = AIR_FALSE;
-        break;
-      }
-    }
-    if (okay) {
+    if (!_pullBinPointTooClose(pctx, bin->point, bin->pointNum, point)) {
       if (_pullBinPointAdd(pctx, bin, point)) {
         biffAddf(PULL, "%s: trouble adding point %p %u", me, AIR_VOIDP(point),
                  point->idtag);
@@ -258,6 +283,73 @@ pullBinsPointMaybeAdd(pullContext *pctx, pullPoint *point,
   return 0;
 }
 
+typedef struct {
+  airULLong code;
+  unsigned int idx;
+} _pullMortonPair;
+
+static int
+_pullMortonPairCompare(const void *_a, const void *_b) {
+  const _pullMortonPair *a, *b;
+
+  a = AIR_CAST(const _pullMortonPair *, _a);
+  b = AIR_CAST(const _pullMortonPair *, _b);
+  return (a->code < b->code ? -1 : (a->code > b->code ? 1 : 0));
+}
+
+/*
+** sets pctx->binOrder[]: the order in which bins are handed out to the
+** tasks. This is the usual linear order, unless flag.binPack, in which
+** case bins are sorted along a 4-D Morton (Z-order) curve, so that bins
+** processed one after the other share most of their neighbors
+*/
+static int /* Biff: 1 */
+_pullBinOrderSet(pullContext *pctx) {
+  static const char me[] = "_pullBinOrderSet";
+  unsigned int binIdx, axi, bit, rem, coord[4];
+  _pullMortonPair *pair;
+
+  pctx->binOrder = AIR_CALLOC(pctx->binNum, unsigned int);
+  pctx->binWork = AIR_CALLOC(pctx->binNum, unsigned int);
+  if (!(pctx->binOrder && pctx->binWork)) {
+    biffAddf(PULL, "%s: couldn't allocate bin order for %u bins", me, pctx->binNum);
+    return 1;
+  }
+  if (!pctx->flag.binPack || 1 == pctx->binNum) {
+    for (binIdx = 0; binIdx < pctx->binNum; binIdx++) {
+      pctx->binOrder[binIdx] = binIdx;
+    }
+    return 0;
+  }
+  pair = AIR_CALLOC(pctx->binNum, _pullMortonPair);
+  if (!pair) {
+    biffAddf(PULL, "%s: couldn't allocate Morton codes for %u bins", me, pctx->binNum);
+    return 1;
+  }
+  for (binIdx = 0; binIdx < pctx->binNum; binIdx++) {
+    rem = binIdx;
+    for (axi = 0; axi < 4; axi++) {
+      coord[axi] = rem % pctx->binsEdge[axi];
+      rem /= pctx->binsEdge[axi];
+    }
+    /* 16 bits per axis is plenty, given PULL_BIN_MAXNUM */
+    pair[binIdx].code = 0;
+    for (bit = 0; bit < 16; bit++) {
+      for (axi = 0; axi < 4; axi++) {
+        pair[binIdx].code |= AIR_CAST(airULLong, (coord[axi] >> bit) & 1)
+                             << (4 * bit + axi);
+      }
+    }
+    pair[binIdx].idx = binIdx;
+  }
+  qsort(pair, pctx->binNum, sizeof(_pullMortonPair), _pullMortonPairCompare);
+  for (binIdx = 0; binIdx < pctx->binNum; binIdx++) {
+    pctx->binOrder[binIdx] = pair[binIdx].idx;
+  }
+  free(pair);
+  return 0;
+}
+
 int /* Biff: (private) 1 */
 _pullBinSetup(pullContext *pctx) {
   static const char me[] = "_pullBinSetup";
@@ -273,6 +365,9 @@ _pullBinSetup(pullContext *pctx) {
   pctx->maxDistSpace = pctx->sysParm.binWidthSpace * width;
   width = (pctx->sysParm.radiusScale ? pctx->sysParm.radiusScale : 0.1);
   pctx->maxDistScale = 1 * width;
+  /* with Verlet lists, the bins have to hold everything within the skin */
+  pctx->maxDistSpace *= 1 + pctx->sysParm.neighborSkin;
+  pctx->maxDistScale *= 1 + pctx->sysParm.neighborSkin;
 
   if (pctx->verbose) {
     printf("%s: radiusSpace = %g -(%g)-> maxDistSpace = %g\n", me,
@@ -346,6 +441,10 @@ _pullBinSetup(pullContext *pctx) {
     pctx->bin[0].neighBin[0] = pctx->bin + 0;
     pctx->bin[0].neighBin[1] = NULL;
   }
+  if (_pullBinOrderSet(pctx)) {
+    biffAddf(PULL, "%s: couldn't set bin processing order", me);
+    return 1;
+  }
   return 0;
 }
 
@@ -359,6 +458,460 @@ _pullBinFinish(pullContext *pctx) {
   pctx->bin = (pullBin *)airFree(pctx->bin);
   ELL_4V_SET(pctx->binsEdge, 0, 0, 0, 0);
   pctx->binNum = 0;
+  pctx->binOrder = (unsigned int *)airFree(pctx->binOrder);
+  pctx->binWork = (unsigned int *)airFree(pctx->binWork);
+  pctx->binWorkNum = 0;
+  pctx->packPos = (double *)airFree(pctx->packPos);
+  pctx->packPosNum = 0;
+}
+
+/*
+** with flag.binPack, copies the positions of all binned points into
+** pctx->packPos, bin after bin in processing order, and points each
+** bin->packPos into it. Called by the master thread before the tasks
+** start an iteration; bin membership does not change until the
+** iteration finisher runs, and during the iteration pullBinProcess()
+** writes back each position it changes
+*/
+int /* Biff: (private) 1 */
+_pullBinsPack(pullContext *pctx) {
+  static const char me[] = "_pullBinsPack";
+  unsigned int orderIdx, pointIdx, pointNum;
+  double *pos;
+  pullBin *bin;
+
+  if (!pctx->flag.binPack) {
+    return 0;
+  }
+  pointNum = pullPointNumber(pctx);
+  if (pointNum > pctx->packPosNum) {
+    airFree(pctx->packPos);
+    /* some slack, so that modest population growth doesn't realloc */
+    pctx->packPosNum = pointNum + pointNum / 8 + 1;
+    pctx->packPos = AIR_CALLOC(4 * pctx->packPosNum, double);
+    if (!pctx->packPos) {
+      biffAddf(PULL, "%s: couldn't allocate packed positions for %u points", me,
+               pctx->packPosNum);
+      pctx->packPosNum = 0;
+      return 1;
+    }
+  }
+  pos = pctx->packPos;
+  for (orderIdx = 0; orderIdx < pctx->binNum; orderIdx++) {
+    bin = pctx->bin + pctx->binOrder[orderIdx];
+    bin->packPos = pos;
+    for (pointIdx = 0; pointIdx < bin->pointNum; pointIdx++) {
+      ELL_4V_COPY(pos, bin->point[pointIdx]->pos);
+      pos += 4;
+    }
+  }
+  return 0;
+}
+
+typedef struct {
+  double cost;
+  unsigned int rank, /* position in binOrder, to break ties */
+    idx;
+} _pullBinCost;
+
+static int
+_pullBinCostCompare(const void *_a, const void *_b) {
+  const _pullBinCost *a, *b;
+
+  a = AIR_CAST(const _pullBinCost *, _a);
+  b = AIR_CAST(const _pullBinCost *, _b);
+  /* decreasing cost */
+  return (a->cost > b->cost
+            ? -1
+            : (a->cost < b->cost ? 1 : (a->rank < b->rank ? -1 : a->rank > b->rank)));
+}
+
+/*
+** sets pctx->binWork, binWorkNum, and binWorkChunk: the list of bins
+** that the tasks will process in this iteration, and how many of them
+** a task takes at a time. Empty bins are left out, so that tasks never
+** have to skip over them. With more than one thread, the bins are
+** sorted by decreasing estimated cost (# points in the bin times # points
+** in all its neighbor bins), so that the expensive bins get started
+** first, and the cheap bins at the end even out the load. With one
+** thread, the order is simply pctx->binOrder, so that results are the
+** same as they have always been.
+**
+** Called by the master thread only, before the tasks start
+*/
+int /* Biff: (private) 1 */
+_pullBinsWorkSet(pullContext *pctx) {
+  static const char me[] = "_pullBinsWorkSet";
+  unsigned int orderIdx, workIdx, neiIdx, neiPointNum;
+  pullBin *bin, *herBin;
+  _pullBinCost *cost;
+
+  pctx->binWorkNum = 0;
+  for (orderIdx = 0; orderIdx < pctx->binNum; orderIdx++) {
+    if (pctx->bin[pctx->binOrder[orderIdx]].pointNum) {
+      pctx->binWork[pctx->binWorkNum++] = pctx->binOrder[orderIdx];
+    }
+  }
+  if (1 == pctx->threadNum) {
+    pctx->binWorkChunk = 1;
+    return 0;
+  }
+  pctx->binWorkChunk = airThreadFetchChunk(pctx->binWorkNum, pctx->threadNum);
+  if (pctx->binWorkNum < 2) {
+    return 0;
+  }
+  cost = AIR_CALLOC(pctx->binWorkNum, _pullBinCost);
+  if (!cost) {
+    biffAddf(PULL, "%s: couldn't allocate costs for %u bins", me, pctx->binWorkNum);
+    return 1;
+  }
+  for (workIdx = 0; workIdx < pctx->binWorkNum; workIdx++) {
+    bin = pctx->bin + pctx->binWork[workIdx];
+    neiPointNum = 0;
+    for (neiIdx = 0; (herBin = bin->neighBin[neiIdx]); neiIdx++) {
+      neiPointNum += herBin->pointNum;
+    }
+    cost[workIdx].cost = AIR_CAST(double, bin->pointNum) * neiPointNum;
+    cost[workIdx].rank = workIdx;
+    cost[workIdx].idx = pctx->binWork[workIdx];
+  }
+  qsort(cost, pctx->binWorkNum, sizeof(_pullBinCost), _pullBinCostCompare);
+  for (workIdx = 0; workIdx < pctx->binWorkNum; workIdx++) {
+    pctx->binWork[workIdx] = cost[workIdx].idx;
+  }
+  free(cost);
+  return 0;
+}
+
+/*
+** with sysParm.neighborSkin, decides at the start of a descent iteration
+** whether the Verlet lists (pullPoint->verletPoint) can be re-used: they
+** are good as long as the population hasn't changed, and no point has
+** moved more than half the skin since they were built (as some task saw
+** happen in the last iteration, or as seen here). Otherwise, this
+** records every point's current position in verletPos, and increments
+** pctx->verletStamp, so that each point's list is rebuilt (by the task
+** processing it) the next time it is needed. Sets pctx->verletDispMax
+** and pctx->verletRebuilt, and resets pctx->verletBroken.
+**
+** Called by the master thread only, before the tasks start
+*/
+void
+_pullVerletCheck(pullContext *pctx) {
+  unsigned int binIdx, pointIdx;
+  double halfSkin, dsq, dsqMax;
+  pullBin *bin;
+  pullPoint *point;
+
+  if (!pctx->sysParm.neighborSkin) {
+    pctx->verletRebuilt = AIR_FALSE;
+    pctx->verletDispMax = 0;
+    pctx->verletBroken = 0;
+    return;
+  }
+  dsqMax = 0;
+  for (binIdx = 0; binIdx < pctx->binNum; binIdx++) {
+    bin = pctx->bin + binIdx;
+    for (pointIdx = 0; pointIdx < bin->pointNum; pointIdx++) {
+      point = bin->point[pointIdx];
+      dsq = _pullPosDistSqrd(pctx, point->pos, point->verletPos);
+      /* (a NaN verletPos, on a point never seen before, also forces rebuild) */
+      dsqMax = AIR_EXISTS(dsq) ? AIR_MAX(dsqMax, dsq) : AIR_POS_INF;
+    }
+  }
+  pctx->verletDispMax = sqrt(dsqMax);
+  halfSkin = pctx->sysParm.neighborSkin / 2;
+  pctx->verletRebuilt = (pctx->verletStale || pctx->verletBroken || !pctx->verletStamp
+                         || pctx->verletDispMax > halfSkin);
+  pctx->verletBroken = 0;
+  if (pctx->verletRebuilt) {
+    for (binIdx = 0; binIdx < pctx->binNum; binIdx++) {
+      bin = pctx->bin + binIdx;
+      for (pointIdx = 0; pointIdx < bin->pointNum; pointIdx++) {
+        point = bin->point[pointIdx];
+        ELL_4V_COPY(point->verletPos, point->pos);
+      }
+    }
+    /* stamp 0 is never current */
+    pctx->verletStamp = pctx->verletStamp + 1 ? pctx->verletStamp + 1 : 1;
+    pctx->verletStale = AIR_FALSE;
+    pctx->count[pullCountVerletRebuild] += 1;
+  }
+  return;
+}
+
+/*
+** invalidates what _pullBinsPack set up, since bin membership is about
+** to change
+*/
+void
+_pullBinsUnpack(pullContext *pctx) {
+  unsigned int binIdx;
+
+  if (!pctx->flag.binPack) {
+    return;
+  }
+  for (binIdx = 0; binIdx < pctx->binNum; binIdx++) {
+    pctx->bin[binIdx].packPos = NULL;
+  }
+  return;
+}
+
+/*
+** The iteration finishers re-bin all the points (_pullIterFinishDescent)
+** or add many new ones (_pullIterFinishAdding). That is done by all the
+** tasks at once, in stages (see the _pullStage* enum), with no locking:
+**
+** _pullBinsGather: (re-binning only) each task copies the points from a
+**   range of bins to pctx->tmpPointPtr, starting at task->stageStart
+** _pullBinsCount: each task finds the bins for its points (a range of
+**   the permuted tmpPointPtr, or its own addPoint list), and counts how
+**   many go in each bin, in task->binCount
+** _pullBinsSize: bin by bin, turns those counts into where each task's
+**   points start in the bin, and resizes the bin to hold them all
+** _pullBinsScatter: each task puts its points in their bins
+** _pullBinsRestrict: (adding with flag.restrictiveAddToBins only) bin by
+**   bin, removes the new points that are too close to earlier new ones
+**
+** These return a _pullStageErr* value, and don't use biff, since they're
+** done by the worker threads.  With one thread, the points end up in
+** each bin in the same order as when they used to be binned one at a
+** time, so single-threaded results are unchanged.
+*/
+
+/* the part of [0,num) that is task threadIdx's, out of threadNum */
+static void
+_pullStageRange(unsigned int *lo, unsigned int *hi, unsigned int num,
+                unsigned int threadIdx, unsigned int threadNum) {
+  *lo = AIR_UINT(AIR_CAST(airULLong, num) * threadIdx / threadNum);
+  *hi = AIR_UINT(AIR_CAST(airULLong, num) * (threadIdx + 1) / threadNum);
+  return;
+}
+
+/* the points that a task is binning: list[perm[ii]] (or list[ii] if perm
+   is NULL) for ii in [lo,hi) */
+static void
+_pullBinsStagePoints(pullPoint ***list, const unsigned int **perm, unsigned int *lo,
+                     unsigned int *hi, const pullTask *task) {
+  const pullContext *pctx;
+
+  pctx = task->pctx;
+  if (pullProcessModeAdding == task->processMode) {
+    *list = task->addPoint;
+    *perm = NULL;
+    *lo = 0;
+    *hi = task->addPointNum;
+  } else {
+    *list = pctx->tmpPointPtr;
+    *perm = pctx->tmpPointPerm;
+    _pullStageRange(lo, hi, pctx->tmpPointNum, task->threadIdx, pctx->threadNum);
+  }
+  return;
+}
+
+int /* Biff: (private) nope */
+_pullBinsGather(pullTask *task) {
+  pullContext *pctx;
+  unsigned int lo, hi, binIdx, pointIdx, runIdx;
+  pullBin *bin;
+
+  pctx = task->pctx;
+  _pullStageRange(&lo, &hi, pctx->binNum, task->threadIdx, pctx->threadNum);
+  runIdx = task->stageStart;
+  for (binIdx = lo; binIdx < hi; binIdx++) {
+    bin = pctx->bin + binIdx;
+    if (!bin->pointNum) {
+      continue;
+    }
+    /* this is the order in which points used to be taken out of the bin,
+       one at a time with _pullBinPointRemove(,,0): the first, and then
+       the rest from the end */
+    pctx->tmpPointPtr[runIdx++] = bin->point[0];
+    for (pointIdx = bin->pointNum - 1; pointIdx > 0; pointIdx--) {
+      pctx->tmpPointPtr[runIdx++] = bin->point[pointIdx];
+    }
+  }
+  return 0;
+}
+
+int /* Biff: (private) nope */
+_pullBinsCount(pullTask *task) {
+  pullContext *pctx;
+  pullPoint **list, *point;
+  const unsigned int *perm;
+  unsigned int lo, hi, ii;
+  pullBin *bin;
+  int restrictive;
+
+  pctx = task->pctx;
+  memset(task->binCount, 0, pctx->binNum * sizeof(unsigned int));
+  restrictive = (pullProcessModeAdding == task->processMode
+                 && pctx->flag.restrictiveAddToBins);
+  _pullBinsStagePoints(&list, &perm, &lo, &hi, task);
+  for (ii = lo; ii < hi; ii++) {
+    point = list[perm ? perm[ii] : ii];
+    /* (checked here so that _pullBinLocate won't use biff) */
+    if (!ELL_4V_EXISTS(point->pos)) {
+      task->stageErrIdx = point->idtag;
+      return _pullStageErrLocate;
+    }
+    bin = _pullBinLocate(pctx, point->pos);
+    if (restrictive) {
+      /* the bins aren't changing right now, so this can check against
+         the points that were already there; _pullBinsRestrict checks
+         against the other new points */
+      if (_pullBinPointTooClose(pctx, bin->point, bin->pointNum, point)) {
+        point->status &= ~PULL_STATUS_NEWBIE_BIT;
+        point->status |= PULL_STATUS_NIXME_BIT;
+        continue;
+      }
+    } else {
+      point->status &= ~PULL_STATUS_NEWBIE_BIT;
+    }
+    task->binCount[bin - pctx->bin] += 1;
+  }
+  return 0;
+}
+
+int /* Biff: (private) nope */
+_pullBinsSize(pullTask *task) {
+  pullContext *pctx;
+  unsigned int workIdx, workStop, binIdx, taskIdx, num, cnt;
+  pullBin *bin;
+
+  pctx = task->pctx;
+  while ((workIdx = airThreadAtomicUIntAdd(&(pctx->binNextIdx), _PULL_STAGE_BIN_CHUNK))
+         < pctx->binNum) {
+    workStop = AIR_MIN(workIdx + _PULL_STAGE_BIN_CHUNK, pctx->binNum);
+    for (binIdx = workIdx; binIdx < workStop; binIdx++) {
+      bin = pctx->bin + binIdx;
+      /* when re-binning, all the points in the bin are going elsewhere */
+      num = (pullProcessModeAdding == task->processMode ? bin->pointNum : 0);
+      for (taskIdx = 0; taskIdx < pctx->threadNum; taskIdx++) {
+        cnt = pctx->task[taskIdx]->binCount[binIdx];
+        pctx->task[taskIdx]->binCount[binIdx] = num;
+        num += cnt;
+      }
+      if (num == bin->pointNum) {
+        continue;
+      }
+      if (num && _pullBinArraySet(pctx, bin, AIR_FALSE)) {
+        task->stageErrIdx = binIdx;
+        return _pullStageErrBinSet;
+      }
+      airArrayLenSet(bin->pointArr, num);
+      if (num && !bin->point) {
+        task->stageErrIdx = binIdx;
+        return _pullStageErrBinAlloc;
+      }
+    }
+  }
+  return 0;
+}
+
+int /* Biff: (private) nope */
+_pullBinsScatter(pullTask *task) {
+  pullContext *pctx;
+  pullPoint **list, *point;
+  const unsigned int *perm;
+  unsigned int lo, hi, ii, idx;
+  pullBin *bin;
+
+  pctx = task->pctx;
+  _pullBinsStagePoints(&list, &perm, &lo, &hi, task);
+  for (ii = lo; ii < hi; ii++) {
+    idx = perm ? perm[ii] : ii;
+    point = list[idx];
+    if (pullProcessModeAdding == task->processMode) {
+      if (point->status & PULL_STATUS_NIXME_BIT) {
+        /* turned away by _pullBinsCount */
+        continue;
+      }
+    } else {
+      list[idx] = NULL;
+    }
+    /* _pullBinsCount already located it, so this can't fail */
+    bin = _pullBinLocate(pctx, point->pos);
+    bin->point[task->binCount[bin - pctx->bin]++] = point;
+  }
+  return 0;
+}
+
+int /* Biff: (private) nope */
+_pullBinsRestrict(pullTask *task) {
+  pullContext *pctx;
+  unsigned int workIdx, workStop, binIdx, first, keep, pointIdx;
+  pullPoint *point;
+  pullBin *bin;
+
+  pctx = task->pctx;
+  while ((workIdx = airThreadAtomicUIntAdd(&(pctx->binNextIdx), _PULL_STAGE_BIN_CHUNK))
+         < pctx->binNum) {
+    workStop = AIR_MIN(workIdx + _PULL_STAGE_BIN_CHUNK, pctx->binNum);
+    for (binIdx = workIdx; binIdx < workStop; binIdx++) {
+      bin = pctx->bin + binIdx;
+      /* the new points are still NEWBIEs, all at the end of the bin */
+      first = bin->pointNum;
+      while (first && (bin->point[first - 1]->status & PULL_STATUS_NEWBIE_BIT)) {
+        first--;
+      }
+      keep = first;
+      for (pointIdx = first; pointIdx < bin->pointNum; pointIdx++) {
+        point = bin->point[pointIdx];
+        point->status &= ~PULL_STATUS_NEWBIE_BIT;
+        if (_pullBinPointTooClose(pctx, bin->point + first, keep - first, point)) {
+          point->status |= PULL_STATUS_NIXME_BIT;
+        } else {
+          bin->point[keep++] = point;
+        }
+      }
+      if (keep < bin->pointNum) {
+        airArrayLenSet(bin->pointArr, keep);
+      }
+    }
+  }
+  return 0;
+}
+
+/*
+** bins (with all the tasks) the points in the tasks' addPoint lists (in
+** adding mode), or in pctx->tmpPointPtr (otherwise, permuted by
+** pctx->tmpPointPerm), as described above. In adding mode with
+** flag.restrictiveAddToBins, the points that weren't added have their
+** NIXME bit set.
+*/
+int /* Biff: (private) 1 */
+_pullBinsAddAll(pullContext *pctx) {
+  static const char me[] = "_pullBinsAddAll";
+  unsigned int taskIdx, num;
+  int adding;
+
+  adding = (pullProcessModeAdding == pctx->task[0]->processMode);
+  num = 0;
+  for (taskIdx = 0; taskIdx < pctx->threadNum; taskIdx++) {
+    pullTask *task = pctx->task[taskIdx];
+    num += adding ? task->addPointNum : 0;
+    if (!task->binCount) {
+      task->binCount = AIR_CALLOC(pctx->binNum, unsigned int);
+      if (!task->binCount) {
+        biffAddf(PULL, "%s: couldn't allocate %u bin counts for task %u", me,
+                 pctx->binNum, taskIdx);
+        return 1;
+      }
+    }
+  }
+  if (adding && !num) {
+    /* nothing to do */
+    return 0;
+  }
+  if (_pullStageRun(pctx, _pullStageCount) || _pullStageRun(pctx, _pullStageSize)
+      || _pullStageRun(pctx, _pullStageScatter)
+      || (adding && pctx->flag.restrictiveAddToBins
+          && _pullStageRun(pctx, _pullStageRestrict))) {
+    biffAddf(PULL, "%s: trouble binning points", me);
+    return 1;
+  }
+  return 0;
 }
 
 /*
@@ -367,18 +920,20 @@ _pullBinFinish(pullContext *pctx) {
 ** reallocates pctx->tmpPointPerm and pctx->tmpPointPtr
 ** the point of this is to do rebinning
 **
-** This function is only called by the master thread, this
-** does *not* have to be thread-safe in any way
+** This function is only called by the master thread, but it has all
+** the tasks do the rebinning, with _pullStageRun
 */
 int /* Biff: (private) 1 */
 _pullIterFinishDescent(pullContext *pctx) {
   static const char me[] = "_pullIterFinishDescent";
-  unsigned int oldBinIdx, pointIdx, taskIdx, runIdx, pointNum;
-  pullBin *oldBin;
+  unsigned int binIdx, pointIdx, taskIdx, runIdx, pointNum, lo, hi;
   pullPoint *point;
   int added;
 
-  _pullNixTheNixed(pctx);
+  if (_pullNixTheNixed(pctx)) {
+    biffAddf(PULL, "%s: trouble nixing points", me);
+    return 1;
+  }
 
   pctx->stuckNum = 0;
   for (taskIdx = 0; taskIdx < pctx->threadNum; taskIdx++) {
@@ -404,21 +959,38 @@ _pullIterFinishDescent(pullContext *pctx) {
     }
     pctx->tmpPointNum = pointNum;
   }
+  /* the tasks copy the points of their ranges of bins to tmpPointPtr */
   runIdx = 0;
-  for (oldBinIdx = 0; oldBinIdx < pctx->binNum; oldBinIdx++) {
-    oldBin = pctx->bin + oldBinIdx;
-    while (oldBin->pointNum) {
-      /* tricky: we can't traverse bin->point[], because of how it is
-         re-ordered on point removal, so we always grab point[0] */
-      pctx->tmpPointPtr[runIdx++] = oldBin->point[0];
-      _pullBinPointRemove(pctx, oldBin, 0);
+  for (taskIdx = 0; taskIdx < pctx->threadNum; taskIdx++) {
+    pctx->task[taskIdx]->stageStart = runIdx;
+    _pullStageRange(&lo, &hi, pctx->binNum, taskIdx, pctx->threadNum);
+    for (binIdx = lo; binIdx < hi; binIdx++) {
+      runIdx += pctx->bin[binIdx].pointNum;
     }
   }
+  if (_pullStageRun(pctx, _pullStageGather)) {
+    biffAddf(PULL, "%s: trouble gathering points", me);
+    return 1;
+  }
   airShuffle_r(pctx->task[0]->rng, pctx->tmpPointPerm, pointNum,
                pctx->flag.permuteOnRebin);
   if (pctx->flag.permuteOnRebin && pctx->verbose) {
     printf("%s: permuting %u points\n", me, pointNum);
   }
+  if (!(pctx->constraint && 0 == pctx->constraintDim)) {
+    /* every point goes back into some bin, so all the tasks can do it */
+    if (_pullBinsAddAll(pctx)) {
+      biffAddf(PULL, "%s: trouble re-binning", me);
+      return 1;
+    }
+    return 0;
+  }
+  /* else points are re-binned one at a time, since whether one is added
+     depends on which others were added before it; so all the bins are
+     emptied first */
+  for (binIdx = 0; binIdx < pctx->binNum; binIdx++) {
+    airArrayLenSet(pctx->bin[binIdx].pointArr, 0);
+  }
   for (pointIdx = 0; pointIdx < pointNum; pointIdx++) {
     point = pctx->tmpPointPtr[pctx->tmpPointPerm[pointIdx]];
     /*
@@ -432,26 +1004,19 @@ _pullIterFinishDescent(pullContext *pctx) {
        along scale), its easy for many points to start piling on top
        of each other; that is the problem that
        pullFlagRestrictiveAddToBins was designed to solve. */
-    if (pctx->constraint && 0 == pctx->constraintDim) {
-      if (pullBinsPointMaybeAdd(pctx, point, NULL, &added)) {
-        biffAddf(PULL, "%s: trouble binning? point %u", me, point->idtag);
-        return 1;
-      }
-      if (!added) {
-        /* the point wasn't owned by any bin, and now it turns out
-           no bin wanted to own it, so we have to remove it */
-        /* in the case of point maxima searching; this mainly happened
-           because two points at the same spatial positition slowly
-           descended along scale towards each other at the scale of
-           maximal strength */
-        point = pullPointNix(point);
-      }
-    } else {
-      if (pullBinsPointAdd(pctx, point, NULL)) {
-        biffAddf(PULL, "%s: trouble binning point %u", me, point->idtag);
-        return 1;
-      }
-      point = NULL;
+    if (pullBinsPointMaybeAdd(pctx, point, NULL, &added)) {
+      biffAddf(PULL, "%s: trouble binning? point %u", me, point->idtag);
+      return 1;
+    }
+    if (!added) {
+      /* the point wasn't owned by any bin, and now it turns out
+         no bin wanted to own it, so we have to remove it */
+      /* in the case of point maxima searching; this mainly happened
+         because two points at the same spatial positition slowly
+         descended along scale towards each other at the scale of
+         maximal strength */
+      point = pullPointNix(point);
+      pctx->verletStale = AIR_TRUE;
     }
     pctx->tmpPointPtr[pctx->tmpPointPerm[pointIdx]] = NULL;
   }
@@ -0,0 +1,785 @@
+/*
+  Teem: Tools to process and visualize scientific data and images
+  Copyright (C) 2009--2023  University of Chicago
+  Copyright (C) 2005--2008  Gordon Kindlmann
+  Copyright (C) 1998--2004  University of Utah
+
+  This library is free software; you can redistribute it and/or modify it under the terms
+  of the GNU Lesser General Public License (LGPL) as published by the Free Software
+  Foundation; either version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also include exceptions to
+  the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+  PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with
+  this library; if not, write to Free Software Foundation, Inc., 51 Franklin Street,
+  Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "pull.h"
+#include "privatePull.h"
+
+/*
+** A checkpoint is a 1-D nrrd of doubles, saved with raw encoding, with
+** key/value pairs for the scalar state of the context and of pullRun().
+** The data is, in order:
+**
+** pointNum records of (CHKP_POINT_LEN + infoTotalLen) values, one per
+**   point, in the order that the points are in the bins, so that
+**   re-binning them recovers the same order of processing
+** the idtags of the neighPoint[] of all the points (the per-point
+**   lengths are in the records)
+** the idtags of the verletPoint[] of all the points
+** threadNum RNG states, of CHKP_RNG_LEN values each
+**
+** All the integers involved are exactly representable as doubles, and
+** doubles in the key/value pairs are printed with "%.17g", so nothing
+** is lost; resuming from a checkpoint with the same number of threads
+** leads to exactly the same result as never having stopped.
+*/
+
+#define CHKP_KEY     "pull checkpoint"
+/* version 2: two more pullCount* values (probe cache hits and misses) */
+#define CHKP_VERSION "2"
+
+#if PULL_TANCOVAR
+#  define CHKP_POINT_LEN 41
+#else
+#  define CHKP_POINT_LEN 35
+#endif
+
+/* the state[], and then pNext (as index into state) and left */
+#define CHKP_RNG_LEN (AIR_RANDMT_N + 2)
+
+static double *
+_chkpPointPut(double *dd, const pullPoint *pnt, unsigned int neighNum,
+              unsigned int verletNum, unsigned int infoLen) {
+  unsigned int ii;
+
+  *dd++ = pnt->idtag;
+  *dd++ = pnt->idCC;
+  *dd++ = pnt->status;
+  *dd++ = pnt->stuckIterNum;
+  *dd++ = pnt->neighInterNum;
+  *dd++ = neighNum;
+  *dd++ = verletNum;
+  *dd++ = verletNum ? pnt->verletStamp : 0;
+  ELL_4V_COPY(dd, pnt->pos);
+  dd += 4;
+  ELL_4V_COPY(dd, pnt->verletPos);
+  dd += 4;
+  *dd++ = pnt->energy;
+  ELL_4V_COPY(dd, pnt->force);
+  dd += 4;
+  *dd++ = pnt->stepEnergy;
+  *dd++ = pnt->stepConstr;
+  *dd++ = pnt->neighDistMean;
+  *dd++ = pnt->stability;
+  for (ii = 0; ii < 10; ii++) {
+    *dd++ = pnt->neighCovar[ii];
+  }
+#if PULL_TANCOVAR
+  for (ii = 0; ii < 6; ii++) {
+    *dd++ = pnt->neighTanCovar[ii];
+  }
+#endif
+  for (ii = 0; ii < infoLen; ii++) {
+    *dd++ = pnt->info[ii];
+  }
+  return dd;
+}
+
+static const double *
+_chkpPointGet(pullPoint *pnt, unsigned int *neighNum, unsigned int *verletNum,
+              const double *dd, unsigned int infoLen) {
+  unsigned int ii;
+
+  pnt->idtag = AIR_UINT(*dd++);
+  pnt->idCC = AIR_UINT(*dd++);
+  pnt->status = AIR_INT(*dd++);
+  pnt->stuckIterNum = AIR_UINT(*dd++);
+  pnt->neighInterNum = AIR_UINT(*dd++);
+  *neighNum = AIR_UINT(*dd++);
+  *verletNum = AIR_UINT(*dd++);
+  pnt->verletStamp = AIR_UINT(*dd++);
+  ELL_4V_COPY(pnt->pos, dd);
+  dd += 4;
+  ELL_4V_COPY(pnt->verletPos, dd);
+  dd += 4;
+  pnt->energy = *dd++;
+  ELL_4V_COPY(pnt->force, dd);
+  dd += 4;
+  pnt->stepEnergy = *dd++;
+  pnt->stepConstr = *dd++;
+  pnt->neighDistMean = *dd++;
+  pnt->stability = AIR_FLOAT(*dd++);
+  for (ii = 0; ii < 10; ii++) {
+    pnt->neighCovar[ii] = AIR_FLOAT(*dd++);
+  }
+#if PULL_TANCOVAR
+  for (ii = 0; ii < 6; ii++) {
+    pnt->neighTanCovar[ii] = AIR_FLOAT(*dd++);
+  }
+#endif
+  for (ii = 0; ii < infoLen; ii++) {
+    pnt->info[ii] = *dd++;
+  }
+  return dd;
+}
+
+static int
+_chkpPtrCompare(const void *_a, const void *_b) {
+  const pullPoint *const *a, *const *b;
+
+  a = AIR_CAST(const pullPoint *const *, _a);
+  b = AIR_CAST(const pullPoint *const *, _b);
+  return (*a < *b ? -1 : (*a > *b ? 1 : 0));
+}
+
+static int
+_chkpIdtagCompare(const void *_a, const void *_b) {
+  const pullPoint *const *a, *const *b;
+
+  a = AIR_CAST(const pullPoint *const *, _a);
+  b = AIR_CAST(const pullPoint *const *, _b);
+  return ((*a)->idtag < (*b)->idtag ? -1 : ((*a)->idtag > (*b)->idtag ? 1 : 0));
+}
+
+/*
+** how many of the num points in list[] are among the sorted live[]
+** points, which is how neighPoint[] entries of points that have since
+** been nixed are dropped (without looking at them)
+*/
+static unsigned int
+_chkpLiveNum(pullPoint *const *live, unsigned int liveNum, pullPoint *const *list,
+             unsigned int num) {
+  unsigned int ii, ret;
+
+  ret = 0;
+  for (ii = 0; ii < num; ii++) {
+    ret += !!bsearch(list + ii, live, liveNum, sizeof(pullPoint *), _chkpPtrCompare);
+  }
+  return ret;
+}
+
+/*
+** sets nout to the checkpoint of pctx: this is the part that is done
+** by the master thread, and then _pullCheckpointWrite does the rest
+*/
+static int /* Biff: 1 */
+_pullCheckpointFill(Nrrd *nout, pullContext *pctx) {
+  static const char me[] = "_pullCheckpointFill";
+  char stmp[AIR_STRLEN_LARGE + 1], *cstr;
+  unsigned int binIdx, pointIdx, pointNum, pointLen, neighNum, verletNum, num, ii, ti,
+    ci, *vnum;
+  size_t total;
+  double *dd, *nd, *vd;
+  pullBin *bin;
+  pullPoint *point, **live;
+  airArray *mop;
+  int E;
+
+  mop = airMopNew();
+  pointNum = pullPointNumber(pctx);
+  pointLen = CHKP_POINT_LEN + pctx->infoTotalLen;
+  live = AIR_CALLOC(pointNum ? pointNum : 1, pullPoint *);
+  vnum = AIR_CALLOC(pointNum ? pointNum : 1, unsigned int);
+  airMopAdd(mop, live, airFree, airMopAlways);
+  airMopAdd(mop, vnum, airFree, airMopAlways);
+  if (!(live && vnum)) {
+    biffAddf(PULL, "%s: couldn't allocate buffers for %u points", me, pointNum);
+    airMopError(mop);
+    return 1;
+  }
+  ii = 0;
+  for (binIdx = 0; binIdx < pctx->binNum; binIdx++) {
+    bin = pctx->bin + binIdx;
+    for (pointIdx = 0; pointIdx < bin->pointNum; pointIdx++) {
+      live[ii++] = bin->point[pointIdx];
+    }
+  }
+  qsort(live, pointNum, sizeof(pullPoint *), _chkpPtrCompare);
+  /* learn how long the lists are going to be; the Verlet lists are
+     only worth saving if they are current (and then, all their points
+     are alive) */
+  neighNum = verletNum = 0;
+  ii = 0;
+  for (binIdx = 0; binIdx < pctx->binNum; binIdx++) {
+    bin = pctx->bin + binIdx;
+    for (pointIdx = 0; pointIdx < bin->pointNum; pointIdx++, ii++) {
+      point = bin->point[pointIdx];
+      neighNum += _chkpLiveNum(live, pointNum, point->neighPoint, point->neighPointNum);
+      vnum[ii] = (!pctx->verletStale && pctx->verletStamp
+                      && point->verletStamp == pctx->verletStamp
+                    ? point->verletPointNum
+                    : 0);
+      verletNum += vnum[ii];
+    }
+  }
+  total = (AIR_CAST(size_t, pointNum) * pointLen + neighNum + verletNum
+           + AIR_CAST(size_t, pctx->threadNum) * CHKP_RNG_LEN);
+  if (nrrdMaybeAlloc_va(nout, nrrdTypeDouble, 1, total)) {
+    biffMovef(PULL, NRRD, "%s: couldn't allocate checkpoint", me);
+    airMopError(mop);
+    return 1;
+  }
+  dd = AIR_CAST(double *, nout->data);
+  nd = dd + AIR_CAST(size_t, pointNum) * pointLen;
+  vd = nd + neighNum;
+  ii = 0;
+  for (binIdx = 0; binIdx < pctx->binNum; binIdx++) {
+    bin = pctx->bin + binIdx;
+    for (pointIdx = 0; pointIdx < bin->pointNum; pointIdx++, ii++) {
+      point = bin->point[pointIdx];
+      num = 0;
+      for (ci = 0; ci < point->neighPointNum; ci++) {
+        if (bsearch(point->neighPoint + ci, live, pointNum, sizeof(pullPoint *),
+                    _chkpPtrCompare)) {
+          *nd++ = point->neighPoint[ci]->idtag;
+          num++;
+        }
+      }
+      for (ci = 0; ci < vnum[ii]; ci++) {
+        *vd++ = point->verletPoint[ci]->idtag;
+      }
+      dd = _chkpPointPut(dd, point, num, vnum[ii], pctx->infoTotalLen);
+    }
+  }
+  dd = vd;
+  for (ti = 0; ti < pctx->threadNum; ti++) {
+    airRandMTState *rng = pctx->task[ti]->rng;
+    for (ci = 0; ci < AIR_RANDMT_N; ci++) {
+      *dd++ = rng->state[ci];
+    }
+    *dd++ = AIR_CAST(double, rng->pNext - rng->state);
+    *dd++ = rng->left;
+  }
+
+  nrrdKeyValueClear(nout);
+  E = 0;
+#define PUT(KEY, FMT, VAL)                                                              \
+  if (!E) {                                                                             \
+    sprintf(stmp, FMT, VAL);                                                            \
+    E |= nrrdKeyValueAdd(nout, KEY, stmp);                                              \
+  }
+  PUT(CHKP_KEY, "%s", CHKP_VERSION);
+  PUT("pointNum", "%u", pointNum);
+  PUT("pointLen", "%u", pointLen);
+  PUT("neighNum", "%u", neighNum);
+  PUT("verletNum", "%u", verletNum);
+  PUT("threadNum", "%u", pctx->threadNum);
+  PUT("infoTotalLen", "%u", pctx->infoTotalLen);
+  PUT("iter", "%u", pctx->iter);
+  PUT("idtagNext", "%u", pctx->idtagNext);
+  PUT("stuckNum", "%u", pctx->stuckNum);
+  PUT("verletStamp", "%u", pctx->verletStamp);
+  PUT("verletStale", "%d", pctx->verletStale);
+  PUT("energyIncreasePermit", "%.17g", pctx->sysParm.energyIncreasePermit);
+  PUT("timeRun", "%.17g", pctx->timeRun);
+  PUT("runEnergyLast", "%.17g", pctx->runEnergyLast);
+  PUT("runEnergyDecreaseAvg", "%.17g", pctx->runEnergyDecreaseAvg);
+  PUT("runFirstIter", "%u", pctx->runFirstIter);
+  strcpy(stmp, "");
+  cstr = stmp;
+  for (ci = pullCountUnknown; ci < pullCountLast; ci++) {
+    cstr += sprintf(cstr, "%s%u", ci ? " " : "", pctx->count[ci]);
+  }
+  if (!E) {
+    E |= nrrdKeyValueAdd(nout, "count", stmp);
+  }
+#undef PUT
+  if (E) {
+    biffMovef(PULL, NRRD, "%s: couldn't set key/value pairs", me);
+    airMopError(mop);
+    return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+** makes (in *headerP) the NRRD header with which _pullCheckpointWrite
+** writes nchkp
+*/
+static int /* Biff: 1 */
+_pullCheckpointHeader(char **headerP, const Nrrd *nchkp) {
+  static const char me[] = "_pullCheckpointHeader";
+  NrrdIoState *nio;
+  airArray *mop;
+
+  mop = airMopNew();
+  nio = nrrdIoStateNew();
+  if (!nio) {
+    biffAddf(PULL, "%s: couldn't allocate", me);
+    airMopError(mop);
+    return 1;
+  }
+  airMopAdd(mop, nio, (airMopper)nrrdIoStateNix, airMopAlways);
+  nio->format = nrrdFormatNRRD;
+  nio->encoding = nrrdEncodingRaw;
+  *headerP = airFree(*headerP);
+  if (nrrdStringWrite(headerP, nchkp, nio)) {
+    biffMovef(PULL, NRRD, "%s: couldn't make checkpoint header", me);
+    *headerP = airFree(*headerP);
+    airMopError(mop);
+    return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+** saves the checkpoint (with the header from _pullCheckpointHeader) to a
+** temporary file first, and then renames it, so that a crash during saving
+** doesn't clobber the previous checkpoint.  This is what checkpointThread
+** does, so it doesn't use biff: on error it returns non-zero and says what
+** went wrong in err
+*/
+static int
+_pullCheckpointWrite(char err[AIR_STRLEN_MED + 1], const char *header,
+                     const Nrrd *nchkp, const char *fname) {
+  char *tname;
+  FILE *file;
+  size_t size;
+  int bad;
+
+  tname = AIR_CALLOC(strlen(fname) + strlen(".tmp") + 1, char);
+  if (!tname) {
+    airStrcpy(err, AIR_STRLEN_MED + 1, "couldn't allocate temporary filename");
+    return 1;
+  }
+  sprintf(tname, "%s.tmp", fname);
+  if (!(file = fopen(tname, "wb"))) {
+    airStrcpy(err, AIR_STRLEN_MED + 1, "couldn't open temporary file for writing");
+    airFree(tname);
+    return 1;
+  }
+  size = nrrdElementNumber(nchkp) * nrrdElementSize(nchkp);
+  bad = (EOF == fputs(header, file) || EOF == fputs("\n", file)
+         || size != fwrite(nchkp->data, 1, size, file));
+  bad |= fclose(file);
+  if (bad) {
+    airStrcpy(err, AIR_STRLEN_MED + 1, "couldn't write temporary file");
+    remove(tname);
+    airFree(tname);
+    return 1;
+  }
+  if (rename(tname, fname)) {
+    /* some platforms won't rename over an existing file */
+    remove(fname);
+    if (rename(tname, fname)) {
+      airStrcpy(err, AIR_STRLEN_MED + 1, "couldn't rename temporary file");
+      airFree(tname);
+      return 1;
+    }
+  }
+  airFree(tname);
+  return 0;
+}
+
+static void *
+_pullCheckpointWorker(void *_pctx) {
+  pullContext *pctx;
+
+  pctx = AIR_CAST(pullContext *, _pctx);
+  pctx->checkpointErr = _pullCheckpointWrite(pctx->checkpointErrStr,
+                                             pctx->checkpointHeader,
+                                             pctx->ncheckpoint, pctx->checkpointName);
+  return _pctx;
+}
+
+int /* Biff: 1 */
+pullCheckpointNameSet(pullContext *pctx, const char *name) {
+  static const char me[] = "pullCheckpointNameSet";
+
+  if (!pctx) {
+    biffAddf(PULL, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (pctx->checkpointBusy) {
+    biffAddf(PULL, "%s: can't change name while writing a checkpoint", me);
+    return 1;
+  }
+  pctx->checkpointName = airFree(pctx->checkpointName);
+  if (airStrlen(name)) {
+    pctx->checkpointName = airStrdup(name);
+  }
+  return 0;
+}
+
+/*
+** waits for the checkpoint being written in the background (if any) to
+** finish, and reports (with biff) its errors
+*/
+int /* Biff: 1 */
+pullCheckpointWait(pullContext *pctx) {
+  static const char me[] = "pullCheckpointWait";
+  void *ret;
+
+  if (!pctx) {
+    biffAddf(PULL, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (!pctx->checkpointBusy) {
+    return 0;
+  }
+  if (airThreadJoin(pctx->checkpointThread, &ret)) {
+    pctx->checkpointBusy = AIR_FALSE;
+    biffAddf(PULL, "%s: couldn't join checkpoint writer thread", me);
+    return 1;
+  }
+  pctx->checkpointBusy = AIR_FALSE;
+  if (pctx->checkpointErr) {
+    biffAddf(PULL, "%s: problem writing checkpoint to \"%s\": %s", me,
+             pctx->checkpointName, pctx->checkpointErrStr);
+    pctx->checkpointErr = 0;
+    return 1;
+  }
+  return 0;
+}
+
+/*
+** called by pullRun() (between iterations) to start writing a checkpoint
+** to pctx->checkpointName in the background. Copying the state into
+** pctx->ncheckpoint (and making its header) is done here; the writing is
+** done by pctx->checkpointThread, while the iterations continue.
+*/
+int /* Biff: (private) 1 */
+_pullCheckpointStart(pullContext *pctx) {
+  static const char me[] = "_pullCheckpointStart";
+
+  /* we have only one ncheckpoint buffer */
+  if (pullCheckpointWait(pctx)) {
+    biffAddf(PULL, "%s: problem with previous checkpoint", me);
+    return 1;
+  }
+  if (!pctx->ncheckpoint) {
+    pctx->ncheckpoint = nrrdNew();
+  }
+  if (!pctx->checkpointThread) {
+    pctx->checkpointThread = airThreadNew();
+  }
+  if (!(pctx->ncheckpoint && pctx->checkpointThread)) {
+    biffAddf(PULL, "%s: couldn't allocate checkpoint buffer or thread", me);
+    return 1;
+  }
+  if (_pullCheckpointFill(pctx->ncheckpoint, pctx)
+      || _pullCheckpointHeader(&(pctx->checkpointHeader), pctx->ncheckpoint)) {
+    biffAddf(PULL, "%s: couldn't set up checkpoint for iter %u", me, pctx->iter);
+    return 1;
+  }
+  if (pctx->verbose) {
+    fprintf(stderr, "%s: iter %u: saving checkpoint to %s\n", me, pctx->iter,
+            pctx->checkpointName);
+  }
+  pctx->checkpointErr = 0;
+  pctx->checkpointBusy = AIR_TRUE;
+  if (airThreadStart(pctx->checkpointThread, _pullCheckpointWorker, pctx)) {
+    pctx->checkpointBusy = AIR_FALSE;
+    biffAddf(PULL, "%s: couldn't start checkpoint writer thread", me);
+    return 1;
+  }
+  return 0;
+}
+
+/*
+** saves a checkpoint right now (without any background thread), which
+** is useful between calls to pullRun
+*/
+int /* Biff: 1 */
+pullCheckpointSave(pullContext *pctx, const char *fname) {
+  static const char me[] = "pullCheckpointSave";
+  char err[AIR_STRLEN_MED + 1], *header;
+  Nrrd *nchkp;
+  airArray *mop;
+
+  if (!(pctx && fname)) {
+    biffAddf(PULL, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (!pctx->task) {
+    biffAddf(PULL, "%s: NULL task array, didn't call pullStart()?", me);
+    return 1;
+  }
+  if (pullCheckpointWait(pctx)) {
+    biffAddf(PULL, "%s: problem with previous checkpoint", me);
+    return 1;
+  }
+  mop = airMopNew();
+  nchkp = nrrdNew();
+  airMopAdd(mop, nchkp, (airMopper)nrrdNuke, airMopAlways);
+  header = NULL;
+  if (_pullCheckpointFill(nchkp, pctx) || _pullCheckpointHeader(&header, nchkp)) {
+    biffAddf(PULL, "%s: trouble", me);
+    airMopError(mop);
+    return 1;
+  }
+  airMopAdd(mop, header, airFree, airMopAlways);
+  if (_pullCheckpointWrite(err, header, nchkp, fname)) {
+    biffAddf(PULL, "%s: problem writing checkpoint to \"%s\": %s", me, fname, err);
+    airMopError(mop);
+    return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+static int /* Biff: 1 */
+_chkpUIntGet(unsigned int *val, const Nrrd *nchkp, const char *key) {
+  static const char me[] = "_chkpUIntGet";
+  char *str;
+  int bad;
+
+  str = nrrdKeyValueGet(nchkp, key);
+  bad = !(str && 1 == sscanf(str, "%u", val));
+  if (str && !nrrdStateKeyValueReturnInternalPointers) {
+    free(str);
+  }
+  if (bad) {
+    biffAddf(PULL, "%s: didn't get unsigned int \"%s\" from checkpoint", me, key);
+    return 1;
+  }
+  return 0;
+}
+
+static int /* Biff: 1 */
+_chkpDoubleGet(double *val, const Nrrd *nchkp, const char *key) {
+  static const char me[] = "_chkpDoubleGet";
+  char *str;
+  int bad;
+
+  str = nrrdKeyValueGet(nchkp, key);
+  bad = !(str && 1 == airSingleSscanf(str, "%lg", val));
+  if (str && !nrrdStateKeyValueReturnInternalPointers) {
+    free(str);
+  }
+  if (bad) {
+    biffAddf(PULL, "%s: didn't get double \"%s\" from checkpoint", me, key);
+    return 1;
+  }
+  return 0;
+}
+
+/*
+** to be called instead of pullStart(), on a context that has been set
+** up the same way as the one that was checkpointed (same volumes, info,
+** and parameters), which then starts with the points and the iteration
+** state from the checkpoint fname, so that pullRun() continues from
+** where the checkpointed run was. Results are the same as without the
+** interruption, if the number of threads is the same as before.
+*/
+int /* Biff: 1 */
+pullStartFromCheckpoint(pullContext *pctx, const char *fname) {
+  static const char me[] = "pullStartFromCheckpoint";
+  char *str;
+  unsigned int pointNum, pointLen, neighNum, verletNum, threadNum, infoTotalLen, iter,
+    idtagNext, stuckNum, verletStamp, runFirstIter, count[PULL_COUNT_MAX + 1], pi, ci,
+    ti, *nnum, *vnum, vs;
+  double eip, timeRun, runEnergyLast, runEnergyDecreaseAvg;
+  const double *dd, *nd, *vd;
+  pullPoint **point, key, *keyP, **hit;
+  size_t total;
+  airArray *mop;
+  Nrrd *nchkp;
+  int skips, E, verletStale;
+
+  if (!(pctx && fname)) {
+    biffAddf(PULL, "%s: got NULL pointer", me);
+    return 1;
+  }
+  mop = airMopNew();
+  nchkp = nrrdNew();
+  airMopAdd(mop, nchkp, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdLoad(nchkp, fname, NULL)) {
+    biffMovef(PULL, NRRD, "%s: couldn't read checkpoint \"%s\"", me, fname);
+    airMopError(mop);
+    return 1;
+  }
+  str = nrrdKeyValueGet(nchkp, CHKP_KEY);
+  E = !(str && !strcmp(str, CHKP_VERSION));
+  if (str && !nrrdStateKeyValueReturnInternalPointers) {
+    free(str);
+  }
+  if (E || !(nrrdTypeDouble == nchkp->type && 1 == nchkp->dim)) {
+    biffAddf(PULL, "%s: \"%s\" isn't a (version " CHKP_VERSION ") pull checkpoint", me,
+             fname);
+    airMopError(mop);
+    return 1;
+  }
+  E = 0;
+  if (!E) E |= _chkpUIntGet(&pointNum, nchkp, "pointNum");
+  if (!E) E |= _chkpUIntGet(&pointLen, nchkp, "pointLen");
+  if (!E) E |= _chkpUIntGet(&neighNum, nchkp, "neighNum");
+  if (!E) E |= _chkpUIntGet(&verletNum, nchkp, "verletNum");
+  if (!E) E |= _chkpUIntGet(&threadNum, nchkp, "threadNum");
+  if (!E) E |= _chkpUIntGet(&infoTotalLen, nchkp, "infoTotalLen");
+  if (!E) E |= _chkpUIntGet(&iter, nchkp, "iter");
+  if (!E) E |= _chkpUIntGet(&idtagNext, nchkp, "idtagNext");
+  if (!E) E |= _chkpUIntGet(&stuckNum, nchkp, "stuckNum");
+  if (!E) E |= _chkpUIntGet(&verletStamp, nchkp, "verletStamp");
+  if (!E) E |= _chkpUIntGet(&vs, nchkp, "verletStale");
+  if (!E) E |= _chkpDoubleGet(&eip, nchkp, "energyIncreasePermit");
+  if (!E) E |= _chkpDoubleGet(&timeRun, nchkp, "timeRun");
+  if (!E) E |= _chkpDoubleGet(&runEnergyLast, nchkp, "runEnergyLast");
+  if (!E) E |= _chkpDoubleGet(&runEnergyDecreaseAvg, nchkp, "runEnergyDecreaseAvg");
+  if (!E) E |= _chkpUIntGet(&runFirstIter, nchkp, "runFirstIter");
+  if (E) {
+    biffAddf(PULL, "%s: problem with \"%s\"", me, fname);
+    airMopError(mop);
+    return 1;
+  }
+  verletStale = !!vs;
+  str = nrrdKeyValueGet(nchkp, "count");
+  E = !(str && PULL_COUNT_MAX + 1 == airParseStrUI(count, str, " ", PULL_COUNT_MAX + 1));
+  if (str && !nrrdStateKeyValueReturnInternalPointers) {
+    free(str);
+  }
+  if (E) {
+    biffAddf(PULL, "%s: didn't get %u counts from \"%s\"", me, PULL_COUNT_MAX + 1,
+             fname);
+    airMopError(mop);
+    return 1;
+  }
+  total = (AIR_CAST(size_t, pointNum) * pointLen + neighNum + verletNum
+           + AIR_CAST(size_t, threadNum) * CHKP_RNG_LEN);
+  if (total != nchkp->axis[0].size) {
+    char stmp[2][AIR_STRLEN_SMALL + 1];
+    biffAddf(PULL, "%s: checkpoint has %s values, not the expected %s", me,
+             airSprintSize_t(stmp[0], nchkp->axis[0].size),
+             airSprintSize_t(stmp[1], total));
+    airMopError(mop);
+    return 1;
+  }
+
+  /* set up everything but the points */
+  skips = pctx->flag.startSkipsPoints;
+  pctx->flag.startSkipsPoints = AIR_TRUE;
+  E = pullStart(pctx);
+  pctx->flag.startSkipsPoints = skips;
+  if (E) {
+    biffAddf(PULL, "%s: trouble starting", me);
+    airMopError(mop);
+    return 1;
+  }
+  if (infoTotalLen != pctx->infoTotalLen || pointLen != CHKP_POINT_LEN + infoTotalLen) {
+    biffAddf(PULL,
+             "%s: checkpoint info length %u (point length %u) doesn't match "
+             "this context's %u; was it set up differently?",
+             me, infoTotalLen, pointLen, pctx->infoTotalLen);
+    airMopError(mop);
+    return 1;
+  }
+
+  /* create and bin the points, in their original order */
+  point = AIR_CALLOC(pointNum ? pointNum : 1, pullPoint *);
+  nnum = AIR_CALLOC(pointNum ? pointNum : 1, unsigned int);
+  vnum = AIR_CALLOC(pointNum ? pointNum : 1, unsigned int);
+  airMopAdd(mop, point, airFree, airMopAlways);
+  airMopAdd(mop, nnum, airFree, airMopAlways);
+  airMopAdd(mop, vnum, airFree, airMopAlways);
+  if (!(point && nnum && vnum)) {
+    biffAddf(PULL, "%s: couldn't allocate buffers for %u points", me, pointNum);
+    airMopError(mop);
+    return 1;
+  }
+  dd = AIR_CAST(const double *, nchkp->data);
+  for (pi = 0; pi < pointNum; pi++) {
+    if (!(point[pi] = pullPointNew(pctx))) {
+      biffAddf(PULL, "%s: couldn't create point %u", me, pi);
+      airMopError(mop);
+      return 1;
+    }
+    dd = _chkpPointGet(point[pi], nnum + pi, vnum + pi, dd, infoTotalLen);
+    if (pullBinsPointAdd(pctx, point[pi], NULL)) {
+      biffAddf(PULL, "%s: trouble binning point %u (id %u)", me, pi,
+               point[pi]->idtag);
+      pullPointNix(point[pi]);
+      airMopError(mop);
+      return 1;
+    }
+  }
+  /* recover neighbor lists, from idtags */
+  nd = dd;
+  vd = nd + neighNum;
+  dd = vd + verletNum;
+  qsort(point, pointNum, sizeof(pullPoint *), _chkpIdtagCompare);
+  keyP = &key;
+  /* (the points were sorted, but nnum and vnum are in the original
+     order, which is the order of the bins) */
+  pi = 0;
+  for (ci = 0; ci < pctx->binNum; ci++) {
+    pullBin *bin;
+    unsigned int bpi, li, ii;
+    bin = pctx->bin + ci;
+    for (bpi = 0; bpi < bin->pointNum; bpi++, pi++) {
+      pullPoint *pnt = bin->point[bpi];
+      for (li = 0; li < nnum[pi] + vnum[pi]; li++) {
+        key.idtag = AIR_UINT(li < nnum[pi] ? *nd++ : *vd++);
+        hit = AIR_CAST(pullPoint **, bsearch(&keyP, point, pointNum, sizeof(pullPoint *),
+                                             _chkpIdtagCompare));
+        if (!hit) {
+          biffAddf(PULL, "%s: point %u neighbor %u has unknown id %u", me, pnt->idtag,
+                   li, key.idtag);
+          airMopError(mop);
+          return 1;
+        }
+        if (li < nnum[pi]) {
+          ii = airArrayLenIncr(pnt->neighPointArr, 1);
+          pnt->neighPoint[ii] = *hit;
+        } else {
+          ii = airArrayLenIncr(pnt->verletPointArr, 1);
+          pnt->verletPoint[ii] = *hit;
+        }
+      }
+    }
+  }
+  if (pi != pointNum) {
+    biffAddf(PULL, "%s: binned %u points, but checkpoint had %u", me, pi, pointNum);
+    airMopError(mop);
+    return 1;
+  }
+
+  /* random number generators */
+  if (threadNum != pctx->threadNum) {
+    fprintf(stderr,
+            "%s: WARNING: checkpoint was from %u threads, now using %u; "
+            "results will differ from uninterrupted run\n",
+            me, threadNum, pctx->threadNum);
+  }
+  for (ti = 0; ti < threadNum; ti++) {
+    if (ti < pctx->threadNum) {
+      airRandMTState *rng = pctx->task[ti]->rng;
+      for (ci = 0; ci < AIR_RANDMT_N; ci++) {
+        rng->state[ci] = AIR_UINT(dd[ci]);
+      }
+      rng->pNext = rng->state + AIR_UINT(dd[AIR_RANDMT_N]);
+      rng->left = AIR_UINT(dd[AIR_RANDMT_N + 1]);
+    }
+    dd += CHKP_RNG_LEN;
+  }
+
+  /* and everything else */
+  pctx->iter = iter;
+  pctx->idtagNext = idtagNext;
+  pctx->stuckNum = stuckNum;
+  pctx->verletStamp = verletStamp;
+  pctx->verletStale = verletStale;
+  pctx->sysParm.energyIncreasePermit = eip;
+  pctx->timeRun = timeRun;
+  for (ci = 0; ci <= PULL_COUNT_MAX; ci++) {
+    pctx->count[ci] = count[ci];
+  }
+  pctx->runEnergyLast = runEnergyLast;
+  pctx->runEnergyDecreaseAvg = runEnergyDecreaseAvg;
+  pctx->runFirstIter = runFirstIter;
+  pctx->resumed = AIR_TRUE;
+  if (pctx->verbose) {
+    fprintf(stderr, "%s: resuming at iter %u with %u points\n", me, pctx->iter,
+            pointNum);
+  }
+  airMopOkay(mop);
+  return 0;
+}
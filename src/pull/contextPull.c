@@ -76,12 +76,21 @@ pullContextNew(void) {
   ELL_4V_SET(pctx->binsEdge, 0, 0, 0, 0);
   pctx->binNum = 0;
   pctx->binNextIdx = 0;
+  pctx->binOrder = NULL;
+  pctx->binWork = NULL;
+  pctx->binWorkNum = 0;
+  pctx->binWorkChunk = 1;
+  pctx->packPos = NULL;
+  pctx->packPosNum = 0;
+  pctx->verletStamp = 0;
+  pctx->verletStale = AIR_TRUE;
+  pctx->verletBroken = 0;
 
   pctx->tmpPointPerm = NULL;
   pctx->tmpPointPtr = NULL;
   pctx->tmpPointNum = 0;
+  pctx->stage = _pullStageUnknown;
 
-  /* pctx->binMutex setup my pullStart */
   pctx->task = NULL;
   pctx->iterBarrierA = NULL;
   pctx->iterBarrierB = NULL;
@@ -89,10 +98,23 @@ pullContextNew(void) {
   pctx->nhinter = nrrdNew();
 #endif
   pctx->logAdd = NULL;
+  pctx->checkpointName = NULL;
+  pctx->checkpointThread = NULL;
+  pctx->ncheckpoint = NULL;
+  pctx->checkpointHeader = NULL;
+  pctx->checkpointBusy = AIR_FALSE;
+  pctx->checkpointErr = 0;
+  pctx->checkpointErrStr[0] = '\0';
+  pctx->resumed = AIR_FALSE;
+  pctx->runEnergyLast = AIR_NAN;
+  pctx->runEnergyDecreaseAvg = AIR_NAN;
+  pctx->runFirstIter = 0;
 
   pctx->timeIteration = 0;
   pctx->timeRun = 0;
   pctx->energy = AIR_NAN;
+  pctx->verletDispMax = 0;
+  pctx->verletRebuilt = AIR_FALSE;
   pctx->addNum = 0;
   pctx->nixNum = 0;
   pctx->stuckNum = 0;
@@ -128,6 +150,18 @@ pullContextNix(pullContext *pctx) {
 #if PULL_HINTER
     nrrdNuke(pctx->nhinter);
 #endif
+    /* pullCheckpointWait() should have been called (by pullRun or
+       pullFinish), but just in case */
+    if (pctx->checkpointBusy) {
+      void *ret;
+      airThreadJoin(pctx->checkpointThread, &ret);
+    }
+    if (pctx->checkpointThread) {
+      airThreadNix(pctx->checkpointThread);
+    }
+    nrrdNuke(pctx->ncheckpoint);
+    airFree(pctx->checkpointHeader);
+    airFree(pctx->checkpointName);
     /* handled elsewhere: bin, task, iterBarrierA, iterBarrierB */
     airFree(pctx);
   }
@@ -169,6 +203,11 @@ _pullMiscParmCheck(pullContext *pctx) {
       return 1;
     }
   }
+  if (pctx->iterParm.checkpoint && !airStrlen(pctx->checkpointName)) {
+    biffAddf(PULL, "%s: want checkpoints every %u iters, but didn't set filename", me,
+             pctx->iterParm.checkpoint);
+    return 1;
+  }
   /* make sure that spatial repulsion is really repulsive at r=0 */
   pctx->energySpecR->energy->eval(&denr, 0.0000001, pctx->energySpecR->parm);
   if (!(denr < 0)) {
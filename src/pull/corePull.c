@@ -29,46 +29,81 @@ int _pullVerbose = 0;
    / ((AIR_ABS(ell) + AIR_ABS(enn)) ? (AIR_ABS(ell) + AIR_ABS(enn)) : 1))
 /*
 ** this is the core of the worker threads: as long as there are bins
-** left to process, get the next one, and process it
+** left to process, get the next chunk of them, and process them.
+** Returns a _pullStageErr* value; whatever pullBinProcess() said about
+** its trouble is still in biff
 */
-int /* Biff: (private) 1 */
+int /* Biff: (private) nope */
 _pullProcess(pullTask *task) {
   static const char me[] = "_pullProcess";
-  unsigned int binIdx;
-
-  while (task->pctx->binNextIdx < task->pctx->binNum) {
-    /* get the index of the next bin to process */
-    if (task->pctx->threadNum > 1) {
-      airThreadMutexLock(task->pctx->binMutex);
-    }
-    /* note that we entirely skip bins with no points */
-    do {
-      binIdx = task->pctx->binNextIdx;
-      if (task->pctx->binNextIdx < task->pctx->binNum) {
-        task->pctx->binNextIdx++;
+  pullContext *pctx;
+  unsigned int workIdx, workStop, binIdx;
+
+  pctx = task->pctx;
+  /* grab binWorkChunk bins at a time, until they're all spoken for; no
+     locking needed, and no empty bins to skip (see _pullBinsWorkSet) */
+  while ((workIdx = airThreadAtomicUIntAdd(&(pctx->binNextIdx), pctx->binWorkChunk))
+         < pctx->binWorkNum) {
+    workStop = AIR_MIN(workIdx + pctx->binWorkChunk, pctx->binWorkNum);
+    for (; workIdx < workStop; workIdx++) {
+      binIdx = pctx->binWork[workIdx];
+      if (pctx->verbose > 1) {
+        fprintf(stderr, "%s(%u): calling pullBinProcess(%u)\n", me, task->threadIdx,
+                binIdx);
+      }
+      if (pullBinProcess(task, binIdx)) {
+        task->stageErrIdx = binIdx;
+        return _pullStageErrProcess;
       }
-    } while (binIdx < task->pctx->binNum && 0 == task->pctx->bin[binIdx].pointNum);
-    if (task->pctx->threadNum > 1) {
-      airThreadMutexUnlock(task->pctx->binMutex);
-    }
-    if (binIdx == task->pctx->binNum) {
-      /* no more bins to process! */
-      break;
-    }
-    if (task->pctx->verbose > 1) {
-      fprintf(stderr, "%s(%u): calling pullBinProcess(%u)\n", me, task->threadIdx,
-              binIdx);
-    }
-    if (pullBinProcess(task, binIdx)) {
-      biffAddf(PULL, "%s(%u): had trouble on bin %u", me, task->threadIdx, binIdx);
-      return 1;
     }
   }
   return 0;
 }
 
-/* the main loop for each worker thread */
-void * /* Biff: (private) NULL */
+/*
+** does this task's part of whatever pctx->stage says to do, and records
+** in task->stageErr how that went
+*/
+static int /* Biff: nope */
+_pullStageDo(pullTask *task) {
+  int E;
+
+  task->stageErrIdx = 0;
+  switch (task->pctx->stage) {
+  case _pullStageProcess:
+    E = _pullProcess(task);
+    break;
+  case _pullStageNix:
+    E = _pullNixTheNixedStage(task);
+    break;
+  case _pullStageGather:
+    E = _pullBinsGather(task);
+    break;
+  case _pullStageCount:
+    E = _pullBinsCount(task);
+    break;
+  case _pullStageSize:
+    E = _pullBinsSize(task);
+    break;
+  case _pullStageScatter:
+    E = _pullBinsScatter(task);
+    break;
+  case _pullStageRestrict:
+    E = _pullBinsRestrict(task);
+    break;
+  default:
+    E = _pullStageErrStage;
+    break;
+  }
+  task->stageErr = E;
+  return E;
+}
+
+/*
+** the main loop for each worker thread; trouble is recorded in
+** task->stageErr, for the master thread to report in _pullStageRun
+*/
+void * /* Biff: (private) nope */
 _pullWorker(void *_task) {
   static const char me[] = "_pullWorker";
   void *ret;
@@ -93,11 +128,7 @@ _pullWorker(void *_task) {
     if (task->pctx->verbose > 1) {
       fprintf(stderr, "%s(%u): starting to process\n", me, task->threadIdx);
     }
-    if (_pullProcess(task)) {
-      /* HEY clearly not threadsafe to have errors . . . */
-      biffAddf(PULL, "%s: thread %u trouble", me, task->threadIdx);
-      task->pctx->finished = AIR_TRUE;
-      /* return NULL; (for biff auto-scan) */
+    if (_pullStageDo(task)) {
       ret = NULL;
     }
     if (task->pctx->verbose > 1) {
@@ -134,7 +165,6 @@ pullStart(pullContext *pctx) {
   }
 
   if (pctx->threadNum > 1) {
-    pctx->binMutex = airThreadMutexNew();
     pctx->iterBarrierA = airThreadBarrierNew(pctx->threadNum);
     pctx->iterBarrierB = airThreadBarrierNew(pctx->threadNum);
     /* start threads 1 and up running; they'll all hit iterBarrierA  */
@@ -145,7 +175,6 @@ pullStart(pullContext *pctx) {
       airThreadStart(pctx->task[tidx]->thread, _pullWorker, (void *)(pctx->task[tidx]));
     }
   } else {
-    pctx->binMutex = NULL;
     pctx->iterBarrierA = NULL;
     pctx->iterBarrierB = NULL;
   }
@@ -173,6 +202,10 @@ pullFinish(pullContext *pctx) {
     biffAddf(PULL, "%s: got NULL pointer", me);
     return 1;
   }
+  if (pullCheckpointWait(pctx)) {
+    biffAddf(PULL, "%s: trouble with last checkpoint", me);
+    return 1;
+  }
 
   pctx->finished = AIR_TRUE;
   if (pctx->threadNum > 1) {
@@ -187,7 +220,6 @@ pullFinish(pullContext *pctx) {
         airThreadJoin(pctx->task[tidx - 1]->thread, &(pctx->task[tidx - 1]->returnPtr));
       }
     }
-    pctx->binMutex = airThreadMutexNix(pctx->binMutex);
     pctx->iterBarrierA = airThreadBarrierNix(pctx->iterBarrierA);
     pctx->iterBarrierB = airThreadBarrierNix(pctx->iterBarrierB);
   }
@@ -201,6 +233,60 @@ pullFinish(pullContext *pctx) {
 
   return 0;
 }
+/*
+** has all the tasks do the work of the given stage (a _pullStage* enum
+** value): the master thread (which calls this) does its share while the
+** workers do theirs, and this returns after they're all done. This is
+** used for the point processing of each iteration, and for the parts of
+** the iteration finishers that can be done in parallel.
+*/
+int /* Biff: (private) 1 */
+_pullStageRun(pullContext *pctx, int stage) {
+  static const char me[] = "_pullStageRun";
+  unsigned int ti;
+  pullTask *task;
+
+  pctx->stage = stage;
+  /* the _pullWorker checks finished after iterBarrierA */
+  pctx->finished = AIR_FALSE;
+  /* initialize index of next bin to be doled out to threads */
+  pctx->binNextIdx = 0;
+  if (pctx->threadNum > 1) {
+    airThreadBarrierWait(pctx->iterBarrierA);
+  }
+  _pullStageDo(pctx->task[0]);
+  if (pctx->threadNum > 1) {
+    airThreadBarrierWait(pctx->iterBarrierB);
+  }
+  /* now that all the tasks are done, it's safe to use biff */
+  for (ti = 0; ti < pctx->threadNum; ti++) {
+    task = pctx->task[ti];
+    switch (task->stageErr) {
+    case _pullStageErrNone:
+      continue;
+    case _pullStageErrProcess:
+      biffAddf(PULL, "%s: task %u had trouble processing bin %u", me, ti,
+               task->stageErrIdx);
+      break;
+    case _pullStageErrLocate:
+      biffAddf(PULL, "%s: task %u couldn't locate point %u", me, ti, task->stageErrIdx);
+      break;
+    case _pullStageErrBinSet:
+      biffAddf(PULL, "%s: task %u couldn't set up bin %u", me, ti, task->stageErrIdx);
+      break;
+    case _pullStageErrBinAlloc:
+      biffAddf(PULL, "%s: task %u couldn't allocate points for bin %u", me, ti,
+               task->stageErrIdx);
+      break;
+    default:
+      biffAddf(PULL, "%s: task %u: stage %d unrecognized", me, ti, stage);
+      break;
+    }
+    return 1;
+  }
+  return 0;
+}
+
 /*
 ** _pullIterate
 **
@@ -212,7 +298,7 @@ int /* Biff: (private) 1 */
 _pullIterate(pullContext *pctx, int mode) {
   static const char me[] = "_pullIterate";
   double time0;
-  int myError, E;
+  int E;
   unsigned int ti;
 
   if (!pctx) {
@@ -258,30 +344,36 @@ _pullIterate(pullContext *pctx, int mode) {
   time0 = airTime();
   pctx->pointNum = pullPointNumber(pctx);
 
-  /* the _pullWorker checks finished after iterBarrierA */
-  pctx->finished = AIR_FALSE;
-
-  /* initialize index of next bin to be doled out to threads */
-  pctx->binNextIdx = 0;
-
-  if (pctx->threadNum > 1) {
-    airThreadBarrierWait(pctx->iterBarrierA);
+  if (pullProcessModeDescent == mode) {
+    _pullVerletCheck(pctx);
+    if (pctx->verbose && pctx->sysParm.neighborSkin) {
+      fprintf(stderr, "%s: max disp %g (half skin %g): %s Verlet lists (%u rebuilds)\n",
+              me, pctx->verletDispMax, pctx->sysParm.neighborSkin / 2,
+              pctx->verletRebuilt ? "rebuilding" : "re-using",
+              pctx->count[pullCountVerletRebuild]);
+    }
   }
-  myError = AIR_FALSE;
-  if (_pullProcess(pctx->task[0])) {
-    biffAddf(PULL, "%s: master thread trouble w/ iter %u", me, pctx->iter);
-    pctx->finished = AIR_TRUE;
-    myError = AIR_TRUE;
+  if (_pullBinsPack(pctx) || _pullBinsWorkSet(pctx)) {
+    biffAddf(PULL, "%s: trouble setting up bins for iter %u", me, pctx->iter);
+    return 1;
   }
-  if (pctx->threadNum > 1) {
-    airThreadBarrierWait(pctx->iterBarrierB);
+
+  if (_pullStageRun(pctx, _pullStageProcess)) {
+    biffAddf(PULL, "%s: trouble w/ iter %u", me, pctx->iter);
+    return 1;
   }
-  if (pctx->finished) {
-    if (!myError) {
-      /* we didn't set finished- one of the workers must have */
-      biffAddf(PULL, "%s: worker error on iter %u", me, pctx->iter);
+  if (pctx->flag.probeCache) {
+    /* the tasks count on their own, so as to not race on pctx->count */
+    for (ti = 0; ti < pctx->threadNum; ti++) {
+      pctx->count[pullCountProbeCacheHit] += pctx->task[ti]->probeCacheHit;
+      pctx->count[pullCountProbeCacheMiss] += pctx->task[ti]->probeCacheMiss;
+      pctx->task[ti]->probeCacheHit = pctx->task[ti]->probeCacheMiss = 0;
+    }
+    if (pctx->verbose) {
+      fprintf(stderr, "%s: probe cache: %u hits, %u misses so far\n", me,
+              pctx->count[pullCountProbeCacheHit],
+              pctx->count[pullCountProbeCacheMiss]);
     }
-    return 1;
   }
   if (pctx->verbose) {
     if (pctx->pointNum > _PULL_PROGRESS_POINT_NUM_MIN) {
@@ -289,6 +381,9 @@ _pullIterate(pullContext *pctx, int mode) {
     }
   }
 
+  /* the finishers may re-bin, add, or nix points */
+  _pullBinsUnpack(pctx);
+
   /* depending on mode, run one of the iteration finishers */
   E = 0;
   switch (mode) {
@@ -338,32 +433,60 @@ pullRun(pullContext *pctx) {
   Nrrd *npos;
   double time0, time1, enrLast, enrNew = AIR_NAN, enrDecrease = AIR_NAN,
                                 enrDecreaseAvg = AIR_NAN;
-  int converged;
+  int converged, resumed;
   unsigned firstIter;
 
   if (pctx->verbose) {
     fprintf(stderr, "%s: hello\n", me);
   }
   time0 = airTime();
-  firstIter = pctx->iter;
-  if (pctx->verbose) {
-    fprintf(stderr, "%s: doing priming iteration (iter now %u)\n", me, pctx->iter);
-  }
-  if (_pullIterate(pctx, pullProcessModeDescent)) {
-    biffAddf(PULL, "%s: trouble on priming iter %u", me, pctx->iter);
-    return 1;
-  }
-  pctx->iter += 1;
-  enrLast = enrNew = _pullEnergyTotal(pctx);
-  if (pctx->verbose) {
-    fprintf(stderr, "%s: starting system energy = %g\n", me, enrLast);
+  resumed = pctx->resumed;
+  if (resumed) {
+    /* pullStartFromCheckpoint() was called; the checkpoint was made at the
+       top of an iteration of the loop below, after the priming iteration,
+       and we pick up at exactly that point */
+    firstIter = pctx->runFirstIter;
+    enrLast = enrNew = pctx->runEnergyLast;
+    enrDecreaseAvg = pctx->runEnergyDecreaseAvg;
+    enrDecrease = 0;
+    pctx->resumed = AIR_FALSE;
+    if (pctx->verbose) {
+      fprintf(stderr, "%s: resuming at iter %u; system energy = %g\n", me, pctx->iter,
+              enrLast);
+    }
+  } else {
+    firstIter = pctx->iter;
+    if (pctx->verbose) {
+      fprintf(stderr, "%s: doing priming iteration (iter now %u)\n", me, pctx->iter);
+    }
+    if (_pullIterate(pctx, pullProcessModeDescent)) {
+      biffAddf(PULL, "%s: trouble on priming iter %u", me, pctx->iter);
+      return 1;
+    }
+    pctx->iter += 1;
+    enrLast = enrNew = _pullEnergyTotal(pctx);
+    if (pctx->verbose) {
+      fprintf(stderr, "%s: starting system energy = %g\n", me, enrLast);
+    }
+    enrDecrease = enrDecreaseAvg = 0;
   }
-  enrDecrease = enrDecreaseAvg = 0;
   converged = AIR_FALSE;
   while ((pctx->iterParm.min && pctx->iter <= pctx->iterParm.min)
          || ((!pctx->iterParm.max || pctx->iter < pctx->iterParm.max) && !converged)) {
     /* this per iteration init had been missing for a very long time */
     pctx->addNum = pctx->nixNum = 0;
+    if (pctx->iterParm.checkpoint && !(pctx->iter % pctx->iterParm.checkpoint)
+        && !resumed) {
+      /* the rest of the state of this function, needed to resume here */
+      pctx->runEnergyLast = enrLast;
+      pctx->runEnergyDecreaseAvg = enrDecreaseAvg;
+      pctx->runFirstIter = firstIter;
+      if (_pullCheckpointStart(pctx)) {
+        biffAddf(PULL, "%s: couldn't checkpoint iter %u", me, pctx->iter);
+        return 1;
+      }
+    }
+    resumed = AIR_FALSE;
     if (pctx->iterParm.snap && !(pctx->iter % pctx->iterParm.snap)) {
       npos = nrrdNew();
       sprintf(poutS, "snap.%06d.pos.nrrd", pctx->iter);
@@ -469,6 +592,10 @@ pullRun(pullContext *pctx) {
 
   pctx->timeRun += time1 - time0;
   pctx->energy = enrNew;
+  if (pullCheckpointWait(pctx)) {
+    biffAddf(PULL, "%s: trouble with last checkpoint", me);
+    return 1;
+  }
 
   /* we do one final neighbor-learn iteration, to set the fields
      (like stability) that are only learned then */
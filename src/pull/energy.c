@@ -148,7 +148,7 @@ _pullEnergyUnknownEval(double *denr, double dist, const double *parm) {
 }
 
 static const pullEnergy _pullEnergyUnknown = {"unknown", 0, _pullEnergyNoWell,
-                                              _pullEnergyUnknownEval};
+                                              _pullEnergyUnknownEval, NULL};
 const pullEnergy *const pullEnergyUnknown = &_pullEnergyUnknown;
 
 /* ----------------------------------------------------------------
@@ -161,12 +161,13 @@ const pullEnergy *const pullEnergyUnknown = &_pullEnergyUnknown;
 **
 ** learned: "1/2" is not 0.5 !!!!!
 */
+/* the energy at one distance, given the one parm; used by both eval and
+   evalBatch, as are the other energies' *One() functions below */
 static double
-_pullEnergySpringEval(double *denr, double dist, const double *parm) {
-  /* static const char me[] = "_pullEnergySpringEval"; */
-  double enr, xx, pull;
+_pullEnergySpringOne(double *denr, double dist, double pull) {
+  /* static const char me[] = "_pullEnergySpringOne"; */
+  double enr, xx;
 
-  pull = parm[0];
   /* support used to be [0,1 + pull], but now is scrunched to [0,1],
      so hack "dist" to match old parameterization */
   dist = AIR_AFFINE(0, dist, 1, 0, 1 + pull);
@@ -190,6 +191,25 @@ _pullEnergySpringEval(double *denr, double dist, const double *parm) {
   return enr;
 }
 
+static double
+_pullEnergySpringEval(double *denr, double dist, const double *parm) {
+
+  return _pullEnergySpringOne(denr, dist, parm[0]);
+}
+
+static void
+_pullEnergySpringEvalBatch(double *enr, double *denr, const double *dist,
+                           unsigned int num, const double *parm) {
+  double pull;
+  unsigned int ii;
+
+  pull = parm[0];
+  for (ii = 0; ii < num; ii++) {
+    enr[ii] = _pullEnergySpringOne(denr + ii, dist[ii], pull);
+  }
+  return;
+}
+
 /* currently unused
 static int
 _pullEnergySpringWell(const double *parm) {
@@ -200,7 +220,8 @@ _pullEnergySpringWell(const double *parm) {
 
 static const pullEnergy _pullEnergySpring = {SPRING, 1,
                                              _pullEnergyNoWell, /* HEY: is this true? */
-                                             _pullEnergySpringEval};
+                                             _pullEnergySpringEval,
+                                             _pullEnergySpringEvalBatch};
 const pullEnergy *const pullEnergySpring = &_pullEnergySpring;
 
 /* ----------------------------------------------------------------
@@ -215,15 +236,34 @@ const pullEnergy *const pullEnergySpring = &_pullEnergySpring;
   (x >= sig * cut ? 0 : -exp(-x * x / (2.0 * sig * sig)) * (x / (sig * sig)))
 
 static double
-_pullEnergyGaussEval(double *denr, double dist, const double *parm) {
+_pullEnergyGaussOne(double *denr, double dist) {
 
-  AIR_UNUSED(parm);
   *denr = _DGAUSS(dist, 0.25, 4);
   return _GAUSS(dist, 0.25, 4);
 }
 
+static double
+_pullEnergyGaussEval(double *denr, double dist, const double *parm) {
+
+  AIR_UNUSED(parm);
+  return _pullEnergyGaussOne(denr, dist);
+}
+
+static void
+_pullEnergyGaussEvalBatch(double *enr, double *denr, const double *dist,
+                          unsigned int num, const double *parm) {
+  unsigned int ii;
+
+  AIR_UNUSED(parm);
+  for (ii = 0; ii < num; ii++) {
+    enr[ii] = _pullEnergyGaussOne(denr + ii, dist[ii]);
+  }
+  return;
+}
+
 static const pullEnergy _pullEnergyGauss = {GAUSS, 0, _pullEnergyNoWell,
-                                            _pullEnergyGaussEval};
+                                            _pullEnergyGaussEval,
+                                            _pullEnergyGaussEvalBatch};
 const pullEnergy *const pullEnergyGauss = &_pullEnergyGauss;
 
 /* ----------------------------------------------------------------
@@ -253,10 +293,9 @@ const pullEnergy *const pullEnergyGauss = &_pullEnergyGauss;
   }
 
 static double
-_pullEnergyBsplnEval(double *denr, double dist, const double *parm) {
+_pullEnergyBsplnOne(double *denr, double dist) {
   double tmp, ret;
 
-  AIR_UNUSED(parm);
   dist *= 2;
   DBSPL(*denr, tmp, dist);
   *denr *= 2;
@@ -264,8 +303,28 @@ _pullEnergyBsplnEval(double *denr, double dist, const double *parm) {
   return ret;
 }
 
+static double
+_pullEnergyBsplnEval(double *denr, double dist, const double *parm) {
+
+  AIR_UNUSED(parm);
+  return _pullEnergyBsplnOne(denr, dist);
+}
+
+static void
+_pullEnergyBsplnEvalBatch(double *enr, double *denr, const double *dist,
+                          unsigned int num, const double *parm) {
+  unsigned int ii;
+
+  AIR_UNUSED(parm);
+  for (ii = 0; ii < num; ii++) {
+    enr[ii] = _pullEnergyBsplnOne(denr + ii, dist[ii]);
+  }
+  return;
+}
+
 static const pullEnergy _pullEnergyBspln = {BSPLN, 0, _pullEnergyNoWell,
-                                            _pullEnergyBsplnEval};
+                                            _pullEnergyBsplnEval,
+                                            _pullEnergyBsplnEvalBatch};
 const pullEnergy *const pullEnergyBspln = &_pullEnergyBspln;
 
 /* ----------------------------------------------------------------
@@ -275,20 +334,39 @@ const pullEnergy *const pullEnergyBspln = &_pullEnergyBspln;
 */
 
 static double
-_pullEnergyButterworthEval(double *denr, double x, const double *parm) {
-  int n;
-  double cut, denom, enr;
+_pullEnergyButterworthOne(double *denr, double x, int n, double cut) {
+  double denom, enr;
 
-  n = AIR_INT(parm[0]);
-  cut = parm[1];
   denom = 1 + airIntPow(x / cut, 2 * n);
   enr = 1 / denom;
   *denr = -2 * n * airIntPow(x / cut, 2 * n - 1) * enr * enr / cut;
   return enr;
 }
 
+static double
+_pullEnergyButterworthEval(double *denr, double x, const double *parm) {
+
+  return _pullEnergyButterworthOne(denr, x, AIR_INT(parm[0]), parm[1]);
+}
+
+static void
+_pullEnergyButterworthEvalBatch(double *enr, double *denr, const double *dist,
+                                unsigned int num, const double *parm) {
+  int n;
+  double cut;
+  unsigned int ii;
+
+  n = AIR_INT(parm[0]);
+  cut = parm[1];
+  for (ii = 0; ii < num; ii++) {
+    enr[ii] = _pullEnergyButterworthOne(denr + ii, dist[ii], n, cut);
+  }
+  return;
+}
+
 static const pullEnergy _pullEnergyButterworth = {BUTTER, 2, _pullEnergyNoWell,
-                                                  _pullEnergyButterworthEval};
+                                                  _pullEnergyButterworthEval,
+                                                  _pullEnergyButterworthEvalBatch};
 const pullEnergy *const pullEnergyButterworth = &_pullEnergyButterworth;
 
 /* ----------------------------------------------------------------
@@ -297,10 +375,9 @@ const pullEnergy *const pullEnergyButterworth = &_pullEnergyButterworth;
 ** 0 parms!
 */
 static double
-_pullEnergyCotanEval(double *denr, double dist, const double *parm) {
+_pullEnergyCotanOne(double *denr, double dist) {
   double pot, cc, enr;
 
-  AIR_UNUSED(parm);
   pot = AIR_PI / 2.0;
   cc = 1.0 / (FLT_MIN + tan(dist * pot));
   enr = dist > 1 ? 0 : cc + dist * pot - pot;
@@ -308,8 +385,28 @@ _pullEnergyCotanEval(double *denr, double dist, const double *parm) {
   return enr;
 }
 
+static double
+_pullEnergyCotanEval(double *denr, double dist, const double *parm) {
+
+  AIR_UNUSED(parm);
+  return _pullEnergyCotanOne(denr, dist);
+}
+
+static void
+_pullEnergyCotanEvalBatch(double *enr, double *denr, const double *dist,
+                          unsigned int num, const double *parm) {
+  unsigned int ii;
+
+  AIR_UNUSED(parm);
+  for (ii = 0; ii < num; ii++) {
+    enr[ii] = _pullEnergyCotanOne(denr + ii, dist[ii]);
+  }
+  return;
+}
+
 static const pullEnergy _pullEnergyCotan = {COTAN, 0, _pullEnergyNoWell,
-                                            _pullEnergyCotanEval};
+                                            _pullEnergyCotanEval,
+                                            _pullEnergyCotanEvalBatch};
 const pullEnergy *const pullEnergyCotan = &_pullEnergyCotan;
 
 /* ----------------------------------------------------------------
@@ -318,10 +415,9 @@ const pullEnergy *const pullEnergyCotan = &_pullEnergyCotan;
 ** 0 parms!
 */
 static double
-_pullEnergyCubicEval(double *denr, double dist, const double *parm) {
+_pullEnergyCubicOne(double *denr, double dist) {
   double omr, enr;
 
-  AIR_UNUSED(parm);
   if (dist <= 1) {
     omr = 1 - dist;
     enr = omr * omr * omr;
@@ -332,8 +428,28 @@ _pullEnergyCubicEval(double *denr, double dist, const double *parm) {
   return enr;
 }
 
+static double
+_pullEnergyCubicEval(double *denr, double dist, const double *parm) {
+
+  AIR_UNUSED(parm);
+  return _pullEnergyCubicOne(denr, dist);
+}
+
+static void
+_pullEnergyCubicEvalBatch(double *enr, double *denr, const double *dist,
+                          unsigned int num, const double *parm) {
+  unsigned int ii;
+
+  AIR_UNUSED(parm);
+  for (ii = 0; ii < num; ii++) {
+    enr[ii] = _pullEnergyCubicOne(denr + ii, dist[ii]);
+  }
+  return;
+}
+
 static const pullEnergy _pullEnergyCubic = {CUBIC, 0, _pullEnergyNoWell,
-                                            _pullEnergyCubicEval};
+                                            _pullEnergyCubicEval,
+                                            _pullEnergyCubicEvalBatch};
 const pullEnergy *const pullEnergyCubic = &_pullEnergyCubic;
 
 /* ----------------------------------------------------------------
@@ -342,10 +458,9 @@ const pullEnergy *const pullEnergyCubic = &_pullEnergyCubic;
 ** 0 parms!
 */
 static double
-_pullEnergyQuarticEval(double *denr, double dist, const double *parm) {
+_pullEnergyQuarticOne(double *denr, double dist) {
   double omr, enr;
 
-  AIR_UNUSED(parm);
   if (dist <= 1) {
     omr = 1 - dist;
     enr = 2.132 * omr * omr * omr * omr;
@@ -356,8 +471,28 @@ _pullEnergyQuarticEval(double *denr, double dist, const double *parm) {
   return enr;
 }
 
+static double
+_pullEnergyQuarticEval(double *denr, double dist, const double *parm) {
+
+  AIR_UNUSED(parm);
+  return _pullEnergyQuarticOne(denr, dist);
+}
+
+static void
+_pullEnergyQuarticEvalBatch(double *enr, double *denr, const double *dist,
+                            unsigned int num, const double *parm) {
+  unsigned int ii;
+
+  AIR_UNUSED(parm);
+  for (ii = 0; ii < num; ii++) {
+    enr[ii] = _pullEnergyQuarticOne(denr + ii, dist[ii]);
+  }
+  return;
+}
+
 static const pullEnergy _pullEnergyQuartic = {QUARTIC, 0, _pullEnergyNoWell,
-                                              _pullEnergyQuarticEval};
+                                              _pullEnergyQuarticEval,
+                                              _pullEnergyQuarticEvalBatch};
 const pullEnergy *const pullEnergyQuartic = &_pullEnergyQuartic;
 
 /* ----------------------------------------------------------------
@@ -365,17 +500,33 @@ const pullEnergy *const pullEnergyQuartic = &_pullEnergyQuartic;
 ** ----------------------------------------------------------------
 ** 2 parm: wellX, wellY
 */
+/* the coefficients, which depend only on parm, so that evalBatch can
+   compute them just once */
+static void
+_pullEnergyCubicWellCoef(double co[7], const double *parm) {
+  double wx, wy;
+
+  co[0] = wx = parm[0];
+  co[1] = wy = parm[1];
+  co[2] = (3 * (-1 + wy)) / wx;
+  co[3] = (-3 * (-1 + wy)) / (wx * wx);
+  co[4] = -(1 - wy) / (wx * wx * wx);
+  co[5] = (-3 * wy) / ((wx - 1) * (wx - 1));
+  co[6] = (-2 * wy) / ((wx - 1) * (wx - 1) * (wx - 1));
+  return;
+}
+
 static double
-_pullEnergyCubicWellEval(double *denr, double x, const double *parm) {
+_pullEnergyCubicWellPoly(double *denr, double x, const double co[7]) {
   double a, b, c, d, e, wx, wy, enr;
 
-  wx = parm[0];
-  wy = parm[1];
-  a = (3 * (-1 + wy)) / wx;
-  b = (-3 * (-1 + wy)) / (wx * wx);
-  c = -(1 - wy) / (wx * wx * wx);
-  d = (-3 * wy) / ((wx - 1) * (wx - 1));
-  e = (-2 * wy) / ((wx - 1) * (wx - 1) * (wx - 1));
+  wx = co[0];
+  wy = co[1];
+  a = co[2];
+  b = co[3];
+  c = co[4];
+  d = co[5];
+  e = co[6];
   if (x < wx) {
     enr = 1 + x * (a + x * (b + c * x));
     *denr = a + x * (2 * b + 3 * c * x);
@@ -391,6 +542,27 @@ _pullEnergyCubicWellEval(double *denr, double x, const double *parm) {
   return enr;
 }
 
+static double
+_pullEnergyCubicWellEval(double *denr, double x, const double *parm) {
+  double co[7];
+
+  _pullEnergyCubicWellCoef(co, parm);
+  return _pullEnergyCubicWellPoly(denr, x, co);
+}
+
+static void
+_pullEnergyCubicWellEvalBatch(double *enr, double *denr, const double *dist,
+                              unsigned int num, const double *parm) {
+  double co[7];
+  unsigned int ii;
+
+  _pullEnergyCubicWellCoef(co, parm);
+  for (ii = 0; ii < num; ii++) {
+    enr[ii] = _pullEnergyCubicWellPoly(denr + ii, dist[ii], co);
+  }
+  return;
+}
+
 static double
 _pullEnergyCubicWellWell(double *wx, const double *parm) {
 
@@ -399,7 +571,8 @@ _pullEnergyCubicWellWell(double *wx, const double *parm) {
 }
 
 static const pullEnergy _pullEnergyCubicWell = {CWELL, 2, _pullEnergyCubicWellWell,
-                                                _pullEnergyCubicWellEval};
+                                                _pullEnergyCubicWellEval,
+                                                _pullEnergyCubicWellEvalBatch};
 const pullEnergy *const pullEnergyCubicWell = &_pullEnergyCubicWell;
 
 /* ----------------------------------------------------------------
@@ -407,25 +580,39 @@ const pullEnergy *const pullEnergyCubicWell = &_pullEnergyCubicWell;
 ** ----------------------------------------------------------------
 ** 2 parm: wellX, wellY
 */
-static double
-_pullEnergyBetterCubicWellEval(double *denr, double x, const double *parm) {
-  double a, b, c, d, e, f, g, wx, wy, xmo, xmoo, xmooo, enr;
+/* as with cwell, the coefficients are computed apart from the polynomial,
+   so that evalBatch can compute them just once */
+static void
+_pullEnergyBetterCubicWellCoef(double co[8], const double *parm) {
+  double wx, wy, xmo, xmoo, xmooo;
 
-  /* HEY: it would be good if there was a place to store these
-     intermediate values, so that they don't need to be computed
-     for *every*single* inter-particle interaction */
-  wx = parm[0];
+  co[0] = wx = parm[0];
   wy = parm[1];
   xmo = wx - 1;
   xmoo = xmo * xmo;
   xmooo = xmoo * xmo;
-  a = -3 * (xmoo + (-1 + 2 * wx) * wy) / (xmoo * wx);
-  b = 3 * (xmoo + (-1 + wx * (2 + wx)) * wy) / (xmoo * wx * wx);
-  c = (-1 + wy - wx * (-2 + wx + 2 * (1 + wx) * wy)) / (xmoo * wx * wx * wx);
-  d = ((-1 + 3 * wx) * wy) / xmooo;
-  e = -(6 * wx * wy) / xmooo;
-  f = (3 * (1 + wx) * wy) / xmooo;
-  g = -(2 * wy) / xmooo;
+  co[1] = -3 * (xmoo + (-1 + 2 * wx) * wy) / (xmoo * wx);
+  co[2] = 3 * (xmoo + (-1 + wx * (2 + wx)) * wy) / (xmoo * wx * wx);
+  co[3] = (-1 + wy - wx * (-2 + wx + 2 * (1 + wx) * wy)) / (xmoo * wx * wx * wx);
+  co[4] = ((-1 + 3 * wx) * wy) / xmooo;
+  co[5] = -(6 * wx * wy) / xmooo;
+  co[6] = (3 * (1 + wx) * wy) / xmooo;
+  co[7] = -(2 * wy) / xmooo;
+  return;
+}
+
+static double
+_pullEnergyBetterCubicWellPoly(double *denr, double x, const double co[8]) {
+  double a, b, c, d, e, f, g, wx, enr;
+
+  wx = co[0];
+  a = co[1];
+  b = co[2];
+  c = co[3];
+  d = co[4];
+  e = co[5];
+  f = co[6];
+  g = co[7];
   if (x < wx) {
     enr = 1 + x * (a + x * (b + x * c));
     *denr = a + x * (2 * b + x * 3 * c);
@@ -439,6 +626,27 @@ _pullEnergyBetterCubicWellEval(double *denr, double x, const double *parm) {
   return enr;
 }
 
+static double
+_pullEnergyBetterCubicWellEval(double *denr, double x, const double *parm) {
+  double co[8];
+
+  _pullEnergyBetterCubicWellCoef(co, parm);
+  return _pullEnergyBetterCubicWellPoly(denr, x, co);
+}
+
+static void
+_pullEnergyBetterCubicWellEvalBatch(double *enr, double *denr, const double *dist,
+                                    unsigned int num, const double *parm) {
+  double co[8];
+  unsigned int ii;
+
+  _pullEnergyBetterCubicWellCoef(co, parm);
+  for (ii = 0; ii < num; ii++) {
+    enr[ii] = _pullEnergyBetterCubicWellPoly(denr + ii, dist[ii], co);
+  }
+  return;
+}
+
 static double
 _pullEnergyBetterCubicWellWell(double *wx, const double *parm) {
 
@@ -447,7 +655,8 @@ _pullEnergyBetterCubicWellWell(double *wx, const double *parm) {
 }
 
 static const pullEnergy _pullEnergyBetterCubicWell
-  = {BWELL, 2, _pullEnergyBetterCubicWellWell, _pullEnergyBetterCubicWellEval};
+  = {BWELL, 2, _pullEnergyBetterCubicWellWell, _pullEnergyBetterCubicWellEval,
+     _pullEnergyBetterCubicWellEvalBatch};
 const pullEnergy *const pullEnergyBetterCubicWell = &_pullEnergyBetterCubicWell;
 
 /* ----------------------------------------------------------------
@@ -455,18 +664,49 @@ const pullEnergy *const pullEnergyBetterCubicWell = &_pullEnergyBetterCubicWell;
 ** ----------------------------------------------------------------
 ** 1 parm: well radius
 */
-static double
-_pullEnergyQuarticWellEval(double *denr, double x, const double *parm) {
-  double a, b, c, d, w, enr;
+static void
+_pullEnergyQuarticWellCoef(double co[4], const double *parm) {
+  double w;
 
   w = parm[0];
-  a = (12 * w) / (1 - 4 * w);
-  b = 3 + 9 / (-1 + 4 * w);
-  c = (8 + 4 * w) / (1 - 4 * w);
-  d = 3 / (-1 + 4 * w);
-  enr = 1 + x * (a + x * (b + x * (c + x * d)));
+  co[0] = (12 * w) / (1 - 4 * w);
+  co[1] = 3 + 9 / (-1 + 4 * w);
+  co[2] = (8 + 4 * w) / (1 - 4 * w);
+  co[3] = 3 / (-1 + 4 * w);
+  return;
+}
+
+static double
+_pullEnergyQuarticWellPoly(double *denr, double x, const double co[4]) {
+  double a, b, c, d;
+
+  a = co[0];
+  b = co[1];
+  c = co[2];
+  d = co[3];
   *denr = a + x * (2 * b + x * (3 * c + x * 4 * d));
-  return enr;
+  return 1 + x * (a + x * (b + x * (c + x * d)));
+}
+
+static double
+_pullEnergyQuarticWellEval(double *denr, double x, const double *parm) {
+  double co[4];
+
+  _pullEnergyQuarticWellCoef(co, parm);
+  return _pullEnergyQuarticWellPoly(denr, x, co);
+}
+
+static void
+_pullEnergyQuarticWellEvalBatch(double *enr, double *denr, const double *dist,
+                                unsigned int num, const double *parm) {
+  double co[4];
+  unsigned int ii;
+
+  _pullEnergyQuarticWellCoef(co, parm);
+  for (ii = 0; ii < num; ii++) {
+    enr[ii] = _pullEnergyQuarticWellPoly(denr + ii, dist[ii], co);
+  }
+  return;
 }
 
 static double
@@ -479,7 +719,8 @@ _pullEnergyQuarticWellWell(double *wx, const double *parm) {
 }
 
 static const pullEnergy _pullEnergyQuarticWell = {QWELL, 1, _pullEnergyQuarticWellWell,
-                                                  _pullEnergyQuarticWellEval};
+                                                  _pullEnergyQuarticWellEval,
+                                                  _pullEnergyQuarticWellEvalBatch};
 const pullEnergy *const pullEnergyQuarticWell = &_pullEnergyQuarticWell;
 
 /* ----------------------------------------------------------------
@@ -487,23 +728,57 @@ const pullEnergy *const pullEnergyQuarticWell = &_pullEnergyQuarticWell;
 ** ----------------------------------------------------------------
 ** 1 parm: well radius
 */
-static double
-_pullEnergyHepticWellEval(double *denr, double x, const double *parm) {
-  double a, b, c, d, e, f, g, w, enr;
+static void
+_pullEnergyHepticWellCoef(double co[7], const double *parm) {
+  double w;
 
   w = parm[0];
-  a = (42 * w) / (1 - 7 * w);
-  b = 15 + 36 / (-1 + 7 * w);
-  c = -20 + 90 / (1 - 7 * w);
-  d = (105 * (1 + w)) / (-1 + 7 * w);
-  e = -((42 * (2 + w)) / (-1 + 7 * w));
-  f = (7 * (5 + w)) / (-1 + 7 * w);
-  g = 6 / (1 - 7 * w);
-  enr = 1 + x * (a + x * (b + x * (c + x * (d + x * (e + x * (f + g * x))))));
+  co[0] = (42 * w) / (1 - 7 * w);
+  co[1] = 15 + 36 / (-1 + 7 * w);
+  co[2] = -20 + 90 / (1 - 7 * w);
+  co[3] = (105 * (1 + w)) / (-1 + 7 * w);
+  co[4] = -((42 * (2 + w)) / (-1 + 7 * w));
+  co[5] = (7 * (5 + w)) / (-1 + 7 * w);
+  co[6] = 6 / (1 - 7 * w);
+  return;
+}
+
+static double
+_pullEnergyHepticWellPoly(double *denr, double x, const double co[7]) {
+  double a, b, c, d, e, f, g;
+
+  a = co[0];
+  b = co[1];
+  c = co[2];
+  d = co[3];
+  e = co[4];
+  f = co[5];
+  g = co[6];
   *denr
     = a
     + x * (2 * b + x * (3 * c + x * (4 * d + x * (5 * e + x * (6 * f + x * 7 * g)))));
-  return enr;
+  return 1 + x * (a + x * (b + x * (c + x * (d + x * (e + x * (f + g * x))))));
+}
+
+static double
+_pullEnergyHepticWellEval(double *denr, double x, const double *parm) {
+  double co[7];
+
+  _pullEnergyHepticWellCoef(co, parm);
+  return _pullEnergyHepticWellPoly(denr, x, co);
+}
+
+static void
+_pullEnergyHepticWellEvalBatch(double *enr, double *denr, const double *dist,
+                               unsigned int num, const double *parm) {
+  double co[7];
+  unsigned int ii;
+
+  _pullEnergyHepticWellCoef(co, parm);
+  for (ii = 0; ii < num; ii++) {
+    enr[ii] = _pullEnergyHepticWellPoly(denr + ii, dist[ii], co);
+  }
+  return;
 }
 
 static double
@@ -516,7 +791,8 @@ _pullEnergyHepticWellWell(double *wx, const double *parm) {
 }
 
 static const pullEnergy _pullEnergyHepticWell = {HWELL, 1, _pullEnergyHepticWellWell,
-                                                 _pullEnergyHepticWellEval};
+                                                 _pullEnergyHepticWellEval,
+                                                 _pullEnergyHepticWellEvalBatch};
 const pullEnergy *const pullEnergyHepticWell = &_pullEnergyHepticWell;
 
 /* ----------------------------------------------------------------
@@ -533,8 +809,22 @@ _pullEnergyZeroEval(double *denr, double dist, const double *parm) {
   return 0;
 }
 
+static void
+_pullEnergyZeroEvalBatch(double *enr, double *denr, const double *dist,
+                         unsigned int num, const double *parm) {
+  unsigned int ii;
+
+  AIR_UNUSED(dist);
+  AIR_UNUSED(parm);
+  for (ii = 0; ii < num; ii++) {
+    enr[ii] = denr[ii] = 0;
+  }
+  return;
+}
+
 static const pullEnergy _pullEnergyZero = {ZERO, 0, _pullEnergyNoWell,
-                                           _pullEnergyZeroEval};
+                                           _pullEnergyZeroEval,
+                                           _pullEnergyZeroEvalBatch};
 const pullEnergy *const pullEnergyZero = &_pullEnergyZero;
 
 /* ----------------------------------------------------------------
@@ -544,16 +834,38 @@ const pullEnergy *const pullEnergyZero = &_pullEnergyZero;
 ** parm[2] is a shift (probably negative) on the parabola
 */
 static double
-_pullEnergyBParabEval(double *denr, double x, const double *parm) {
+_pullEnergyBParabOne(double *denr, double x, int n, double cut, double shift) {
   double ben, dben;
 
-  ben = _pullEnergyButterworthEval(&dben, x, parm);
+  ben = _pullEnergyButterworthOne(&dben, x, n, cut);
   *denr = 2 * x * ben + x * x * dben;
-  return (x * x + parm[2]) * ben;
+  return (x * x + shift) * ben;
 }
 
-static const pullEnergy _pullEnergyButterworthParabola = {BPARAB, 3, _pullEnergyNoWell,
-                                                          _pullEnergyBParabEval};
+static double
+_pullEnergyBParabEval(double *denr, double x, const double *parm) {
+
+  return _pullEnergyBParabOne(denr, x, AIR_INT(parm[0]), parm[1], parm[2]);
+}
+
+static void
+_pullEnergyBParabEvalBatch(double *enr, double *denr, const double *dist,
+                           unsigned int num, const double *parm) {
+  int n;
+  double cut, shift;
+  unsigned int ii;
+
+  n = AIR_INT(parm[0]);
+  cut = parm[1];
+  shift = parm[2];
+  for (ii = 0; ii < num; ii++) {
+    enr[ii] = _pullEnergyBParabOne(denr + ii, dist[ii], n, cut, shift);
+  }
+  return;
+}
+
+static const pullEnergy _pullEnergyButterworthParabola
+  = {BPARAB, 3, _pullEnergyNoWell, _pullEnergyBParabEval, _pullEnergyBParabEvalBatch};
 const pullEnergy *const pullEnergyButterworthParabola = &_pullEnergyButterworthParabola;
 
 /* ----------------------------------------------------------------
@@ -623,6 +935,28 @@ pullEnergySpecNix(pullEnergySpec *ensp) {
   return NULL;
 }
 
+/*
+******** pullEnergySpecEvalBatch
+**
+** evaluates the energy (and its derivative) of ensp at num distances,
+** using the energy's evalBatch if it has one, and otherwise calling
+** eval() num times
+*/
+void
+pullEnergySpecEvalBatch(double *enr, double *denr, const double *dist, unsigned int num,
+                        const pullEnergySpec *ensp) {
+  unsigned int ii;
+
+  if (ensp->energy->evalBatch) {
+    ensp->energy->evalBatch(enr, denr, dist, num, ensp->parm);
+  } else {
+    for (ii = 0; ii < num; ii++) {
+      enr[ii] = ensp->energy->eval(denr + ii, dist[ii], ensp->parm);
+    }
+  }
+  return;
+}
+
 int /* Biff: 1 */
 pullEnergySpecParse(pullEnergySpec *ensp, const char *_str) {
   static const char me[] = "pullEnergySpecParse";
@@ -292,7 +292,10 @@ _pullCountStr[] = {
   "pts stuck",
   "pts",
   "CC",
-  "iter"
+  "iter",
+  "verlet rebuild",
+  "probe cache hit",
+  "probe cache miss"
 };
 
 static const airEnum
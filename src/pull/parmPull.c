@@ -36,6 +36,7 @@ _pullIterParmInit(pullIterParm *iterParm) {
   iterParm->callback = 1;
   iterParm->snap = 0;
   iterParm->energyIncreasePermitHalfLife = 0;
+  iterParm->checkpoint = 0;
   return;
 }
 
@@ -51,7 +52,9 @@ _pullSysParmInit(pullSysParm *sysParm) {
   sysParm->radiusScale = 1;
   sysParm->binWidthSpace = 1.001; /* supersititious */
   sysParm->neighborTrueProb = 1.0;
+  sysParm->neighborSkin = 0.0;
   sysParm->probeProb = 1.0;
+  sysParm->probeCacheQuantum = 0.0;
   sysParm->stepInitial = 1;
   sysParm->opporStepScale = 1.0;
   sysParm->backStepScale = 0.5;
@@ -85,6 +88,8 @@ _pullFlagInit(pullFlag *flag) {
   flag->scaleIsTau = AIR_FALSE;
   flag->startSkipsPoints = AIR_FALSE; /* must be false by default */
   flag->zeroZ = AIR_FALSE;
+  flag->binPack = AIR_FALSE;
+  flag->probeCache = AIR_FALSE;
   return;
 }
 
@@ -145,6 +150,9 @@ pullIterParmSet(pullContext *pctx, int which, unsigned int pval) {
       pctx->eipScale = 1;
     }
     break;
+  case pullIterParmCheckpoint:
+    pctx->iterParm.checkpoint = pval;
+    break;
   default:
     biffAddf(PULL, "%s: sorry, iter parm %d valid but not handled?", me, which);
     return 1;
@@ -173,7 +181,9 @@ _pullSysParmCheck(pullSysParm *sysParm) {
   CHECK(radiusScale, 0.000001, 80.0);
   CHECK(binWidthSpace, 1.0, 15.0);
   CHECK(neighborTrueProb, 0.02, 1.0);
+  CHECK(neighborSkin, 0.0, 1.0);
   CHECK(probeProb, 0.02, 1.0);
+  CHECK(probeCacheQuantum, 0.0, 1.0);
   if (!(AIR_EXISTS(sysParm->stepInitial) && sysParm->stepInitial > 0)) {
     biffAddf(PULL, "%s: sysParm->stepInitial %g not > 0", me, sysParm->stepInitial);
     return 1;
@@ -229,9 +239,15 @@ pullSysParmSet(pullContext *pctx, int which, double pval) {
   case pullSysParmNeighborTrueProb:
     pctx->sysParm.neighborTrueProb = pval;
     break;
+  case pullSysParmNeighborSkin:
+    pctx->sysParm.neighborSkin = pval;
+    break;
   case pullSysParmProbeProb:
     pctx->sysParm.probeProb = pval;
     break;
+  case pullSysParmProbeCacheQuantum:
+    pctx->sysParm.probeCacheQuantum = pval;
+    break;
   case pullSysParmOpporStepScale:
     pctx->sysParm.opporStepScale = pval;
     break;
@@ -329,6 +345,12 @@ pullFlagSet(pullContext *pctx, int which, int flag) {
   case pullFlagZeroZ:
     pctx->flag.zeroZ = flag;
     break;
+  case pullFlagBinPack:
+    pctx->flag.binPack = flag;
+    break;
+  case pullFlagProbeCache:
+    pctx->flag.probeCache = flag;
+    break;
   default:
     biffAddf(PULL, "%s: sorry, flag %d valid but not handled?", me, which);
     return 1;
@@ -63,6 +63,13 @@ pullPointNew(pullContext *pctx) {
   pnt->neighPointArr = airArrayNew(pppu.v, &(pnt->neighPointNum), sizeof(pullPoint *),
                                    PULL_POINT_NEIGH_INCR);
   pnt->neighPointArr->noReallocWhenSmaller = AIR_TRUE;
+  pnt->verletPoint = NULL;
+  pnt->verletPointNum = 0;
+  pppu.points = &(pnt->verletPoint);
+  pnt->verletPointArr = airArrayNew(pppu.v, &(pnt->verletPointNum),
+                                    sizeof(pullPoint *), PULL_POINT_NEIGH_INCR);
+  pnt->verletPointArr->noReallocWhenSmaller = AIR_TRUE;
+  pnt->verletStamp = 0;
   pnt->neighDistMean = 0;
   ELL_10V_ZERO_SET(pnt->neighCovar);
   pnt->stability = 0.0;
@@ -79,6 +86,7 @@ pullPointNew(pullContext *pctx) {
 #endif
   pnt->status = 0;
   ELL_4V_SET(pnt->pos, AIR_NAN, AIR_NAN, AIR_NAN, AIR_NAN);
+  ELL_4V_SET(pnt->verletPos, AIR_NAN, AIR_NAN, AIR_NAN, AIR_NAN);
   pnt->energy = AIR_NAN;
   ELL_4V_SET(pnt->force, AIR_NAN, AIR_NAN, AIR_NAN, AIR_NAN);
   pnt->stepEnergy = pctx->sysParm.stepInitial;
@@ -93,6 +101,7 @@ pullPoint * /* Biff: nope */
 pullPointNix(pullPoint *pnt) {
 
   pnt->neighPointArr = airArrayNuke(pnt->neighPointArr);
+  pnt->verletPointArr = airArrayNuke(pnt->verletPointArr);
 #if PULL_PHIST
   pnt->phistArr = airArrayNuke(pnt->phistArr);
 #endif
@@ -354,11 +363,44 @@ pullPointScalar(const pullContext *pctx, const pullPoint *point, int sclInfo,
   return scl;
 }
 
+/*
+** _pullProbeCacheFind: with pullFlagProbeCache, finds the entry in the
+** task's probe cache that is for point->pos, and sets key[] to what the
+** entry must hold in order to be valid for this position. An entry is:
+** [0]: generation (0 if never used), [1..4]: key, [5]: edge, [6..]: the
+** infos as learned by pullProbe.  The cache is direct-mapped: the only
+** entry that could be valid is the one indexed by a hash of the key
+*/
+static double *
+_pullProbeCacheFind(pullTask *task, const pullPoint *point, double key[4]) {
+  const pullContext *pctx;
+  double qnt, vsize;
+  airDouble dbl;
+  airULLong hash;
+  unsigned int ci;
+
+  pctx = task->pctx;
+  qnt = pctx->sysParm.probeCacheQuantum;
+  hash = 0;
+  for (ci = 0; ci < 4; ci++) {
+    vsize = (ci < 3 ? pctx->voxelSizeSpace : pctx->voxelSizeScale);
+    key[ci] = (qnt && vsize > 0 ? floor(point->pos[ci] / (qnt * vsize) + 0.5)
+                                : point->pos[ci]);
+    /* FNV-1a-style mixing of the bits of the key */
+    dbl.d = key[ci];
+    hash = (hash ^ dbl.i) * AIR_ULLONG(0x100000001b3);
+    hash ^= hash >> 29;
+  }
+  return (task->probeCache
+          + (hash & (_PULL_PROBE_CACHE_SIZE - 1)) * (6 + pctx->infoTotalLen));
+}
+
 int /* Biff: 1 */
 pullProbe(pullTask *task, pullPoint *point) {
   static const char me[] = "pullProbe";
   unsigned int ii, gret = 0;
-  int edge;
+  int edge, hit;
+  double *centry, ckey[4], cgen;
   /*
   fprintf(stderr, "!%s: task->probeSeedPreThreshOnly = %d\n", me,
           task->probeSeedPreThreshOnly);
@@ -408,11 +450,31 @@ pullProbe(pullTask *task, pullPoint *point) {
   }
   edge = AIR_FALSE;
   task->pctx->count[pullCountProbe] += 1;
+  if (task->probeCache && !task->probeSeedPreThreshOnly) {
+    /* entries made during the first iteration (#0) are not valid after it,
+       since then the seedOnly volumes are no longer probed */
+    cgen = task->pctx->iter ? 2 : 1;
+    centry = _pullProbeCacheFind(task, point, ckey);
+    hit = (cgen == centry[0] && ELL_4V_EQUAL(ckey, centry + 1));
+    if (hit) {
+      task->probeCacheHit += 1;
+    } else {
+      task->probeCacheMiss += 1;
+    }
+  } else {
+    centry = NULL;
+    cgen = 0;
+    hit = AIR_FALSE;
+  }
+  if (hit) {
+    /* the cached infos and edge-ness are used instead of probing */
+    edge = !!centry[5];
+  }
   /*
   fprintf(stderr, "%s(%u,%u): B volNum = %u\n", me, task->pctx->iter,
   point->idtag,task->pctx->volNum);
   */
-  for (ii = 0; ii < task->pctx->volNum; ii++) {
+  for (ii = 0; !hit && ii < task->pctx->volNum; ii++) {
     pullVolume *vol;
     vol = task->vol[ii];
     if (task->probeSeedPreThreshOnly && !(vol->forSeedPreThresh)) {
@@ -488,7 +550,8 @@ pullProbe(pullTask *task, pullPoint *point) {
       alen = _pullInfoLen[ii];
       aidx = task->pctx->infoIdx[ii];
       if (pullSourceGage == ispec->source) {
-        _pullInfoCopy[alen](point->info + aidx, task->ans[ii]);
+        _pullInfoCopy[alen](point->info + aidx,
+                            hit ? centry + 6 + aidx : task->ans[ii]);
         /* if (289 == task->pctx->iter) {
           fprintf(stderr, "!%s(%u): copied info %u (%s) len %u\n", me, point->idtag,
                   ii, airEnumStr(pullInfo, ii), alen);
@@ -578,6 +641,12 @@ pullProbe(pullTask *task, pullPoint *point) {
       }
     }
   }
+  if (centry && !hit) {
+    centry[0] = cgen;
+    ELL_4V_COPY(centry + 1, ckey);
+    centry[5] = edge;
+    memcpy(centry + 6, point->info, task->pctx->infoTotalLen * sizeof(double));
+  }
 
 #if 0
   if (logStarted && !logDone) {
@@ -404,87 +404,124 @@ _pullIterFinishAdding(pullContext *pctx) {
   static const char me[] = "_pullIterFinishAdding";
   unsigned int taskIdx;
 
+  /* all the tasks bin all the new points, and with
+     flag.restrictiveAddToBins, turn away those too close to others */
+  if (_pullBinsAddAll(pctx)) {
+    biffAddf(PULL, "%s: trouble binning new points", me);
+    return 1;
+  }
   pctx->addNum = 0;
   for (taskIdx = 0; taskIdx < pctx->threadNum; taskIdx++) {
     pullTask *task;
     task = pctx->task[taskIdx];
     if (task->addPointNum) {
       unsigned int pointIdx;
-      int added;
       for (pointIdx = 0; pointIdx < task->addPointNum; pointIdx++) {
         pullPoint *point;
         pullBin *bin;
+        unsigned int npi, xpi;
         point = task->addPoint[pointIdx];
-        point->status &= ~PULL_STATUS_NEWBIE_BIT;
-        if (pullBinsPointMaybeAdd(pctx, point, &bin, &added)) {
-          biffAddf(PULL, "%s: trouble binning new point %u", me, point->idtag);
-          return 1;
-        }
-        if (added) {
+        if (!(point->status & PULL_STATUS_NIXME_BIT)) {
           pctx->addNum++;
-        } else {
-          unsigned int npi, xpi;
-          if (pctx->verbose) {
-            printf("%s: decided NOT to add new point %u\n", me, point->idtag);
-          }
-          /* HEY: copied from above */
-          /* ugh, have to signal to neigs that its no longer their neighbor */
-          task->processMode = pullProcessModeNeighLearn;
-          point->status |= PULL_STATUS_NIXME_BIT;
-          for (npi = 0; npi < point->neighPointNum; npi++) {
-            _pullEnergyFromPoints(task, bin, point->neighPoint[npi], NULL);
-          }
-          task->processMode = pullProcessModeAdding;
-          /* can't do immediate nix for reasons GLK doesn't quite understand */
-          xpi = airArrayLenIncr(task->nixPointArr, 1);
-          task->nixPoint[xpi] = point;
+          continue;
         }
+        if (pctx->verbose) {
+          printf("%s: decided NOT to add new point %u\n", me, point->idtag);
+        }
+        /* HEY: copied from above */
+        /* ugh, have to signal to neigs that its no longer their neighbor */
+        bin = _pullBinLocate(pctx, point->pos);
+        task->processMode = pullProcessModeNeighLearn;
+        for (npi = 0; npi < point->neighPointNum; npi++) {
+          _pullEnergyFromPoints(task, bin, point->neighPoint[npi], NULL);
+        }
+        task->processMode = pullProcessModeAdding;
+        /* can't do immediate nix for reasons GLK doesn't quite understand */
+        xpi = airArrayLenIncr(task->nixPointArr, 1);
+        task->nixPoint[xpi] = point;
       }
       airArrayLenSet(task->addPointArr, 0);
     }
   }
+  if (pctx->addNum) {
+    pctx->verletStale = AIR_TRUE;
+  }
   if (pctx->verbose && pctx->addNum) {
     printf("%s: ADDED %u\n", me, pctx->addNum);
   }
   return 0;
 }
 
-void
-_pullNixTheNixed(pullContext *pctx) {
-  unsigned int binIdx;
+/*
+** this task's part of _pullNixTheNixed: removing and nixing the points
+** with the NIXME bit from the bins that it gets; bins are independent,
+** so this doesn't need any locking
+*/
+int /* Biff: (private) nope */
+_pullNixTheNixedStage(pullTask *task) {
+  pullContext *pctx;
+  unsigned int workIdx, workStop, binIdx;
 
-  pctx->nixNum = 0;
-  for (binIdx = 0; binIdx < pctx->binNum; binIdx++) {
-    pullBin *bin;
-    unsigned int pointIdx;
-    bin = pctx->bin + binIdx;
-    pointIdx = 0;
-    while (pointIdx < bin->pointNum) {
-      pullPoint *point;
-      point = bin->point[pointIdx];
-      if (pctx->flag.nixAtVolumeEdgeSpace && (point->status & PULL_STATUS_EDGE_BIT)) {
-        point->status |= PULL_STATUS_NIXME_BIT;
-      }
-      if (point->status & PULL_STATUS_NIXME_BIT) {
-        pullPointNix(point);
-        /* copy last point pointer to this slot */
-        bin->point[pointIdx] = bin->point[bin->pointNum - 1];
-        airArrayLenIncr(bin->pointArr, -1); /* will decrement bin->pointNum */
-        pctx->nixNum++;
-      } else {
-        pointIdx++;
+  pctx = task->pctx;
+  task->nixNum = 0;
+  while ((workIdx = airThreadAtomicUIntAdd(&(pctx->binNextIdx), _PULL_STAGE_BIN_CHUNK))
+         < pctx->binNum) {
+    workStop = AIR_MIN(workIdx + _PULL_STAGE_BIN_CHUNK, pctx->binNum);
+    for (binIdx = workIdx; binIdx < workStop; binIdx++) {
+      pullBin *bin;
+      unsigned int pointIdx;
+      bin = pctx->bin + binIdx;
+      pointIdx = 0;
+      while (pointIdx < bin->pointNum) {
+        pullPoint *point;
+        point = bin->point[pointIdx];
+        if (pctx->flag.nixAtVolumeEdgeSpace && (point->status & PULL_STATUS_EDGE_BIT)) {
+          point->status |= PULL_STATUS_NIXME_BIT;
+        }
+        if (point->status & PULL_STATUS_NIXME_BIT) {
+          pullPointNix(point);
+          /* copy last point pointer to this slot */
+          bin->point[pointIdx] = bin->point[bin->pointNum - 1];
+          airArrayLenIncr(bin->pointArr, -1); /* will decrement bin->pointNum */
+          task->nixNum++;
+        } else {
+          pointIdx++;
+        }
       }
     }
   }
-  return;
+  return 0;
 }
 
-int /* Biff: (private) nope */
+int /* Biff: (private) 1 */
+_pullNixTheNixed(pullContext *pctx) {
+  static const char me[] = "_pullNixTheNixed";
+  unsigned int taskIdx;
+
+  if (_pullStageRun(pctx, _pullStageNix)) {
+    biffAddf(PULL, "%s: trouble", me);
+    return 1;
+  }
+  pctx->nixNum = 0;
+  for (taskIdx = 0; taskIdx < pctx->threadNum; taskIdx++) {
+    pctx->nixNum += pctx->task[taskIdx]->nixNum;
+  }
+  if (pctx->nixNum) {
+    /* Verlet lists may have pointers to the nixed points */
+    pctx->verletStale = AIR_TRUE;
+  }
+  return 0;
+}
+
+int /* Biff: (private) 1 */
 _pullIterFinishNixing(pullContext *pctx) {
   static const char me[] = "_pullIterFinishNixing";
   unsigned int taskIdx;
 
-  _pullNixTheNixed(pctx);
+  if (_pullNixTheNixed(pctx)) {
+    biffAddf(PULL, "%s: trouble", me);
+    return 1;
+  }
   /* finish nixing the things that we decided not to add */
   for (taskIdx = 0; taskIdx < pctx->threadNum; taskIdx++) {
     pullTask *task;
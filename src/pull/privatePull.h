@@ -33,6 +33,13 @@ extern "C" {
 /* size/allocation increment for per-bin airArray */
 #define _PULL_BIN_INCR 32
 
+/* # neighbors gathered at a time by _pullEnergyFromPoints, for evaluating
+   energies in batches (see pullEnergy->evalBatch) */
+#define _PULL_ENERGY_BATCH 64
+
+/* # entries (a power of 2) in each task's probe cache (pullFlagProbeCache) */
+#define _PULL_PROBE_CACHE_SIZE 4096
+
 /* size/allocation increment for pullTrace airArray in pullTraceMulti */
 #define _PULL_TRACE_MULTI_INCR 1024
 
@@ -94,6 +101,42 @@ extern "C" {
 /* resolution of histogram of (r,s) coords of interactions ("hinter") */
 #define _PULL_HINTER_SIZE 601
 
+/* # bins a task takes per fetch, in the bin-wise stages of the iteration
+   finishers (which do much less work per bin than an iteration does) */
+#define _PULL_STAGE_BIN_CHUNK 256
+
+/*
+** the kinds of work (pctx->stage) that the tasks do between iterBarrierA
+** and iterBarrierB: the point processing of an iteration, or one of the
+** steps of the iteration finishers that are done in parallel
+*/
+enum {
+  _pullStageUnknown,  /* 0 */
+  _pullStageProcess,  /* 1: pullBinProcess() on bins of binWork */
+  _pullStageNix,      /* 2: remove and nix the NIXME points, bin by bin */
+  _pullStageGather,   /* 3: copy points from a range of bins to tmpPointPtr */
+  _pullStageCount,    /* 4: count how many of a task's points go in each bin */
+  _pullStageSize,     /* 5: make room in each bin for its new points */
+  _pullStageScatter,  /* 6: put a task's points in their bins */
+  _pullStageRestrict, /* 7: turn away new points too close to other new ones */
+  _pullStageLast
+};
+
+/*
+** how a task can fail to do its stage (pullTask->stageErr); the stages
+** are done by the worker threads, so they don't use biff, and
+** _pullStageRun() makes the biff error from this and task->stageErrIdx
+*/
+enum {
+  _pullStageErrNone,     /* 0: no problem */
+  _pullStageErrProcess,  /* 1: pullBinProcess() failed on bin stageErrIdx */
+  _pullStageErrLocate,   /* 2: point idtag stageErrIdx has no position */
+  _pullStageErrBinSet,   /* 3: couldn't set up bin stageErrIdx */
+  _pullStageErrBinAlloc, /* 4: couldn't allocate points for bin stageErrIdx */
+  _pullStageErrStage,    /* 5: pctx->stage not recognized */
+  _pullStageErrLast
+};
+
 /* initPull.c */
 extern void _pullInitParmInit(pullInitParm *initParm);
 extern int _pullInitParmCheck(pullInitParm *iparm);
@@ -126,6 +169,8 @@ extern int _pullTaskSetup(pullContext *pctx);
 extern void _pullTaskFinish(pullContext *pctx);
 
 /* actionPull.c */
+extern double _pullPosDistSqrd(pullContext *pctx, const double AA[4],
+                               const double BB[4]);
 extern double _pullDistLimit(pullTask *task, pullPoint *point);
 extern double _pullEnergyFromPoints(pullTask *task, pullBin *bin, pullPoint *point,
                                     /* output */
@@ -167,7 +212,8 @@ extern int _pullPointProcessNixing(pullTask *task, pullBin *bin, pullPoint *poin
 extern int _pullIterFinishNeighLearn(pullContext *pctx);
 extern int _pullIterFinishAdding(pullContext *pctx);
 extern int _pullIterFinishNixing(pullContext *pctx);
-extern void _pullNixTheNixed(pullContext *pctx);
+extern int _pullNixTheNixedStage(pullTask *task);
+extern int _pullNixTheNixed(pullContext *pctx);
 
 /* binningPull.c */
 extern void _pullBinInit(pullBin *bin);
@@ -177,13 +223,27 @@ extern void _pullBinPointRemove(pullContext *pctx, pullBin *bin, int loseIdx);
 extern int _pullBinSetup(pullContext *pctx);
 extern int _pullIterFinishDescent(pullContext *pctx);
 extern void _pullBinFinish(pullContext *pctx);
+extern int _pullBinsPack(pullContext *pctx);
+extern int _pullBinsWorkSet(pullContext *pctx);
+extern void _pullBinsUnpack(pullContext *pctx);
+extern void _pullVerletCheck(pullContext *pctx);
+extern int _pullBinsGather(pullTask *task);
+extern int _pullBinsCount(pullTask *task);
+extern int _pullBinsSize(pullTask *task);
+extern int _pullBinsScatter(pullTask *task);
+extern int _pullBinsRestrict(pullTask *task);
+extern int _pullBinsAddAll(pullContext *pctx);
 
 /* corePull.c */
 extern int _pullVerbose;
 extern int _pullProcess(pullTask *task);
 extern void *_pullWorker(void *_task);
+extern int _pullStageRun(pullContext *pctx, int stage);
 extern int _pullIterate(pullContext *pctx, int mode);
 
+/* checkpointPull.c */
+extern int _pullCheckpointStart(pullContext *pctx);
+
 #ifdef __cplusplus
 }
 #endif
@@ -310,9 +310,12 @@ enum {
   pullCountPoints,            /* 12 */
   pullCountCC,                /* 13 */
   pullCountIteration,         /* 14 */
+  pullCountVerletRebuild,     /* 15 */
+  pullCountProbeCacheHit,     /* 16 */
+  pullCountProbeCacheMiss,    /* 17 */
   pullCountLast
 };
-#define PULL_COUNT_MAX 14
+#define PULL_COUNT_MAX 17
 
 /*
 ** reasons for pullTraceSet to stop (or go nowhere)
@@ -374,6 +377,15 @@ typedef struct pullPoint_t {
   unsigned int neighPointNum;
   airArray *neighPointArr; /* airArray around neighPoint and neighNum
                               (no callbacks used here) */
+  struct pullPoint_t **verletPoint; /* with sysParm.neighborSkin > 0: the
+                                       Verlet list, of all points that were
+                                       within (1+skin) (in rs-normalized
+                                       space) when the list was built */
+  unsigned int verletPointNum;
+  airArray *verletPointArr; /* airArray around verletPoint and
+                               verletPointNum */
+  unsigned int verletStamp; /* verletPoint[] is current iff this is the same
+                               as pctx->verletStamp */
   double neighDistMean;    /* average of distance to neighboring
                               points with whom this point interacted,
                               in rs-normalized space */
@@ -394,6 +406,7 @@ typedef struct pullPoint_t {
 #endif
   int status;    /* bit-flag of status info */
   double pos[4], /* position in space and scale */
+    verletPos[4], /* position when Verlet lists were last rebuilt */
     energy,      /* energy accumulator for this iteration */
     force[4],    /* force accumulator for this iteration */
     stepEnergy,  /* step size for energy minimization */
@@ -417,6 +430,10 @@ typedef struct pullBin_t {
                                   (no callbacks used here) */
   struct pullBin_t **neighBin; /* NULL-terminated list of all
                                   neighboring bins, including myself */
+  double *packPos;             /* if non-NULL (only with pullFlagBinPack, and
+                                  only during an iteration), points into
+                                  pctx->packPos: 4*pointNum contiguous copies
+                                  of point[]->pos, for the neighbor search */
 } pullBin;
 
 /*
@@ -437,6 +454,13 @@ typedef struct {
   unsigned int parmNum;
   double (*well)(double *wx, const double parm[PULL_ENERGY_PARM_NUM]);
   double (*eval)(double *denr, double dist, const double parm[PULL_ENERGY_PARM_NUM]);
+  /* same as eval(), but for num distances at once, so that per-energy
+     setup (from parm) is done once, and the loop over dist[] can be
+     vectorized. All the pullEnergy's here have one; if it is NULL (as
+     with pullEnergyUnknown), pullEnergySpecEvalBatch() calls eval() num
+     times */
+  void (*evalBatch)(double *enr, double *denr, const double *dist, unsigned int num,
+                    const double parm[PULL_ENERGY_PARM_NUM]);
 } pullEnergy;
 
 typedef struct {
@@ -514,7 +538,29 @@ typedef struct pullTask_t {
   unsigned int nixPointNum;             /* # of points to nix */
   airArray *nixPointArr;                /* airArray around nixPoint, nixPointNum */
   void *returnPtr;                      /* for airThreadJoin */
-  unsigned int stuckNum;                /* # stuck particles seen by this task */
+  unsigned int stuckNum,                /* # stuck particles seen by this task */
+    nixNum,                             /* # points nixed by this task, in the
+                                           iteration finisher */
+    stageStart,                         /* where this task starts writing into
+                                           pctx->tmpPointPtr, while rebinning */
+    *binCount;                          /* if non-NULL, pctx->binNum counters of
+                                           how many points this task will put in
+                                           each bin (during the iteration
+                                           finishers, which re-bin or add points
+                                           in parallel), and then where in the
+                                           bin they go */
+  int stageErr;                         /* if non-zero, how this task failed in
+                                           its last pctx->stage (a private
+                                           _pullStageErr* value; worker threads
+                                           don't use biff), and */
+  unsigned int stageErrIdx;             /* the bin index or point idtag that
+                                           it failed on */
+  double *probeCache;                   /* if non-NULL (with pullFlagProbeCache),
+                                           _PULL_PROBE_CACHE_SIZE entries, each
+                                           holding the position, edge-ness, and
+                                           infos of a past probe */
+  unsigned int probeCacheHit,           /* # probes answered by probeCache, and */
+    probeCacheMiss;                     /* # not, since last added to pctx->count */
 } pullTask;
 
 /*
@@ -608,12 +654,17 @@ enum {
      0 if no such decay is wanted */
   pullIterParmEnergyIncreasePermitHalfLife,
 
+  /* if non-zero, interval between iters at which the whole state of the
+     system is saved (by a background thread) to a checkpoint file (see
+     pullCheckpointNameSet), from which pullStartFromCheckpoint can resume */
+  pullIterParmCheckpoint,
+
   pullIterParmLast
 };
 
 typedef struct {
   unsigned int min, max, popCntlPeriod, addDescent, constraintMax, stuckMax, callback,
-    snap, energyIncreasePermitHalfLife;
+    snap, energyIncreasePermitHalfLife, checkpoint;
 } pullIterParm;
 
 /*
@@ -705,14 +756,27 @@ enum {
      paper implies that this value should be 0.5; lower values also work) */
   pullSysParmFracNeighNixedMax,
 
+  /* if non-zero, use Verlet neighbor lists: each point remembers all the
+     points within (1 + neighborSkin) times the interaction radius, and
+     these lists are re-used (instead of searching the bins) until some
+     point has moved more than half the skin. Bins are made wider by
+     (1 + neighborSkin) to accommodate this */
+  pullSysParmNeighborSkin,
+
+  /* with pullFlagProbeCache: if non-zero, positions are rounded to this
+     fraction of voxelSizeSpace (and voxelSizeScale) to find their probe
+     cache entry, so that nearby positions share gage results. This is an
+     approximation; with zero, only identical positions share them */
+  pullSysParmProbeCacheQuantum,
+
   pullSysParmLast
 };
 
 typedef struct {
   double alpha, beta, gamma, separableGammaLearnRescale, wall, radiusSpace, radiusScale,
-    binWidthSpace, neighborTrueProb, probeProb, stepInitial, opporStepScale,
-    backStepScale, constraintStepMin, energyDecreaseMin, energyDecreasePopCntlMin,
-    energyIncreasePermit, fracNeighNixedMax;
+    binWidthSpace, neighborTrueProb, neighborSkin, probeProb, probeCacheQuantum,
+    stepInitial, opporStepScale, backStepScale, constraintStepMin, energyDecreaseMin,
+    energyDecreasePopCntlMin, energyIncreasePermit, fracNeighNixedMax;
 } pullSysParm;
 
 /*
@@ -816,6 +880,21 @@ enum {
      times, so that pull can be used to process 2D images */
   pullFlagZeroZ,
 
+  /* packed storage for the neighbor search: at the start of every
+     iteration, copy all point positions into one contiguous array,
+     ordered by bin, and hand out bins to the threads in Morton
+     (Z-curve) order so that consecutive bins (and their neighbors)
+     are also close in memory. Point processing order differs from
+     the default, so results are not bit-identical with it */
+  pullFlagBinPack,
+
+  /* each task remembers the results of its recent probes (in a table
+     indexed by position, see pullSysParmProbeCacheQuantum), and re-uses
+     them when probing at the same position again, as happens when
+     backing off from bad steps, satisfying constraints, and for points
+     that didn't move */
+  pullFlagProbeCache,
+
   pullFlagLast
 };
 
@@ -823,7 +902,8 @@ typedef struct {
   int permuteOnRebin, noPopCntlWithZeroAlpha, useBetaForGammaLearn, restrictiveAddToBins,
     energyFromStrength, nixAtVolumeEdgeSpace, nixAtVolumeEdgeSpaceInitRorH,
     constraintBeforeSeedThresh, popCntlEnoughTest, convergenceIgnoresPopCntl, noAdd,
-    binSingle, allowCodimension3Constraints, scaleIsTau, startSkipsPoints, zeroZ;
+    binSingle, allowCodimension3Constraints, scaleIsTau, startSkipsPoints, zeroZ,
+    binPack, probeCache;
 } pullFlag;
 
 /*
@@ -929,14 +1009,41 @@ typedef struct pullContext_t {
   unsigned int binsEdge[4],      /* # bins along each volume edge,
                                     determined by maxEval and scale */
     binNum,                      /* total # bins in grid */
-    binNextIdx;                  /* next bin of points to be processed,
-                                    we're done when binNextIdx == binNum */
+    binNextIdx,                  /* index into binWork of the next chunk of
+                                    bins to be processed (fetched with
+                                    airThreadAtomicUIntAdd); we're done when
+                                    binNextIdx >= binWorkNum */
+    *binOrder,                   /* if non-NULL, binNum bin indices in the
+                                    order that bins are processed (Morton
+                                    order, with flag.binPack) */
+    *binWork,                    /* indices of the non-empty bins, for the
+                                    current iteration: in binOrder order
+                                    with one thread, else by decreasing
+                                    estimated cost */
+    binWorkNum,                  /* # bins in binWork */
+    binWorkChunk;                /* # bins that a task takes per fetch */
+  double *packPos;               /* with flag.binPack, 4*packPosNum packed
+                                    point positions (see pullBin->packPos) */
+  unsigned int packPosNum;       /* # points allocated for in packPos */
+  unsigned int verletStamp;      /* incremented with every rebuild of the
+                                    Verlet lists (with sysParm.neighborSkin) */
+  int verletStale;               /* the population changed, so the Verlet
+                                    lists have to be rebuilt */
+  volatile unsigned int verletBroken; /* # points that have moved more than
+                                         half the skin since the last
+                                         _pullVerletCheck(): incremented (and
+                                         read) by the tasks with
+                                         airThreadAtomicUIntAdd; once non-zero,
+                                         no task trusts the Verlet lists until
+                                         they are rebuilt */
   unsigned int *tmpPointPerm;    /* storing points during rebinning */
   pullPoint **tmpPointPtr;
   unsigned int tmpPointNum;
+  int stage;                     /* what the tasks do when they pass
+                                    iterBarrierA: process bins for an
+                                    iteration, or one of the steps of the
+                                    iteration finishers (_pullStage* enum) */
 
-  airThreadMutex *binMutex;       /* mutex around bin, needed because bins
-                                     are the unit of work for the tasks */
   pullTask **task;                /* dynamically allocated array of tasks */
   airThreadBarrier *iterBarrierA; /* barriers between iterations */
   airThreadBarrier *iterBarrierB; /* barriers between iterations */
@@ -948,12 +1055,36 @@ typedef struct pullContext_t {
   FILE *logAdd; /* text-file record of all the particles
                    that have been added
                    (NOT thread-safe) */
+  char *checkpointName;        /* file to which checkpoints are saved, with
+                                  iterParm.checkpoint */
+  airThread *checkpointThread; /* background writer of checkpoints */
+  Nrrd *ncheckpoint;           /* the checkpoint it is writing */
+  char *checkpointHeader;      /* NRRD header of ncheckpoint, made before
+                                  checkpointThread starts */
+  int checkpointBusy,          /* checkpointThread was started, and hasn't
+                                  yet been joined */
+    checkpointErr;             /* non-zero if checkpointThread failed, which
+                                  (without biff) it describes in: */
+  char checkpointErrStr[AIR_STRLEN_MED + 1];
+  int resumed;                 /* set by pullStartFromCheckpoint, so that
+                                  pullRun continues (with no priming iteration)
+                                  from the run* values below */
+  double runEnergyLast,        /* the parts of the state of pullRun() that */
+    runEnergyDecreaseAvg;      /* are saved in checkpoints, as of the last */
+  unsigned int runFirstIter;   /* checkpoint or resume */
 
   /* OUTPUT ---------------------------- */
 
   double timeIteration, /* time needed for last (single) iter */
     timeRun,            /* total time spent in pullRun() */
-    energy;             /* final energy of system */
+    energy,             /* final energy of system */
+    verletDispMax;      /* with sysParm.neighborSkin: at the start of the
+                           last descent iter, the max (rs-normalized)
+                           displacement of any point since the Verlet
+                           lists were rebuilt */
+  int verletRebuilt;    /* the Verlet lists were rebuilt for the last
+                           descent iter (how often, over all iters, is
+                           counted by count[pullCountVerletRebuild]) */
   unsigned int addNum,  /* # prtls added by PopCntl in last iter */
     nixNum,             /* # prtls nixed by PopCntl in last iter */
     stuckNum,           /* # stuck particles in last iter */
@@ -1069,6 +1200,8 @@ PULL_EXPORT void pullEnergySpecSet(pullEnergySpec *ensp,
                                    const double parm[PULL_ENERGY_PARM_NUM]);
 PULL_EXPORT void pullEnergySpecCopy(pullEnergySpec *esDst, const pullEnergySpec *esSrc);
 PULL_EXPORT pullEnergySpec *pullEnergySpecNix(pullEnergySpec *ensp);
+PULL_EXPORT void pullEnergySpecEvalBatch(double *enr, double *denr, const double *dist,
+                                         unsigned int num, const pullEnergySpec *ensp);
 PULL_EXPORT int pullEnergySpecParse(pullEnergySpec *ensp, const char *str);
 PULL_EXPORT const hestCB *const pullHestEnergySpec;
 
@@ -1207,6 +1340,12 @@ PULL_EXPORT int pullStart(pullContext *pctx);
 PULL_EXPORT int pullRun(pullContext *pctx);
 PULL_EXPORT int pullFinish(pullContext *pctx);
 
+/* checkpointPull.c */
+PULL_EXPORT int pullCheckpointNameSet(pullContext *pctx, const char *name);
+PULL_EXPORT int pullCheckpointSave(pullContext *pctx, const char *fname);
+PULL_EXPORT int pullCheckpointWait(pullContext *pctx);
+PULL_EXPORT int pullStartFromCheckpoint(pullContext *pctx, const char *fname);
+
 /* ccPull.c */
 PULL_EXPORT int pullCCFind(pullContext *pctx);
 PULL_EXPORT int pullCCMeasure(pullContext *pctx, Nrrd *nmeas, int measrInfo, double rho);
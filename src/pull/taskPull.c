@@ -108,6 +108,22 @@ _pullTaskNew(pullContext *pctx, int threadIdx) {
                                   PULL_POINT_NEIGH_INCR);
   task->returnPtr = NULL;
   task->stuckNum = 0;
+  task->nixNum = 0;
+  task->stageStart = 0;
+  task->stageErr = 0;
+  task->stageErrIdx = 0;
+  task->binCount = NULL;
+  if (pctx->flag.probeCache) {
+    task->probeCache = AIR_CALLOC(_PULL_PROBE_CACHE_SIZE * (6 + pctx->infoTotalLen),
+                                  double);
+    if (!task->probeCache) {
+      biffAddf(PULL, "%s: couldn't allocate probe cache", me);
+      return NULL;
+    }
+  } else {
+    task->probeCache = NULL;
+  }
+  task->probeCacheHit = task->probeCacheMiss = 0;
   return task;
 }
 
@@ -127,6 +143,8 @@ _pullTaskNix(pullTask *task) {
     airFree(task->neighPoint);
     task->addPointArr = airArrayNuke(task->addPointArr);
     task->nixPointArr = airArrayNuke(task->nixPointArr);
+    airFree(task->binCount);
+    airFree(task->probeCache);
     airFree(task);
   }
   return NULL;
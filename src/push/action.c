@@ -160,8 +160,9 @@ _pushPairwiseEnergy(pushTask *task, double *enrP, double frc[3], pushEnergySpec
 int /* Biff: 1 */
 pushBinProcess(pushTask *task, unsigned int myBinIdx) {
   static const char me[] = "pushBinProcess";
-  pushBin *myBin, *herBin, **neighbor;
-  unsigned int myPointIdx, herPointIdx;
+  pushBin *myBin, *herBin;
+  unsigned int myPointIdx, herPointIdx, nei[27], neiNum, neiIdx;
+  int cell[3], neiCell[3];
   pushPoint *myPoint, *herPoint;
   double enr, frc[3], delta[3], deltaLen, deltaNorm[3], warp[3], limit, maxDiffLenSqrd,
     iscl, diff[3], diffLenSqrd;
@@ -172,6 +173,7 @@ pushBinProcess(pushTask *task, unsigned int myBinIdx) {
   maxDiffLenSqrd = (task->pctx->maxDist) * (task->pctx->maxDist);
   myBin = task->pctx->bin + myBinIdx;
   iscl = 1.0 / (2 * task->pctx->scale);
+  neiNum = 0;
   for (myPointIdx = 0; myPointIdx < myBin->pointNum; myPointIdx++) {
     myPoint = myBin->point[myPointIdx];
     myPoint->enr = 0;
@@ -180,11 +182,17 @@ pushBinProcess(pushTask *task, unsigned int myBinIdx) {
     if (1.0 <= task->pctx->neighborTrueProb
         || airDrandMT_r(task->rng) <= task->pctx->neighborTrueProb
         || !myPoint->neighArr->len) {
-      neighbor = myBin->neighbor;
+      airHashGridCell(task->pctx->hgrid, cell, myPoint->pos);
+      if (!neiNum || !ELL_3V_EQUAL(cell, neiCell)) {
+        /* a bin's points are often all in the same cell */
+        neiNum = airHashGridNeighborBuckets(task->pctx->hgrid, nei, cell);
+        ELL_3V_COPY(neiCell, cell);
+      }
       if (1.0 > task->pctx->neighborTrueProb) {
         airArrayLenSet(myPoint->neighArr, 0);
       }
-      while ((herBin = *neighbor)) {
+      for (neiIdx = 0; neiIdx < neiNum; neiIdx++) {
+        herBin = task->pctx->bin + nei[neiIdx];
         for (herPointIdx = 0; herPointIdx < herBin->pointNum; herPointIdx++) {
           herPoint = herBin->point[herPointIdx];
           if (myPoint == herPoint) {
@@ -219,7 +227,6 @@ pushBinProcess(pushTask *task, unsigned int myBinIdx) {
             return 1;
           }
         }
-        neighbor++;
       }
     } else {
       /* we are doing neighborhood list optimization, and this is an
@@ -317,8 +324,9 @@ pushBinProcess(pushTask *task, unsigned int myBinIdx) {
     ELL_3V_SCALE(delta, task->pctx->step, myPoint->frc);
     ELL_3V_NORM(deltaNorm, delta, deltaLen);
     if (0 == deltaLen) {
-      /* an unforced point, but this isn't an error */
-      return 0;
+      /* an unforced point, but this isn't an error; it doesn't move, but
+         the rest of the bin's points still need processing */
+      continue;
     }
     if (!(AIR_EXISTS(deltaLen) && ELL_3V_EXISTS(deltaNorm))) {
       biffAddf(PUSH, "%s: deltaLen %g or deltaNorm (%g,%g,%g) doesn't exist", me,
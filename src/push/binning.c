@@ -23,206 +23,125 @@
 #include "privatePush.h"
 
 /*
-** because the pushContext keeps an array of bins (not pointers to them)
-** we have Init and Done functions (not New and Nix)
+** puts the points in the bins that they are now in: builds pctx->hgrid (in
+** parallel, with pctx->threadNum threads) from the point positions,
+** re-orders pctx->point by bin, and sets the bins to point into it.
+**
+** This function is only called by the master thread, between iterations
 */
-void
-pushBinInit(pushBin *bin, unsigned int incr) {
-  pushPtrPtrUnion pppu;
-
-  bin->pointNum = 0;
-  bin->point = NULL;
-  bin->pointArr = airArrayNew((pppu.point = &(bin->point), pppu.v), &(bin->pointNum),
-                              sizeof(pushPoint *), incr);
-  bin->neighbor = NULL;
-  return;
-}
-
-/*
-** bins own the points they contain- so this frees them
-*/
-void
-pushBinDone(pushBin *bin) {
-  unsigned int idx;
-
-  for (idx = 0; idx < bin->pointNum; idx++) {
-    bin->point[idx] = pushPointNix(bin->point[idx]);
+int /* Biff: 1 */
+pushRebin(pushContext *pctx) {
+  static const char me[] = "pushRebin";
+  unsigned int pointIdx, binIdx;
+  pushPoint *point, **tmp;
+
+  for (pointIdx = 0; pointIdx < pctx->pointNum; pointIdx++) {
+    point = pctx->point[pointIdx];
+    if (!ELL_3V_EXISTS(point->pos)) {
+      biffAddf(PUSH, "%s: point %p %u has non-existent position (%g,%g,%g)", me,
+               AIR_VOIDP(point), point->ttaagg, point->pos[0], point->pos[1],
+               point->pos[2]);
+      return 1;
+    }
+    ELL_3V_COPY(pctx->pointPos + 3 * pointIdx, point->pos);
   }
-  bin->pointArr = airArrayNuke(bin->pointArr);
-  bin->neighbor = (pushBin **)airFree(bin->neighbor);
-  return;
-}
-
-/*
-** bins on boundary now extend to infinity; so the only time this
-** returns NULL (indicating error) is for non-existent positions
-*/
-pushBin * /* Biff: (private) NULL */
-_pushBinLocate(pushContext *pctx, double *_posWorld) {
-  static const char me[] = "_pushBinLocate";
-  double posWorld[4], posIdx[4];
-  unsigned int axi, eidx[3], binIdx;
-
-  if (!ELL_3V_EXISTS(_posWorld)) {
-    biffAddf(PUSH, "%s: non-existent position (%g,%g,%g)", me, _posWorld[0],
-             _posWorld[1], _posWorld[2]);
-    return NULL;
+  if (airHashGridBuild(pctx->hgrid, pctx->pointPos, 3, pctx->pointNum,
+                       pctx->threadNum)) {
+    biffAddf(PUSH, "%s: trouble hashing %u points", me, pctx->pointNum);
+    return 1;
   }
-
-  if (pctx->binSingle) {
-    binIdx = 0;
-  } else {
-    ELL_3V_COPY(posWorld, _posWorld);
-    posWorld[3] = 1.0;
-    ELL_4MV_MUL(posIdx, pctx->gctx->shape->WtoI, posWorld);
-    ELL_34V_HOMOG(posIdx, posIdx);
-    for (axi = 0; axi < 3; axi++) {
-      eidx[axi] = airIndexClamp(-0.5,
-                                posIdx[axi],
-                                pctx->gctx->shape->size[axi] - 0.5,
-                                pctx->binsEdge[axi]);
+  if (pctx->binNum != pctx->hgrid->bucketNum) {
+    airFree(pctx->bin);
+    airFree(pctx->binWork);
+    pctx->binNum = pctx->hgrid->bucketNum;
+    pctx->bin = (pushBin *)calloc(pctx->binNum, sizeof(pushBin));
+    pctx->binWork = (unsigned int *)calloc(pctx->binNum, sizeof(unsigned int));
+    if (!(pctx->bin && pctx->binWork)) {
+      biffAddf(PUSH, "%s: trouble allocating %u bins", me, pctx->binNum);
+      return 1;
     }
-    binIdx = (eidx[0] + pctx->binsEdge[0] * (eidx[1] + pctx->binsEdge[1] * eidx[2]));
   }
-  /*
-  fprintf(stderr, "!%s: bin(%g,%g,%g) = %u\n", me,
-          _posWorld[0], _posWorld[1], _posWorld[2], binIdx);
-  */
+  for (pointIdx = 0; pointIdx < pctx->pointNum; pointIdx++) {
+    pctx->pointTmp[pointIdx] = pctx->point[pctx->hgrid->pointIdx[pointIdx]];
+  }
+  tmp = pctx->point;
+  pctx->point = pctx->pointTmp;
+  pctx->pointTmp = tmp;
+  for (binIdx = 0; binIdx < pctx->binNum; binIdx++) {
+    pctx->bin[binIdx].pointNum = pctx->hgrid->bucketCount[binIdx];
+    pctx->bin[binIdx].point = pctx->point + pctx->hgrid->bucketStart[binIdx];
+  }
 
-  return pctx->bin + binIdx;
+  return 0;
 }
 
-/*
-** this makes the bin the owner of the point
-*/
-void
-_pushBinPointAdd(pushContext *pctx, pushBin *bin, pushPoint *point) {
-  int pntI;
-
-  AIR_UNUSED(pctx);
-  pntI = airArrayLenIncr(bin->pointArr, 1);
-  bin->point[pntI] = point;
-
-  return;
+typedef struct {
+  double cost;
+  unsigned int idx;
+} _pushBinCost;
+
+static int
+_pushBinCostCompare(const void *_a, const void *_b) {
+  const _pushBinCost *a, *b;
+
+  a = AIR_CAST(const _pushBinCost *, _a);
+  b = AIR_CAST(const _pushBinCost *, _b);
+  /* decreasing cost, then increasing bin index */
+  return (a->cost > b->cost
+            ? -1
+            : (a->cost < b->cost ? 1 : (a->idx < b->idx ? -1 : a->idx > b->idx)));
 }
 
 /*
-** the bin loses track of the point, caller responsible for ownership
+** sets pctx->binWork, binWorkNum, binWorkChunk: the non-empty bins to
+** be processed this iteration, and how many a task takes at a time.
+** With more than one thread, bins are sorted by decreasing estimated
+** cost (# points times # points in the bins neighboring its first
+** point), so that load balances even when point density varies a lot.
+** With one thread, bins are in index order, as they always were.
 */
-static void
-_pushBinPointRemove(pushContext *pctx, pushBin *bin, int loseIdx) {
-
-  AIR_UNUSED(pctx);
-  bin->point[loseIdx] = bin->point[bin->pointNum - 1];
-  airArrayLenIncr(bin->pointArr, -1);
-
-  return;
-}
-
-static void
-_pushBinNeighborSet(pushBin *bin, pushBin **nei, unsigned int num) {
-  unsigned int neiI;
-
-  bin->neighbor = (pushBin **)airFree(bin->neighbor);
-  bin->neighbor = (pushBin **)calloc(1 + num, sizeof(pushBin *));
-  for (neiI = 0; neiI < num; neiI++) {
-    bin->neighbor[neiI] = nei[neiI];
-  }
-  bin->neighbor[neiI] = NULL;
-  return;
-}
-
-void
-pushBinAllNeighborSet(pushContext *pctx) {
-  /* static const char me[] = "pushBinAllNeighborSet"; */
-  pushBin *nei[3 * 3 * 3];
-  unsigned int neiNum, xi, yi, zi, xx, yy, zz, xmax, ymax, zmax, binIdx;
-  int xmin, ymin, zmin;
+int /* Biff: (private) 1 */
+_pushBinWorkSet(pushContext *pctx) {
+  static const char me[] = "_pushBinWorkSet";
+  unsigned int binIdx, workIdx, neiPointNum, nei[27], neiNum, neiIdx;
+  int cell[3];
+  pushBin *bin;
+  _pushBinCost *cost;
 
-  if (pctx->binSingle) {
-    neiNum = 0;
-    nei[neiNum++] = pctx->bin + 0;
-    _pushBinNeighborSet(pctx->bin + 0, nei, neiNum);
-  } else {
-    for (zi = 0; zi < pctx->binsEdge[2]; zi++) {
-      zmin = AIR_MAX(0, (int)zi - 1);
-      zmax = AIR_MIN(zi + 1, pctx->binsEdge[2] - 1);
-      for (yi = 0; yi < pctx->binsEdge[1]; yi++) {
-        ymin = AIR_MAX(0, (int)yi - 1);
-        ymax = AIR_MIN(yi + 1, pctx->binsEdge[1] - 1);
-        for (xi = 0; xi < pctx->binsEdge[0]; xi++) {
-          xmin = AIR_MAX(0, (int)xi - 1);
-          xmax = AIR_MIN(xi + 1, pctx->binsEdge[0] - 1);
-          neiNum = 0;
-          for (zz = zmin; zz <= zmax; zz++) {
-            for (yy = ymin; yy <= ymax; yy++) {
-              for (xx = xmin; xx <= xmax; xx++) {
-                binIdx = xx + pctx->binsEdge[0] * (yy + pctx->binsEdge[1] * zz);
-                /*
-                fprintf(stderr, "!%s: nei[%u](%u,%u,%u) = %u\n", me,
-                        neiNum, xi, yi, zi, binIdx);
-                */
-                nei[neiNum++] = pctx->bin + binIdx;
-              }
-            }
-          }
-          _pushBinNeighborSet(pctx->bin + xi
-                                + pctx->binsEdge[0] * (yi + pctx->binsEdge[1] * zi),
-                              nei, neiNum);
-        }
-      }
+  pctx->binWorkNum = 0;
+  for (binIdx = 0; binIdx < pctx->binNum; binIdx++) {
+    if (pctx->bin[binIdx].pointNum) {
+      pctx->binWork[pctx->binWorkNum++] = binIdx;
     }
   }
-  return;
-}
-
-int /* Biff: 1 */
-pushBinPointAdd(pushContext *pctx, pushPoint *point) {
-  static const char me[] = "pushBinPointAdd";
-  pushBin *bin;
-
-  if (!(bin = _pushBinLocate(pctx, point->pos))) {
-    biffAddf(PUSH, "%s: can't locate point %p %u", me, AIR_VOIDP(point), point->ttaagg);
+  if (1 == pctx->threadNum) {
+    pctx->binWorkChunk = 1;
+    return 0;
+  }
+  pctx->binWorkChunk = airThreadFetchChunk(pctx->binWorkNum, pctx->threadNum);
+  if (pctx->binWorkNum < 2) {
+    return 0;
+  }
+  cost = (_pushBinCost *)calloc(pctx->binWorkNum, sizeof(_pushBinCost));
+  if (!cost) {
+    biffAddf(PUSH, "%s: couldn't allocate costs for %u bins", me, pctx->binWorkNum);
     return 1;
   }
-  _pushBinPointAdd(pctx, bin, point);
-  return 0;
-}
-
-/*
-** This function is only called by the master thread, this
-** does *not* have to be thread-safe in any way
-*/
-int /* Biff: 1 */
-pushRebin(pushContext *pctx) {
-  static const char me[] = "pushRebin";
-  unsigned int oldBinIdx, pointIdx;
-  pushBin *oldBin, *newBin;
-  pushPoint *point;
-
-  if (!pctx->binSingle) {
-    for (oldBinIdx = 0; oldBinIdx < pctx->binNum; oldBinIdx++) {
-      oldBin = pctx->bin + oldBinIdx;
-
-      for (pointIdx = 0; pointIdx < oldBin->pointNum; /* nope! */) {
-        point = oldBin->point[pointIdx];
-        newBin = _pushBinLocate(pctx, point->pos);
-        if (!newBin) {
-          biffAddf(PUSH, "%s: can't locate point %p %u", me, AIR_VOIDP(point),
-                   point->ttaagg);
-          return 1;
-        }
-        if (oldBin != newBin) {
-          _pushBinPointRemove(pctx, oldBin, pointIdx);
-          _pushBinPointAdd(pctx, newBin, point);
-        } else {
-          /* its in the right bin, move on */
-          pointIdx++;
-        }
-      } /* for pointIdx */
-
-    } /* for oldBinIdx */
+  for (workIdx = 0; workIdx < pctx->binWorkNum; workIdx++) {
+    bin = pctx->bin + pctx->binWork[workIdx];
+    airHashGridCell(pctx->hgrid, cell, bin->point[0]->pos);
+    neiNum = airHashGridNeighborBuckets(pctx->hgrid, nei, cell);
+    neiPointNum = 0;
+    for (neiIdx = 0; neiIdx < neiNum; neiIdx++) {
+      neiPointNum += pctx->bin[nei[neiIdx]].pointNum;
+    }
+    cost[workIdx].cost = AIR_CAST(double, bin->pointNum) * neiPointNum;
+    cost[workIdx].idx = pctx->binWork[workIdx];
   }
-
+  qsort(cost, pctx->binWorkNum, sizeof(_pushBinCost), _pushBinCostCompare);
+  for (workIdx = 0; workIdx < pctx->binWorkNum; workIdx++) {
+    pctx->binWork[workIdx] = cost[workIdx].idx;
+  }
+  free(cost);
   return 0;
 }
@@ -24,35 +24,25 @@
 
 /*
 ** this is the core of the worker threads: as long as there are bins
-** left to process, get the next one, and process it
+** left to process, get the next chunk of them, and process them
 */
 static int /* Biff: 1 */
 _pushProcess(pushTask *task) {
   static const char me[] = "_pushProcess";
-  unsigned int binIdx;
-
-  while (task->pctx->binIdx < task->pctx->binNum) {
-    /* get the index of the next bin to process */
-    if (task->pctx->threadNum > 1) {
-      airThreadMutexLock(task->pctx->binMutex);
-    }
-    do {
-      binIdx = task->pctx->binIdx;
-      if (task->pctx->binIdx < task->pctx->binNum) {
-        task->pctx->binIdx++;
+  pushContext *pctx;
+  unsigned int workIdx, workStop, binIdx;
+
+  pctx = task->pctx;
+  /* grab binWorkChunk bins at a time (see _pushBinWorkSet) */
+  while ((workIdx = airThreadAtomicUIntAdd(&(pctx->binIdx), pctx->binWorkChunk))
+         < pctx->binWorkNum) {
+    workStop = AIR_MIN(workIdx + pctx->binWorkChunk, pctx->binWorkNum);
+    for (; workIdx < workStop; workIdx++) {
+      binIdx = pctx->binWork[workIdx];
+      if (pushBinProcess(task, binIdx)) {
+        biffAddf(PUSH, "%s(%u): had trouble on bin %u", me, task->threadIdx, binIdx);
+        return 1;
       }
-    } while (binIdx < task->pctx->binNum && 0 == task->pctx->bin[binIdx].pointNum);
-    if (task->pctx->threadNum > 1) {
-      airThreadMutexUnlock(task->pctx->binMutex);
-    }
-    if (binIdx == task->pctx->binNum) {
-      /* no more bins to process! */
-      break;
-    }
-
-    if (pushBinProcess(task, binIdx)) {
-      biffAddf(PUSH, "%s(%u): had trouble on bin %u", me, task->threadIdx, binIdx);
-      return 1;
     }
   }
   return 0;
@@ -202,7 +192,6 @@ pushStart(pushContext *pctx) {
   fprintf(stderr, "!%s: setup done-ish\n", me);
 
   if (pctx->threadNum > 1) {
-    pctx->binMutex = airThreadMutexNew();
     pctx->iterBarrierA = airThreadBarrierNew(pctx->threadNum);
     pctx->iterBarrierB = airThreadBarrierNew(pctx->threadNum);
     /* start threads 1 and up running; they'll all hit iterBarrierA  */
@@ -213,7 +202,6 @@ pushStart(pushContext *pctx) {
       airThreadStart(pctx->task[tidx]->thread, _pushWorker, (void *)(pctx->task[tidx]));
     }
   } else {
-    pctx->binMutex = NULL;
     pctx->iterBarrierA = NULL;
     pctx->iterBarrierB = NULL;
   }
@@ -250,6 +238,10 @@ pushIterate(pushContext *pctx) {
   /* the _pushWorker checks finished after iterBarrierA */
   pctx->finished = AIR_FALSE;
   pctx->binIdx = 0;
+  if (_pushBinWorkSet(pctx)) {
+    biffAddf(PUSH, "%s: trouble setting up bins for iter %u", me, pctx->iter);
+    return 1;
+  }
   for (ti = 0; ti < pctx->threadNum; ti++) {
     pctx->task[ti]->pointNum = 0;
     pctx->task[ti]->energySum = 0;
@@ -424,15 +416,21 @@ pushFinish(pushContext *pctx) {
   pctx->ninv = nrrdNuke(pctx->ninv);
   pctx->nmask = nrrdNuke(pctx->nmask);
   pctx->gctx = gageContextNix(pctx->gctx);
-  for (ii = 0; ii < pctx->binNum; ii++) {
-    pushBinDone(pctx->bin + ii);
+  if (pctx->point) {
+    for (ii = 0; ii < pctx->pointNum; ii++) {
+      pctx->point[ii] = pushPointNix(pctx->point[ii]);
+    }
   }
+  pctx->point = (pushPoint **)airFree(pctx->point);
+  pctx->pointTmp = (pushPoint **)airFree(pctx->pointTmp);
+  pctx->pointPos = (double *)airFree(pctx->pointPos);
+  pctx->hgrid = airHashGridNix(pctx->hgrid);
   pctx->bin = (pushBin *)airFree(pctx->bin);
-  ELL_3V_SET(pctx->binsEdge, 0, 0, 0);
+  pctx->binWork = (unsigned int *)airFree(pctx->binWork);
   pctx->binNum = 0;
+  pctx->binWorkNum = 0;
 
   if (pctx->threadNum > 1) {
-    pctx->binMutex = airThreadMutexNix(pctx->binMutex);
     pctx->iterBarrierA = airThreadBarrierNix(pctx->iterBarrierA);
     pctx->iterBarrierB = airThreadBarrierNix(pctx->iterBarrierB);
   }
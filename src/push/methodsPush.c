@@ -105,7 +105,6 @@ pushContextNew(void) {
     pctx->ensp = pushEnergySpecNew();
 
     pctx->binSingle = AIR_FALSE;
-    pctx->binIncr = 512;
 
     pctx->ksp00 = nrrdKernelSpecNew();
     pctx->ksp11 = nrrdKernelSpecNew();
@@ -122,11 +121,16 @@ pushContextNew(void) {
     pctx->dimIn = 0;
     pctx->sliceAxis = 42; /* an invalid value */
 
+    pctx->point = NULL;
+    pctx->pointTmp = NULL;
+    pctx->pointPos = NULL;
+    pctx->hgrid = NULL;
     pctx->bin = NULL;
-    ELL_3V_SET(pctx->binsEdge, 0, 0, 0);
     pctx->binNum = 0;
     pctx->binIdx = 0;
-    pctx->binMutex = NULL;
+    pctx->binWork = NULL;
+    pctx->binWorkNum = 0;
+    pctx->binWorkChunk = 1;
 
     pctx->step = AIR_NAN;
     pctx->maxDist = AIR_NAN;
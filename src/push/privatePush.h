@@ -27,8 +27,7 @@ extern "C" {
 extern int _pushVerbose;
 
 /* binning.c */
-extern pushBin *_pushBinLocate(pushContext *pctx, double *pos);
-extern void _pushBinPointAdd(pushContext *pctx, pushBin *bin, pushPoint *point);
+extern int _pushBinWorkSet(pushContext *pctx);
 
 /* setup.c */
 extern pushTask *_pushTaskNew(pushContext *pctx, int threadIdx);
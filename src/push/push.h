@@ -80,14 +80,13 @@ typedef struct pushPoint_t {
 **
 ** the data structure for doing spatial binning.
 **
-** in tractlet-less push, bins do own the points they contain
+** bins are the buckets of pctx->hgrid, and are re-set by every pushRebin.
+** Bins don't own the points they contain; pctx->point does
 */
-typedef struct pushBin_t {
-  unsigned int pointNum;       /* # of points in this bin */
-  pushPoint **point;           /* dyn. alloc. array of point pointers */
-  airArray *pointArr;          /* airArray around point and pointNum */
-  struct pushBin_t **neighbor; /* pre-computed NULL-terminated list of all
-                                  neighboring bins, including myself */
+typedef struct {
+  unsigned int pointNum; /* # of points in this bin */
+  pushPoint **point;     /* pointer into pctx->point, where this bin's
+                            points start */
 } pushBin;
 
 /*
@@ -208,8 +207,7 @@ typedef struct pushContext_t {
 
   pushEnergySpec *ensp; /* potential energy function to use */
 
-  int binSingle;        /* disable binning (for debugging) */
-  unsigned int binIncr; /* increment for per-bin airArray */
+  int binSingle; /* disable binning (for debugging) */
 
   NrrdKernelSpec *ksp00, /* for sampling tensor field */
     *ksp11,              /* for gradient of mask, other 1st derivs */
@@ -229,14 +227,24 @@ typedef struct pushContext_t {
     sliceAxis;                /* got a single 3-D slice, which axis had
                                  only a single sample */
 
-  pushBin *bin;             /* volume of bins (see binsEdge, binNum) */
-  unsigned int binsEdge[3], /* # bins along each volume edge,
-                               determined by maxEval and scale */
-    binNum,                 /* total # bins in grid */
-    binIdx;                 /* *next* bin of points needing to be
-                               processed.  Stage is done when
-                               binIdx == binNum */
-  airThreadMutex *binMutex; /* mutex around bin */
+  pushPoint **point,        /* all pointNum points, in order of the bin
+                               they're in (as of last pushRebin) */
+    **pointTmp;             /* pointNum pointers for re-ordering point */
+  double *pointPos;         /* 3 x pointNum positions for building hgrid */
+  airHashGrid *hgrid;       /* spatial hash of points, with cells of size
+                               maxDist; memory used doesn't depend on the
+                               size of the field */
+  pushBin *bin;             /* one per hgrid bucket (see binNum) */
+  unsigned int binNum,      /* # bins (hgrid->bucketNum) */
+    binIdx,                 /* index into binWork of the *next* chunk
+                               of bins needing to be processed (fetched
+                               with airThreadAtomicUIntAdd).  Stage is
+                               done when binIdx >= binWorkNum */
+    *binWork,               /* indices of the non-empty bins, in index
+                               order with one thread, else by decreasing
+                               estimated cost */
+    binWorkNum,             /* # bins in binWork */
+    binWorkChunk;           /* # bins that a task takes per fetch */
 
   double step,                    /* current working step size */
     maxDist,                      /* max distance btween interacting points */
@@ -298,10 +306,6 @@ PUSH_EXPORT int pushRun(pushContext *pctx);
 PUSH_EXPORT int pushFinish(pushContext *pctx);
 
 /* binning.c */
-PUSH_EXPORT void pushBinInit(pushBin *bin, unsigned int incr);
-PUSH_EXPORT void pushBinDone(pushBin *bin);
-PUSH_EXPORT int pushBinPointAdd(pushContext *pctx, pushPoint *point);
-PUSH_EXPORT void pushBinAllNeighborSet(pushContext *pctx);
 PUSH_EXPORT int pushRebin(pushContext *pctx);
 
 /* action.c */
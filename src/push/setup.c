@@ -254,16 +254,16 @@ _pushTaskSetup(pushContext *pctx) {
 /*
 ** _pushBinSetup sets:
 **** pctx->maxDist, pctx->minEval, pctx->maxEval, pctx->maxDet
-**** pctx->binsEdge[], pctx->binNum
-**** pctx->bin
-**** pctx->bin[]
+**** pctx->hgrid
+**
+** the bins themselves are allocated by the first pushRebin, once the
+** number of points is known
 */
 int /* Biff: (private) 1 */
 _pushBinSetup(pushContext *pctx) {
   static const char me[] = "_pushBinSetup";
   float eval[3], *tdata;
   unsigned int ii, nn, count;
-  double col[3][4], volEdge[3];
 
   /* ------------------------ find maxEval, maxDet, and set up binning */
   nn = AIR_UINT(nrrdElementNumber(pctx->nten) / 7);
@@ -299,45 +299,14 @@ _pushBinSetup(pushContext *pctx) {
   pctx->maxDist = (2 * pctx->scale * pctx->maxEval
                    * pctx->ensp->energy->support(pctx->ensp->parm));
 
-  if (pctx->binSingle) {
-    pctx->binsEdge[0] = 1;
-    pctx->binsEdge[1] = 1;
-    pctx->binsEdge[2] = 1;
-    pctx->binNum = 1;
-  } else {
-    ELL_4MV_COL0_GET(col[0], pctx->gctx->shape->ItoW);
-    col[0][3] = 0.0;
-    ELL_4MV_COL1_GET(col[1], pctx->gctx->shape->ItoW);
-    col[1][3] = 0.0;
-    ELL_4MV_COL2_GET(col[2], pctx->gctx->shape->ItoW);
-    col[2][3] = 0.0;
-    volEdge[0] = ELL_3V_LEN(col[0]) * pctx->gctx->shape->size[0];
-    volEdge[1] = ELL_3V_LEN(col[1]) * pctx->gctx->shape->size[1];
-    volEdge[2] = ELL_3V_LEN(col[2]) * pctx->gctx->shape->size[2];
-    fprintf(stderr, "!%s: volEdge = %g %g %g\n", me, volEdge[0], volEdge[1], volEdge[2]);
-    pctx->binsEdge[0] = AIR_UINT(floor(volEdge[0] / pctx->maxDist));
-    pctx->binsEdge[0] = pctx->binsEdge[0] ? pctx->binsEdge[0] : 1;
-    pctx->binsEdge[1] = AIR_UINT(floor(volEdge[1] / pctx->maxDist));
-    pctx->binsEdge[1] = pctx->binsEdge[1] ? pctx->binsEdge[1] : 1;
-    pctx->binsEdge[2] = AIR_UINT(floor(volEdge[2] / pctx->maxDist));
-    pctx->binsEdge[2] = pctx->binsEdge[2] ? pctx->binsEdge[2] : 1;
-    if (2 == pctx->dimIn) {
-      pctx->binsEdge[pctx->sliceAxis] = 1;
-    }
-    fprintf(stderr, "!%s: maxEval=%g -> maxDist=%g -> binsEdge=(%u,%u,%u)\n", me,
-            pctx->maxEval, pctx->maxDist, pctx->binsEdge[0], pctx->binsEdge[1],
-            pctx->binsEdge[2]);
-    pctx->binNum = pctx->binsEdge[0] * pctx->binsEdge[1] * pctx->binsEdge[2];
-  }
-  pctx->bin = (pushBin *)calloc(pctx->binNum, sizeof(pushBin));
-  if (!(pctx->bin)) {
-    biffAddf(PUSH, "%s: trouble allocating bin arrays", me);
+  /* with binSingle, all points are in one (infinitely large) cell */
+  pctx->hgrid = airHashGridNew(pctx->binSingle ? AIR_POS_INF : pctx->maxDist);
+  if (!pctx->hgrid) {
+    biffAddf(PUSH, "%s: couldn't create spatial hash with cells of size %g", me,
+             pctx->maxDist);
     return 1;
   }
-  for (ii = 0; ii < pctx->binNum; ii++) {
-    pushBinInit(pctx->bin + ii, pctx->binIncr);
-  }
-  pushBinAllNeighborSet(pctx);
+  fprintf(stderr, "!%s: maxEval=%g -> maxDist=%g\n", me, pctx->maxEval, pctx->maxDist);
 
   return 0;
 }
@@ -345,6 +314,8 @@ _pushBinSetup(pushContext *pctx) {
 /*
 ** _pushPointSetup sets:
 **** pctx->pointNum (in case pctx->npos)
+**** pctx->point, pctx->pointTmp, pctx->pointPos
+**** pctx->bin, pctx->binNum, pctx->binWork (via pushRebin)
 **
 ** This is only called by the master thread
 **
@@ -365,6 +336,13 @@ _pushPointSetup(pushContext *pctx) {
 
   pctx->pointNum = (pctx->npos ? AIR_UINT(pctx->npos->axis[1].size) : pctx->pointNum);
   lup = pctx->npos ? nrrdDLookup[pctx->npos->type] : NULL;
+  pctx->point = (pushPoint **)calloc(pctx->pointNum, sizeof(pushPoint *));
+  pctx->pointTmp = (pushPoint **)calloc(pctx->pointNum, sizeof(pushPoint *));
+  pctx->pointPos = (double *)calloc(3 * pctx->pointNum, sizeof(double));
+  if (!(pctx->point && pctx->pointTmp && pctx->pointPos)) {
+    biffAddf(PUSH, "%s: couldn't allocate arrays for %u points", me, pctx->pointNum);
+    return 1;
+  }
   fprintf(stderr, "!%s: initilizing/seeding ... \n", me);
   /* HEY: we end up keeping a local copy of maxDet because convolution
      can produce a tensor with higher determinant than that of any
@@ -446,10 +424,11 @@ _pushPointSetup(pushContext *pctx) {
                        > 0))
                || (pctx->detReject && (airDrandMT() < detProbe / maxDet)));
     }
-    if (pushBinPointAdd(pctx, point)) {
-      biffAddf(PUSH, "%s: trouble binning point %u", me, point->ttaagg);
-      return 1;
-    }
+    pctx->point[pointIdx] = point;
+  }
+  if (pushRebin(pctx)) {
+    biffAddf(PUSH, "%s: trouble binning points", me);
+    return 1;
   }
   fprintf(stderr, "!%s: ... seeding DONE\n", me);
   return 0;
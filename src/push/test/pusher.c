@@ -177,7 +177,6 @@ main(int argc, const char *argv[]) {
   pctx->nin = nin;
   pctx->npos = nPosIn;
   pctx->verbose = 0;
-  pctx->binIncr = 84;  /* random small-ish value */
   pushEnergySpecSet(pctx->ensp, ensp->energy, ensp->parm);
   nrrdKernelSpecSet(pctx->ksp00, ksp00->kernel, ksp00->parm);
   nrrdKernelSpecSet(pctx->ksp11, ksp11->kernel, ksp11->parm);
@@ -570,6 +570,84 @@ tenEstimateLinearSingle_f(float *_ten, float *_B0P,              /* output */
   return;
 }
 
+/* # voxels at a time in tenEstimateLinear4D */
+#define _TEN_LINEAR_BLOCK 16
+
+/*
+** _tenEstimateLinearBlock_d
+**
+** does what tenEstimateLinearSingle_d does, but for num voxels at once:
+** dwi[] has the DD values of each voxel in turn, ten[] gets 7 values per
+** voxel, and B0[] (if non-NULL) one value per voxel.  vbuf[] has to be
+** allocated for (DD+1)*num doubles.  The log values are stored in vbuf with
+** the voxel index fastest, so that applying emat is a matrix-matrix product
+** whose innermost loop is over voxels.  For each voxel, the arithmetic is
+** the same (and in the same order) as with tenEstimateLinearSingle_d.
+*/
+static void
+_tenEstimateLinearBlock_d(double *ten, double *B0, const double *dwi,
+                          const double *emat, double *vbuf, unsigned int DD,
+                          unsigned int num, int knownB0, double thresh, double soft,
+                          double b) {
+  const double *dd;
+  double logB0, tmp, mean, ee, *acc;
+  unsigned int ii, jj, vi, LL;
+
+  /* LL = number of log values per voxel */
+  LL = knownB0 ? DD - 1 : DD;
+  acc = vbuf + LL * num;
+  for (vi = 0; vi < num; vi++) {
+    dd = dwi + DD * vi;
+    mean = 0;
+    if (knownB0) {
+      if (B0) {
+        B0[vi] = AIR_MAX(dd[0], 1);
+      }
+      logB0 = log(AIR_MAX(dd[0], 1));
+      for (ii = 1; ii < DD; ii++) {
+        tmp = AIR_MAX(dd[ii], 1);
+        mean += tmp;
+        vbuf[vi + num * (ii - 1)] = (logB0 - log(tmp)) / b;
+      }
+    } else {
+      for (ii = 0; ii < DD; ii++) {
+        tmp = AIR_MAX(dd[ii], 1);
+        mean += tmp;
+        vbuf[vi + num * ii] = -log(tmp) / b;
+      }
+    }
+    mean /= LL;
+    if (soft) {
+      ten[7 * vi] = AIR_AFFINE(-1, airErf((mean - thresh) / (soft + 0.000001)), 1, 0,
+                               1);
+    } else {
+      ten[7 * vi] = mean > thresh;
+    }
+  }
+  for (jj = 0; jj < (knownB0 ? 6u : 7u); jj++) {
+    for (vi = 0; vi < num; vi++) {
+      acc[vi] = 0;
+    }
+    for (ii = 0; ii < LL; ii++) {
+      ee = emat[ii + LL * jj];
+      for (vi = 0; vi < num; vi++) {
+        acc[vi] += ee * vbuf[vi + num * ii];
+      }
+    }
+    if (jj < 6) {
+      for (vi = 0; vi < num; vi++) {
+        ten[jj + 1 + 7 * vi] = acc[vi];
+      }
+    } else if (B0) {
+      /* seventh row, for finding B0 */
+      for (vi = 0; vi < num; vi++) {
+        B0[vi] = exp(b * acc[vi]);
+      }
+    }
+  }
+  return;
+}
+
 /*
 ******** tenEstimateLinear3D
 **
@@ -632,10 +710,11 @@ tenEstimateLinear4D(Nrrd *nten, Nrrd **nterrP, Nrrd **nB0P, const Nrrd *ndwi,
   static const char me[] = "tenEstimateLinear4D";
   Nrrd *nemat, *nbmat, *ncrop, *nhist;
   airArray *mop;
-  size_t cmin[4], cmax[4], sx, sy, sz, II, d, DD;
+  size_t cmin[4], cmax[4], sx, sy, sz, NN, II, d, DD;
+  unsigned int vi, num;
   int E, amap[4];
   float *ten, *dwi1, *dwi2, *terr, _B0, *B0, (*lup)(const void *, size_t);
-  double *emat, *bmat, *vbuf;
+  double *emat, *bmat, *vbuf, *dblk, *tblk, *bblk;
   NrrdRange *range;
   float te, d1, d2;
   char stmp[2][AIR_STRLEN_SMALL + 1];
@@ -690,13 +769,20 @@ tenEstimateLinear4D(Nrrd *nten, Nrrd **nterrP, Nrrd **nB0P, const Nrrd *ndwi,
     airMopError(mop);
     return 1;
   }
-  vbuf = AIR_CALLOC(knownB0 ? DD - 1 : DD, double);
-  dwi1 = AIR_CALLOC(DD, float);
+  /* voxels are estimated _TEN_LINEAR_BLOCK at a time */
+  vbuf = AIR_CALLOC((DD + 1) * _TEN_LINEAR_BLOCK, double);
+  dblk = AIR_CALLOC(DD * _TEN_LINEAR_BLOCK, double);
+  tblk = AIR_CALLOC(7 * _TEN_LINEAR_BLOCK, double);
+  bblk = AIR_CALLOC(_TEN_LINEAR_BLOCK, double);
+  dwi1 = AIR_CALLOC(DD * _TEN_LINEAR_BLOCK, float);
   dwi2 = AIR_CALLOC(knownB0 ? DD : DD + 1, float);
   airMopAdd(mop, vbuf, airFree, airMopAlways);
+  airMopAdd(mop, dblk, airFree, airMopAlways);
+  airMopAdd(mop, tblk, airFree, airMopAlways);
+  airMopAdd(mop, bblk, airFree, airMopAlways);
   airMopAdd(mop, dwi1, airFree, airMopAlways);
   airMopAdd(mop, dwi2, airFree, airMopAlways);
-  if (!(vbuf && dwi1 && dwi2)) {
+  if (!(vbuf && dblk && tblk && bblk && dwi1 && dwi2)) {
     biffAddf(TEN, "%s: couldn't allocate temp buffers", me);
     airMopError(mop);
     return 1;
@@ -764,51 +850,51 @@ tenEstimateLinear4D(Nrrd *nten, Nrrd **nterrP, Nrrd **nB0P, const Nrrd *ndwi,
   emat = (double *)(nemat->data);
   ten = (float *)(nten->data);
   lup = nrrdFLookup[ndwi->type];
-  for (II = 0; II < sx * sy * sz; II++) {
-    /* tenVerbose = (II == 42 + 190*(96 + 196*0)); */
-    for (d = 0; d < DD; d++) {
+  NN = sx * sy * sz;
+  for (II = 0; II < NN; II += num) {
+    num = AIR_UINT(AIR_MIN(_TEN_LINEAR_BLOCK, NN - II));
+    /* the values go through float, as with tenEstimateLinearSingle_f */
+    for (d = 0; d < DD * num; d++) {
       dwi1[d] = lup(ndwi->data, d + DD * II);
-      /* if (tenVerbose) {
-        fprintf(stderr, "%s: input dwi1[%d] = %g\n", me, d, dwi1[d]);
-      } */
+      dblk[d] = dwi1[d];
     }
-    tenEstimateLinearSingle_f(ten, &_B0, dwi1, emat, vbuf, AIR_UINT(DD), knownB0,
+    _tenEstimateLinearBlock_d(tblk, bblk, dblk, emat, vbuf, AIR_UINT(DD), num, knownB0,
                               AIR_FLOAT(thresh), AIR_FLOAT(soft), AIR_FLOAT(b));
-    if (nB0P) {
-      *B0 = _B0;
-    }
-    /* if (tenVerbose) {
-      fprintf(stderr, "%s: output ten = (%g) %g,%g,%g  %g,%g  %g\n", me,
-              ten[0], ten[1], ten[2], ten[3], ten[4], ten[5], ten[6]);
-    } */
-    if (nterrP) {
-      te = 0;
-      if (knownB0) {
-        tenSimulateSingle_f(dwi2, _B0, ten, bmat, AIR_UINT(DD), AIR_FLOAT(b));
-        for (d = 1; d < DD; d++) {
-          d1 = AIR_MAX(dwi1[d], 1);
-          d2 = AIR_MAX(dwi2[d], 1);
-          te += (d1 - d2) * (d1 - d2);
-        }
-        te /= (DD - 1);
-      } else {
-        tenSimulateSingle_f(dwi2, _B0, ten, bmat, AIR_UINT(DD + 1), AIR_FLOAT(b));
-        for (d = 0; d < DD; d++) {
-          d1 = AIR_MAX(dwi1[d], 1);
-          /* tenSimulateSingle_f always puts the B0 in the beginning of
-             the dwi vector, but in this case we didn't have it in
-             the input dwi vector */
-          d2 = AIR_MAX(dwi2[d + 1], 1);
-          te += (d1 - d2) * (d1 - d2);
+    for (vi = 0; vi < num; vi++) {
+      TEN_T_COPY_TT(ten, float, tblk + 7 * vi);
+      _B0 = AIR_FLOAT(bblk[vi]);
+      if (nB0P) {
+        *B0 = _B0;
+      }
+      if (nterrP) {
+        te = 0;
+        if (knownB0) {
+          tenSimulateSingle_f(dwi2, _B0, ten, bmat, AIR_UINT(DD), AIR_FLOAT(b));
+          for (d = 1; d < DD; d++) {
+            d1 = AIR_MAX(dwi1[d + DD * vi], 1);
+            d2 = AIR_MAX(dwi2[d], 1);
+            te += (d1 - d2) * (d1 - d2);
+          }
+          te /= (DD - 1);
+        } else {
+          tenSimulateSingle_f(dwi2, _B0, ten, bmat, AIR_UINT(DD + 1), AIR_FLOAT(b));
+          for (d = 0; d < DD; d++) {
+            d1 = AIR_MAX(dwi1[d + DD * vi], 1);
+            /* tenSimulateSingle_f always puts the B0 in the beginning of
+               the dwi vector, but in this case we didn't have it in
+               the input dwi vector */
+            d2 = AIR_MAX(dwi2[d + 1], 1);
+            te += (d1 - d2) * (d1 - d2);
+          }
+          te /= DD;
         }
-        te /= DD;
+        *terr = AIR_FLOAT(sqrt(te));
+        terr += 1;
+      }
+      ten += 7;
+      if (B0) {
+        B0 += 1;
       }
-      *terr = AIR_FLOAT(sqrt(te));
-      terr += 1;
-    }
-    ten += 7;
-    if (B0) {
-      B0 += 1;
     }
   }
   /* not our job: tenEigenvalueClamp(nten, nten, 0, AIR_NAN); */
@@ -106,94 +106,211 @@ _tenEpiRegCheck(Nrrd **nout, Nrrd **ndwi, unsigned int dwiLen, Nrrd *ngrad,
   return 0;
 }
 
+/*
+** The stages of registration that are independent across DWIs (blurring,
+** thresholding, connected components, moments) or across slices (HST
+** estimation, final resampling) are split into "jobs", one per DWI or
+** slice, which are handed out one at a time by _tenJobsRun.  No job depends
+** on which thread does it, or on the jobs before it, so the output doesn't
+** depend on threadNum.  Biff is not thread-safe, so only jobs that can't
+** use biff (not even via the nrrd and ell functions they call) are done by
+** many threads, and their failures are described (with biffAddf) only by
+** the caller, in this thread.  Jobs that can use biff are instead done in
+** this thread, one at a time, stopping at the first failure, so that biff
+** holds the messages of just that one job for the caller to biffMovef.
+*/
+typedef struct {
+  /* input */
+  void *stage; /* whatever the job function needs */
+  int (*job)(void *stage, unsigned int ti, unsigned int jj);
+  /* ^ does job jj in task ti; returns non-zero on error */
+  int useBiff;         /* job can use biff (directly or not), so it has to
+                          be done in this thread */
+  unsigned int jobNum, /* number of jobs */
+    verbStride;        /* if non-zero, print jj/verbStride when starting job jj,
+                          if jj is a multiple of verbStride */
+  /* output */
+  int failed,           /* some job failed */
+    failRet;            /* what the lowest-numbered failed job returned */
+  unsigned int failJob; /* the lowest-numbered failed job */
+} _tenEpiRegJobs;
+
+/* the work of _tenJobsRun: jobs [lo,hi) */
+static int
+_tenEpiRegWork(void *_ejobs, unsigned int ti, size_t lo, size_t hi, size_t *failP) {
+  _tenEpiRegJobs *ejobs;
+  size_t jj;
+  int ret;
+
+  ejobs = AIR_CAST(_tenEpiRegJobs *, _ejobs);
+  for (jj = lo; jj < hi; jj++) {
+    if ((ret = ejobs->job(ejobs->stage, ti, AIR_UINT(jj)))) {
+      *failP = jj;
+      return ret;
+    }
+  }
+  return 0;
+}
+
+static void
+_tenEpiRegFetched(void *_ejobs, size_t lo) {
+  _tenEpiRegJobs *ejobs;
+
+  ejobs = AIR_CAST(_tenEpiRegJobs *, _ejobs);
+  if (!(lo % ejobs->verbStride)) {
+    fprintf(stderr, "%2u ", AIR_UINT(lo / ejobs->verbStride));
+    fflush(stderr);
+  }
+}
+
+/*
+** _tenEpiRegJobsRun
+**
+** does the ejobs->jobNum jobs with threadNum threads (or with just this
+** one, if ejobs->useBiff).  Returns non-zero only when there was trouble
+** with the threads themselves; whether some job failed is recorded in
+** ejobs->failed, for the caller to report.
+*/
+static int /* Biff: 1 */
+_tenEpiRegJobsRun(_tenEpiRegJobs *ejobs, unsigned int threadNum) {
+  _tenJobs jobs;
+  unsigned int jj;
+  int ret;
+
+  ejobs->failed = AIR_FALSE;
+  ejobs->failRet = 0;
+  ejobs->failJob = 0;
+  if (ejobs->useBiff) {
+    for (jj = 0; jj < ejobs->jobNum; jj++) {
+      if (ejobs->verbStride) {
+        _tenEpiRegFetched(ejobs, jj);
+      }
+      if ((ret = ejobs->job(ejobs->stage, 0, jj))) {
+        ejobs->failed = AIR_TRUE;
+        ejobs->failRet = ret;
+        ejobs->failJob = jj;
+        break;
+      }
+    }
+    return 0;
+  }
+  jobs.data = ejobs;
+  jobs.work = _tenEpiRegWork;
+  jobs.fetched = ejobs->verbStride ? _tenEpiRegFetched : NULL;
+  jobs.jobNum = ejobs->jobNum;
+  jobs.chunk = 1;
+  if (_tenJobsRun(&jobs, threadNum)) {
+    return 1;
+  }
+  ejobs->failed = jobs.failed;
+  ejobs->failRet = jobs.failRet;
+  ejobs->failJob = AIR_UINT(jobs.failJob);
+  return 0;
+}
+
+typedef struct {
+  Nrrd **nblur, **ndwi;
+  const NrrdResampleInfo *rinfo; /* NULL if not blurring, only copying */
+} _tenEpiRegBlurStage;
+
+static int
+_tenEpiRegBlurJob(void *_stage, unsigned int ti, unsigned int ni) {
+  _tenEpiRegBlurStage *stage;
+  Nrrd *ndwi;
+  double savemin[2], savemax[2];
+  int ret;
+
+  AIR_UNUSED(ti);
+  stage = AIR_CAST(_tenEpiRegBlurStage *, _stage);
+  ndwi = stage->ndwi[ni];
+  if (!stage->rinfo) {
+    return nrrdCopy(stage->nblur[ni], ndwi);
+  }
+  savemin[0] = ndwi->axis[0].min;
+  savemax[0] = ndwi->axis[0].max;
+  savemin[1] = ndwi->axis[1].min;
+  savemax[1] = ndwi->axis[1].max;
+  ndwi->axis[0].min = 0;
+  ndwi->axis[0].max = AIR_CAST(double, ndwi->axis[0].size - 1);
+  ndwi->axis[1].min = 0;
+  ndwi->axis[1].max = AIR_CAST(double, ndwi->axis[1].size - 1);
+  ret = nrrdSpatialResample(stage->nblur[ni], ndwi, stage->rinfo);
+  ndwi->axis[0].min = savemin[0];
+  ndwi->axis[0].max = savemax[0];
+  ndwi->axis[1].min = savemin[1];
+  ndwi->axis[1].max = savemax[1];
+  return ret;
+}
+
 /*
 ** this assumes that all nblur[i] are valid nrrds, and does nothing
 ** to manage them
 */
 static int /* Biff: 1 */
 _tenEpiRegBlur(Nrrd **nblur, Nrrd **ndwi, unsigned int dwiLen, double bwX, double bwY,
-               int verb) {
+               unsigned int threadNum, int verb) {
   static const char me[] = "_tenEpiRegBlur";
   NrrdResampleInfo *rinfo;
   airArray *mop;
-  size_t ni, sx, sy, sz;
-  double savemin[2], savemax[2];
+  _tenEpiRegBlurStage stage;
+  _tenEpiRegJobs jobs;
+  size_t sx, sy, sz;
 
+  mop = airMopNew();
+  stage.nblur = nblur;
+  stage.ndwi = ndwi;
   if (!(bwX || bwY)) {
-    if (verb) {
-      fprintf(stderr, "%s:\n            ", me);
-      fflush(stderr);
-    }
-    for (ni = 0; ni < dwiLen; ni++) {
-      if (verb) {
-        fprintf(stderr, "%2u ", (unsigned int)ni);
-        fflush(stderr);
-      }
-      if (nrrdCopy(nblur[ni], ndwi[ni])) {
-        biffMovef(TEN, NRRD, "%s: trouble copying ndwi[%u]", me, (unsigned int)ni);
-        return 1;
-      }
+    stage.rinfo = NULL;
+  } else {
+    /* we need to blur */
+    sx = ndwi[0]->axis[0].size;
+    sy = ndwi[0]->axis[1].size;
+    sz = ndwi[0]->axis[2].size;
+    rinfo = nrrdResampleInfoNew();
+    airMopAdd(mop, rinfo, (airMopper)nrrdResampleInfoNix, airMopAlways);
+    if (bwX) {
+      rinfo->kernel[0] = nrrdKernelGaussian;
+      rinfo->parm[0][0] = bwX;
+      rinfo->parm[0][1] = 3.0; /* how many stnd devs do we cut-off at */
+    } else {
+      rinfo->kernel[0] = NULL;
     }
-    if (verb) {
-      fprintf(stderr, "done\n");
+    if (bwY) {
+      rinfo->kernel[1] = nrrdKernelGaussian;
+      rinfo->parm[1][0] = bwY;
+      rinfo->parm[1][1] = 3.0; /* how many stnd devs do we cut-off at */
+    } else {
+      rinfo->kernel[1] = NULL;
     }
-    return 0;
-  }
-  /* else we need to blur */
-  sx = ndwi[0]->axis[0].size;
-  sy = ndwi[0]->axis[1].size;
-  sz = ndwi[0]->axis[2].size;
-  mop = airMopNew();
-  rinfo = nrrdResampleInfoNew();
-  airMopAdd(mop, rinfo, (airMopper)nrrdResampleInfoNix, airMopAlways);
-  if (bwX) {
-    rinfo->kernel[0] = nrrdKernelGaussian;
-    rinfo->parm[0][0] = bwX;
-    rinfo->parm[0][1] = 3.0; /* how many stnd devs do we cut-off at */
-  } else {
-    rinfo->kernel[0] = NULL;
-  }
-  if (bwY) {
-    rinfo->kernel[1] = nrrdKernelGaussian;
-    rinfo->parm[1][0] = bwY;
-    rinfo->parm[1][1] = 3.0; /* how many stnd devs do we cut-off at */
-  } else {
-    rinfo->kernel[1] = NULL;
-  }
-  rinfo->kernel[2] = NULL;
-  ELL_3V_SET(rinfo->samples, sx, sy, sz);
-  ELL_3V_SET(rinfo->min, 0, 0, 0);
-  ELL_3V_SET(rinfo->max, sx - 1, sy - 1, sz - 1);
-  rinfo->boundary = nrrdBoundaryBleed;
-  rinfo->type = nrrdTypeDefault;
-  rinfo->renormalize = AIR_TRUE;
-  rinfo->clamp = AIR_TRUE;
+    rinfo->kernel[2] = NULL;
+    ELL_3V_SET(rinfo->samples, sx, sy, sz);
+    ELL_3V_SET(rinfo->min, 0, 0, 0);
+    ELL_3V_SET(rinfo->max, sx - 1, sy - 1, sz - 1);
+    rinfo->boundary = nrrdBoundaryBleed;
+    rinfo->type = nrrdTypeDefault;
+    rinfo->renormalize = AIR_TRUE;
+    rinfo->clamp = AIR_TRUE;
+    stage.rinfo = rinfo;
+  }
+  jobs.stage = &stage;
+  jobs.job = _tenEpiRegBlurJob;
+  jobs.useBiff = AIR_TRUE; /* nrrdSpatialResample, nrrdCopy */
+  jobs.jobNum = dwiLen;
+  jobs.verbStride = !!verb;
   if (verb) {
     fprintf(stderr, "%s:\n            ", me);
     fflush(stderr);
   }
-  for (ni = 0; ni < dwiLen; ni++) {
-    if (verb) {
-      fprintf(stderr, "%2u ", (unsigned int)ni);
-      fflush(stderr);
-    }
-    savemin[0] = ndwi[ni]->axis[0].min;
-    savemax[0] = ndwi[ni]->axis[0].max;
-    savemin[1] = ndwi[ni]->axis[1].min;
-    savemax[1] = ndwi[ni]->axis[1].max;
-    ndwi[ni]->axis[0].min = 0;
-    ndwi[ni]->axis[0].max = sx - 1;
-    ndwi[ni]->axis[1].min = 0;
-    ndwi[ni]->axis[1].max = sy - 1;
-    if (nrrdSpatialResample(nblur[ni], ndwi[ni], rinfo)) {
-      biffMovef(TEN, NRRD, "%s: trouble blurring ndwi[%u]", me, (unsigned int)ni);
-      airMopError(mop);
-      return 1;
-    }
-    ndwi[ni]->axis[0].min = savemin[0];
-    ndwi[ni]->axis[0].max = savemax[0];
-    ndwi[ni]->axis[1].min = savemin[1];
-    ndwi[ni]->axis[1].max = savemax[1];
+  if (_tenEpiRegJobsRun(&jobs, threadNum)) {
+    biffAddf(TEN, "%s: trouble with threads", me);
+    airMopError(mop);
+    return 1;
+  }
+  if (jobs.failed) {
+    biffMovef(TEN, NRRD, "%s: trouble %s ndwi[%u]", me,
+              stage.rinfo ? "blurring" : "copying", jobs.failJob);
+    airMopError(mop);
+    return 1;
   }
   if (verb) {
     fprintf(stderr, "done\n");
@@ -265,14 +382,39 @@ _tenEpiRegThresholdFind(double *DWthrP, Nrrd **nin, int ninLen, int save, double
   return 0;
 }
 
+typedef struct {
+  Nrrd **nthresh, **nblur;
+  float DWthr;
+} _tenEpiRegThresholdStage;
+
+static int
+_tenEpiRegThresholdJob(void *_stage, unsigned int ti, unsigned int ni) {
+  _tenEpiRegThresholdStage *stage;
+  Nrrd *nblur;
+  size_t I, NN;
+  float val;
+  unsigned char *thr;
+
+  AIR_UNUSED(ti);
+  stage = AIR_CAST(_tenEpiRegThresholdStage *, _stage);
+  nblur = stage->nblur[ni];
+  NN = nrrdElementNumber(nblur);
+  thr = (unsigned char *)(stage->nthresh[ni]->data);
+  for (I = 0; I < NN; I++) {
+    val = nrrdFLookup[nblur->type](nblur->data, I);
+    val -= stage->DWthr;
+    thr[I] = (val >= 0 ? 1 : 0);
+  }
+  return 0;
+}
+
 static int /* Biff: 1 */
 _tenEpiRegThreshold(Nrrd **nthresh, Nrrd **nblur, unsigned int ninLen, double DWthr,
-                    int verb, int progress, double expo) {
+                    unsigned int threadNum, int verb, int progress, double expo) {
   static const char me[] = "_tenEpiRegThreshold";
-  airArray *mop;
-  size_t I, sx, sy, sz, ni;
-  float val;
-  unsigned char *thr;
+  _tenEpiRegThresholdStage stage;
+  _tenEpiRegJobs jobs;
+  unsigned int ni;
 
   if (!(AIR_EXISTS(DWthr))) {
     if (_tenEpiRegThresholdFind(&DWthr, nblur, ninLen, progress, expo)) {
@@ -282,36 +424,34 @@ _tenEpiRegThreshold(Nrrd **nthresh, Nrrd **nblur, unsigned int ninLen, double DW
     fprintf(stderr, "%s: using %g for DWI threshold\n", me, DWthr);
   }
 
-  mop = airMopNew();
+  /* allocated here so that the jobs don't use biff */
+  for (ni = 0; ni < ninLen; ni++) {
+    if (nrrdMaybeAlloc_va(nthresh[ni], nrrdTypeUChar, 3, nblur[ni]->axis[0].size,
+                          nblur[ni]->axis[1].size, nblur[ni]->axis[2].size)) {
+      biffMovef(TEN, NRRD, "%s: trouble allocating threshold %u", me, ni);
+      return 1;
+    }
+  }
+  stage.nthresh = nthresh;
+  stage.nblur = nblur;
+  stage.DWthr = AIR_FLOAT(DWthr);
+  jobs.stage = &stage;
+  jobs.job = _tenEpiRegThresholdJob;
+  jobs.useBiff = AIR_FALSE;
+  jobs.jobNum = ninLen;
+  jobs.verbStride = !!verb;
   if (verb) {
     fprintf(stderr, "%s:\n            ", me);
     fflush(stderr);
   }
-  sx = nblur[0]->axis[0].size;
-  sy = nblur[0]->axis[1].size;
-  sz = nblur[0]->axis[2].size;
-  for (ni = 0; ni < ninLen; ni++) {
-    if (verb) {
-      fprintf(stderr, "%2u ", (unsigned int)ni);
-      fflush(stderr);
-    }
-    if (nrrdMaybeAlloc_va(nthresh[ni], nrrdTypeUChar, 3, sx, sy, sz)) {
-      biffMovef(TEN, NRRD, "%s: trouble allocating threshold %u", me, (unsigned int)ni);
-      airMopError(mop);
-      return 1;
-    }
-    thr = (unsigned char *)(nthresh[ni]->data);
-    for (I = 0; I < sx * sy * sz; I++) {
-      val = nrrdFLookup[nblur[ni]->type](nblur[ni]->data, I);
-      val -= AIR_FLOAT(DWthr);
-      thr[I] = (val >= 0 ? 1 : 0);
-    }
+  if (_tenEpiRegJobsRun(&jobs, threadNum)) {
+    biffAddf(TEN, "%s: trouble with threads", me);
+    return 1;
   }
   if (verb) {
     fprintf(stderr, "done\n");
   }
 
-  airMopOkay(mop);
   return 0;
 }
 
@@ -333,64 +473,123 @@ _tenEpiRegBB(Nrrd *nval, Nrrd *nsize) {
   return big;
 }
 
+typedef struct {
+  Nrrd **nthr;
+  unsigned int conny;
+  Nrrd **nslc, **ncc, **nval, **nsize; /* per-task buffers; nrrdCCFind may nuke
+                                          and NULL out nval[ti] on error */
+} _tenEpiRegCCStage;
+
+/*
+** returns 1 for trouble with the 3-D processing, 2 if there was no bright
+** 3-D CC, or 3 + z for trouble processing slice z
+*/
+static int
+_tenEpiRegCCJob(void *_stage, unsigned int ti, unsigned int ni) {
+  _tenEpiRegCCStage *stage;
+  Nrrd *nthr, *nslc, *ncc, **nvalP, *nsize;
+  int big;
+  unsigned int z, sz, conny;
+
+  stage = AIR_CAST(_tenEpiRegCCStage *, _stage);
+  nthr = stage->nthr[ni];
+  nslc = stage->nslc[ti];
+  ncc = stage->ncc[ti];
+  nvalP = stage->nval + ti;
+  nsize = stage->nsize[ti];
+  conny = stage->conny;
+  sz = AIR_UINT(nthr->axis[2].size);
+  /* for each volume, we find the biggest bright 3-D CC, and merge
+     down (to dark) all smaller bright pieces.  Then, within each
+     slice, we do 2-D CCs, find the biggest bright CC (size == big),
+     and merge up (to bright) all small dark pieces, where
+     (currently) small is big/2 */
+  big = -1;
+  if (nrrdCCFind(ncc, nvalP, nthr, nrrdTypeDefault, conny) || nrrdCCSize(nsize, ncc)
+      || !(big = _tenEpiRegBB(*nvalP, nsize))
+      || nrrdCCMerge(ncc, ncc, *nvalP, -1, big - 1, 0, conny)
+      || nrrdCCRevalue(nthr, ncc, *nvalP)) {
+    return big ? 1 : 2;
+  }
+  for (z = 0; z < sz; z++) {
+    big = -1;
+    if (nrrdSlice(nslc, nthr, 2, z)
+        || nrrdCCFind(ncc, nvalP, nslc, nrrdTypeDefault, conny)
+        || nrrdCCSize(nsize, ncc) || !(big = _tenEpiRegBB(*nvalP, nsize))
+        || nrrdCCMerge(ncc, ncc, *nvalP, 1, big / 2, 0, conny)
+        || nrrdCCRevalue(nslc, ncc, *nvalP) || nrrdSplice(nthr, nthr, nslc, 2, z)) {
+      if (big) {
+        return 3 + AIR_INT(z);
+      } else {
+        /* biggest bright CC on this slice had size 0
+           <==> there was no bright CC on this slice, move on */
+      }
+    }
+  }
+  return 0;
+}
+
 static int /* Biff: 1 */
-_tenEpiRegCC(Nrrd **nthr, int ninLen, int conny, int verb) {
+_tenEpiRegCC(Nrrd **nthr, unsigned int ninLen, unsigned int conny,
+             unsigned int threadNum, int verb) {
   static const char me[] = "_tenEpiRegCC";
-  Nrrd *nslc, *ncc, *nval, *nsize;
+  _tenEpiRegCCStage stage;
+  _tenEpiRegJobs jobs;
   airArray *mop;
-  int ni, big;
-  unsigned int z, sz;
+  unsigned int ti, taskNum;
+  int ret;
 
   mop = airMopNew();
-  airMopAdd(mop, nslc = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  airMopAdd(mop, nval = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  airMopAdd(mop, ncc = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  airMopAdd(mop, nsize = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  sz = AIR_UINT(nthr[0]->axis[2].size);
+  taskNum = _tenJobsThreadNum(threadNum, ninLen);
+  stage.nthr = nthr;
+  stage.conny = conny;
+  stage.nslc = AIR_CALLOC(4 * taskNum, Nrrd *);
+  if (!stage.nslc) {
+    biffAddf(TEN, "%s: couldn't allocate buffers for %u tasks", me, taskNum);
+    airMopError(mop);
+    return 1;
+  }
+  airMopAdd(mop, stage.nslc, airFree, airMopAlways);
+  stage.ncc = stage.nslc + taskNum;
+  stage.nval = stage.ncc + taskNum;
+  stage.nsize = stage.nval + taskNum;
+  for (ti = 0; ti < taskNum; ti++) {
+    airMopAdd(mop, stage.nslc[ti] = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
+    airMopAdd(mop, stage.ncc[ti] = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
+    stage.nval[ti] = nrrdNew();
+    airMopAdd(mop, stage.nsize[ti] = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
+  }
+  jobs.stage = &stage;
+  jobs.job = _tenEpiRegCCJob;
+  jobs.useBiff = AIR_TRUE; /* nrrdCC*, nrrdSlice, nrrdSplice */
+  jobs.jobNum = ninLen;
+  jobs.verbStride = !!verb;
   if (verb) {
     fprintf(stderr, "%s:\n            ", me);
     fflush(stderr);
   }
-  for (ni = 0; ni < ninLen; ni++) {
-    if (verb) {
-      fprintf(stderr, "%2d ", ni);
-      fflush(stderr);
-    }
-    /* for each volume, we find the biggest bright 3-D CC, and merge
-       down (to dark) all smaller bright pieces.  Then, within each
-       slice, we do 2-D CCs, find the biggest bright CC (size == big),
-       and merge up (to bright) all small dark pieces, where
-       (currently) small is big/2 */
-    big = -1;
-    if (nrrdCCFind(ncc, &nval, nthr[ni], nrrdTypeDefault, conny)
-        || nrrdCCSize(nsize, ncc) || !(big = _tenEpiRegBB(nval, nsize))
-        || nrrdCCMerge(ncc, ncc, nval, -1, big - 1, 0, conny)
-        || nrrdCCRevalue(nthr[ni], ncc, nval)) {
-      if (big) {
-        biffMovef(TEN, NRRD, "%s: trouble with 3-D processing nthr[%d]", me, ni);
-        return 1;
-      } else {
-        biffAddf(TEN, "%s: got size 0 for biggest bright CC of nthr[%d]", me, ni);
-        return 1;
-      }
-    }
-    for (z = 0; z < sz; z++) {
-      big = -1;
-      if (nrrdSlice(nslc, nthr[ni], 2, z)
-          || nrrdCCFind(ncc, &nval, nslc, nrrdTypeDefault, conny)
-          || nrrdCCSize(nsize, ncc) || !(big = _tenEpiRegBB(nval, nsize))
-          || nrrdCCMerge(ncc, ncc, nval, 1, big / 2, 0, conny)
-          || nrrdCCRevalue(nslc, ncc, nval)
-          || nrrdSplice(nthr[ni], nthr[ni], nslc, 2, z)) {
-        if (big) {
-          biffMovef(TEN, NRRD, "%s: trouble processing slice %d of nthr[%d]", me, z, ni);
-          return 1;
-        } else {
-          /* biggest bright CC on this slice had size 0
-             <==> there was no bright CC on this slice, move on */
-        }
-      }
+  ret = _tenEpiRegJobsRun(&jobs, threadNum);
+  for (ti = 0; ti < taskNum; ti++) {
+    nrrdNuke(stage.nval[ti]);
+  }
+  if (ret) {
+    biffAddf(TEN, "%s: trouble with threads", me);
+    airMopError(mop);
+    return 1;
+  }
+  if (jobs.failed) {
+    if (1 == jobs.failRet) {
+      biffMovef(TEN, NRRD, "%s: trouble with 3-D processing nthr[%u]", me,
+                jobs.failJob);
+    } else if (2 == jobs.failRet) {
+      biffAddf(TEN, "%s: got size 0 for biggest bright CC of nthr[%u]", me,
+               jobs.failJob);
+    } else {
+      biffMovef(TEN, NRRD, "%s: trouble processing slice %d of nthr[%u]", me,
+                jobs.failRet - 3, jobs.failJob);
     }
+    airMopError(mop);
+    return 1;
   }
   if (verb) {
     fprintf(stderr, "done\n");
@@ -406,6 +605,87 @@ _tenEpiRegCC(Nrrd **nthr, int ninLen, int conny, int verb) {
 #define M_11   3
 #define M_20   4
 
+typedef struct {
+  Nrrd **nmom, **nthresh;
+} _tenEpiRegMomentsStage;
+
+/*
+** returns 1 if some slice of nthresh[ni] had only non-zero pixels
+*/
+static int
+_tenEpiRegMomentsJob(void *_stage, unsigned int ti, unsigned int ni) {
+  _tenEpiRegMomentsStage *stage;
+  Nrrd *nmom, *nthresh;
+  size_t sx, sy, sz, xi, yi, zi;
+  double N, mx, my, cx, cy, x, y, M02, M11, M20, *mom;
+  float val;
+  unsigned char *thr;
+
+  AIR_UNUSED(ti);
+  stage = AIR_CAST(_tenEpiRegMomentsStage *, _stage);
+  nmom = stage->nmom[ni];
+  nthresh = stage->nthresh[ni];
+  sx = nthresh->axis[0].size;
+  sy = nthresh->axis[1].size;
+  sz = nthresh->axis[2].size;
+  thr = (unsigned char *)(nthresh->data);
+  mom = (double *)(nmom->data);
+  for (zi = 0; zi < sz; zi++) {
+    /* ------ find mx, my */
+    N = 0;
+    mx = my = 0.0;
+    for (yi = 0; yi < sy; yi++) {
+      for (xi = 0; xi < sx; xi++) {
+        val = thr[xi + sx * yi];
+        N += val;
+        mx += xi * val;
+        my += yi * val;
+      }
+    }
+    if (N == sx * sy) {
+      return 1;
+    }
+    if (N) {
+      /* there were non-zero pixels */
+      mx /= N;
+      my /= N;
+      cx = sx / 2.0;
+      cy = sy / 2.0;
+      /* ------ find M02, M11, M20 */
+      M02 = M11 = M20 = 0.0;
+      for (yi = 0; yi < sy; yi++) {
+        for (xi = 0; xi < sx; xi++) {
+          val = thr[xi + sx * yi];
+          x = xi - cx;
+          y = yi - cy;
+          M02 += y * y * val;
+          M11 += x * y * val;
+          M20 += x * x * val;
+        }
+      }
+      M02 /= N;
+      M11 /= N;
+      M20 /= N;
+      /* ------ set output */
+      mom[MEAN_X] = mx;
+      mom[MEAN_Y] = my;
+      mom[M_02] = M02;
+      mom[M_11] = M11;
+      mom[M_20] = M20;
+    } else {
+      /* there were no non-zero pixels */
+      mom[MEAN_X] = 0;
+      mom[MEAN_Y] = 0;
+      mom[M_02] = 0;
+      mom[M_11] = 0;
+      mom[M_20] = 0;
+    }
+    thr += sx * sy;
+    mom += 5;
+  }
+  return 0;
+}
+
 /*
 ** _tenEpiRegMoments()
 **
@@ -416,89 +696,43 @@ _tenEpiRegCC(Nrrd **nthr, int ninLen, int conny, int verb) {
 **   mean(x)  mean(y)  M_02    M_11    M_20
 */
 static int /* Biff: 1 */
-_tenEpiRegMoments(Nrrd **nmom, Nrrd **nthresh, unsigned int ninLen, int verb) {
+_tenEpiRegMoments(Nrrd **nmom, Nrrd **nthresh, unsigned int ninLen,
+                  unsigned int threadNum, int verb) {
   static const char me[] = "_tenEpiRegMoments";
-  size_t sx, sy, sz, xi, yi, zi, ni;
-  double N, mx, my, cx, cy, x, y, M02, M11, M20, *mom;
-  float val;
-  unsigned char *thr;
+  _tenEpiRegMomentsStage stage;
+  _tenEpiRegJobs jobs;
+  unsigned int ni;
 
-  sx = nthresh[0]->axis[0].size;
-  sy = nthresh[0]->axis[1].size;
-  sz = nthresh[0]->axis[2].size;
-  if (verb) {
-    fprintf(stderr, "%s:\n            ", me);
-    fflush(stderr);
-  }
+  /* allocated here so that the jobs don't use biff */
   for (ni = 0; ni < ninLen; ni++) {
-    if (verb) {
-      fprintf(stderr, "%2u ", (unsigned int)ni);
-      fflush(stderr);
-    }
-    if (nrrdMaybeAlloc_va(nmom[ni], nrrdTypeDouble, 2, AIR_SIZE_T(5), sz)) {
-      biffMovef(TEN, NRRD, "%s: couldn't allocate nmom[%u]", me, (unsigned int)ni);
+    if (nrrdMaybeAlloc_va(nmom[ni], nrrdTypeDouble, 2, AIR_SIZE_T(5),
+                          nthresh[ni]->axis[2].size)) {
+      biffMovef(TEN, NRRD, "%s: couldn't allocate nmom[%u]", me, ni);
       return 1;
     }
     nrrdAxisInfoSet_va(nmom[ni], nrrdAxisInfoLabel, "mx,my,h,s,t", "z");
-    thr = (unsigned char *)(nthresh[ni]->data);
-    mom = (double *)(nmom[ni]->data);
-    for (zi = 0; zi < sz; zi++) {
-      /* ------ find mx, my */
-      N = 0;
-      mx = my = 0.0;
-      for (yi = 0; yi < sy; yi++) {
-        for (xi = 0; xi < sx; xi++) {
-          val = thr[xi + sx * yi];
-          N += val;
-          mx += xi * val;
-          my += yi * val;
-        }
-      }
-      if (N == sx * sy) {
-        biffAddf(TEN,
-                 "%s: saw only non-zero pixels in nthresh[%u]; "
-                 "DWI hreshold too low?",
-                 me, (unsigned int)ni);
-        return 1;
-      }
-      if (N) {
-        /* there were non-zero pixels */
-        mx /= N;
-        my /= N;
-        cx = sx / 2.0;
-        cy = sy / 2.0;
-        /* ------ find M02, M11, M20 */
-        M02 = M11 = M20 = 0.0;
-        for (yi = 0; yi < sy; yi++) {
-          for (xi = 0; xi < sx; xi++) {
-            val = thr[xi + sx * yi];
-            x = xi - cx;
-            y = yi - cy;
-            M02 += y * y * val;
-            M11 += x * y * val;
-            M20 += x * x * val;
-          }
-        }
-        M02 /= N;
-        M11 /= N;
-        M20 /= N;
-        /* ------ set output */
-        mom[MEAN_X] = mx;
-        mom[MEAN_Y] = my;
-        mom[M_02] = M02;
-        mom[M_11] = M11;
-        mom[M_20] = M20;
-      } else {
-        /* there were no non-zero pixels */
-        mom[MEAN_X] = 0;
-        mom[MEAN_Y] = 0;
-        mom[M_02] = 0;
-        mom[M_11] = 0;
-        mom[M_20] = 0;
-      }
-      thr += sx * sy;
-      mom += 5;
-    }
+  }
+  stage.nmom = nmom;
+  stage.nthresh = nthresh;
+  jobs.stage = &stage;
+  jobs.job = _tenEpiRegMomentsJob;
+  jobs.useBiff = AIR_FALSE;
+  jobs.jobNum = ninLen;
+  jobs.verbStride = !!verb;
+  if (verb) {
+    fprintf(stderr, "%s:\n            ", me);
+    fflush(stderr);
+  }
+  if (_tenEpiRegJobsRun(&jobs, threadNum)) {
+    biffAddf(TEN, "%s: trouble with threads", me);
+    return 1;
+  }
+  if (jobs.failed) {
+    biffAddf(TEN,
+             "%s: saw only non-zero pixels in nthresh[%u]; "
+             "DWI hreshold too low?",
+             me, jobs.failJob);
+    return 1;
   }
   if (verb) {
     fprintf(stderr, "done\n");
@@ -553,192 +787,183 @@ _tenEpiRegPairXforms(Nrrd *npxfr, Nrrd **nmom, int ninLen) {
 #define SCALE 3
 #define TRAN  4
 
-static int /* Biff: 1 */
-_tenEpiRegEstimHST(Nrrd *nhst, Nrrd *npxfr, int ninLen, Nrrd *ngrad) {
-  static const char me[] = "_tenEpiRegEstimHST";
-  double *hst, *grad, *mat, *vec, *ans, *pxfr, *gA, *gB;
-  int A, B, npairs, ri;
-  Nrrd **nmat, *nvec, **ninv, *nans;
-  airArray *mop;
-  int order;
-  unsigned int z, sz;
-
-  order = 1;
+typedef struct {
+  Nrrd *nhst, *npxfr, *ngrad;
+  int ninLen, order;
+  Nrrd **nmat, **ninv, **nvec, **nans; /* per-task buffers */
+} _tenEpiRegEstimHSTStage;
 
-  sz = AIR_UINT(npxfr->axis[1].size);
-  npairs = ninLen * (ninLen - 1);
-
-  mop = airMopNew();
-  nmat = (Nrrd **)calloc(sz, sizeof(Nrrd *));
-  ninv = (Nrrd **)calloc(sz, sizeof(Nrrd *));
-  airMopAdd(mop, nmat, airFree, airMopAlways);
-  airMopAdd(mop, ninv, airFree, airMopAlways);
-  for (z = 0; z < sz; z++) {
-    airMopAdd(mop, nmat[z] = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-    if (nrrdMaybeAlloc_va(nmat[z], nrrdTypeDouble, 2, AIR_SIZE_T((1 == order ? 3 : 9)),
-                          AIR_SIZE_T(npairs))) {
-      biffMovef(TEN, NRRD, "%s: couldn't allocate fitting matrices", me);
-      airMopError(mop);
-      return 1;
-    }
-    airMopAdd(mop, ninv[z] = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  }
-  airMopAdd(mop, nvec = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  airMopAdd(mop, nans = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  if (nrrdMaybeAlloc_va(nhst, nrrdTypeDouble, 2, AIR_SIZE_T((1 == order ? 9 : 27)),
-                        AIR_SIZE_T(sz))
-      || nrrdMaybeAlloc_va(nvec, nrrdTypeDouble, 2, AIR_SIZE_T(1), AIR_SIZE_T(npairs))) {
-    biffMovef(TEN, NRRD, "%s: couldn't allocate HST nrrd", me);
-    airMopError(mop);
-    return 1;
-  }
-  nrrdAxisInfoSet_va(nhst, nrrdAxisInfoLabel,
-                     (1 == order ? "Hx,Hy,Hz,Sx,Sy,Sz,Tx,Ty,Tz" : "HST parms"), "z");
-
-  /* ------ per-slice: compute model fitting matrix and its pseudo-inverse */
-  grad = (double *)(ngrad->data);
-  for (z = 0; z < sz; z++) {
-    hst = (double *)(nhst->data) + (1 == order ? 9 : 27) * z;
-    mat = (double *)(nmat[z]->data);
-    ri = 0;
-    for (A = 0; A < ninLen; A++) {
-      for (B = 0; B < ninLen; B++) {
-        if (A == B) continue;
-        pxfr = (double *)(npxfr->data) + 0 + 5 * (z + sz * (A + ninLen * B));
-        gA = grad + 0 + 3 * A;
-        gB = grad + 0 + 3 * B;
-        /* clang-format off */
-        if (1 == order) {
-          ELL_3V_SET(mat + 3*ri,
-                     gB[0] - pxfr[SCALE]*gA[0],
-                     gB[1] - pxfr[SCALE]*gA[1],
-                     gB[2] - pxfr[SCALE]*gA[2]);
-        } else {
-          ELL_9V_SET(mat + 9*ri,
-                     gB[0] - pxfr[SCALE]*gA[0],
-                     gB[1] - pxfr[SCALE]*gA[1],
-                     gB[2] - pxfr[SCALE]*gA[2],
-                     gB[0]*gB[0]*gB[0] - pxfr[SCALE]*gA[0]*gA[0]*gA[0],
-                     gB[1]*gB[1]*gB[1] - pxfr[SCALE]*gA[1]*gA[1]*gA[1],
-                     gB[2]*gB[2]*gB[2] - pxfr[SCALE]*gA[2]*gA[2]*gA[2],
-                     gB[0]*gB[1]*gB[2] - pxfr[SCALE]*gA[0]*gA[1]*gA[2],
-                     1, 1);
-          /*
-                     gB[0]*gB[1] - pxfr[SCALE]*gA[0]*gA[1],
-                     gB[0]*gB[2] - pxfr[SCALE]*gA[0]*gA[2],
-                     gB[1]*gB[2] - pxfr[SCALE]*gA[1]*gA[2]);
-                     */
-        }
-        ri += 1;
-        /* clang-format on */
-      }
-    }
-    if (nrrdHasNonExist(nmat[z])) {
-      /* as happens if there were zero slices in the segmentation output */
+/*
+** estimates HST for slice z.  Returns 1 if the fitting matrix couldn't be
+** pseudo-inverted, or 2, 3, 4 for trouble estimating H, S, T respectively
+*/
+static int
+_tenEpiRegEstimHSTJob(void *_stage, unsigned int ti, unsigned int z) {
+  _tenEpiRegEstimHSTStage *stage;
+  double *hst, *grad, *mat, *vec, *ans, *pxfr, *gA, *gB;
+  int A, B, ri, order, ninLen;
+  unsigned int sz, pi, plen;
+  Nrrd *nmat, *ninv, *nvec, *nans;
+
+  stage = AIR_CAST(_tenEpiRegEstimHSTStage *, _stage);
+  nmat = stage->nmat[ti];
+  ninv = stage->ninv[ti];
+  nvec = stage->nvec[ti];
+  nans = stage->nans[ti];
+  order = stage->order;
+  ninLen = stage->ninLen;
+  sz = AIR_UINT(stage->npxfr->axis[1].size);
+  plen = (1 == order ? 3 : 9);
+  grad = (double *)(stage->ngrad->data);
+  hst = (double *)(stage->nhst->data) + 3 * plen * z;
+
+  /* ------ compute model fitting matrix and its pseudo-inverse */
+  mat = (double *)(nmat->data);
+  ri = 0;
+  for (A = 0; A < ninLen; A++) {
+    for (B = 0; B < ninLen; B++) {
+      if (A == B) continue;
+      pxfr = (double *)(stage->npxfr->data) + 0 + 5 * (z + sz * (A + ninLen * B));
+      gA = grad + 0 + 3 * A;
+      gB = grad + 0 + 3 * B;
+      /* clang-format off */
       if (1 == order) {
-        ELL_3V_SET(hst + 0 * 3, 0, 0, 0);
-        ELL_3V_SET(hst + 1 * 3, 0, 0, 0);
-        ELL_3V_SET(hst + 2 * 3, 0, 0, 0);
+        ELL_3V_SET(mat + 3*ri,
+                   gB[0] - pxfr[SCALE]*gA[0],
+                   gB[1] - pxfr[SCALE]*gA[1],
+                   gB[2] - pxfr[SCALE]*gA[2]);
       } else {
-        ELL_9V_SET(hst + 0 * 9, 0, 0, 0, 0, 0, 0, 0, 0, 0);
-        ELL_9V_SET(hst + 1 * 9, 0, 0, 0, 0, 0, 0, 0, 0, 0);
-        ELL_9V_SET(hst + 2 * 9, 0, 0, 0, 0, 0, 0, 0, 0, 0);
-      }
-    } else {
-      if (ell_Nm_pseudo_inv(ninv[z], nmat[z])) {
-        biffMovef(TEN, ELL, "%s: trouble estimating model (slice %d)", me, z);
-        airMopError(mop);
-        return 1;
+        ELL_9V_SET(mat + 9*ri,
+                   gB[0] - pxfr[SCALE]*gA[0],
+                   gB[1] - pxfr[SCALE]*gA[1],
+                   gB[2] - pxfr[SCALE]*gA[2],
+                   gB[0]*gB[0]*gB[0] - pxfr[SCALE]*gA[0]*gA[0]*gA[0],
+                   gB[1]*gB[1]*gB[1] - pxfr[SCALE]*gA[1]*gA[1]*gA[1],
+                   gB[2]*gB[2]*gB[2] - pxfr[SCALE]*gA[2]*gA[2]*gA[2],
+                   gB[0]*gB[1]*gB[2] - pxfr[SCALE]*gA[0]*gA[1]*gA[2],
+                   1, 1);
+        /*
+                   gB[0]*gB[1] - pxfr[SCALE]*gA[0]*gA[1],
+                   gB[0]*gB[2] - pxfr[SCALE]*gA[0]*gA[2],
+                   gB[1]*gB[2] - pxfr[SCALE]*gA[1]*gA[2]);
+                   */
       }
+      ri += 1;
+      /* clang-format on */
     }
   }
-  vec = (double *)(nvec->data);
-
-  /* ------ find Sx, Sy, Sz per slice */
-  for (z = 0; z < sz; z++) {
-    if (nrrdHasNonExist(nmat[z])) {
-      /* we've already zero-ed out this row in the HST nrrd */
-      continue;
-    }
-    hst = (double *)(nhst->data) + (1 == order ? 9 : 27) * z;
-    ri = 0;
-    for (A = 0; A < ninLen; A++) {
-      for (B = 0; B < ninLen; B++) {
-        if (A == B) continue;
-        pxfr = (double *)(npxfr->data) + 0 + 5 * (z + sz * (A + ninLen * B));
-        vec[ri] = pxfr[SCALE] - 1;
-        ri += 1;
-      }
-    }
-    if (ell_Nm_mul(nans, ninv[z], nvec)) {
-      biffMovef(TEN, ELL, "%s: trouble estimating model (slice %d): Sx, Sy, Sz", me, z);
-      airMopError(mop);
-      return 1;
-    }
-    ans = (double *)(nans->data);
-    if (1 == order) {
-      ELL_3V_COPY(hst + 1 * 3, ans);
-    } else {
-      ELL_9V_COPY(hst + 1 * 9, ans);
+  if (nrrdHasNonExist(nmat)) {
+    /* as happens if there were zero slices in the segmentation output */
+    for (pi = 0; pi < 3 * plen; pi++) {
+      hst[pi] = 0;
     }
+    return 0;
+  }
+  if (ell_Nm_pseudo_inv(ninv, nmat)) {
+    return 1;
   }
 
-  /* ------ find Hx, Hy, Hz per slice */
-  for (z = 0; z < sz; z++) {
-    if (nrrdHasNonExist(nmat[z])) {
-      /* we've already zero-ed out this row in the HST nrrd */
-      continue;
-    }
-    hst = (double *)(nhst->data) + (1 == order ? 9 : 27) * z;
+  /* ------ find (pi=0) Hx, Hy, Hz, (pi=1) Sx, Sy, Sz, (pi=2) Tx, Ty, Tz */
+  vec = (double *)(nvec->data);
+  for (pi = 0; pi < 3; pi++) {
     ri = 0;
     for (A = 0; A < ninLen; A++) {
       for (B = 0; B < ninLen; B++) {
         if (A == B) continue;
-        pxfr = (double *)(npxfr->data) + 0 + 5 * (z + sz * (A + ninLen * B));
-        vec[ri] = pxfr[SHEAR];
+        pxfr = (double *)(stage->npxfr->data) + 0 + 5 * (z + sz * (A + ninLen * B));
+        /* SHEAR, SCALE, TRAN are consecutive; scale is relative to 1 */
+        vec[ri] = pxfr[SHEAR + pi] - (SCALE == SHEAR + pi ? 1 : 0);
         ri += 1;
       }
     }
-    if (ell_Nm_mul(nans, ninv[z], nvec)) {
-      biffAddf(TEN, ELL, "%s: trouble estimating model (slice %d): Hx, Hy, Hz", me, z);
-      airMopError(mop);
-      return 1;
+    if (ell_Nm_mul(nans, ninv, nvec)) {
+      return 2 + AIR_INT(pi);
     }
     ans = (double *)(nans->data);
     if (1 == order) {
-      ELL_3V_COPY(hst + 0 * 3, ans);
+      ELL_3V_COPY(hst + pi * 3, ans);
     } else {
-      ELL_9V_COPY(hst + 0 * 9, ans);
+      ELL_9V_COPY(hst + pi * 9, ans);
     }
   }
+  return 0;
+}
 
-  /* ------ find Tx, Ty, Tz per slice */
-  for (z = 0; z < sz; z++) {
-    if (nrrdHasNonExist(nmat[z])) {
-      /* we've already zero-ed out this row in the HST nrrd */
-      continue;
-    }
-    hst = (double *)(nhst->data) + (1 == order ? 9 : 27) * z;
-    ri = 0;
-    for (A = 0; A < ninLen; A++) {
-      for (B = 0; B < ninLen; B++) {
-        if (A == B) continue;
-        pxfr = (double *)(npxfr->data) + 0 + 5 * (z + sz * (A + ninLen * B));
-        vec[ri] = pxfr[TRAN];
-        ri += 1;
-      }
-    }
-    if (ell_Nm_mul(nans, ninv[z], nvec)) {
-      biffMovef(TEN, ELL, "%s: trouble estimating model (slice %d): Tx, Ty, Tz", me, z);
+static int /* Biff: 1 */
+_tenEpiRegEstimHST(Nrrd *nhst, Nrrd *npxfr, int ninLen, Nrrd *ngrad,
+                   unsigned int threadNum) {
+  static const char me[] = "_tenEpiRegEstimHST";
+  static const char *const hstStr[3] = {"Hx, Hy, Hz", "Sx, Sy, Sz", "Tx, Ty, Tz"};
+  _tenEpiRegEstimHSTStage stage;
+  _tenEpiRegJobs jobs;
+  airArray *mop;
+  int npairs;
+  unsigned int ti, taskNum, sz;
+
+  stage.order = 1;
+  sz = AIR_UINT(npxfr->axis[1].size);
+  npairs = ninLen * (ninLen - 1);
+
+  mop = airMopNew();
+  taskNum = _tenJobsThreadNum(threadNum, sz);
+  stage.nmat = AIR_CALLOC(4 * taskNum, Nrrd *);
+  if (!stage.nmat) {
+    biffAddf(TEN, "%s: couldn't allocate buffers for %u tasks", me, taskNum);
+    airMopError(mop);
+    return 1;
+  }
+  airMopAdd(mop, stage.nmat, airFree, airMopAlways);
+  stage.ninv = stage.nmat + taskNum;
+  stage.nvec = stage.ninv + taskNum;
+  stage.nans = stage.nvec + taskNum;
+  for (ti = 0; ti < taskNum; ti++) {
+    airMopAdd(mop, stage.nmat[ti] = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
+    airMopAdd(mop, stage.ninv[ti] = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
+    airMopAdd(mop, stage.nvec[ti] = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
+    airMopAdd(mop, stage.nans[ti] = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
+    if (nrrdMaybeAlloc_va(stage.nmat[ti], nrrdTypeDouble, 2,
+                          AIR_SIZE_T((1 == stage.order ? 3 : 9)), AIR_SIZE_T(npairs))
+        || nrrdMaybeAlloc_va(stage.nvec[ti], nrrdTypeDouble, 2, AIR_SIZE_T(1),
+                             AIR_SIZE_T(npairs))) {
+      biffMovef(TEN, NRRD, "%s: couldn't allocate fitting matrices", me);
       airMopError(mop);
       return 1;
     }
-    ans = (double *)(nans->data);
-    if (1 == order) {
-      ELL_3V_COPY(hst + 2 * 3, ans);
+  }
+  if (nrrdMaybeAlloc_va(nhst, nrrdTypeDouble, 2,
+                        AIR_SIZE_T((1 == stage.order ? 9 : 27)), AIR_SIZE_T(sz))) {
+    biffMovef(TEN, NRRD, "%s: couldn't allocate HST nrrd", me);
+    airMopError(mop);
+    return 1;
+  }
+  nrrdAxisInfoSet_va(nhst, nrrdAxisInfoLabel,
+                     (1 == stage.order ? "Hx,Hy,Hz,Sx,Sy,Sz,Tx,Ty,Tz" : "HST parms"),
+                     "z");
+
+  /* ------ per-slice fitting */
+  stage.nhst = nhst;
+  stage.npxfr = npxfr;
+  stage.ngrad = ngrad;
+  stage.ninLen = ninLen;
+  jobs.stage = &stage;
+  jobs.job = _tenEpiRegEstimHSTJob;
+  jobs.useBiff = AIR_TRUE; /* ell_Nm_pseudo_inv, ell_Nm_mul */
+  jobs.jobNum = sz;
+  jobs.verbStride = 0;
+  if (_tenEpiRegJobsRun(&jobs, threadNum)) {
+    biffAddf(TEN, "%s: trouble with threads", me);
+    airMopError(mop);
+    return 1;
+  }
+  if (jobs.failed) {
+    if (1 == jobs.failRet) {
+      biffMovef(TEN, ELL, "%s: trouble estimating model (slice %u)", me, jobs.failJob);
     } else {
-      ELL_9V_COPY(hst + 2 * 9, ans);
+      biffMovef(TEN, ELL, "%s: trouble estimating model (slice %u): %s", me,
+                jobs.failJob, hstStr[jobs.failRet - 2]);
     }
+    airMopError(mop);
+    return 1;
   }
 
   airMopOkay(mop);
@@ -909,32 +1134,32 @@ _tenEpiRegGetHST(double *hhP, double *ssP, double *ttP, int reference, int ni, i
 /*
 ** _tenEpiRegSliceWarp
 **
-** Apply [hh,ss,tt] transform to nin, putting results in nout, but with
-** some trickiness:
-** - nwght and nidx are already allocated to the the weights (type float)
-**   and indices for resampling nin with "kern" and "kparm"
+** Apply [hh,ss,tt] transform to slice zi of nout, with some trickiness:
 ** - nout is already allocated to the correct size and type
-** - nin is type float, but output must be type nout->type
-** - nin is been transposed to have the resampled axis fastest in memory,
-**   but nout output will not be transposed
+** - slc is the input slice, as floats, and transposed to have the
+**   resampled (Y) axis fastest in memory; but nout is not transposed
+** - nwght and nidx are already allocated to the the weights (type float)
+**   and indices for resampling one column of slc with "kern" and "kparm"
 */
 static int
-_tenEpiRegSliceWarp(Nrrd *nout, Nrrd *nin, Nrrd *nwght, Nrrd *nidx,
-                    const NrrdKernel *kern, double *kparm, double hh, double ss,
-                    double tt, double cx, double cy) {
-  float *wght, *in, pp, pf, tmp;
+_tenEpiRegSliceWarp(Nrrd *nout, unsigned int zi, const float *slc, Nrrd *nwght,
+                    Nrrd *nidx, const NrrdKernel *kern, double *kparm, double hh,
+                    double ss, double tt, double cx, double cy) {
+  float *wght, pp, pf, tmp;
+  const float *in;
   int *idx;
   unsigned int supp;
-  size_t sx, sy, xi, yi, pb, pi;
+  size_t sx, sy, xi, yi, pb, pi, outOff;
   double (*ins)(void *, size_t, double), (*clamp)(double);
 
-  sy = nin->axis[0].size;
-  sx = nin->axis[1].size;
+  sx = nout->axis[0].size;
+  sy = nout->axis[1].size;
+  outOff = sx * sy * zi;
   supp = AIR_UINT(kern->support(kparm));
   ins = nrrdDInsert[nout->type];
   clamp = nrrdDClamp[nout->type];
 
-  in = AIR_CAST(float *, nin->data);
+  in = slc;
   for (xi = 0; xi < sx; xi++) {
     idx = AIR_CAST(int *, nidx->data);
     wght = AIR_CAST(float *, nwght->data);
@@ -958,7 +1183,7 @@ _tenEpiRegSliceWarp(Nrrd *nout, Nrrd *nin, Nrrd *nwght, Nrrd *nidx,
       for (pi = 0; pi < 2 * supp; pi++) {
         tmp += in[idx[pi]] * wght[pi];
       }
-      ins(nout->data, xi + sx * yi, clamp(ss * tmp));
+      ins(nout->data, outOff + xi + sx * yi, clamp(ss * tmp));
       idx += 2 * supp;
       wght += 2 * supp;
     }
@@ -968,69 +1193,151 @@ _tenEpiRegSliceWarp(Nrrd *nout, Nrrd *nin, Nrrd *nwght, Nrrd *nidx,
   return 0;
 }
 
+typedef struct {
+  Nrrd **ndone, **nin, *npxfr, *nhst, *ngrad;
+  unsigned int sz;
+  int reference;
+  const NrrdKernel *kern;
+  double *kparm, cx, cy;
+  float **slc;          /* per-task transposed input slice */
+  Nrrd **nwght, **nidx; /* per-task resampling weights and indices */
+} _tenEpiRegWarpStage;
+
+static int
+_tenEpiRegWarpCopyJob(void *_stage, unsigned int ti, unsigned int ni) {
+  _tenEpiRegWarpStage *stage;
+
+  AIR_UNUSED(ti);
+  stage = AIR_CAST(_tenEpiRegWarpStage *, _stage);
+  return nrrdCopy(stage->ndone[ni], stage->nin[ni]);
+}
+
+/* job jj is slice jj % sz of DWI jj / sz */
+static int
+_tenEpiRegWarpJob(void *_stage, unsigned int ti, unsigned int jj) {
+  _tenEpiRegWarpStage *stage;
+  const Nrrd *nin;
+  float *slc, (*lup)(const void *, size_t);
+  unsigned int ni, zi;
+  size_t sx, sy, xi, yi, inOff;
+  double hh, ss, tt;
+
+  stage = AIR_CAST(_tenEpiRegWarpStage *, _stage);
+  ni = jj / stage->sz;
+  zi = jj % stage->sz;
+  nin = stage->nin[ni];
+  slc = stage->slc[ti];
+  sx = nin->axis[0].size;
+  sy = nin->axis[1].size;
+  inOff = sx * sy * zi;
+  lup = nrrdFLookup[nin->type];
+  for (yi = 0; yi < sy; yi++) {
+    for (xi = 0; xi < sx; xi++) {
+      slc[yi + sy * xi] = lup(nin->data, inOff + xi + sx * yi);
+    }
+  }
+  return (_tenEpiRegGetHST(&hh, &ss, &tt, stage->reference, AIR_INT(ni), AIR_INT(zi),
+                           stage->npxfr, stage->nhst, stage->ngrad)
+          || _tenEpiRegSliceWarp(stage->ndone[ni], zi, slc, stage->nwght[ti],
+                                 stage->nidx[ti], stage->kern, stage->kparm, hh, ss, tt,
+                                 stage->cx, stage->cy));
+}
+
 /*
 ** _tenEpiRegWarp()
 **
+** resamples all the slices of all the DWIs, as one set of jobs, so that
+** the threads are kept busy even when there are fewer DWIs than threads
 */
 static int /* Biff: 1 */
 _tenEpiRegWarp(Nrrd **ndone, Nrrd *npxfr, Nrrd *nhst, Nrrd *ngrad, Nrrd **nin,
                unsigned int ninLen, int reference, const NrrdKernel *kern, double *kparm,
-               int verb) {
+               unsigned int threadNum, int verb) {
   static const char me[] = "_tenEpiRegWarp";
-  Nrrd *ntmp, *nfin, *nslcA, *nslcB, *nwght, *nidx;
+  _tenEpiRegWarpStage stage;
+  _tenEpiRegJobs jobs;
   airArray *mop;
-  unsigned int sx, sy, sz, ni, zi, supp;
-  double hh, ss, tt, cx, cy;
+  unsigned int sx, sy, ti, taskNum, supp;
 
   mop = airMopNew();
-  airMopAdd(mop, ntmp = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  airMopAdd(mop, nfin = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  airMopAdd(mop, nslcA = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  airMopAdd(mop, nslcB = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  airMopAdd(mop, nwght = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  airMopAdd(mop, nidx = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-
-  if (verb) {
-    fprintf(stderr, "%s:\n            ", me);
-    fflush(stderr);
-  }
   sx = AIR_UINT(nin[0]->axis[0].size);
   sy = AIR_UINT(nin[0]->axis[1].size);
-  sz = AIR_UINT(nin[0]->axis[2].size);
-  cx = sx / 2.0;
-  cy = sy / 2.0;
+  stage.ndone = ndone;
+  stage.nin = nin;
+  stage.npxfr = npxfr;
+  stage.nhst = nhst;
+  stage.ngrad = ngrad;
+  stage.sz = AIR_UINT(nin[0]->axis[2].size);
+  stage.reference = reference;
+  stage.kern = kern;
+  stage.kparm = kparm;
+  stage.cx = sx / 2.0;
+  stage.cy = sy / 2.0;
   /* HEY this is effectively a floor(); why not say that? */
   supp = AIR_UINT(kern->support(kparm));
-  if (nrrdMaybeAlloc_va(nwght, nrrdTypeFloat, 2, AIR_SIZE_T(2 * supp), AIR_SIZE_T(sy))
-      || nrrdMaybeAlloc_va(nidx, nrrdTypeInt, 2, AIR_SIZE_T(2 * supp), AIR_SIZE_T(sy))) {
-    biffMovef(TEN, NRRD, "%s: trouble allocating buffers", me);
+  taskNum = _tenJobsThreadNum(threadNum, ninLen * stage.sz);
+  stage.slc = AIR_CALLOC(taskNum, float *);
+  stage.nwght = AIR_CALLOC(2 * taskNum, Nrrd *);
+  if (!(stage.slc && stage.nwght)) {
+    biffAddf(TEN, "%s: couldn't allocate buffers for %u tasks", me, taskNum);
     airMopError(mop);
     return 1;
   }
-  for (ni = 0; ni < ninLen; ni++) {
-    if (verb) {
-      fprintf(stderr, "%2d ", ni);
-      fflush(stderr);
-    }
-    if (nrrdCopy(ndone[ni], nin[ni])
-        || ((!ni) && nrrdSlice(nslcB, ndone[ni], 2, 0)) /* only when 0==ni */
-        || nrrdAxesSwap(ntmp, nin[ni], 0, 1) || nrrdConvert(nfin, ntmp, nrrdTypeFloat)) {
-      biffMovef(TEN, NRRD, "%s: trouble prepping at ni=%d", me, ni);
+  airMopAdd(mop, stage.slc, airFree, airMopAlways);
+  airMopAdd(mop, stage.nwght, airFree, airMopAlways);
+  stage.nidx = stage.nwght + taskNum;
+  for (ti = 0; ti < taskNum; ti++) {
+    stage.slc[ti] = AIR_CALLOC(AIR_SIZE_T(sx) * sy, float);
+    airMopAdd(mop, stage.slc[ti], airFree, airMopAlways);
+    airMopAdd(mop, stage.nwght[ti] = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
+    airMopAdd(mop, stage.nidx[ti] = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
+    if (!stage.slc[ti]
+        || nrrdMaybeAlloc_va(stage.nwght[ti], nrrdTypeFloat, 2, AIR_SIZE_T(2 * supp),
+                             AIR_SIZE_T(sy))
+        || nrrdMaybeAlloc_va(stage.nidx[ti], nrrdTypeInt, 2, AIR_SIZE_T(2 * supp),
+                             AIR_SIZE_T(sy))) {
+      biffMovef(TEN, NRRD, "%s: trouble allocating buffers", me);
       airMopError(mop);
       return 1;
     }
-    for (zi = 0; zi < sz; zi++) {
-      if (_tenEpiRegGetHST(&hh, &ss, &tt, reference, ni, zi, npxfr, nhst, ngrad)
-          || nrrdSlice(nslcA, nfin, 2, zi)
-          || _tenEpiRegSliceWarp(nslcB, nslcA, nwght, nidx, kern, kparm, hh, ss, tt, cx,
-                                 cy)
-          || nrrdSplice(ndone[ni], ndone[ni], nslcB, 2, zi)) {
-        biffMovef(TEN, NRRD, "%s: trouble on slice %d if ni=%d", me, zi, ni);
-        /* because the _tenEpiReg calls above don't use biff */
-        airMopError(mop);
-        return 1;
-      }
-    }
+  }
+
+  /* the outputs start as copies of the inputs, to get the right type,
+     size, and meta-data */
+  jobs.stage = &stage;
+  jobs.job = _tenEpiRegWarpCopyJob;
+  jobs.useBiff = AIR_TRUE; /* nrrdCopy */
+  jobs.jobNum = ninLen;
+  jobs.verbStride = 0;
+  if (_tenEpiRegJobsRun(&jobs, threadNum)) {
+    biffAddf(TEN, "%s: trouble with threads", me);
+    airMopError(mop);
+    return 1;
+  }
+  if (jobs.failed) {
+    biffMovef(TEN, NRRD, "%s: trouble prepping at ni=%u", me, jobs.failJob);
+    airMopError(mop);
+    return 1;
+  }
+  jobs.job = _tenEpiRegWarpJob;
+  jobs.useBiff = AIR_FALSE;
+  jobs.jobNum = ninLen * stage.sz;
+  jobs.verbStride = verb ? stage.sz : 0;
+  if (verb) {
+    fprintf(stderr, "%s:\n            ", me);
+    fflush(stderr);
+  }
+  if (_tenEpiRegJobsRun(&jobs, threadNum)) {
+    biffAddf(TEN, "%s: trouble with threads", me);
+    airMopError(mop);
+    return 1;
+  }
+  if (jobs.failed) {
+    /* neither _tenEpiRegGetHST nor _tenEpiRegSliceWarp use biff */
+    biffAddf(TEN, "%s: trouble on slice %u if ni=%u", me, jobs.failJob % stage.sz,
+             jobs.failJob / stage.sz);
+    airMopError(mop);
+    return 1;
   }
   if (verb) {
     fprintf(stderr, "done\n");
@@ -1040,11 +1347,20 @@ _tenEpiRegWarp(Nrrd **ndone, Nrrd *npxfr, Nrrd *nhst, Nrrd *ngrad, Nrrd **nin,
   return 0;
 }
 
+/*
+******** tenEpiRegister3D
+**
+** corrects the eddy-current distortion of the DWIs nin[0] through
+** nin[ninLen-1], putting the results in nout[].  Thresholding, moments,
+** and the final resampling, which work on one DWI (or one slice) at a time
+** without needing biff, are done by threadNum threads; the output does not
+** depend on threadNum.
+*/
 int /* Biff: 1 */
 tenEpiRegister3D(Nrrd **nout, Nrrd **nin, unsigned int ninLen, Nrrd *_ngrad,
                  int reference, double bwX, double bwY, double fitFrac, double DWthr,
-                 int doCC, const NrrdKernel *kern, double *kparm, int progress,
-                 int verbose) {
+                 int doCC, const NrrdKernel *kern, double *kparm,
+                 unsigned int threadNum, int progress, int verbose) {
   static const char me[] = "tenEpiRegister3D";
   airArray *mop;
   Nrrd **nbuffA, **nbuffB, *npxfr, *nhst, *ngrad;
@@ -1088,7 +1404,7 @@ tenEpiRegister3D(Nrrd **nout, Nrrd **nin, unsigned int ninLen, Nrrd *_ngrad,
   }
 
   /* ------ blur */
-  if (_tenEpiRegBlur(nbuffA, nin, ninLen, bwX, bwY, verbose)) {
+  if (_tenEpiRegBlur(nbuffA, nin, ninLen, bwX, bwY, threadNum, verbose)) {
     biffAddf(TEN, "%s: trouble %s", me, (bwX || bwY) ? "blurring" : "copying");
     airMopError(mop);
     return 1;
@@ -1100,7 +1416,8 @@ tenEpiRegister3D(Nrrd **nout, Nrrd **nin, unsigned int ninLen, Nrrd *_ngrad,
   }
 
   /* ------ threshold */
-  if (_tenEpiRegThreshold(nbuffB, nbuffA, ninLen, DWthr, verbose, progress, 1.5)) {
+  if (_tenEpiRegThreshold(nbuffB, nbuffA, ninLen, DWthr, threadNum, verbose, progress,
+                          1.5)) {
     biffAddf(TEN, "%s: trouble thresholding", me);
     airMopError(mop);
     return 1;
@@ -1114,7 +1431,7 @@ tenEpiRegister3D(Nrrd **nout, Nrrd **nin, unsigned int ninLen, Nrrd *_ngrad,
 
   /* ------ connected components */
   if (doCC) {
-    if (_tenEpiRegCC(nbuffB, ninLen, 1, verbose)) {
+    if (_tenEpiRegCC(nbuffB, ninLen, 1, threadNum, verbose)) {
       biffAddf(TEN, "%s: trouble doing connected components", me);
       airMopError(mop);
       return 1;
@@ -1128,7 +1445,7 @@ tenEpiRegister3D(Nrrd **nout, Nrrd **nin, unsigned int ninLen, Nrrd *_ngrad,
   }
 
   /* ------ moments */
-  if (_tenEpiRegMoments(nbuffA, nbuffB, ninLen, verbose)) {
+  if (_tenEpiRegMoments(nbuffA, nbuffB, ninLen, threadNum, verbose)) {
     biffAddf(TEN, "%s: trouble finding moments", me);
     airMopError(mop);
     return 1;
@@ -1152,7 +1469,7 @@ tenEpiRegister3D(Nrrd **nout, Nrrd **nin, unsigned int ninLen, Nrrd *_ngrad,
 
   if (-1 == reference) {
     /* ------ HST estimation */
-    if (_tenEpiRegEstimHST(nhst, npxfr, ninLen, ngrad)) {
+    if (_tenEpiRegEstimHST(nhst, npxfr, ninLen, ngrad, threadNum)) {
       biffAddf(TEN, "%s: trouble estimating HST", me);
       airMopError(mop);
       return 1;
@@ -1179,7 +1496,7 @@ tenEpiRegister3D(Nrrd **nout, Nrrd **nin, unsigned int ninLen, Nrrd *_ngrad,
 
   /* ------ doit */
   if (_tenEpiRegWarp(nout, npxfr, nhst, ngrad, nin, ninLen, reference, kern, kparm,
-                     verbose)) {
+                     threadNum, verbose)) {
     biffAddf(TEN, "%s: trouble performing final registration", me);
     airMopError(mop);
     return 1;
@@ -1194,7 +1511,8 @@ tenEpiRegister3D(Nrrd **nout, Nrrd **nin, unsigned int ninLen, Nrrd *_ngrad,
 int /* Biff: 1 */
 tenEpiRegister4D(Nrrd *_nout, Nrrd *_nin, Nrrd *_ngrad, int reference, double bwX,
                  double bwY, double fitFrac, double DWthr, int doCC,
-                 const NrrdKernel *kern, double *kparm, int progress, int verbose) {
+                 const NrrdKernel *kern, double *kparm, unsigned int threadNum,
+                 int progress, int verbose) {
   static const char me[] = "tenEpiRegister4D";
   unsigned int ninIdx, ninLen, dwiAx, rangeAxisNum, rangeAxisIdx[NRRD_DIM_MAX];
   int dwiIdx;
@@ -1304,8 +1622,8 @@ tenEpiRegister4D(Nrrd *_nout, Nrrd *_nin, Nrrd *_ngrad, int reference, double bw
   /* HEY: HACK! */
   ndwigrad->axis[1].size = 1 + AIR_UINT(dwiIdx);
   if (tenEpiRegister3D(ndwiOut, ndwi, AIR_UINT(ndwigrad->axis[1].size), ndwigrad,
-                       reference, bwX, bwY, fitFrac, DWthr, doCC, kern, kparm, progress,
-                       verbose)) {
+                       reference, bwX, bwY, fitFrac, DWthr, doCC, kern, kparm, threadNum,
+                       progress, verbose)) {
     biffAddf(TEN, "%s: trouble", me);
     airMopError(mop);
     return 1;
@@ -34,15 +34,40 @@ http://www.mathworks.com/access/helpdesk/help/toolbox/curvefit/ch_fitt5.html#405
 
 */
 
+/*
+** LLS and WLS estimation is done for blocks of (up to) this many samples
+** at once (see _tenEstimate1TensorBlock_LLS), which lets the inner loops run
+** over the samples of a block rather than over the values of one sample
+*/
+#define _TEN_ESTIMATE_BLOCK 16
+
+/* per-sample length of tec->block, as divided up by _tenEstimateBlockBuffSet */
+#define _TEN_ESTIMATE_BLOCK_LEN(dwiNum) (3 * (dwiNum) + 28 + 7 + 2 + 6)
+
+/*
+** the arrays in tec->block, for a block of num samples.  All of them are
+** sample-fastest: array entry ii for sample vi is at [vi + num*ii]
+*/
+typedef struct {
+  double *dwi,  /* dwiNum input values */
+    *lval,      /* dwiNum (log) values that are linear in the model */
+    *wght,      /* dwiNum weights, for WLS */
+    *mat,       /* upper triangle (by rows) of the WLS normal equation matrix */
+    *vec,       /* 7 normal equation right-hand side, and then solution */
+    *B0,        /* 1 known B0 (input) or estimated B0 (output) */
+    *logB0,     /* 1 log of known B0 */
+    *ten;       /* 6 tensor coefficients (output) */
+} _tenEstimateBlockBuff;
+
 /* ---------------------------------------------- */
 
-static int /* Biff: 1 */
-_tenGaussian(double *retP, double m, double t, double s) {
+static int /* Biff: maybe:1:1 */
+_tenGaussian(int useBiff, double *retP, double m, double t, double s) {
   static const char me[] = "_tenGaussian";
   double diff, earg, den;
 
   if (!retP) {
-    biffAddf(TEN, "%s: got NULL pointer", me);
+    biffMaybeAddf(useBiff, TEN, "%s: got NULL pointer", me);
     return 1;
   }
   diff = (m - t) / 2;
@@ -50,18 +75,18 @@ _tenGaussian(double *retP, double m, double t, double s) {
   den = s * sqrt(2 * AIR_PI);
   *retP = exp(earg) / den;
   if (!AIR_EXISTS(*retP)) {
-    biffAddf(TEN, "%s: m=%g, t=%g, s=%g", me, m, t, s);
-    biffAddf(TEN, "%s: diff=%g, earg=%g, den=%g", me, diff, earg, den);
-    biffAddf(TEN, "%s: failed with ret = exp(%g)/%g = %g/%g = %g", me, earg, den,
-             exp(earg), den, *retP);
+    biffMaybeAddf(useBiff, TEN, "%s: m=%g, t=%g, s=%g", me, m, t, s);
+    biffMaybeAddf(useBiff, TEN, "%s: diff=%g, earg=%g, den=%g", me, diff, earg, den);
+    biffMaybeAddf(useBiff, TEN, "%s: failed with ret = exp(%g)/%g = %g/%g = %g", me,
+                  earg, den, exp(earg), den, *retP);
     *retP = AIR_NAN;
     return 1;
   }
   return 0;
 }
 
-static int /* Biff: 1 */
-_tenRicianTrue(double *retP,
+static int /* Biff: maybe:1:1 */
+_tenRicianTrue(int useBiff, double *retP,
                double m /* measured */,
                double t /* truth */,
                double s /* sigma */) {
@@ -69,7 +94,7 @@ _tenRicianTrue(double *retP,
   double mos, moss, mos2, tos2, tos, ss, earg, barg;
 
   if (!retP) {
-    biffAddf(TEN, "%s: got NULL pointer", me);
+    biffMaybeAddf(useBiff, TEN, "%s: got NULL pointer", me);
     return 1;
   }
 
@@ -84,49 +109,53 @@ _tenRicianTrue(double *retP,
   *retP = exp(earg) * airBesselI0(barg) * moss;
 
   if (!AIR_EXISTS(*retP)) {
-    biffAddf(TEN, "%s: m=%g, t=%g, s=%g", me, m, t, s);
-    biffAddf(TEN, "%s: mos=%g, moss=%g, tos=%g, ss=%g", me, mos, moss, tos, ss);
-    biffAddf(TEN, "%s: mos2=%g, tos2=%g, earg=%g, barg=%g", me, mos2, tos2, earg, barg);
-    biffAddf(TEN, "%s: failed: ret=exp(%g)*bessi0(%g)*%g = %g * %g * %g = %g", me, earg,
-             barg, moss, exp(earg), airBesselI0(barg), moss, *retP);
+    biffMaybeAddf(useBiff, TEN, "%s: m=%g, t=%g, s=%g", me, m, t, s);
+    biffMaybeAddf(useBiff, TEN, "%s: mos=%g, moss=%g, tos=%g, ss=%g", me, mos, moss, tos,
+                  ss);
+    biffMaybeAddf(useBiff, TEN, "%s: mos2=%g, tos2=%g, earg=%g, barg=%g", me, mos2, tos2,
+                  earg, barg);
+    biffMaybeAddf(useBiff, TEN,
+                  "%s: failed: ret=exp(%g)*bessi0(%g)*%g = %g * %g * %g = %g", me, earg,
+                  barg, moss, exp(earg), airBesselI0(barg), moss, *retP);
     *retP = AIR_NAN;
     return 1;
   }
   return 0;
 }
 
-static int /* Biff: 1 */
-_tenRicianSafe(double *retP, double m, double t, double s) {
+static int /* Biff: maybe:1:1 */
+_tenRicianSafe(int useBiff, double *retP, double m, double t, double s) {
   static const char me[] = "_tenRicianSafe";
   double diff, ric, gau, neer = 10, faar = 20;
   int E;
 
   if (!retP) {
-    biffAddf(TEN, "%s: got NULL pointer", me);
+    biffMaybeAddf(useBiff, TEN, "%s: got NULL pointer", me);
     return 1;
   }
 
   diff = AIR_ABS(m - t) / s;
   E = 0;
   if (diff < neer) {
-    if (!E) E |= _tenRicianTrue(retP, m, t, s);
+    if (!E) E |= _tenRicianTrue(useBiff, retP, m, t, s);
   } else if (diff < faar) {
-    if (!E) E |= _tenRicianTrue(&ric, m, t, s);
-    if (!E) E |= _tenGaussian(&gau, m, t, s);
+    if (!E) E |= _tenRicianTrue(useBiff, &ric, m, t, s);
+    if (!E) E |= _tenGaussian(useBiff, &gau, m, t, s);
     if (!E) *retP = AIR_AFFINE(neer, diff, faar, ric, gau);
   } else {
-    if (!E) E |= _tenGaussian(retP, m, t, s);
+    if (!E) E |= _tenGaussian(useBiff, retP, m, t, s);
   }
   if (E) {
-    biffAddf(TEN, "%s: failed with m=%g, t=%g, s=%g -> diff=%g", me, m, t, s, diff);
+    biffMaybeAddf(useBiff, TEN, "%s: failed with m=%g, t=%g, s=%g -> diff=%g", me, m, t,
+                  s, diff);
     *retP = AIR_NAN;
     return 1;
   }
   return 0;
 }
 
-static int /* Biff: 1 */
-_tenRician(double *retP,
+static int /* Biff: maybe:1:1 */
+_tenRician(int useBiff, double *retP,
            double m /* measured */,
            double t /* truth */,
            double s /* sigma */) {
@@ -135,11 +164,11 @@ _tenRician(double *retP,
   int E;
 
   if (!retP) {
-    biffAddf(TEN, "%s: got NULL pointer", me);
+    biffMaybeAddf(useBiff, TEN, "%s: got NULL pointer", me);
     return 1;
   }
   if (!(m >= 0 && t >= 0 && s > 0)) {
-    biffAddf(TEN, "%s: got bad args: m=%g t=%g s=%g", me, m, t, s);
+    biffMaybeAddf(useBiff, TEN, "%s: got bad args: m=%g t=%g s=%g", me, m, t, s);
     *retP = AIR_NAN;
     return 1;
   }
@@ -147,16 +176,17 @@ _tenRician(double *retP,
   tos = t / s;
   E = 0;
   if (tos < loSignal) {
-    if (!E) E |= _tenRicianSafe(retP, m, t, s);
+    if (!E) E |= _tenRicianSafe(useBiff, retP, m, t, s);
   } else if (tos < hiSignal) {
-    if (!E) E |= _tenRicianSafe(&ric, m, t, s);
-    if (!E) E |= _tenGaussian(&gau, m, t, s);
+    if (!E) E |= _tenRicianSafe(useBiff, &ric, m, t, s);
+    if (!E) E |= _tenGaussian(useBiff, &gau, m, t, s);
     if (!E) *retP = AIR_AFFINE(loSignal, tos, hiSignal, ric, gau);
   } else {
-    if (!E) E |= _tenGaussian(retP, m, t, s);
+    if (!E) E |= _tenGaussian(useBiff, retP, m, t, s);
   }
   if (E) {
-    biffAddf(TEN, "%s: failed with m=%g, t=%g, s=%g -> tos=%g", me, m, t, s, tos);
+    biffMaybeAddf(useBiff, TEN, "%s: failed with m=%g, t=%g, s=%g -> tos=%g", me, m, t,
+                  s, tos);
     *retP = AIR_NAN;
     return 1;
   }
@@ -223,6 +253,8 @@ tenEstimateContextNew() {
     tec->verbose = 0;
     tec->progress = AIR_FALSE;
     tec->WLSIterNum = 3;
+    tec->threadNum = 1;
+    tec->useBiff = AIR_TRUE;
     for (fi = flagUnknown + 1; fi < flagLast; fi++) {
       tec->flag[fi] = AIR_FALSE;
     }
@@ -237,6 +269,7 @@ tenEstimateContextNew() {
     tec->allTmp = NULL;
     tec->dwiTmp = NULL;
     tec->dwi = NULL;
+    tec->block = NULL;
     tec->skipLut = NULL;
     _tenEstimateOutputInit(tec);
   }
@@ -256,6 +289,7 @@ tenEstimateContextNix(tenEstimateContext *tec) {
     airFree(tec->allTmp);
     airFree(tec->dwiTmp);
     airFree(tec->dwi);
+    airFree(tec->block);
     airFree(tec->skipLut);
     airFree(tec);
   }
@@ -279,6 +313,22 @@ tenEstimateNegEvalShiftSet(tenEstimateContext *tec, int doit) {
   return;
 }
 
+/*
+******** tenEstimateThreadNumSet
+**
+** sets the number of threads that tenEstimate1TensorVolume4D() uses; with
+** more than one, each additional thread estimates with its own copy of tec.
+** Zero is treated as one.
+*/
+void
+tenEstimateThreadNumSet(tenEstimateContext *tec, unsigned int threadNum) {
+
+  if (tec) {
+    tec->threadNum = AIR_MAX(1, threadNum);
+  }
+  return;
+}
+
 int /* Biff: 1 */
 tenEstimateMethodSet(tenEstimateContext *tec, int estimateMethod) {
   static const char me[] = "tenEstimateMethodSet";
@@ -680,9 +730,12 @@ _tenEstimateDwiAllocUpdate(tenEstimateContext *tec) {
   if (tec->flag[flagDwiNum]) {
     airFree(tec->dwi);
     airFree(tec->dwiTmp);
+    airFree(tec->block);
     tec->dwi = AIR_CAST(double *, calloc(tec->dwiNum, sizeof(double)));
     tec->dwiTmp = AIR_CAST(double *, calloc(tec->dwiNum, sizeof(double)));
-    if (!(tec->dwi && tec->dwiTmp)) {
+    tec->block = AIR_CALLOC(_TEN_ESTIMATE_BLOCK * _TEN_ESTIMATE_BLOCK_LEN(tec->dwiNum),
+                            double);
+    if (!(tec->dwi && tec->dwiTmp && tec->block)) {
       biffAddf(TEN, "%s: couldn't allocate DWI arrays (length %u)", me, tec->dwiNum);
       return 1;
     }
@@ -920,12 +973,12 @@ _tenEstimate1TensorSimulateSingle(tenEstimateContext *tec, double sigma, double
   const double *bmat;
 
   if (!(ten && ten)) {
-    biffAddf(TEN, "%s: got NULL pointer", me);
+    biffMaybeAddf(tec->useBiff, TEN, "%s: got NULL pointer", me);
     return 1;
   }
   if (!(AIR_EXISTS(sigma) && sigma >= 0 && AIR_EXISTS(bValue) && AIR_EXISTS(B0))) {
-    biffAddf(TEN, "%s: got bad args: sigma %g, bValue %g, B0 %g\n", me, sigma, bValue,
-             B0);
+    biffMaybeAddf(tec->useBiff, TEN, "%s: got bad args: sigma %g, bValue %g, B0 %g\n",
+                  me, sigma, bValue, B0);
     return 1;
   }
 
@@ -1158,66 +1211,351 @@ tenEstimate1TensorSimulateVolume(tenEstimateContext *tec, Nrrd *ndwi, double sig
   return 0;
 }
 
+static void
+_tenEstimateBlockBuffSet(_tenEstimateBlockBuff *bb, tenEstimateContext *tec,
+                         unsigned int num) {
+
+  bb->dwi = tec->block;
+  bb->lval = bb->dwi + num * tec->dwiNum;
+  bb->wght = bb->lval + num * tec->dwiNum;
+  bb->mat = bb->wght + num * tec->dwiNum;
+  bb->vec = bb->mat + num * 28;
+  bb->B0 = bb->vec + num * 7;
+  bb->logB0 = bb->B0 + num;
+  bb->ten = bb->logB0 + num;
+  return;
+}
+
 /*
-** sets:
-** tec->ten[1..6]
-** tec->B0, if tec->estimateB0
+** from bb->dwi (and bb->B0, if !tec->estimateB0), sets bb->lval
 */
-static int /* Biff: 1 */
-_tenEstimate1Tensor_LLS(tenEstimateContext *tec) {
-  static const char me[] = "_tenEstimate1Tensor_LLS";
-  double *emat, tmp, logB0;
-  unsigned int ii, jj;
+static void
+_tenEstimateBlockLvalSet(tenEstimateContext *tec, _tenEstimateBlockBuff *bb,
+                         unsigned int num) {
+  unsigned int ii, vi;
+  double tmp, *dwi, *lval;
 
-  emat = AIR_CAST(double *, tec->nemat->data);
-  if (tec->verbose) {
-    fprintf(stderr, "!%s: estimateB0 = %d\n", me, tec->estimateB0);
+  if (!tec->estimateB0) {
+    for (vi = 0; vi < num; vi++) {
+      bb->logB0[vi] = log(AIR_MAX(tec->valueMin, bb->B0[vi]));
+    }
   }
-  if (tec->estimateB0) {
-    for (ii = 0; ii < tec->allNum; ii++) {
-      tmp = AIR_MAX(tec->valueMin, tec->all[ii]);
-      tec->allTmp[ii] = -log(tmp) / (tec->bValue);
+  for (ii = 0; ii < tec->dwiNum; ii++) {
+    dwi = bb->dwi + num * ii;
+    lval = bb->lval + num * ii;
+    if (tec->estimateB0) {
+      for (vi = 0; vi < num; vi++) {
+        tmp = AIR_MAX(tec->valueMin, dwi[vi]);
+        lval[vi] = -log(tmp) / (tec->bValue);
+      }
+    } else {
+      for (vi = 0; vi < num; vi++) {
+        tmp = AIR_MAX(tec->valueMin, dwi[vi]);
+        lval[vi] = (bb->logB0[vi] - log(tmp)) / (tec->bValue);
+      }
+    }
+  }
+  return;
+}
+
+/*
+** from the model parameters in bb->vec, sets bb->ten and (if
+** tec->estimateB0) bb->B0.  Returns 1 + the index of the first sample for
+** which this doesn't give existent values, or 0 if all is well
+*/
+static unsigned int
+_tenEstimateBlockSolutionSet(tenEstimateContext *tec, _tenEstimateBlockBuff *bb,
+                             unsigned int num) {
+  unsigned int jj, vi, bad;
+
+  for (jj = 0; jj < 6; jj++) {
+    for (vi = 0; vi < num; vi++) {
+      bb->ten[vi + num * jj] = bb->vec[vi + num * jj];
+    }
+  }
+  if (!tec->estimateB0) {
+    return 0;
+  }
+  for (vi = 0; vi < num; vi++) {
+    bb->B0[vi] = exp(tec->bValue * bb->vec[vi + num * 6]);
+    bb->B0[vi] = AIR_MIN(FLT_MAX, bb->B0[vi]);
+  }
+  bad = 0;
+  for (vi = 0; !bad && vi < num; vi++) {
+    for (jj = 0; jj < 6; jj++) {
+      if (!AIR_EXISTS(bb->ten[vi + num * jj])) {
+        bad = 1 + vi;
+      }
+    }
+    if (!AIR_EXISTS(bb->B0[vi])) {
+      bad = 1 + vi;
+    }
+  }
+  return bad;
+}
+
+/*
+******** _tenEstimate1TensorBlock_LLS
+**
+** linear least-squares estimation for a block of num samples, from
+** bb->dwi[] and (if !tec->estimateB0) bb->B0[], setting bb->ten[] and (if
+** tec->estimateB0) bb->B0[].  All samples use the same estimation matrix
+** tec->nemat, so this is a matrix-matrix product; per sample, the
+** arithmetic is the same as with num == 1.  Returns 1 + the index of the
+** first sample for which this failed, or 0 if all is well.
+*/
+static unsigned int
+_tenEstimate1TensorBlock_LLS(tenEstimateContext *tec, unsigned int num) {
+  static const char me[] = "_tenEstimate1TensorBlock_LLS";
+  _tenEstimateBlockBuff bb;
+  const double *emat;
+  double ee, *acc, *lval;
+  unsigned int ii, jj, vi, rowNum, bad;
+
+  _tenEstimateBlockBuffSet(&bb, tec, num);
+  _tenEstimateBlockLvalSet(tec, &bb, num);
+  emat = AIR_CAST(const double *, tec->nemat->data);
+  rowNum = tec->estimateB0 ? 7 : 6;
+  for (jj = 0; jj < rowNum; jj++) {
+    acc = bb.vec + num * jj;
+    for (vi = 0; vi < num; vi++) {
+      acc[vi] = 0;
     }
-    for (jj = 0; jj < 7; jj++) {
-      tmp = 0;
-      for (ii = 0; ii < tec->allNum; ii++) {
-        tmp += emat[ii + tec->allNum * jj] * tec->allTmp[ii];
+    for (ii = 0; ii < tec->dwiNum; ii++) {
+      ee = emat[ii + tec->dwiNum * jj];
+      lval = bb.lval + num * ii;
+      for (vi = 0; vi < num; vi++) {
+        acc[vi] += ee * lval[vi];
       }
-      if (jj < 6) {
-        tec->ten[1 + jj] = tmp;
-        if (!AIR_EXISTS(tmp)) {
-          biffAddf(TEN, "%s: estimated non-existent tensor coef (%u) %g", me, jj, tmp);
-          return 1;
+    }
+  }
+  if ((bad = _tenEstimateBlockSolutionSet(tec, &bb, num))) {
+    biffMaybeAddf(tec->useBiff, TEN,
+                  "%s: estimated non-existent tensor or B0 (sample %u of %u)", me,
+                  bad - 1, num);
+  }
+  return bad;
+}
+
+/* index into the upper triangle, stored by rows, of a PP-by-PP matrix */
+#define _TEN_ESTIMATE_UT(PP, rr, cc) ((rr) * (2 * (PP) - (rr) + 1) / 2 + (cc) - (rr))
+
+/*
+** solves, for each sample in the block, the WLS normal equations
+** (B^T W B) x = B^T W y, with B from tec->nbmat, W from bb->wght, and y from
+** bb->lval, by Cholesky decomposition.  Everything is done for all samples
+** at once.  Returns 1 + the index of first sample for which B^T W B wasn't
+** positive definite, or 0 if all is well.
+*/
+static unsigned int
+_tenEstimateBlockWghtSolve(tenEstimateContext *tec, _tenEstimateBlockBuff *bb,
+                           unsigned int num) {
+  const double *bmat, *brow, *ua, *ub;
+  double *mat, *vec, *wght, *lval, *mrc, *xx, aa, piv;
+  unsigned int PP, ii, rr, cc, kk, vi, bad;
+
+  PP = tec->estimateB0 ? 7 : 6;
+  mat = bb->mat;
+  vec = bb->vec;
+  for (vi = 0; vi < num * PP * (PP + 1) / 2; vi++) {
+    mat[vi] = 0;
+  }
+  for (vi = 0; vi < num * PP; vi++) {
+    vec[vi] = 0;
+  }
+  bmat = AIR_CAST(const double *, tec->nbmat->data);
+  for (ii = 0; ii < tec->dwiNum; ii++) {
+    brow = bmat + PP * ii;
+    wght = bb->wght + num * ii;
+    lval = bb->lval + num * ii;
+    for (rr = 0; rr < PP; rr++) {
+      xx = vec + num * rr;
+      for (vi = 0; vi < num; vi++) {
+        xx[vi] += brow[rr] * wght[vi] * lval[vi];
+      }
+      for (cc = rr; cc < PP; cc++) {
+        aa = brow[rr] * brow[cc];
+        mrc = mat + num * _TEN_ESTIMATE_UT(PP, rr, cc);
+        for (vi = 0; vi < num; vi++) {
+          mrc[vi] += aa * wght[vi];
+        }
+      }
+    }
+  }
+  /* in-place Cholesky decomposition U^T U of the matrix */
+  bad = 0;
+  for (rr = 0; rr < PP; rr++) {
+    for (cc = rr; cc < PP; cc++) {
+      mrc = mat + num * _TEN_ESTIMATE_UT(PP, rr, cc);
+      for (kk = 0; kk < rr; kk++) {
+        ua = mat + num * _TEN_ESTIMATE_UT(PP, kk, rr);
+        ub = mat + num * _TEN_ESTIMATE_UT(PP, kk, cc);
+        for (vi = 0; vi < num; vi++) {
+          mrc[vi] -= ua[vi] * ub[vi];
+        }
+      }
+      if (cc == rr) {
+        for (vi = 0; vi < num; vi++) {
+          piv = mrc[vi];
+          if (!bad && !(piv > 0)) {
+            bad = 1 + vi;
+          }
+          mrc[vi] = sqrt(piv);
         }
       } else {
-        /* we're on seventh row, for finding B0 */
-        tec->estimatedB0 = exp(tec->bValue * tmp);
-        tec->estimatedB0 = AIR_MIN(FLT_MAX, tec->estimatedB0);
-        if (!AIR_EXISTS(tec->estimatedB0)) {
-          biffAddf(TEN, "%s: estimated non-existent B0 %g (b=%g, tmp=%g)", me,
-                   tec->estimatedB0, tec->bValue, tmp);
-          return 1;
+        ua = mat + num * _TEN_ESTIMATE_UT(PP, rr, rr);
+        for (vi = 0; vi < num; vi++) {
+          mrc[vi] /= ua[vi];
         }
       }
     }
-  } else {
-    logB0 = log(AIR_MAX(tec->valueMin, tec->knownB0));
-    for (ii = 0; ii < tec->dwiNum; ii++) {
-      tmp = AIR_MAX(tec->valueMin, tec->dwi[ii]);
-      tec->dwiTmp[ii] = (logB0 - log(tmp)) / (tec->bValue);
+  }
+  if (bad) {
+    return bad;
+  }
+  /* solve U^T z = vec, then U x = z */
+  for (rr = 0; rr < PP; rr++) {
+    xx = vec + num * rr;
+    for (kk = 0; kk < rr; kk++) {
+      ua = mat + num * _TEN_ESTIMATE_UT(PP, kk, rr);
+      ub = vec + num * kk;
+      for (vi = 0; vi < num; vi++) {
+        xx[vi] -= ua[vi] * ub[vi];
+      }
     }
-    for (jj = 0; jj < 6; jj++) {
-      tmp = 0;
-      for (ii = 0; ii < tec->dwiNum; ii++) {
-        tmp += emat[ii + tec->dwiNum * jj] * tec->dwiTmp[ii];
-        if (tec->verbose > 5) {
-          fprintf(stderr, "%s: emat[(%u,%u)=%u]*dwi[%u] = %g*%g --> %g\n", me, ii, jj,
-                  ii + tec->dwiNum * jj, ii, emat[ii + tec->dwiNum * jj],
-                  tec->dwiTmp[ii], tmp);
+    mrc = mat + num * _TEN_ESTIMATE_UT(PP, rr, rr);
+    for (vi = 0; vi < num; vi++) {
+      xx[vi] /= mrc[vi];
+    }
+  }
+  for (rr = PP; rr > 0; rr--) {
+    xx = vec + num * (rr - 1);
+    for (cc = rr; cc < PP; cc++) {
+      ua = mat + num * _TEN_ESTIMATE_UT(PP, rr - 1, cc);
+      ub = vec + num * cc;
+      for (vi = 0; vi < num; vi++) {
+        xx[vi] -= ua[vi] * ub[vi];
+      }
+    }
+    mrc = mat + num * _TEN_ESTIMATE_UT(PP, rr - 1, rr - 1);
+    for (vi = 0; vi < num; vi++) {
+      xx[vi] /= mrc[vi];
+    }
+  }
+  return 0;
+}
+
+/*
+******** _tenEstimate1TensorBlock_WLS
+**
+** weighted least-squares estimation for a block of num samples, with the
+** same inputs and outputs as _tenEstimate1TensorBlock_LLS.  Each sample
+** has its own weights, and so its own (7x7 or 6x6) normal equations, which
+** are set up and solved for all samples at once.  The weights are first
+** the squared DWIs, and then for tec->WLSIterNum iterations the squared
+** DWIs simulated from the last estimate.
+*/
+static unsigned int
+_tenEstimate1TensorBlock_WLS(tenEstimateContext *tec, unsigned int num) {
+  static const char me[] = "_tenEstimate1TensorBlock_WLS";
+  _tenEstimateBlockBuff bb;
+  const double *bmat, *brow;
+  double *dwi, *wght, *sum, vv;
+  unsigned int ii, jj, vi, iter, bad;
+
+  _tenEstimateBlockBuffSet(&bb, tec, num);
+  _tenEstimateBlockLvalSet(tec, &bb, num);
+  /* initial weights: squared DWIs, normalized to unit sum */
+  sum = bb.vec; /* used for the sums until solving */
+  for (vi = 0; vi < num; vi++) {
+    sum[vi] = 0;
+  }
+  for (ii = 0; ii < tec->dwiNum; ii++) {
+    dwi = bb.dwi + num * ii;
+    wght = bb.wght + num * ii;
+    for (vi = 0; vi < num; vi++) {
+      wght[vi] = AIR_MAX(tec->valueMin, dwi[vi]);
+      wght[vi] *= wght[vi];
+      sum[vi] += wght[vi];
+    }
+  }
+  for (ii = 0; ii < tec->dwiNum; ii++) {
+    wght = bb.wght + num * ii;
+    for (vi = 0; vi < num; vi++) {
+      wght[vi] /= sum[vi];
+    }
+  }
+  if ((bad = _tenEstimateBlockWghtSolve(tec, &bb, num))) {
+    biffMaybeAddf(tec->useBiff, TEN, "%s: initial weighted fit failed (sample %u of %u)",
+                  me, bad - 1, num);
+    return bad;
+  }
+  if ((bad = _tenEstimateBlockSolutionSet(tec, &bb, num))) {
+    biffMaybeAddf(tec->useBiff, TEN,
+                  "%s: estimated non-existent tensor or B0 (sample %u of %u)", me,
+                  bad - 1, num);
+    return bad;
+  }
+  bmat = AIR_CAST(const double *, tec->nbmat->data);
+  for (iter = 0; iter < tec->WLSIterNum; iter++) {
+    /* weights from simulated DWIs, as in _tenEstimate1TensorSimulateSingle */
+    for (ii = 0; ii < tec->dwiNum; ii++) {
+      brow = bmat + tec->nbmat->axis[0].size * ii;
+      wght = bb.wght + num * ii;
+      for (vi = 0; vi < num; vi++) {
+        vv = 0;
+        for (jj = 0; jj < 6; jj++) {
+          vv += brow[jj] * bb.ten[vi + num * jj];
+        }
+        vv = bb.B0[vi] * exp(-tec->bValue * AIR_MAX(0, vv));
+        wght[vi] = AIR_MAX(FLT_MIN, vv * vv);
+      }
+      for (vi = 0; !bad && vi < num; vi++) {
+        if (!AIR_EXISTS(wght[vi])) {
+          bad = 1 + vi;
         }
       }
-      tec->ten[1 + jj] = tmp;
     }
+    if (bad) {
+      biffMaybeAddf(tec->useBiff, TEN,
+                    "%s: bad simulated dwi (iter %u, sample %u of %u)", me, iter,
+                    bad - 1, num);
+      return bad;
+    }
+    if ((bad = _tenEstimateBlockWghtSolve(tec, &bb, num))) {
+      biffMaybeAddf(tec->useBiff, TEN,
+                    "%s: weighted fit failed (iter %u, sample %u of %u)", me, iter,
+                    bad - 1, num);
+      return bad;
+    }
+    _tenEstimateBlockSolutionSet(tec, &bb, num);
+  }
+  return 0;
+}
+
+/*
+** sets:
+** tec->ten[1..6]
+** tec->B0, if tec->estimateB0
+*/
+static int /* Biff: 1 */
+_tenEstimate1Tensor_LLS(tenEstimateContext *tec) {
+  static const char me[] = "_tenEstimate1Tensor_LLS";
+  _tenEstimateBlockBuff bb;
+
+  if (tec->verbose) {
+    fprintf(stderr, "!%s: estimateB0 = %d\n", me, tec->estimateB0);
+  }
+  _tenEstimateBlockBuffSet(&bb, tec, 1);
+  memcpy(bb.dwi, tec->dwi, tec->dwiNum * sizeof(double));
+  bb.B0[0] = tec->knownB0;
+  if (_tenEstimate1TensorBlock_LLS(tec, 1)) {
+    biffMaybeAddf(tec->useBiff, TEN, "%s: trouble", me);
+    return 1;
+  }
+  ELL_6V_COPY(tec->ten + 1, bb.ten);
+  if (tec->estimateB0) {
+    tec->estimatedB0 = bb.B0[0];
   }
   return 0;
 }
@@ -1225,74 +1563,23 @@ _tenEstimate1Tensor_LLS(tenEstimateContext *tec) {
 static int /* Biff: 1 */
 _tenEstimate1Tensor_WLS(tenEstimateContext *tec) {
   static const char me[] = "_tenEstimate1Tensor_WLS";
-  unsigned int dwiIdx, iter;
-  double *wght, dwi, sum;
+  _tenEstimateBlockBuff bb;
 
   if (!tec) {
     biffAddf(TEN, "%s: got NULL pointer", me);
     return 1;
   }
-
-  wght = AIR_CAST(double *, tec->nwght->data);
-  sum = 0;
-  for (dwiIdx = 0; dwiIdx < tec->dwiNum; dwiIdx++) {
-    dwi = tec->dwi[dwiIdx];
-    dwi = AIR_MAX(tec->valueMin, dwi);
-    sum += dwi * dwi;
-  }
-  for (dwiIdx = 0; dwiIdx < tec->dwiNum; dwiIdx++) {
-    dwi = tec->dwi[dwiIdx];
-    dwi = AIR_MAX(tec->valueMin, dwi);
-    wght[dwiIdx + tec->dwiNum * dwiIdx] = dwi * dwi / sum;
-  }
-  if (ell_Nm_wght_pseudo_inv(tec->nemat, tec->nbmat, tec->nwght)) {
-    biffMovef(TEN, ELL, "%s(1): trouble wght-pseudo-inverting %ux%u B-matrix", me,
-              AIR_UINT(tec->nbmat->axis[1].size), AIR_UINT(tec->nbmat->axis[0].size));
-    return 1;
-  }
-  /*
-  nrrdSave("wght.txt", tec->nwght, NULL);
-  nrrdSave("bmat.txt", tec->nbmat, NULL);
-  nrrdSave("emat.txt", tec->nemat, NULL);
-  */
-  if (_tenEstimate1Tensor_LLS(tec)) {
-    biffAddf(TEN, "%s: initial weighted LLS failed", me);
+  _tenEstimateBlockBuffSet(&bb, tec, 1);
+  memcpy(bb.dwi, tec->dwi, tec->dwiNum * sizeof(double));
+  bb.B0[0] = tec->knownB0;
+  if (_tenEstimate1TensorBlock_WLS(tec, 1)) {
+    biffMaybeAddf(tec->useBiff, TEN, "%s: trouble", me);
     return 1;
   }
-
-  for (iter = 0; iter < tec->WLSIterNum; iter++) {
-    /*
-    fprintf(stderr, "!%s: bValue = %g, B0 = %g, ten = %g %g %g %g %g %g\n",
-            me,
-            tec->bValue, (tec->estimateB0 ? tec->estimatedB0 : tec->knownB0),
-            tec->ten[1], tec->ten[2], tec->ten[3],
-            tec->ten[4], tec->ten[5], tec->ten[6]);
-    */
-    if (_tenEstimate1TensorSimulateSingle(tec, 0.0, tec->bValue,
-                                          (tec->estimateB0 ? tec->estimatedB0
-                                                           : tec->knownB0),
-                                          tec->ten)) {
-      biffAddf(TEN, "%s: iter %u", me, iter);
-      return 1;
-    }
-    for (dwiIdx = 0; dwiIdx < tec->dwiNum; dwiIdx++) {
-      dwi = tec->dwiTmp[dwiIdx];
-      if (!AIR_EXISTS(dwi)) {
-        biffAddf(TEN, "%s: bad simulated dwi[%u] == %g (iter %u)", me, dwiIdx, dwi,
-                 iter);
-        return 1;
-      }
-      wght[dwiIdx + tec->dwiNum * dwiIdx] = AIR_MAX(FLT_MIN, dwi * dwi);
-    }
-    if (ell_Nm_wght_pseudo_inv(tec->nemat, tec->nbmat, tec->nwght)) {
-      biffMovef(TEN, ELL, "%s(2): trouble w/ %ux%u B-matrix (iter %u)", me,
-                AIR_UINT(tec->nbmat->axis[1].size), AIR_UINT(tec->nbmat->axis[0].size),
-                iter);
-      return 1;
-    }
-    _tenEstimate1Tensor_LLS(tec);
+  ELL_6V_COPY(tec->ten + 1, bb.ten);
+  if (tec->estimateB0) {
+    tec->estimatedB0 = bb.B0[0];
   }
-
   return 0;
 }
 
@@ -1314,7 +1601,7 @@ _tenEstimate1TensorGradient(tenEstimateContext *tec, double *gradB0P, double gra
 
   if (gradientCB) {
     if (gradientCB(tec, gradB0P, gradTen, B0, ten)) {
-      biffAddf(TEN, "%s: problem with grad callback", me);
+      biffMaybeAddf(tec->useBiff, TEN, "%s: problem with grad callback", me);
       return 1;
     }
   } else {
@@ -1327,11 +1614,22 @@ _tenEstimate1TensorGradient(tenEstimateContext *tec, double *gradB0P, double gra
       backTen[ti + 1] -= epsilon;
       if (badnessCB(tec, &forwBad, B0, forwTen)
           || badnessCB(tec, &backBad, B0, backTen)) {
-        biffAddf(TEN, "%s: trouble at ti=%u", me, ti);
+        biffMaybeAddf(tec->useBiff, TEN, "%s: trouble at ti=%u", me, ti);
         return 1;
       }
       gradTen[ti + 1] = (forwBad - backBad) / (2 * epsilon);
     }
+    /* the descent uses gradB0 even when B0 is known, so it has to be set */
+    if (tec->estimateB0) {
+      if (badnessCB(tec, &forwBad, B0 + epsilon, ten)
+          || badnessCB(tec, &backBad, B0 - epsilon, ten)) {
+        biffMaybeAddf(tec->useBiff, TEN, "%s: trouble with B0", me);
+        return 1;
+      }
+      *gradB0P = (forwBad - backBad) / (2 * epsilon);
+    } else {
+      *gradB0P = 0;
+    }
   }
 
   return 0;
@@ -1364,7 +1662,7 @@ _tenEstimate1TensorDescent(tenEstimateContext *tec,
   if (badnessCB(tec, &badInit, (tec->estimateB0 ? tec->estimatedB0 : tec->knownB0),
                 tec->ten)
       || !AIR_EXISTS(badInit)) {
-    biffAddf(TEN, "%s: problem getting initial bad", me);
+    biffMaybeAddf(tec->useBiff, TEN, "%s: problem getting initial bad", me);
     return 1;
   }
   if (tec->verbose) {
@@ -1377,11 +1675,12 @@ newepsilon:
   if (_tenEstimate1TensorGradient(tec, &gradB0, gradTen,
                                   (tec->estimateB0 ? tec->estimatedB0 : tec->knownB0),
                                   tec->ten, epsilon, gradientCB, badnessCB)) {
-    biffAddf(TEN, "%s: problem getting initial gradient", me);
+    biffMaybeAddf(tec->useBiff, TEN, "%s: problem getting initial gradient", me);
     return 1;
   }
   if (!(AIR_EXISTS(gradB0) || 0 <= TEN_T_NORM(gradTen))) {
-    biffAddf(TEN, "%s: got bad gradB0 %g or zero-norm tensor grad", me, gradB0);
+    biffMaybeAddf(tec->useBiff, TEN, "%s: got bad gradB0 %g or zero-norm tensor grad",
+                  me, gradB0);
     return 1;
   }
   if (tec->verbose) {
@@ -1400,7 +1699,7 @@ newepsilon:
       currB0 = tec->knownB0;
     }
     if (badnessCB(tec, &bad, currB0, currTen) || !AIR_EXISTS(bad)) {
-      biffAddf(TEN, "%s: problem getting badness for stepSize", me);
+      biffMaybeAddf(tec->useBiff, TEN, "%s: problem getting badness for stepSize", me);
       return 1;
     }
     if (tec->verbose) {
@@ -1415,11 +1714,11 @@ newepsilon:
       fprintf(stderr, "%s: re-trying initial step w/ eps %g\n", me, epsilon);
       goto newepsilon;
     } else {
-      biffAddf(TEN, "%s: never found a usable step size", me);
+      biffMaybeAddf(tec->useBiff, TEN, "%s: never found a usable step size", me);
       return 1;
     }
   } else if (tec->verbose) {
-    biffAddf(TEN, "%s: using step size %g\n", me, stepSize);
+    biffMaybeAddf(tec->useBiff, TEN, "%s: using step size %g\n", me, stepSize);
   }
 
   iter = 0;
@@ -1432,7 +1731,7 @@ newepsilon:
       if (_tenEstimate1TensorGradient(tec, &gradB0, gradTen, currB0, currTen,
                                       stepSize / 5, gradientCB, badnessCB)
           || !AIR_EXISTS(gradB0)) {
-        biffAddf(TEN, "%s[%u]: problem getting iter grad", me, iter);
+        biffMaybeAddf(tec->useBiff, TEN, "%s[%u]: problem getting iter grad", me, iter);
         return 1;
       }
     }
@@ -1441,7 +1740,8 @@ newepsilon:
       currB0 -= stepSize * gradB0;
     }
     if (badnessCB(tec, &bad, currB0, currTen) || !AIR_EXISTS(bad)) {
-      biffAddf(TEN, "%s[%u]: problem getting badness during grad", me, iter);
+      biffMaybeAddf(tec->useBiff, TEN, "%s[%u]: problem getting badness during grad", me,
+                    iter);
       return 1;
     }
     if (tec->verbose) {
@@ -1461,7 +1761,8 @@ newepsilon:
     }
   } while (iter < iterMax && (iter < 2 || badDelta < -0.00005));
   if (iter >= iterMax) {
-    biffAddf(TEN, "%s: didn't converge after %u iterations", me, iter);
+    biffMaybeAddf(tec->useBiff, TEN, "%s: didn't converge after %u iterations", me,
+                  iter);
     return 1;
   }
   if (tec->verbose) {
@@ -1511,7 +1812,7 @@ _tenEstimate1Tensor_BadnessNLS(tenEstimateContext *tec, double *retP, double cur
     return 1;
   }
   if (_tenEstimate1TensorSimulateSingle(tec, 0.0, tec->bValue, currB0, currTen)) {
-    biffAddf(TEN, "%s: ", me);
+    biffMaybeAddf(tec->useBiff, TEN, "%s: ", me);
     return 1;
   }
   if (tec->verbose > 2) {
@@ -1540,7 +1841,7 @@ _tenEstimate1Tensor_NLS(tenEstimateContext *tec) {
                                  /* _tenEstimate1Tensor_GradientNLS */
                                  ,
                                  _tenEstimate1Tensor_BadnessNLS)) {
-    biffAddf(TEN, "%s: ", me);
+    biffMaybeAddf(tec->useBiff, TEN, "%s: ", me);
     return 1;
   }
   return 0;
@@ -1595,7 +1896,7 @@ _tenEstimate1Tensor_GradientMLE(tenEstimateContext *tec, double *gradB0P,
     if (!AIR_EXISTS(scl)) {
       TEN_T_SET(gradTen, AIR_NAN, AIR_NAN, AIR_NAN, AIR_NAN, AIR_NAN, AIR_NAN, AIR_NAN);
       *gradB0P = AIR_NAN;
-      biffAddf(TEN, "%s: scl = %g, very sorry", me, scl);
+      biffMaybeAddf(tec->useBiff, TEN, "%s: scl = %g, very sorry", me, scl);
       return 1;
     }
     bmat += tec->nbmat->axis[0].size;
@@ -1624,7 +1925,7 @@ _tenEstimate1Tensor_BadnessMLE(tenEstimateContext *tec, double *retP, double cur
     dot = ELL_6V_DOT(bmat, curt + 1);
     simdwi = currB0 * exp(-(tec->bValue) * dot);
     mesdwi = tec->dwi[dwiIdx];
-    if (!E) E |= _tenRician(&rice, mesdwi, simdwi, tec->sigma);
+    if (!E) E |= _tenRician(tec->useBiff, &rice, mesdwi, simdwi, tec->sigma);
     if (!E) E |= !AIR_EXISTS(rice);
     if (!E) logrice = log(rice + DBL_MIN);
     if (!E) sum += logrice;
@@ -1632,18 +1933,18 @@ _tenEstimate1Tensor_BadnessMLE(tenEstimateContext *tec, double *retP, double cur
     if (!E) bmat += tec->nbmat->axis[0].size;
   }
   if (E) {
-    biffAddf(TEN, "%s[%u]: dot = (%g %g %g %g %g %g).(%g %g %g %g %g %g) = %g", me,
-             dwiIdx, bmat[0], bmat[1], bmat[2], bmat[3], bmat[4], bmat[5], curt[1],
-             curt[2], curt[3], curt[4], curt[5], curt[6], dot);
-    biffAddf(TEN,
-             "%s[%u]: simdwi = %g * exp(-%g * %g) = %g * exp(%g) "
-             "= %g * %g = %g",
-             me, dwiIdx, currB0, tec->bValue, dot, currB0, -(tec->bValue) * dot, currB0,
-             exp(-(tec->bValue) * dot), currB0 * exp(-(tec->bValue) * dot));
-    biffAddf(TEN, "%s[%u]: mesdwi = %g, simdwi = %g, sigma = %g", me, dwiIdx, mesdwi,
-             simdwi, tec->sigma);
-    biffAddf(TEN, "%s[%u]: rice = %g, logrice = %g, sum = %g", me, dwiIdx, rice, logrice,
-             sum);
+    biffMaybeAddf(tec->useBiff, TEN,
+                  "%s[%u]: dot = (%g %g %g %g %g %g).(%g %g %g %g %g %g) = %g", me,
+                  dwiIdx, bmat[0], bmat[1], bmat[2], bmat[3], bmat[4], bmat[5], curt[1],
+                  curt[2], curt[3], curt[4], curt[5], curt[6], dot);
+    biffMaybeAddf(tec->useBiff, TEN,
+                  "%s[%u]: simdwi = %g * exp(-%g * %g) = %g * exp(%g) " "= %g * %g = %g",
+                  me, dwiIdx, currB0, tec->bValue, dot, currB0, -(tec->bValue) * dot,
+                  currB0, exp(-(tec->bValue) * dot), currB0 * exp(-(tec->bValue) * dot));
+    biffMaybeAddf(tec->useBiff, TEN, "%s[%u]: mesdwi = %g, simdwi = %g, sigma = %g", me,
+                  dwiIdx, mesdwi, simdwi, tec->sigma);
+    biffMaybeAddf(tec->useBiff, TEN, "%s[%u]: rice = %g, logrice = %g, sum = %g", me,
+                  dwiIdx, rice, logrice, sum);
     *retP = AIR_NAN;
     return 1;
   }
@@ -1656,7 +1957,7 @@ _tenEstimate1Tensor_MLE(tenEstimateContext *tec) {
   static const char me[] = "_tenEstimate1Tensor_MLE";
 
   if (_tenEstimate1TensorDescent(tec, NULL, _tenEstimate1Tensor_BadnessMLE)) {
-    biffAddf(TEN, "%s: ", me);
+    biffMaybeAddf(tec->useBiff, TEN, "%s: ", me);
     return 1;
   }
 
@@ -1664,17 +1965,55 @@ _tenEstimate1Tensor_MLE(tenEstimateContext *tec) {
 }
 
 /*
-** sets:
-** tec->ten[0] (from tec->conf)
-** tec->time, if tec->recordTime
+** what is done after a successful estimation, sets:
+** tec->ten[1..6], if tec->negEvalShift
 ** tec->errorDwi, if tec->recordErrorDwi
 ** tec->errorLogDwi, if tec->recordErrorLogDwi
 ** tec->likelihoodDwi, if tec->recordLikelihoodDwi
 */
 static int /* Biff: 1 */
+_tenEstimate1TensorFinish(tenEstimateContext *tec) {
+  static const char me[] = "_tenEstimate1TensorFinish";
+  double B0;
+
+  if (tec->negEvalShift) {
+    double eval[3];
+    tenEigensolve_d(eval, NULL, tec->ten);
+    if (eval[2] < 0) {
+      tec->ten[1] += -eval[2];
+      tec->ten[4] += -eval[2];
+      tec->ten[6] += -eval[2];
+    }
+  }
+  if (tec->recordErrorDwi || tec->recordErrorLogDwi) {
+    B0 = tec->estimateB0 ? tec->estimatedB0 : tec->knownB0;
+    if (_tenEstimate1TensorSimulateSingle(tec, 0.0, tec->bValue, B0, tec->ten)) {
+      biffMaybeAddf(tec->useBiff, TEN, "%s: simulation failed", me);
+      return 1;
+    }
+    if (tec->recordErrorDwi) {
+      tec->errorDwi = _tenEstimateErrorDwi(tec);
+    }
+    if (tec->recordErrorLogDwi) {
+      tec->errorLogDwi = _tenEstimateErrorLogDwi(tec);
+    }
+  }
+
+  /* HEY: record likelihood! */
+
+  return 0;
+}
+
+/*
+** sets:
+** tec->ten[0] (from tec->conf)
+** tec->time, if tec->recordTime
+** and whatever _tenEstimate1TensorFinish sets
+*/
+static int /* Biff: 1 */
 _tenEstimate1TensorSingle(tenEstimateContext *tec) {
   static const char me[] = "_tenEstimate1TensorSingle";
-  double time0, B0;
+  double time0;
   int E;
 
   _tenEstimateOutputInit(tec);
@@ -1695,44 +2034,23 @@ _tenEstimate1TensorSingle(tenEstimateContext *tec) {
     E = _tenEstimate1Tensor_MLE(tec);
     break;
   default:
-    biffAddf(TEN, "%s: estimation method %d unimplemented", me, tec->estimate1Method);
+    biffMaybeAddf(tec->useBiff, TEN, "%s: estimation method %d unimplemented", me,
+                  tec->estimate1Method);
     return 1;
   }
   tec->time = tec->recordTime ? airTime() - time0 : 0;
-  if (tec->negEvalShift) {
-    double eval[3];
-    tenEigensolve_d(eval, NULL, tec->ten);
-    if (eval[2] < 0) {
-      tec->ten[1] += -eval[2];
-      tec->ten[4] += -eval[2];
-      tec->ten[6] += -eval[2];
-    }
-  }
   if (E) {
     TEN_T_SET(tec->ten, AIR_NAN, AIR_NAN, AIR_NAN, AIR_NAN, AIR_NAN, AIR_NAN, AIR_NAN);
     if (tec->estimateB0) {
       tec->estimatedB0 = AIR_NAN;
     }
-    biffAddf(TEN, "%s: estimation failed", me);
+    biffMaybeAddf(tec->useBiff, TEN, "%s: estimation failed", me);
     return 1;
   }
-
-  if (tec->recordErrorDwi || tec->recordErrorLogDwi) {
-    B0 = tec->estimateB0 ? tec->estimatedB0 : tec->knownB0;
-    if (_tenEstimate1TensorSimulateSingle(tec, 0.0, tec->bValue, B0, tec->ten)) {
-      biffAddf(TEN, "%s: simulation failed", me);
-      return 1;
-    }
-    if (tec->recordErrorDwi) {
-      tec->errorDwi = _tenEstimateErrorDwi(tec);
-    }
-    if (tec->recordErrorLogDwi) {
-      tec->errorLogDwi = _tenEstimateErrorLogDwi(tec);
-    }
+  if (_tenEstimate1TensorFinish(tec)) {
+    biffMaybeAddf(tec->useBiff, TEN, "%s: trouble finishing", me);
+    return 1;
   }
-
-  /* HEY: record likelihood! */
-
   return 0;
 }
 
@@ -1789,7 +2107,7 @@ tenEstimate1TensorSingle_d(tenEstimateContext *tec, double ten[7], const double
             tec->valueMin);
   }
   if (_tenEstimate1TensorSingle(tec)) {
-    biffAddf(TEN, "%s: ", me);
+    biffMaybeAddf(tec->useBiff, TEN, "%s: ", me);
     return 1;
   }
   if (tec->verbose) {
@@ -1801,16 +2119,243 @@ tenEstimate1TensorSingle_d(tenEstimateContext *tec, double ten[7], const double
   return 0;
 }
 
+/*
+** makes a new context with the same input parameters as tec, updated and
+** ready for estimation, for use by another thread.  The copy refers to the
+** same gradients or B-matrices as tec, so those still belong to the caller.
+*/
+static tenEstimateContext * /* Biff: NULL */
+_tenEstimateContextCopy(const tenEstimateContext *tec) {
+  static const char me[] = "_tenEstimateContextCopy";
+  tenEstimateContext *cpy;
+  unsigned int skipIdx;
+
+  cpy = tenEstimateContextNew();
+  if (!cpy) {
+    biffAddf(TEN, "%s: couldn't allocate new context", me);
+    return NULL;
+  }
+  cpy->bValue = tec->bValue;
+  cpy->valueMin = tec->valueMin;
+  cpy->sigma = tec->sigma;
+  cpy->dwiConfThresh = tec->dwiConfThresh;
+  cpy->dwiConfSoft = tec->dwiConfSoft;
+  cpy->_ngrad = tec->_ngrad;
+  cpy->_nbmat = tec->_nbmat;
+  for (skipIdx = 0; skipIdx < tec->skipListArr->len; skipIdx++) {
+    airArrayLenIncr(cpy->skipListArr, 1);
+    cpy->skipList[0 + 2 * skipIdx] = tec->skipList[0 + 2 * skipIdx];
+    cpy->skipList[1 + 2 * skipIdx] = tec->skipList[1 + 2 * skipIdx];
+  }
+  cpy->simulate = tec->simulate;
+  cpy->estimate1Method = tec->estimate1Method;
+  cpy->estimateB0 = tec->estimateB0;
+  cpy->recordTime = tec->recordTime;
+  cpy->recordErrorDwi = tec->recordErrorDwi;
+  cpy->recordErrorLogDwi = tec->recordErrorLogDwi;
+  cpy->recordLikelihoodDwi = tec->recordLikelihoodDwi;
+  cpy->verbose = tec->verbose;
+  cpy->negEvalShift = tec->negEvalShift;
+  cpy->progress = AIR_FALSE;
+  cpy->WLSIterNum = tec->WLSIterNum;
+  cpy->threadNum = 1;
+  cpy->flag[flagEstimateMethod] = AIR_TRUE;
+  cpy->flag[flagBInfo] = AIR_TRUE;
+  cpy->flag[flagSkipSet] = AIR_TRUE;
+  if (tenEstimateUpdate(cpy)) {
+    biffAddf(TEN, "%s: trouble updating copy", me);
+    tenEstimateContextNix(cpy);
+    return NULL;
+  }
+  return cpy;
+}
+
+/* what all the threads of tenEstimate1TensorVolume4D share */
+typedef struct {
+  const Nrrd *ndwi;
+  Nrrd *nten, *nB0, *nterr;
+  double (*lup)(const void *, size_t), (*ins)(void *v, size_t I, double d);
+  size_t sampleNum;         /* total number of samples */
+  int progress;             /* do progress indication */
+  tenEstimateContext **tec; /* per-task: the caller's context, or a copy of it */
+  double **all;             /* per-task: values of the current sample */
+} _tenEstimateVolume;
+
+/* progress indication, as samples [lo,...) are handed out */
+static void
+_tenEstimateVolumeFetched(void *_vol, size_t lo) {
+  _tenEstimateVolume *vol;
+  char doneStr[20];
+
+  vol = AIR_CAST(_tenEstimateVolume *, _vol);
+  if (vol->progress) {
+    fprintf(stderr, "%s", airDoneStr(0, lo, vol->sampleNum - 1, doneStr));
+    fflush(stderr);
+  }
+  return;
+}
+
+/* puts what tec has just estimated into the outputs for sample II */
+static void
+_tenEstimateVolumeOutput(_tenEstimateVolume *vol, const tenEstimateContext *tec,
+                         size_t II) {
+  size_t sizeTen;
+  unsigned int dd;
+  double val;
+
+  sizeTen = nrrdKindSize(nrrdKind3DMaskedSymMatrix);
+  for (dd = 0; dd < 7; dd++) {
+    vol->ins(vol->nten->data, dd + sizeTen * II, tec->ten[dd]);
+  }
+  if (vol->nB0) {
+    vol->ins(vol->nB0->data, II, (tec->estimateB0 ? tec->estimatedB0 : tec->knownB0));
+  }
+  if (vol->nterr) {
+    /* this works because tenEstimate1TensorVolume4D checked that only
+       one of the tec->record* flags is set */
+    if (tec->recordErrorDwi) {
+      val = tec->errorDwi;
+    } else if (tec->recordErrorLogDwi) {
+      val = tec->errorLogDwi;
+    } else {
+      val = tec->likelihoodDwi;
+    }
+    vol->ins(vol->nterr->data, II, val);
+  }
+  return;
+}
+
+/* gets the values of sample II into vol->all[ti] */
+static void
+_tenEstimateVolumeValuesGet(_tenEstimateVolume *vol, unsigned int ti, size_t II) {
+  unsigned int dd, allNum;
+
+  allNum = vol->tec[ti]->allNum;
+  for (dd = 0; dd < allNum; dd++) {
+    vol->all[ti][dd] = vol->lup(vol->ndwi->data, dd + allNum * II);
+  }
+  return;
+}
+
+/*
+** does LLS or WLS estimation for samples [lo,hi) in task ti,
+** _TEN_ESTIMATE_BLOCK samples at a time.  The outputs are the same as from
+** doing them one at a time with _tenEstimate1TensorSingle.  Returns
+** non-zero (after setting *failP to the sample at which estimation failed)
+** on error.  Doesn't use biff (with vol->tec[ti]->useBiff off)
+*/
+static int
+_tenEstimateVolumeBlocks(_tenEstimateVolume *vol, unsigned int ti, size_t lo,
+                         size_t hi, size_t *failP) {
+  tenEstimateContext *tec;
+  _tenEstimateBlockBuff bb;
+  size_t bl;
+  unsigned int num, vi, ii, jj, bad;
+  double conf[_TEN_ESTIMATE_BLOCK];
+
+  tec = vol->tec[ti];
+  tec->all_f = NULL;
+  tec->all_d = vol->all[ti];
+  for (bl = lo; bl < hi; bl += num) {
+    num = AIR_UINT(AIR_MIN(_TEN_ESTIMATE_BLOCK, hi - bl));
+    _tenEstimateBlockBuffSet(&bb, tec, num);
+    for (vi = 0; vi < num; vi++) {
+      _tenEstimateVolumeValuesGet(vol, ti, bl + vi);
+      _tenEstimateValuesSet(tec);
+      for (ii = 0; ii < tec->dwiNum; ii++) {
+        bb.dwi[vi + num * ii] = tec->dwi[ii];
+      }
+      bb.B0[vi] = tec->knownB0;
+      conf[vi] = tec->conf;
+    }
+    bad = (tenEstimate1MethodLLS == tec->estimate1Method
+             ? _tenEstimate1TensorBlock_LLS(tec, num)
+             : _tenEstimate1TensorBlock_WLS(tec, num));
+    if (bad) {
+      *failP = bl + bad - 1;
+      return 1;
+    }
+    for (vi = 0; vi < num; vi++) {
+      _tenEstimateOutputInit(tec);
+      tec->ten[0] = conf[vi];
+      for (jj = 0; jj < 6; jj++) {
+        tec->ten[1 + jj] = bb.ten[vi + num * jj];
+      }
+      if (tec->estimateB0) {
+        tec->estimatedB0 = bb.B0[vi];
+      } else {
+        tec->knownB0 = bb.B0[vi];
+      }
+      if (tec->recordErrorDwi || tec->recordErrorLogDwi) {
+        /* the errors are measured against the values in tec->dwi */
+        for (ii = 0; ii < tec->dwiNum; ii++) {
+          tec->dwi[ii] = bb.dwi[vi + num * ii];
+        }
+      }
+      if (_tenEstimate1TensorFinish(tec)) {
+        *failP = bl + vi;
+        return 1;
+      }
+      _tenEstimateVolumeOutput(vol, tec, bl + vi);
+    }
+  }
+  return 0;
+}
+
+/* the _tenJobs work function of tenEstimate1TensorVolume4D */
+static int
+_tenEstimateVolumeWork(void *_vol, unsigned int ti, size_t lo, size_t hi,
+                       size_t *failP) {
+  static const char me[] = "_tenEstimateVolumeWork";
+  _tenEstimateVolume *vol;
+  tenEstimateContext *tec;
+  size_t II;
+  double ten[7];
+
+  vol = AIR_CAST(_tenEstimateVolume *, _vol);
+  tec = vol->tec[ti];
+  /* the one-at-a-time path is kept for verbose output, and for timing */
+  if ((tenEstimate1MethodLLS == tec->estimate1Method
+       || tenEstimate1MethodWLS == tec->estimate1Method)
+      && !tec->verbose && !tec->recordTime) {
+    return _tenEstimateVolumeBlocks(vol, ti, lo, hi, failP);
+  }
+  for (II = lo; II < hi; II++) {
+    _tenEstimateVolumeValuesGet(vol, ti, II);
+    if (tec->verbose) {
+      fprintf(stderr, "!%s: hello; II=%u\n", me, AIR_UINT(II));
+    }
+    if (tenEstimate1TensorSingle_d(tec, ten, vol->all[ti])) {
+      *failP = II;
+      return 1;
+    }
+    _tenEstimateVolumeOutput(vol, tec, II);
+  }
+  return 0;
+}
+
+/*
+******** tenEstimate1TensorVolume4D
+**
+** estimates a tensor at every sample of the 4-D DWI volume ndwi (with the
+** values along axis 0), putting them in nten, and optionally the B0 and
+** fitting error in new nrrds *nB0P and *nterrP.  With tec->threadNum > 1
+** (see tenEstimateThreadNumSet) the samples are handed out in small runs
+** to that many threads, each with its own copy of tec; the output is the
+** same as with one thread.
+*/
 int /* Biff: 1 */
 tenEstimate1TensorVolume4D(tenEstimateContext *tec, Nrrd *nten, Nrrd **nB0P,
                            Nrrd **nterrP, const Nrrd *ndwi, int outType) {
   static const char me[] = "tenEstimate1TensorVolume4D";
   char doneStr[20];
-  size_t sizeTen, sizeX, sizeY, sizeZ, NN, II, tick;
-  double *all, ten[7], (*lup)(const void *, size_t), (*ins)(void *v, size_t I, double d);
-  unsigned int dd;
+  size_t sizeTen, sizeX, sizeY, sizeZ, NN, tick;
+  _tenEstimateVolume vol;
+  _tenJobs jobs;
+  unsigned int ti, threadNum;
   airArray *mop;
-  int axmap[4];
+  int axmap[4], useBiff, E;
+  double ten[7];
   char stmp[AIR_STRLEN_SMALL + 1];
 
 #if 0
@@ -1820,7 +2365,7 @@ tenEstimate1TensorVolume4D(tenEstimateContext *tec, Nrrd *nten, Nrrd **nB0P,
   Nrrd *nval;
   for (valIdx=0; valIdx<NUM; valIdx++) {
     arg = AIR_AFFINE(0, valIdx, NUM-1, minVal, maxVal);
-    if (_tenRician(val + valIdx, arg, 1, 1)) {
+    if (_tenRician(AIR_TRUE, val + valIdx, arg, 1, 1)) {
       biffAddf(TEN, "%s: you are out of luck", me);
       return 1;
     }
@@ -1888,14 +2433,6 @@ tenEstimate1TensorVolume4D(tenEstimateContext *tec, Nrrd *nten, Nrrd **nB0P,
   sizeX = ndwi->axis[1].size;
   sizeY = ndwi->axis[2].size;
   sizeZ = ndwi->axis[3].size;
-  all = AIR_CAST(double *, calloc(tec->allNum, sizeof(double)));
-  if (!all) {
-    biffAddf(TEN, "%s: couldn't allocate length %u array", me, tec->allNum);
-    airMopError(mop);
-    return 1;
-  }
-  airMopAdd(mop, all, airFree, airMopAlways);
-
   if (nrrdMaybeAlloc_va(nten, outType, 4, sizeTen, sizeX, sizeY, sizeZ)) {
     biffMovef(TEN, NRRD, "%s: couldn't allocate tensor output", me);
     airMopError(mop);
@@ -1934,56 +2471,86 @@ tenEstimate1TensorVolume4D(tenEstimateContext *tec, Nrrd *nten, Nrrd **nB0P,
     airMopAdd(mop, nterrP, (airMopper)airSetNull, airMopOnError);
   }
   NN = sizeX * sizeY * sizeZ;
-  lup = nrrdDLookup[ndwi->type];
-  ins = nrrdDInsert[outType];
-  if (tec->progress) {
-    fprintf(stderr, "%s:       ", me);
+  threadNum = _tenJobsThreadNum(tec->threadNum, NN);
+  vol.ndwi = ndwi;
+  vol.nten = nten;
+  vol.nB0 = nB0P ? *nB0P : NULL;
+  vol.nterr = nterrP ? *nterrP : NULL;
+  vol.lup = nrrdDLookup[ndwi->type];
+  vol.ins = nrrdDInsert[outType];
+  vol.sampleNum = NN;
+  vol.progress = tec->progress;
+  vol.tec = AIR_CALLOC(threadNum, tenEstimateContext *);
+  vol.all = AIR_CALLOC(threadNum, double *);
+  if (!(vol.tec && vol.all)) {
+    biffAddf(TEN, "%s: couldn't allocate %u tasks", me, threadNum);
+    airFree(vol.tec);
+    airFree(vol.all);
+    airMopError(mop);
+    return 1;
   }
-  fflush(stderr);
-  tick = NN / 200;
-  tick = AIR_MAX(1, tick);
-  for (II = 0; II < NN; II++) {
-    if (tec->progress && 0 == II % tick) {
-      fprintf(stderr, "%s", airDoneStr(0, II, NN - 1, doneStr));
-    }
-    for (dd = 0; dd < tec->allNum; dd++) {
-      all[dd] = lup(ndwi->data, dd + tec->allNum * II);
-    }
-    /*
-    tec->verbose = 10*(II == 42509);
-    */
-    if (tec->verbose) {
-      fprintf(stderr, "!%s: hello; II=%u\n", me, AIR_UINT(II));
-    }
-    if (tenEstimate1TensorSingle_d(tec, ten, all)) {
-      biffAddf(TEN, "%s: failed at sample %s", me, airSprintSize_t(stmp, II));
+  airMopAdd(mop, vol.tec, airFree, airMopAlways);
+  airMopAdd(mop, vol.all, airFree, airMopAlways);
+  for (ti = 0; ti < threadNum; ti++) {
+    vol.all[ti] = AIR_CALLOC(tec->allNum, double);
+    if (!vol.all[ti]) {
+      biffAddf(TEN, "%s: couldn't allocate length %u array", me, tec->allNum);
       airMopError(mop);
       return 1;
     }
-    ins(nten->data, 0 + sizeTen * II, ten[0]);
-    ins(nten->data, 1 + sizeTen * II, ten[1]);
-    ins(nten->data, 2 + sizeTen * II, ten[2]);
-    ins(nten->data, 3 + sizeTen * II, ten[3]);
-    ins(nten->data, 4 + sizeTen * II, ten[4]);
-    ins(nten->data, 5 + sizeTen * II, ten[5]);
-    ins(nten->data, 6 + sizeTen * II, ten[6]);
-    if (nB0P) {
-      ins((*nB0P)->data, II, (tec->estimateB0 ? tec->estimatedB0 : tec->knownB0));
-    }
-    if (nterrP) {
-      /* this works because above we checked that only one of the
-         tec->record* flags is set */
-      if (tec->recordErrorDwi) {
-        ins((*nterrP)->data, II, tec->errorDwi);
-      } else if (tec->recordErrorLogDwi) {
-        ins((*nterrP)->data, II, tec->errorLogDwi);
-      } else if (tec->recordLikelihoodDwi) {
-        ins((*nterrP)->data, II, tec->likelihoodDwi);
+    airMopAdd(mop, vol.all[ti], airFree, airMopAlways);
+    if (!ti) {
+      /* the first task uses tec itself */
+      vol.tec[ti] = tec;
+    } else {
+      if (!(vol.tec[ti] = _tenEstimateContextCopy(tec))) {
+        biffAddf(TEN, "%s: couldn't set up context for thread %u", me, ti);
+        airMopError(mop);
+        return 1;
       }
+      airMopAdd(mop, vol.tec[ti], (airMopper)tenEstimateContextNix, airMopAlways);
     }
   }
+  jobs.data = &vol;
+  jobs.work = _tenEstimateVolumeWork;
+  jobs.fetched = _tenEstimateVolumeFetched;
+  jobs.jobNum = NN;
+  jobs.chunk = NN / (threadNum * _TEN_JOBS_FETCH_PER_THREAD);
+  if (tec->progress) {
+    /* fetches are also when progress is shown, so they should be at least
+       as frequent as the 200 updates that a single thread used to do */
+    tick = NN / 200;
+    jobs.chunk = AIR_MIN(jobs.chunk, tick);
+  }
+  /* whole blocks (see _tenEstimateVolumeBlocks) */
+  jobs.chunk = _TEN_ESTIMATE_BLOCK * AIR_MAX(1, jobs.chunk / _TEN_ESTIMATE_BLOCK);
+  if (tec->progress) {
+    fprintf(stderr, "%s:       ", me);
+  }
+  fflush(stderr);
+  /* the threads stay off biff; the failed sample (if any) is re-done below */
+  useBiff = tec->useBiff;
+  for (ti = 0; ti < threadNum; ti++) {
+    vol.tec[ti]->useBiff = AIR_FALSE;
+  }
+  E = _tenJobsRun(&jobs, threadNum);
+  tec->useBiff = useBiff;
+  if (E) {
+    biffAddf(TEN, "%s: trouble with threads", me);
+    airMopError(mop);
+    return 1;
+  }
+  if (jobs.failed) {
+    /* estimating the first sample that failed again, in this thread and
+       now with biff, says why it failed */
+    _tenEstimateVolumeValuesGet(&vol, 0, jobs.failJob);
+    tenEstimate1TensorSingle_d(tec, ten, vol.all[0]);
+    biffAddf(TEN, "%s: failed at sample %s", me, airSprintSize_t(stmp, jobs.failJob));
+    airMopError(mop);
+    return 1;
+  }
   if (tec->progress) {
-    fprintf(stderr, "%s\n", airDoneStr(0, II, NN - 1, doneStr));
+    fprintf(stderr, "%s\n", airDoneStr(0, NN, NN - 1, doneStr));
   }
 
   ELL_4V_SET(axmap, -1, 1, 2, 3);
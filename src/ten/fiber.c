@@ -184,8 +184,9 @@ _tenFiberProbe(tenFiberContext *tfx, int *gageRet, double wPos[3], int seedProbe
       }
       break;
     default:
-      biffAddf(TEN, "%s: %s %s (%d) unimplemented!", me, tenDwiFiberType->name,
-               airEnumStr(tenDwiFiberType, tfx->fiberType), tfx->fiberType);
+      biffMaybeAddf(tfx->useBiff, TEN, "%s: %s %s (%d) unimplemented!", me,
+                    tenDwiFiberType->name, airEnumStr(tenDwiFiberType, tfx->fiberType),
+                    tfx->fiberType);
       /* return 1; (for biff auto-scan) */
       ret = 1;
     } /* switch (tfx->fiberType) */
@@ -476,7 +477,8 @@ _fiberTraceSet(tenFiberContext *tfx, Nrrd *nval, Nrrd *nfiber, double *buff,
   }
   if (nval) {
     if (!tfx->fiberProbeItem) {
-      biffAddf(TEN, "%s: want to record probed values but no item set", me);
+      biffMaybeAddf(tfx->useBiff, TEN,
+                    "%s: want to record probed values but no item set", me);
       return 1;
     }
     pansLen = gageAnswerLength(tfx->gtx, tfx->pvl, tfx->fiberProbeItem);
@@ -499,11 +501,12 @@ _fiberTraceSet(tenFiberContext *tfx, Nrrd *nval, Nrrd *nfiber, double *buff,
   oldStop = tfx->stop;
   if (!nfiber) {
     if (!(buff && halfBuffLen > 0 && startIdxP && startIdxP)) {
-      biffAddf(TEN, "%s: need either non-NULL nfiber or fpts buffer info", me);
+      biffMaybeAddf(tfx->useBiff, TEN,
+                    "%s: need either non-NULL nfiber or fpts buffer info", me);
       return 1;
     }
     if (tenFiberStopSet(tfx, tenFiberStopNumSteps, halfBuffLen)) {
-      biffAddf(TEN, "%s: error setting new fiber stop", me);
+      biffMaybeAddf(tfx->useBiff, TEN, "%s: error setting new fiber stop", me);
       return 1;
     }
   }
@@ -523,13 +526,14 @@ _fiberTraceSet(tenFiberContext *tfx, Nrrd *nval, Nrrd *nfiber, double *buff,
     ELL_3V_COPY(tmp, seed);
   }
   if (_tenFiberProbe(tfx, &gret, tmp, AIR_TRUE)) {
-    biffAddf(TEN, "%s: first _tenFiberProbe failed", me);
+    biffMaybeAddf(tfx->useBiff, TEN, "%s: first _tenFiberProbe failed", me);
     return 1;
   }
   if (gret) {
     if (gageErrBoundsSpace != tfx->gtx->errNum) {
-      biffAddf(TEN, "%s: gage problem on first _tenFiberProbe: %s (%d)", me,
-               tfx->gtx->errStr, tfx->gtx->errNum);
+      biffMaybeAddf(tfx->useBiff, TEN,
+                    "%s: gage problem on first _tenFiberProbe: %s (%d)", me,
+                    tfx->gtx->errStr, tfx->gtx->errNum);
       return 1;
     } else {
       /* the problem on the first probe was that it was out of bounds,
@@ -933,7 +937,7 @@ tenFiberSingleTrace(tenFiberContext *tfx, tenFiberSingle *tfbs, double seed[3],
   tfx->ten2Which = which;
   if (_fiberTraceSet(tfx, (tfx->fiberProbeItem ? tfbs->nval : NULL), tfbs->nvert, NULL,
                      0, NULL, NULL, seed)) {
-    biffAddf(TEN, "%s: problem computing tract", me);
+    biffMaybeAddf(tfx->useBiff, TEN, "%s: problem computing tract", me);
     return 1;
   }
 
@@ -1014,12 +1018,95 @@ tenFiberMultiNix(tenFiberMulti *tfm) {
   return NULL;
 }
 
+/* what all the threads of tenFiberMultiTrace share */
+typedef struct {
+  tenFiberMulti *tfml;
+  const double *seedData;
+  const unsigned int *fibrIdx; /* the fibers from seed si are
+                                  tfml->fiber[fibrIdx[si]] up to (but not
+                                  including) tfml->fiber[fibrIdx[si+1]] */
+  unsigned int seedNum;        /* total number of seeds */
+  tenFiberContext **tfx;       /* per-task: the caller's context, or a copy */
+} _tenFiberMultiShare;
+
+/*
+** traces all the fibers from seed seedIdx; this uses biff only as much
+** as tfx->useBiff says to
+*/
+static int /* Biff: 1 */
+_tenFiberMultiSeedTrace(tenFiberContext *tfx, _tenFiberMultiShare *share,
+                        unsigned int seedIdx) {
+  static const char me[] = "_tenFiberMultiSeedTrace";
+  tenFiberSingle *fibr;
+  double seed[3];
+  unsigned int dirNum, dirIdx;
+
+  dirNum = share->fibrIdx[seedIdx + 1] - share->fibrIdx[seedIdx];
+  for (dirIdx = 0; dirIdx < dirNum; dirIdx++) {
+    fibr = share->tfml->fiber + share->fibrIdx[seedIdx] + dirIdx;
+    if (tfx->verbose > 1) {
+      fprintf(stderr, "%s: dir %u/%u on seed %u/%u; # %u\n", me, dirIdx, dirNum,
+              seedIdx, share->seedNum, share->fibrIdx[seedIdx] + dirIdx);
+    }
+    ELL_3V_COPY(fibr->seedPos, share->seedData + 3 * seedIdx);
+    fibr->dirIdx = dirIdx;
+    fibr->dirNum = dirNum;
+    ELL_3V_COPY(seed, share->seedData + 3 * seedIdx);
+    if (tenFiberSingleTrace(tfx, fibr, seed, dirIdx)) {
+      biffMaybeAddf(tfx->useBiff, TEN, "%s: trouble on seed (%g,%g,%g) %u/%u, dir %u/%u",
+                    me, seed[0], seed[1], seed[2], seedIdx, share->seedNum, dirIdx,
+                    dirNum);
+      return 1;
+    }
+    if (tfx->verbose) {
+      if (tenFiberStopUnknown == fibr->whyNowhere) {
+        fprintf(stderr,
+                "%s: (%g,%g,%g) ->\n"
+                "   steps = %u,%u; len = %g,%g; whyStop = %s,%s\n",
+                me, seed[0], seed[1], seed[2], fibr->stepNum[0], fibr->stepNum[1],
+                fibr->halfLen[0], fibr->halfLen[1],
+                airEnumStr(tenFiberStop, fibr->whyStop[0]),
+                airEnumStr(tenFiberStop, fibr->whyStop[1]));
+      } else {
+        fprintf(stderr, "%s: (%g,%g,%g) -> whyNowhere: %s\n", me, seed[0], seed[1],
+                seed[2], airEnumStr(tenFiberStop, fibr->whyNowhere));
+      }
+    }
+  }
+  return 0;
+}
+
+/* the work of _tenJobsRun: seeds [lo,hi) */
+static int
+_tenFiberMultiWork(void *_share, unsigned int ti, size_t lo, size_t hi, size_t *failP) {
+  _tenFiberMultiShare *share;
+  size_t seedIdx;
+
+  share = AIR_CAST(_tenFiberMultiShare *, _share);
+  for (seedIdx = lo; seedIdx < hi; seedIdx++) {
+    if (_tenFiberMultiSeedTrace(share->tfx[ti], share, AIR_UINT(seedIdx))) {
+      *failP = seedIdx;
+      return 1;
+    }
+  }
+  return 0;
+}
+
 /*
 ******** tenFiberMultiTrace
 **
 ** does tractography for a list of seedpoints
 **
 ** tfml has been returned from tenFiberMultiNew()
+**
+** With tenFiberParmThreadNum > 1, the seeds are handed out a few at a
+** time to that many threads (by _tenJobsRun), each with its own
+** tenFiberContextCopy of tfx (with DWIs, tenFiberParmDwiFitCache lets the
+** threads share the tensor fits at voxels).  Since the number of fibers from
+** each seed is learned first, every fiber has its place in tfml->fiber[]
+** ahead of time: the fibers are in seed order, and are the same as with one
+** thread.  The threads trace without biff; if tracing failed, the first
+** seed at which it failed is traced again here to learn why.
 */
 int /* Biff: 1 */
 tenFiberMultiTrace(tenFiberContext *tfx, tenFiberMulti *tfml, const Nrrd *_nseed) {
@@ -1027,8 +1114,11 @@ tenFiberMultiTrace(tenFiberContext *tfx, tenFiberMulti *tfml, const Nrrd *_nseed
   airArray *mop;
   const double *seedData;
   double seed[3];
-  unsigned int seedNum, seedIdx, fibrNum, dirNum, dirIdx;
+  unsigned int seedNum, seedIdx, dirNum, *fibrIdx, threadNum, ti;
   Nrrd *nseed;
+  _tenFiberMultiShare share;
+  _tenJobs jobs;
+  int E, useBiff;
 
   if (!(tfx && tfml && _nseed)) {
     biffAddf(TEN, "%s: got NULL pointer", me);
@@ -1056,60 +1146,86 @@ tenFiberMultiTrace(tenFiberContext *tfx, tenFiberMulti *tfml, const Nrrd *_nseed
     airMopAdd(mop, nseed, AIR_CAST(airMopper, nrrdNuke), airMopAlways);
     if (nrrdConvert(nseed, _nseed, nrrdTypeDouble)) {
       biffMovef(TEN, NRRD, "%s: couldn't convert seed list", me);
+      airMopError(mop);
       return 1;
     }
     seedData = AIR_CAST(const double *, nseed->data);
   }
 
-  /* HEY: the correctness of the use of the airArray here is quite subtle */
-  fibrNum = 0;
+  /* learn where each seed's fibers go */
+  fibrIdx = AIR_CALLOC(seedNum + 1, unsigned int);
+  if (!fibrIdx) {
+    biffAddf(TEN, "%s: couldn't allocate fiber index for %u seeds", me, seedNum);
+    airMopError(mop);
+    return 1;
+  }
+  airMopAdd(mop, fibrIdx, airFree, airMopAlways);
+  fibrIdx[0] = 0;
   for (seedIdx = 0; seedIdx < seedNum; seedIdx++) {
+    ELL_3V_COPY(seed, seedData + 3 * seedIdx);
     dirNum = tenFiberDirectionNumber(tfx, seed);
     if (!dirNum) {
       biffAddf(TEN, "%s: couldn't learn dirNum at seed (%g,%g,%g)", me, seed[0], seed[1],
                seed[2]);
+      airMopError(mop);
       return 1;
     }
-    for (dirIdx = 0; dirIdx < dirNum; dirIdx++) {
-      if (tfx->verbose > 1) {
-        fprintf(stderr, "%s: dir %u/%u on seed %u/%u; len %u; # %u\n", me, dirIdx,
-                dirNum, seedIdx, seedNum, tfml->fiberArr->len, fibrNum);
-      }
-      /* tfml->fiberArr->len can never be < fibrNum */
-      if (tfml->fiberArr->len == fibrNum) {
-        airArrayLenIncr(tfml->fiberArr, 1);
-      }
-      ELL_3V_COPY(tfml->fiber[fibrNum].seedPos, seedData + 3 * seedIdx);
-      tfml->fiber[fibrNum].dirIdx = dirIdx;
-      tfml->fiber[fibrNum].dirNum = dirNum;
-      ELL_3V_COPY(seed, seedData + 3 * seedIdx);
-      if (tenFiberSingleTrace(tfx, &(tfml->fiber[fibrNum]), seed, dirIdx)) {
-        biffAddf(TEN, "%s: trouble on seed (%g,%g,%g) %u/%u, dir %u/%u", me, seed[0],
-                 seed[1], seed[2], seedIdx, seedNum, dirIdx, dirNum);
-        return 1;
-      }
-      if (tfx->verbose) {
-        if (tenFiberStopUnknown == tfml->fiber[fibrNum].whyNowhere) {
-          fprintf(stderr,
-                  "%s: (%g,%g,%g) ->\n"
-                  "   steps = %u,%u; len = %g,%g; whyStop = %s,%s\n",
-                  me, seed[0], seed[1], seed[2], tfml->fiber[fibrNum].stepNum[0],
-                  tfml->fiber[fibrNum].stepNum[1], tfml->fiber[fibrNum].halfLen[0],
-                  tfml->fiber[fibrNum].halfLen[1],
-                  airEnumStr(tenFiberStop, tfml->fiber[fibrNum].whyStop[0]),
-                  airEnumStr(tenFiberStop, tfml->fiber[fibrNum].whyStop[1]));
-        } else {
-          fprintf(stderr, "%s: (%g,%g,%g) -> whyNowhere: %s\n", me, seed[0], seed[1],
-                  seed[2], airEnumStr(tenFiberStop, tfml->fiber[fibrNum].whyNowhere));
-        }
-      }
-      fibrNum++;
+    fibrIdx[seedIdx + 1] = fibrIdx[seedIdx] + dirNum;
+  }
+  /* tenFiberSingles already in the array are re-used; via the callbacks,
+     new ones are initialized and any extra ones are cleared out */
+  airArrayLenSet(tfml->fiberArr, fibrIdx[seedNum]);
+  if (fibrIdx[seedNum] && !tfml->fiber) {
+    biffAddf(TEN, "%s: couldn't allocate %u fibers", me, fibrIdx[seedNum]);
+    airMopError(mop);
+    return 1;
+  }
+
+  threadNum = _tenJobsThreadNum(tfx->threadNum, seedNum);
+  share.tfml = tfml;
+  share.seedData = seedData;
+  share.fibrIdx = fibrIdx;
+  share.seedNum = seedNum;
+  share.tfx = AIR_CALLOC(threadNum, tenFiberContext *);
+  if (!share.tfx) {
+    biffAddf(TEN, "%s: couldn't allocate %u contexts", me, threadNum);
+    airMopError(mop);
+    return 1;
+  }
+  airMopAdd(mop, share.tfx, airFree, airMopAlways);
+  /* the first task uses tfx itself */
+  share.tfx[0] = tfx;
+  for (ti = 1; ti < threadNum; ti++) {
+    if (!(share.tfx[ti] = tenFiberContextCopy(tfx))) {
+      biffAddf(TEN, "%s: couldn't set up context for thread %u", me, ti);
+      airMopError(mop);
+      return 1;
     }
+    airMopAdd(mop, share.tfx[ti], (airMopper)tenFiberContextNix, airMopAlways);
+    share.tfx[ti]->useBiff = AIR_FALSE;
+  }
+  useBiff = tfx->useBiff;
+  tfx->useBiff = AIR_FALSE;
+  jobs.data = &share;
+  jobs.work = _tenFiberMultiWork;
+  jobs.fetched = NULL;
+  jobs.jobNum = seedNum;
+  jobs.chunk = 0;
+  E = _tenJobsRun(&jobs, threadNum);
+  tfx->useBiff = useBiff;
+  if (E) {
+    biffAddf(TEN, "%s: trouble with threads", me);
+    airMopError(mop);
+    return 1;
+  }
+  if (jobs.failed) {
+    seedIdx = AIR_UINT(jobs.failJob);
+    /* trace it again, with biff, to learn why */
+    _tenFiberMultiSeedTrace(tfx, &share, seedIdx);
+    biffAddf(TEN, "%s: failed at seed %u/%u", me, seedIdx, seedNum);
+    airMopError(mop);
+    return 1;
   }
-  /* if the airArray got to be its length only because of the work above,
-     then the following will be a no-op.  Otherwise, via the callbacks,
-     it will clear out the tenFiberSingle's that we didn't create here */
-  airArrayLenSet(tfml->fiberArr, fibrNum);
 
   airMopOkay(mop);
   return 0;
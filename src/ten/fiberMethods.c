@@ -168,6 +168,8 @@ _tenFiberContextCommonNew(const Nrrd *vol, int useDwi, double thresh, double sof
   tfx->minNumSteps = 0;
   tfx->useIndexSpace = tenDefFiberUseIndexSpace;
   tfx->verbose = 0;
+  tfx->threadNum = 1;
+  tfx->useBiff = AIR_TRUE;
   tfx->stepSize = tenDefFiberStepSize;
   tfx->maxHalfLen = tenDefFiberMaxHalfLen;
   tfx->minWholeLen = 0.0;
@@ -779,6 +781,12 @@ tenFiberParmSet(tenFiberContext *tfx, int parm, double val) {
     case tenFiberParmVerbose:
       tfx->verbose = AIR_INT(val);
       break;
+    case tenFiberParmThreadNum:
+      tfx->threadNum = AIR_UINT(AIR_MAX(1, val));
+      break;
+    case tenFiberParmDwiFitCache:
+      tfx->dwiFitCache = !!val;
+      break;
     default:
       fprintf(stderr, "%s: WARNING!!! tenFiberParm %d not handled\n", me, parm);
       break;
@@ -819,6 +827,14 @@ tenFiberUpdate(tenFiberContext *tfx) {
   if (tfx->fiberProbeItem) {
     GAGE_QUERY_ITEM_ON(tfx->query, tfx->fiberProbeItem);
   }
+  if (tfx->useDwi) {
+    /* the kind was created (just for us) by _tenFiberContextCommonNew */
+    if (tenDwiGageKindFitCacheSet(AIR_CAST(gageKind *, tfx->pvl->kind),
+                                  tfx->dwiFitCache)) {
+      biffAddf(TEN, "%s: trouble with DWI fit cache", me);
+      return 1;
+    }
+  }
   if (gageQuerySet(tfx->gtx, tfx->pvl, tfx->query) || gageUpdate(tfx->gtx)) {
     biffMovef(TEN, GAGE, "%s: trouble with gage", me);
     return 1;
@@ -832,6 +848,14 @@ tenFiberUpdate(tenFiberContext *tfx) {
   return 0;
 }
 
+/* where, in tfx's answer buffer, is what was at ans in oldTfx's */
+static const double *
+_tenFiberAnswerCopy(const tenFiberContext *tfx, const tenFiberContext *oldTfx,
+                    const double *ans) {
+
+  return ans ? tfx->pvl->answer + (ans - oldTfx->pvl->answer) : NULL;
+}
+
 /*
 ** exact same precautions about utility of this as with gageContextCopy!!!
 ** So: only after tenFiberUpdate, and don't touch anything, and don't
@@ -839,31 +863,29 @@ tenFiberUpdate(tenFiberContext *tfx) {
 */
 tenFiberContext * /* Biff: nope */
 tenFiberContextCopy(tenFiberContext *oldTfx) {
-  static const char me[] = "tenFiberContextCopy";
   tenFiberContext *tfx;
 
-  if (oldTfx->useDwi) {
-    fprintf(stderr, "!%s: sorry, can't copy DWI contexts; bye.\n", me);
-    exit(1);
-  }
+  /* with DWIs, the copy shares the DWI kind (and its fit cache) */
   tfx = AIR_CALLOC(1, tenFiberContext);
   memcpy(tfx, oldTfx, sizeof(tenFiberContext));
   tfx->ksp = nrrdKernelSpecCopy(oldTfx->ksp);
   tfx->gtx = gageContextCopy(oldTfx->gtx);
+  if (!tfx->gtx) {
+    nrrdKernelSpecNix(tfx->ksp);
+    free(tfx);
+    return NULL;
+  }
   tfx->pvl = tfx->gtx->pvl[0]; /* HEY! gage API sucks */
-  tfx->gageTen = gageAnswerPointer(tfx->gtx, tfx->pvl, tenGageTensor);
-  tfx->gageEval = gageAnswerPointer(tfx->gtx, tfx->pvl, tenGageEval0);
-  /* HEY: COPY AND PASTE */
-  tfx->gageEvec = gageAnswerPointer(tfx->gtx, tfx->pvl,
-                                    (tenFiberTypeEvec0 == tfx->fiberType
-                                       ? tenGageEvec0
-                                       : (tenFiberTypeEvec1 == tfx->fiberType
-                                            ? tenGageEvec1
-                                            : tenGageEvec2)));
-  tfx->gageAnisoStop = gageAnswerPointer(tfx->gtx, tfx->pvl, tfx->anisoStopType);
-  tfx->gageAnisoSpeed = (tfx->anisoSpeedType
-                           ? gageAnswerPointer(tfx->gtx, tfx->pvl, tfx->anisoSpeedType)
-                           : NULL);
+  /* the answer pointers are at the same places within the new answer
+     buffer as they were in the old one (re-learning them from the fiber
+     type and aniso types would have to repeat the logic of
+     tenFiberTypeSet and tenFiberStopSet) */
+  tfx->gageTen = _tenFiberAnswerCopy(tfx, oldTfx, oldTfx->gageTen);
+  tfx->gageEval = _tenFiberAnswerCopy(tfx, oldTfx, oldTfx->gageEval);
+  tfx->gageEvec = _tenFiberAnswerCopy(tfx, oldTfx, oldTfx->gageEvec);
+  tfx->gageAnisoStop = _tenFiberAnswerCopy(tfx, oldTfx, oldTfx->gageAnisoStop);
+  tfx->gageAnisoSpeed = _tenFiberAnswerCopy(tfx, oldTfx, oldTfx->gageAnisoSpeed);
+  tfx->gageTen2 = _tenFiberAnswerCopy(tfx, oldTfx, oldTfx->gageTen2);
   return tfx;
 }
 
@@ -0,0 +1,376 @@
+/*
+  Teem: Tools to process and visualize scientific data and images
+  Copyright (C) 2009--2023  University of Chicago
+  Copyright (C) 2005--2008  Gordon Kindlmann
+  Copyright (C) 1998--2004  University of Utah
+
+  This library is free software; you can redistribute it and/or modify it under the terms
+  of the GNU Lesser General Public License (LGPL) as published by the Free Software
+  Foundation; either version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also include exceptions to
+  the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+  PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with
+  this library; if not, write to Free Software Foundation, Inc., 51 Franklin Street,
+  Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "ten.h"
+#include "privateTen.h"
+
+/* allocation increments for the vertex and fiber buffers */
+#define _TEN_FIBER_SINK_VERT_INCR 4096
+#define _TEN_FIBER_SINK_FIBER_INCR 256
+
+/*
+******** tenFiberSinkNew
+**
+** creates a sink that will write chunks of chunkFiberNum fibers to file.
+** By default no fibers are dropped, and no transform is applied.
+*/
+tenFiberSink * /* Biff: NULL */
+tenFiberSinkNew(FILE *file, unsigned int chunkFiberNum) {
+  static const char me[] = "tenFiberSinkNew";
+  tenFiberSink *tfsk;
+  airPtrPtrUnion appu;
+
+  if (!file) {
+    biffAddf(TEN, "%s: got NULL pointer", me);
+    return NULL;
+  }
+  if (!chunkFiberNum) {
+    biffAddf(TEN, "%s: need non-zero # fibers per chunk", me);
+    return NULL;
+  }
+  tfsk = AIR_CALLOC(1, tenFiberSink);
+  if (!tfsk) {
+    biffAddf(TEN, "%s: couldn't allocate sink", me);
+    return NULL;
+  }
+  tfsk->file = file;
+  tfsk->chunkFiberNum = chunkFiberNum;
+  tfsk->lenRange[0] = 0;
+  tfsk->lenRange[1] = AIR_POS_INF;
+  tfsk->dropStop = 0;
+  tfsk->shape = NULL;
+  tfsk->xformUse = AIR_FALSE;
+  ELL_4M_IDENTITY_SET(tfsk->xform);
+  tfsk->xyzw = NULL;
+  tfsk->indx = NULL;
+  tfsk->icnt = NULL;
+  tfsk->type = NULL;
+  tfsk->vertNum = 0;
+  tfsk->fiberNum = 0;
+  appu.f = &(tfsk->xyzw);
+  tfsk->xyzwArr = airArrayNew(appu.v, &(tfsk->vertNum), 4 * sizeof(float),
+                              _TEN_FIBER_SINK_VERT_INCR);
+  appu.ui = &(tfsk->indx);
+  tfsk->indxArr = airArrayNew(appu.v, NULL, sizeof(unsigned int),
+                              _TEN_FIBER_SINK_VERT_INCR);
+  appu.ui = &(tfsk->icnt);
+  tfsk->icntArr = airArrayNew(appu.v, &(tfsk->fiberNum), sizeof(unsigned int),
+                              _TEN_FIBER_SINK_FIBER_INCR);
+  appu.uc = &(tfsk->type);
+  tfsk->typeArr = airArrayNew(appu.v, NULL, sizeof(unsigned char),
+                              _TEN_FIBER_SINK_FIBER_INCR);
+  if (!(tfsk->xyzwArr && tfsk->indxArr && tfsk->icntArr && tfsk->typeArr)) {
+    biffAddf(TEN, "%s: couldn't create buffers", me);
+    return tenFiberSinkNix(tfsk);
+  }
+  tfsk->fiberAdded = 0;
+  tfsk->fiberWritten = 0;
+  tfsk->vertWritten = 0;
+  tfsk->chunkWritten = 0;
+  return tfsk;
+}
+
+/*
+******** tenFiberSinkNix
+**
+** frees the sink, without flushing it, or closing its file
+*/
+tenFiberSink *
+tenFiberSinkNix(tenFiberSink *tfsk) {
+
+  if (tfsk) {
+    airArrayNuke(tfsk->xyzwArr);
+    airArrayNuke(tfsk->indxArr);
+    airArrayNuke(tfsk->icntArr);
+    airArrayNuke(tfsk->typeArr);
+    free(tfsk);
+  }
+  return NULL;
+}
+
+/*
+******** tenFiberSinkFlush
+**
+** writes out whatever fibers are buffered (if any) as one chunk
+*/
+int /* Biff: 1 */
+tenFiberSinkFlush(tenFiberSink *tfsk) {
+  static const char me[] = "tenFiberSinkFlush";
+  limnPolyData lpld;
+
+  if (!tfsk) {
+    biffAddf(TEN, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (!tfsk->fiberNum) {
+    return 0;
+  }
+  /* a limnPolyData wrapped around the buffers, which it doesn't own */
+  memset(&lpld, 0, sizeof(lpld));
+  lpld.xyzw = tfsk->xyzw;
+  lpld.xyzwNum = tfsk->vertNum;
+  lpld.indx = tfsk->indx;
+  lpld.indxNum = tfsk->vertNum;
+  lpld.type = tfsk->type;
+  lpld.icnt = tfsk->icnt;
+  lpld.primNum = tfsk->fiberNum;
+  if (limnPolyDataWriteLMPD(tfsk->file, &lpld)) {
+    biffMovef(TEN, LIMN, "%s: trouble writing chunk %u", me, tfsk->chunkWritten);
+    return 1;
+  }
+  fflush(tfsk->file);
+  tfsk->fiberWritten += tfsk->fiberNum;
+  tfsk->vertWritten += tfsk->vertNum;
+  tfsk->chunkWritten++;
+  airArrayLenSet(tfsk->xyzwArr, 0);
+  airArrayLenSet(tfsk->indxArr, 0);
+  airArrayLenSet(tfsk->icntArr, 0);
+  airArrayLenSet(tfsk->typeArr, 0);
+  return 0;
+}
+
+/*
+******** tenFiberSinkAdd
+**
+** gives one fiber to the sink.  Fibers that went nowhere, or that are
+** dropped according to tfsk->lenRange and tfsk->dropStop, are counted
+** (in tfsk->fiberAdded) but otherwise ignored.  Kept fibers are buffered,
+** and when there are tfsk->chunkFiberNum of them, they are written out.
+*/
+int /* Biff: 1 */
+tenFiberSinkAdd(tenFiberSink *tfsk, const tenFiberSingle *tfbs) {
+  static const char me[] = "tenFiberSinkAdd";
+  unsigned int vertNum, vertIdx, vertBase, fiberIdx;
+  const double *vert;
+  double len, indx[4], world[3], xxx[4], yyy[4];
+  float *xyzw;
+
+  if (!(tfsk && tfbs)) {
+    biffAddf(TEN, "%s: got NULL pointer", me);
+    return 1;
+  }
+  tfsk->fiberAdded++;
+  if (tenFiberStopUnknown != tfbs->whyNowhere) {
+    return 0;
+  }
+  len = tfbs->halfLen[0] + tfbs->halfLen[1];
+  if (!AIR_IN_CL(tfsk->lenRange[0], len, tfsk->lenRange[1])) {
+    return 0;
+  }
+  if ((tfsk->dropStop & (1 << tfbs->whyStop[0]))
+      || (tfsk->dropStop & (1 << tfbs->whyStop[1]))) {
+    return 0;
+  }
+  if (!(tfbs->nvert && 2 == tfbs->nvert->dim && 3 == tfbs->nvert->axis[0].size
+        && nrrdTypeDouble == tfbs->nvert->type)) {
+    biffAddf(TEN, "%s: fiber vertices not a 3-by-N array of doubles", me);
+    return 1;
+  }
+  vertNum = AIR_UINT(tfbs->nvert->axis[1].size);
+  vert = AIR_CAST(const double *, tfbs->nvert->data);
+  vertBase = airArrayLenIncr(tfsk->xyzwArr, vertNum);
+  airArrayLenIncr(tfsk->indxArr, vertNum);
+  fiberIdx = airArrayLenIncr(tfsk->icntArr, 1);
+  airArrayLenIncr(tfsk->typeArr, 1);
+  if (!(tfsk->xyzw && tfsk->indx && tfsk->icnt && tfsk->type)) {
+    biffAddf(TEN, "%s: couldn't grow buffers for %u more vertices", me, vertNum);
+    return 1;
+  }
+  /* the vertices are converted in the same order of operations (and with
+     the same intermediate rounding to float) as "tend fiber" does for
+     polydata from tenFiberMultiPolyData(), so that the results match */
+  for (vertIdx = 0; vertIdx < vertNum; vertIdx++) {
+    xyzw = tfsk->xyzw + 4 * (vertBase + vertIdx);
+    ELL_3V_COPY_TT(xyzw, float, vert + 3 * vertIdx);
+    xyzw[3] = 1.0;
+    if (tfsk->shape) {
+      ELL_4V_COPY(indx, xyzw);
+      ELL_4V_HOMOG(indx, indx);
+      gageShapeItoW(tfsk->shape, world, indx);
+      ELL_3V_COPY_TT(xyzw, float, world);
+      xyzw[3] = 1.0;
+    }
+    if (tfsk->xformUse) {
+      ELL_4V_COPY(xxx, xyzw);
+      ELL_4MV_MUL(yyy, tfsk->xform, xxx);
+      ELL_4V_HOMOG(yyy, yyy);
+      ELL_4V_COPY_TT(xyzw, float, yyy);
+    }
+    tfsk->indx[vertBase + vertIdx] = vertBase + vertIdx;
+  }
+  tfsk->icnt[fiberIdx] = vertNum;
+  tfsk->type[fiberIdx] = limnPrimitiveLineStrip;
+  if (tfsk->fiberNum >= tfsk->chunkFiberNum) {
+    if (tenFiberSinkFlush(tfsk)) {
+      biffAddf(TEN, "%s: trouble", me);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/*
+******** tenFiberSinkRead
+**
+** reads all the chunks written by a tenFiberSink into one limnPolyData.
+** Because a chunk is just an LMPD polydata, this can also read a single
+** polydata saved by limnPolyDataSave() in LMPD format.
+*/
+int /* Biff: 1 */
+tenFiberSinkRead(limnPolyData *lpld, FILE *file) {
+  static const char me[] = "tenFiberSinkRead";
+  airArray *mop, *chunkArr;
+  limnPolyData **chunk, *join;
+  unsigned int chunkIdx;
+  airPtrPtrUnion appu;
+  int cc;
+
+  if (!(lpld && file)) {
+    biffAddf(TEN, "%s: got NULL pointer", me);
+    return 1;
+  }
+  mop = airMopNew();
+  chunk = NULL;
+  appu.v = AIR_CAST(void **, &chunk);
+  chunkArr = airArrayNew(appu.v, NULL, sizeof(limnPolyData *), 64);
+  airMopAdd(mop, chunkArr, (airMopper)airArrayNuke, airMopAlways);
+  while (1) {
+    /* skip the newline after the previous chunk, and find out if there
+       is another one */
+    do {
+      cc = getc(file);
+    } while (EOF != cc && isspace(cc));
+    if (EOF == cc) {
+      break;
+    }
+    ungetc(cc, file);
+    chunkIdx = airArrayLenIncr(chunkArr, 1);
+    if (!chunk) {
+      biffAddf(TEN, "%s: couldn't allocate chunk array", me);
+      airMopError(mop);
+      return 1;
+    }
+    chunk[chunkIdx] = limnPolyDataNew();
+    airMopAdd(mop, chunk[chunkIdx], (airMopper)limnPolyDataNix, airMopAlways);
+    if (limnPolyDataReadLMPD(chunk[chunkIdx], file)) {
+      biffMovef(TEN, LIMN, "%s: trouble reading chunk %u", me, chunkIdx);
+      airMopError(mop);
+      return 1;
+    }
+  }
+  if (!chunkArr->len) {
+    biffAddf(TEN, "%s: didn't get any chunks", me);
+    airMopError(mop);
+    return 1;
+  }
+  if (!(join = limnPolyDataJoin(AIR_CAST(const limnPolyData **, chunk),
+                                chunkArr->len))) {
+    biffMovef(TEN, LIMN, "%s: trouble joining %u chunks", me, chunkArr->len);
+    airMopError(mop);
+    return 1;
+  }
+  airMopAdd(mop, join, (airMopper)limnPolyDataNix, airMopAlways);
+  if (limnPolyDataCopy(lpld, join)) {
+    biffMovef(TEN, LIMN, "%s: trouble copying result", me);
+    airMopError(mop);
+    return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+******** tenFiberMultiTraceSink
+**
+** like tenFiberMultiTrace(), but instead of keeping all the fibers,
+** traces tfsk->chunkFiberNum seeds at a time (with tfx->threadNum
+** threads) and gives the resulting fibers, in seed order, to the sink.
+** Memory use is thus bounded by the size of a chunk rather than the
+** size of the whole tractogram.  The last partial chunk is flushed.
+*/
+int /* Biff: 1 */
+tenFiberMultiTraceSink(tenFiberContext *tfx, tenFiberSink *tfsk, const Nrrd *_nseed) {
+  static const char me[] = "tenFiberMultiTraceSink";
+  airArray *mop;
+  Nrrd *nseed, *nsub;
+  tenFiberMulti *tfml;
+  double *seedData;
+  unsigned int seedNum, seedLo, seedHi, fiberIdx;
+
+  if (!(tfx && tfsk && _nseed)) {
+    biffAddf(TEN, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (!(2 == _nseed->dim && 3 == _nseed->axis[0].size)) {
+    biffAddf(TEN,
+             "%s: seed list should be a 2-D (not %u-D) "
+             "3-by-X (not %u-by-X) array",
+             me, _nseed->dim, AIR_UINT(_nseed->axis[0].size));
+    return 1;
+  }
+  mop = airMopNew();
+  nseed = nrrdNew();
+  airMopAdd(mop, nseed, (airMopper)nrrdNuke, airMopAlways);
+  nsub = nrrdNew();
+  airMopAdd(mop, nsub, (airMopper)nrrdNix, airMopAlways);
+  if (nrrdConvert(nseed, _nseed, nrrdTypeDouble)) {
+    biffMovef(TEN, NRRD, "%s: couldn't convert seed list", me);
+    airMopError(mop);
+    return 1;
+  }
+  if (!(tfml = tenFiberMultiNew())) {
+    biffAddf(TEN, "%s: couldn't create fiber buffer", me);
+    airMopError(mop);
+    return 1;
+  }
+  airMopAdd(mop, tfml, (airMopper)tenFiberMultiNix, airMopAlways);
+  seedData = AIR_CAST(double *, nseed->data);
+  seedNum = AIR_UINT(nseed->axis[1].size);
+  for (seedLo = 0; seedLo < seedNum; seedLo = seedHi) {
+    seedHi = AIR_MIN(seedNum, seedLo + tfsk->chunkFiberNum);
+    if (nrrdWrap_va(nsub, seedData + 3 * seedLo, nrrdTypeDouble, 2, AIR_SIZE_T(3),
+                    AIR_SIZE_T(seedHi - seedLo))) {
+      biffMovef(TEN, NRRD, "%s: couldn't wrap seeds [%u,%u)", me, seedLo, seedHi);
+      airMopError(mop);
+      return 1;
+    }
+    if (tenFiberMultiTrace(tfx, tfml, nsub)) {
+      biffAddf(TEN, "%s: trouble tracing from seeds [%u,%u)", me, seedLo, seedHi);
+      airMopError(mop);
+      return 1;
+    }
+    for (fiberIdx = 0; fiberIdx < tfml->fiberArr->len; fiberIdx++) {
+      if (tenFiberSinkAdd(tfsk, tfml->fiber + fiberIdx)) {
+        biffAddf(TEN, "%s: trouble with fiber %u from seeds [%u,%u)", me, fiberIdx,
+                 seedLo, seedHi);
+        airMopError(mop);
+        return 1;
+      }
+    }
+  }
+  if (tenFiberSinkFlush(tfsk)) {
+    biffAddf(TEN, "%s: trouble", me);
+    airMopError(mop);
+    return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
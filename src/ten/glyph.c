@@ -57,6 +57,9 @@ tenGlyphParmNew() {
     parm->sliceOffset = 0.0;
     parm->sliceBias = 0.05f;
     parm->sliceGamma = 1.0;
+
+    parm->shapeRes = 0;
+    parm->threadNum = 1;
   }
   return parm;
 }
@@ -169,74 +172,286 @@ tenGlyphParmCheck(tenGlyphParm *parm, const Nrrd *nten, const Nrrd *npos,
   return 0;
 }
 
-int /* Biff: 1 */
-tenGlyphGen(limnObject *glyphsLimn, echoScene *glyphsEcho, tenGlyphParm *parm,
-            const Nrrd *nten, const Nrrd *npos, const Nrrd *nslc) {
-  static const char me[] = "tenGlyphGen";
-  gageShape *shape;
-  airArray *mop;
-  float *tdata, eval[3], evec[9], *cvec, rotEvec[9], mA_f[16], absEval[3], glyphScl[3];
-  double pI[3], pW[3], cl, cp, sRot[16], mA[16], mB[16], msFr[9], tmpvec[3], R, G, B, qA,
-    qB, qC, glyphAniso, sliceGray;
-  unsigned int duh;
-  int slcCoord[3], idx, glyphIdx, axis, numGlyphs, svRGBAfl = AIR_FALSE;
-  limnLook *look;
-  int lookIdx;
-  echoObject *eglyph, *inst, *list = NULL, *split, *esquare;
-  echoPos_t eM[16], originOffset[3], edge0[3], edge1[3];
-  char stmp[AIR_STRLEN_SMALL + 1];
-  /*
-  int eret;
-  double tmp1[3], tmp2[3];
-  */
+/* the measurement frame of nten, as a 3x3 matrix (identity if not set) */
+static void
+_tenGlyphMeasurementFrame(double msFr[9], const Nrrd *nten) {
 
-  if (!((glyphsLimn || glyphsEcho) && nten && parm)) {
-    biffAddf(TEN, "%s: got NULL pointer", me);
-    return 1;
+  if (3 == nten->spaceDim && AIR_EXISTS(nten->measurementFrame[0][0])) {
+    /*     msFr        nten->measurementFrame
+    **   0  1  2      [0][0]   [1][0]   [2][0]
+    **   3  4  5      [0][1]   [1][1]   [2][1]
+    **   6  7  8      [0][2]   [1][2]   [2][2]
+    */
+    msFr[0] = nten->measurementFrame[0][0];
+    msFr[3] = nten->measurementFrame[0][1];
+    msFr[6] = nten->measurementFrame[0][2];
+    msFr[1] = nten->measurementFrame[1][0];
+    msFr[4] = nten->measurementFrame[1][1];
+    msFr[7] = nten->measurementFrame[1][2];
+    msFr[2] = nten->measurementFrame[2][0];
+    msFr[5] = nten->measurementFrame[2][1];
+    msFr[8] = nten->measurementFrame[2][2];
+  } else {
+    ELL_3M_IDENTITY_SET(msFr);
   }
-  mop = airMopNew();
-  shape = gageShapeNew();
-  shape->defaultCenter = nrrdCenterCell;
-  airMopAdd(mop, shape, (airMopper)gageShapeNix, airMopAlways);
+  return;
+}
+
+/* eigensystem of tensor tdata, with the eigenvectors transformed by the
+   measurement frame msFr, and made into a right-handed frame */
+static void
+_tenGlyphEigensystem(float eval[3], float evec[9], const float *tdata,
+                     const double msFr[9]) {
+  double tmpvec[3];
+
+  tenEigensolve_f(eval, evec, tdata);
+  ELL_3MV_MUL(tmpvec, msFr, evec + 0);
+  ELL_3V_COPY_TT(evec + 0, float, tmpvec);
+  ELL_3MV_MUL(tmpvec, msFr, evec + 3);
+  ELL_3V_COPY_TT(evec + 3, float, tmpvec);
+  ELL_3MV_MUL(tmpvec, msFr, evec + 6);
+  ELL_3V_COPY_TT(evec + 6, float, tmpvec);
+  ELL_3V_CROSS(tmpvec, evec + 0, evec + 3);
+  if (0 > ELL_3V_DOT(tmpvec, evec + 6)) {
+    ELL_3V_SCALE(evec + 6, -1, evec + 6);
+  }
+  return;
+}
+
+/* the homogeneous transform mA from glyph to world space, for a glyph at
+   world-space position pW */
+static void
+_tenGlyphTransform(double mA[16], const tenGlyphParm *parm, const float eval[3],
+                   const float evec[9], const double pW[3]) {
+  float rotEvec[9], absEval[3], glyphScl[3];
+  double mB[16];
+
+  ELL_3M_TRANSPOSE(rotEvec, evec);
+  ELL_3V_ABS(absEval, eval);
+  ELL_4M_IDENTITY_SET(mA);                           /* reset */
+  ELL_3V_SCALE(glyphScl, parm->glyphScale, absEval); /* scale by evals */
+  ELL_4M_SCALE_SET(mB, glyphScl[0], glyphScl[1], glyphScl[2]);
+
+  ell_4m_post_mul_d(mA, mB);
+  ELL_43M_INSET(mB, rotEvec); /* rotate by evecs */
+  ell_4m_post_mul_d(mA, mB);
+  ELL_4M_TRANSLATE_SET(mB, pW[0], pW[1], pW[2]); /* translate */
+  ell_4m_post_mul_d(mA, mB);
+  return;
+}
+
+/* the glyph color */
+static void
+_tenGlyphColor(double rgb[3], const tenGlyphParm *parm, const float eval[3],
+               const float evec[9]) {
+  const float *cvec;
+  double R, G, B, glyphAniso;
+
+  glyphAniso = tenAnisoEval_f(eval, parm->colAnisoType);
+  cvec = evec + 3 * (AIR_CLAMP(0, parm->colEvec, 2));
+  R = AIR_ABS(cvec[0]); /* standard mapping */
+  G = AIR_ABS(cvec[1]);
+  B = AIR_ABS(cvec[2]);
+  /* desaturate by colMaxSat */
+  R = AIR_AFFINE(0.0, parm->colMaxSat, 1.0, parm->colIsoGray, R);
+  G = AIR_AFFINE(0.0, parm->colMaxSat, 1.0, parm->colIsoGray, G);
+  B = AIR_AFFINE(0.0, parm->colMaxSat, 1.0, parm->colIsoGray, B);
+  /* desaturate some by anisotropy */
+  R = AIR_AFFINE(0.0, parm->colAnisoModulate, 1.0, R,
+                 AIR_AFFINE(0.0, glyphAniso, 1.0, parm->colIsoGray, R));
+  G = AIR_AFFINE(0.0, parm->colAnisoModulate, 1.0, G,
+                 AIR_AFFINE(0.0, glyphAniso, 1.0, parm->colIsoGray, G));
+  B = AIR_AFFINE(0.0, parm->colAnisoModulate, 1.0, B,
+                 AIR_AFFINE(0.0, glyphAniso, 1.0, parm->colIsoGray, B));
+  /* clamp and do gamma */
+  R = AIR_CLAMP(0.0, R, 1.0);
+  G = AIR_CLAMP(0.0, G, 1.0);
+  B = AIR_CLAMP(0.0, B, 1.0);
+  R = pow(R, parm->colGamma);
+  G = pow(G, parm->colGamma);
+  B = pow(B, parm->colGamma);
+  ELL_3V_SET(rgb, R, G, B);
+  return;
+}
+
+/* the axis (0 or 2) of a glyph, and its superquadric exponents qq[] */
+static void
+_tenGlyphSuperquad(int *axisP, double qq[3], const float eval[3], double sqdSharp) {
+  float absEval[3];
+  double cl, cp, qA, qB, qC;
+  int axis;
+
+  ELL_3V_ABS(absEval, eval);
+  if (eval[2] > 0) {
+    /* all evals positive */
+    cl = AIR_MIN(0.99, tenAnisoEval_f(eval, tenAniso_Cl1));
+    cp = AIR_MIN(0.99, tenAnisoEval_f(eval, tenAniso_Cp1));
+    if (cl > cp) {
+      axis = 0;
+      qA = pow(1 - cp, sqdSharp);
+      qB = pow(1 - cl, sqdSharp);
+    } else {
+      axis = 2;
+      qA = pow(1 - cl, sqdSharp);
+      qB = pow(1 - cp, sqdSharp);
+    }
+    qC = qB;
+  } else if (eval[0] < 0) {
+    /* all evals negative */
+    float aef[3];
+    aef[0] = absEval[2];
+    aef[1] = absEval[1];
+    aef[2] = absEval[0];
+    cl = AIR_MIN(0.99, tenAnisoEval_f(aef, tenAniso_Cl1));
+    cp = AIR_MIN(0.99, tenAnisoEval_f(aef, tenAniso_Cp1));
+    if (cl > cp) {
+      axis = 2;
+      qA = pow(1 - cp, sqdSharp);
+      qB = pow(1 - cl, sqdSharp);
+    } else {
+      axis = 0;
+      qA = pow(1 - cl, sqdSharp);
+      qB = pow(1 - cp, sqdSharp);
+    }
+    qC = qB;
+  } else {
+#define OOSQRT2 0.70710678118654752440
+#define OOSQRT3 0.57735026918962576451
+    /* double poleA[3]={OOSQRT3, OOSQRT3, OOSQRT3}; */
+    double poleB[3] = {1, 0, 0};
+    double poleC[3] = {OOSQRT2, OOSQRT2, 0};
+    double poleD[3] = {OOSQRT3, -OOSQRT3, -OOSQRT3};
+    double poleE[3] = {OOSQRT2, 0, -OOSQRT2};
+    double poleF[3] = {OOSQRT3, OOSQRT3, -OOSQRT3};
+    double poleG[3] = {0, -OOSQRT2, -OOSQRT2};
+    double poleH[3] = {0, 0, -1};
+    /* double poleI[3]={-OOSQRT3, -OOSQRT3, -OOSQRT3}; */
+    double funk[3] = {0, 4, 2}, thrn[3] = {1, 4, 4};
+    double octa[3] = {0, 2, 2}, cone[3] = {1, 2, 2};
+    double evalN[3], tmp, bary[3];
+
+    ELL_3V_NORM(evalN, eval, tmp);
+    if (eval[1] >= -eval[2]) {
+      /* inside B-F-C */
+      ell_3v_barycentric_spherical_d(bary, poleB, poleF, poleC, evalN);
+      ELL_3V_SCALE_ADD3(qq, bary[0], octa, bary[1], thrn, bary[2], cone);
+      axis = 2;
+    } else if (eval[0] >= -eval[2]) {
+      /* inside B-D-F */
+      if (eval[1] >= 0) {
+        /* inside B-E-F */
+        ell_3v_barycentric_spherical_d(bary, poleB, poleE, poleF, evalN);
+        ELL_3V_SCALE_ADD3(qq, bary[0], octa, bary[1], funk, bary[2], thrn);
+        axis = 2;
+      } else {
+        /* inside B-D-E */
+        ell_3v_barycentric_spherical_d(bary, poleB, poleD, poleE, evalN);
+        ELL_3V_SCALE_ADD3(qq, bary[0], cone, bary[1], thrn, bary[2], funk);
+        axis = 0;
+      }
+    } else if (eval[0] < -eval[1]) {
+      /* inside D-G-H */
+      ell_3v_barycentric_spherical_d(bary, poleD, poleG, poleH, evalN);
+      ELL_3V_SCALE_ADD3(qq, bary[0], thrn, bary[1], cone, bary[2], octa);
+      axis = 0;
+    } else if (eval[1] < 0) {
+      /* inside E-D-H */
+      ell_3v_barycentric_spherical_d(bary, poleE, poleD, poleH, evalN);
+      ELL_3V_SCALE_ADD3(qq, bary[0], funk, bary[1], thrn, bary[2], octa);
+      axis = 0;
+    } else {
+      /* inside F-E-H */
+      ell_3v_barycentric_spherical_d(bary, poleF, poleE, poleH, evalN);
+      ELL_3V_SCALE_ADD3(qq, bary[0], thrn, bary[1], funk, bary[2], cone);
+      axis = 2;
+    }
+    qA = qq[0];
+    qB = qq[1];
+    qC = qq[2];
+#undef OOSQRT2
+#undef OOSQRT3
+  }
+  *axisP = axis;
+  ELL_3V_SET(qq, qA, qB, qC);
+  return;
+}
+
+/* checks the inputs common to tenGlyphGen and tenGlyphInstGen, and (without
+   npos) sets shape from nten */
+static int /* Biff: 1 */
+_tenGlyphInputCheck(gageShape *shape, tenGlyphParm *parm, const Nrrd *nten,
+                    const Nrrd *npos, const Nrrd *nslc) {
+  static const char me[] = "_tenGlyphInputCheck";
+  char stmp[AIR_STRLEN_SMALL + 1];
+
   if (npos) {
     if (!(2 == nten->dim && 7 == nten->axis[0].size)) {
       biffAddf(TEN, "%s: nten isn't 2-D 7-by-N array", me);
-      airMopError(mop);
       return 1;
     }
     if (!(2 == npos->dim && 3 == npos->axis[0].size
           && nten->axis[1].size == npos->axis[1].size)) {
       biffAddf(TEN, "%s: npos isn't 2-D 3-by-%s array", me,
                airSprintSize_t(stmp, nten->axis[1].size));
-      airMopError(mop);
       return 1;
     }
     if (!(nrrdTypeFloat == nten->type && nrrdTypeFloat == npos->type)) {
       biffAddf(TEN, "%s: nten and npos must be %s, not %s and %s", me,
                airEnumStr(nrrdType, nrrdTypeFloat), airEnumStr(nrrdType, nten->type),
                airEnumStr(nrrdType, npos->type));
-      airMopError(mop);
       return 1;
     }
   } else {
     if (tenTensorCheck(nten, nrrdTypeFloat, AIR_TRUE, AIR_TRUE)) {
       biffAddf(TEN, "%s: didn't get a valid DT volume", me);
-      airMopError(mop);
       return 1;
     }
   }
   if (tenGlyphParmCheck(parm, nten, npos, nslc)) {
     biffAddf(TEN, "%s: trouble", me);
-    airMopError(mop);
     return 1;
   }
   if (!npos) {
     if (gageShapeSet(shape, nten, tenGageKind->baseDim)) {
       biffMovef(TEN, GAGE, "%s: trouble", me);
-      airMopError(mop);
       return 1;
     }
   }
+  return 0;
+}
+
+int /* Biff: 1 */
+tenGlyphGen(limnObject *glyphsLimn, echoScene *glyphsEcho, tenGlyphParm *parm,
+            const Nrrd *nten, const Nrrd *npos, const Nrrd *nslc) {
+  static const char me[] = "tenGlyphGen";
+  gageShape *shape;
+  airArray *mop;
+  float *tdata, eval[3], evec[9], mA_f[16];
+  double pI[3], pW[3], sRot[16], mA[16], mB[16], msFr[9], rgb[3], qq[3], sliceGray;
+  unsigned int duh;
+  int slcCoord[3], idx, glyphIdx, axis, numGlyphs, svRGBAfl = AIR_FALSE;
+  limnLook *look;
+  int lookIdx;
+  echoObject *eglyph, *inst, *list = NULL, *split, *esquare;
+  echoPos_t eM[16], originOffset[3], edge0[3], edge1[3];
+  /*
+  int eret;
+  double tmp1[3], tmp2[3];
+  */
+
+  if (!((glyphsLimn || glyphsEcho) && nten && parm)) {
+    biffAddf(TEN, "%s: got NULL pointer", me);
+    return 1;
+  }
+  mop = airMopNew();
+  shape = gageShapeNew();
+  shape->defaultCenter = nrrdCenterCell;
+  airMopAdd(mop, shape, (airMopper)gageShapeNix, airMopAlways);
+  if (_tenGlyphInputCheck(shape, parm, nten, npos, nslc)) {
+    biffAddf(TEN, "%s: trouble", me);
+    airMopError(mop);
+    return 1;
+  }
   if (parm->doSlice) {
     ELL_3V_COPY(edge0, shape->spacing);
     ELL_3V_COPY(edge1, shape->spacing);
@@ -276,24 +491,7 @@ tenGlyphGen(limnObject *glyphsLimn, echoScene *glyphsEcho, tenGlyphParm *parm,
     numGlyphs = shape->size[0] * shape->size[1] * shape->size[2];
   }
   /* find measurement frame transform */
-  if (3 == nten->spaceDim && AIR_EXISTS(nten->measurementFrame[0][0])) {
-    /*     msFr        nten->measurementFrame
-    **   0  1  2      [0][0]   [1][0]   [2][0]
-    **   3  4  5      [0][1]   [1][1]   [2][1]
-    **   6  7  8      [0][2]   [1][2]   [2][2]
-    */
-    msFr[0] = nten->measurementFrame[0][0];
-    msFr[3] = nten->measurementFrame[0][1];
-    msFr[6] = nten->measurementFrame[0][2];
-    msFr[1] = nten->measurementFrame[1][0];
-    msFr[4] = nten->measurementFrame[1][1];
-    msFr[7] = nten->measurementFrame[1][2];
-    msFr[2] = nten->measurementFrame[2][0];
-    msFr[5] = nten->measurementFrame[2][1];
-    msFr[8] = nten->measurementFrame[2][2];
-  } else {
-    ELL_3M_IDENTITY_SET(msFr);
-  }
+  _tenGlyphMeasurementFrame(msFr, nten);
   for (idx = 0; idx < numGlyphs; idx++) {
     tdata = (float *)(nten->data) + 7 * idx;
     if (parm->verbose >= 2) {
@@ -330,19 +528,8 @@ tenGlyphGen(limnObject *glyphsLimn, echoScene *glyphsEcho, tenGlyphParm *parm,
         }
       }
     }
-    tenEigensolve_f(eval, evec, tdata);
-    /* transform eigenvectors by measurement frame */
-    ELL_3MV_MUL(tmpvec, msFr, evec + 0);
-    ELL_3V_COPY_TT(evec + 0, float, tmpvec);
-    ELL_3MV_MUL(tmpvec, msFr, evec + 3);
-    ELL_3V_COPY_TT(evec + 3, float, tmpvec);
-    ELL_3MV_MUL(tmpvec, msFr, evec + 6);
-    ELL_3V_COPY_TT(evec + 6, float, tmpvec);
-    ELL_3V_CROSS(tmpvec, evec + 0, evec + 3);
-    if (0 > ELL_3V_DOT(tmpvec, evec + 6)) {
-      ELL_3V_SCALE(evec + 6, -1, evec + 6);
-    }
-    ELL_3M_TRANSPOSE(rotEvec, evec);
+    /* (with eigenvectors transformed by measurement frame) */
+    _tenGlyphEigensystem(eval, evec, tdata, msFr);
     if (parm->doSlice && pI[parm->sliceAxis] == parm->slicePos) {
       /* set sliceGray */
       if (nslc) {
@@ -438,7 +625,6 @@ tenGlyphGen(limnObject *glyphsLimn, echoScene *glyphsEcho, tenGlyphParm *parm,
       }
       continue;
     }
-    glyphAniso = tenAnisoEval_f(eval, parm->colAnisoType);
     /*
       fprintf(stderr, "%s: eret = %d; evals = %g %g %g\n", me,
       eret, eval[0], eval[1], eval[2]);
@@ -450,132 +636,13 @@ tenGlyphGen(limnObject *glyphsLimn, echoScene *glyphsEcho, tenGlyphParm *parm,
     */
 
     /* set transform (in mA) */
-    ELL_3V_ABS(absEval, eval);
-    ELL_4M_IDENTITY_SET(mA);                           /* reset */
-    ELL_3V_SCALE(glyphScl, parm->glyphScale, absEval); /* scale by evals */
-    ELL_4M_SCALE_SET(mB, glyphScl[0], glyphScl[1], glyphScl[2]);
-
-    ell_4m_post_mul_d(mA, mB);
-    ELL_43M_INSET(mB, rotEvec); /* rotate by evecs */
-    ell_4m_post_mul_d(mA, mB);
-    ELL_4M_TRANSLATE_SET(mB, pW[0], pW[1], pW[2]); /* translate */
-    ell_4m_post_mul_d(mA, mB);
-
-    /* set color (in R,G,B) */
-    cvec = evec + 3 * (AIR_CLAMP(0, parm->colEvec, 2));
-    R = AIR_ABS(cvec[0]); /* standard mapping */
-    G = AIR_ABS(cvec[1]);
-    B = AIR_ABS(cvec[2]);
-    /* desaturate by colMaxSat */
-    R = AIR_AFFINE(0.0, parm->colMaxSat, 1.0, parm->colIsoGray, R);
-    G = AIR_AFFINE(0.0, parm->colMaxSat, 1.0, parm->colIsoGray, G);
-    B = AIR_AFFINE(0.0, parm->colMaxSat, 1.0, parm->colIsoGray, B);
-    /* desaturate some by anisotropy */
-    R = AIR_AFFINE(0.0, parm->colAnisoModulate, 1.0, R,
-                   AIR_AFFINE(0.0, glyphAniso, 1.0, parm->colIsoGray, R));
-    G = AIR_AFFINE(0.0, parm->colAnisoModulate, 1.0, G,
-                   AIR_AFFINE(0.0, glyphAniso, 1.0, parm->colIsoGray, G));
-    B = AIR_AFFINE(0.0, parm->colAnisoModulate, 1.0, B,
-                   AIR_AFFINE(0.0, glyphAniso, 1.0, parm->colIsoGray, B));
-    /* clamp and do gamma */
-    R = AIR_CLAMP(0.0, R, 1.0);
-    G = AIR_CLAMP(0.0, G, 1.0);
-    B = AIR_CLAMP(0.0, B, 1.0);
-    R = pow(R, parm->colGamma);
-    G = pow(G, parm->colGamma);
-    B = pow(B, parm->colGamma);
-
-    /* find axis, and superquad exponents qA and qB */
-    if (eval[2] > 0) {
-      /* all evals positive */
-      cl = AIR_MIN(0.99, tenAnisoEval_f(eval, tenAniso_Cl1));
-      cp = AIR_MIN(0.99, tenAnisoEval_f(eval, tenAniso_Cp1));
-      if (cl > cp) {
-        axis = 0;
-        qA = pow(1 - cp, parm->sqdSharp);
-        qB = pow(1 - cl, parm->sqdSharp);
-      } else {
-        axis = 2;
-        qA = pow(1 - cl, parm->sqdSharp);
-        qB = pow(1 - cp, parm->sqdSharp);
-      }
-      qC = qB;
-    } else if (eval[0] < 0) {
-      /* all evals negative */
-      float aef[3];
-      aef[0] = absEval[2];
-      aef[1] = absEval[1];
-      aef[2] = absEval[0];
-      cl = AIR_MIN(0.99, tenAnisoEval_f(aef, tenAniso_Cl1));
-      cp = AIR_MIN(0.99, tenAnisoEval_f(aef, tenAniso_Cp1));
-      if (cl > cp) {
-        axis = 2;
-        qA = pow(1 - cp, parm->sqdSharp);
-        qB = pow(1 - cl, parm->sqdSharp);
-      } else {
-        axis = 0;
-        qA = pow(1 - cl, parm->sqdSharp);
-        qB = pow(1 - cp, parm->sqdSharp);
-      }
-      qC = qB;
-    } else {
-#define OOSQRT2 0.70710678118654752440
-#define OOSQRT3 0.57735026918962576451
-      /* double poleA[3]={OOSQRT3, OOSQRT3, OOSQRT3}; */
-      double poleB[3] = {1, 0, 0};
-      double poleC[3] = {OOSQRT2, OOSQRT2, 0};
-      double poleD[3] = {OOSQRT3, -OOSQRT3, -OOSQRT3};
-      double poleE[3] = {OOSQRT2, 0, -OOSQRT2};
-      double poleF[3] = {OOSQRT3, OOSQRT3, -OOSQRT3};
-      double poleG[3] = {0, -OOSQRT2, -OOSQRT2};
-      double poleH[3] = {0, 0, -1};
-      /* double poleI[3]={-OOSQRT3, -OOSQRT3, -OOSQRT3}; */
-      double funk[3] = {0, 4, 2}, thrn[3] = {1, 4, 4};
-      double octa[3] = {0, 2, 2}, cone[3] = {1, 2, 2};
-      double evalN[3], tmp, bary[3];
-      double qq[3];
-
-      ELL_3V_NORM(evalN, eval, tmp);
-      if (eval[1] >= -eval[2]) {
-        /* inside B-F-C */
-        ell_3v_barycentric_spherical_d(bary, poleB, poleF, poleC, evalN);
-        ELL_3V_SCALE_ADD3(qq, bary[0], octa, bary[1], thrn, bary[2], cone);
-        axis = 2;
-      } else if (eval[0] >= -eval[2]) {
-        /* inside B-D-F */
-        if (eval[1] >= 0) {
-          /* inside B-E-F */
-          ell_3v_barycentric_spherical_d(bary, poleB, poleE, poleF, evalN);
-          ELL_3V_SCALE_ADD3(qq, bary[0], octa, bary[1], funk, bary[2], thrn);
-          axis = 2;
-        } else {
-          /* inside B-D-E */
-          ell_3v_barycentric_spherical_d(bary, poleB, poleD, poleE, evalN);
-          ELL_3V_SCALE_ADD3(qq, bary[0], cone, bary[1], thrn, bary[2], funk);
-          axis = 0;
-        }
-      } else if (eval[0] < -eval[1]) {
-        /* inside D-G-H */
-        ell_3v_barycentric_spherical_d(bary, poleD, poleG, poleH, evalN);
-        ELL_3V_SCALE_ADD3(qq, bary[0], thrn, bary[1], cone, bary[2], octa);
-        axis = 0;
-      } else if (eval[1] < 0) {
-        /* inside E-D-H */
-        ell_3v_barycentric_spherical_d(bary, poleE, poleD, poleH, evalN);
-        ELL_3V_SCALE_ADD3(qq, bary[0], funk, bary[1], thrn, bary[2], octa);
-        axis = 0;
-      } else {
-        /* inside F-E-H */
-        ell_3v_barycentric_spherical_d(bary, poleF, poleE, poleH, evalN);
-        ELL_3V_SCALE_ADD3(qq, bary[0], thrn, bary[1], funk, bary[2], cone);
-        axis = 2;
-      }
-      qA = qq[0];
-      qB = qq[1];
-      qC = qq[2];
-#undef OOSQRT2
-#undef OOSQRT3
-    }
+    _tenGlyphTransform(mA, parm, eval, evec, pW);
+
+    /* set color (in rgb) */
+    _tenGlyphColor(rgb, parm, eval, evec);
+
+    /* find axis, and superquad exponents qq[0,1,2] */
+    _tenGlyphSuperquad(&axis, qq, eval, parm->sqdSharp);
 
     /* add the glyph */
     if (parm->verbose >= 2) {
@@ -584,7 +651,7 @@ tenGlyphGen(limnObject *glyphsLimn, echoScene *glyphsEcho, tenGlyphParm *parm,
     if (glyphsLimn) {
       lookIdx = limnObjectLookAdd(glyphsLimn);
       look = glyphsLimn->look + lookIdx;
-      ELL_4V_SET_TT(look->rgba, float, R, G, B, 1);
+      ELL_4V_SET_TT(look->rgba, float, rgb[0], rgb[1], rgb[2], 1);
       ELL_3V_SET(look->kads, parm->ADSP[0], parm->ADSP[1], parm->ADSP[2]);
       look->spow = 0;
       switch (parm->glyphType) {
@@ -600,10 +667,9 @@ tenGlyphGen(limnObject *glyphsLimn, echoScene *glyphsEcho, tenGlyphParm *parm,
         break;
       case tenGlyphTypeSuperquad:
       default:
-        glyphIdx = limnObjectPolarSuperquadFancyAdd(glyphsLimn, lookIdx, axis,
-                                                    AIR_FLOAT(qA), AIR_FLOAT(qB),
-                                                    AIR_FLOAT(qC), 0, 2 * parm->facetRes,
-                                                    parm->facetRes);
+        glyphIdx = limnObjectPolarSuperquadFancyAdd(
+          glyphsLimn, lookIdx, axis, AIR_FLOAT(qq[0]), AIR_FLOAT(qq[1]),
+          AIR_FLOAT(qq[2]), 0, 2 * parm->facetRes, parm->facetRes);
         break;
       }
       ELL_4M_COPY_TT(mA_f, float, mA);
@@ -626,11 +692,11 @@ tenGlyphGen(limnObject *glyphsLimn, echoScene *glyphsEcho, tenGlyphParm *parm,
       case tenGlyphTypeSuperquad:
       default:
         eglyph = echoObjectNew(glyphsEcho, echoTypeSuperquad);
-        echoSuperquadSet(eglyph, axis, qA, qB);
+        echoSuperquadSet(eglyph, axis, qq[0], qq[1]);
         break;
       }
-      echoColorSet(eglyph, AIR_CAST(echoCol_t, R), AIR_CAST(echoCol_t, G),
-                   AIR_CAST(echoCol_t, B), 1);
+      echoColorSet(eglyph, AIR_CAST(echoCol_t, rgb[0]), AIR_CAST(echoCol_t, rgb[1]),
+                   AIR_CAST(echoCol_t, rgb[2]), 1);
       echoMatterPhongSet(glyphsEcho, eglyph, parm->ADSP[0], parm->ADSP[1], parm->ADSP[2],
                          parm->ADSP[3]);
       inst = echoObjectNew(glyphsEcho, echoTypeInstance);
@@ -929,3 +995,538 @@ tenGlyphBqdAbcUv(double abc[3], const double uv[2], double betaMax) {
             abcAll[zone][pvi[2]]);
   return;
 }
+
+/*
+** Instanced glyphs: tenGlyphInstGen makes the same glyphs as tenGlyphGen
+** (without the slice), but each glyph is only a transform and a color
+** applied to one of a set of shared base meshes, and tenGlyphInstPolyData
+** expands these into one limnPolyData.  In both, the per-glyph work is
+** divided among threads by _tenJobsRun.
+*/
+
+/* the (u,v) grid of tenGlyphParm->shapeRes can't be finer than this */
+#define _TEN_GLYPH_SHAPE_RES_MAX 1000
+
+tenGlyphInst * /* Biff: nope */
+tenGlyphInstNew(void) {
+  tenGlyphInst *gin;
+
+  gin = AIR_CALLOC(1, tenGlyphInst);
+  if (gin) {
+    gin->glyphNum = 0;
+    gin->baseNum = 0;
+    gin->base = NULL;
+    gin->baseIdx = NULL;
+    gin->sampleIdx = NULL;
+    gin->xform = NULL;
+    gin->rgba = NULL;
+  }
+  return gin;
+}
+
+static void
+_tenGlyphInstEmpty(tenGlyphInst *gin) {
+  unsigned int bi;
+
+  if (gin->base) {
+    for (bi = 0; bi < gin->baseNum; bi++) {
+      limnPolyDataNix(gin->base[bi]);
+    }
+  }
+  gin->base = AIR_CAST(limnPolyData **, airFree(gin->base));
+  gin->baseIdx = AIR_CAST(unsigned int *, airFree(gin->baseIdx));
+  gin->sampleIdx = AIR_CAST(unsigned int *, airFree(gin->sampleIdx));
+  gin->xform = AIR_CAST(float *, airFree(gin->xform));
+  gin->rgba = AIR_CAST(unsigned char *, airFree(gin->rgba));
+  gin->glyphNum = gin->baseNum = 0;
+  return;
+}
+
+tenGlyphInst * /* Biff: nope */
+tenGlyphInstNix(tenGlyphInst *gin) {
+
+  if (gin) {
+    _tenGlyphInstEmpty(gin);
+    airFree(gin);
+  }
+  return NULL;
+}
+
+/* what the threads of tenGlyphInstGen share */
+typedef struct {
+  tenGlyphParm *parm;
+  const Nrrd *nten, *npos;
+  const gageShape *shape; /* only used without npos */
+  double msFr[9];
+  unsigned int *code; /* per-sample: UINT_MAX if no glyph, else shape code */
+  tenGlyphInst *gin;
+} _tenGlyphInstState;
+
+/*
+** if sample idx gets a glyph, by the same criteria as tenGlyphGen, sets its
+** eigensystem and world-space position and returns non-zero
+*/
+static int
+_tenGlyphInstSample(float eval[3], float evec[9], double pW[3],
+                    const _tenGlyphInstState *st, unsigned int idx) {
+  const tenGlyphParm *parm;
+  const float *tdata;
+  double pI[3];
+
+  parm = st->parm;
+  tdata = AIR_CAST(const float *, st->nten->data) + 7 * AIR_SIZE_T(idx);
+  if (!(TEN_T_EXISTS(tdata))) {
+    return 0;
+  }
+  if (st->npos) {
+    ELL_3V_COPY(pW, AIR_CAST(const float *, st->npos->data) + 3 * AIR_SIZE_T(idx));
+    if (!(AIR_EXISTS(pW[0]) && AIR_EXISTS(pW[1]) && AIR_EXISTS(pW[2]))) {
+      return 0;
+    }
+  } else {
+    NRRD_COORD_GEN(pI, st->shape->size, 3, idx);
+    gageShapeItoW(st->shape, pW, pI);
+    if (parm->nmask
+        && !(nrrdFLookup[parm->nmask->type](parm->nmask->data, idx)
+             >= parm->maskThresh)) {
+      return 0;
+    }
+  }
+  _tenGlyphEigensystem(eval, evec, tdata, st->msFr);
+  if (parm->onlyPositive && eval[2] < 0) {
+    return 0;
+  }
+  if (!(tdata[0] >= parm->confThresh)) {
+    return 0;
+  }
+  if (!(tenAnisoEval_f(eval, parm->anisoType) >= parm->anisoThresh)) {
+    return 0;
+  }
+  return 1;
+}
+
+/*
+** which base mesh a glyph with eigenvalues eval (from sample idx) uses.
+** Boxes all use the same one, spheres and cylinders one per axis, and
+** superquadrics either one per (u,v) grid point, or (with shapeRes 0) one
+** per sample.  Sets in *numP the number of possible codes.
+*/
+static unsigned int
+_tenGlyphInstCode(unsigned int *numP, const _tenGlyphInstState *st,
+                  const float eval[3], unsigned int idx) {
+  unsigned int ret, res;
+  double qq[3], uv[2], deval[3];
+  int axis;
+
+  switch (st->parm->glyphType) {
+  case tenGlyphTypeBox:
+    *numP = 1;
+    ret = 0;
+    break;
+  case tenGlyphTypeSphere:
+  case tenGlyphTypeCylinder:
+    *numP = 2;
+    ret = 0;
+    if (eval) {
+      _tenGlyphSuperquad(&axis, qq, eval, st->parm->sqdSharp);
+      ret = !axis;
+    }
+    break;
+  case tenGlyphTypeSuperquad:
+  default:
+    res = st->parm->shapeRes;
+    if (!res) {
+      *numP = AIR_UINT(nrrdElementNumber(st->nten) / 7);
+      ret = idx;
+    } else {
+      *numP = (res + 1) * (res + 1);
+      ret = 0;
+      if (eval) {
+        ELL_3V_COPY(deval, eval);
+        tenGlyphBqdUvEval(uv, deval);
+        ret = (AIR_UINT(floor(AIR_CLAMP(0, uv[0], 1) * res + 0.5))
+               + (res + 1) * AIR_UINT(floor(AIR_CLAMP(0, uv[1], 1) * res + 0.5)));
+      }
+    }
+    break;
+  }
+  return ret;
+}
+
+/* makes in pld the base mesh for glyphs with the given code */
+static int /* Biff: 1 */
+_tenGlyphInstBaseSet(limnPolyData *pld, const _tenGlyphInstState *st,
+                     unsigned int code) {
+  static const char me[] = "_tenGlyphInstBaseSet";
+  /* rotation from the limnPolyData shapes, which are all around the Z axis,
+     to the limnObject glyph shapes around the X axis */
+  static const double rotX[16] = {0, 0, 1, 0, 0, -1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1};
+  const tenGlyphParm *parm;
+  unsigned int flag, res;
+  float eval[3], evec[9];
+  double uv[2], deval[3], qq[3], pW[3];
+  int axis, E;
+
+  parm = st->parm;
+  flag = (1 << limnPolyDataInfoNorm);
+  axis = 2;
+  switch (parm->glyphType) {
+  case tenGlyphTypeBox:
+    E = limnPolyDataCube(pld, flag, AIR_TRUE);
+    break;
+  case tenGlyphTypeSphere:
+    axis = code ? 0 : 2;
+    E = limnPolyDataPolarSphere(pld, flag, 2 * parm->facetRes, parm->facetRes);
+    break;
+  case tenGlyphTypeCylinder:
+    axis = code ? 0 : 2;
+    E = limnPolyDataCylinder(pld, flag, parm->facetRes, AIR_TRUE);
+    break;
+  case tenGlyphTypeSuperquad:
+  default:
+    res = parm->shapeRes;
+    if (res) {
+      uv[0] = AIR_CAST(double, code % (res + 1)) / res;
+      uv[1] = AIR_CAST(double, code / (res + 1)) / res;
+      tenGlyphBqdEvalUv(deval, uv);
+      ELL_3V_COPY_TT(eval, float, deval);
+    } else {
+      /* code is the index of the (only) sample with this shape */
+      _tenGlyphInstSample(eval, evec, pW, st, code);
+    }
+    _tenGlyphSuperquad(&axis, qq, eval, parm->sqdSharp);
+    E = limnPolyDataSpiralBetterquadric(pld, flag, AIR_FLOAT(qq[0]), AIR_FLOAT(qq[1]),
+                                        AIR_FLOAT(qq[2]), 0, 2 * parm->facetRes,
+                                        parm->facetRes);
+    break;
+  }
+  if (E) {
+    biffMovef(TEN, LIMN, "%s: trouble making base mesh %u", me, code);
+    return 1;
+  }
+  if (0 == axis) {
+    limnPolyDataTransform_d(pld, rotX);
+  }
+  return 0;
+}
+
+static int
+_tenGlyphInstCodeWork(void *_st, unsigned int ti, size_t lo, size_t hi, size_t *failP) {
+  _tenGlyphInstState *st;
+  float eval[3], evec[9];
+  double pW[3];
+  unsigned int idx, num;
+
+  AIR_UNUSED(ti);
+  AIR_UNUSED(failP);
+  st = AIR_CAST(_tenGlyphInstState *, _st);
+  for (idx = AIR_UINT(lo); idx < hi; idx++) {
+    st->code[idx] = (_tenGlyphInstSample(eval, evec, pW, st, idx)
+                       ? _tenGlyphInstCode(&num, st, eval, idx)
+                       : UINT_MAX);
+  }
+  return 0;
+}
+
+static int
+_tenGlyphInstGlyphWork(void *_st, unsigned int ti, size_t lo, size_t hi, size_t *failP) {
+  _tenGlyphInstState *st;
+  tenGlyphInst *gin;
+  float eval[3], evec[9];
+  double pW[3], mA[16], rgb[3];
+  unsigned int gi;
+
+  AIR_UNUSED(ti);
+  AIR_UNUSED(failP);
+  st = AIR_CAST(_tenGlyphInstState *, _st);
+  gin = st->gin;
+  for (gi = AIR_UINT(lo); gi < hi; gi++) {
+    _tenGlyphInstSample(eval, evec, pW, st, gin->sampleIdx[gi]);
+    _tenGlyphTransform(mA, st->parm, eval, evec, pW);
+    ELL_4M_COPY_TT(gin->xform + 16 * AIR_SIZE_T(gi), float, mA);
+    _tenGlyphColor(rgb, st->parm, eval, evec);
+    ELL_4V_SET_TT(gin->rgba + 4 * AIR_SIZE_T(gi), unsigned char,
+                  airIndexClamp(0.0, rgb[0], 1.0, 256),
+                  airIndexClamp(0.0, rgb[1], 1.0, 256),
+                  airIndexClamp(0.0, rgb[2], 1.0, 256), 255);
+  }
+  return 0;
+}
+
+/*
+******** tenGlyphInstGen
+**
+** makes in gin (replacing whatever was there) the same glyphs as tenGlyphGen
+** would, as transforms and colors of shared base meshes.  Finding which
+** samples get glyphs, and computing the glyph transforms and colors, are
+** done with parm->threadNum threads; the base meshes are made serially.
+** Slices (parm->doSlice) are not supported.  With superquadric glyphs,
+** parm->shapeRes controls how many base meshes there can be.
+*/
+int /* Biff: 1 */
+tenGlyphInstGen(tenGlyphInst *gin, tenGlyphParm *parm, const Nrrd *nten,
+                const Nrrd *npos) {
+  static const char me[] = "tenGlyphInstGen";
+  _tenGlyphInstState st;
+  _tenJobs jobs;
+  gageShape *shape;
+  airArray *mop;
+  unsigned int sampleNum, codeNum, idx, gi, bi, *baseOfCode, *baseCode;
+
+  if (!(gin && parm && nten)) {
+    biffAddf(TEN, "%s: got NULL pointer", me);
+    return 1;
+  }
+  mop = airMopNew();
+  shape = gageShapeNew();
+  shape->defaultCenter = nrrdCenterCell;
+  airMopAdd(mop, shape, (airMopper)gageShapeNix, airMopAlways);
+  if (_tenGlyphInputCheck(shape, parm, nten, npos, NULL)) {
+    biffAddf(TEN, "%s: trouble", me);
+    airMopError(mop);
+    return 1;
+  }
+  if (parm->doSlice) {
+    biffAddf(TEN, "%s: can't do slice with instanced glyphs", me);
+    airMopError(mop);
+    return 1;
+  }
+  if (!(parm->shapeRes <= _TEN_GLYPH_SHAPE_RES_MAX)) {
+    biffAddf(TEN, "%s: shapeRes %u > max %u", me, parm->shapeRes,
+             _TEN_GLYPH_SHAPE_RES_MAX);
+    airMopError(mop);
+    return 1;
+  }
+  if (npos) {
+    sampleNum = AIR_UINT(nten->axis[1].size);
+  } else {
+    sampleNum = shape->size[0] * shape->size[1] * shape->size[2];
+  }
+  st.parm = parm;
+  st.nten = nten;
+  st.npos = npos;
+  st.shape = shape;
+  _tenGlyphMeasurementFrame(st.msFr, nten);
+  st.gin = gin;
+  st.code = AIR_CALLOC(AIR_MAX(1, sampleNum), unsigned int);
+  _tenGlyphInstCode(&codeNum, &st, NULL, 0);
+  baseOfCode = AIR_CALLOC(AIR_MAX(1, codeNum), unsigned int);
+  baseCode = AIR_CALLOC(AIR_MAX(1, codeNum), unsigned int);
+  airMopAdd(mop, st.code, airFree, airMopAlways);
+  airMopAdd(mop, baseOfCode, airFree, airMopAlways);
+  airMopAdd(mop, baseCode, airFree, airMopAlways);
+  if (!(st.code && baseOfCode && baseCode)) {
+    biffAddf(TEN, "%s: couldn't allocate buffers for %u samples", me, sampleNum);
+    airMopError(mop);
+    return 1;
+  }
+
+  /* which samples get glyphs, and of what shape */
+  jobs.data = &st;
+  jobs.work = _tenGlyphInstCodeWork;
+  jobs.fetched = NULL;
+  jobs.jobNum = sampleNum;
+  jobs.chunk = 0;
+  if (_tenJobsRun(&jobs, parm->threadNum)) {
+    biffAddf(TEN, "%s: trouble finding glyphs", me);
+    airMopError(mop);
+    return 1;
+  }
+
+  /* base meshes are numbered in order of first use, so the result
+     doesn't depend on the number of threads */
+  _tenGlyphInstEmpty(gin);
+  for (idx = 0; idx < codeNum; idx++) {
+    baseOfCode[idx] = UINT_MAX;
+  }
+  for (idx = 0; idx < sampleNum; idx++) {
+    if (UINT_MAX == st.code[idx]) {
+      continue;
+    }
+    if (UINT_MAX == baseOfCode[st.code[idx]]) {
+      baseOfCode[st.code[idx]] = gin->baseNum;
+      baseCode[gin->baseNum++] = st.code[idx];
+    }
+    gin->glyphNum++;
+  }
+  gin->base = AIR_CALLOC(AIR_MAX(1, gin->baseNum), limnPolyData *);
+  gin->baseIdx = AIR_CALLOC(AIR_MAX(1, gin->glyphNum), unsigned int);
+  gin->sampleIdx = AIR_CALLOC(AIR_MAX(1, gin->glyphNum), unsigned int);
+  gin->xform = AIR_CALLOC(16 * AIR_SIZE_T(AIR_MAX(1, gin->glyphNum)), float);
+  gin->rgba = AIR_CALLOC(4 * AIR_SIZE_T(AIR_MAX(1, gin->glyphNum)), unsigned char);
+  if (!(gin->base && gin->baseIdx && gin->sampleIdx && gin->xform && gin->rgba)) {
+    biffAddf(TEN, "%s: couldn't allocate for %u glyphs", me, gin->glyphNum);
+    _tenGlyphInstEmpty(gin);
+    airMopError(mop);
+    return 1;
+  }
+  gi = 0;
+  for (idx = 0; idx < sampleNum; idx++) {
+    if (UINT_MAX != st.code[idx]) {
+      gin->sampleIdx[gi] = idx;
+      gin->baseIdx[gi] = baseOfCode[st.code[idx]];
+      gi++;
+    }
+  }
+  for (bi = 0; bi < gin->baseNum; bi++) {
+    if (!(gin->base[bi] = limnPolyDataNew())
+        || _tenGlyphInstBaseSet(gin->base[bi], &st, baseCode[bi])) {
+      biffAddf(TEN, "%s: trouble making base mesh %u of %u", me, bi, gin->baseNum);
+      _tenGlyphInstEmpty(gin);
+      airMopError(mop);
+      return 1;
+    }
+  }
+
+  /* glyph transforms and colors */
+  jobs.work = _tenGlyphInstGlyphWork;
+  jobs.jobNum = gin->glyphNum;
+  jobs.chunk = 0;
+  if (_tenJobsRun(&jobs, parm->threadNum)) {
+    biffAddf(TEN, "%s: trouble setting glyphs", me);
+    _tenGlyphInstEmpty(gin);
+    airMopError(mop);
+    return 1;
+  }
+  if (parm->verbose) {
+    fprintf(stderr, "%s: %u glyphs from %u samples, with %u base meshes\n", me,
+            gin->glyphNum, sampleNum, gin->baseNum);
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
+
+/* what the threads of tenGlyphInstPolyData share */
+typedef struct {
+  limnPolyData *pld;
+  const tenGlyphInst *gin;
+  unsigned int *vertStart, *indxStart, *primStart; /* per glyph */
+} _tenGlyphInstPolyDataState;
+
+static int
+_tenGlyphInstPolyDataWork(void *_st, unsigned int ti, size_t lo, size_t hi,
+                          size_t *failP) {
+  _tenGlyphInstPolyDataState *st;
+  const limnPolyData *base;
+  limnPolyData *pld;
+  const float *mm;
+  double mat[9], nmat[9], norm[3], len;
+  unsigned int gi, vi, ii, pi, vo;
+  float *xyzw;
+
+  AIR_UNUSED(ti);
+  AIR_UNUSED(failP);
+  st = AIR_CAST(_tenGlyphInstPolyDataState *, _st);
+  pld = st->pld;
+  for (gi = AIR_UINT(lo); gi < hi; gi++) {
+    base = st->gin->base[st->gin->baseIdx[gi]];
+    mm = st->gin->xform + 16 * AIR_SIZE_T(gi);
+    /* normals are transformed by the cofactor matrix of the linear part,
+       which (unlike the inverse-transpose) exists for flattened glyphs */
+    ELL_34M_EXTRACT(mat, mm);
+    ELL_3V_CROSS(nmat + 0, mat + 3, mat + 6);
+    ELL_3V_CROSS(nmat + 3, mat + 6, mat + 0);
+    ELL_3V_CROSS(nmat + 6, mat + 0, mat + 3);
+    vo = st->vertStart[gi];
+    for (vi = 0; vi < base->xyzwNum; vi++) {
+      xyzw = pld->xyzw + 4 * AIR_SIZE_T(vo + vi);
+      ELL_4MV_MUL(xyzw, mm, base->xyzw + 4 * vi);
+      ELL_3MV_MUL(norm, nmat, base->norm + 3 * vi);
+      len = ELL_3V_LEN(norm);
+      if (len) {
+        ELL_3V_SCALE(norm, 1 / len, norm);
+      }
+      ELL_3V_COPY_TT(pld->norm + 3 * AIR_SIZE_T(vo + vi), float, norm);
+      ELL_4V_COPY(pld->rgba + 4 * AIR_SIZE_T(vo + vi),
+                  st->gin->rgba + 4 * AIR_SIZE_T(gi));
+    }
+    for (ii = 0; ii < base->indxNum; ii++) {
+      pld->indx[st->indxStart[gi] + ii] = vo + base->indx[ii];
+    }
+    for (pi = 0; pi < base->primNum; pi++) {
+      pld->type[st->primStart[gi] + pi] = base->type[pi];
+      pld->icnt[st->primStart[gi] + pi] = base->icnt[pi];
+    }
+  }
+  return 0;
+}
+
+/*
+******** tenGlyphInstPolyData
+**
+** puts in pld (with per-vertex normals and colors) all the glyphs of gin,
+** in order.  pld is allocated once at its final size, and then filled by
+** threadNum threads.
+*/
+int /* Biff: 1 */
+tenGlyphInstPolyData(limnPolyData *pld, const tenGlyphInst *gin,
+                     unsigned int threadNum) {
+  static const char me[] = "tenGlyphInstPolyData";
+  _tenGlyphInstPolyDataState st;
+  _tenJobs jobs;
+  const limnPolyData *base;
+  airArray *mop;
+  airULLong vertNum, indxNum, primNum;
+  unsigned int gi, bi, allocNum;
+
+  if (!(pld && gin)) {
+    biffAddf(TEN, "%s: got NULL pointer", me);
+    return 1;
+  }
+  for (bi = 0; bi < gin->baseNum; bi++) {
+    if (!(gin->base[bi] && gin->base[bi]->norm)) {
+      biffAddf(TEN, "%s: base mesh %u missing or without normals", me, bi);
+      return 1;
+    }
+  }
+  mop = airMopNew();
+  allocNum = AIR_MAX(1, gin->glyphNum);
+  st.vertStart = AIR_CALLOC(allocNum, unsigned int);
+  st.indxStart = AIR_CALLOC(allocNum, unsigned int);
+  st.primStart = AIR_CALLOC(allocNum, unsigned int);
+  airMopAdd(mop, st.vertStart, airFree, airMopAlways);
+  airMopAdd(mop, st.indxStart, airFree, airMopAlways);
+  airMopAdd(mop, st.primStart, airFree, airMopAlways);
+  if (!(st.vertStart && st.indxStart && st.primStart)) {
+    biffAddf(TEN, "%s: couldn't allocate offsets for %u glyphs", me, gin->glyphNum);
+    airMopError(mop);
+    return 1;
+  }
+  vertNum = indxNum = primNum = 0;
+  for (gi = 0; gi < gin->glyphNum; gi++) {
+    base = gin->base[gin->baseIdx[gi]];
+    st.vertStart[gi] = AIR_UINT(vertNum);
+    st.indxStart[gi] = AIR_UINT(indxNum);
+    st.primStart[gi] = AIR_UINT(primNum);
+    vertNum += base->xyzwNum;
+    indxNum += base->indxNum;
+    primNum += base->primNum;
+    if (vertNum > UINT_MAX || indxNum > UINT_MAX || primNum > UINT_MAX) {
+      biffAddf(TEN, "%s: glyphs past glyph %u don't fit in a limnPolyData", me, gi);
+      airMopError(mop);
+      return 1;
+    }
+  }
+  if (limnPolyDataAlloc(pld, (1 << limnPolyDataInfoRGBA) | (1 << limnPolyDataInfoNorm),
+                        AIR_UINT(vertNum), AIR_UINT(indxNum), AIR_UINT(primNum))) {
+    biffMovef(TEN, LIMN, "%s: couldn't allocate output", me);
+    airMopError(mop);
+    return 1;
+  }
+  st.pld = pld;
+  st.gin = gin;
+  jobs.data = &st;
+  jobs.work = _tenGlyphInstPolyDataWork;
+  jobs.fetched = NULL;
+  jobs.jobNum = gin->glyphNum;
+  jobs.chunk = 0;
+  if (_tenJobsRun(&jobs, threadNum)) {
+    biffAddf(TEN, "%s: trouble", me);
+    airMopError(mop);
+    return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
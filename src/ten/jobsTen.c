@@ -0,0 +1,202 @@
+/*
+  Teem: Tools to process and visualize scientific data and images
+  Copyright (C) 2009--2023  University of Chicago
+  Copyright (C) 2005--2008  Gordon Kindlmann
+  Copyright (C) 1998--2004  University of Utah
+
+  This library is free software; you can redistribute it and/or modify it under the terms
+  of the GNU Lesser General Public License (LGPL) as published by the Free Software
+  Foundation; either version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also include exceptions to
+  the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+  PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with
+  this library; if not, write to Free Software Foundation, Inc., 51 Franklin Street,
+  Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "ten.h"
+#include "privateTen.h"
+
+/*
+** The one place where ten hands out independent jobs (samples, scanlines,
+** seeds, DWIs, glyphs) to a pool of threads; see _tenJobs in privateTen.h
+*/
+
+typedef struct {
+  _tenJobs *jobs;
+  unsigned int ti;
+  airThread *thread;
+} _tenJobsTask;
+
+/*
+** the number of threads used to do jobNum jobs, which is also how many
+** sets of per-task buffers the caller needs
+*/
+unsigned int
+_tenJobsThreadNum(unsigned int threadNum, size_t jobNum) {
+
+  threadNum = airThreadCapable ? threadNum : 1;
+  threadNum = AIR_UINT(AIR_MIN(threadNum, jobNum));
+  return AIR_MAX(1, threadNum);
+}
+
+/*
+** sets *loP and *hiP to the [lo,hi) range of jobs to do next;
+** returns zero when there's nothing left to do
+*/
+static int
+_tenJobsFetch(_tenJobs *jobs, size_t *loP, size_t *hiP) {
+  int ret;
+
+  if (jobs->mutex) {
+    airThreadMutexLock(jobs->mutex);
+  }
+  ret = !jobs->failed && jobs->jobNext < jobs->jobNum;
+  if (ret) {
+    *loP = jobs->jobNext;
+    *hiP = AIR_MIN(jobs->jobNext + jobs->chunk, jobs->jobNum);
+    jobs->jobNext = *hiP;
+    if (jobs->fetched) {
+      jobs->fetched(jobs->data, *loP);
+    }
+  }
+  if (jobs->mutex) {
+    airThreadMutexUnlock(jobs->mutex);
+  }
+  return ret;
+}
+
+static void *
+_tenJobsWorker(void *_task) {
+  _tenJobsTask *task;
+  _tenJobs *jobs;
+  size_t lo, hi, fail;
+  int ret;
+
+  task = AIR_CAST(_tenJobsTask *, _task);
+  jobs = task->jobs;
+  while (_tenJobsFetch(jobs, &lo, &hi)) {
+    fail = lo;
+    ret = jobs->work(jobs->data, task->ti, lo, hi, &fail);
+    if (ret) {
+      if (jobs->mutex) {
+        airThreadMutexLock(jobs->mutex);
+      }
+      /* jobs are handed out in order, and every range that was handed out
+         is finished unless it fails, so the lowest failed job recorded is
+         the first job (in order) to fail */
+      if (!jobs->failed || fail < jobs->failJob) {
+        jobs->failJob = fail;
+        jobs->failRet = ret;
+      }
+      jobs->failed = AIR_TRUE;
+      if (jobs->mutex) {
+        airThreadMutexUnlock(jobs->mutex);
+      }
+      break;
+    }
+  }
+  return _task;
+}
+
+/*
+******** _tenJobsRun
+**
+** does the jobs->jobNum jobs with _tenJobsThreadNum(threadNum,
+** jobs->jobNum) threads, the first of which is this one.  Returns non-zero
+** only when there was trouble with the threads themselves; whether some job
+** failed is recorded in jobs->failed, jobs->failJob, and jobs->failRet, for
+** the caller to report (with biff) once all the threads are done.
+*/
+int /* Biff: 1 */
+_tenJobsRun(_tenJobs *jobs, unsigned int threadNum) {
+  static const char me[] = "_tenJobsRun";
+  _tenJobsTask *task;
+  airArray *mop;
+  unsigned int ti, tj;
+  void *ret;
+  int E;
+
+  if (!(jobs && jobs->work)) {
+    biffAddf(TEN, "%s: got NULL pointer", me);
+    return 1;
+  }
+  threadNum = _tenJobsThreadNum(threadNum, jobs->jobNum);
+  if (!jobs->chunk) {
+    jobs->chunk = jobs->jobNum / (threadNum * _TEN_JOBS_FETCH_PER_THREAD);
+    jobs->chunk = AIR_MAX(1, jobs->chunk);
+  }
+  jobs->jobNext = 0;
+  jobs->mutex = NULL;
+  jobs->failed = AIR_FALSE;
+  jobs->failRet = 0;
+  jobs->failJob = 0;
+  mop = airMopNew();
+  task = AIR_CALLOC(threadNum, _tenJobsTask);
+  if (!task) {
+    biffAddf(TEN, "%s: couldn't allocate %u tasks", me, threadNum);
+    airMopError(mop);
+    return 1;
+  }
+  airMopAdd(mop, task, airFree, airMopAlways);
+  for (ti = 0; ti < threadNum; ti++) {
+    task[ti].jobs = jobs;
+    task[ti].ti = ti;
+    if (!ti) {
+      /* the first task runs in this thread */
+      task[ti].thread = NULL;
+    } else {
+      task[ti].thread = airThreadNew();
+      if (!task[ti].thread) {
+        biffAddf(TEN, "%s: couldn't allocate thread %u", me, ti);
+        airMopError(mop);
+        return 1;
+      }
+      airMopAdd(mop, task[ti].thread, (airMopper)airThreadNix, airMopAlways);
+    }
+  }
+  if (threadNum > 1) {
+    jobs->mutex = airThreadMutexNew();
+    if (!jobs->mutex) {
+      biffAddf(TEN, "%s: couldn't allocate mutex", me);
+      airMopError(mop);
+      return 1;
+    }
+    airMopAdd(mop, jobs->mutex, (airMopper)airThreadMutexNix, airMopAlways);
+  }
+  for (ti = 1; ti < threadNum; ti++) {
+    if (airThreadStart(task[ti].thread, _tenJobsWorker, task + ti)) {
+      biffAddf(TEN, "%s: couldn't start thread %u", me, ti);
+      /* let the threads already started finish up, then wait for them */
+      airThreadMutexLock(jobs->mutex);
+      jobs->jobNext = jobs->jobNum;
+      airThreadMutexUnlock(jobs->mutex);
+      for (tj = 1; tj < ti; tj++) {
+        airThreadJoin(task[tj].thread, &ret);
+      }
+      jobs->mutex = NULL;
+      airMopError(mop);
+      return 1;
+    }
+  }
+  _tenJobsWorker(task + 0);
+  E = 0;
+  for (ti = 1; ti < threadNum; ti++) {
+    if (airThreadJoin(task[ti].thread, &ret)) {
+      biffAddf(TEN, "%s: couldn't join thread %u", me, ti);
+      E = 1;
+    }
+  }
+  jobs->mutex = NULL;
+  if (E) {
+    airMopError(mop);
+    return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
@@ -98,9 +98,41 @@ extern "C" {
 #define USAGE_PARSE(INFO)     USAGE(INFO) PARSE(INFO)
 #define USAGE_JUSTPARSE(INFO) USAGE(INFO) JUSTPARSE(INFO)
 
+/* # tensors that "tend eval -batch" and "tend evec -batch" give at a time
+   to tenEigensolveBatch_f */
+#define TEND_EIGEN_BATCH 1024
+
 /* enumsTen.c */
 extern const airEnum _tenGage;
 
+/* jobsTen.c: doing independent jobs with a pool of threads */
+/* unless the caller says otherwise (with _tenJobs->chunk), a thread takes
+   as many jobs per fetch as gives about this many fetches per thread, so
+   that threads that happen to get cheap jobs go on to do more of them */
+#define _TEN_JOBS_FETCH_PER_THREAD 32
+typedef struct {
+  /* input */
+  void *data; /* whatever the work function needs */
+  int (*work)(void *data, unsigned int ti, size_t lo, size_t hi, size_t *failP);
+  /* ^ does jobs [lo,hi) in task ti (with per-task buffers, if any, in
+     data); returns non-zero on error, after setting *failP to the job that
+     failed.  Since it runs in many threads at once, it can't use biff */
+  void (*fetched)(void *data, size_t lo);
+  /* ^ if non-NULL: called (with the lock held) when jobs [lo,...) are
+     handed out, e.g. for progress indication */
+  size_t jobNum, /* number of jobs */
+    chunk;       /* jobs per fetch, or 0 to use _TEN_JOBS_FETCH_PER_THREAD */
+  /* internal */
+  size_t jobNext;        /* next job to hand out */
+  airThreadMutex *mutex; /* NULL if single-threaded */
+  /* output */
+  int failed,     /* some job failed: no more jobs were handed out */
+    failRet;      /* what work returned for the lowest-numbered failed job */
+  size_t failJob; /* the lowest-numbered failed job */
+} _tenJobs;
+extern unsigned int _tenJobsThreadNum(unsigned int threadNum, size_t jobNum);
+extern int _tenJobsRun(_tenJobs *jobs, unsigned int threadNum);
+
 /* qseg.c: 2-tensor estimation */
 extern void _tenQball(const double b, const int gradcount, const double svals[],
                       const double grads[], double qvals[]);
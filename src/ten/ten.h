@@ -146,7 +146,7 @@ enum {
 /*
 ******** tenGlyphParm struct
 **
-** all input parameters to tenGlyphGen
+** all input parameters to tenGlyphGen and tenGlyphInstGen
 */
 typedef struct {
   int verbose;
@@ -188,8 +188,33 @@ typedef struct {
   size_t slicePos;
   int doSlice, sliceAnisoType;
   float sliceOffset, sliceBias, sliceGamma;
+
+  /* only for tenGlyphInstGen: if shapeRes is non-zero, superquadric glyph
+     shapes are quantized to the nearest of the (shapeRes+1)^2 points on a
+     grid over the Betterquad (u,v) parameterization of eigenvalue shape
+     (tenGlyphBqdUvEval), so that glyphs of similar shape share a mesh.
+     With shapeRes 0 each superquadric glyph has its own mesh.  The work
+     is divided among threadNum threads */
+  unsigned int shapeRes, threadNum;
 } tenGlyphParm;
 
+/*
+******** tenGlyphInst struct
+**
+** glyphs made by tenGlyphInstGen: instead of a mesh per glyph, there are
+** baseNum meshes base[], each centered at the origin with unit radius,
+** shared by all glyphs of the same shape.  Glyph gi is base[baseIdx[gi]]
+** transformed by the (row-major homogeneous) xform + 16*gi, with color
+** rgba + 4*gi; it came from tensor sample sampleIdx[gi].
+*/
+typedef struct {
+  unsigned int glyphNum, baseNum;
+  limnPolyData **base;
+  unsigned int *baseIdx, *sampleIdx;
+  float *xform;
+  unsigned char *rgba;
+} tenGlyphInst;
+
 #define TEN_ANISO_DESC                                                                  \
   "All the Westin metrics come in two versions.  Currently supported:\n "               \
   "\b\bo \"cl1\", \"cl2\": Westin's linear\n "                                          \
@@ -776,9 +801,13 @@ enum {
                                 instead of default world */
   tenFiberParmWPunct,        /* 3: tensor-line parameter */
   tenFiberParmVerbose,       /* 4: verbosity */
+  tenFiberParmThreadNum,     /* 5: # threads for tenFiberMultiTrace */
+  tenFiberParmDwiFitCache,   /* 6: with DWIs, fit single tensors once at
+                                voxels and interpolate them (see
+                                tenDwiGageKindFitCacheSet) */
   tenFiberParmLast
 };
-#define TEN_FIBER_PARM_MAX 4
+#define TEN_FIBER_PARM_MAX 6
 
 enum {
   tenTripleTypeUnknown,    /* 0: nobody knows */
@@ -815,6 +844,7 @@ typedef struct {
     anisoSpeedType,         /* base step size is function of this anisotropy */
     stop,                   /* BITFLAG for different reasons to stop a fiber */
     useIndexSpace,          /* output in index space, not world space */
+    dwiFitCache,            /* with useDwi: use the DWI kind's fit cache */
     verbose;                /* blah blah blah */
   double anisoThresh,       /* anisotropy threshold */
     anisoSpeedFunc[3];      /* parameters of mapping aniso to speed */
@@ -828,7 +858,8 @@ typedef struct {
     minRadius,              /* minimum radius of curvature of path */
     minFraction;            /* minimum fractional constituency in multi-tensor */
   double wPunct;            /* knob for tensor lines */
-  unsigned int ten2Which;   /* which path to follow in 2-tensor tracking */
+  unsigned int ten2Which,   /* which path to follow in 2-tensor tracking */
+    threadNum;              /* # threads to use in tenFiberMultiTrace */
   /* ---- internal ----- */
   gageQuery query;      /* query we'll send to gageQuerySet */
   int halfIdx,          /* current fiber half being computed (0 or 1) */
@@ -842,6 +873,9 @@ typedef struct {
   int lastDirSet,       /* lastDir[] is usefully set */
     lastTenSet;         /* lastTen[] is usefully set */
   unsigned int ten2Use; /* which of the 2-tensors was last used */
+  int useBiff;          /* if zero, tracing a fiber doesn't use biff (except
+                           when allocating fails); this is how the threads of
+                           tenFiberMultiTrace stay off biff */
   gageContext *gtx;     /* wrapped around pvl */
   gagePerVolume *pvl;   /* wrapped around dtvol */
 
@@ -895,6 +929,45 @@ typedef struct {
   airArray *fiberArr;
 } tenFiberMulti;
 
+/*
+******** tenFiberSink
+**
+** for writing fibers to a file as they are traced, instead of keeping
+** all of them in a tenFiberMulti.  Fibers given to tenFiberSinkAdd are
+** filtered, and kept ones are buffered as line strips until there are
+** chunkFiberNum of them, at which point they are written out as one LMPD
+** polydata (see limnPolyDataWriteLMPD).  The output file is thus a
+** sequence of LMPD "chunks", which tenFiberSinkRead can read back into
+** one limnPolyData.  The fields up to "internal" can be set by the user
+*/
+typedef struct {
+  /* ---- input -------- */
+  FILE *file;                 /* where the chunks go; not opened, closed, or
+                                 otherwise owned by the sink */
+  unsigned int chunkFiberNum; /* # fibers to buffer before writing a chunk */
+  double lenRange[2];         /* fibers with total (both halves) length
+                                 outside this range are dropped */
+  int dropStop;               /* BITFLAG of (1 << tenFiberStop*) values;
+                                 fibers for which either half stopped for one
+                                 of these reasons are dropped */
+  const gageShape *shape;     /* if non-NULL, vertices are converted from
+                                 index to world space with this */
+  int xformUse;               /* then apply xform to vertex positions */
+  double xform[16];           /* homogeneous transform */
+  /* ---- internal ----- */
+  float *xyzw;             /* buffered vertices */
+  unsigned int *indx,      /* buffered vertex indices */
+    *icnt,                 /* buffered per-fiber vertex counts */
+    vertNum, fiberNum;     /* # vertices and fibers buffered */
+  unsigned char *type;     /* buffered primitive types */
+  airArray *xyzwArr, *indxArr, *icntArr, *typeArr;
+  /* ---- output ------- */
+  unsigned int fiberAdded, /* # fibers given to tenFiberSinkAdd */
+    fiberWritten,          /* # fibers (not dropped) written out */
+    vertWritten,           /* # vertices written out */
+    chunkWritten;          /* # chunks written out */
+} tenFiberSink;
+
 /*
 ******** struct tenEmBimodalParm
 **
@@ -1037,11 +1110,16 @@ typedef struct {
     negEvalShift,          /* if non-zero, shift eigenvalues upwards so that
                               smallest one is non-negative */
     progress;              /* progress indication for volume processing */
-  unsigned int WLSIterNum; /* number of iterations for WLS */
+  unsigned int WLSIterNum, /* number of iterations for WLS */
+    threadNum;             /* number of threads to use in
+                              tenEstimate1TensorVolume4D() */
   /* internal -------- */
   /* a "dwi" in here is basically any value (diffusion-weighted or not)
      that varies as a function of the model parameters being estimated */
   int flag[128];          /* flags for state management */
+  int useBiff;            /* if zero, errors in estimating a single sample are
+                             not recorded with biff; this is how the threads of
+                             tenEstimate1TensorVolume4D stay off biff */
   unsigned int allNum,    /* total number of images (Dwi and non-Dwi) */
     dwiNum;               /* number of Dwis */
   Nrrd *nbmat,            /* B-matrices (dwiNum of them) for the Dwis, with
@@ -1055,7 +1133,9 @@ typedef struct {
     *bnorm,               /* frob norm of B-matrix, allocated for allNum */
     *allTmp, *dwiTmp,     /* for storing intermediate values,
                              allocated for allNum and dwiNum respectively */
-    *dwi;                 /* the Dwi values, allocated for dwiNum */
+    *dwi,                 /* the Dwi values, allocated for dwiNum */
+    *block;               /* for estimating a block of samples at once,
+                             allocated along with dwi (see estimate.c) */
   unsigned char *skipLut; /* skipLut[i] non-zero if we should ignore all[i],
                              allocated for allNum */
   /* output ---------- */
@@ -1074,13 +1154,22 @@ typedef struct {
 **
 ** the kind data has static info that is set by the user
 ** and then not altered-- or else it wouldn't really be per-kind,
-** and it wouldn't be thread-safe
+** and it wouldn't be thread-safe.  The exception is the cache of
+** per-voxel tensor fits (see tenDwiGageKindFitCacheSet), which is
+** only accessed with cacheMutex locked.
 */
 typedef struct {
   Nrrd *ngrad, *nbmat; /* owned by us */
   double thresh, soft, bval, valueMin;
   int est1Method, est2Method;
   unsigned int randSeed;
+  int fitCache;               /* single tensors are fit (once) at voxels,
+                                 and interpolated, rather than being fit
+                                 to interpolated DWIs */
+  const Nrrd *cacheNin;       /* the DWI volume that the cache is for */
+  double *cacheTen;           /* 7 tensor values per voxel of cacheNin */
+  unsigned char *cacheDone;   /* per voxel: cacheTen has been set */
+  airThreadMutex *cacheMutex; /* guards cacheNin, cacheTen, cacheDone */
 } tenDwiGageKindData;
 
 /*
@@ -1112,6 +1201,13 @@ typedef struct {
   unsigned int levmarMaxIter;
   double levmarTau, levmarEps1, levmarEps2, levmarEps3, levmarDelta, levmarMinCp;
   double levmarInfo[9]; /* output */
+  /* with kindData->fitCache: */
+  double *fitTen;           /* fitted tensors at voxels of the (2r)^3
+                               neighborhood (same ordering as pvl->iv3) */
+  unsigned char *fitHave;   /* per neighborhood voxel: fitTen is set */
+  unsigned int fitLen,      /* (2r)^3, # voxels in neighborhood */
+    fitIdx[3];              /* the ctx->point.idx[] fitTen is for */
+  int fitValid;             /* fitTen is valid for fitIdx */
 } tenDwiGagePvlData;
 
 typedef struct {
@@ -1310,6 +1406,12 @@ TEN_EXPORT int tenGlyphParmCheck(tenGlyphParm *parm, const Nrrd *nten, const Nrr
                                  const Nrrd *nslc);
 TEN_EXPORT int tenGlyphGen(limnObject *glyphs, echoScene *scene, tenGlyphParm *parm,
                            const Nrrd *nten, const Nrrd *npos, const Nrrd *nslc);
+TEN_EXPORT tenGlyphInst *tenGlyphInstNew(void);
+TEN_EXPORT tenGlyphInst *tenGlyphInstNix(tenGlyphInst *gin);
+TEN_EXPORT int tenGlyphInstGen(tenGlyphInst *gin, tenGlyphParm *parm, const Nrrd *nten,
+                               const Nrrd *npos);
+TEN_EXPORT int tenGlyphInstPolyData(limnPolyData *pld, const tenGlyphInst *gin,
+                                    unsigned int threadNum);
 TEN_EXPORT unsigned int tenGlyphBqdZoneEval(const double eval[3]);
 TEN_EXPORT void tenGlyphBqdUvEval(double uv[2], const double eval[3]);
 TEN_EXPORT void tenGlyphBqdEvalUv(double eval[3], const double uv[2]);
@@ -1327,6 +1429,10 @@ TEN_EXPORT int tenExpand(Nrrd *tnine, const Nrrd *tseven, double scale, double t
 TEN_EXPORT int tenShrink(Nrrd *tseven, const Nrrd *nconf, const Nrrd *tnine);
 TEN_EXPORT int tenEigensolve_f(float eval[3], float evec[9], const float ten[7]);
 TEN_EXPORT int tenEigensolve_d(double eval[3], double evec[9], const double ten[7]);
+TEN_EXPORT void tenEigensolveBatch_f(float *eval, float *evec, const float *ten,
+                                     size_t num, unsigned int jacobiIter);
+TEN_EXPORT void tenEigensolveBatch_d(double *eval, double *evec, const double *ten,
+                                     size_t num, unsigned int jacobiIter);
 TEN_EXPORT void tenMakeSingle_f(float ten[7], float conf, const float eval[3],
                                 const float evec[9]);
 TEN_EXPORT void tenMakeSingle_d(double ten[7], double conf, const double eval[3],
@@ -1401,6 +1507,7 @@ TEN_EXPORT int tenSimulate(Nrrd *ndwi, const Nrrd *nT2, const Nrrd *nten,
 TEN_EXPORT tenEstimateContext *tenEstimateContextNew(void);
 TEN_EXPORT void tenEstimateVerboseSet(tenEstimateContext *tec, int verbose);
 TEN_EXPORT void tenEstimateNegEvalShiftSet(tenEstimateContext *tec, int doit);
+TEN_EXPORT void tenEstimateThreadNumSet(tenEstimateContext *tec, unsigned int threadNum);
 TEN_EXPORT int tenEstimateMethodSet(tenEstimateContext *tec, int estMethod);
 TEN_EXPORT int tenEstimateSigmaSet(tenEstimateContext *tec, double sigma);
 TEN_EXPORT int tenEstimateValueMinSet(tenEstimateContext *tec, double valueMin);
@@ -1521,16 +1628,25 @@ TEN_EXPORT int tenFiberMultiPolyData(tenFiberContext *tfx, limnPolyData *lpld,
 TEN_EXPORT int tenFiberMultiProbeVals(tenFiberContext *tfx, Nrrd *nval,
                                       tenFiberMulti *tfml);
 
+/* fiberSink.c */
+TEN_EXPORT tenFiberSink *tenFiberSinkNew(FILE *file, unsigned int chunkFiberNum);
+TEN_EXPORT tenFiberSink *tenFiberSinkNix(tenFiberSink *tfsk);
+TEN_EXPORT int tenFiberSinkAdd(tenFiberSink *tfsk, const tenFiberSingle *tfbs);
+TEN_EXPORT int tenFiberSinkFlush(tenFiberSink *tfsk);
+TEN_EXPORT int tenFiberSinkRead(limnPolyData *lpld, FILE *file);
+TEN_EXPORT int tenFiberMultiTraceSink(tenFiberContext *tfx, tenFiberSink *tfsk,
+                                      const Nrrd *nseed);
+
 /* epireg.c */
 TEN_EXPORT int tenEpiRegister3D(Nrrd **nout, Nrrd **ndwi, unsigned int dwiLen,
                                 Nrrd *ngrad, int reference, double bwX, double bwY,
                                 double fitFrac, double DWthr, int doCC,
-                                const NrrdKernel *kern, double *kparm, int progress,
-                                int verbose);
+                                const NrrdKernel *kern, double *kparm,
+                                unsigned int threadNum, int progress, int verbose);
 TEN_EXPORT int tenEpiRegister4D(Nrrd *nout, Nrrd *nin, Nrrd *ngrad, int reference,
                                 double bwX, double bwY, double fitFrac, double DWthr,
                                 int doCC, const NrrdKernel *kern, double *kparm,
-                                int progress, int verbose);
+                                unsigned int threadNum, int progress, int verbose);
 
 /* experSpec.c */
 TEN_EXPORT tenExperSpec *tenExperSpecNew(void);
@@ -1571,8 +1687,8 @@ TEN_EXPORT int tenModelSqeFit(Nrrd *nparm, Nrrd **nsqeP, Nrrd **nconvP, Nrrd **n
                               const tenModel *model, const tenExperSpec *espec,
                               const Nrrd *ndwi, int knownB0, int saveB0, int typeOut,
                               unsigned int minIter, unsigned int maxIter,
-                              unsigned int starts, double convEps, airRandMTState *rng,
-                              int verbose);
+                              unsigned int starts, int warmStart, double convEps,
+                              airRandMTState *rng, unsigned int threadNum, int verbose);
 TEN_EXPORT int tenModelNllFit(Nrrd *nparm, Nrrd **nnllP, const tenModel *model,
                               const tenExperSpec *espec, const Nrrd *ndwi, int rician,
                               double sigma, int knownB0);
@@ -1645,6 +1761,8 @@ TEN_EXPORT int tenBVecNonLinearFit(Nrrd *nout, const Nrrd *nin, double *bb, doub
 
 /* tenGage.c */
 TEN_EXPORT gageKind *const tenGageKind;
+TEN_EXPORT int tenGageEigenVolume(Nrrd *nout, const Nrrd *nin);
+TEN_EXPORT int tenGageEigenVolumeSet(gagePerVolume *pvl, const Nrrd *neig);
 
 /* tenDwiGage.c */
 /* we can't declare or define a tenDwiGageKind->name (analogous to
@@ -1661,6 +1779,7 @@ TEN_EXPORT int tenDwiGageKindSet(gageKind *dwiKind, double thresh, double soft,
                                  const Nrrd *nbmat, int emethod1, int emethod2,
                                  unsigned int randSeed);
 TEN_EXPORT int tenDwiGageKindCheck(const gageKind *kind);
+TEN_EXPORT int tenDwiGageKindFitCacheSet(gageKind *dwiKind, int fitCache);
 
 /* bimod.c */
 TEN_EXPORT tenEMBimodalParm *tenEMBimodalParmNew(void);
@@ -323,6 +323,121 @@ _tenLevmarPeledCB(double *pp, double *xx, int mm, int nn, void *_pvlData) {
   return;
 }
 #endif
+
+/* index into the fit cache of voxel vi of the neighborhood starting
+   at lo[], clamped (like the iv3) to the volume of size sz[] */
+static size_t
+_tenDwiGageCacheIndex(const int lo[3], const int sz[3], unsigned int fd,
+                      unsigned int vi) {
+  size_t xi, yi, zi;
+
+  xi = AIR_CAST(size_t, AIR_CLAMP(0, lo[0] + AIR_INT(vi % fd), sz[0]-1));
+  yi = AIR_CAST(size_t, AIR_CLAMP(0, lo[1] + AIR_INT((vi/fd) % fd), sz[1]-1));
+  zi = AIR_CAST(size_t, AIR_CLAMP(0, lo[2] + AIR_INT(vi/fd/fd), sz[2]-1));
+  return xi + AIR_CAST(size_t, sz[0])*(yi + AIR_CAST(size_t, sz[1])*zi);
+}
+
+/*
+** with kindData->fitCache: sets pvlData->fitTen to the single tensors fit
+** to the DWIs at each voxel of the current (2r)^3 neighborhood. Voxels
+** already fit (by any pvl sharing this kind) are taken from the kind's
+** cache, and the others are fit here, with the cache mutex unlocked, and
+** then added to it.  The iv3 already holds the DWIs of the neighborhood
+** (with indices clamped at the volume boundary, as done here)
+*/
+static void
+_tenDwiGageFitNeighborhood(gageContext *ctx, gagePerVolume *pvl) {
+  tenDwiGageKindData *kindData;
+  tenDwiGagePvlData *pvlData;
+  unsigned int fd, fddd, vi, dwiIdx, dwiNum;
+  int lo[3], sz[3];
+  size_t ci;
+
+  kindData = AIR_CAST(tenDwiGageKindData *, pvl->kind->data);
+  pvlData = AIR_CAST(tenDwiGagePvlData *, pvl->data);
+  fd = AIR_UINT(2*ctx->radius);
+  fddd = fd*fd*fd;
+  dwiNum = pvl->kind->valLen;
+  for (vi=0; vi<3; vi++) {
+    /* idx-1: see Thu Jan 14 comment in gage/filter.c */
+    lo[vi] = AIR_INT(ctx->point.idx[vi]) - 1 - (ctx->radius - 1);
+    sz[vi] = AIR_INT(pvl->nin->axis[1+vi].size);
+  }
+  airThreadMutexLock(kindData->cacheMutex);
+  for (vi=0; vi<fddd; vi++) {
+    ci = _tenDwiGageCacheIndex(lo, sz, fd, vi);
+    if ((pvlData->fitHave[vi] = kindData->cacheDone[ci])) {
+      TEN_T_COPY(pvlData->fitTen + 7*vi, kindData->cacheTen + 7*ci);
+    }
+  }
+  airThreadMutexUnlock(kindData->cacheMutex);
+  for (vi=0; vi<fddd; vi++) {
+    if (!pvlData->fitHave[vi]) {
+      for (dwiIdx=0; dwiIdx<dwiNum; dwiIdx++) {
+        pvlData->vbuf[dwiIdx] = pvl->iv3[vi + fddd*dwiIdx];
+      }
+      if (tenEstimate1TensorSingle_d(pvlData->tec1, pvlData->fitTen + 7*vi,
+                                     pvlData->vbuf)) {
+        /* tec1 doesn't use biff; a failed fit is cached (and interpolated)
+           as a zero tensor with zero confidence */
+        TEN_T_SET(pvlData->fitTen + 7*vi, 0, 0, 0, 0, 0, 0, 0);
+      }
+    }
+  }
+  airThreadMutexLock(kindData->cacheMutex);
+  for (vi=0; vi<fddd; vi++) {
+    if (!pvlData->fitHave[vi]) {
+      ci = _tenDwiGageCacheIndex(lo, sz, fd, vi);
+      TEN_T_COPY(kindData->cacheTen + 7*ci, pvlData->fitTen + 7*vi);
+      kindData->cacheDone[ci] = 1;
+    }
+  }
+  airThreadMutexUnlock(kindData->cacheMutex);
+  ELL_3V_COPY(pvlData->fitIdx, ctx->point.idx);
+  pvlData->fitValid = AIR_TRUE;
+  return;
+}
+
+/*
+** the single tensor at the current location: normally fit to the
+** interpolated DWIs, or with kindData->fitCache, interpolated (with the
+** same weights as the DWIs) from the tensors fit at the voxels
+*/
+static void
+_tenDwiGageTensorFit(gageContext *ctx, gagePerVolume *pvl, double ten[7]) {
+  tenDwiGageKindData *kindData;
+  tenDwiGagePvlData *pvlData;
+  double *dwiAll, wght, tendummy[7];
+  unsigned int fd, vi;
+
+  kindData = AIR_CAST(tenDwiGageKindData *, pvl->kind->data);
+  pvlData = AIR_CAST(tenDwiGagePvlData *, pvl->data);
+  dwiAll = pvl->directAnswer[tenDwiGageAll];
+  if (!kindData->fitCache) {
+    tenEstimate1TensorSingle_d(pvlData->tec1, ten, dwiAll);
+    return;
+  }
+  if (!(pvlData->fitValid && ELL_3V_EQUAL(pvlData->fitIdx, ctx->point.idx))) {
+    _tenDwiGageFitNeighborhood(ctx, pvl);
+  }
+  fd = AIR_UINT(2*ctx->radius);
+  TEN_T_SET(ten, 0, 0, 0, 0, 0, 0, 0);
+  for (vi=0; vi<pvlData->fitLen; vi++) {
+    wght = (ctx->fw[vi % fd + fd*(0 + 3*gageKernel00)]
+            *ctx->fw[(vi/fd) % fd + fd*(1 + 3*gageKernel00)]
+            *ctx->fw[vi/fd/fd + fd*(2 + 3*gageKernel00)]);
+    TEN_T_SCALE_INCR(ten, wght, pvlData->fitTen + 7*vi);
+  }
+  if (pvlData->tec1->recordErrorDwi
+      || pvlData->tec1->recordErrorLogDwi
+      || pvlData->tec1->recordLikelihoodDwi) {
+    /* the error and likelihood items are still those of the fit to the
+       interpolated DWIs, which has to come after the fits at the voxels */
+    tenEstimate1TensorSingle_d(pvlData->tec1, tendummy, dwiAll);
+  }
+  return;
+}
+
 static void
 _tenDwiGageAnswer(gageContext *ctx, gagePerVolume *pvl) {
   static const char me[] = "_tenDwiGageAnswer";
@@ -384,7 +499,7 @@ _tenDwiGageAnswer(gageContext *ctx, gagePerVolume *pvl) {
      repeated over and over again; the copy into the answer
      buffer is what changes... */
   if (GAGE_QUERY_ITEM_TEST(pvl->query, tenDwiGageTensorLLS)) {
-    tenEstimate1TensorSingle_d(pvlData->tec1, tentmp, dwiAll);
+    _tenDwiGageTensorFit(ctx, pvl, tentmp);
     TEN_T_COPY(pvl->directAnswer[tenDwiGageTensorLLS], tentmp);
   }
   if (GAGE_QUERY_ITEM_TEST(pvl->query, tenDwiGageTensorLLSError)) {
@@ -395,15 +510,15 @@ _tenDwiGageAnswer(gageContext *ctx, gagePerVolume *pvl) {
       = pvlData->tec1->errorLogDwi;
   }
   if (GAGE_QUERY_ITEM_TEST(pvl->query, tenDwiGageTensorWLS)) {
-    tenEstimate1TensorSingle_d(pvlData->tec1, tentmp, dwiAll);
+    _tenDwiGageTensorFit(ctx, pvl, tentmp);
     TEN_T_COPY(pvl->directAnswer[tenDwiGageTensorWLS], tentmp);
   }
   if (GAGE_QUERY_ITEM_TEST(pvl->query, tenDwiGageTensorNLS)) {
-    tenEstimate1TensorSingle_d(pvlData->tec1, tentmp, dwiAll);
+    _tenDwiGageTensorFit(ctx, pvl, tentmp);
     TEN_T_COPY(pvl->directAnswer[tenDwiGageTensorNLS], tentmp);
   }
   if (GAGE_QUERY_ITEM_TEST(pvl->query, tenDwiGageTensorMLE)) {
-    tenEstimate1TensorSingle_d(pvlData->tec1, tentmp, dwiAll);
+    _tenDwiGageTensorFit(ctx, pvl, tentmp);
     TEN_T_COPY(pvl->directAnswer[tenDwiGageTensorMLE], tentmp);
   }
   /* HEY: have to implement all the different kinds of errors */
@@ -498,10 +613,8 @@ _tenDwiGageAnswer(gageContext *ctx, gagePerVolume *pvl) {
     if (!E) E |= tenEstimate1TensorSingle_d(pvlData->tec2,
                                             twoten + 7, dwiAll);
     if (E) {
-      char *terr;
-      terr = biffGetDone(TEN);
-      fprintf(stderr, "%s: (trouble) %s\n", me, terr);
-      free(terr);
+      /* tec2 doesn't use biff (and this may be one of many threads) */
+      fprintf(stderr, "%s: (trouble) with two-tensor fit\n", me);
     }
 
     /* hack: confidence for two-tensor fit */
@@ -791,6 +904,10 @@ _tenDwiGagePvlDataNew(const gageKind *kind) {
       biffMovef(GAGE, TEN, "%s: trouble setting %u estimation", me, num);
       return NULL;
     }
+    /* the estimation itself happens in the answer method, possibly in
+       many threads at once (via tenFiberContextCopy), where biff can't be
+       used; failures there are reported through the answers instead */
+    tec->useBiff = AIR_FALSE;
   }
   pvlData->vbuf = AIR_CALLOC(kind->valLen, double);
   pvlData->wght = AIR_CALLOC(kind->valLen, unsigned int);
@@ -843,16 +960,29 @@ _tenDwiGagePvlDataNew(const gageKind *kind) {
 
   /* pvlData->levmarInfo[] is output; not initialized */
 
+  /* allocated by _tenDwiGagePvlDataUpdate(), if needed */
+  pvlData->fitTen = NULL;
+  pvlData->fitHave = NULL;
+  pvlData->fitLen = 0;
+  ELL_3V_SET(pvlData->fitIdx, 0, 0, 0);
+  pvlData->fitValid = AIR_FALSE;
+
   return AIR_VOIDP(pvlData);
 }
 
-static void *
+static void * /* Biff: NULL */
 _tenDwiGagePvlDataCopy(const gageKind *kind, const void *_pvlDataOld) {
   const tenDwiGagePvlData *pvlDataOld;
   tenDwiGagePvlData *pvlDataNew;
 
   pvlDataOld = AIR_CAST(const tenDwiGagePvlData *, _pvlDataOld);
+  /* this also makes new tec1 and tec2, which (like the old ones) don't
+     use biff */
   pvlDataNew = AIR_CAST(tenDwiGagePvlData *, _tenDwiGagePvlDataNew(kind));
+  if (!pvlDataNew) {
+    /* _tenDwiGagePvlDataNew() added to GAGE biff key */
+    return NULL;
+  }
 
   /* HEY: no error checking? */
   if (pvlDataOld->nten1EigenGrads) {
@@ -874,6 +1004,13 @@ _tenDwiGagePvlDataCopy(const gageKind *kind, const void *_pvlDataOld) {
   pvlDataNew->levmarMinCp = pvlDataOld->levmarMinCp;
   /* pvlData->levmarInfo[] is output; not copied */
 
+  if (pvlDataOld->fitLen) {
+    /* fitTen and fitHave are not copied, just allocated */
+    pvlDataNew->fitTen = AIR_CALLOC(7*pvlDataOld->fitLen, double);
+    pvlDataNew->fitHave = AIR_CALLOC(pvlDataOld->fitLen, unsigned char);
+    pvlDataNew->fitLen = pvlDataOld->fitLen;
+  }
+
   return pvlDataNew;
 }
 
@@ -881,12 +1018,52 @@ static int
 _tenDwiGagePvlDataUpdate(const gageKind *kind,
                          const gageContext *ctx,
                          const gagePerVolume *pvl, void *_pvlData) {
-  /* static const char me[] = "_tenDwiGagePvlDataUpdate"; */
+  static const char me[] = "_tenDwiGagePvlDataUpdate";
   tenDwiGagePvlData *pvlData;
+  tenDwiGageKindData *kindData;
+  unsigned int fitLen;
+  size_t cacheLen;
 
-  AIR_UNUSED(ctx);
   pvlData = AIR_CAST(tenDwiGagePvlData *, _pvlData);
-  AIR_UNUSED(kind);
+  kindData = AIR_CAST(tenDwiGageKindData *, kind->data);
+  if (kindData->fitCache) {
+    if (ctx->parm.stackUse) {
+      biffAddf(GAGE, "%s: sorry, fit cache not usable with stack", me);
+      return 1;
+    }
+    fitLen = AIR_UINT(2*ctx->radius);
+    fitLen = fitLen*fitLen*fitLen;
+    if (fitLen != pvlData->fitLen) {
+      airFree(pvlData->fitTen);
+      airFree(pvlData->fitHave);
+      pvlData->fitTen = AIR_CALLOC(7*fitLen, double);
+      pvlData->fitHave = AIR_CALLOC(fitLen, unsigned char);
+      if (!(pvlData->fitTen && pvlData->fitHave)) {
+        biffAddf(GAGE, "%s: couldn't allocate %u neighborhood fits", me,
+                 fitLen);
+        pvlData->fitLen = 0;
+        return 1;
+      }
+      pvlData->fitLen = fitLen;
+    }
+    pvlData->fitValid = AIR_FALSE;
+    airThreadMutexLock(kindData->cacheMutex);
+    if (kindData->cacheNin != pvl->nin) {
+      cacheLen = (pvl->nin->axis[1].size*pvl->nin->axis[2].size
+                  *pvl->nin->axis[3].size);
+      airFree(kindData->cacheTen);
+      airFree(kindData->cacheDone);
+      kindData->cacheTen = AIR_CALLOC(7*cacheLen, double);
+      kindData->cacheDone = AIR_CALLOC(cacheLen, unsigned char);
+      kindData->cacheNin = ((kindData->cacheTen && kindData->cacheDone)
+                            ? pvl->nin : NULL);
+    }
+    airThreadMutexUnlock(kindData->cacheMutex);
+    if (!kindData->cacheNin) {
+      biffAddf(GAGE, "%s: couldn't allocate fit cache", me);
+      return 1;
+    }
+  }
   if (GAGE_QUERY_ITEM_TEST(pvl->query, tenDwiGageTensorLLSError)
       || GAGE_QUERY_ITEM_TEST(pvl->query, tenDwiGageTensorWLSError)
       || GAGE_QUERY_ITEM_TEST(pvl->query, tenDwiGageTensorNLSError)
@@ -937,6 +1114,8 @@ _tenDwiGagePvlDataNix(const gageKind *kind, void *_pvlData) {
     airFree(pvlData->weights);
     nrrdNuke(pvlData->nten1EigenGrads);
     airRandMTStateNix(pvlData->randState);
+    airFree(pvlData->fitTen);
+    airFree(pvlData->fitHave);
     airFree(pvlData);
   }
   return NULL;
@@ -957,16 +1136,33 @@ tenDwiGageKindDataNew(void) {
     ret->est1Method = tenEstimate1MethodUnknown;
     ret->est2Method = tenEstimate2MethodUnknown;
     ret->randSeed = 42;
+    ret->fitCache = AIR_FALSE;
+    ret->cacheNin = NULL;
+    ret->cacheTen = NULL;
+    ret->cacheDone = NULL;
+    ret->cacheMutex = NULL;
   }
   return ret;
 }
 
+/* forgets all the cached fits (without locking cacheMutex) */
+static void
+_tenDwiGageKindDataCacheClear(tenDwiGageKindData *kindData) {
+
+  kindData->cacheNin = NULL;
+  kindData->cacheTen = AIR_CAST(double *, airFree(kindData->cacheTen));
+  kindData->cacheDone = AIR_CAST(unsigned char *, airFree(kindData->cacheDone));
+  return;
+}
+
 static tenDwiGageKindData*
 tenDwiGageKindDataNix(tenDwiGageKindData *kindData) {
 
   if (kindData) {
     nrrdNuke(kindData->ngrad);
     nrrdNuke(kindData->nbmat);
+    _tenDwiGageKindDataCacheClear(kindData);
+    airThreadMutexNix(kindData->cacheMutex);
     airFree(kindData);
   }
   return NULL;
@@ -1170,6 +1366,8 @@ tenDwiGageKindSet(gageKind *dwiKind,
   kindData->est1Method = e1method;
   kindData->est2Method = e2method;
   kindData->randSeed = randSeed;
+  /* any cached fits were made with the old parameters */
+  _tenDwiGageKindDataCacheClear(kindData);
   return 0;
 }
 
@@ -1196,4 +1394,39 @@ tenDwiGageKindCheck(const gageKind *kind) {
   }
   return 0;
 }
+
+/*
+******** tenDwiGageKindFitCacheSet
+**
+** with fitCache, the single tensor items (tenDwiGageTensor and
+** tenDwiGageTensorLLS, etc) are no longer fit to the interpolated DWIs,
+** but instead are interpolated (with the same kernel) from the tensors
+** fit at the voxels of the neighborhood.  Each voxel is fit only once,
+** and the fit is cached in the kind, so that it is shared by all the
+** gageContexts (possibly in different threads) that use this kind.
+** The cache is cleared by tenDwiGageKindSet(), and when fitCache is
+** turned off.  This can't be used with scale-space (stack) probing.
+*/
+int /* Biff: 1 */
+tenDwiGageKindFitCacheSet(gageKind *dwiKind, int fitCache) {
+  static const char me[] = "tenDwiGageKindFitCacheSet";
+  tenDwiGageKindData *kindData;
+
+  if (tenDwiGageKindCheck(dwiKind)) {
+    biffAddf(TEN, "%s: didn't get valid DWI kind", me);
+    return 1;
+  }
+  kindData = AIR_CAST(tenDwiGageKindData *, dwiKind->data);
+  if (fitCache && !kindData->cacheMutex) {
+    if (!(kindData->cacheMutex = airThreadMutexNew())) {
+      biffAddf(TEN, "%s: couldn't create mutex", me);
+      return 1;
+    }
+  }
+  if (!fitCache) {
+    _tenDwiGageKindDataCacheClear(kindData);
+  }
+  kindData->fitCache = !!fitCache;
+  return 0;
+}
 /* clang-format on */
@@ -26,6 +26,9 @@ typedef struct {
   double *buffTen, *buffWght;
   tenInterpParm *tip; /* sneakiness: using tip->allocLen to record
                          allocation sizes of buffTen and buffWght, too */
+  const Nrrd *neig;   /* if non-NULL, per-voxel eigensystems (from
+                         tenGageEigenVolume) to interpolate for Eval and
+                         Evec, instead of solving for them; not owned */
 } _tenGagePvlData;
 
 /* clang-format off */
@@ -378,6 +381,73 @@ _tenGageFilter(gageContext *ctx, gagePerVolume *pvl) {
   return;
 }
 
+/*
+** trilinear interpolation, at the current probe location, of the
+** per-voxel eigensystems in neig.  The eigenvalues are simply blended
+** (which keeps them sorted); each voxel's eigenvectors are first flipped
+** to agree in sign with those of the most heavily weighted voxel, and
+** the blended eigenvectors are then re-orthonormalized.
+*/
+static void
+_tenGageEigenLerp(double eval[3], double evec[9],
+                  const gageContext *ctx, const Nrrd *neig) {
+  const double *edata, *ee[8], *rv, *cv;
+  double ww[8], fr[3], perp[3], len, dot;
+  size_t sz[3], lo[3], hi[3], xi, yi, zi;
+  unsigned int ai, ci, ri, vi;
+
+  edata = AIR_CAST(const double *, neig->data);
+  for (ai=0; ai<3; ai++) {
+    sz[ai] = neig->axis[1+ai].size;
+    /* point.idx is the *upper* corner of the containing voxel; clamping
+       handles the half-voxel at the edges of cell-centered volumes */
+    hi[ai] = AIR_MIN(ctx->point.idx[ai], sz[ai]-1);
+    lo[ai] = ctx->point.idx[ai] ? AIR_MIN(ctx->point.idx[ai]-1, sz[ai]-1) : 0;
+    fr[ai] = ctx->point.frac[ai];
+  }
+  ri = 0;
+  for (ci=0; ci<8; ci++) {
+    xi = (ci & 1) ? hi[0] : lo[0];
+    yi = (ci & 2) ? hi[1] : lo[1];
+    zi = (ci & 4) ? hi[2] : lo[2];
+    ee[ci] = edata + 12*(xi + sz[0]*(yi + sz[1]*zi));
+    ww[ci] = (((ci & 1) ? fr[0] : 1-fr[0])
+              *((ci & 2) ? fr[1] : 1-fr[1])
+              *((ci & 4) ? fr[2] : 1-fr[2]));
+    ri = ww[ci] > ww[ri] ? ci : ri;
+  }
+  ELL_3V_SET(eval, 0, 0, 0);
+  for (ci=0; ci<8; ci++) {
+    ELL_3V_SCALE_INCR(eval, ww[ci], ee[ci]);
+  }
+  if (!evec) {
+    return;
+  }
+  for (vi=0; vi<3; vi++) {
+    rv = ee[ri] + 3 + 3*vi;
+    ELL_3V_SET(evec + 3*vi, 0, 0, 0);
+    for (ci=0; ci<8; ci++) {
+      cv = ee[ci] + 3 + 3*vi;
+      dot = ELL_3V_DOT(cv, rv);
+      ELL_3V_SCALE_INCR(evec + 3*vi, dot < 0 ? -ww[ci] : ww[ci], cv);
+    }
+  }
+  /* the blend of evec0 can't be zero: it is dominated by ee[ri] */
+  ELL_3V_NORM(evec + 0, evec + 0, len);
+  dot = ELL_3V_DOT(evec + 3, evec + 0);
+  ELL_3V_SCALE_INCR(evec + 3, -dot, evec + 0);
+  len = ELL_3V_LEN(evec + 3);
+  if (!len) {
+    ell_3v_perp_d(evec + 3, evec + 0);
+  }
+  ELL_3V_NORM(evec + 3, evec + 3, len);
+  /* evec2 is perpendicular to the other two, on the side it was blended to */
+  ELL_3V_CROSS(perp, evec + 0, evec + 3);
+  dot = ELL_3V_DOT(perp, evec + 6);
+  ELL_3V_SCALE(evec + 6, dot < 0 ? -1 : 1, perp);
+  return;
+}
+
 static void
 _tenGageAnswer(gageContext *ctx, gagePerVolume *pvl) {
   static const char me[] = "_tenGageAnswer";
@@ -395,6 +465,7 @@ _tenGageAnswer(gageContext *ctx, gagePerVolume *pvl) {
     gradCbA[3]={0,0,0}, gradCbC[3]={0,0,0};
   double hessCbA[9]={0,0,0,0,0,0,0,0,0},
     hessCbC[9]={0,0,0,0,0,0,0,0,0};
+  _tenGagePvlData *pvlData;
   int ci;
 
   tenAns = pvl->directAnswer[tenGageTensor];
@@ -485,7 +556,16 @@ _tenGageAnswer(gageContext *ctx, gagePerVolume *pvl) {
     pvl->directAnswer[tenGageModeWarp][0] =
       cos((1-pvl->directAnswer[tenGageMode][0])*AIR_PI/2);
   }
-  if (GAGE_QUERY_ITEM_TEST(pvl->query, tenGageEvec)) {
+  pvlData = AIR_CAST(_tenGagePvlData *, pvl->data);
+  if (pvlData->neig && !ctx->parm.stackUse
+      && (GAGE_QUERY_ITEM_TEST(pvl->query, tenGageEvec)
+          || GAGE_QUERY_ITEM_TEST(pvl->query, tenGageEval))) {
+    /* interpolate the eigensystem instead of solving for it */
+    _tenGageEigenLerp(evalAns,
+                      (GAGE_QUERY_ITEM_TEST(pvl->query, tenGageEvec)
+                       ? evecAns : NULL),
+                      ctx, pvlData->neig);
+  } else if (GAGE_QUERY_ITEM_TEST(pvl->query, tenGageEvec)) {
     /* we do the longer process to get eigenvectors, and in the process
        we always find the eigenvalues, whether or not they were asked for */
     tenEigensolve_d(evalAns, evecAns, tenAns);
@@ -494,8 +574,12 @@ _tenGageAnswer(gageContext *ctx, gagePerVolume *pvl) {
     tenEigensolve_d(evalAns, NULL, tenAns);
   }
 
+  /* the R gradients below include DelNormK3, so the K gradients need only
+     be found here if DelNormK2 is wanted, or if the R ones aren't */
   if (GAGE_QUERY_ITEM_TEST(pvl->query, tenGageDelNormK2)
-      || GAGE_QUERY_ITEM_TEST(pvl->query, tenGageDelNormK3)) {
+      || (GAGE_QUERY_ITEM_TEST(pvl->query, tenGageDelNormK3)
+          && !GAGE_QUERY_ITEM_TEST(pvl->query, tenGageDelNormR1)
+          && !GAGE_QUERY_ITEM_TEST(pvl->query, tenGageDelNormR2))) {
     double tmp[7];
     tenInvariantGradientsK_d(tmp,
                              pvl->directAnswer[tenGageDelNormK2],
@@ -867,9 +951,12 @@ _tenGageAnswer(gageContext *ctx, gagePerVolume *pvl) {
                tmpRes); /* l2 = trace - l1 - l3 */
   }
   if (GAGE_QUERY_ITEM_TEST(pvl->query, tenGageRotTans)) {
-    double phi1[7], phi2[7], phi3[7];
+    const double *phi1, *phi2, *phi3;
 
-    tenRotationTangents_d(phi1, phi2, phi3, evecAns);
+    /* the rotation tangents are prerequisites, already found above */
+    phi1 = pvl->directAnswer[tenGageDelNormPhi1];
+    phi2 = pvl->directAnswer[tenGageDelNormPhi2];
+    phi3 = pvl->directAnswer[tenGageDelNormPhi3];
     ELL_3V_SET(pvl->directAnswer[tenGageRotTans] + 0*3,
                TEN_T_DOT(phi1, gradDdXYZ + 0*7),
                TEN_T_DOT(phi1, gradDdXYZ + 1*7),
@@ -1472,11 +1559,9 @@ _tenGageAnswer(gageContext *ctx, gagePerVolume *pvl) {
       GAGE_QUERY_ITEM_TEST(pvl->query, tenGageTensorQuatGeoLoxR) ||
       GAGE_QUERY_ITEM_TEST(pvl->query, tenGageTensorRThetaPhiLinear)) {
     unsigned int vijk, vii, vjj, vkk, fd, fddd;
-    _tenGagePvlData *pvlData;
     double *ans;
     int qret;
 
-    pvlData = AIR_CAST(_tenGagePvlData *, pvl->data);
     /* HEY: casting because radius is signed (shouldn't be) */
     fd = AIR_UINT(2*ctx->radius);
     fddd = fd*fd*fd;
@@ -2042,6 +2127,7 @@ _tenGagePvlDataNew(const struct gageKind_t *kind) {
     pvlData->buffTen = NULL;
     pvlData->buffWght = NULL;
     pvlData->tip = tenInterpParmNew();
+    pvlData->neig = NULL;
   }
   return pvlData;
 }
@@ -2061,6 +2147,8 @@ _tenGagePvlDataCopy(const struct gageKind_t *kind,
     pvlDataNew->buffTen = AIR_CALLOC(7*num, double);
     pvlDataNew->buffWght = AIR_CALLOC(num, double);
     pvlDataNew->tip = tenInterpParmCopy(pvlDataOld->tip);
+    /* the eigensystem volume is shared, like pvl->nin */
+    pvlDataNew->neig = pvlDataOld->neig;
   }
   return pvlDataNew;
 }
@@ -2126,3 +2214,108 @@ _tenGageKind = {
 gageKind *const
 tenGageKind = &_tenGageKind;
 /* clang-format on */
+
+/*
+******** tenGageEigenVolume
+**
+** computes (with tenEigensolve_d) the eigensystem of every tensor in the
+** given DT volume, to make a 4-D double volume with 12 values per voxel:
+** the three eigenvalues, followed by the three eigenvectors (the same
+** layout as the tenGageEval and tenGageEvec answers). Meant for use with
+** tenGageEigenVolumeSet.
+*/
+int /* Biff: 1 */
+tenGageEigenVolume(Nrrd *nout, const Nrrd *nin) {
+  static const char me[] = "tenGageEigenVolume";
+  double (*lup)(const void *, size_t), ten[7], *edata;
+  size_t NN, II, sx, sy, sz;
+  unsigned int ci;
+  int map[4];
+
+  if (!(nout && nin)) {
+    biffAddf(TEN, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (tenTensorCheck(nin, nrrdTypeDefault, AIR_TRUE, AIR_TRUE)) {
+    biffAddf(TEN, "%s: didn't get a valid DT volume", me);
+    return 1;
+  }
+  sx = nin->axis[1].size;
+  sy = nin->axis[2].size;
+  sz = nin->axis[3].size;
+  if (nrrdMaybeAlloc_va(nout, nrrdTypeDouble, 4, AIR_SIZE_T(12), sx, sy, sz)) {
+    biffMovef(TEN, NRRD, "%s: can't allocate output", me);
+    return 1;
+  }
+  lup = nrrdDLookup[nin->type];
+  edata = AIR_CAST(double *, nout->data);
+  NN = sx * sy * sz;
+  for (II = 0; II < NN; II++) {
+    for (ci = 0; ci < 7; ci++) {
+      ten[ci] = lup(nin->data, 7 * II + ci);
+    }
+    tenEigensolve_d(edata + 12 * II, edata + 12 * II + 3, ten);
+  }
+  ELL_4V_SET(map, -1, 1, 2, 3);
+  if (nrrdAxisInfoCopy(nout, nin, map, NRRD_AXIS_INFO_SIZE_BIT)
+      || nrrdBasicInfoCopy(nout, nin, NRRD_BASIC_INFO_ALL ^ NRRD_BASIC_INFO_SPACE)) {
+    biffMovef(TEN, NRRD, "%s: trouble", me);
+    return 1;
+  }
+  nout->axis[0].kind = nrrdKindUnknown;
+  return 0;
+}
+
+/*
+******** tenGageEigenVolumeSet
+**
+** has the tenGageKind pvl interpolate the eigensystems in neig (from
+** tenGageEigenVolume(neig, pvl->nin)) for tenGageEval and tenGageEvec
+** (and everything that depends on them), instead of solving for them at
+** each probe. This is faster, but only an approximation: the result is
+** exactly the eigensystem of the probed tensor only at voxel centers
+** (and only when the reconstruction kernel interpolates).  Passing NULL
+** neig goes back to solving at each probe.  Not used with scale-space
+** (stack) probing.  The pvl does not own neig, which has to stay around
+** as long as the pvl (or copies of it, as from gageContextCopy) is in use.
+*/
+int /* Biff: 1 */
+tenGageEigenVolumeSet(gagePerVolume *pvl, const Nrrd *neig) {
+  static const char me[] = "tenGageEigenVolumeSet";
+  _tenGagePvlData *pvlData;
+  unsigned int ai;
+
+  if (!pvl) {
+    biffAddf(TEN, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (tenGageKind != pvl->kind) {
+    biffAddf(TEN, "%s: pvl kind is \"%s\", not \"%s\"", me, pvl->kind->name,
+             tenGageKind->name);
+    return 1;
+  }
+  if (neig) {
+    if (nrrdCheck(neig)) {
+      biffMovef(TEN, NRRD, "%s: problem with eigensystem volume", me);
+      return 1;
+    }
+    if (!(nrrdTypeDouble == neig->type && 4 == neig->dim
+          && 12 == neig->axis[0].size)) {
+      biffAddf(TEN, "%s: need 4-D %s volume with 12 values per voxel", me,
+               airEnumStr(nrrdType, nrrdTypeDouble));
+      return 1;
+    }
+    for (ai = 1; ai <= 3; ai++) {
+      if (neig->axis[ai].size != pvl->nin->axis[ai].size) {
+        char stmp[2][AIR_STRLEN_SMALL + 1];
+        biffAddf(TEN, "%s: axis %u size %s != DT volume's %s", me, ai,
+                 airSprintSize_t(stmp[0], neig->axis[ai].size),
+                 airSprintSize_t(stmp[1], pvl->nin->axis[ai].size));
+        return 1;
+      }
+    }
+  }
+  pvlData = AIR_CAST(_tenGagePvlData *, pvl->data);
+  pvlData->neig = neig;
+  return 0;
+}
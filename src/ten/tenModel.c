@@ -406,23 +406,150 @@ _tenModelSqeFitSingle(const tenModel *model, double *testParm, double *grad,
   return val;
 }
 
+/* per-task buffers of tenModelSqeFit */
+typedef struct {
+  double *ddwi, *dwibuff, *dparm, *dparmBest,
+    *dparmWarm; /* best fit at the previous sample of the scanline */
+  airRandMTState *rng;
+} _tenModelFitTask;
+
+/* what all the threads of tenModelSqeFit share */
+typedef struct {
+  const tenModel *model;
+  const tenExperSpec *espec;
+  const Nrrd *ndwi;
+  Nrrd *nparm, *nsqe, *nconv, *niter;
+  double (*lup)(const void *v, size_t I), (*ins)(void *v, size_t I, double d);
+  int knownB0, saveB0, warmStart, verbose;
+  unsigned int dwiNum, saveParmNum, minIter, maxIter, starts,
+    seed; /* the RNG is seeded with seed+II for sample II */
+  double convEps;
+  size_t sampleNum, /* total number of samples */
+    rowLen,         /* number of samples per scanline */
+    rowNum;         /* number of scanlines */
+  _tenModelFitTask *task; /* per-task buffers */
+} _tenModelFitVolume;
+
+/* progress indication, as scanlines [lo,...) are handed out */
+static void
+_tenModelFitFetched(void *_vol, size_t lo) {
+  _tenModelFitVolume *vol;
+  char doneStr[13];
+
+  vol = AIR_CAST(_tenModelFitVolume *, _vol);
+  if (vol->verbose) {
+    fprintf(stderr, "%s", airDoneStr(0, lo, vol->rowNum, doneStr));
+    fflush(stderr);
+  }
+  return;
+}
+
+/*
+** fits sample II, starting the first fit from task->dparmWarm if warm
+** is non-zero.  The RNG is re-seeded for every sample, so the result
+** depends only on the sample (and its scanline predecessor, if warm),
+** not on which thread fit it.
+*/
+static void
+_tenModelFitSample(_tenModelFitVolume *vol, _tenModelFitTask *task, size_t II,
+                   int warm) {
+  const tenModel *model;
+  const char *dwi;
+  double cvf, convFrac, sqe, sqeBest;
+  unsigned int ii, ss, itak, itersTaken;
+
+  model = vol->model;
+  airSrandMT_r(task->rng, vol->seed + AIR_UINT(II));
+  dwi = AIR_CAST(const char *, vol->ndwi->data);
+  for (ii = 0; ii < vol->dwiNum; ii++) {
+    task->ddwi[ii] = vol->lup(dwi, ii + vol->dwiNum * II);
+  }
+  convFrac = 0;
+  itersTaken = 0;
+  sqeBest = DBL_MAX; /* forces at least one improvement */
+  for (ss = 0; ss < vol->starts; ss++) {
+    if (!ss && warm) {
+      model->copy(task->dparm, task->dparmWarm);
+    } else {
+      model->rand(task->dparm, task->rng, vol->knownB0);
+    }
+    if (vol->knownB0) {
+      /* (the rand method doesn't touch B0 when it is known) */
+      task->dparm[0] = tenExperSpecKnownB0Get(vol->espec, task->ddwi);
+    }
+    sqe = model->sqeFit(task->dparm, &cvf, &itak, vol->espec, task->dwibuff, task->ddwi,
+                        task->dparm, vol->knownB0, vol->minIter, vol->maxIter,
+                        vol->convEps, vol->verbose);
+    if (sqe <= sqeBest) {
+      sqeBest = sqe;
+      model->copy(task->dparmBest, task->dparm);
+      itersTaken = itak;
+      convFrac = cvf;
+    }
+  }
+  model->copy(task->dparmWarm, task->dparmBest);
+  for (ii = 0; ii < vol->saveParmNum; ii++) {
+    vol->ins(vol->nparm->data, ii + vol->saveParmNum * II,
+             vol->saveB0 ? task->dparmBest[ii] : task->dparmBest[ii + 1]);
+  }
+  /* save things about fitting into nrrds */
+  if (vol->nsqe) {
+    vol->ins(vol->nsqe->data, II, sqeBest);
+  }
+  if (vol->nconv) {
+    nrrdDInsert[nrrdTypeDouble](vol->nconv->data, II, convFrac);
+  }
+  if (vol->niter) {
+    nrrdDInsert[nrrdTypeUInt](vol->niter->data, II, itersTaken);
+  }
+  return;
+}
+
+/* the _tenJobs work function of tenModelSqeFit: fits scanlines [lo,hi) */
+static int
+_tenModelFitWork(void *_vol, unsigned int ti, size_t lo, size_t hi, size_t *failP) {
+  _tenModelFitVolume *vol;
+  size_t row, xi;
+
+  AIR_UNUSED(failP);
+  vol = AIR_CAST(_tenModelFitVolume *, _vol);
+  for (row = lo; row < hi; row++) {
+    for (xi = 0; xi < vol->rowLen; xi++) {
+      _tenModelFitSample(vol, vol->task + ti, xi + vol->rowLen * row,
+                         vol->warmStart && xi);
+    }
+  }
+  return 0;
+}
+
+/*
+******** tenModelSqeFit
+**
+** fits model to every sample of ndwi (with the DWIs along axis 0), by
+** least-squares from "starts" different starting points, keeping the best.
+** The starting points are random, except that with warmStart, the first
+** start at each sample is the fit at the previous sample along axis 1
+** (when there is one), so that in smooth regions fewer random starts are
+** needed.  The samples are fit by threadNum threads, a run of scanlines
+** (along axis 1) at a time.  The random number generator is re-seeded at
+** every sample, from a seed drawn from rng (or the global airRandMTState
+** if rng is NULL), so the output doesn't depend on threadNum.
+*/
 int /* Biff: 1 */
 tenModelSqeFit(Nrrd *nparm, Nrrd **nsqeP, Nrrd **nconvP, Nrrd **niterP,
                const tenModel *model, const tenExperSpec *espec, const Nrrd *ndwi,
                int knownB0, int saveB0, int typeOut, unsigned int minIter,
-               unsigned int maxIter, unsigned int starts, double convEps,
-               airRandMTState *_rng, int verbose) {
+               unsigned int maxIter, unsigned int starts, int warmStart, double convEps,
+               airRandMTState *_rng, unsigned int threadNum, int verbose) {
   static const char me[] = "tenModelSqeFit";
   char doneStr[13];
-  double *ddwi, *dwibuff, sqe, sqeBest, *dparm, *dparmBest,
-    (*ins)(void *v, size_t I, double d), (*lup)(const void *v, size_t I);
   airArray *mop;
-  unsigned int saveParmNum, dwiNum, ii, lablen, itersTaken;
-  size_t szOut[NRRD_DIM_MAX], II, numSamp;
-  int axmap[NRRD_DIM_MAX], erraxmap[NRRD_DIM_MAX], fitVerbose;
-  const char *dwi;
-  char *parm;
-  airRandMTState *rng;
+  unsigned int dwiNum, ii, ti, lablen;
+  size_t szOut[NRRD_DIM_MAX];
+  int axmap[NRRD_DIM_MAX], erraxmap[NRRD_DIM_MAX];
+  _tenModelFitVolume vol;
+  _tenModelFitTask *task;
+  _tenJobs jobs;
   Nrrd *nsqe, *nconv, *niter;
 
   /* nsqeP, nconvP, niterP can be NULL */
@@ -448,18 +575,10 @@ tenModelSqeFit(Nrrd *nparm, Nrrd **nsqeP, Nrrd **nconvP, Nrrd **niterP,
   }
 
   /* allocate output (and set axmap) */
-  dparm = model->alloc();
-  dparmBest = model->alloc();
-  if (!(dparm && dparmBest)) {
-    biffAddf(TEN, "%s: couldn't allocate parm vecs", me);
-    return 1;
-  }
   mop = airMopNew();
-  airMopAdd(mop, dparm, airFree, airMopAlways);
-  airMopAdd(mop, dparmBest, airFree, airMopAlways);
-  saveParmNum = saveB0 ? model->parmNum : model->parmNum - 1;
+  vol.saveParmNum = saveB0 ? model->parmNum : model->parmNum - 1;
   for (ii = 0; ii < ndwi->dim; ii++) {
-    szOut[ii] = (!ii ? saveParmNum : ndwi->axis[ii].size);
+    szOut[ii] = (!ii ? vol.saveParmNum : ndwi->axis[ii].size);
     axmap[ii] = (!ii ? -1 : AIR_INT(ii));
     if (ii) {
       erraxmap[ii - 1] = AIR_INT(ii);
@@ -515,78 +634,81 @@ tenModelSqeFit(Nrrd *nparm, Nrrd **nsqeP, Nrrd **nconvP, Nrrd **niterP,
   } else {
     niter = NULL;
   }
-  ddwi = AIR_CALLOC(espec->imgNum, double);
-  dwibuff = AIR_CALLOC(espec->imgNum, double);
-  if (!(ddwi && dwibuff)) {
-    biffAddf(TEN, "%s: couldn't allocate dwi buffers", me);
-    airMopError(mop);
-    return 1;
-  }
-  airMopAdd(mop, ddwi, airFree, airMopAlways);
-  airMopAdd(mop, dwibuff, airFree, airMopAlways);
-
-  /* set output */
+  vol.model = model;
+  vol.espec = espec;
+  vol.ndwi = ndwi;
+  vol.nparm = nparm;
+  vol.nsqe = nsqe;
+  vol.nconv = nconv;
+  vol.niter = niter;
+  vol.lup = nrrdDLookup[ndwi->type];
+  vol.ins = nrrdDInsert[typeOut];
+  vol.knownB0 = knownB0;
+  vol.saveB0 = saveB0;
+  vol.warmStart = warmStart;
+  vol.verbose = verbose;
+  vol.dwiNum = dwiNum;
+  vol.minIter = minIter;
+  vol.maxIter = maxIter;
+  vol.starts = starts;
   if (_rng) {
-    rng = _rng;
+    vol.seed = airUIrandMT_r(_rng);
   } else {
     airRandMTStateGlobalInit();
-    rng = airRandMTStateGlobal;
+    vol.seed = airUIrandMT_r(airRandMTStateGlobal);
+  }
+  vol.convEps = convEps;
+  vol.sampleNum = nrrdElementNumber(ndwi) / ndwi->axis[0].size;
+  vol.rowLen = ndwi->dim > 1 ? ndwi->axis[1].size : 1;
+  vol.rowNum = vol.sampleNum / vol.rowLen;
+  threadNum = _tenJobsThreadNum(threadNum, vol.rowNum);
+  task = AIR_CALLOC(threadNum, _tenModelFitTask);
+  if (!task) {
+    biffAddf(TEN, "%s: couldn't allocate %u tasks", me, threadNum);
+    airMopError(mop);
+    return 1;
   }
-  numSamp = nrrdElementNumber(ndwi) / ndwi->axis[0].size;
-  lup = nrrdDLookup[ndwi->type];
-  ins = nrrdDInsert[typeOut];
-  parm = AIR_CAST(char *, nparm->data);
-  dwi = AIR_CAST(char *, ndwi->data);
-  itersTaken = 0;
+  airMopAdd(mop, task, airFree, airMopAlways);
+  for (ti = 0; ti < threadNum; ti++) {
+    task[ti].ddwi = AIR_CALLOC(dwiNum, double);
+    airMopAdd(mop, task[ti].ddwi, airFree, airMopAlways);
+    task[ti].dwibuff = AIR_CALLOC(dwiNum, double);
+    airMopAdd(mop, task[ti].dwibuff, airFree, airMopAlways);
+    task[ti].dparm = model->alloc();
+    airMopAdd(mop, task[ti].dparm, airFree, airMopAlways);
+    task[ti].dparmBest = model->alloc();
+    airMopAdd(mop, task[ti].dparmBest, airFree, airMopAlways);
+    task[ti].dparmWarm = model->alloc();
+    airMopAdd(mop, task[ti].dparmWarm, airFree, airMopAlways);
+    task[ti].rng = airRandMTStateNew(0);
+    airMopAdd(mop, task[ti].rng, (airMopper)airRandMTStateNix, airMopAlways);
+    if (!(task[ti].ddwi && task[ti].dwibuff && task[ti].dparm && task[ti].dparmBest
+          && task[ti].dparmWarm && task[ti].rng)) {
+      biffAddf(TEN, "%s: couldn't allocate buffers for thread %u", me, ti);
+      airMopError(mop);
+      return 1;
+    }
+  }
+  vol.task = task;
+  jobs.data = &vol;
+  jobs.work = _tenModelFitWork;
+  jobs.fetched = _tenModelFitFetched;
+  jobs.jobNum = vol.rowNum;
+  jobs.chunk = 0;
   if (verbose) {
+    /* progress is shown at each fetch, so there should be at least 100 */
+    jobs.chunk = vol.rowNum / (threadNum * _TEN_JOBS_FETCH_PER_THREAD);
+    jobs.chunk = AIR_MAX(1, AIR_MIN(jobs.chunk, vol.rowNum / 100));
     fprintf(stderr, "%s: fitting ...       ", me);
     fflush(stderr);
   }
-  for (II = 0; II < numSamp; II++) {
-    double cvf, convFrac = 0;
-    unsigned int ss, itak;
-    if (verbose) {
-      fprintf(stderr, "%s", airDoneStr(0, II, numSamp, doneStr));
-      fflush(stderr);
-    }
-    for (ii = 0; ii < dwiNum; ii++) {
-      ddwi[ii] = lup(dwi, ii);
-    }
-    sqeBest = DBL_MAX; /* forces at least one improvement */
-    for (ss = 0; ss < starts; ss++) {
-      /* can add other debugging conditions here */
-      fitVerbose = verbose;
-      if (knownB0) {
-        dparm[0] = tenExperSpecKnownB0Get(espec, ddwi);
-      }
-      model->rand(dparm, rng, knownB0);
-      sqe = model->sqeFit(dparm, &cvf, &itak, espec, dwibuff, ddwi, dparm, knownB0,
-                          minIter, maxIter, convEps, fitVerbose);
-      if (sqe <= sqeBest) {
-        sqeBest = sqe;
-        model->copy(dparmBest, dparm);
-        itersTaken = itak;
-        convFrac = cvf;
-      }
-    }
-    for (ii = 0; ii < saveParmNum; ii++) {
-      ins(parm, ii, saveB0 ? dparmBest[ii] : dparmBest[ii + 1]);
-    }
-    /* save things about fitting into nrrds */
-    if (nsqeP) {
-      ins(nsqe->data, II, sqeBest);
-    }
-    if (nconvP) {
-      nrrdDInsert[nrrdTypeDouble](nconv->data, II, convFrac);
-    }
-    if (niterP) {
-      nrrdDInsert[nrrdTypeUInt](niter->data, II, itersTaken);
-    }
-    parm += saveParmNum * nrrdTypeSize[typeOut];
-    dwi += espec->imgNum * nrrdTypeSize[ndwi->type];
+  if (_tenJobsRun(&jobs, threadNum)) {
+    biffAddf(TEN, "%s: trouble with threads", me);
+    airMopError(mop);
+    return 1;
   }
   if (verbose) {
-    fprintf(stderr, "%s\n", airDoneStr(0, II, numSamp, doneStr));
+    fprintf(stderr, "%s\n", airDoneStr(0, vol.rowNum, vol.rowNum, doneStr));
   }
 
   if (nrrdAxisInfoCopy(nparm, ndwi, axmap, NRRD_AXIS_INFO_SIZE_BIT)
@@ -45,11 +45,12 @@ tend_epiregMain(int argc, const char **argv, const char *me, hestParm *hparm) {
   char *gradS;
   NrrdKernelSpec *ksp;
   Nrrd **nin, **nout3D, *nout4D, *ngrad, *ngradKVP, *nbmatKVP;
-  unsigned int ni, ninLen, *skip, skipNum, baseNum;
+  unsigned int ni, ninLen, *skip, skipNum, baseNum, threadNum;
   int ref, noverbose, progress, nocc;
   float bw[2], thr, fitFrac;
   double bvalue;
 
+  threadNum = 1;
   hestOptAdd_Nv_Other(&hopt, "i", "dwi0 dwi1", 1, -1, &nin, NULL,
                       "all the diffusion-weighted images (DWIs), as separate 3D nrrds, "
                       "**OR**: one 4D nrrd of all DWIs stacked along axis 0",
@@ -101,6 +102,11 @@ tend_epiregMain(int argc, const char **argv, const char *me, hestParm *hparm) {
                      "kernel for resampling DWIs along the phase-encoding "
                      "direction during final registration stage",
                      nrrdHestKernelSpec);
+  if (airThreadCapable) {
+    hestOptAdd_1_UInt(&hopt, "nt", "# threads", &threadNum, "1",
+                      "number of threads to register with; the output does not "
+                      "depend on this");
+  }
   hestOptAdd_1_UInt(&hopt, "s", "start #", &baseNum, "1",
                     "first number to use in numbered sequence of output files.");
   hestOptAdd_1_String(&hopt, "o", "output/prefix", &outS, "-",
@@ -161,10 +167,12 @@ tend_epiregMain(int argc, const char **argv, const char *me, hestParm *hparm) {
   }
   if (1 == ninLen) {
     rret = tenEpiRegister4D(nout4D, nin[0], ngrad, ref, bw[0], bw[1], fitFrac, thr,
-                            !nocc, ksp->kernel, ksp->parm, progress, !noverbose);
+                            !nocc, ksp->kernel, ksp->parm, threadNum, progress,
+                            !noverbose);
   } else {
     rret = tenEpiRegister3D(nout3D, nin, ninLen, ngrad, ref, bw[0], bw[1], fitFrac, thr,
-                            !nocc, ksp->kernel, ksp->parm, progress, !noverbose);
+                            !nocc, ksp->kernel, ksp->parm, threadNum, progress,
+                            !noverbose);
   }
   if (rret) {
     airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
@@ -42,7 +42,7 @@ tend_estimMain(int argc, const char **argv, const char *me, hestParm *hparm) {
   char *outS, *terrS, *bmatS, *eb0S;
   float soft, scale, sigma;
   int dwiax, EE, knownB0, oldstuff, estmeth, verbose, fixneg;
-  unsigned int ninLen, axmap[4], wlsi, *skip, skipNum, skipIdx;
+  unsigned int ninLen, axmap[4], wlsi, *skip, skipNum, skipIdx, threadNum;
   double valueMin, thresh;
 
   Nrrd *ngradKVP = NULL, *nbmatKVP = NULL;
@@ -61,6 +61,13 @@ tend_estimMain(int argc, const char **argv, const char *me, hestParm *hparm) {
   hestOptAdd_1_UInt(&hopt, "wlsi", "WLS iters", &wlsi, "1",
                     "when using weighted-least-squares (\"-est wls\"), how "
                     "many iterations to do after the initial weighted fit.");
+  threadNum = 1;
+  if (airThreadCapable) {
+    hestOptAdd_1_UInt(&hopt, "nt", "# threads", &threadNum, "1",
+                      "number of threads to estimate with (not used with "
+                      "\"-old\"); most useful with the slower \"-est nls\" and "
+                      "\"-est mle\"");
+  }
   hestOptAdd_Flag(&hopt, "fixneg", &fixneg,
                   "after estimating the tensor, ensure that there are no negative "
                   "eigenvalues by adding (to all eigenvalues) the amount by which "
@@ -275,6 +282,7 @@ tend_estimMain(int argc, const char **argv, const char *me, hestParm *hparm) {
     EE = 0;
     if (!EE) tenEstimateVerboseSet(tec, verbose);
     if (!EE) tenEstimateNegEvalShiftSet(tec, fixneg);
+    if (!EE) tenEstimateThreadNumSet(tec, threadNum);
     if (!EE) EE |= tenEstimateMethodSet(tec, estmeth);
     if (!EE) EE |= tenEstimateBMatricesSet(tec, nbmat, bval, !knownB0);
     if (!EE) EE |= tenEstimateValueMinSet(tec, valueMin);
@@ -32,12 +32,12 @@ tend_evalMain(int argc, const char **argv, const char *me, hestParm *hparm) {
   char *perr, *err;
   airArray *mop;
 
-  int ret;
+  int ret, batch;
   unsigned int *comp, compLen, cc;
   Nrrd *nin, *nout;
   char *outS;
-  float thresh, *edata, *tdata, eval[3], evec[9];
-  size_t N, I, sx, sy, sz;
+  float thresh, *edata, *tdata, eval[3], evec[9], *bval;
+  size_t N, I, sx, sy, sz, bb, bnum;
 
   hestOptAdd_Nv_UInt(&hopt, "c", "c0 ", 1, 3, &comp, NULL,
                      "which eigenvalues should be saved out. \"0\" for the "
@@ -45,6 +45,10 @@ tend_evalMain(int argc, const char **argv, const char *me, hestParm *hparm) {
                      "\"0 1\", \"1 2\", \"0 1 2\" or similar for more than one",
                      &compLen);
   hestOptAdd_1_Float(&hopt, "t", "thresh", &thresh, "0.5", "confidence threshold");
+  hestOptAdd_Flag(&hopt, "batch", &batch,
+                  "find eigenvalues of many tensors at once with the closed-form "
+                  "solver of tenEigensolveBatch_f, which is faster but won't "
+                  "give bit-for-bit the same results as the default solver");
   hestOptAdd_1_Other(&hopt, "i", "nin", &nin, "-", "input diffusion tensor volume",
                      nrrdHestNrrd);
   hestOptAdd_1_String(&hopt, "o", "nout", &outS, "-", "output image (floating point)");
@@ -92,13 +96,28 @@ tend_evalMain(int argc, const char **argv, const char *me, hestParm *hparm) {
   tdata = (float *)nin->data;
   if (1 == compLen) {
     ELL_3V_SET(map, 1, 2, 3);
-    for (I = 0; I < N; I++) {
-      tenEigensolve_f(eval, evec, tdata);
-      edata[I] = (tdata[0] >= thresh) * eval[comp[0]];
-      tdata += 7;
-    }
   } else {
     ELL_4V_SET(map, 0, 1, 2, 3);
+  }
+  if (batch) {
+    bval = AIR_CALLOC(3 * TEND_EIGEN_BATCH, float);
+    if (!bval) {
+      fprintf(stderr, "%s: couldn't allocate eigenvalue buffer\n", me);
+      airMopError(mop);
+      return 1;
+    }
+    airMopAdd(mop, bval, airFree, airMopAlways);
+    for (I = 0; I < N; I += bnum) {
+      bnum = AIR_MIN(TEND_EIGEN_BATCH, N - I);
+      tenEigensolveBatch_f(bval, NULL, tdata, bnum, 0);
+      for (bb = 0; bb < bnum; bb++) {
+        for (cc = 0; cc < compLen; cc++)
+          edata[cc] = (tdata[0] >= thresh) * bval[comp[cc] + 3 * bb];
+        edata += compLen;
+        tdata += 7;
+      }
+    }
+  } else {
     for (I = 0; I < N; I++) {
       tenEigensolve_f(eval, evec, tdata);
       for (cc = 0; cc < compLen; cc++)
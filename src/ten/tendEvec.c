@@ -32,12 +32,12 @@ tend_evecMain(int argc, const char **argv, const char *me, hestParm *hparm) {
   char *perr, *err;
   airArray *mop;
 
-  int ret, *comp;
+  int ret, *comp, batch;
   unsigned int cc, compLen;
   Nrrd *nin, *nout;
   char *outS;
-  float thresh, *edata, *tdata, eval[3], evec[9], scl;
-  size_t N, I, sx, sy, sz;
+  float thresh, *edata, *tdata, eval[3], evec[9], scl, *bval, *bvec;
+  size_t N, I, sx, sy, sz, bb, bnum;
 
   hestOptAdd_Nv_Int(&hopt, "c", "c0 ", 1, 3, &comp, NULL,
                     "which eigenvalues should be saved out. \"0\" for the "
@@ -45,6 +45,10 @@ tend_evecMain(int argc, const char **argv, const char *me, hestParm *hparm) {
                     "\"0 1\", \"1 2\", \"0 1 2\" or similar for more than one",
                     &compLen);
   hestOptAdd_1_Float(&hopt, "t", "thresh", &thresh, "0.5", "confidence threshold");
+  hestOptAdd_Flag(&hopt, "batch", &batch,
+                  "find eigenvectors of many tensors at once with the closed-form "
+                  "solver of tenEigensolveBatch_f, which is faster but won't "
+                  "give bit-for-bit the same results as the default solver");
   hestOptAdd_1_Other(&hopt, "i", "nin", &nin, "-", "input diffusion tensor volume",
                      nrrdHestNrrd);
   hestOptAdd_1_String(&hopt, "o", "nout", &outS, "-", "output image (floating point)");
@@ -86,13 +90,27 @@ tend_evecMain(int argc, const char **argv, const char *me, hestParm *hparm) {
   N = sx * sy * sz;
   edata = (float *)nout->data;
   tdata = (float *)nin->data;
-  if (1 == compLen) {
-    for (I = 0; I < N; I++) {
-      tenEigensolve_f(eval, evec, tdata);
-      scl = AIR_FLOAT(tdata[0] >= thresh);
-      ELL_3V_SCALE(edata, scl, evec + 3 * comp[0]);
-      edata += 3;
-      tdata += 7;
+  if (batch) {
+    bval = AIR_CALLOC(3 * TEND_EIGEN_BATCH, float);
+    airMopAdd(mop, bval, airFree, airMopAlways);
+    bvec = AIR_CALLOC(9 * TEND_EIGEN_BATCH, float);
+    airMopAdd(mop, bvec, airFree, airMopAlways);
+    if (!(bval && bvec)) {
+      fprintf(stderr, "%s: couldn't allocate eigensystem buffers\n", me);
+      airMopError(mop);
+      return 1;
+    }
+    for (I = 0; I < N; I += bnum) {
+      bnum = AIR_MIN(TEND_EIGEN_BATCH, N - I);
+      tenEigensolveBatch_f(bval, bvec, tdata, bnum, 0);
+      for (bb = 0; bb < bnum; bb++) {
+        scl = AIR_FLOAT(tdata[0] >= thresh);
+        for (cc = 0; cc < compLen; cc++) {
+          ELL_3V_SCALE(edata + 3 * cc, scl, bvec + 3 * comp[cc] + 9 * bb);
+        }
+        edata += 3 * compLen;
+        tdata += 7;
+      }
     }
   } else {
     for (I = 0; I < N; I++) {
@@ -40,16 +40,26 @@ tend_fiberMain(int argc, const char **argv, const char *me, hestParm *hparm) {
   double start[3], step, *_stop, *stop;
   const airEnum *ftypeEnum;
   char *ftypeS;
-  int E, intg, useDwi, allPaths, verbose, worldSpace, worldSpaceOut, ftype, ftypeDef;
+  int E, intg, useDwi, fitCache, allPaths, verbose, worldSpace, worldSpaceOut, ftype,
+    ftypeDef;
   Nrrd *nin, *nseed, *nmat, *_nmat;
-  unsigned int si, stopLen, whichPath;
+  unsigned int si, stopLen, whichPath, threadNum, streamNum, sdropLen;
+  int *sdrop;
+  double slen[2];
   double matx[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
   tenFiberMulti *tfml;
   limnPolyData *fiberPld;
+  tenFiberSink *tfsk;
+  FILE *fout;
 
   hestOptAdd_1_Other(&hopt, "i", "nin", &nin, "-", "input volume", nrrdHestNrrd);
   hestOptAdd_Flag(&hopt, "dwi", &useDwi,
                   "input volume is a DWI volume, not a single tensor volume");
+  hestOptAdd_Flag(&hopt, "fc", &fitCache,
+                  "with \"-dwi\": fit single tensors once at each voxel (as "
+                  "needed) and interpolate them, rather than fitting a tensor "
+                  "to the interpolated DWIs at every step. The fits are shared "
+                  "by all threads (\"-nt\")");
   hestOptAdd_3_Double(&hopt, "s", "seed point", start, "0 0 0",
                       "seed point for fiber; it will propogate in two opposite "
                       "directions starting from here");
@@ -100,11 +110,31 @@ tend_fiberMain(int argc, const char **argv, const char *me, hestParm *hparm) {
                       "steps is below N (not really a termination criterion)",
                       &stopLen, tendFiberStopCB);
   hestOptAdd_1_Int(&hopt, "v", "verbose", &verbose, "0", "verbosity level");
+  threadNum = 1;
+  if (airThreadCapable) {
+    hestOptAdd_1_UInt(&hopt, "nt", "# threads", &threadNum, "1",
+                      "number of threads to trace with, when tracing from "
+                      "multiple seeds (\"-ap\")");
+  }
   hestOptAdd_1_Other(&hopt, "nmat", "transform", &_nmat, "",
                      "a 4x4 homogenous transform matrix (as a nrrd, or just a text "
                      "file) given with this option will be applied to the output "
                      "tractography vertices just prior to output",
                      nrrdHestNrrd);
+  hestOptAdd_1_UInt(&hopt, "stream", "N", &streamNum, "0",
+                    "with \"-ap\": if non-zero, instead of tracing all fibers and "
+                    "then saving them, write fibers to the output as they are "
+                    "traced, N fibers at a time (tracing N seeds at a time), "
+                    "so that memory use doesn't grow with the number of seeds. "
+                    "The output is then a sequence of LMPD polydata chunks");
+  hestOptAdd_2_Double(&hopt, "slen", "min max", slen, "0 inf",
+                      "with \"-stream\": drop fibers with (whole) length "
+                      "outside this range");
+  hestOptAdd_Nv_Enum(&hopt, "sdrop", "why", 0, -1, &sdrop, "",
+                     "with \"-stream\": drop fibers for which either half stopped "
+                     "for one of these reasons (as named in the tenFiberStop enum, "
+                     "e.g. \"bounds\")",
+                     &sdropLen, tenFiberStop);
   hestOptAdd_1_String(&hopt, "o", "out", &outS, "-", "output fiber(s)");
 
   mop = airMopNew();
@@ -207,6 +237,8 @@ tend_fiberMain(int argc, const char **argv, const char *me, hestParm *hparm) {
   if (!E)
     E |= tenFiberParmSet(tfx, tenFiberParmUseIndexSpace,
                          worldSpace ? AIR_FALSE : AIR_TRUE);
+  if (!E) E |= tenFiberParmSet(tfx, tenFiberParmThreadNum, threadNum);
+  if (!E) E |= tenFiberParmSet(tfx, tenFiberParmDwiFitCache, useDwi && fitCache);
   if (!E) E |= tenFiberUpdate(tfx);
   if (E) {
     airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
@@ -258,6 +290,45 @@ tend_fiberMain(int argc, const char **argv, const char *me, hestParm *hparm) {
       airMopError(mop);
       return 1;
     }
+    if (streamNum) {
+      if (!(fout = airFopen(outS, stdout, "wb"))) {
+        fprintf(stderr, "%s: couldn't open \"%s\" for writing\n", me, outS);
+        airMopError(mop);
+        return 1;
+      }
+      airMopAdd(mop, fout, (airMopper)airFclose, airMopAlways);
+      if (!(tfsk = tenFiberSinkNew(fout, streamNum))) {
+        airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble:\n%s\n", me, err);
+        airMopError(mop);
+        return 1;
+      }
+      airMopAdd(mop, tfsk, (airMopper)tenFiberSinkNix, airMopAlways);
+      ELL_2V_COPY(tfsk->lenRange, slen);
+      for (si = 0; si < sdropLen; si++) {
+        tfsk->dropStop |= (1 << sdrop[si]);
+      }
+      if (worldSpaceOut && !worldSpace) {
+        tfsk->shape = tfx->gtx->shape;
+      }
+      if (_nmat) {
+        tfsk->xformUse = AIR_TRUE;
+        ELL_4M_COPY(tfsk->xform, matx);
+      }
+      if (tenFiberMultiTraceSink(tfx, tfsk, nseed)) {
+        airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble:\n%s\n", me, err);
+        airMopError(mop);
+        return 1;
+      }
+      if (verbose) {
+        fprintf(stderr, "%s: wrote %u of %u fibers (%u vertices) in %u chunks\n", me,
+                tfsk->fiberWritten, tfsk->fiberAdded, tfsk->vertWritten,
+                tfsk->chunkWritten);
+      }
+      airMopOkay(mop);
+      return 0;
+    }
     tfml = tenFiberMultiNew();
     airMopAdd(mop, tfml, (airMopper)tenFiberMultiNix, airMopAlways);
     /*
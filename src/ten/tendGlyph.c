@@ -26,6 +26,10 @@
 static const char *_tend_glyphInfoL
   = (INFO ".  Whether the output is postscript or a ray-traced image is controlled "
           "by the initial \"rt\" flag (by default, the output is postscript). "
+          "Alternatively, with \"-pd\", the glyphs are saved as a single "
+          "polygonal mesh (in a format determined by the extension of the output "
+          "filename, as with limnPolyDataSave), made by instancing shared "
+          "per-shape meshes, which scales to many more glyphs. "
           "Because this is doing viz/graphics, many parameters need to be set. "
           "Use a response file to simplify giving the command-line options which "
           "aren't changing between invocations. "
@@ -98,7 +102,7 @@ _tendGlyphReadCams(int imgSize[2], limnCamera **camP, unsigned int *numCamsP,
 
 static int
 tend_glyphMain(int argc, const char **argv, const char *me, hestParm *hparm) {
-  int pret, doRT = AIR_FALSE;
+  int pret, doRT = AIR_FALSE, doPD = AIR_FALSE;
   hestOpt *hopt = NULL;
   char *perr, *err;
   airArray *mop;
@@ -107,6 +111,8 @@ tend_glyphMain(int argc, const char **argv, const char *me, hestParm *hparm) {
   char *outS;
   limnCamera *cam, *hackcams;
   limnObject *glyph;
+  limnPolyData *pld;
+  tenGlyphInst *ginst;
   limnWindow *win;
   echoObject *rect = NULL;
   echoScene *scene;
@@ -152,6 +158,9 @@ tend_glyphMain(int argc, const char **argv, const char *me, hestParm *hparm) {
   hestOptAdd_Flag(&hopt, "rt", &doRT,
                   "generate ray-traced output.  By default (not using this "
                   "option), postscript output is generated.");
+  hestOptAdd_Flag(&hopt, "pd", &doPD,
+                  "instead of rendering, save glyphs as polygonal data "
+                  "(with \"-gr\" and \"-shr\" governing the meshes)");
 
   hestOptAdd_1_Int(&hopt, "v", "level", &(gparm->verbose), "0", "verbosity level");
 
@@ -254,6 +263,12 @@ tend_glyphMain(int argc, const char **argv, const char *me, hestParm *hparm) {
                    "(* postscript only *) "
                    "resolution of polygonalization of glyphs (all glyphs "
                    "other than the default box)");
+  hestOptAdd_1_UInt(&hopt, "shr", "shape res", &(gparm->shapeRes), "0",
+                    "(* polygonal only *) "
+                    "if non-zero, superquadric glyph shapes are quantized to a "
+                    "grid of this resolution over the space of eigenvalue shapes, "
+                    "so that similar glyphs share one mesh (e.g. 30).  With 0, "
+                    "every superquadric glyph has its own exact mesh.");
   hestOptAdd_3_Float(&hopt, "wd", "3 widths", gparm->edgeWidth, "0.8 0.4 0.0",
                      "(* postscript only *) "
                      "width of edges drawn for three kinds of glyph "
@@ -281,8 +296,9 @@ tend_glyphMain(int argc, const char **argv, const char *me, hestParm *hparm) {
                    "number of samples per pixel (must be a square number)");
   if (airThreadCapable) {
     hestOptAdd_1_Int(&hopt, "nt", "# threads", &(eparm->numThreads), "1",
-                     "(* ray-traced only *) "
-                     "number of threads to be used for rendering");
+                     "(* ray-traced or polygonal only *) "
+                     "number of threads to be used for rendering, or for "
+                     "generating polygonal glyphs");
   }
   hestOptAdd_N_Float(&hopt, "al", "B U V N E", 5, buvne, "0 -1 -1 -4 0.7",
                      "(* ray-traced only *) "
@@ -325,6 +341,33 @@ tend_glyphMain(int argc, const char **argv, const char *me, hestParm *hparm) {
   if (gparm->verbose) {
     fprintf(stderr, "%s: verbose = %d\n", me, gparm->verbose);
   }
+  if (doPD) {
+    if (doRT) {
+      fprintf(stderr, "%s: can't use both \"-rt\" and \"-pd\"\n", me);
+      airMopError(mop);
+      return 1;
+    }
+    gparm->threadNum = AIR_UINT(AIR_MAX(1, eparm->numThreads));
+    ginst = tenGlyphInstNew();
+    airMopAdd(mop, ginst, (airMopper)tenGlyphInstNix, airMopAlways);
+    pld = limnPolyDataNew();
+    airMopAdd(mop, pld, (airMopper)limnPolyDataNix, airMopAlways);
+    if (tenGlyphInstGen(ginst, gparm, nin, npos)
+        || tenGlyphInstPolyData(pld, ginst, gparm->threadNum)) {
+      airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble generating glyphs:\n%s\n", me, err);
+      airMopError(mop);
+      return 1;
+    }
+    if (limnPolyDataSave(outS, pld)) {
+      airMopAdd(mop, err = biffGetDone(LIMN), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble saving glyphs:\n%s\n", me, err);
+      airMopError(mop);
+      return 1;
+    }
+    airMopOkay(mop);
+    return 0;
+  }
   if (tenGlyphGen(doRT ? NULL : glyph, doRT ? scene : NULL, gparm, nin, npos, nslc)) {
     airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
     fprintf(stderr, "%s: trouble generating glyphs:\n%s\n", me, err);
@@ -34,8 +34,8 @@ tend_mfitMain(int argc, const char **argv, const char *me, hestParm *hparm) {
 
   Nrrd *nin, *nout, *nterr, *nconv, *niter;
   char *outS, *terrS, *convS, *iterS, *modS;
-  int knownB0, saveB0, verbose, mlfit, typeOut;
-  unsigned int maxIter, minIter, starts;
+  int knownB0, saveB0, verbose, mlfit, typeOut, warmStart;
+  unsigned int maxIter, minIter, starts, threadNum;
   double sigma, eps;
   const tenModel *model;
   tenExperSpec *espec;
@@ -49,6 +49,16 @@ tend_mfitMain(int argc, const char **argv, const char *me, hestParm *hparm) {
   hestOptAdd_1_UInt(&hopt, "ns", "# starts", &starts, "1",
                     "number of random starting points at which to initialize "
                     "fitting");
+  hestOptAdd_Flag(&hopt, "ws", &warmStart,
+                  "warm start: make the first of the \"-ns\" starting points at "
+                  "each sample be the fit at the previous sample along the "
+                  "first spatial axis, so that fewer random starts may be needed");
+  threadNum = 1;
+  if (airThreadCapable) {
+    hestOptAdd_1_UInt(&hopt, "nt", "# threads", &threadNum, "1",
+                      "number of threads to fit with; the output does not "
+                      "depend on this");
+  }
   hestOptAdd_Flag(&hopt, "ml", &mlfit,
                   "do ML fitting, rather than least-squares, which also "
                   "requires setting \"-sigma\"");
@@ -113,7 +123,7 @@ tend_mfitMain(int argc, const char **argv, const char *me, hestParm *hparm) {
   if (tenModelSqeFit(nout, airStrlen(terrS) ? &nterr : NULL,
                      airStrlen(convS) ? &nconv : NULL, airStrlen(iterS) ? &niter : NULL,
                      model, espec, nin, knownB0, saveB0, typeOut, minIter, maxIter,
-                     starts, eps, NULL, verbose)) {
+                     starts, warmStart, eps, NULL, threadNum, verbose)) {
     airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
     fprintf(stderr, "%s: trouble fitting:\n%s\n", me, err);
     airMopError(mop);
@@ -22,6 +22,9 @@
 #include "ten.h"
 #include "privateTen.h"
 
+/* # tensors tenEigensolveBatch_f converts to double at a time */
+#define _TEN_EIGEN_BATCH 64
+
 int tenVerbose = 0;
 
 void
@@ -451,6 +454,62 @@ tenEigensolve_d(double _eval[3], double evec[9], const double t[7]) {
   return ret;
 }
 
+/*
+******** tenEigensolveBatch_d
+**
+** finds the eigensystems of num tensors, the ii-th of which is at
+** ten + 7*ii, putting the eigenvalues in eval + 3*ii and (if evec is
+** non-NULL) the eigenvectors in evec + 9*ii, with the same ordering and
+** conventions as tenEigensolve_d.  This is ell_3ms_eigensolve_batch_d,
+** which is generally faster and more accurate than the ell_3m_eigensolve_d
+** used by tenEigensolve_d (see its documentation, including for
+** jacobiIter), but the two will not give bit-for-bit identical results.
+** Disregards the confidence values.
+*/
+void
+tenEigensolveBatch_d(double *eval, double *evec, const double *ten, size_t num,
+                     unsigned int jacobiIter) {
+
+  if (!(eval && ten)) {
+    return;
+  }
+  ell_3ms_eigensolve_batch_d(eval, evec, ten + 1, 7, num, jacobiIter);
+  return;
+}
+
+/*
+******** tenEigensolveBatch_f
+**
+** same as tenEigensolveBatch_d, but for floats
+*/
+void
+tenEigensolveBatch_f(float *eval, float *evec, const float *ten, size_t num,
+                     unsigned int jacobiIter) {
+  double sym[6 * _TEN_EIGEN_BATCH], deval[3 * _TEN_EIGEN_BATCH],
+    devec[9 * _TEN_EIGEN_BATCH];
+  size_t base, nn, ii;
+
+  if (!(eval && ten)) {
+    return;
+  }
+  for (base = 0; base < num; base += nn) {
+    nn = AIR_MIN(_TEN_EIGEN_BATCH, num - base);
+    for (ii = 0; ii < nn; ii++) {
+      ELL_6V_COPY(sym + 6 * ii, ten + 1 + 7 * (base + ii));
+    }
+    ell_3ms_eigensolve_batch_d(deval, evec ? devec : NULL, sym, 6, nn, jacobiIter);
+    for (ii = 0; ii < 3 * nn; ii++) {
+      eval[3 * base + ii] = AIR_FLOAT(deval[ii]);
+    }
+    if (evec) {
+      for (ii = 0; ii < 9 * nn; ii++) {
+        evec[9 * base + ii] = AIR_FLOAT(devec[ii]);
+      }
+    }
+  }
+  return;
+}
+
 /*  lop A
     fprintf(stderr, "###################################  I = %d\n", (int)I);
     tenEigensolve(teval, tevec, out);